@@ -45,7 +45,53 @@
     **************************************
 
     ## Notes
-    (TODO)
+
+    Outside the debug visualization, video decoding happens in scanline
+    batches: the video memory bytes fetched during the visible part of
+    a scanline are collected in a line buffer, and the whole visible line
+    is decoded in one pass (with the mode switch hoisted out of the
+    per-character loop) when the beam leaves the visible area. A palette
+    or mode change in the middle of a line first decodes the characters
+    collected so far with the old settings, so the result is identical
+    to decoding each character immediately. Call am40010_flush_video()
+    at the end of a frame or time slice to decode a partially collected
+    line before the framebuffer is displayed.
+
+    ## Video Thread
+
+    The pixel decoding of the collected scanlines can be moved to a
+    separate thread by providing an am40010_video_queue_t in
+    am40010_desc_t.video_queue. Instead of decoding a line, the gate
+    array then pushes the line's characters together with the video mode,
+    border and ink colors into the queue, and the video thread decodes
+    the queued lines into the framebuffer with
+    am40010_video_queue_decode():
+
+    ~~~C
+    static am40010_video_job_t jobs[256];
+    static am40010_video_queue_t queue;
+    am40010_video_queue_init(&queue, jobs, 256);
+
+    // on the video thread:
+    while (running) {
+        if (!am40010_video_queue_decode(&queue)) {
+            // nothing to do, sleep or yield...
+        }
+    }
+    ~~~
+
+    The queue is a lock-free single-producer/single-consumer queue like
+    the audio ring buffer in chips_common.h. When the queue is full, the
+    emulator thread waits for the video thread (and counts this in
+    am40010_video_queue_t.stalls), so the video thread must be running
+    while the emulation runs.
+
+    am40010_sync_video() decodes or queues the partially collected line,
+    waits until the video thread has decoded all queued lines and merges
+    the lines changed by the video thread into the gate array's dirty
+    lines. After this the framebuffer is complete and must not be
+    displayed before the next am40010_sync_video() call. Without a video
+    queue, am40010_sync_video() is the same as am40010_flush_video().
 
     ## Links
 
@@ -84,6 +130,11 @@ extern "C" {
 #define AM40010_FRAMEBUFFER_SIZE_BYTES (AM40010_FRAMEBUFFER_WIDTH * AM40010_FRAMEBUFFER_HEIGHT)
 #define AM40010_NUM_HWCOLORS (32 + 32)  // 32 colors plus pure black plus debug visualization colors
 
+// character kinds in the scanline buffer
+#define AM40010_LINE_PIXELS (0)     // display-enabled character, decoded from video memory
+#define AM40010_LINE_BLACK  (1)     // pure black (during SYNC)
+#define AM40010_LINE_BORDER (2)     // border color
+
 // Z80-compatible pins
 #define AM40010_PIN_A13     (13)
 #define AM40010_PIN_A14     (14)
@@ -207,7 +258,8 @@ typedef struct am40010_desc_t {
     am40010_bankswitch_t bankswitch_cb; // memory bank-switching callback
     am40010_cclk_t cclk_cb;             // the 1 MHz CCLK callback
     chips_range_t ram;                  // direct pointer to the gate-array-visible 4*16 KByte RAM banks
-    chips_range_t framebuffer;          // pointer to framebuffer (at least 1024 * 312 bytes)
+    chips_range_t framebuffer;          // pointer to framebuffer (at least 1024 * 312 bytes), or null for headless operation
+    struct am40010_video_queue_t* video_queue;  // optional, decode pixels on a separate thread (see 'Video Thread')
     void* user_data;                    // optional userdata for callbacks
 } am40010_desc_t;
 
@@ -244,9 +296,43 @@ typedef struct am40010_crt_t {
     bool v_blank;       // true if currently in vertical blanking
 } am40010_crt_t;
 
+// the visible characters of the current scanline waiting to be decoded
+typedef struct am40010_line_t {
+    int x0, y;          // beam position of the first character
+    int num;            // number of collected characters
+    uint8_t kind[AM40010_DISPLAY_WIDTH / 16];      // AM40010_LINE_PIXELS, _BLACK or _BORDER
+    uint8_t data[AM40010_DISPLAY_WIDTH / 8];       // the two video memory bytes per character
+} am40010_line_t;
+
+// a scanline segment with the gate array state needed to decode it (see 'Video Thread')
+typedef struct am40010_video_job_t {
+    am40010_line_t line;
+    uint8_t mode;
+    uint8_t border;
+    uint8_t ink[16];
+} am40010_video_job_t;
+
+// a lock-free single-producer/single-consumer queue of scanline segments (see 'Video Thread')
+typedef struct am40010_video_queue_t {
+    am40010_video_job_t* jobs;  // host-provided job memory
+    uint32_t size;              // number of jobs, must be a power of 2
+    uint32_t write_pos;         // only written by the producer (the emulator thread)
+    uint32_t read_pos;          // only written by the consumer (the video thread)
+    uint32_t stalls;            // number of times the emulator thread waited for a free job
+    uint8_t* fb;                // the framebuffer (set in am40010_init())
+    chips_dirty_lines_t dirty_lines;    // lines changed by the video thread, merged in am40010_sync_video()
+} am40010_video_queue_t;
+
+// statistics counters (only updated when CHIPS_STATS is defined)
+typedef struct am40010_stats_t {
+    uint32_t interrupts;            // number of interrupt requests
+    uint32_t video_decode_ticks;    // number of 1 MHz ticks which decoded pixels into the framebuffer
+} am40010_stats_t;
+
 // AM40010 state
 typedef struct am40010_t {
     bool dbg_vis;               // debug visualization currently enabled?
+    bool video_disabled;        // skip decoding pixels into the framebuffer
     am40010_cpc_type_t cpc_type;
     uint32_t seq_tick_count;    // gate array sequencer ticks
     uint64_t crtc_pins;         // previous crtc pins
@@ -255,12 +341,16 @@ typedef struct am40010_t {
     am40010_registers_t regs;
     am40010_video_t video;
     am40010_crt_t crt;
+    am40010_line_t line;
+    am40010_stats_t stats;
     am40010_bankswitch_t bankswitch_cb;
     am40010_cclk_t cclk_cb;
     const uint8_t* ram;
     void* user_data;
     uint64_t pins;              // only for debug inspection
     uint8_t* fb;                // decoded framebuffer pixels as hw palette indices
+    am40010_video_queue_t* video_queue; // optional queue to a video thread
+    chips_dirty_lines_t dirty_lines;    // changed framebuffer lines, cleared by the system emulator
     uint32_t hw_colors[AM40010_NUM_HWCOLORS]; // hardware colors (different for CPC and KCC)
 } am40010_t;
 
@@ -285,6 +375,14 @@ void am40010_iorq(am40010_t* ga, uint64_t cpu_pins);
         AM40010_INT/Z80_INT    - interrupt request from the gate array was triggered
 */
 uint64_t am40010_tick(am40010_t* ga, uint64_t cpu_pins);
+// decode the collected characters of the current scanline into the framebuffer
+void am40010_flush_video(am40010_t* ga);
+// flush the current scanline and wait until the video thread has decoded all queued lines
+void am40010_sync_video(am40010_t* ga);
+// initialize a video queue with host-provided memory (num_jobs must be a power of 2)
+void am40010_video_queue_init(am40010_video_queue_t* queue, am40010_video_job_t* jobs, uint32_t num_jobs);
+// video thread: decode all queued lines into the framebuffer, returns false if the queue was empty
+bool am40010_video_queue_decode(am40010_video_queue_t* queue);
 
 // prepare am40010_t snapshot before saving
 void am40010_snapshot_onsave(am40010_t* snapshot);
@@ -439,7 +537,7 @@ static void _am40010_init_hwcolors(am40010_t* ga) {
 void am40010_init(am40010_t* ga, const am40010_desc_t* desc) {
     CHIPS_ASSERT(ga && desc);
     CHIPS_ASSERT(desc->bankswitch_cb && desc->cclk_cb);
-    CHIPS_ASSERT(desc->framebuffer.ptr && (desc->framebuffer.size >= AM40010_FRAMEBUFFER_SIZE_BYTES));
+    CHIPS_ASSERT((0 == desc->framebuffer.ptr) || (desc->framebuffer.size >= AM40010_FRAMEBUFFER_SIZE_BYTES));
     CHIPS_ASSERT(desc->ram.ptr && (desc->ram.size >= (64*1024)));
     memset(ga, 0, sizeof(am40010_t));
     ga->cpc_type = desc->cpc_type;
@@ -447,6 +545,12 @@ void am40010_init(am40010_t* ga, const am40010_desc_t* desc) {
     ga->cclk_cb = desc->cclk_cb;
     ga->ram = desc->ram.ptr;
     ga->fb = desc->framebuffer.ptr;
+    // without framebuffer, video decoding stays disabled
+    ga->video_disabled = (0 == ga->fb);
+    ga->video_queue = desc->video_queue;
+    if (ga->video_queue) {
+        ga->video_queue->fb = ga->fb;
+    }
     ga->user_data = desc->user_data;
     _am40010_init_regs(ga);
     _am40010_init_video(ga);
@@ -491,6 +595,8 @@ void am40010_iorq(am40010_t* ga, uint64_t pins) {
                will only be made visible during the tick() function
             */
             case (1<<6):
+                // decode the collected characters with the old colors first
+                am40010_flush_video(ga);
                 if (ga->regs.inksel & (1<<4)) {
                     ga->regs.border = data & 0x1F;
                 } else {
@@ -660,6 +766,7 @@ static bool _am40010_sync_irq(am40010_t* ga, uint64_t crtc_pins) {
         // 2 HSYNCs after start of VSYNC, reset the interrupt counter
         if (ga->video.hscount == 2) {
             if (ga->video.intcnt >= 32) {
+                CHIPS_STATS_INC(ga->stats.interrupts);
                 ga->video.intr = true;
             }
             ga->video.intcnt = 0;
@@ -667,6 +774,7 @@ static bool _am40010_sync_irq(am40010_t* ga, uint64_t crtc_pins) {
 
         // if interrupt count reaches 52, it is reset to 0 and an interrupt is requested
         if (ga->video.intcnt == 52) {
+            CHIPS_STATS_INC(ga->stats.interrupts);
             ga->video.intr = true;
             ga->video.intcnt = 0;
         }
@@ -676,7 +784,11 @@ static bool _am40010_sync_irq(am40010_t* ga, uint64_t crtc_pins) {
     uint8_t clkcnt = ga->video.clkcnt;
     if (clkcnt == 7) {
         // trigger video-mode switch
-        ga->video.mode = ga->regs.config & AM40010_CONFIG_MODE;
+        const uint8_t mode = ga->regs.config & AM40010_CONFIG_MODE;
+        if (mode != ga->video.mode) {
+            am40010_flush_video(ga);
+            ga->video.mode = mode;
+        }
     }
     // if HSYNC is off, force the clkcnt counter to 0
     if (0 == (crtc_pins & AM40010_HS)) {
@@ -713,82 +825,200 @@ static uint8_t _am40010_vid_read(am40010_t* ga, uint64_t crtc_pins, uint16_t ccl
     return ga->ram[addr];
 }
 
+/*
+    160x200 @ 16 colors (2 pixels per byte)
+    pixel    bit mask
+    0:       |1|5|3|7|
+    1:       |0|4|2|6|
+*/
+static inline void _am40010_decode_mode0(const uint8_t* ink, const uint8_t* src, uint8_t* dst) {
+    for (size_t i = 0; i < 2; i++) {
+        const uint8_t c = src[i];
+        uint8_t p = ink[((c>>7)&0x1)|((c>>2)&0x2)|((c>>3)&0x4)|((c<<2)&0x8)];
+        *dst++ = p; *dst++ = p; *dst++ = p; *dst++ = p;
+        p = ink[((c>>6)&0x1)|((c>>1)&0x2)|((c>>2)&0x4)|((c<<3)&0x8)];
+        *dst++ = p; *dst++ = p; *dst++ = p; *dst++ = p;
+    }
+}
+
+/*
+    320x200 @ 4 colors (4 pixels per byte)
+    pixel    bit mask
+    0:       |3|7|
+    1:       |2|6|
+    2:       |1|5|
+    3:       |0|4|
+*/
+static inline void _am40010_decode_mode1(const uint8_t* ink, const uint8_t* src, uint8_t* dst) {
+    for (size_t i = 0; i < 2; i++) {
+        const uint8_t c = src[i];
+        uint8_t p = ink[((c>>2)&2)|((c>>7)&1)];
+        *dst++ = p; *dst++ = p;
+        p = ink[((c>>1)&2)|((c>>6)&1)];
+        *dst++ = p; *dst++ = p;
+        p = ink[((c>>0)&2)|((c>>5)&1)];
+        *dst++ = p; *dst++ = p;
+        p = ink[((c<<1)&2)|((c>>4)&1)];
+        *dst++ = p; *dst++ = p;
+    }
+}
+
+// 640x200 @ 2 colors (8 pixels per byte)
+static inline void _am40010_decode_mode2(const uint8_t* ink, const uint8_t* src, uint8_t* dst) {
+    for (size_t i = 0; i < 2; i++) {
+        const uint8_t c = src[i];
+        *dst++ = ink[(c>>7)&1];
+        *dst++ = ink[(c>>6)&1];
+        *dst++ = ink[(c>>5)&1];
+        *dst++ = ink[(c>>4)&1];
+        *dst++ = ink[(c>>3)&1];
+        *dst++ = ink[(c>>2)&1];
+        *dst++ = ink[(c>>1)&1];
+        *dst++ = ink[(c>>0)&1];
+    }
+}
+
+/*  undocumented mode 3:
+    160x200 @ 4 colors (2 pixels per byte)
+    pixel    bit mask
+    0:       |x|x|3|7|
+    1:       |x|x|2|6|
+*/
+static inline void _am40010_decode_mode3(const uint8_t* ink, const uint8_t* src, uint8_t* dst) {
+    for (size_t i = 0; i < 2; i++) {
+        const uint8_t c = src[i];
+        uint8_t p = ink[((c>>7)&0x1)|((c>>2)&0x2)];
+        *dst++ = p; *dst++ = p; *dst++ = p; *dst++ = p;
+        p = ink[((c>>6)&0x1)|((c>>1)&0x2)];
+        *dst++ = p; *dst++ = p; *dst++ = p; *dst++ = p;
+    }
+}
+
 static void _am40010_decode_pixels(am40010_t* ga, uint8_t* dst) {
-    uint8_t c;
-    uint8_t p;
     switch (ga->video.mode) {
-        case 0:
-            /*
-                160x200 @ 16 colors (2 pixels per byte)
-                pixel    bit mask
-                0:       |1|5|3|7|
-                1:       |0|4|2|6|
-            */
-            for (size_t i = 0; i < 2; i++) {
-                c = ga->video.latch[i];
-                p = ga->regs.ink[((c>>7)&0x1)|((c>>2)&0x2)|((c>>3)&0x4)|((c<<2)&0x8)];
-                *dst++ = p; *dst++ = p; *dst++ = p; *dst++ = p;
-                p = ga->regs.ink[((c>>6)&0x1)|((c>>1)&0x2)|((c>>2)&0x4)|((c<<3)&0x8)];
-                *dst++ = p; *dst++ = p; *dst++ = p; *dst++ = p;
-            }
-            break;
-        case 1:
-            /*
-                320x200 @ 4 colors (4 pixels per byte)
-                pixel    bit mask
-                0:       |3|7|
-                1:       |2|6|
-                2:       |1|5|
-                3:       |0|4|
-            */
-            for (size_t i = 0; i < 2; i++) {
-                c = ga->video.latch[i];
-                p = ga->regs.ink[((c>>2)&2)|((c>>7)&1)];
-                *dst++ = p; *dst++ = p;
-                p = ga->regs.ink[((c>>1)&2)|((c>>6)&1)];
-                *dst++ = p; *dst++ = p;
-                p = ga->regs.ink[((c>>0)&2)|((c>>5)&1)];
-                *dst++ = p; *dst++ = p;
-                p = ga->regs.ink[((c<<1)&2)|((c>>4)&1)];
-                *dst++ = p; *dst++ = p;
-            }
-            break;
-        case 2:
-            // 640x200 @ 2 colors (8 pixels per byte)
-            for (size_t i = 0; i < 2; i++) {
-                c = ga->video.latch[i];
-                *dst++ = ga->regs.ink[(c>>7)&1];
-                *dst++ = ga->regs.ink[(c>>6)&1];
-                *dst++ = ga->regs.ink[(c>>5)&1];
-                *dst++ = ga->regs.ink[(c>>4)&1];
-                *dst++ = ga->regs.ink[(c>>3)&1];
-                *dst++ = ga->regs.ink[(c>>2)&1];
-                *dst++ = ga->regs.ink[(c>>1)&1];
-                *dst++ = ga->regs.ink[(c>>0)&1];
-            }
-            break;
-        case 3:
-            /*  undocumented mode 3:
-                160x200 @ 4 colors (2 pixels per byte)
-                pixel    bit mask
-                0:       |x|x|3|7|
-                1:       |x|x|2|6|
-            */
-            for (size_t i = 0; i < 2; i++) {
-                c = ga->video.latch[i];
-                p = ga->regs.ink[((c>>7)&0x1)|((c>>2)&0x2)];
-                *dst++ = p; *dst++ = p; *dst++ = p; *dst++ = p;
-                p = ga->regs.ink[((c>>6)&0x1)|((c>>1)&0x2)];
-                *dst++ = p; *dst++ = p; *dst++ = p; *dst++ = p;
-            }
-            break;
+        case 0: _am40010_decode_mode0(ga->regs.ink, ga->video.latch, dst); break;
+        case 1: _am40010_decode_mode1(ga->regs.ink, ga->video.latch, dst); break;
+        case 2: _am40010_decode_mode2(ga->regs.ink, ga->video.latch, dst); break;
+        case 3: _am40010_decode_mode3(ga->regs.ink, ga->video.latch, dst); break;
         default: _AM40010_UNREACHABLE;
     }
 }
 
+// decode all display-enabled characters of the line buffer with the same mode
+#define _AM40010_DECODE_LINE(func) \
+    for (int i = 0; i < line->num; i++) { \
+        if (line->kind[i] == AM40010_LINE_PIXELS) { \
+            func(ink, &line->data[i * 2], &pixels[i * 16]); \
+        } \
+    }
+
+// decode a line buffer into the framebuffer (called on the emulator thread or the video thread)
+static void _am40010_decode_line(const am40010_line_t* line, uint8_t mode, const uint8_t* ink, uint8_t border, uint8_t* fb, chips_dirty_lines_t* dirty_lines) {
+    CHIPS_ASSERT(fb && ((line->x0 + line->num) <= (AM40010_DISPLAY_WIDTH / 16)));
+    uint8_t pixels[AM40010_DISPLAY_WIDTH];
+    // first fill the border and black characters...
+    for (int i = 0; i < line->num; i++) {
+        if (line->kind[i] != AM40010_LINE_PIXELS) {
+            memset(&pixels[i * 16], (line->kind[i] == AM40010_LINE_BLACK) ? 63 : border, 16);
+        }
+    }
+    // ...then decode the display-enabled characters
+    switch (mode) {
+        case 0: _AM40010_DECODE_LINE(_am40010_decode_mode0); break;
+        case 1: _AM40010_DECODE_LINE(_am40010_decode_mode1); break;
+        case 2: _AM40010_DECODE_LINE(_am40010_decode_mode2); break;
+        case 3: _AM40010_DECODE_LINE(_am40010_decode_mode3); break;
+        default: _AM40010_UNREACHABLE;
+    }
+    const size_t num_bytes = (size_t)line->num * 16;
+    uint8_t* dst = &fb[line->x0 * 16 + line->y * AM40010_FRAMEBUFFER_WIDTH];
+    if (0 != memcmp(dst, pixels, num_bytes)) {
+        memcpy(dst, pixels, num_bytes);
+        chips_dirty_lines_set(dirty_lines, line->y);
+    }
+}
+#undef _AM40010_DECODE_LINE
+
+// push the line buffer into the video queue, waits for the video thread if the queue is full
+static void _am40010_queue_line(am40010_t* ga) {
+    am40010_video_queue_t* queue = ga->video_queue;
+    const uint32_t wr = queue->write_pos;
+    if ((wr - _CHIPS_LOAD_ACQUIRE(&queue->read_pos)) >= queue->size) {
+        queue->stalls++;
+        while ((wr - _CHIPS_LOAD_ACQUIRE(&queue->read_pos)) >= queue->size) {
+            // wait for the video thread
+        }
+    }
+    am40010_video_job_t* job = &queue->jobs[wr & (queue->size - 1)];
+    job->line.x0 = ga->line.x0;
+    job->line.y = ga->line.y;
+    job->line.num = ga->line.num;
+    memcpy(job->line.kind, ga->line.kind, (size_t)ga->line.num);
+    memcpy(job->line.data, ga->line.data, (size_t)ga->line.num * 2);
+    job->mode = ga->video.mode;
+    job->border = ga->regs.border;
+    memcpy(job->ink, ga->regs.ink, sizeof(job->ink));
+    _CHIPS_STORE_RELEASE(&queue->write_pos, wr + 1);
+}
+
+void am40010_flush_video(am40010_t* ga) {
+    CHIPS_ASSERT(ga);
+    am40010_line_t* line = &ga->line;
+    if (0 == line->num) {
+        return;
+    }
+    if (ga->video_queue) {
+        _am40010_queue_line(ga);
+    }
+    else {
+        _am40010_decode_line(line, ga->video.mode, ga->regs.ink, ga->regs.border, ga->fb, &ga->dirty_lines);
+    }
+    line->num = 0;
+}
+
+void am40010_sync_video(am40010_t* ga) {
+    CHIPS_ASSERT(ga);
+    am40010_flush_video(ga);
+    am40010_video_queue_t* queue = ga->video_queue;
+    if (queue) {
+        while (_CHIPS_LOAD_ACQUIRE(&queue->read_pos) != queue->write_pos) {
+            // wait for the video thread
+        }
+        // the video thread is idle now and doesn't touch its dirty lines until the next job is queued
+        for (size_t i = 0; i < (CHIPS_DIRTY_MAX_LINES / 32); i++) {
+            ga->dirty_lines.bits[i] |= queue->dirty_lines.bits[i];
+        }
+        chips_dirty_lines_clear(&queue->dirty_lines);
+    }
+}
+
+void am40010_video_queue_init(am40010_video_queue_t* queue, am40010_video_job_t* jobs, uint32_t num_jobs) {
+    CHIPS_ASSERT(queue && jobs && (num_jobs > 0) && (0 == (num_jobs & (num_jobs - 1))));
+    memset(queue, 0, sizeof(am40010_video_queue_t));
+    queue->jobs = jobs;
+    queue->size = num_jobs;
+}
+
+bool am40010_video_queue_decode(am40010_video_queue_t* queue) {
+    CHIPS_ASSERT(queue && queue->jobs);
+    const uint32_t wr = _CHIPS_LOAD_ACQUIRE(&queue->write_pos);
+    uint32_t rd = queue->read_pos;
+    if (rd == wr) {
+        return false;
+    }
+    for (; rd != wr; rd++) {
+        const am40010_video_job_t* job = &queue->jobs[rd & (queue->size - 1)];
+        _am40010_decode_line(&job->line, job->mode, job->ink, job->border, queue->fb, &queue->dirty_lines);
+        _CHIPS_STORE_RELEASE(&queue->read_pos, rd + 1);
+    }
+    return true;
+}
+
 // video signal generator, call this at 1 MHz frequency
 static void _am40010_decode_video(am40010_t* ga, uint64_t crtc_pins) {
     if (ga->dbg_vis) {
+        // the debug visualization decodes each character immediately
+        am40010_sync_video(ga);
         size_t dst_x = ga->crt.h_pos * 16;
         size_t dst_y = ga->crt.v_pos;
         if ((dst_x <= (AM40010_FRAMEBUFFER_WIDTH-16)) && (dst_y < AM40010_FRAMEBUFFER_HEIGHT)) {
@@ -812,6 +1042,11 @@ static void _am40010_decode_video(am40010_t* ga, uint64_t crtc_pins) {
             if (ga->video.intr) {
                 c |= 0x08;
             }
+            // the debug visualization changes every frame, and may also touch the previous line
+            chips_dirty_lines_set(&ga->dirty_lines, dst_y);
+            if ((dst_x == 0) && (dst_y > 0)) {
+                chips_dirty_lines_set(&ga->dirty_lines, dst_y - 1);
+            }
             if (crtc_pins & AM40010_DE) {
                 _am40010_decode_pixels(ga, dst);
                 for (size_t i = 0; i < 16; i++) {
@@ -832,21 +1067,28 @@ static void _am40010_decode_video(am40010_t* ga, uint64_t crtc_pins) {
             }
         }
     } else if (ga->crt.visible) {
-        size_t dst_x = ga->crt.pos_x * 16;
-        size_t dst_y = ga->crt.pos_y;
-        bool black = ga->video.sync;
-        uint8_t* dst = &ga->fb[dst_x + dst_y * AM40010_FRAMEBUFFER_WIDTH];
+        // collect the character in the line buffer, decoding happens in am40010_flush_video()
+        am40010_line_t* line = &ga->line;
+        if ((line->num > 0) && ((line->y != ga->crt.pos_y) || ((line->x0 + line->num) != ga->crt.pos_x))) {
+            am40010_flush_video(ga);
+        }
+        if (0 == line->num) {
+            line->x0 = ga->crt.pos_x;
+            line->y = ga->crt.pos_y;
+        }
+        const int i = line->num++;
         if (crtc_pins & AM40010_DE) {
-            _am40010_decode_pixels(ga, dst);
-        } else if (black) {
-            for (int i = 0; i < 16; i++) {
-                *dst++ = 63;    // special 'pure black' hw color
-            }
+            line->kind[i] = AM40010_LINE_PIXELS;
+            line->data[i * 2 + 0] = ga->video.latch[0];
+            line->data[i * 2 + 1] = ga->video.latch[1];
+        } else if (ga->video.sync) {
+            line->kind[i] = AM40010_LINE_BLACK;     // special 'pure black' hw color
         } else {
-            for (int i = 0; i < 16; i++) {
-                *dst++ = ga->regs.border;
-            }
+            line->kind[i] = AM40010_LINE_BORDER;
         }
+    } else if (ga->line.num > 0) {
+        // the beam has left the visible area, decode the whole line
+        am40010_flush_video(ga);
     }
 }
 
@@ -895,7 +1137,10 @@ uint64_t am40010_tick(am40010_t* ga, uint64_t pins) {
     if (cclk1) {
         // read second video ram byte
         ga->video.latch[1] = _am40010_vid_read(ga, ga->crtc_pins, 1);
-        _am40010_decode_video(ga, ga->crtc_pins);
+        if (!ga->video_disabled) {
+            CHIPS_STATS_INC(ga->stats.video_decode_ticks);
+            _am40010_decode_video(ga, ga->crtc_pins);
+        }
     }
 
     // perform the per-4Mhz-tick actions, the AM40010_READY pin is also the Z80_WAIT pin
@@ -929,6 +1174,7 @@ void am40010_snapshot_onsave(am40010_t* snapshot) {
     snapshot->user_data = 0;
     snapshot->ram = 0;
     snapshot->fb = 0;
+    snapshot->video_queue = 0;
 }
 
 void am40010_snapshot_onload(am40010_t* snapshot, am40010_t* sys) {
@@ -938,6 +1184,7 @@ void am40010_snapshot_onload(am40010_t* snapshot, am40010_t* sys) {
     snapshot->user_data = sys->user_data;
     snapshot->ram = sys->ram;
     snapshot->fb = sys->fb;
+    snapshot->video_queue = sys->video_queue;
 }
 
 #endif // CHIPS_IMPL
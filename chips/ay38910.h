@@ -33,6 +33,29 @@
       a CP1610 CPU
     - the RESET pin state is ignored, instead call ay38910_reset()
 
+    LAZY CATCH-UP:
+
+    Instead of calling ay38910_tick() for every chip tick, a system can
+    just count the ticks and call ay38910_run() with the accumulated tick
+    count right before an ay38910_iorq() call and at the end of a frame.
+    ay38910_run() writes the generated samples into a sample buffer and
+    skips over the ticks where nothing happens inside the chip, the
+    generated samples are identical to calling ay38910_tick() in a loop.
+
+    BAND-LIMITED OUTPUT:
+
+    By default the channel outputs are mixed once per output sample and
+    passed through a moving-average DC filter.
+
+    Optionally define CHIPS_BLIP before including ay38910.h to generate
+    the output samples through band-limited step synthesis instead (see
+    blip.h), the output level is then only recomputed when a tone, noise
+    or envelope generator changes state or when a register is written.
+    In this case you need to include the following headers before
+    including ay38910.h:
+
+    - chips/blip.h
+
     ## zlib/libpng license
 
     Copyright (c) 2018 Andre Weissflog
@@ -165,8 +188,10 @@ extern "C" {
 #define AY38910_FIXEDPOINT_SCALE (16)
 // number of channels
 #define AY38910_NUM_CHANNELS (3)
+#if !defined(CHIPS_BLIP)
 // DC adjustment buffer length
 #define AY38910_DCADJ_BUFLEN (512)
+#endif
 
 // IO port names
 #define AY38910_PORT_A (0)
@@ -266,10 +291,16 @@ typedef struct {
     int sample_period;
     int sample_counter;
     float mag;
+#if defined(CHIPS_BLIP)
+    float level;            // current output level (sum of the channel volumes)
+    float sample;
+    blip_t blip;            // band-limited step synthesis state
+#else
     float sample;
     float dcadj_sum;
     uint32_t dcadj_pos;
     float dcadj_buf[AY38910_DCADJ_BUFLEN];
+#endif
 } ay38910_t;
 
 // extract 8-bit data bus from 64-bit pins
@@ -289,6 +320,8 @@ void ay38910_reset(ay38910_t* ay);
 uint64_t ay38910_iorq(ay38910_t* ay, uint64_t pins);
 // tick the AY-3-8910, return true if a new sample is ready
 bool ay38910_tick(ay38910_t* ay);
+// run the AY-3-8910 for num_ticks or until max_samples have been written to samples, returns number of executed ticks
+uint32_t ay38910_run(ay38910_t* ay, uint32_t num_ticks, float* samples, int max_samples, int* out_num_samples);
 // helper functions to directly write register values and update dependent state, not intended for regular operation!
 void ay38910_set_register(ay38910_t* ay, uint8_t addr, uint8_t data);
 void ay38910_set_addr_latch(ay38910_t* ay, uint8_t addr);
@@ -296,6 +329,10 @@ void ay38910_set_addr_latch(ay38910_t* ay, uint8_t addr);
 void ay38910_snapshot_onsave(ay38910_t* snapshot);
 // fixup ay38910_t snapshot after loading
 void ay38910_snapshot_onload(ay38910_t* snapshot, ay38910_t* sys);
+#if defined(CHIPS_FOURCC)
+// write ay38910_t state to a stream or read it from a stream (needs chips_common.h)
+void ay38910_serialize(ay38910_t* ay, chips_stream_t* stream);
+#endif
 
 #ifdef __cplusplus
 } // extern "C"
@@ -309,6 +346,14 @@ void ay38910_snapshot_onload(ay38910_t* snapshot, ay38910_t* sys);
     #define CHIPS_ASSERT(c) assert(c)
 #endif
 
+#if defined(__GNUC__)
+#define _AY38910_FORCE_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define _AY38910_FORCE_INLINE __forceinline
+#else
+#define _AY38910_FORCE_INLINE inline
+#endif
+
 // register width bit masks
 static const uint8_t _ay38910_reg_mask[AY38910_NUM_REGISTERS] = {
     0xFF,       // AY38910_REG_PERIOD_A_FINE
@@ -380,6 +425,47 @@ static const uint8_t _ay38910_shapes[16][32] = {
     { 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
 };
 
+// compute the current output level (sum of the enabled channel volumes)
+static float _ay38910_mix(const ay38910_t* ay) {
+    float level = 0.0f;
+    for (int i = 0; i < AY38910_NUM_CHANNELS; i++) {
+        const ay38910_tone_t* chn = &ay->tone[i];
+        float vol;
+        if (0 == (ay->reg[AY38910_REG_AMP_A+i] & (1<<4))) {
+            // fixed amplitude
+            vol = _ay38910_volumes[ay->reg[AY38910_REG_AMP_A+i] & 0x0F];
+        }
+        else {
+            // envelope control
+            vol = _ay38910_volumes[ay->env.shape_state];
+        }
+        int vol_enable = (chn->bit|chn->tone_disable) & ((ay->noise.rng&1)|(chn->noise_disable));
+        if (vol_enable) {
+            level += vol;
+        }
+    }
+    return level;
+}
+
+#if defined(CHIPS_BLIP)
+/* recompute the output level and report changes to the band-limited step
+   synthesis, must be called whenever the tone, noise or envelope generator
+   state or the registers have changed, the output DC offset is removed by
+   blip_next_sample()
+*/
+static void _ay38910_update_level(ay38910_t* ay) {
+    const float level = _ay38910_mix(ay);
+    if (level != ay->level) {
+        blip_add_delta(&ay->blip, blip_phase(ay->sample_counter, ay->sample_period), level - ay->level);
+        ay->level = level;
+    }
+}
+#else
+// without CHIPS_BLIP the output is mixed once per sample in _ay38910_tick()
+static void _ay38910_update_level(ay38910_t* ay) {
+    (void)ay;
+}
+
 /* DC adjustment filter from StSound, this moves an "offcenter"
    signal back to the zero-line (e.g. the volume-level output
    from the chip simulation which is >0.0 gets converted to
@@ -392,6 +478,7 @@ static float _ay38910_dcadjust(ay38910_t* ay, float s) {
     ay->dcadj_pos = (ay->dcadj_pos + 1) & (AY38910_DCADJ_BUFLEN-1);
     return s - (ay->dcadj_sum / AY38910_DCADJ_BUFLEN);
 }
+#endif
 
 // update computed values after registers have been reprogrammed
 static void _ay38910_update_values(ay38910_t* ay) {
@@ -447,8 +534,12 @@ void ay38910_init(ay38910_t* ay, const ay38910_desc_t* desc) {
     ay->sample_period = (desc->tick_hz * AY38910_FIXEDPOINT_SCALE) / desc->sound_hz;
     ay->sample_counter = ay->sample_period;
     ay->mag = desc->magnitude;
+    #if defined(CHIPS_BLIP)
+    blip_init(&ay->blip);
+    #endif
     _ay38910_update_values(ay);
     _ay38910_restart_env_shape(ay);
+    _ay38910_update_level(ay);
 }
 
 void ay38910_reset(ay38910_t* ay) {
@@ -460,10 +551,12 @@ void ay38910_reset(ay38910_t* ay) {
     }
     _ay38910_update_values(ay);
     _ay38910_restart_env_shape(ay);
+    _ay38910_update_level(ay);
 }
 
-bool ay38910_tick(ay38910_t* ay) {
+static _AY38910_FORCE_INLINE bool _ay38910_tick(ay38910_t* ay) {
     ay->tick++;
+    bool changed = false;
     if ((ay->tick & 7) == 0) {
         // tick the tone channels
         for (int i = 0; i < AY38910_NUM_CHANNELS; i++) {
@@ -471,6 +564,7 @@ bool ay38910_tick(ay38910_t* ay) {
             if (++chn->counter >= chn->period) {
                 chn->counter = 0;
                 chn->bit ^= 1;
+                changed = true;
             }
         }
 
@@ -479,6 +573,7 @@ bool ay38910_tick(ay38910_t* ay) {
             ay->noise.counter = 0;
             ay->noise.bit ^= 1;
             if (ay->noise.bit) {
+                changed = true;
                 // random number generator from MAME:
                 // https://github.com/mamedev/mame/blob/master/src/devices/sound/ay8910.cpp
                 // The Random Number Generator of the 8910 is a 17-bit shift
@@ -501,37 +596,65 @@ bool ay38910_tick(ay38910_t* ay) {
                 }
             }
             ay->env.shape_state = _ay38910_shapes[ay->env_shape_cycle][ay->env.shape_counter];
+            changed = true;
         }
     }
+    if (changed) {
+        _ay38910_update_level(ay);
+    }
 
     // generate new sample?
     ay->sample_counter -= AY38910_FIXEDPOINT_SCALE;
     if (ay->sample_counter <= 0) {
         ay->sample_counter += ay->sample_period;
-        float sm = 0.0f;
-        for (int i = 0; i < AY38910_NUM_CHANNELS; i++) {
-            const ay38910_tone_t* chn = &ay->tone[i];
-            float vol;
-            if (0 == (ay->reg[AY38910_REG_AMP_A+i] & (1<<4))) {
-                // fixed amplitude
-                vol = _ay38910_volumes[ay->reg[AY38910_REG_AMP_A+i] & 0x0F];
-            }
-            else {
-                // envelope control
-                vol = _ay38910_volumes[ay->env.shape_state];
-            }
-            int vol_enable = (chn->bit|chn->tone_disable) & ((ay->noise.rng&1)|(chn->noise_disable));
-            if (vol_enable) {
-                sm += vol;
-            }
-        }
-        ay->sample = _ay38910_dcadjust(ay, sm) * ay->mag;
+        #if defined(CHIPS_BLIP)
+        ay->sample = blip_next_sample(&ay->blip) * ay->mag;
+        #else
+        ay->sample = _ay38910_dcadjust(ay, _ay38910_mix(ay)) * ay->mag;
+        #endif
         return true; // new sample is ready
     }
     // fallthrough: no new sample ready yet
     return false;
 }
 
+bool ay38910_tick(ay38910_t* ay) {
+    return _ay38910_tick(ay);
+}
+
+uint32_t ay38910_run(ay38910_t* ay, uint32_t num_ticks, float* samples, int max_samples, int* out_num_samples) {
+    CHIPS_ASSERT(ay && samples && (max_samples > 0) && out_num_samples);
+    uint32_t tick = 0;
+    int num_samples = 0;
+    while ((tick < num_ticks) && (num_samples < max_samples)) {
+        /* Between the clock-divided tone/noise/envelope updates (every 8th
+           tick) and the sample generation nothing happens except
+           counting, so skip ahead to the next tick where something happens
+        */
+        uint32_t skip = 7 - (ay->tick & 7);
+        if (ay->sample_counter > AY38910_FIXEDPOINT_SCALE) {
+            const uint32_t sample_skip = (uint32_t)((ay->sample_counter - 1) / AY38910_FIXEDPOINT_SCALE);
+            if (sample_skip < skip) {
+                skip = sample_skip;
+            }
+        }
+        else {
+            skip = 0;
+        }
+        if (skip > (num_ticks - tick - 1)) {
+            skip = num_ticks - tick - 1;
+        }
+        ay->tick += skip;
+        ay->sample_counter -= (int)skip * AY38910_FIXEDPOINT_SCALE;
+        tick += skip + 1;
+        if (_ay38910_tick(ay)) {
+            samples[num_samples++] = ay->sample;
+        }
+    }
+    *out_num_samples = num_samples;
+    return tick;
+}
+
 uint64_t ay38910_iorq(ay38910_t* ay, uint64_t pins) {
     if (pins & AY38910_BDIR) {
         const uint8_t data = AY38910_GET_DATA(pins);
@@ -551,6 +674,7 @@ uint64_t ay38910_iorq(ay38910_t* ay, uint64_t pins) {
                 // write register content, and update dependent values
                 ay->reg[ay->addr] = data & _ay38910_reg_mask[ay->addr];
                 _ay38910_update_values(ay);
+                _ay38910_update_level(ay);
                 if (ay->addr == AY38910_REG_ENV_SHAPE_CYCLE) {
                     _ay38910_restart_env_shape(ay);
                 }
@@ -646,6 +770,7 @@ void ay38910_set_register(ay38910_t* ay, uint8_t addr, uint8_t data) {
     CHIPS_ASSERT(ay && (addr < AY38910_NUM_REGISTERS));
     ay->reg[addr] = data & _ay38910_reg_mask[addr];
     _ay38910_update_values(ay);
+    _ay38910_update_level(ay);
     if (addr == AY38910_REG_ENV_SHAPE_CYCLE) {
         _ay38910_restart_env_shape(ay);
     }
@@ -669,4 +794,58 @@ void ay38910_snapshot_onload(ay38910_t* snapshot, ay38910_t* sys) {
     snapshot->out_cb = sys->out_cb;
     snapshot->user_data = sys->user_data;
 }
+
+#if defined(CHIPS_FOURCC)
+void ay38910_serialize(ay38910_t* ay, chips_stream_t* s) {
+    CHIPS_ASSERT(ay && s);
+    #if defined(CHIPS_BLIP)
+    const uint32_t version = 2;
+    #else
+    const uint32_t version = 1;
+    #endif
+    if (!chips_stream_begin(s, CHIPS_FOURCC('A','Y','3','8'), version)) {
+        return;
+    }
+    int type = (int)ay->type;
+    chips_stream_int(s, &type);
+    ay->type = (ay38910_type_t)type;
+    chips_stream_u32(s, &ay->tick);
+    chips_stream_u8(s, &ay->addr);
+    chips_stream_bytes(s, ay->reg, AY38910_NUM_REGISTERS);
+    for (int i = 0; i < AY38910_NUM_CHANNELS; i++) {
+        ay38910_tone_t* tone = &ay->tone[i];
+        chips_stream_u16(s, &tone->period);
+        chips_stream_u16(s, &tone->counter);
+        chips_stream_u32(s, &tone->bit);
+        chips_stream_u32(s, &tone->tone_disable);
+        chips_stream_u32(s, &tone->noise_disable);
+    }
+    chips_stream_u16(s, &ay->noise.period);
+    chips_stream_u16(s, &ay->noise.counter);
+    chips_stream_u32(s, &ay->noise.rng);
+    chips_stream_u32(s, &ay->noise.bit);
+    chips_stream_u16(s, &ay->env.period);
+    chips_stream_u16(s, &ay->env.counter);
+    chips_stream_bool(s, &ay->env.shape_holding);
+    chips_stream_bool(s, &ay->env.shape_hold);
+    chips_stream_u8(s, &ay->env.shape_counter);
+    chips_stream_u8(s, &ay->env.shape_state);
+    chips_stream_u64(s, &ay->pins);
+    chips_stream_int(s, &ay->sample_period);
+    chips_stream_int(s, &ay->sample_counter);
+    chips_stream_float(s, &ay->mag);
+    #if defined(CHIPS_BLIP)
+    chips_stream_float(s, &ay->level);
+    chips_stream_float(s, &ay->sample);
+    blip_serialize(&ay->blip, s);
+    #else
+    chips_stream_float(s, &ay->sample);
+    chips_stream_float(s, &ay->dcadj_sum);
+    chips_stream_u32(s, &ay->dcadj_pos);
+    for (int i = 0; i < AY38910_DCADJ_BUFLEN; i++) {
+        chips_stream_float(s, &ay->dcadj_buf[i]);
+    }
+    #endif
+}
+#endif
 #endif /* CHIPS_IMPL */
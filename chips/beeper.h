@@ -2,7 +2,21 @@
 /*
     beeper.h    -- simple square-wave beeper
 
-    TODO: docs
+    Do this:
+        #define CHIPS_IMPL
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    By default the output samples are generated by averaging the beeper
+    level over each sample period with a moving-average DC filter.
+
+    Optionally define CHIPS_BLIP before including beeper.h to generate
+    the output samples through band-limited step synthesis instead (see
+    blip.h), the beeper output is then only updated when the beeper state
+    or volume changes. In this case you need to include the following
+    headers before including beeper.h:
+
+    - chips/blip.h
 
     ## zlib/libpng license
 
@@ -31,8 +45,10 @@ extern "C" {
 
 // error-accumulation precision boost
 #define BEEPER_FIXEDPOINT_SCALE (16)
+#if !defined(CHIPS_BLIP)
 // DC adjust buffer size
 #define BEEPER_DCADJ_BUFLEN (128)
+#endif
 
 // initialization parameters
 typedef struct {
@@ -48,30 +64,58 @@ typedef struct {
     int counter;
     float base_volume;
     float volume;
+#if defined(CHIPS_BLIP)
+    float level;        // current output level
+    float sample;
+    blip_t blip;
+#else
     float sample;
     float dcadj_sum;
     uint32_t dcadj_pos;
     float dcadj_buf[BEEPER_DCADJ_BUFLEN];
+#endif
 } beeper_t;
 
 // initialize beeper instance
 void beeper_init(beeper_t* beeper, const beeper_desc_t* desc);
 // reset the beeper instance
 void beeper_reset(beeper_t* beeper);
+// report an output level change to the band-limited step synthesis (called by the functions below)
+static inline void beeper_update_level(beeper_t* beeper) {
+#if defined(CHIPS_BLIP)
+    const float level = (float)beeper->state * beeper->volume * beeper->base_volume;
+    if (level != beeper->level) {
+        blip_add_delta(&beeper->blip, blip_phase(beeper->counter, beeper->period), level - beeper->level);
+        beeper->level = level;
+    }
+#else
+    (void)beeper;
+#endif
+}
 // set current on/off state
 static inline void beeper_set(beeper_t* beeper, bool state) {
-    beeper->state = state ? 1 : 0;
+    const int new_state = state ? 1 : 0;
+    if (new_state != beeper->state) {
+        beeper->state = new_state;
+        beeper_update_level(beeper);
+    }
 }
 // toggle current state (on->off or off->on)
 static inline void beeper_toggle(beeper_t* beeper) {
     beeper->state = !beeper->state;
+    beeper_update_level(beeper);
 }
 // set current volume 0.0 to 1.0
 static inline void beeper_set_volume(beeper_t* beeper, float vol) {
     beeper->volume = vol;
+    beeper_update_level(beeper);
 }
 // tick the beeper, return true if a new sample is ready
 bool beeper_tick(beeper_t* beeper);
+#if defined(CHIPS_FOURCC)
+// write beeper_t state to a stream or read it from a stream (needs chips_common.h)
+void beeper_serialize(beeper_t* beeper, chips_stream_t* stream);
+#endif
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -89,19 +133,27 @@ void beeper_init(beeper_t* b, const beeper_desc_t* desc) {
     CHIPS_ASSERT((desc->tick_hz > 0) && (desc->sound_hz > 0));
     *b = (beeper_t){
         .period = (desc->tick_hz * BEEPER_FIXEDPOINT_SCALE) / desc->sound_hz,
-        .counter = b->period,
         .base_volume = desc->base_volume,
         .volume = 1.0f,
     };
+    b->counter = b->period;
+    #if defined(CHIPS_BLIP)
+    blip_init(&b->blip);
+    #endif
 }
 
 void beeper_reset(beeper_t* b) {
     CHIPS_ASSERT(b);
     b->state = 0;
     b->counter = b->period;
-    b->sample = 0;
+    b->sample = 0.0f;
+    #if defined(CHIPS_BLIP)
+    b->level = 0.0f;
+    blip_init(&b->blip);
+    #endif
 }
 
+#if !defined(CHIPS_BLIP)
 /* DC adjustment filter from StSound, this moves an "offcenter"
    signal back to the zero-line (e.g. the volume-level output
    from the chip simulation which is >0.0 gets converted to
@@ -113,18 +165,55 @@ static void _beeper_dcadjust(beeper_t* bp, float s) {
     bp->dcadj_buf[bp->dcadj_pos] = s;
     bp->dcadj_pos = (bp->dcadj_pos + 1) & (BEEPER_DCADJ_BUFLEN-1);
 }
+#endif
 
 bool beeper_tick(beeper_t* bp) {
+    #if !defined(CHIPS_BLIP)
     _beeper_dcadjust(bp, (float)bp->state * bp->volume * bp->base_volume);
+    #endif
     /* generate a new sample? */
     bp->counter -= BEEPER_FIXEDPOINT_SCALE;
     if (bp->counter <= 0) {
         bp->counter += bp->period;
+        #if defined(CHIPS_BLIP)
+        bp->sample = blip_next_sample(&bp->blip);
+        #else
         bp->sample = bp->dcadj_sum / BEEPER_DCADJ_BUFLEN;
+        #endif
         return true;
     }
     return false;
 }
 
+#if defined(CHIPS_FOURCC)
+void beeper_serialize(beeper_t* bp, chips_stream_t* s) {
+    CHIPS_ASSERT(bp && s);
+    #if defined(CHIPS_BLIP)
+    const uint32_t version = 2;
+    #else
+    const uint32_t version = 1;
+    #endif
+    if (!chips_stream_begin(s, CHIPS_FOURCC('B','E','E','P'), version)) {
+        return;
+    }
+    chips_stream_int(s, &bp->state);
+    chips_stream_int(s, &bp->period);
+    chips_stream_int(s, &bp->counter);
+    chips_stream_float(s, &bp->base_volume);
+    chips_stream_float(s, &bp->volume);
+    #if defined(CHIPS_BLIP)
+    chips_stream_float(s, &bp->level);
+    chips_stream_float(s, &bp->sample);
+    blip_serialize(&bp->blip, s);
+    #else
+    chips_stream_float(s, &bp->sample);
+    chips_stream_float(s, &bp->dcadj_sum);
+    chips_stream_u32(s, &bp->dcadj_pos);
+    for (int i = 0; i < BEEPER_DCADJ_BUFLEN; i++) {
+        chips_stream_float(s, &bp->dcadj_buf[i]);
+    }
+    #endif
+}
+#endif
 
 #endif /* CHIPS_IMPL */
@@ -0,0 +1,189 @@
+#pragma once
+/*
+    blip.h  -- band-limited step synthesis for square-wave sound chips
+
+    Do this:
+        #define CHIPS_IMPL
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Optionally provide the following macros with your own implementation
+
+    CHIPS_ASSERT(c)     -- your own assert macro (default: assert(c))
+
+    Sound chips which produce a piecewise-constant output signal (like the
+    beeper and the AY-3-8910) don't need to compute and average their output
+    level on every emulated tick. Instead they only report the *changes* of
+    their output level to a blip_t instance, together with the position of
+    the change between two output samples. The blip_t adds a band-limited
+    step (an integrated windowed sinc) into a small buffer of output samples
+    for each change, and the host-rate output samples are obtained by
+    integrating that buffer, followed by a simple DC-blocking filter. This
+    removes the aliasing of the box-filter approach, and the per-tick work
+    in the chip emulators is reduced to integer counting.
+
+    The step kernels are precomputed for BLIP_PHASES sub-sample positions
+    and are BLIP_TAPS output samples wide, which results in an output
+    latency of BLIP_TAPS/2 samples.
+
+    The beeper and AY-3-8910 emulators only use blip.h when CHIPS_BLIP
+    is defined, otherwise they keep their box-filter output and blip.h
+    doesn't need to be included.
+
+    ## zlib/libpng license
+
+    Copyright (c) 2018 Andre Weissflog
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// number of sub-sample step positions
+#define BLIP_PHASES (32)
+// width of a band-limited step in output samples
+#define BLIP_TAPS (16)
+// DC blocking filter coefficient (about 35 Hz at 44.1 kHz)
+#define BLIP_DCBLOCK (0.995f)
+
+// band-limited step synthesis state
+typedef struct {
+    int pos;                        // read position in buf
+    float accum;                    // integrated output level
+    float dc_in;                    // DC blocker filter state
+    float dc_out;
+    float buf[2 * BLIP_TAPS];       // pending step deltas, the upper half avoids wrap-around in blip_add_delta()
+} blip_t;
+
+// initialize or reset a blip_t instance
+void blip_init(blip_t* blip);
+// add an output level change at a sub-sample position (0 = just after the previous sample, BLIP_PHASES-1 = just before the next sample)
+void blip_add_delta(blip_t* blip, int phase, float delta);
+// get the next output sample
+float blip_next_sample(blip_t* blip);
+// compute the step phase from a chip's fixed-point sample counter and sample period
+static inline int blip_phase(int sample_counter, int sample_period) {
+    int phase = ((sample_period - sample_counter) * BLIP_PHASES) / sample_period;
+    return (phase < 0) ? 0 : ((phase >= BLIP_PHASES) ? (BLIP_PHASES - 1) : phase);
+}
+#if defined(CHIPS_FOURCC)
+// write blip_t state to a stream or read it from a stream (needs chips_common.h)
+void blip_serialize(blip_t* blip, chips_stream_t* stream);
+#endif
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_IMPL
+#include <string.h>
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+/* Blackman-windowed sinc steps with a cutoff at 0.45 times the sample rate,
+   one row per sub-sample phase, each row sums up to 1.0
+*/
+static const float _blip_steps[BLIP_PHASES][BLIP_TAPS] = {
+    { 0.00017331f, -0.00099008f, 0.00189697f, -0.00050521f, -0.00871339f, 0.03585009f, -0.10580969f, 0.56403602f, 0.58927330f, -0.10066157f, 0.03210062f, -0.00642138f, -0.00165149f, 0.00234399f, -0.00111163f, 0.00019012f },
+    { 0.00015671f, -0.00087048f, 0.00146349f, 0.00058319f, -0.01082640f, 0.03913688f, -0.10976187f, 0.53797085f, 0.61356733f, -0.09428181f, 0.02789801f, -0.00396148f, -0.00284861f, 0.00280122f, -0.00123395f, 0.00020692f },
+    { 0.00014052f, -0.00075386f, 0.00104657f, 0.00160751f, -0.01275132f, 0.04195558f, -0.11255940f, 0.51119584f, 0.63680608f, -0.08664073f, 0.02325603f, -0.00134682f, -0.00408864f, 0.00326496f, -0.00135577f, 0.00022345f },
+    { 0.00012492f, -0.00064118f, 0.00064888f, 0.00256246f, -0.01448104f, 0.04430474f, -0.11424875f, 0.48383103f, 0.65888155f, -0.07771497f, 0.01819272f, 0.00140750f, -0.00536286f, 0.00373125f, -0.00147571f, 0.00023945f },
+    { 0.00011005f, -0.00053323f, 0.00027274f, 0.00344363f, -0.01601042f, 0.04618674f, -0.11488113f, 0.45599771f, 0.67969045f, -0.06748785f, 0.01273050f, 0.00428443f, -0.00666174f, 0.00419583f, -0.00159228f, 0.00025459f },
+    { 0.00009604f, -0.00043073f, -0.00007989f, 0.00424747f, -0.01733627f, 0.04760760f, -0.11451205f, 0.42781777f, 0.69913477f, -0.05594966f, 0.00689616f, 0.00726503f, -0.00797501f, 0.00465418f, -0.00170394f, 0.00026852f },
+    { 0.00008296f, -0.00033423f, -0.00040737f, 0.00497134f, -0.01845723f, 0.04857677f, -0.11320081f, 0.39941296f, 0.71712242f, -0.04309788f, 0.00072084f, 0.01032857f, -0.00929175f, 0.00510154f, -0.00180904f, 0.00028088f },
+    { 0.00007090f, -0.00024420f, -0.00070843f, 0.00561341f, -0.01937375f, 0.04910692f, -0.11101003f, 0.37090422f, 0.73356779f, -0.02893740f, -0.00576002f, 0.01345260f, -0.01060038f, 0.00553297f, -0.00190587f, 0.00029126f },
+    { 0.00005989f, -0.00016100f, -0.00098212f, 0.00617268f, -0.02008796f, 0.04921367f, -0.10800510f, 0.34241095f, 0.74839225f, -0.01348064f, -0.01250675f, 0.01661305f, -0.01188881f, 0.00594336f, -0.00199270f, 0.00029924f },
+    { 0.00004996f, -0.00008486f, -0.00122782f, 0.00664893f, -0.02060364f, 0.04891538f, -0.10425376f, 0.31405043f, 0.76152463f, 0.00325227f, -0.01947558f, 0.01978445f, -0.01314449f, 0.00632749f, -0.00206774f, 0.00030436f },
+    { 0.00004110f, -0.00001593f, -0.00144521f, 0.00704271f, -0.02092604f, 0.04823286f, -0.09982549f, 0.28593708f, 0.77290170f, 0.02123350f, -0.02661880f, 0.02293998f, -0.01435451f, 0.00668005f, -0.00212920f, 0.00030618f },
+    { 0.00003330f, 0.00004576f, -0.00163426f, 0.00735524f, -0.02106181f, 0.04718910f, -0.09479108f, 0.25818192f, 0.78246852f, 0.04042749f, -0.03388491f, 0.02605173f, -0.01550567f, 0.00699574f, -0.00217530f, 0.00030423f },
+    { 0.00002651f, 0.00010024f, -0.00179523f, 0.00758842f, -0.02101887f, 0.04580900f, -0.08922206f, 0.23089195f, 0.79017878f, 0.06079097f, -0.04121889f, 0.02909081f, -0.01658465f, 0.00726924f, -0.00220427f, 0.00029805f },
+    { 0.00002069f, 0.00014764f, -0.00192862f, 0.00774473f, -0.02080626f, 0.04411908f, -0.08319026f, 0.20416957f, 0.79599512f, 0.08227308f, -0.04856244f, 0.03202764f, -0.01757808f, 0.00749534f, -0.00221441f, 0.00028717f },
+    { 0.00001579f, 0.00018814f, -0.00203516f, 0.00782721f, -0.02043406f, 0.04214720f, -0.07676729f, 0.17811212f, 0.79988930f, 0.10481549f, -0.05585424f, 0.03483211f, -0.01847266f, 0.00766895f, -0.00220405f, 0.00027115f },
+    { 0.00001172f, 0.00022201f, -0.00211580f, 0.00783938f, -0.01991320f, 0.03992226f, -0.07002410f, 0.15281136f, 0.80184245f, 0.12835262f, -0.06303031f, 0.03747383f, -0.01925531f, 0.00778519f, -0.00217167f, 0.00024956f },
+    { 0.00000842f, 0.00024956f, -0.00217167f, 0.00778521f, -0.01925537f, 0.03747395f, -0.06303051f, 0.12835304f, 0.80184510f, 0.15281186f, -0.07002433f, 0.03992239f, -0.01991327f, 0.00783941f, -0.00211581f, 0.00022201f },
+    { 0.00000580f, 0.00027115f, -0.00220408f, 0.00766903f, -0.01847284f, 0.03483246f, -0.05585479f, 0.10481654f, 0.79989730f, 0.17811390f, -0.07676806f, 0.04214762f, -0.02043426f, 0.00782728f, -0.00203518f, 0.00018814f },
+    { 0.00000378f, 0.00028717f, -0.00221444f, 0.00749546f, -0.01757838f, 0.03202818f, -0.04856326f, 0.08227447f, 0.79600858f, 0.20417302f, -0.08319166f, 0.04411983f, -0.02080661f, 0.00774486f, -0.00192865f, 0.00014764f },
+    { 0.00000227f, 0.00029805f, -0.00220433f, 0.00726941f, -0.01658505f, 0.02909152f, -0.04121989f, 0.06079245f, 0.79019794f, 0.23089754f, -0.08922422f, 0.04581011f, -0.02101937f, 0.00758860f, -0.00179527f, 0.00010024f },
+    { 0.00000119f, 0.00030424f, -0.00217537f, 0.00699596f, -0.01550617f, 0.02605256f, -0.03388599f, 0.04042879f, 0.78249364f, 0.25819021f, -0.09479412f, 0.04719062f, -0.02106249f, 0.00735548f, -0.00163431f, 0.00004576f },
+    { 0.00000046f, 0.00030619f, -0.00212929f, 0.00668033f, -0.01435509f, 0.02294092f, -0.02661988f, 0.02123437f, 0.77293311f, 0.28594870f, -0.09982955f, 0.04823482f, -0.02092689f, 0.00704300f, -0.00144527f, -0.00001593f },
+    { 0.00000002f, 0.00030438f, -0.00206784f, 0.00632780f, -0.01314515f, 0.01978544f, -0.01947655f, 0.00325243f, 0.76156266f, 0.31406611f, -0.10425897f, 0.04891783f, -0.02060467f, 0.00664927f, -0.00122788f, -0.00008487f },
+    { -0.00000022f, 0.00029925f, -0.00199282f, 0.00594372f, -0.01188953f, 0.01661405f, -0.01250750f, -0.01348145f, 0.74843724f, 0.34243154f, -0.10801160f, 0.04921663f, -0.02008917f, 0.00617305f, -0.00098218f, -0.00016101f },
+    { -0.00000031f, 0.00029128f, -0.00190601f, 0.00553336f, -0.01060113f, 0.01345355f, -0.00576043f, -0.02893946f, 0.73362004f, 0.37093063f, -0.11101793f, 0.04911042f, -0.01937513f, 0.00561381f, -0.00070848f, -0.00024422f },
+    { -0.00000031f, 0.00028091f, -0.00180919f, 0.00510197f, -0.00929252f, 0.01032943f, 0.00072090f, -0.04310147f, 0.71718214f, 0.39944623f, -0.11321024f, 0.04858082f, -0.01845877f, 0.00497176f, -0.00040740f, -0.00033426f },
+    { -0.00000025f, 0.00026855f, -0.00170410f, 0.00465463f, -0.00797578f, 0.00726573f, 0.00689683f, -0.05595505f, 0.69920209f, 0.42785897f, -0.11452308f, 0.04761219f, -0.01733794f, 0.00424788f, -0.00007990f, -0.00043077f },
+    { -0.00000017f, 0.00025462f, -0.00159246f, 0.00419630f, -0.00666247f, 0.00428490f, 0.01273190f, -0.06749529f, 0.67976537f, 0.45604798f, -0.11489379f, 0.04619183f, -0.01601219f, 0.00344401f, 0.00027277f, -0.00053329f },
+    { -0.00000009f, 0.00023948f, -0.00147589f, 0.00373172f, -0.00536353f, 0.00140767f, 0.01819499f, -0.07772468f, 0.65896393f, 0.48389152f, -0.11426303f, 0.04431028f, -0.01448285f, 0.00256278f, 0.00064896f, -0.00064126f },
+    { -0.00000004f, 0.00022349f, -0.00135596f, 0.00326542f, -0.00408922f, -0.00134701f, 0.02325930f, -0.08665291f, 0.63689560f, 0.51126771f, -0.11257522f, 0.04196148f, -0.01275311f, 0.00160773f, 0.00104672f, -0.00075397f },
+    { -0.00000001f, 0.00020695f, -0.00123414f, 0.00280165f, -0.00284905f, -0.00396210f, 0.02790239f, -0.09429659f, 0.61366351f, 0.53805517f, -0.10977908f, 0.03914302f, -0.01082810f, 0.00058328f, 0.00146372f, -0.00087061f },
+    { -0.00000000f, 0.00019016f, -0.00111182f, 0.00234440f, -0.00165178f, -0.00642249f, 0.03210619f, -0.10067902f, 0.58937545f, 0.56413379f, -0.10582803f, 0.03585630f, -0.00871490f, -0.00050530f, 0.00189730f, -0.00099025f },
+};
+
+void blip_init(blip_t* blip) {
+    CHIPS_ASSERT(blip);
+    memset(blip, 0, sizeof(blip_t));
+}
+
+void blip_add_delta(blip_t* blip, int phase, float delta) {
+    CHIPS_ASSERT((phase >= 0) && (phase < BLIP_PHASES));
+    // contiguous and branch-free, so that the compiler can vectorize this loop
+    float* dst = &blip->buf[blip->pos];
+    const float* step = _blip_steps[phase];
+    for (int i = 0; i < BLIP_TAPS; i++) {
+        dst[i] += step[i] * delta;
+    }
+}
+
+float blip_next_sample(blip_t* blip) {
+    blip->accum += blip->buf[blip->pos++];
+    if (blip->pos == BLIP_TAPS) {
+        // move the upper half down, so that blip_add_delta() never needs to wrap around
+        memcpy(&blip->buf[0], &blip->buf[BLIP_TAPS], BLIP_TAPS * sizeof(float));
+        memset(&blip->buf[BLIP_TAPS], 0, BLIP_TAPS * sizeof(float));
+        blip->pos = 0;
+    }
+    // DC blocker: y[n] = x[n] - x[n-1] + R * y[n-1]
+    blip->dc_out = blip->accum - blip->dc_in + BLIP_DCBLOCK * blip->dc_out;
+    blip->dc_in = blip->accum;
+    return blip->dc_out;
+}
+
+#if defined(CHIPS_FOURCC)
+void blip_serialize(blip_t* blip, chips_stream_t* s) {
+    CHIPS_ASSERT(blip && s);
+    if (!chips_stream_begin(s, CHIPS_FOURCC('B','L','I','P'), 1)) {
+        return;
+    }
+    chips_stream_int(s, &blip->pos);
+    if ((blip->pos < 0) || (blip->pos >= BLIP_TAPS)) {
+        s->failed = true;
+        return;
+    }
+    chips_stream_float(s, &blip->accum);
+    chips_stream_float(s, &blip->dc_in);
+    chips_stream_float(s, &blip->dc_out);
+    for (int i = 0; i < 2 * BLIP_TAPS; i++) {
+        chips_stream_float(s, &blip->buf[i]);
+    }
+}
+#endif
+
+#endif /* CHIPS_IMPL */
@@ -4,6 +4,363 @@
 
     Common data types for chips system headers.
 
+    ## Delta Snapshots
+
+    chips_delta_encode() compares a snapshot against a base snapshot of the
+    same size in blocks of CHIPS_DELTA_BLOCK_SIZE bytes (the same size as
+    a mem.h memory page) and only writes the changed blocks to the
+    destination buffer. chips_delta_apply() patches the changed blocks into
+    a copy of the base snapshot, which results in the original snapshot.
+
+    The encoded delta starts with a chips_delta_header_t, followed by
+    'num_blocks' records, each record is a 32-bit block index followed by
+    the block data (the last block of a snapshot may be shorter than
+    CHIPS_DELTA_BLOCK_SIZE).
+
+    chips_delta_encode_ram() does the same, but takes the content of a RAM
+    range inside the snapshot from the live RAM of the system, and only
+    looks at the RAM pages which have been marked as written in a bit mask
+    (the other RAM pages are assumed to be unchanged since the base snapshot).
+    This way the RAM doesn't need to be copied or compared as a whole.
+
+    The system emulators wrap this in functions called
+    xxx_save_snapshot_delta() and xxx_apply_snapshot_delta(), the written
+    RAM pages are gathered through the access tracking in mem.h (see
+    'Access Tracking' in mem.h).
+
+    ## Snapshot Files
+
+    Snapshots are raw struct images which contain long runs of zeros and
+    repeated data, chips_snapshot_pack() compresses a snapshot into a
+    self-contained container for storing on disk or sending over the
+    network, and chips_snapshot_unpack() restores the original snapshot,
+    which can then be loaded with xxx_load_snapshot():
+
+    ~~~C
+    static c64_t snapshot;
+    static uint8_t buf[CHIPS_SNAPSHOT_MAX_PACKED_SIZE(sizeof(c64_t))];
+    const uint32_t version = c64_save_snapshot(&sys, &snapshot);
+    const size_t size = chips_snapshot_pack(CHIPS_FOURCC('C','6','4',' '), version,
+        (chips_range_t){ .ptr = &snapshot, .size = C64_SNAPSHOT_SIZE },
+        (chips_range_t){ .ptr = buf, .size = sizeof(buf) });
+    ...
+    chips_snapshot_header_t hdr;
+    if (chips_snapshot_header((chips_range_t){ buf, size }, &hdr) &&
+        (hdr.system == CHIPS_FOURCC('C','6','4',' ')) &&
+        chips_snapshot_unpack((chips_range_t){ buf, size }, (chips_range_t){ &snapshot, sizeof(snapshot) }))
+    {
+        c64_load_snapshot(&sys, hdr.version, &snapshot);
+    }
+    ~~~
+
+    The container starts with a header of CHIPS_SNAPSHOT_HEADER_SIZE bytes
+    (all values are 32-bit little-endian):
+
+    - magic: CHIPS_SNAPSHOT_MAGIC ('CHSN')
+    - system: a caller-provided system type, usually a FOURCC code
+    - version: the snapshot version returned by xxx_save_snapshot()
+    - size: size of the unpacked snapshot in bytes
+    - packed_size: size of the compressed data following the header
+    - checksum: FNV-1a hash of the unpacked snapshot
+
+    The compressed data is a sequence of byte-aligned tokens, each starting
+    with a control byte:
+
+    - 0x00..0x7F: (c+1) literal bytes follow
+    - 0x80..0xBF: run of (c&0x3F)+3 copies of the byte that follows
+    - 0xC0..0xFF: copy (c&0x3F)+4 bytes from a previous position, followed
+      by a 16-bit little-endian distance
+
+    If the lower 6 bits of a run or copy control byte are all set, more
+    length bytes follow the control byte, each adding its value to the
+    length, until a byte less than 255 ends the length. A compressed
+    snapshot is never bigger than CHIPS_SNAPSHOT_MAX_PACKED_SIZE(size)
+    bytes. The compressor needs no dynamic memory, and both functions
+    work directly in caller-provided buffers.
+
+    ## Snapshot Streams
+
+    A chips_stream_t serializes emulator state into a flat byte stream in
+    a caller-provided buffer. Unlike the struct-copy snapshots, the stream
+    contains no pointers and no padding, all values are stored in
+    little-endian byte order, so a stream can be loaded by a program built
+    with a different compiler or for a different CPU architecture.
+
+    The same function is used for writing and reading, depending on how the
+    stream was created:
+
+    ~~~C
+    chips_stream_t s = chips_stream_writer(buffer);
+    chips_stream_t s = chips_stream_reader(buffer);
+    ~~~
+
+    The chip emulators provide xxx_serialize() functions (for instance
+    z80_serialize(), m6502_serialize() or ay38910_serialize()) which
+    start with a chunk tag and chunk version written by
+    chips_stream_begin(). When reading, a mismatching tag or version, or
+    reading past the end of the buffer sets the 'failed' flag, after that
+    all further stream operations are ignored. Callbacks, user data
+    pointers and memory mapping pointers are not part of the stream and
+    remain unchanged in the target struct.
+
+    The serializers are only available when chips_common.h is included
+    before the chip headers.
+
+    The system emulators wrap this in functions called
+    xxx_save_stream() and xxx_load_stream().
+
+    ## Asynchronous Snapshots
+
+    Copying a whole system struct into a snapshot can take long enough to
+    cause a visible hitch when many instances are saved periodically. An
+    asynchronous snapshot splits this into two parts:
+
+    - the emulator thread copies everything except the large RAM areas
+      into the snapshot (this is usually just a few KBytes of chip state),
+      and 'freezes' the RAM pages in a chips_async_snapshot_t
+    - a background thread copies the frozen RAM pages into the snapshot
+      with chips_async_snapshot_run() while the emulation continues, and
+      may then compress or serialize the finished snapshot
+
+    Before the emulation writes to a RAM page which hasn't been copied yet,
+    it copies the page into the snapshot itself (copy-on-write), so the
+    snapshot contains the RAM content at the time the snapshot was started.
+    Each page is copied exactly once, either by the emulator thread or by
+    the background thread, page ownership is taken with an atomic
+    compare-and-swap. If the emulation writes to a page which the
+    background thread is copying at that moment, the emulator thread waits
+    for the copy to finish (this takes less than a microsecond).
+
+    The system emulators wrap this in functions called
+    xxx_save_snapshot_async() and xxx_finish_snapshot_async(), see the
+    system headers for details.
+
+    ## Audio Ring Buffers
+
+    Instead of receiving audio samples through the audio callback in small
+    packets, the host can provide a chips_audio_ring_t in the audio
+    descriptor (chips_audio_desc_t.ring). The system emulators then write
+    each sample directly into the ring buffer memory, and the audio thread
+    reads the samples directly from there, without callbacks and without
+    copying the samples into an intermediate buffer.
+
+    The ring buffer is a lock-free single-producer/single-consumer queue:
+    the emulator thread only writes 'write_pos', the audio thread only
+    writes 'read_pos'. Both positions are free-running counters, the
+    number of samples in the ring buffer is 'write_pos - read_pos'. When
+    the ring buffer is full, new samples are dropped (and counted in
+    'dropped'), the emulator never waits for the audio thread.
+
+    Consuming samples on the audio thread:
+
+    ~~~C
+    uint32_t num_samples;
+    const float* samples = chips_audio_ring_begin_read(ring, &num_samples);
+    ...
+    chips_audio_ring_end_read(ring, num_samples);
+    ~~~
+
+    chips_audio_ring_begin_read() only returns the contiguous part of the
+    available samples, so call it again after wrapping around the end of
+    the ring buffer memory.
+
+    ## Audio Register Logs
+
+    Sound chips which only depend on the register values written by the
+    CPU can be emulated on a separate audio thread. Instead of ticking the
+    sound chip, the emulator thread then only appends timestamped register
+    writes to a chips_audio_log_t, and the audio thread replays the
+    register writes at the same system tick while running the sound chip
+    emulation and writing the generated samples into the audio ring
+    buffer or audio callback. See the system headers for which systems
+    support this (e.g. 'Audio Thread' in namco.h).
+
+    Like the audio ring buffer, the register log is a lock-free
+    single-producer/single-consumer queue of chips_audio_event_t items.
+    Additionally, the emulator thread publishes the system tick up to
+    which all register writes have been pushed in 'horizon' (usually at
+    the end of each xxx_exec() call), the audio thread must not run the
+    sound chip beyond this tick. Register writes must not be lost, so when
+    the log is full the emulator thread publishes the current tick and
+    waits for the audio thread (this is counted in 'stalls').
+
+    Consuming register writes on the audio thread:
+
+    ~~~C
+    const uint32_t horizon = chips_audio_log_horizon(log);
+    for (;;) {
+        const chips_audio_event_t* ev;
+        while ((ev = chips_audio_log_peek(log)) && (ev->tick == tick)) {
+            // ...write ev->value to sound chip register ev->reg
+            chips_audio_log_pop(log);
+        }
+        if (tick == horizon) {
+            break;
+        }
+        // ...tick the sound chip
+        tick++;
+    }
+    ~~~
+
+    The register writes of the horizon tick itself must be consumed too,
+    otherwise the emulator thread may wait forever on a full log.
+
+    ## Running the Emulation
+
+    The system emulators can be driven in three ways:
+
+    - xxx_exec(sys, micro_seconds) runs the emulation for the host's frame
+      duration, the fractional tick left over by converting micro-seconds
+      to ticks is carried over to the next call (see clk_us_to_ticks_frac()
+      in clk.h), so that the emulation doesn't drift against the host clock
+    - xxx_exec_ticks(sys, num_ticks) runs the emulation for an exact number
+      of system ticks
+    - xxx_exec_frame(sys) runs the emulation until the video hardware
+      starts the next frame (usually the vertical sync of the video chip),
+      a host can present the framebuffer immediately after the call, which
+      decouples the emulated frame rate from the host's display refresh
+      rate and avoids the extra latency of a partially emulated frame
+
+    All three functions return the number of executed ticks. Systems without
+    a video frame timing (e.g. the LC-80, Z1013 and Z9001) don't have an
+    xxx_exec_frame() function.
+
+    ## Automatic Warp Mode
+
+    Systems with a tape or disc drive can be configured to run faster than
+    real time while the drive is active (for instance while the tape motor
+    is switched on) by setting chips_warp_desc_t.enabled in the system's
+    desc struct to true. In warp mode, each xxx_exec() call runs the
+    requested time slice at normal speed with audio and video output, and
+    then up to 'max_slices - 1' additional time slices with video decoding
+    switched off and without audio output. As soon as the drive is no longer
+    active, the system continues in real time.
+
+    Since the audio output only sees the first time slice of each
+    xxx_exec() call, the audio stream continues without gaps in the host's
+    audio buffer, and there is no audible glitch when warp mode ends.
+
+    'max_slices' limits how much emulation work is done per host frame, the
+    host should lower it if the emulator can't run that fast on the host
+    machine (the default is CHIPS_DEFAULT_WARP_SLICES).
+
+    ## Text Input
+
+    Entering text by simulating key presses (xxx_key_down() and
+    xxx_key_up()) needs several emulated frames per character because the
+    ROM's keyboard scanning must observe each key in its pressed and
+    released state. Systems with a keyboard buffer or a keyboard input
+    routine in ROM can instead feed text directly into the ROM's keyboard
+    input as fast as the ROM consumes it (e.g. c64_input_text()), so that
+    a long BASIC listing is only limited by how fast the ROM processes
+    each character.
+
+    The system keeps a chips_text_input_t with a pointer to the text,
+    the text is not copied and must remain valid until the input has been
+    consumed (or until the system is reset or a snapshot is loaded, which
+    discards any pending text input). Pending text input is not part of
+    snapshots.
+
+    Newlines ('\n') are converted to the RETURN key code 0x0D, and carriage
+    returns ('\r') are skipped so that both Unix and Windows line endings
+    work; all other bytes are passed through unchanged, apart from system
+    specific conversions (see the system headers).
+
+    ## Dirty Lines
+
+    Some system emulators track which framebuffer lines have actually
+    changed during the last xxx_exec() call, this information is returned
+    by xxx_display_info() in chips_display_info_t.dirty_lines (which is
+    null if a system doesn't track dirty lines). The host can use this to
+    only upload the changed parts of the framebuffer into a texture, or
+    to skip unchanged frames when encoding video:
+
+    ~~~C
+    const chips_display_info_t info = zx_display_info(&sys);
+    int y = 0, num_lines;
+    while ((num_lines = chips_dirty_lines_run(info.dirty_lines, &y, info.frame.dim.height)) > 0) {
+        // upload framebuffer lines y .. y+num_lines-1
+        ...
+        y += num_lines;
+    }
+    ~~~
+
+    The dirty line bitmap is cleared at the start of each xxx_exec() call,
+    so the host must look at it after each call. A line is only flagged if
+    at least one of its pixels has been written with a different value.
+
+    ## Debug Callback Filter
+
+    By default, the system emulators call the debug callback in
+    chips_debug_t after each tick. When chips_debug_t.filter points to a
+    chips_debug_filter_t, the callback is only called when needed:
+
+    - on every tick if CHIPS_DEBUG_FILTER_TICK is set in 'flags'
+    - at every instruction boundary (Z80 opcode fetch or M6502 SYNC) if
+      CHIPS_DEBUG_FILTER_OP is set in 'flags'
+    - at an instruction boundary if the instruction address is set in the
+      'exec' bitmap
+    - on a memory read or write access to an address set in the
+      'read' or 'write' bitmap
+
+    The filter is owned by the debugger (for instance ui_dbg.h), which
+    updates the flags and bitmaps when breakpoints or the step mode
+    change. The systems only test a few bits per tick inline, and
+    increment the 'ticks' counter, so that the debugger can find out how
+    many ticks have passed since the last callback.
+
+    ## Statistics
+
+    Define CHIPS_STATS before including the chips headers to enable
+    statistics counters in the system tick functions and some chips
+    (for instance m6569.h and am40010.h). The counters are reset at the
+    start of each xxx_exec() call (usually once per frame), and can be
+    read with xxx_stats() afterwards. Without CHIPS_STATS the counters
+    stay at zero and the tick functions don't contain any instrumentation
+    code.
+
+    ## Hardware Event Timeline
+
+    Define CHIPS_EVENTS before including the chips headers to let the
+    system tick functions record a timeline of hardware events into a
+    host-provided chips_event_ring_t (see the system headers for which
+    systems support this, e.g. 'Hardware Event Timeline' in c64.h):
+
+    - CHIPS_EVENT_IRQ and CHIPS_EVENT_NMI when the CPU interrupt lines
+      change, with the new line level in 'data'
+    - CHIPS_EVENT_VSYNC at the start of each video frame
+    - CHIPS_EVENT_RASTER_IRQ when a video chip requests a raster
+      interrupt, with the raster line in 'addr'
+    - CHIPS_EVENT_TIMER on counter/timer underflows, with a
+      system-specific timer index in 'addr'
+    - CHIPS_EVENT_SOUND_REG on sound chip register writes, with the
+      register index in 'addr' and the written value in 'data'
+    - CHIPS_EVENT_MEMORY_MAP when the memory mapping is updated, with a
+      system-specific memory configuration value in 'data'
+
+    Each event is timestamped with the ring's free-running 'tick' counter,
+    which the system increments on every tick (CPU ticks in overclock
+    mode). The ring buffer is not thread-safe, it's usually drained on the
+    emulator thread after each xxx_exec() call (for instance by the
+    Chrome trace exporter in util/timeline.h). When the ring is full, the
+    oldest events are overwritten (this is counted in 'dropped').
+
+    ~~~C
+    static chips_event_t events[4096];
+    static chips_event_ring_t ring;
+    chips_event_ring_init(&ring, events, 4096);
+    c64_init(&sys, &(c64_desc_t){ .events = &ring, ... });
+    ...
+    c64_exec(&sys, frame_time_us);
+    const chips_event_t* ev;
+    while ((ev = chips_event_ring_next(&ring))) {
+        // ...
+    }
+    ~~~
+
+    Without CHIPS_EVENTS, the tick functions don't contain any event
+    recording code and the ring stays empty.
+
     ## zlib/libpng license
 
     Copyright (c) 2018 Andre Weissflog
@@ -25,11 +382,19 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#if defined(_MSC_VER)
+#include <intrin.h> // _InterlockedOr, _InterlockedExchange, _InterlockedCompareExchange
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// delta snapshot block size (same as mem.h page size)
+#define CHIPS_DELTA_BLOCK_SIZE (1024)
+// max size of an encoded delta for a snapshot size
+#define CHIPS_DELTA_MAX_SIZE(snapshot_size) (sizeof(chips_delta_header_t) + ((snapshot_size) + CHIPS_DELTA_BLOCK_SIZE - 1) / CHIPS_DELTA_BLOCK_SIZE * (sizeof(uint32_t) + CHIPS_DELTA_BLOCK_SIZE))
+
 typedef struct {
     void* ptr;
     size_t size;
@@ -43,6 +408,14 @@ typedef struct {
     int x, y, width, height;
 } chips_rect_t;
 
+// max number of framebuffer lines in a chips_dirty_lines_t bitmap
+#define CHIPS_DIRTY_MAX_LINES (512)
+
+// a bitmap with one bit per changed framebuffer line (see 'Dirty Lines')
+typedef struct {
+    uint32_t bits[CHIPS_DIRTY_MAX_LINES / 32];
+} chips_dirty_lines_t;
+
 typedef struct {
     struct {
         chips_dim_t dim;        // framebuffer dimensions in pixels
@@ -51,6 +424,7 @@ typedef struct {
     } frame;
     chips_rect_t screen;
     chips_range_t palette;
+    const chips_dirty_lines_t* dirty_lines; // lines changed in the last xxx_exec() call, null if not tracked
     bool portrait;
 } chips_display_info_t;
 
@@ -60,21 +434,415 @@ typedef struct {
 } chips_audio_callback_t;
 
 typedef void (*chips_debug_func_t)(void* user_data, uint64_t pins);
+
+// debug callback filter flags (see 'Debug Callback Filter')
+#define CHIPS_DEBUG_FILTER_TICK (1<<0)  // call the debug callback on every tick
+#define CHIPS_DEBUG_FILTER_OP   (1<<1)  // call the debug callback at every instruction boundary
+
+typedef struct {
+    uint64_t exec[1<<10];   // 64K-bit bitmap of execution breakpoint addresses
+    uint64_t read[1<<10];   // 64K-bit bitmap of memory read breakpoint addresses
+    uint64_t write[1<<10];  // 64K-bit bitmap of memory write breakpoint addresses
+    uint32_t flags;         // CHIPS_DEBUG_FILTER_*
+    uint64_t ticks;         // running tick counter, incremented by chips_debug_filter_hit()
+} chips_debug_filter_t;
+
 typedef struct {
     struct {
         chips_debug_func_t func;
         void* user_data;
     } callback;
     bool* stopped;
+    chips_debug_filter_t* filter;   // optional, if null the callback is called on every tick
 } chips_debug_t;
 
+// a lock-free single-producer/single-consumer audio sample ring buffer (see 'Audio Ring Buffers')
+typedef struct {
+    float* buffer;          // host-provided sample memory
+    uint32_t size;          // number of samples in buffer, must be a power of 2
+    uint32_t write_pos;     // only written by the producer (the emulator thread)
+    uint32_t read_pos;      // only written by the consumer (the audio thread)
+    uint32_t dropped;       // number of samples dropped because the ring buffer was full
+} chips_audio_ring_t;
+
 typedef struct {
     chips_audio_callback_t callback;
+    chips_audio_ring_t* ring;   // optional ring buffer, if set, the callback isn't called
     int num_samples;
     int sample_rate;
     float volume;
 } chips_audio_desc_t;
 
+// a timestamped sound chip register write (see 'Audio Register Logs')
+typedef struct {
+    uint32_t tick;          // free-running system tick of the register write
+    uint16_t reg;           // system-specific register address
+    uint8_t value;          // the written value
+} chips_audio_event_t;
+
+// a lock-free single-producer/single-consumer sound chip register write log (see 'Audio Register Logs')
+typedef struct {
+    chips_audio_event_t* events;    // host-provided event memory
+    uint32_t size;          // number of events, must be a power of 2
+    uint32_t write_pos;     // only written by the producer (the emulator thread)
+    uint32_t read_pos;      // only written by the consumer (the audio thread)
+    uint32_t horizon;       // system tick up to which all register writes have been pushed
+    uint32_t stalls;        // number of times the emulator thread waited because the log was full
+} chips_audio_log_t;
+
+// hardware event types (see 'Hardware Event Timeline')
+#define CHIPS_EVENT_IRQ         (1)     // CPU IRQ/INT line changed, data: new line level
+#define CHIPS_EVENT_NMI         (2)     // CPU NMI line changed, data: new line level
+#define CHIPS_EVENT_VSYNC       (3)     // start of a video frame
+#define CHIPS_EVENT_RASTER_IRQ  (4)     // raster interrupt request, addr: raster line
+#define CHIPS_EVENT_TIMER       (5)     // counter/timer underflow, addr: system-specific timer index
+#define CHIPS_EVENT_SOUND_REG   (6)     // sound chip register write, addr: register, data: value
+#define CHIPS_EVENT_MEMORY_MAP  (7)     // memory mapping updated, data: system-specific memory configuration
+#define CHIPS_EVENT_USER        (0x80)  // first host-defined event type
+
+// a timestamped hardware event (see 'Hardware Event Timeline')
+typedef struct {
+    uint64_t tick;          // value of chips_event_ring_t.tick when the event happened
+    uint16_t type;          // CHIPS_EVENT_*
+    uint16_t addr;          // event-specific address
+    uint32_t data;          // event-specific data
+} chips_event_t;
+
+// a hardware event ring buffer, written by the system tick functions (see 'Hardware Event Timeline')
+typedef struct {
+    chips_event_t* events;  // host-provided event memory
+    uint32_t size;          // number of events, must be a power of 2
+    uint32_t write_pos;
+    uint32_t read_pos;
+    uint32_t dropped;       // number of events overwritten before they were read
+    uint32_t levels;        // last recorded line levels, bits are assigned by the system
+    uint64_t tick;          // free-running tick counter, incremented by the system
+} chips_event_ring_t;
+
+// default max number of xxx_exec() time slices per call in automatic warp mode
+#define CHIPS_DEFAULT_WARP_SLICES (16)
+
+// automatic warp mode parameters (see 'Automatic Warp Mode')
+typedef struct {
+    bool enabled;       // true to run faster than real time while a tape or disc drive is active
+    int max_slices;     // max number of time slices per xxx_exec() call (default: CHIPS_DEFAULT_WARP_SLICES)
+} chips_warp_desc_t;
+
+// borrowed text which is fed into the ROM keyboard input (see 'Text Input')
+typedef struct {
+    const uint8_t* ptr;
+    size_t size;
+    size_t pos;
+} chips_text_input_t;
+
+// atomic load-acquire, store-release and compare-and-swap for the ring buffer positions and async snapshot pages
+#if defined(_MSC_VER)
+    #define _CHIPS_LOAD_ACQUIRE(p) ((uint32_t)_InterlockedOr((volatile long*)(p), 0))
+    #define _CHIPS_STORE_RELEASE(p, v) ((void)_InterlockedExchange((volatile long*)(p), (long)(v)))
+    #define _CHIPS_CAS(p, expected, desired) (_InterlockedCompareExchange((volatile long*)(p), (long)(desired), (long)(expected)) == (long)(expected))
+#else
+    #define _CHIPS_LOAD_ACQUIRE(p) (__atomic_load_n((p), __ATOMIC_ACQUIRE))
+    #define _CHIPS_STORE_RELEASE(p, v) (__atomic_store_n((p), (v), __ATOMIC_RELEASE))
+    #define _CHIPS_CAS(p, expected, desired) (__sync_bool_compare_and_swap((p), (expected), (desired)))
+#endif
+
+// initialize an audio ring buffer with host-provided memory (num_samples must be a power of 2)
+static inline void chips_audio_ring_init(chips_audio_ring_t* ring, float* buffer, uint32_t num_samples) {
+    ring->buffer = buffer;
+    ring->size = num_samples;
+    ring->write_pos = 0;
+    ring->read_pos = 0;
+    ring->dropped = 0;
+}
+// producer: push a single sample, returns false if the ring buffer is full and the sample was dropped
+static inline bool chips_audio_ring_push(chips_audio_ring_t* ring, float sample) {
+    const uint32_t wr = ring->write_pos;
+    if ((wr - _CHIPS_LOAD_ACQUIRE(&ring->read_pos)) >= ring->size) {
+        ring->dropped++;
+        return false;
+    }
+    ring->buffer[wr & (ring->size - 1)] = sample;
+    _CHIPS_STORE_RELEASE(&ring->write_pos, wr + 1);
+    return true;
+}
+// producer: get pointer to and size of the contiguous free space, commit written samples with chips_audio_ring_end_write()
+static inline float* chips_audio_ring_begin_write(chips_audio_ring_t* ring, uint32_t* out_num_samples) {
+    const uint32_t wr = ring->write_pos;
+    const uint32_t num_free = ring->size - (wr - _CHIPS_LOAD_ACQUIRE(&ring->read_pos));
+    const uint32_t offset = wr & (ring->size - 1);
+    const uint32_t num_contiguous = ring->size - offset;
+    *out_num_samples = (num_free < num_contiguous) ? num_free : num_contiguous;
+    return &ring->buffer[offset];
+}
+// producer: publish samples written after chips_audio_ring_begin_write()
+static inline void chips_audio_ring_end_write(chips_audio_ring_t* ring, uint32_t num_samples) {
+    _CHIPS_STORE_RELEASE(&ring->write_pos, ring->write_pos + num_samples);
+}
+// consumer: get pointer to and number of contiguous readable samples, release them with chips_audio_ring_end_read()
+static inline const float* chips_audio_ring_begin_read(chips_audio_ring_t* ring, uint32_t* out_num_samples) {
+    const uint32_t rd = ring->read_pos;
+    const uint32_t num_avail = _CHIPS_LOAD_ACQUIRE(&ring->write_pos) - rd;
+    const uint32_t offset = rd & (ring->size - 1);
+    const uint32_t num_contiguous = ring->size - offset;
+    *out_num_samples = (num_avail < num_contiguous) ? num_avail : num_contiguous;
+    return &ring->buffer[offset];
+}
+// consumer: release samples read after chips_audio_ring_begin_read()
+static inline void chips_audio_ring_end_read(chips_audio_ring_t* ring, uint32_t num_samples) {
+    _CHIPS_STORE_RELEASE(&ring->read_pos, ring->read_pos + num_samples);
+}
+
+// initialize a register write log with host-provided memory (num_events must be a power of 2)
+static inline void chips_audio_log_init(chips_audio_log_t* log, chips_audio_event_t* events, uint32_t num_events) {
+    log->events = events;
+    log->size = num_events;
+    log->write_pos = 0;
+    log->read_pos = 0;
+    log->horizon = 0;
+    log->stalls = 0;
+}
+// producer: publish the system tick up to which all register writes have been pushed
+static inline void chips_audio_log_advance(chips_audio_log_t* log, uint32_t tick) {
+    _CHIPS_STORE_RELEASE(&log->horizon, tick);
+}
+// producer: push a register write, waits for the consumer if the log is full
+static inline void chips_audio_log_push(chips_audio_log_t* log, uint32_t tick, uint16_t reg, uint8_t value) {
+    const uint32_t wr = log->write_pos;
+    if ((wr - _CHIPS_LOAD_ACQUIRE(&log->read_pos)) >= log->size) {
+        // let the consumer catch up to the current tick
+        log->stalls++;
+        chips_audio_log_advance(log, tick);
+        while ((wr - _CHIPS_LOAD_ACQUIRE(&log->read_pos)) >= log->size) {
+            // wait for the audio thread
+        }
+    }
+    chips_audio_event_t* ev = &log->events[wr & (log->size - 1)];
+    ev->tick = tick;
+    ev->reg = reg;
+    ev->value = value;
+    _CHIPS_STORE_RELEASE(&log->write_pos, wr + 1);
+}
+// consumer: get the system tick up to which the sound chip may run
+static inline uint32_t chips_audio_log_horizon(chips_audio_log_t* log) {
+    return _CHIPS_LOAD_ACQUIRE(&log->horizon);
+}
+// consumer: get pointer to the oldest register write, or null if the log is empty
+static inline const chips_audio_event_t* chips_audio_log_peek(chips_audio_log_t* log) {
+    const uint32_t rd = log->read_pos;
+    if (rd == _CHIPS_LOAD_ACQUIRE(&log->write_pos)) {
+        return 0;
+    }
+    return &log->events[rd & (log->size - 1)];
+}
+// consumer: release the register write returned by chips_audio_log_peek()
+static inline void chips_audio_log_pop(chips_audio_log_t* log) {
+    _CHIPS_STORE_RELEASE(&log->read_pos, log->read_pos + 1);
+}
+
+// initialize a hardware event ring buffer with host-provided memory (num_events must be a power of 2)
+static inline void chips_event_ring_init(chips_event_ring_t* ring, chips_event_t* events, uint32_t num_events) {
+    ring->events = events;
+    ring->size = num_events;
+    ring->write_pos = 0;
+    ring->read_pos = 0;
+    ring->dropped = 0;
+    ring->levels = 0;
+    ring->tick = 0;
+}
+// push an event with the current tick, overwrites the oldest event if the ring is full
+static inline void chips_event_push(chips_event_ring_t* ring, uint16_t type, uint16_t addr, uint32_t data) {
+    if ((ring->write_pos - ring->read_pos) == ring->size) {
+        ring->read_pos++;
+        ring->dropped++;
+    }
+    chips_event_t* ev = &ring->events[ring->write_pos++ & (ring->size - 1)];
+    ev->tick = ring->tick;
+    ev->type = type;
+    ev->addr = addr;
+    ev->data = data;
+}
+// update a line level bit in 'levels', returns true if the level has changed
+static inline bool chips_event_changed(chips_event_ring_t* ring, uint32_t mask, bool level) {
+    if (((ring->levels & mask) != 0) != level) {
+        ring->levels ^= mask;
+        return true;
+    }
+    return false;
+}
+// get the oldest unread event and advance the read position, or null if the ring is empty
+static inline const chips_event_t* chips_event_ring_next(chips_event_ring_t* ring) {
+    if (ring->read_pos == ring->write_pos) {
+        return 0;
+    }
+    return &ring->events[ring->read_pos++ & (ring->size - 1)];
+}
+
+// test if the debug callback must be called for the current tick, op_done is true at instruction boundaries
+static inline bool chips_debug_filter_hit(chips_debug_filter_t* filter, bool op_done, uint16_t addr, bool rd, bool wr) {
+    filter->ticks++;
+    if (filter->flags & CHIPS_DEBUG_FILTER_TICK) {
+        return true;
+    }
+    const size_t i = addr >> 6;
+    const uint64_t bit = 1ULL << (addr & 63);
+    if (op_done && ((filter->flags & CHIPS_DEBUG_FILTER_OP) || (filter->exec[i] & bit))) {
+        return true;
+    }
+    return (rd && (filter->read[i] & bit)) || (wr && (filter->write[i] & bit));
+}
+
+// clear all lines in a dirty line bitmap
+static inline void chips_dirty_lines_clear(chips_dirty_lines_t* dirty) {
+    for (int i = 0; i < (CHIPS_DIRTY_MAX_LINES / 32); i++) {
+        dirty->bits[i] = 0;
+    }
+}
+// flag a framebuffer line as changed
+static inline void chips_dirty_lines_set(chips_dirty_lines_t* dirty, size_t y) {
+    dirty->bits[(y >> 5) & ((CHIPS_DIRTY_MAX_LINES / 32) - 1)] |= 1u << (y & 31);
+}
+// test if a framebuffer line has changed
+static inline bool chips_dirty_lines_test(const chips_dirty_lines_t* dirty, size_t y) {
+    return 0 != (dirty->bits[(y >> 5) & ((CHIPS_DIRTY_MAX_LINES / 32) - 1)] & (1u << (y & 31)));
+}
+// find the next run of dirty lines at or after *inout_y, returns the number of lines in the run and
+// moves *inout_y to the start of the run, returns 0 if there are no more dirty lines, if dirty is
+// null all lines are considered dirty
+static inline int chips_dirty_lines_run(const chips_dirty_lines_t* dirty, int* inout_y, int num_lines) {
+    int y = *inout_y;
+    if (0 == dirty) {
+        return (y < num_lines) ? (num_lines - y) : 0;
+    }
+    if (num_lines > CHIPS_DIRTY_MAX_LINES) {
+        num_lines = CHIPS_DIRTY_MAX_LINES;
+    }
+    while ((y < num_lines) && !chips_dirty_lines_test(dirty, (size_t)y)) {
+        // skip 32 clean lines at once
+        if ((0 == (y & 31)) && (0 == dirty->bits[y >> 5])) {
+            y += 32;
+        }
+        else {
+            y++;
+        }
+    }
+    if (y >= num_lines) {
+        *inout_y = num_lines;
+        return 0;
+    }
+    *inout_y = y;
+    int end = y + 1;
+    while ((end < num_lines) && chips_dirty_lines_test(dirty, (size_t)end)) {
+        end++;
+    }
+    return end - y;
+}
+
+// start feeding a new text, discards any pending text
+static inline void chips_text_input_start(chips_text_input_t* in, const uint8_t* ptr, size_t size) {
+    in->ptr = ptr;
+    in->size = ptr ? size : 0;
+    in->pos = 0;
+}
+// discard any pending text
+static inline void chips_text_input_clear(chips_text_input_t* in) {
+    in->ptr = 0;
+    in->size = 0;
+    in->pos = 0;
+}
+// return true if there's unconsumed text
+static inline bool chips_text_input_pending(const chips_text_input_t* in) {
+    return in->pos < in->size;
+}
+// get the next character with '\n' converted to 0x0D and '\r' skipped, returns 0 when no text is left
+static inline uint8_t chips_text_input_next(chips_text_input_t* in) {
+    while (in->pos < in->size) {
+        const uint8_t c = in->ptr[in->pos++];
+        if (c == '\n') {
+            return 0x0D;
+        }
+        else if ((c != '\r') && (c != 0)) {
+            return c;
+        }
+    }
+    return 0;
+}
+
+// relocate a pointer into a memory block which has been copied from src to dst (pointers outside the block are unchanged)
+static inline void* chips_relocate_ptr(const void* ptr, const void* src, size_t size, void* dst) {
+    const uint8_t* p = (const uint8_t*)ptr;
+    const uint8_t* s = (const uint8_t*)src;
+    if ((p >= s) && (p < (s + size))) {
+        return (uint8_t*)dst + (p - s);
+    }
+    return (void*)ptr;
+}
+
+// increment a statistics counter, only active when CHIPS_STATS is defined
+#if defined(CHIPS_STATS)
+    #define CHIPS_STATS_INC(counter) ((counter)++)
+#else
+    #define CHIPS_STATS_INC(counter) ((void)0)
+#endif
+
+// record a hardware event if an event ring is attached, only active when CHIPS_EVENTS is defined
+#if defined(CHIPS_EVENTS)
+    #define CHIPS_EVENT(ring, type, addr, data) ((ring) ? chips_event_push((ring), (type), (addr), (data)) : (void)0)
+#else
+    #define CHIPS_EVENT(ring, type, addr, data) ((void)0)
+#endif
+
+// build a 32-bit chunk tag from 4 characters
+#define CHIPS_FOURCC(a,b,c,d) ((uint32_t)(a) | ((uint32_t)(b)<<8) | ((uint32_t)(c)<<16) | ((uint32_t)(d)<<24))
+
+// a byte stream for pointer-free serialization
+typedef struct {
+    uint8_t* ptr;
+    size_t size;        // size of the buffer in bytes
+    size_t pos;         // current read/write position
+    bool writing;       // true when writing into the buffer, false when reading
+    bool failed;        // set on buffer overflow or chunk mismatch
+} chips_stream_t;
+
+// header of an encoded delta snapshot
+typedef struct {
+    uint32_t snapshot_size;     // size of the original snapshot in bytes
+    uint32_t num_blocks;        // number of changed blocks following the header
+} chips_delta_header_t;
+
+// async snapshot page size (same as mem.h page size) and max number of pages
+#define CHIPS_ASYNC_SNAPSHOT_PAGE_SIZE (1024)
+#define CHIPS_ASYNC_SNAPSHOT_MAX_PAGES (128)
+
+// async snapshot page states
+#define CHIPS_ASYNC_SNAPSHOT_PAGE_PENDING (0)   // not copied yet
+#define CHIPS_ASYNC_SNAPSHOT_PAGE_COPYING (1)   // currently being copied by one of the threads
+#define CHIPS_ASYNC_SNAPSHOT_PAGE_DONE (2)      // copied into the snapshot
+
+// a memory range which is copied into a snapshot page by page (see 'Asynchronous Snapshots')
+typedef struct {
+    const uint8_t* src;         // live memory of the running system
+    uint8_t* dst;               // destination in the snapshot
+    size_t size;                // size of the memory range in bytes
+    uint32_t num_pages;
+    uint32_t page_state[CHIPS_ASYNC_SNAPSHOT_MAX_PAGES];   // CHIPS_ASYNC_SNAPSHOT_PAGE_*, only accessed atomically
+} chips_async_snapshot_t;
+
+// snapshot file container (see 'Snapshot Files')
+#define CHIPS_SNAPSHOT_MAGIC CHIPS_FOURCC('C','H','S','N')
+#define CHIPS_SNAPSHOT_HEADER_SIZE (24)
+// worst case size of a packed snapshot (header plus about one literal control byte per 128 input bytes)
+#define CHIPS_SNAPSHOT_MAX_PACKED_SIZE(size) (CHIPS_SNAPSHOT_HEADER_SIZE + (size) + (size) / 128 + 1)
+
+// header of a snapshot file container
+typedef struct {
+    uint32_t magic;         // CHIPS_SNAPSHOT_MAGIC
+    uint32_t system;        // system type
+    uint32_t version;       // snapshot version from xxx_save_snapshot()
+    uint32_t size;          // size of the unpacked snapshot
+    uint32_t packed_size;   // size of the compressed data following the header
+    uint32_t checksum;      // FNV-1a hash of the unpacked snapshot
+} chips_snapshot_header_t;
+
 // prepare chips_audio_t snapshot for saving
 void chips_audio_callback_snapshot_onsave(chips_audio_callback_t* snapshot);
 // fixup chips_audio_t snapshot after loading
@@ -83,6 +851,41 @@ void chips_audio_callback_snapshot_onload(chips_audio_callback_t* snapshot, chip
 void chips_debug_snapshot_onsave(chips_debug_t* snapshot);
 // fixup chips_debug_t snapshot after loading
 void chips_debug_snapshot_onload(chips_debug_t* snapshot, chips_debug_t* sys);
+// encode the difference between two same-size snapshots, returns number of bytes written to dst, or 0 if dst is too small
+size_t chips_delta_encode(chips_range_t base, chips_range_t snapshot, chips_range_t dst);
+// same as chips_delta_encode(), but the snapshot range at ram_offset is taken from ram, and only the pages with a bit set in written_pages are compared
+size_t chips_delta_encode_ram(chips_range_t base, chips_range_t snapshot, size_t ram_offset, chips_range_t ram, size_t page_size, const uint64_t* written_pages, chips_range_t dst);
+// apply an encoded delta to a copy of the base snapshot, returns false if the delta doesn't match
+bool chips_delta_apply(chips_range_t delta, chips_range_t inout_snapshot);
+// prepare an async snapshot of a memory range, all pages are pending
+void chips_async_snapshot_init(chips_async_snapshot_t* job, chips_range_t src, void* dst);
+// copy a page if it is still pending (or wait until the other thread has copied it), returns true if this call copied the page
+bool chips_async_snapshot_copy_page(chips_async_snapshot_t* job, uint32_t page_index);
+// copy all remaining pages (usually called on a background thread)
+void chips_async_snapshot_run(chips_async_snapshot_t* job);
+// return true if all pages have been copied
+bool chips_async_snapshot_done(chips_async_snapshot_t* job);
+// compress a snapshot into a snapshot file container, returns number of bytes written to dst, or 0 if dst is too small
+size_t chips_snapshot_pack(uint32_t system, uint32_t version, chips_range_t snapshot, chips_range_t dst);
+// read and validate the header of a snapshot file container
+bool chips_snapshot_header(chips_range_t src, chips_snapshot_header_t* out_header);
+// decompress a snapshot file container, dst must be big enough for the unpacked snapshot, returns false on corrupt data
+bool chips_snapshot_unpack(chips_range_t src, chips_range_t dst);
+// create a stream which writes into a buffer
+chips_stream_t chips_stream_writer(chips_range_t buffer);
+// create a stream which reads from a buffer
+chips_stream_t chips_stream_reader(chips_range_t buffer);
+// write or check a chunk tag and version, returns false if the stream has failed
+bool chips_stream_begin(chips_stream_t* s, uint32_t tag, uint32_t version);
+// write or read values
+void chips_stream_u8(chips_stream_t* s, uint8_t* val);
+void chips_stream_u16(chips_stream_t* s, uint16_t* val);
+void chips_stream_u32(chips_stream_t* s, uint32_t* val);
+void chips_stream_u64(chips_stream_t* s, uint64_t* val);
+void chips_stream_int(chips_stream_t* s, int* val);
+void chips_stream_bool(chips_stream_t* s, bool* val);
+void chips_stream_float(chips_stream_t* s, float* val);
+void chips_stream_bytes(chips_stream_t* s, void* ptr, size_t num_bytes);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -90,6 +893,11 @@ void chips_debug_snapshot_onload(chips_debug_t* snapshot, chips_debug_t* sys);
 
 /*--- IMPLEMENTATION ---------------------------------------------------------*/
 #ifdef CHIPS_IMPL
+#include <string.h> // memcmp, memcpy, memset
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
 
 void chips_audio_callback_snapshot_onsave(chips_audio_callback_t* snapshot) {
     snapshot->func = 0;
@@ -105,12 +913,465 @@ void chips_debug_snapshot_onsave(chips_debug_t* snapshot) {
     snapshot->callback.func = 0;
     snapshot->callback.user_data = 0;
     snapshot->stopped = 0;
+    snapshot->filter = 0;
 }
 
 void chips_debug_snapshot_onload(chips_debug_t* snapshot, chips_debug_t* sys) {
     snapshot->callback.func = sys->callback.func;
     snapshot->callback.user_data = sys->callback.user_data;
     snapshot->stopped = sys->stopped;
+    snapshot->filter = sys->filter;
+}
+
+size_t chips_delta_encode_ram(chips_range_t base, chips_range_t snapshot, size_t ram_offset, chips_range_t ram, size_t page_size, const uint64_t* written_pages, chips_range_t dst) {
+    CHIPS_ASSERT(base.ptr && snapshot.ptr && dst.ptr);
+    CHIPS_ASSERT(base.size == snapshot.size);
+    CHIPS_ASSERT((ram.size == 0) || (ram.ptr && (page_size > 0) && written_pages && ((ram_offset + ram.size) <= snapshot.size)));
+    if (dst.size < sizeof(chips_delta_header_t)) {
+        return 0;
+    }
+    const uint8_t* base_ptr = (const uint8_t*) base.ptr;
+    const uint8_t* src_ptr = (const uint8_t*) snapshot.ptr;
+    const uint8_t* ram_ptr = (const uint8_t*) ram.ptr;
+    const size_t ram_end = ram_offset + ram.size;
+    uint8_t* dst_ptr = (uint8_t*) dst.ptr;
+    uint8_t block_buf[CHIPS_DELTA_BLOCK_SIZE];
+    chips_delta_header_t hdr = { .snapshot_size = (uint32_t)snapshot.size, .num_blocks = 0 };
+    size_t pos = sizeof(hdr);
+    for (size_t offset = 0; offset < snapshot.size; offset += CHIPS_DELTA_BLOCK_SIZE) {
+        const size_t block_size = ((snapshot.size - offset) < CHIPS_DELTA_BLOCK_SIZE) ? (snapshot.size - offset) : CHIPS_DELTA_BLOCK_SIZE;
+        const size_t block_end = offset + block_size;
+        const uint8_t* block_ptr = src_ptr + offset;
+        if ((offset < ram_end) && (block_end > ram_offset)) {
+            // the block overlaps the RAM, skip it if it only covers unwritten RAM pages
+            const size_t lo = (offset > ram_offset) ? offset : ram_offset;
+            const size_t hi = (block_end < ram_end) ? block_end : ram_end;
+            bool written = (lo > offset) || (hi < block_end);
+            for (size_t page = (lo - ram_offset) / page_size; !written && (page <= ((hi - 1 - ram_offset) / page_size)); page++) {
+                written = 0 != (written_pages[page >> 6] & (1ULL << (page & 63)));
+            }
+            if (!written) {
+                continue;
+            }
+            memcpy(block_buf, block_ptr, block_size);
+            memcpy(block_buf + (lo - offset), ram_ptr + (lo - ram_offset), hi - lo);
+            block_ptr = block_buf;
+        }
+        if (0 != memcmp(base_ptr + offset, block_ptr, block_size)) {
+            if ((pos + sizeof(uint32_t) + block_size) > dst.size) {
+                return 0;
+            }
+            const uint32_t block_index = (uint32_t)(offset / CHIPS_DELTA_BLOCK_SIZE);
+            memcpy(dst_ptr + pos, &block_index, sizeof(block_index));
+            pos += sizeof(block_index);
+            memcpy(dst_ptr + pos, block_ptr, block_size);
+            pos += block_size;
+            hdr.num_blocks++;
+        }
+    }
+    memcpy(dst_ptr, &hdr, sizeof(hdr));
+    return pos;
+}
+
+size_t chips_delta_encode(chips_range_t base, chips_range_t snapshot, chips_range_t dst) {
+    return chips_delta_encode_ram(base, snapshot, 0, (chips_range_t){0}, 0, 0, dst);
+}
+
+bool chips_delta_apply(chips_range_t delta, chips_range_t inout_snapshot) {
+    CHIPS_ASSERT(delta.ptr && inout_snapshot.ptr);
+    if (delta.size < sizeof(chips_delta_header_t)) {
+        return false;
+    }
+    const uint8_t* src_ptr = (const uint8_t*) delta.ptr;
+    uint8_t* dst_ptr = (uint8_t*) inout_snapshot.ptr;
+    chips_delta_header_t hdr;
+    memcpy(&hdr, src_ptr, sizeof(hdr));
+    if (hdr.snapshot_size != inout_snapshot.size) {
+        return false;
+    }
+    size_t pos = sizeof(hdr);
+    for (uint32_t i = 0; i < hdr.num_blocks; i++) {
+        uint32_t block_index;
+        if ((pos + sizeof(block_index)) > delta.size) {
+            return false;
+        }
+        memcpy(&block_index, src_ptr + pos, sizeof(block_index));
+        pos += sizeof(block_index);
+        const size_t offset = (size_t)block_index * CHIPS_DELTA_BLOCK_SIZE;
+        if (offset >= inout_snapshot.size) {
+            return false;
+        }
+        const size_t block_size = ((inout_snapshot.size - offset) < CHIPS_DELTA_BLOCK_SIZE) ? (inout_snapshot.size - offset) : CHIPS_DELTA_BLOCK_SIZE;
+        if ((pos + block_size) > delta.size) {
+            return false;
+        }
+        memcpy(dst_ptr + offset, src_ptr + pos, block_size);
+        pos += block_size;
+    }
+    return true;
+}
+
+void chips_async_snapshot_init(chips_async_snapshot_t* job, chips_range_t src, void* dst) {
+    CHIPS_ASSERT(job && src.ptr && dst);
+    CHIPS_ASSERT(src.size <= (CHIPS_ASYNC_SNAPSHOT_MAX_PAGES * CHIPS_ASYNC_SNAPSHOT_PAGE_SIZE));
+    memset(job, 0, sizeof(chips_async_snapshot_t));
+    job->src = (const uint8_t*)src.ptr;
+    job->dst = (uint8_t*)dst;
+    job->size = src.size;
+    job->num_pages = (uint32_t)((src.size + CHIPS_ASYNC_SNAPSHOT_PAGE_SIZE - 1) / CHIPS_ASYNC_SNAPSHOT_PAGE_SIZE);
+}
+
+bool chips_async_snapshot_copy_page(chips_async_snapshot_t* job, uint32_t page_index) {
+    CHIPS_ASSERT(job && (page_index < job->num_pages));
+    uint32_t* state = &job->page_state[page_index];
+    if (_CHIPS_CAS(state, CHIPS_ASYNC_SNAPSHOT_PAGE_PENDING, CHIPS_ASYNC_SNAPSHOT_PAGE_COPYING)) {
+        const size_t offset = (size_t)page_index * CHIPS_ASYNC_SNAPSHOT_PAGE_SIZE;
+        const size_t num_bytes = ((job->size - offset) < CHIPS_ASYNC_SNAPSHOT_PAGE_SIZE) ? (job->size - offset) : CHIPS_ASYNC_SNAPSHOT_PAGE_SIZE;
+        memcpy(job->dst + offset, job->src + offset, num_bytes);
+        _CHIPS_STORE_RELEASE(state, CHIPS_ASYNC_SNAPSHOT_PAGE_DONE);
+        return true;
+    }
+    // the other thread owns the page, wait until it is copied
+    while (_CHIPS_LOAD_ACQUIRE(state) != CHIPS_ASYNC_SNAPSHOT_PAGE_DONE) { }
+    return false;
+}
+
+void chips_async_snapshot_run(chips_async_snapshot_t* job) {
+    CHIPS_ASSERT(job);
+    for (uint32_t i = 0; i < job->num_pages; i++) {
+        chips_async_snapshot_copy_page(job, i);
+    }
+}
+
+bool chips_async_snapshot_done(chips_async_snapshot_t* job) {
+    CHIPS_ASSERT(job);
+    for (uint32_t i = 0; i < job->num_pages; i++) {
+        if (_CHIPS_LOAD_ACQUIRE(&job->page_state[i]) != CHIPS_ASYNC_SNAPSHOT_PAGE_DONE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#define _CHIPS_SNAPSHOT_HASH_BITS (12)
+#define _CHIPS_SNAPSHOT_NO_POS (0xFFFFFFFF)
+#define _CHIPS_SNAPSHOT_MAX_DIST (0xFFFF)
+
+// output buffer of the snapshot compressor, overflow is checked once at the end
+typedef struct {
+    uint8_t* ptr;
+    size_t size;
+    size_t pos;
+} _chips_snapshot_out_t;
+
+static inline void _chips_snapshot_put(_chips_snapshot_out_t* out, uint8_t val) {
+    if (out->pos < out->size) {
+        out->ptr[out->pos] = val;
+    }
+    out->pos++;
+}
+
+static void _chips_snapshot_put_literals(_chips_snapshot_out_t* out, const uint8_t* ptr, size_t num_bytes) {
+    while (num_bytes > 0) {
+        const size_t n = (num_bytes < 128) ? num_bytes : 128;
+        _chips_snapshot_put(out, (uint8_t)(n - 1));
+        if ((out->pos + n) <= out->size) {
+            memcpy(out->ptr + out->pos, ptr, n);
+        }
+        out->pos += n;
+        ptr += n;
+        num_bytes -= n;
+    }
+}
+
+// put a run or copy control byte with the extra length bytes
+static void _chips_snapshot_put_token(_chips_snapshot_out_t* out, uint8_t type, size_t len) {
+    if (len < 63) {
+        _chips_snapshot_put(out, (uint8_t)(type | len));
+    }
+    else {
+        _chips_snapshot_put(out, (uint8_t)(type | 63));
+        len -= 63;
+        while (len >= 255) {
+            _chips_snapshot_put(out, 255);
+            len -= 255;
+        }
+        _chips_snapshot_put(out, (uint8_t)len);
+    }
+}
+
+static inline uint32_t _chips_snapshot_hash(const uint8_t* ptr) {
+    uint32_t v;
+    memcpy(&v, ptr, sizeof(v));
+    return (v * 2654435761U) >> (32 - _CHIPS_SNAPSHOT_HASH_BITS);
+}
+
+static uint32_t _chips_snapshot_checksum(const uint8_t* ptr, size_t num_bytes) {
+    uint32_t hash = 0x811C9DC5;
+    for (size_t i = 0; i < num_bytes; i++) {
+        hash = (hash ^ ptr[i]) * 0x01000193;
+    }
+    return hash;
+}
+
+static void _chips_snapshot_header_stream(chips_stream_t* s, chips_snapshot_header_t* hdr) {
+    chips_stream_u32(s, &hdr->magic);
+    chips_stream_u32(s, &hdr->system);
+    chips_stream_u32(s, &hdr->version);
+    chips_stream_u32(s, &hdr->size);
+    chips_stream_u32(s, &hdr->packed_size);
+    chips_stream_u32(s, &hdr->checksum);
+}
+
+size_t chips_snapshot_pack(uint32_t system, uint32_t version, chips_range_t snapshot, chips_range_t dst) {
+    CHIPS_ASSERT(snapshot.ptr && dst.ptr);
+    CHIPS_ASSERT(snapshot.size <= 0xFFFFFFFF);
+    if (dst.size < CHIPS_SNAPSHOT_HEADER_SIZE) {
+        return 0;
+    }
+    const uint8_t* src = (const uint8_t*) snapshot.ptr;
+    const size_t src_size = snapshot.size;
+    _chips_snapshot_out_t out = {
+        .ptr = (uint8_t*)dst.ptr + CHIPS_SNAPSHOT_HEADER_SIZE,
+        .size = dst.size - CHIPS_SNAPSHOT_HEADER_SIZE,
+    };
+    // most recent position of each hashed 4-byte sequence
+    uint32_t table[1<<_CHIPS_SNAPSHOT_HASH_BITS];
+    memset(table, 0xFF, sizeof(table));
+    size_t lit_start = 0;
+    size_t pos = 0;
+    while ((pos + 4) <= src_size) {
+        // length of a run of the same byte
+        const uint8_t val = src[pos];
+        size_t run_len = 1;
+        while (((pos + run_len) < src_size) && (src[pos + run_len] == val)) {
+            run_len++;
+        }
+        // length of a match with the most recent position of the same 4-byte sequence
+        const uint32_t h = _chips_snapshot_hash(src + pos);
+        const uint32_t match_pos = table[h];
+        table[h] = (uint32_t)pos;
+        size_t match_len = 0;
+        if ((match_pos != _CHIPS_SNAPSHOT_NO_POS) && ((pos - match_pos) <= _CHIPS_SNAPSHOT_MAX_DIST)) {
+            while (((pos + match_len) < src_size) && (src[match_pos + match_len] == src[pos + match_len])) {
+                match_len++;
+            }
+        }
+        if ((run_len >= 3) && ((run_len + 1) >= match_len)) {
+            // a run is one byte shorter than a copy
+            _chips_snapshot_put_literals(&out, src + lit_start, pos - lit_start);
+            _chips_snapshot_put_token(&out, 0x80, run_len - 3);
+            _chips_snapshot_put(&out, val);
+            pos += run_len;
+            lit_start = pos;
+        }
+        else if (match_len >= 4) {
+            const size_t dist = pos - match_pos;
+            _chips_snapshot_put_literals(&out, src + lit_start, pos - lit_start);
+            _chips_snapshot_put_token(&out, 0xC0, match_len - 4);
+            _chips_snapshot_put(&out, (uint8_t)dist);
+            _chips_snapshot_put(&out, (uint8_t)(dist >> 8));
+            pos += match_len;
+            lit_start = pos;
+        }
+        else {
+            pos++;
+        }
+    }
+    _chips_snapshot_put_literals(&out, src + lit_start, src_size - lit_start);
+    if (out.pos > out.size) {
+        return 0;
+    }
+    chips_snapshot_header_t hdr = {
+        .magic = CHIPS_SNAPSHOT_MAGIC,
+        .system = system,
+        .version = version,
+        .size = (uint32_t)src_size,
+        .packed_size = (uint32_t)out.pos,
+        .checksum = _chips_snapshot_checksum(src, src_size),
+    };
+    chips_stream_t s = chips_stream_writer((chips_range_t){ .ptr = dst.ptr, .size = CHIPS_SNAPSHOT_HEADER_SIZE });
+    _chips_snapshot_header_stream(&s, &hdr);
+    CHIPS_ASSERT(!s.failed);
+    return CHIPS_SNAPSHOT_HEADER_SIZE + out.pos;
+}
+
+bool chips_snapshot_header(chips_range_t src, chips_snapshot_header_t* out_header) {
+    CHIPS_ASSERT(src.ptr && out_header);
+    if (src.size < CHIPS_SNAPSHOT_HEADER_SIZE) {
+        return false;
+    }
+    chips_snapshot_header_t hdr;
+    chips_stream_t s = chips_stream_reader((chips_range_t){ .ptr = src.ptr, .size = CHIPS_SNAPSHOT_HEADER_SIZE });
+    _chips_snapshot_header_stream(&s, &hdr);
+    if (s.failed || (hdr.magic != CHIPS_SNAPSHOT_MAGIC) || ((CHIPS_SNAPSHOT_HEADER_SIZE + (size_t)hdr.packed_size) > src.size)) {
+        return false;
+    }
+    *out_header = hdr;
+    return true;
+}
+
+bool chips_snapshot_unpack(chips_range_t src, chips_range_t dst) {
+    CHIPS_ASSERT(src.ptr && dst.ptr);
+    chips_snapshot_header_t hdr;
+    if (!chips_snapshot_header(src, &hdr) || (hdr.size > dst.size)) {
+        return false;
+    }
+    const uint8_t* in = (const uint8_t*)src.ptr + CHIPS_SNAPSHOT_HEADER_SIZE;
+    const uint8_t* in_end = in + hdr.packed_size;
+    uint8_t* out_start = (uint8_t*) dst.ptr;
+    uint8_t* out = out_start;
+    uint8_t* out_end = out_start + hdr.size;
+    while (in < in_end) {
+        const uint8_t c = *in++;
+        if (c < 0x80) {
+            const size_t n = (size_t)c + 1;
+            if ((n > (size_t)(in_end - in)) || (n > (size_t)(out_end - out))) {
+                return false;
+            }
+            memcpy(out, in, n);
+            in += n;
+            out += n;
+            continue;
+        }
+        size_t len = c & 63;
+        if (len == 63) {
+            uint8_t b;
+            do {
+                if (in >= in_end) {
+                    return false;
+                }
+                b = *in++;
+                len += b;
+            } while (b == 255);
+        }
+        if (c < 0xC0) {
+            len += 3;
+            if ((in >= in_end) || (len > (size_t)(out_end - out))) {
+                return false;
+            }
+            memset(out, *in++, len);
+            out += len;
+        }
+        else {
+            len += 4;
+            if ((2 > (in_end - in)) || (len > (size_t)(out_end - out))) {
+                return false;
+            }
+            const size_t dist = (size_t)in[0] | ((size_t)in[1] << 8);
+            in += 2;
+            if ((0 == dist) || (dist > (size_t)(out - out_start))) {
+                return false;
+            }
+            // the source and destination may overlap, copy byte by byte
+            const uint8_t* from = out - dist;
+            for (size_t i = 0; i < len; i++) {
+                out[i] = from[i];
+            }
+            out += len;
+        }
+    }
+    return (out == out_end) && (_chips_snapshot_checksum(out_start, hdr.size) == hdr.checksum);
+}
+
+chips_stream_t chips_stream_writer(chips_range_t buffer) {
+    CHIPS_ASSERT(buffer.ptr);
+    return (chips_stream_t){ .ptr = (uint8_t*)buffer.ptr, .size = buffer.size, .writing = true };
+}
+
+chips_stream_t chips_stream_reader(chips_range_t buffer) {
+    CHIPS_ASSERT(buffer.ptr);
+    return (chips_stream_t){ .ptr = (uint8_t*)buffer.ptr, .size = buffer.size, .writing = false };
+}
+
+// write or read an unsigned integer of up to 8 bytes in little-endian order
+static void _chips_stream_uint(chips_stream_t* s, uint64_t* val, size_t num_bytes) {
+    if (s->failed || ((s->pos + num_bytes) > s->size)) {
+        s->failed = true;
+        return;
+    }
+    uint8_t* ptr = s->ptr + s->pos;
+    if (s->writing) {
+        for (size_t i = 0; i < num_bytes; i++) {
+            ptr[i] = (uint8_t)(*val >> (i * 8));
+        }
+    }
+    else {
+        uint64_t v = 0;
+        for (size_t i = 0; i < num_bytes; i++) {
+            v |= (uint64_t)ptr[i] << (i * 8);
+        }
+        *val = v;
+    }
+    s->pos += num_bytes;
+}
+
+bool chips_stream_begin(chips_stream_t* s, uint32_t tag, uint32_t version) {
+    CHIPS_ASSERT(s);
+    uint32_t t = tag;
+    uint32_t v = version;
+    chips_stream_u32(s, &t);
+    chips_stream_u32(s, &v);
+    if ((t != tag) || (v != version)) {
+        s->failed = true;
+    }
+    return !s->failed;
+}
+
+void chips_stream_u8(chips_stream_t* s, uint8_t* val) {
+    uint64_t v = *val;
+    _chips_stream_uint(s, &v, 1);
+    *val = (uint8_t)v;
+}
+
+void chips_stream_u16(chips_stream_t* s, uint16_t* val) {
+    uint64_t v = *val;
+    _chips_stream_uint(s, &v, 2);
+    *val = (uint16_t)v;
+}
+
+void chips_stream_u32(chips_stream_t* s, uint32_t* val) {
+    uint64_t v = *val;
+    _chips_stream_uint(s, &v, 4);
+    *val = (uint32_t)v;
+}
+
+void chips_stream_u64(chips_stream_t* s, uint64_t* val) {
+    _chips_stream_uint(s, val, 8);
+}
+
+void chips_stream_int(chips_stream_t* s, int* val) {
+    uint64_t v = (uint32_t)*val;
+    _chips_stream_uint(s, &v, 4);
+    *val = (int)(int32_t)(uint32_t)v;
+}
+
+void chips_stream_bool(chips_stream_t* s, bool* val) {
+    uint64_t v = *val ? 1 : 0;
+    _chips_stream_uint(s, &v, 1);
+    *val = (v != 0);
+}
+
+void chips_stream_float(chips_stream_t* s, float* val) {
+    uint32_t bits;
+    memcpy(&bits, val, sizeof(bits));
+    chips_stream_u32(s, &bits);
+    memcpy(val, &bits, sizeof(bits));
+}
+
+void chips_stream_bytes(chips_stream_t* s, void* ptr, size_t num_bytes) {
+    CHIPS_ASSERT(s && ptr);
+    if (s->failed || ((s->pos + num_bytes) > s->size)) {
+        s->failed = true;
+        return;
+    }
+    if (s->writing) {
+        memcpy(s->ptr + s->pos, ptr, num_bytes);
+    }
+    else {
+        memcpy(ptr, s->ptr + s->pos, num_bytes);
+    }
+    s->pos += num_bytes;
 }
 
 #endif // CHIPS_IMPL
@@ -23,7 +23,26 @@
     ~~~C
     uint32_t clk_us_to_ticks(uint64_t freq_hz, uint32_t micro_seconds)
     ~~~
-        Convert micro-seconds to system ticks.
+        Convert micro-seconds to system ticks. The fractional part is
+        truncated, so calling this function repeatedly with the same
+        micro_seconds value loses up to one tick per call.
+
+    ~~~C
+    uint32_t clk_us_to_ticks_frac(uint64_t freq_hz, uint32_t micro_seconds, uint32_t* inout_frac)
+    ~~~
+        Convert micro-seconds to system ticks, and carry the fractional
+        tick over to the next call. The value pointed to by inout_frac is
+        the remainder in 1/1000000 ticks (always less than 1000000), it
+        should be initialized to zero and then must be passed unmodified to
+        the next call. This makes sure that the sum of all executed ticks
+        matches the sum of all elapsed micro-seconds exactly, which is what
+        the xxx_exec() functions of the system emulators use to prevent
+        the emulation from drifting when running in 60 Hz time slices.
+
+    ~~~C
+    uint32_t clk_ticks_to_us(uint64_t freq_hz, uint32_t ticks)
+    ~~~
+        Convert system ticks to micro-seconds (truncated).
 
     ## zlib/libpng license
 
@@ -51,6 +70,10 @@ extern "C" {
 
 // helper func to convert micro_seconds into ticks
 uint32_t clk_us_to_ticks(uint64_t freq_hz, uint32_t micro_seconds);
+// same as clk_us_to_ticks(), but carry the fractional remainder to the next call
+uint32_t clk_us_to_ticks_frac(uint64_t freq_hz, uint32_t micro_seconds, uint32_t* inout_frac);
+// helper func to convert ticks into micro_seconds
+uint32_t clk_ticks_to_us(uint64_t freq_hz, uint32_t ticks);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -66,4 +89,16 @@ uint32_t clk_us_to_ticks(uint64_t freq_hz, uint32_t micro_seconds);
 uint32_t clk_us_to_ticks(uint64_t freq_hz, uint32_t micro_seconds) {
     return (uint32_t) ((freq_hz * micro_seconds) / 1000000);
 }
+
+uint32_t clk_us_to_ticks_frac(uint64_t freq_hz, uint32_t micro_seconds, uint32_t* inout_frac) {
+    CHIPS_ASSERT(inout_frac && (*inout_frac < 1000000));
+    const uint64_t t = (freq_hz * micro_seconds) + *inout_frac;
+    *inout_frac = (uint32_t) (t % 1000000);
+    return (uint32_t) (t / 1000000);
+}
+
+uint32_t clk_ticks_to_us(uint64_t freq_hz, uint32_t ticks) {
+    CHIPS_ASSERT(freq_hz > 0);
+    return (uint32_t) (((uint64_t)ticks * 1000000) / freq_hz);
+}
 #endif
@@ -20,6 +20,39 @@
 
     FIXME: DOCS
 
+    ## Borrowed Disc Images
+
+    By default, the fdd_t struct contains a buffer for the entire disc image
+    (FDD_MAX_DISC_SIZE bytes, almost 1 MByte), and inserting a disc copies
+    the image data into this buffer. When running many emulator instances
+    this quickly adds up, so alternatively the disc image data can be borrowed
+    from a caller-owned buffer (for instance a memory-mapped file shared
+    between all instances) by defining:
+
+    ~~~C
+    #define FDD_BORROWED_DATA
+    ~~~
+
+    ...before including fdd.h (this must be the same for all files which
+    include fdd.h, since it changes the layout of fdd_t).
+
+    With FDD_BORROWED_DATA, fdd_insert_disc() only stores a pointer to the
+    image data, which must remain valid and unchanged until the disc is
+    ejected. The borrowed data is never written to, instead the first
+    write to a sector copies the sector into a copy-on-write overlay inside
+    fdd_t. The number of overlay sectors is defined by:
+
+    ~~~C
+    #define FDD_MAX_OVERLAY_SECTORS (64)
+    ~~~
+
+    When all overlay sectors are in use, fdd_write() to a new sector fails
+    with FDD_RESULT_NOT_READY.
+
+    Snapshots don't contain the borrowed data pointer (see
+    fdd_snapshot_onsave() and fdd_snapshot_onload()), when loading a snapshot
+    the same disc image must be inserted in the target fdd_t.
+
     ## zlib/libpng license
 
     Copyright (c) 2018 Andre Weissflog
@@ -52,6 +85,12 @@ extern "C" {
 #define FDD_MAX_TRACK_SIZE (FDD_MAX_SECTORS*FDD_MAX_SECTOR_SIZE)
 #define FDD_MAX_DISC_SIZE (FDD_MAX_SIDES*FDD_MAX_TRACKS*FDD_MAX_TRACK_SIZE)
 
+#if defined(FDD_BORROWED_DATA)
+#ifndef FDD_MAX_OVERLAY_SECTORS
+#define FDD_MAX_OVERLAY_SECTORS (64)    /* max number of overwritten sectors of a borrowed disc image */
+#endif
+#endif
+
 // result bits (compatible with UPD765_RESULT_*)
 #define FDD_RESULT_SUCCESS (0)
 #define FDD_RESULT_NOT_READY (1<<0)
@@ -95,6 +134,15 @@ typedef struct {
     fdd_track_t tracks[FDD_MAX_SIDES][FDD_MAX_TRACKS];
 } fdd_disc_t;
 
+#if defined(FDD_BORROWED_DATA)
+// a copy-on-write overlay for a written sector of a borrowed disc image
+typedef struct {
+    int data_offset;    // start of sector data in the borrowed disc data blob
+    int data_size;      // size in bytes of sector data
+    uint8_t data[FDD_MAX_SECTOR_SIZE];
+} fdd_overlay_t;
+#endif
+
 // a floppy disc drive description
 typedef struct {
     int cur_side;
@@ -105,14 +153,21 @@ typedef struct {
     bool motor_on;
     fdd_disc_t disc;
     int data_size;
+#if defined(FDD_BORROWED_DATA)
+    const uint8_t* data;    // the borrowed disc image data
+    int cur_overlay;        // 1-based overlay index of the current sector, 0 if not overwritten
+    int num_overlays;
+    fdd_overlay_t overlays[FDD_MAX_OVERLAY_SECTORS];
+#else
     uint8_t data[FDD_MAX_DISC_SIZE];
+#endif
 } fdd_t;
 
 // initialize a floppy disc drive
 void fdd_init(fdd_t* fdd);
 // drive motor on/off
 void fdd_motor(fdd_t* fdd, bool on);
-// insert a disc, the disc structure and data will be copied
+// insert a disc, the disc structure and data will be copied (data is borrowed with FDD_BORROWED_DATA)
 bool fdd_insert_disc(fdd_t* fdd, const fdd_disc_t* disc, const uint8_t* data, int data_size);
 // eject current disc
 void fdd_eject_disc(fdd_t* fdd);
@@ -127,6 +182,14 @@ int fdd_seek_sector(fdd_t* fdd, int side, uint8_t c, uint8_t h, uint8_t r, uint8
 int fdd_read(fdd_t* fdd, int side, uint8_t* out_data);
 // write the next byte to the seeked-to sector, return FDD_RESULT_*
 int fdd_write(fdd_t* fdd, int side, uint8_t data);
+// get pointer and size of the entire seeked-to sector data, return FDD_RESULT_*
+int fdd_sector_data(fdd_t* fdd, int side, const uint8_t** out_ptr, int* out_size);
+// read a byte from the disc image data without side effects (includes written sectors)
+uint8_t fdd_peek(const fdd_t* fdd, int data_offset);
+// prepare fdd_t snapshot for saving
+void fdd_snapshot_onsave(fdd_t* snapshot);
+// fixup fdd_t snapshot after loading
+void fdd_snapshot_onload(fdd_t* snapshot, fdd_t* sys);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -159,7 +222,14 @@ void fdd_eject_disc(fdd_t* fdd) {
     fdd->has_disc = false;
     fdd->motor_on = false;
     memset(&fdd->disc, 0, sizeof(fdd->disc));
-    memset(&fdd->data, 0, sizeof(fdd->data));
+    fdd->data_size = 0;
+    #if defined(FDD_BORROWED_DATA)
+        fdd->data = 0;
+        fdd->cur_overlay = 0;
+        fdd->num_overlays = 0;
+    #else
+        memset(&fdd->data, 0, sizeof(fdd->data));
+    #endif
 }
 
 bool fdd_disc_inserted(fdd_t* fdd) {
@@ -207,6 +277,34 @@ bool _fdd_validate_disc(const fdd_disc_t* disc) {
     return true;
 }
 
+#if defined(FDD_BORROWED_DATA)
+/* check that all sectors are inside the borrowed data */
+static bool _fdd_validate_data_size(const fdd_disc_t* disc, int data_size) {
+    for (int side_index = 0; side_index < disc->num_sides; side_index++) {
+        for (int track_index = 0; track_index < disc->num_tracks; track_index++) {
+            const fdd_track_t* track = &(disc->tracks[side_index][track_index]);
+            for (int sector_index = 0; sector_index < track->num_sectors; sector_index++) {
+                const fdd_sector_t* sector = &(track->sectors[sector_index]);
+                if ((sector->data_offset + sector->data_size) > data_size) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/* find the overlay of the sector at data_offset, return 1-based index, or 0 */
+static int _fdd_find_overlay(const fdd_t* fdd, int data_offset) {
+    for (int i = 0; i < fdd->num_overlays; i++) {
+        if (fdd->overlays[i].data_offset == data_offset) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+#endif
+
 bool fdd_insert_disc(fdd_t* fdd, const fdd_disc_t* disc, const uint8_t* data, int data_size) {
     CHIPS_ASSERT(fdd);
     if (fdd->has_disc) {
@@ -221,8 +319,17 @@ bool fdd_insert_disc(fdd_t* fdd, const fdd_disc_t* disc, const uint8_t* data, in
     }
     if (data) {
         if ((data_size > 0) && (data_size <= FDD_MAX_DISC_SIZE)) {
+            #if defined(FDD_BORROWED_DATA)
+                if (!_fdd_validate_data_size(&fdd->disc, data_size)) {
+                    /* sectors outside of the borrowed data */
+                    memset(&fdd->disc, 0, sizeof(fdd->disc));
+                    return false;
+                }
+                fdd->data = data;
+            #else
+                memcpy(&fdd->data, data, data_size);
+            #endif
             fdd->data_size = data_size;
-            memcpy(&fdd->data, data, data_size);
             fdd->disc.formatted = true;
         }
         else {
@@ -262,6 +369,9 @@ int fdd_seek_sector(fdd_t* fdd, int side, uint8_t c, uint8_t h, uint8_t r, uint8
             if (sector->info.upd765.r == r) {
                 fdd->cur_sector_index = si;
                 fdd->cur_sector_pos = 0;
+                #if defined(FDD_BORROWED_DATA)
+                    fdd->cur_overlay = _fdd_find_overlay(fdd, sector->data_offset);
+                #endif
                 return FDD_RESULT_SUCCESS;
             }
         }
@@ -278,8 +388,17 @@ int fdd_read(fdd_t* fdd, int side, uint8_t* out_data) {
         fdd->cur_side = side;
         const fdd_sector_t* sector = &fdd->disc.tracks[side][fdd->cur_track_index].sectors[fdd->cur_sector_index];
         if (fdd->cur_sector_pos < sector->data_size) {
-            const int data_offset = sector->data_offset + fdd->cur_sector_pos;
-            *out_data = fdd->data[data_offset];
+            #if defined(FDD_BORROWED_DATA)
+                if (fdd->cur_overlay > 0) {
+                    *out_data = fdd->overlays[fdd->cur_overlay - 1].data[fdd->cur_sector_pos];
+                }
+                else {
+                    *out_data = fdd->data ? fdd->data[sector->data_offset + fdd->cur_sector_pos] : 0;
+                }
+            #else
+                const int data_offset = sector->data_offset + fdd->cur_sector_pos;
+                *out_data = fdd->data[data_offset];
+            #endif
             fdd->cur_sector_pos++;
             if (fdd->cur_sector_pos < sector->data_size) {
                 return FDD_RESULT_SUCCESS;
@@ -300,8 +419,28 @@ int fdd_write(fdd_t* fdd, int side, uint8_t data) {
         fdd->cur_side = side;
         const fdd_sector_t* sector = &fdd->disc.tracks[side][fdd->cur_track_index].sectors[fdd->cur_sector_index];
         if (fdd->cur_sector_pos < sector->data_size) {
-            const int data_offset = sector->data_offset + fdd->cur_sector_pos;
-            fdd->data[data_offset] = data;
+            #if defined(FDD_BORROWED_DATA)
+                if (0 == fdd->cur_overlay) {
+                    /* first write to this sector, copy it into a new overlay */
+                    if (fdd->num_overlays == FDD_MAX_OVERLAY_SECTORS) {
+                        return FDD_RESULT_NOT_READY;
+                    }
+                    fdd_overlay_t* ovl = &fdd->overlays[fdd->num_overlays++];
+                    ovl->data_offset = sector->data_offset;
+                    ovl->data_size = sector->data_size;
+                    if (fdd->data) {
+                        memcpy(ovl->data, &fdd->data[sector->data_offset], sector->data_size);
+                    }
+                    else {
+                        memset(ovl->data, 0, sizeof(ovl->data));
+                    }
+                    fdd->cur_overlay = fdd->num_overlays;
+                }
+                fdd->overlays[fdd->cur_overlay - 1].data[fdd->cur_sector_pos] = data;
+            #else
+                const int data_offset = sector->data_offset + fdd->cur_sector_pos;
+                fdd->data[data_offset] = data;
+            #endif
             fdd->cur_sector_pos++;
             if (fdd->cur_sector_pos < sector->data_size) {
                 return FDD_RESULT_SUCCESS;
@@ -315,4 +454,79 @@ int fdd_write(fdd_t* fdd, int side, uint8_t data) {
     return FDD_RESULT_NOT_READY;
 }
 
+int fdd_sector_data(fdd_t* fdd, int side, const uint8_t** out_ptr, int* out_size) {
+    CHIPS_ASSERT(fdd && (side >= 0) && (side < FDD_MAX_SIDES) && out_ptr && out_size);
+    if (fdd->has_disc & fdd->motor_on) {
+        fdd->cur_side = side;
+        const fdd_sector_t* sector = &fdd->disc.tracks[side][fdd->cur_track_index].sectors[fdd->cur_sector_index];
+        #if defined(FDD_BORROWED_DATA)
+            static const uint8_t zero_sector[FDD_MAX_SECTOR_SIZE];
+            if (fdd->cur_overlay > 0) {
+                *out_ptr = fdd->overlays[fdd->cur_overlay - 1].data;
+            }
+            else {
+                *out_ptr = fdd->data ? &fdd->data[sector->data_offset] : zero_sector;
+            }
+        #else
+            *out_ptr = &fdd->data[sector->data_offset];
+        #endif
+        *out_size = sector->data_size;
+        return FDD_RESULT_SUCCESS;
+    }
+    *out_ptr = 0;
+    *out_size = 0;
+    return FDD_RESULT_NOT_READY;
+}
+
+uint8_t fdd_peek(const fdd_t* fdd, int data_offset) {
+    CHIPS_ASSERT(fdd);
+    if ((data_offset < 0) || (data_offset >= FDD_MAX_DISC_SIZE)) {
+        return 0xFF;
+    }
+    #if defined(FDD_BORROWED_DATA)
+        for (int i = 0; i < fdd->num_overlays; i++) {
+            const fdd_overlay_t* ovl = &fdd->overlays[i];
+            if ((data_offset >= ovl->data_offset) && (data_offset < (ovl->data_offset + ovl->data_size))) {
+                return ovl->data[data_offset - ovl->data_offset];
+            }
+        }
+        if (fdd->data && (data_offset < fdd->data_size)) {
+            return fdd->data[data_offset];
+        }
+        return 0;
+    #else
+        return fdd->data[data_offset];
+    #endif
+}
+
+void fdd_snapshot_onsave(fdd_t* snapshot) {
+    CHIPS_ASSERT(snapshot);
+    #if defined(FDD_BORROWED_DATA)
+        snapshot->data = 0;
+    #else
+        (void)snapshot;
+    #endif
+}
+
+void fdd_snapshot_onload(fdd_t* snapshot, fdd_t* sys) {
+    CHIPS_ASSERT(snapshot && sys);
+    #if defined(FDD_BORROWED_DATA)
+        // the borrowed disc image data is taken from the target fdd_t
+        if (snapshot->has_disc && snapshot->disc.formatted) {
+            if (sys->data && (sys->data_size == snapshot->data_size)) {
+                snapshot->data = sys->data;
+            }
+            else {
+                // the disc image isn't available, eject the disc
+                fdd_eject_disc(snapshot);
+            }
+        }
+        else {
+            snapshot->data = 0;
+        }
+    #else
+        (void)snapshot; (void)sys;
+    #endif
+}
+
 #endif /* CHIPS_IMPL */
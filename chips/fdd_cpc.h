@@ -19,6 +19,9 @@
         data        - pointer to the .dsk image data in memory
         data_size   - size in bytes of the image data
 
+        With FDD_BORROWED_DATA (see fdd.h) the image data isn't copied
+        and must remain valid until the disc is ejected.
+
     ## zlib/libpng license
 
     Copyright (c) 2018 Andre Weissflog
@@ -99,10 +102,15 @@ static bool _fdd_cpc_parse_dsk(fdd_t* fdd, bool ext, chips_range_t data) {
         return false;
     }
 
-    /* copy the data blob to the local buffer */
+    /* copy the data blob to the local buffer, or borrow it */
     CHIPS_ASSERT(data.size <= FDD_MAX_DISC_SIZE);
+    const uint8_t* src = (const uint8_t*) data.ptr;
     fdd->data_size = data.size;
-    memcpy(fdd->data, data.ptr, fdd->data_size);
+    #if defined(FDD_BORROWED_DATA)
+        fdd->data = src;
+    #else
+        memcpy(fdd->data, src, fdd->data_size);
+    #endif
 
     /* setup the disc structure */
     fdd_disc_t* disc = &fdd->disc;
@@ -122,7 +130,7 @@ static bool _fdd_cpc_parse_dsk(fdd_t* fdd, bool ext, chips_range_t data) {
                 track_size = (hdr->track_size_h<<8) | hdr->track_size_l;
             }
             if (track_size > 0) {
-                const _fdd_cpc_dsk_track_info* track_info = (const _fdd_cpc_dsk_track_info*) &fdd->data[data_offset];
+                const _fdd_cpc_dsk_track_info* track_info = (const _fdd_cpc_dsk_track_info*) &src[data_offset];
                 if (0 != memcmp("Track-Info", track_info->magic, 10)) {
                     return false;
                 }
@@ -165,6 +173,11 @@ static bool _fdd_cpc_parse_dsk(fdd_t* fdd, bool ext, chips_range_t data) {
             }
         }
     }
+    #if defined(FDD_BORROWED_DATA)
+        if (!_fdd_validate_data_size(disc, fdd->data_size)) {
+            return false;
+        }
+    #endif
     fdd->has_disc = true;
     return true;
 }
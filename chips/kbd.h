@@ -100,30 +100,31 @@ typedef struct {
     bool released;
 } key_state_t;
 
-// keyboard matrix state
+// keyboard matrix state (the state which is scanned by the emulated system
+// on every tick comes first, the key tables only used on key events last)
 typedef struct {
-    // current time stamp, bumped by kbd_update()
-    uint64_t cur_time;
-    // number of frames a key will at least remain pressed
-    uint32_t sticky_time;
     // currently active columns
     uint16_t active_columns;
     // currently active lines
     uint16_t active_lines;
-    // map key ASCII code to modifier/column/line bits
-    uint32_t key_masks[KBD_MAX_KEYS];
-    // column/line bits for modifier keys
-    uint32_t mod_masks[KBD_MAX_MOD_KEYS];
-    // currently pressed keys (bitmask==0 is empty slot)
-    key_state_t key_buffer[KBD_MAX_PRESSED_KEYS];
-    // active column/line masks, updated when key pressed state changes
-    uint16_t scanout_column_masks[KBD_MAX_LINES];
-    uint16_t scanout_line_masks[KBD_MAX_COLUMNS];
     // last cached column / scanout combinations
     uint16_t cur_column_mask;
     uint16_t cur_scanout_line_mask;
     uint16_t cur_line_mask;
     uint16_t cur_scanout_column_mask;
+    // active column/line masks, updated when key pressed state changes
+    uint16_t scanout_column_masks[KBD_MAX_LINES];
+    uint16_t scanout_line_masks[KBD_MAX_COLUMNS];
+    // current time stamp, bumped by kbd_update()
+    uint64_t cur_time;
+    // number of frames a key will at least remain pressed
+    uint32_t sticky_time;
+    // currently pressed keys (bitmask==0 is empty slot)
+    key_state_t key_buffer[KBD_MAX_PRESSED_KEYS];
+    // column/line bits for modifier keys
+    uint32_t mod_masks[KBD_MAX_MOD_KEYS];
+    // map key ASCII code to modifier/column/line bits
+    uint32_t key_masks[KBD_MAX_KEYS];
 } kbd_t;
 
 // initialize a keyboard matrix instance, provide key-sticky duration in number of 60Hz frames
@@ -162,6 +163,10 @@ static inline void kbd_set_active_lines(kbd_t* kbd, uint16_t line_mask) {
 static inline uint16_t kbd_scan_columns(kbd_t* kbd) {
     return kbd_test_columns(kbd, kbd->active_lines);
 }
+#if defined(CHIPS_FOURCC)
+// write the keyboard state to a stream or read it from a stream (the key map isn't included, needs chips_common.h)
+void kbd_serialize(kbd_t* kbd, chips_stream_t* stream);
+#endif
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -407,4 +412,31 @@ uint16_t kbd_test_columns(kbd_t* kbd, uint16_t line_mask) {
     return kbd->cur_scanout_column_mask;
 }
 
+#if defined(CHIPS_FOURCC)
+void kbd_serialize(kbd_t* kbd, chips_stream_t* s) {
+    CHIPS_ASSERT(kbd && s);
+    if (!chips_stream_begin(s, CHIPS_FOURCC('K','B','D',' '), 1)) {
+        return;
+    }
+    chips_stream_u64(s, &kbd->cur_time);
+    chips_stream_u16(s, &kbd->active_columns);
+    chips_stream_u16(s, &kbd->active_lines);
+    for (int i = 0; i < KBD_MAX_PRESSED_KEYS; i++) {
+        chips_stream_u32(s, &kbd->key_buffer[i].mask);
+        chips_stream_u64(s, &kbd->key_buffer[i].pressed_time);
+        chips_stream_bool(s, &kbd->key_buffer[i].released);
+    }
+    for (int i = 0; i < KBD_MAX_LINES; i++) {
+        chips_stream_u16(s, &kbd->scanout_column_masks[i]);
+    }
+    for (int i = 0; i < KBD_MAX_COLUMNS; i++) {
+        chips_stream_u16(s, &kbd->scanout_line_masks[i]);
+    }
+    chips_stream_u16(s, &kbd->cur_column_mask);
+    chips_stream_u16(s, &kbd->cur_scanout_line_mask);
+    chips_stream_u16(s, &kbd->cur_line_mask);
+    chips_stream_u16(s, &kbd->cur_scanout_column_mask);
+}
+#endif
+
 #endif /* CHIPS_IMPL */
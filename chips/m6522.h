@@ -86,6 +86,24 @@
     m6522_reset(&sys->via);
     ~~~
 
+    ## Idle Ticks
+
+    Most of the time a VIA doesn't do much more than counting down its
+    timers, m6522_tick_sched() can be used as a drop-in replacement for
+    m6522_tick() with bit-identical results, but the full chip emulation
+    only runs on register accesses, input pin changes and timer events.
+
+    After each full tick the chip computes how many of the following ticks
+    can be handled by just decrementing the timer counters (as long as the
+    CS1, CS2, port and control input pins don't change), those ticks are
+    handled inline in m6522_tick_sched() without calling into the chip
+    emulation.
+
+    m6522_tick_idle() skips over a number of such ticks at once, this is
+    the same as calling m6522_tick_sched() num_ticks times, the caller must
+    make sure that num_ticks isn't greater than m6522_t.idle_ticks and that
+    the input pins match m6522_t.idle_pins (see m6522_is_idle()).
+
     ## LINKS
 
     On timer behaviour when hitting zero:
@@ -329,8 +347,14 @@ typedef struct {
     uint8_t acr;        /* auxilary control register */
     uint8_t pcr;        /* peripheral control register */
     uint64_t pins;
+    uint32_t idle_ticks;    // number of upcoming ticks which only decrement the timer counters
+    uint64_t idle_pins;     // input pin state the idle ticks have been computed for
 } m6522_t;
 
+// input and output pins which are considered by idle ticks
+#define M6522_IDLE_INPUT_PINS (M6522_CS1|M6522_CS2|M6522_PA_PINS|M6522_PB_PINS|M6522_CA1|M6522_CA2|M6522_CB1|M6522_CB2)
+#define M6522_IDLE_OUTPUT_PINS (M6522_IRQ|M6522_PA_PINS|M6522_PB_PINS|M6522_CA1|M6522_CA2|M6522_CB1|M6522_CB2)
+
 // extract 8-bit data bus from 64-bit pins
 #define M6522_GET_DATA(p) ((uint8_t)((p)>>16))
 // merge 8-bit data bus value into 64-bit pins
@@ -352,6 +376,35 @@ void m6522_init(m6522_t* m6522);
 void m6522_reset(m6522_t* m6522);
 // tick the m6522
 uint64_t m6522_tick(m6522_t* m6522, uint64_t pins);
+// same as m6522_tick() but also computes the number of upcoming idle ticks
+uint64_t m6522_tick_full(m6522_t* m6522, uint64_t pins);
+
+// tick the m6522, only calls into the chip emulation if the chip isn't idle
+static inline uint64_t m6522_tick_sched(m6522_t* c, uint64_t pins) {
+    if ((c->idle_ticks > 0) && ((pins & M6522_IDLE_INPUT_PINS) == c->idle_pins)) {
+        c->idle_ticks--;
+        c->t1.counter -= (uint16_t)(c->t1.pip & 1);
+        if (!M6522_ACR_T2_COUNT_PB6(c)) {
+            c->t2.counter -= (uint16_t)(c->t2.pip & 1);
+        }
+        return (pins & ~M6522_IDLE_OUTPUT_PINS) | (c->pins & M6522_IDLE_OUTPUT_PINS);
+    }
+    return m6522_tick_full(c, pins);
+}
+
+// true if the next num_ticks ticks with the input pins in 'pins' are idle ticks
+static inline bool m6522_is_idle(const m6522_t* c, uint64_t pins, uint32_t num_ticks) {
+    return (c->idle_ticks >= num_ticks) && ((pins & M6522_IDLE_INPUT_PINS) == c->idle_pins);
+}
+
+// skip num_ticks idle ticks, the output pins don't change
+static inline void m6522_tick_idle(m6522_t* c, uint32_t num_ticks) {
+    c->idle_ticks -= num_ticks;
+    c->t1.counter -= (uint16_t)((c->t1.pip & 1) * num_ticks);
+    if (!M6522_ACR_T2_COUNT_PB6(c)) {
+        c->t2.counter -= (uint16_t)((c->t2.pip & 1) * num_ticks);
+    }
+}
 
 #ifdef __cplusplus
 } // extern "C"
@@ -425,6 +478,7 @@ void m6522_reset(m6522_t* c) {
     c->acr = 0;
     c->pcr = 0;
     c->pins = 0;
+    c->idle_ticks = 0;
 }
 
 /*--- delay-pipeline macros ---*/
@@ -895,4 +949,43 @@ uint64_t m6522_tick(m6522_t* c, uint64_t pins) {
     return pins;
 }
 
+/* Compute the number of upcoming idle ticks for the given input pins.
+
+   The next tick is run on a copy of the chip, if the only state change
+   is the counter decrement of the timers and the output pins don't
+   change, the chip is in a steady state and will remain there until
+   a counting timer underflows.
+*/
+static uint32_t _m6522_idle_ticks(const m6522_t* c, uint64_t pins) {
+    if ((pins & (M6522_CS1|M6522_CS2)) == M6522_CS1) {
+        return 0;
+    }
+    const bool t2_counting = !M6522_ACR_T2_COUNT_PB6(c) && (c->t2.pip & 1);
+    m6522_t tmp;
+    memcpy(&tmp, c, sizeof(tmp));
+    const uint64_t out_pins = _m6522_tick(&tmp, pins);
+    tmp.t1.counter += (uint16_t)(c->t1.pip & 1);
+    tmp.t2.counter += (uint16_t)(t2_counting ? 1 : 0);
+    if ((0 != memcmp(&tmp, c, sizeof(tmp))) || (0 != ((out_pins ^ c->pins) & M6522_IDLE_OUTPUT_PINS))) {
+        return 0;
+    }
+    // a counting timer underflows on the tick where the counter is decremented from zero
+    uint32_t num_ticks = 0xFFFF;
+    if ((c->t1.pip & 1) && (c->t1.counter < num_ticks)) {
+        num_ticks = c->t1.counter;
+    }
+    if (t2_counting && (c->t2.counter < num_ticks)) {
+        num_ticks = c->t2.counter;
+    }
+    return num_ticks;
+}
+
+uint64_t m6522_tick_full(m6522_t* c, uint64_t pins) {
+    const uint64_t in_pins = pins;
+    pins = m6522_tick(c, pins);
+    c->idle_ticks = _m6522_idle_ticks(c, in_pins);
+    c->idle_pins = in_pins & M6522_IDLE_INPUT_PINS;
+    return pins;
+}
+
 #endif /* CHIPS_IMPL */
@@ -48,6 +48,18 @@
     - https://ist.uwaterloo.ca/~schepers/MJK/cia6526.html
     - https://ist.uwaterloo.ca/~schepers/MJK/cia6526.html
 
+    ## Idle Ticks
+
+    Most of the time a CIA doesn't do much more than counting down its
+    timers. m6526_tick_sched() is a drop-in replacement for m6526_tick()
+    which is bit-identical in its results, but only runs the full chip
+    emulation on register accesses, input pin changes and timer events.
+
+    After each full tick the chip computes how many of the following ticks
+    can be handled by just decrementing the timer counters (as long as the
+    CS, PA, PB and FLAG input pins don't change), those ticks are handled
+    inline in m6526_tick_sched() without calling into the chip emulation.
+
     TODO: Documentation
 
     ## zlib/libpng license
@@ -249,6 +261,8 @@ typedef struct {
     m6526_timer_t tb;
     m6526_int_t intr;
     uint64_t pins;
+    uint32_t idle_ticks;    // number of upcoming ticks which only decrement the timer counters
+    uint64_t idle_pins;     // input pin state the idle ticks have been computed for
 } m6526_t;
 
 // extract 8-bit data bus from 64-bit pins
@@ -266,12 +280,29 @@ typedef struct {
 // merge port A and B pins into pin mask
 #define M6526_SET_PAB(p,a,b) {p=((p)&0x0000FFFFFFFFFFFFULL)|(((a)&0xFFULL)<<48)|(((b)&0xFFULL)<<56);}
 
+// input and output pins which are considered by idle ticks
+#define M6526_IDLE_INPUT_PINS (M6526_CS|M6526_FLAG|M6526_PA_PINS|M6526_PB_PINS)
+#define M6526_IDLE_OUTPUT_PINS (M6526_IRQ|M6526_PA_PINS|M6526_PB_PINS)
+
 // initialize a new m6526_t instance
 void m6526_init(m6526_t* c);
 // reset an existing m6526_t instance
 void m6526_reset(m6526_t* c);
 // tick the m6526_t instance
 uint64_t m6526_tick(m6526_t* c, uint64_t pins);
+// same as m6526_tick() but also computes the number of upcoming idle ticks
+uint64_t m6526_tick_full(m6526_t* c, uint64_t pins);
+
+// tick the m6526_t instance, only calls into the chip emulation if the chip isn't idle
+static inline uint64_t m6526_tick_sched(m6526_t* c, uint64_t pins) {
+    if ((c->idle_ticks > 0) && ((pins & M6526_IDLE_INPUT_PINS) == c->idle_pins)) {
+        c->idle_ticks--;
+        c->ta.counter -= (uint16_t)(c->ta.pip & 1);
+        c->tb.counter -= (uint16_t)(c->tb.pip & 1);
+        return (pins & ~M6526_IDLE_OUTPUT_PINS) | (c->pins & M6526_IDLE_OUTPUT_PINS);
+    }
+    return m6526_tick_full(c, pins);
+}
 
 #ifdef __cplusplus
 } // extern "C"
@@ -329,6 +360,7 @@ void m6526_reset(m6526_t* c) {
     _m6526_init_timer(&c->tb);
     _m6526_init_interrupt(&c->intr);
     c->pins = 0;
+    c->idle_ticks = 0;
 }
 
 /*--- delay-pipeline macros ---*/
@@ -683,4 +715,44 @@ uint64_t m6526_tick(m6526_t* c, uint64_t pins) {
     return pins;
 }
 
+/* Compute the number of upcoming idle ticks for the given input pins.
+
+   The next tick is run on a copy of the chip, if the only state change
+   is the counter decrement of running timers and the output pins don't
+   change, the chip is in a steady state and will remain there until
+   a running timer underflows.
+*/
+static uint32_t _m6526_idle_ticks(const m6526_t* c, uint64_t pins) {
+    if (pins & M6526_CS) {
+        return 0;
+    }
+    m6526_t tmp;
+    memcpy(&tmp, c, sizeof(tmp));
+    const uint64_t out_pins = _m6526_tick(&tmp, pins);
+    tmp.ta.counter += (uint16_t)(c->ta.pip & 1);
+    tmp.tb.counter += (uint16_t)(c->tb.pip & 1);
+    if ((0 != memcmp(&tmp, c, sizeof(tmp))) || (0 != ((out_pins ^ c->pins) & M6526_IDLE_OUTPUT_PINS))) {
+        return 0;
+    }
+    // a running timer underflows on the tick where the counter is decremented to zero
+    uint32_t num_ticks = 0xFFFF;
+    if (c->ta.pip & 1) {
+        const uint32_t ta_ticks = (uint16_t)(c->ta.counter - 1);
+        num_ticks = (ta_ticks < num_ticks) ? ta_ticks : num_ticks;
+    }
+    if (c->tb.pip & 1) {
+        const uint32_t tb_ticks = (uint16_t)(c->tb.counter - 1);
+        num_ticks = (tb_ticks < num_ticks) ? tb_ticks : num_ticks;
+    }
+    return num_ticks;
+}
+
+uint64_t m6526_tick_full(m6526_t* c, uint64_t pins) {
+    const uint64_t in_pins = pins;
+    pins = m6526_tick(c, pins);
+    c->idle_ticks = _m6526_idle_ticks(c, in_pins);
+    c->idle_pins = in_pins & M6526_IDLE_INPUT_PINS;
+    return pins;
+}
+
 #endif /* CHIPS_IMPL */
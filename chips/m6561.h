@@ -126,7 +126,7 @@ typedef uint16_t (*m6561_fetch_t)(uint16_t addr, void* user_data);
 
 // setup parameters for m6561_init() function
 typedef struct {
-    // pointer and size of external framebuffer
+    // pointer and size of external framebuffer, or null for headless operation
     chips_range_t framebuffer;
     // visible CRT area decoded into framebuffer (in pixels)
     chips_rect_t screen;
@@ -238,6 +238,8 @@ void m6561_init(m6561_t* vic, const m6561_desc_t* desc);
 void m6561_reset(m6561_t* vic);
 // tick the m6561_t instance
 uint64_t m6561_tick(m6561_t* vic, uint64_t pins);
+// get the number of ticks until the next vertical retrace starts
+uint32_t m6561_ticks_to_vsync(const m6561_t* vic);
 // get the visible screen rect in pixels
 chips_rect_t m6561_screen(m6561_t* vic);
 // get the color palette
@@ -312,7 +314,7 @@ static void _m6561_init_crt(m6561_crt_t* crt, const m6561_desc_t* desc) {
 
 void m6561_init(m6561_t* vic, const m6561_desc_t* desc) {
     CHIPS_ASSERT(vic && desc && desc->fetch_cb);
-    CHIPS_ASSERT(desc->framebuffer.ptr && (desc->framebuffer.size >= M6561_FRAMEBUFFER_SIZE_BYTES));
+    CHIPS_ASSERT((0 == desc->framebuffer.ptr) || (desc->framebuffer.size >= M6561_FRAMEBUFFER_SIZE_BYTES));
     memset(vic, 0, sizeof(*vic));
     _m6561_init_crt(&vic->crt, desc);
     vic->border.enabled = _M6561_HBORDER|_M6561_VBORDER;
@@ -365,6 +367,16 @@ void m6561_reset(m6561_t* vic) {
     _m6561_reset_audio(vic);
 }
 
+// the vertical retrace starts in the tick which wraps the horizontal counter into line _M6561_VRETRACEPOS
+uint32_t m6561_ticks_to_vsync(const m6561_t* vic) {
+    CHIPS_ASSERT(vic);
+    const uint32_t frame_ticks = _M6561_HTOTAL * _M6561_VTOTAL;
+    const uint32_t cur_pos = vic->rs.v_count * _M6561_HTOTAL + vic->rs.h_count;
+    const uint32_t vsync_pos = _M6561_VRETRACEPOS * _M6561_HTOTAL;
+    const uint32_t ticks = (vsync_pos + frame_ticks - cur_pos) % frame_ticks;
+    return (0 == ticks) ? frame_ticks : ticks;
+}
+
 chips_rect_t m6561_screen(m6561_t* vic) {
     CHIPS_ASSERT(vic);
     return (chips_rect_t){
@@ -421,47 +433,57 @@ static inline void _m6561_decode_4pixels(m6561_t* vic, uint8_t* dst) {
         }
     }
     else {
-        uint8_t p = vic->gunit.shift;
+        // the pixel bits index into a small color table instead of branching per pixel
+        const uint8_t p = vic->gunit.shift;
         if (vic->gunit.color & 8) {
-            // multi-color mode
-            switch (p & 0xC0) {
-                case 0x00: dst[0] = dst[1] = vic->gunit.bg_color; break;
-                case 0x40: dst[0] = dst[1] = vic->gunit.brd_color; break;
-                case 0x80: dst[0] = dst[1] = vic->gunit.color & 7; break;
-                case 0xC0: dst[0] = dst[1] = vic->gunit.aux_color; break;
-            }
-            switch (p & 0x30) {
-                case 0x00: dst[2] = dst[3] = vic->gunit.bg_color; break;
-                case 0x10: dst[2] = dst[3] = vic->gunit.brd_color; break;
-                case 0x20: dst[2] = dst[3] = vic->gunit.color & 7; break;
-                case 0x30: dst[2] = dst[3] = vic->gunit.aux_color; break;
-            }
+            // multi-color mode, 2 bits per double-wide pixel
+            const uint8_t colors[4] = {
+                vic->gunit.bg_color,
+                vic->gunit.brd_color,
+                (uint8_t)(vic->gunit.color & 7),
+                vic->gunit.aux_color
+            };
+            dst[0] = dst[1] = colors[(p>>6) & 3];
+            dst[2] = dst[3] = colors[(p>>4) & 3];
         }
         else {
-            // hires mode
-            uint8_t bg, fg;
+            // hires mode, 1 bit per pixel
+            uint8_t colors[2];
             if (vic->gunit.inv_color) {
-                bg = vic->gunit.color & 7;
-                fg = vic->gunit.bg_color;
+                colors[0] = vic->gunit.color & 7;
+                colors[1] = vic->gunit.bg_color;
             }
             else {
-                bg = vic->gunit.bg_color;
-                fg = vic->gunit.color & 7;
+                colors[0] = vic->gunit.bg_color;
+                colors[1] = vic->gunit.color & 7;
             }
-            dst[0] = (p & (1<<7)) ? fg : bg;
-            dst[1] = (p & (1<<6)) ? fg : bg;
-            dst[2] = (p & (1<<5)) ? fg : bg;
-            dst[3] = (p & (1<<4)) ? fg : bg;
+            dst[0] = colors[(p>>7) & 1];
+            dst[1] = colors[(p>>6) & 1];
+            dst[2] = colors[(p>>5) & 1];
+            dst[3] = colors[(p>>4) & 1];
         }
         vic->gunit.shift = p<<4;
     }
 }
 
+/*  In the vertical border the video counter is stuck on an even value
+    (and only reloaded with the even vc_base), so all memory accesses are
+    c-accesses which overwrite each other's result without it being used.
+    Only the last c-access before the display area opens needs to happen.
+*/
+static inline bool _m6561_skip_c_access(m6561_t* vic) {
+    return (0 != (vic->rs.vc_disabled & _M6561_VVC_DISABLE)) &&
+           !((vic->rs.h_count == (_M6561_HTOTAL - 1)) && ((vic->rs.v_count + 1) == vic->border.top));
+}
+
 // tick function for video output
 static void _m6561_tick_video(m6561_t* vic) {
 
     // decode pixels, each tick is 4 pixels
-    if (vic->debug_vis) {
+    if (0 == vic->crt.fb) {
+        // headless, nothing to decode
+    }
+    else if (vic->debug_vis) {
         const size_t x = vic->rs.h_count;
         const size_t y = vic->rs.v_count;
         uint8_t* dst = vic->crt.fb + (y * M6561_FRAMEBUFFER_WIDTH) + (x * _M6561_PIXELS_PER_TICK);
@@ -501,7 +523,7 @@ static void _m6561_tick_video(m6561_t* vic) {
         vic->gunit.shift = (uint8_t) vic->fetch_cb(addr, vic->user_data);
         vic->gunit.color = (vic->mem.c_value>>8) & 0xF;
     }
-    else {
+    else if (!_m6561_skip_c_access(vic)) {
         // a c-access (character code and color)
         uint16_t addr = vic->mem.c_addr_base + (vic->rs.vc>>1);
         vic->mem.c_value = vic->fetch_cb(addr, vic->user_data);
@@ -37,6 +37,28 @@
     The real VIC-II has multiplexed address bus pins, the emulation
     doesn't.
 
+    ## Batched Line Decoding
+
+    Ticks without displayed sprites are not decoded immediately, instead
+    the graphics data, video matrix data and border state of each tick are
+    collected in a line buffer, and the collected ticks are decoded in one
+    pass (with the display mode switch hoisted out of the pixel loop) when
+    the beam leaves the visible area. The line buffer is flushed first with
+    the old state whenever a register is written, the graphics sequencer is
+    restarted or a sprite is displayed (those ticks are decoded one by one
+    because sprite collisions are visible to the CPU immediately), so the
+    result is identical to decoding each tick immediately. Call
+    m6569_flush_video() at the end of a frame or time slice to decode a
+    partially collected line before the framebuffer is displayed.
+
+    ## Vertical Sync
+
+    The VIC-II has a fixed PAL frame timing of 312 raster lines with 63 ticks
+    each, the beam returns to the top of the display in raster line 303.
+    Call m6569_ticks_to_vsync() to get the number of ticks until the
+    next vertical retrace, a system emulator can use this to run exactly
+    up to the end of a frame.
+
     TODO: Documentation
 
     ## zlib/libpng license
@@ -153,7 +175,8 @@ typedef uint16_t (*m6569_fetch_t)(uint16_t addr, void* user_data);
 
 // setup parameters for m6569_init() function
 typedef struct {
-    // pointer and size of external framebuffer (at least M6569_FRAMEBUFFER_SIZE_BYTES big)
+    // pointer and size of external framebuffer (at least M6569_FRAMEBUFFER_SIZE_BYTES big),
+    // or null for headless operation (video_disabled is then always set)
     chips_range_t framebuffer;
     // visible CRT area decoded into framebuffer (in pixels)
     chips_rect_t screen;
@@ -295,9 +318,25 @@ typedef struct {
     uint8_t colors[8][4];       // 0: unused, 1: multicolor0, 2: main color, 3: multicolor
 } m6569_sprite_unit_t;
 
+// ticks of the current rasterline waiting to be decoded (see 'Batched Line Decoding')
+typedef struct {
+    uint16_t x0, y;                     // framebuffer position of the first tick (in ticks and lines)
+    uint16_t num;                       // number of collected ticks
+    uint8_t g_data[M6569_HTOTAL];       // graphics data byte
+    uint8_t brd[M6569_HTOTAL];          // border flip-flops (bit 0: main, bit 1: vertical)
+    uint16_t c_data[M6569_HTOTAL];      // video matrix data (or 0 if the graphics sequencer is idle)
+} m6569_line_t;
+
+// statistics counters (only updated when CHIPS_STATS is defined)
+typedef struct {
+    uint32_t badline_ticks;     // ticks with BA active because of a badline
+    uint32_t sprite_dma_ticks;  // ticks with BA active because of sprite DMA
+} m6569_stats_t;
+
 // the m6569 state structure
 typedef struct {
     bool debug_vis;             // toggle this to switch debug visualization on/off
+    bool video_disabled;        // toggle this to skip writing pixels to the framebuffer
     m6569_registers_t reg;
     m6569_crt_t crt;
     m6569_border_unit_t brd;
@@ -306,6 +345,9 @@ typedef struct {
     m6569_graphics_unit_t gunit;
     m6569_sprite_unit_t sunit;
     m6569_video_matrix_t vm;
+    m6569_line_t line;
+    m6569_stats_t stats;
+    chips_dirty_lines_t dirty_lines;    // changed framebuffer lines, cleared by the system emulator
     uint64_t pins;
 } m6569_t;
 
@@ -315,6 +357,10 @@ void m6569_init(m6569_t* vic, const m6569_desc_t* desc);
 void m6569_reset(m6569_t* vic);
 // tick the m6569 instance
 uint64_t m6569_tick(m6569_t* vic, uint64_t pins);
+// decode the collected ticks of the current rasterline into the framebuffer
+void m6569_flush_video(m6569_t* vic);
+// get the number of ticks until the next vertical retrace starts (1..M6569_HTOTAL*M6569_VTOTAL)
+uint32_t m6569_ticks_to_vsync(const m6569_t* vic);
 // get the visible screen rect in pixels
 chips_rect_t m6569_screen(m6569_t* vic);
 // get the color palette
@@ -396,9 +442,10 @@ static void _m6569_init_crt(m6569_crt_t* crt, const m6569_desc_t* desc) {
 
 void m6569_init(m6569_t* vic, const m6569_desc_t* desc) {
     CHIPS_ASSERT(vic && desc);
-    CHIPS_ASSERT(desc->framebuffer.ptr && (desc->framebuffer.size >= M6569_FRAMEBUFFER_SIZE_BYTES));
+    CHIPS_ASSERT((0 == desc->framebuffer.ptr) || (desc->framebuffer.size >= M6569_FRAMEBUFFER_SIZE_BYTES));
     memset(vic, 0, sizeof(*vic));
     _m6569_init_crt(&vic->crt, desc);
+    vic->video_disabled = (0 == desc->framebuffer.ptr);
     vic->mem.fetch_cb = desc->fetch_cb;
     vic->mem.user_data = desc->user_data;
 }
@@ -449,6 +496,7 @@ static void _m6569_reset_crt(m6569_crt_t* c) {
 
 void m6569_reset(m6569_t* vic) {
     CHIPS_ASSERT(vic);
+    m6569_flush_video(vic);
     _m6569_reset_register_bank(&vic->reg);
     _m6569_reset_raster_unit(&vic->rs);
     _m6569_reset_crt(&vic->crt);
@@ -567,6 +615,8 @@ static uint64_t _m6569_read(m6569_t* vic, uint64_t pins) {
 
 // write chip registers
 static void _m6569_write(m6569_t* vic, uint64_t pins) {
+    // decode the collected ticks with the old register values first
+    m6569_flush_video(vic);
     m6569_registers_t* r = &vic->reg;
     uint8_t r_addr = pins & M6569_REG_MASK;
     const uint8_t data = M6569_GET_DATA(pins) & _m6569_reg_mask[r_addr];
@@ -711,6 +761,7 @@ static void _m6569_write(m6569_t* vic, uint64_t pins) {
    the graphics sequencer must be delayed by xscroll
 */
 static inline void _m6569_gunit_rewind(m6569_t* vic) {
+    m6569_flush_video(vic);
     const uint8_t xscroll = vic->reg.ctrl_2 & M6569_CTRL2_XSCROLL;
     vic->gunit.count = xscroll;
     vic->gunit.shift = 0;
@@ -724,11 +775,11 @@ static inline void _m6569_gunit_rewind(m6569_t* vic) {
    byte, and the video-matrix value with the current video-matrix-value
    (or 0 if the graphics sequencer is idle).
 */
-static inline void _m6569_gunit_tick(m6569_t* vic, uint8_t g_data) {
+static inline void _m6569_gunit_tick_cdata(m6569_t* vic, uint8_t g_data, uint16_t c_data) {
     if (vic->gunit.count == 0) {
         vic->gunit.count = 7;
         vic->gunit.shift |= g_data;
-        vic->gunit.c_data = vic->gunit.enabled ? vic->vm.line[vic->vm.vmli] : 0;
+        vic->gunit.c_data = c_data;
     } else {
         vic->gunit.count--;
     }
@@ -739,6 +790,14 @@ static inline void _m6569_gunit_tick(m6569_t* vic, uint8_t g_data) {
     vic->gunit.shift <<= 1;
 }
 
+static inline uint16_t _m6569_gunit_cdata(m6569_t* vic) {
+    return vic->gunit.enabled ? vic->vm.line[vic->vm.vmli] : 0;
+}
+
+static inline void _m6569_gunit_tick(m6569_t* vic, uint8_t g_data) {
+    _m6569_gunit_tick_cdata(vic, g_data, _m6569_gunit_cdata(vic));
+}
+
 /*
     graphics sequencer decoding functions for 1 pixel
 
@@ -834,6 +893,12 @@ static inline uint16_t _m6569_gunit_decode_mode4(m6569_t* vic) {
     }
 }
 
+// illegal modes 5, 6 and 7 output black
+static inline uint16_t _m6569_gunit_decode_illegal(m6569_t* vic) {
+    (void)vic;
+    return 0;
+}
+
 /*--- sprite sequencer helper ------------------------------------------------*/
 
 static inline void _m6569_sunit_start(m6569_t* vic) {
@@ -943,6 +1008,7 @@ static inline void _m6569_sunit_dma_disp_disable(m6569_t* vic) {
 // set the BA pin if one or multiple sprite's DMA is enabled
 static inline uint64_t _m6569_sunit_dma_ba(m6569_t* vic, uint8_t mask, uint64_t pins) {
     if (vic->sunit.dma_enabled & mask) {
+        CHIPS_STATS_INC(vic->stats.sprite_dma_ticks);
         pins |= M6569_BA;
     }
     return pins;
@@ -956,69 +1022,69 @@ static inline uint64_t _m6569_sunit_dma_aec(m6569_t* vic, uint8_t mask, uint64_t
     return pins;
 }
 
-static inline uint16_t _m6569_sunit_decode(m6569_t* vic, uint8_t hpos) {
-    /* this will tick all the sprite units and return the color
-        of the highest-priority sprite color for the current pixel in
-        the lower 8 bits of the result, the high 8 bits of the result
-        have one bit set for each sprite unit that produced a color
-        (used for collision detection)
+static inline void _m6569_sunit_decode(m6569_t* vic, uint8_t hpos, uint16_t* sc) {
+    /* this will tick all the sprite units for the next 8 pixels and write
+        the color of the highest-priority sprite color for each pixel in
+        the lower 8 bits of sc[], the high 8 bits of sc[] have one bit set
+        for each sprite unit that produced a color (used for collision
+        detection and the sprite/data priority check)
+
+        sc[] must be cleared by the caller, items remain 0 if the sprite
+        units didn't produce a color.
 
-        The function returns 0 if the sprite units didn't produce a color.
+        Each sprite unit is ticked for all 8 pixels at once, and
+        sprite-sprite collisions are computed once for the 8 pixels from
+        the per-sprite 8-bit coverage masks via bitwise ops.
     */
-    uint16_t c = 0;
     m6569_sprite_unit_t* su = &vic->sunit;
-    if (su->disp_enabled != 0) {
-        bool collision = false;
-        const uint8_t mxe = vic->reg.mxe;
-        const uint8_t mmc = vic->reg.mmc;
-        for (size_t i = 0; i < 8; i++) {
-            const uint8_t mask = 1 << i;
-            if ((su->disp_enabled & mask) && (hpos >= su->h_first[i]) && (hpos <= su->h_last[i])) {
-                if (su->delay_count[i] == 0) {
-                    if ((0 == (su->xexp_count[i]++ & 1)) || (0 == (mxe & mask))) {
-                        // bit 31 of outp is the current shifter output
-                        su->outp[i] = su->shift[i];
-                        // bits 31 and 30 of outp is half-frequency shifter output
-                        if (0 == (su->outp2_count[i]++ & 1)) {
-                            su->outp2[i] = su->shift[i];
-                        }
-                        su->shift[i] <<= 1;
+    const uint8_t mxe = vic->reg.mxe;
+    const uint8_t mmc = vic->reg.mmc;
+    uint8_t cover[8] = { 0 };   // one bit per pixel covered by a sprite
+    uint8_t once = 0;           // pixels covered by at least one sprite
+    uint8_t twice = 0;          // pixels covered by more than one sprite
+    for (size_t i = 0; i < 8; i++) {
+        const uint8_t mask = 1 << i;
+        if ((0 == (su->disp_enabled & mask)) || (hpos < su->h_first[i]) || (hpos > su->h_last[i])) {
+            continue;
+        }
+        const uint16_t sprite_bit = 1 << (8 + i);
+        for (size_t px = 0; px < 8; px++) {
+            if (su->delay_count[i] == 0) {
+                if ((0 == (su->xexp_count[i]++ & 1)) || (0 == (mxe & mask))) {
+                    // bit 31 of outp is the current shifter output
+                    su->outp[i] = su->shift[i];
+                    // bits 31 and 30 of outp is half-frequency shifter output
+                    if (0 == (su->outp2_count[i]++ & 1)) {
+                        su->outp2[i] = su->shift[i];
                     }
-                    if (mmc & mask) {
-                        // multicolor mode
-                        uint32_t ci = (su->outp2[i] & ((1<<31)|(1<<30)))>>30;
-                        if (ci != 0) {
-                            // don't overwrite higher-priority colors
-                            if (0 == c) {
-                                c = su->colors[i][ci];
-                            } else {
-                                collision = true;
-                            }
-                            c |= (1<<(8+i));
-                        }
-                    } else {
-                        /* standard color mode */
-                        if (su->outp[i] & (1<<31)) {
-                            /* don't overwrite higher-priority colors */
-                            if (0 == c) {
-                                c = su->colors[i][2] | (1<<(24+i));
-                            } else {
-                                collision = true;
-                            }
-                            c |= (1<<(8+i));
-                        }
+                    su->shift[i] <<= 1;
+                }
+                // multicolor mode or standard color mode
+                const uint32_t ci = (mmc & mask) ? ((su->outp2[i] & ((1U<<31)|(1U<<30)))>>30) : ((su->outp[i] & (1U<<31)) ? 2 : 0);
+                if (ci != 0) {
+                    // don't overwrite higher-priority colors
+                    if (0 == (sc[px] & 0xFF00)) {
+                        sc[px] = su->colors[i][ci];
                     }
-                } else {
-                    su->delay_count[i]--;
+                    sc[px] |= sprite_bit;
+                    cover[i] |= (uint8_t)(1 << px);
                 }
+            } else {
+                su->delay_count[i]--;
             }
         }
-        if (collision) {
-            vic->reg.mcm |= (c>>8);
-            vic->reg.int_latch |= M6569_INT_IMMC;
+        twice |= once & cover[i];
+        once |= cover[i];
+    }
+    if (twice != 0) {
+        // each sprite covering a pixel which is covered by another sprite has collided
+        for (size_t i = 0; i < 8; i++) {
+            if (cover[i] & twice) {
+                vic->reg.mcm |= (uint8_t)(1 << i);
+            }
         }
+        vic->reg.int_latch |= M6569_INT_IMMC;
     }
-    return c;
 }
 
 /*
@@ -1108,10 +1174,14 @@ static inline void _m6569_decode_pixels(m6569_t* vic, uint8_t g_data, uint8_t* d
     uint8_t brd_color = vic->brd.main ? vic->brd.bc : vic->gunit.bg[0];
     const uint8_t mdp = vic->reg.mdp;
     const uint8_t mode = vic->gunit.mode;
+    // lower 8 bit sprite color, top 8 bit 'coverage mask'
+    uint16_t sprite_colors[8] = { 0 };
+    if (su->disp_enabled != 0) {
+        _m6569_sunit_decode(vic, hpos, sprite_colors);
+    }
     uint16_t bmc = 0;
     for (size_t i = 0; i < 8; i++) {
-        // lower 8 bit sprite color, top 8 bit 'coverage mask'
-        uint16_t sc = _m6569_sunit_decode(vic, hpos);
+        const uint16_t sc = sprite_colors[i];
         _m6569_gunit_tick(vic, g_data);
         // bmc: lower 8 bit color, top 8 bit set (foregreound) or cleared (background)
         switch (mode) {
@@ -1128,6 +1198,67 @@ static inline void _m6569_decode_pixels(m6569_t* vic, uint8_t g_data, uint8_t* d
     }
 }
 
+// decode all collected ticks of the line buffer with the same display mode (without sprites)
+#define _M6569_DECODE_LINE(func) \
+    for (size_t ti = 0; ti < line->num; ti++) { \
+        const uint8_t g_data = line->g_data[ti]; \
+        const uint16_t c_data = line->c_data[ti]; \
+        const uint8_t brd = line->brd[ti]; \
+        const uint8_t brd_color = (brd & 1) ? vic->brd.bc : (uint8_t)vic->gunit.bg[0]; \
+        uint8_t* dst = &pixels[ti * M6569_PIXELS_PER_TICK]; \
+        for (size_t i = 0; i < M6569_PIXELS_PER_TICK; i++) { \
+            _m6569_gunit_tick_cdata(vic, g_data, c_data); \
+            const uint16_t bmc = func(vic); \
+            dst[i] = brd ? brd_color : (uint8_t)bmc; \
+        } \
+    }
+
+void m6569_flush_video(m6569_t* vic) {
+    CHIPS_ASSERT(vic);
+    m6569_line_t* line = &vic->line;
+    if (0 == line->num) {
+        return;
+    }
+    CHIPS_ASSERT(vic->crt.fb && (line->num <= M6569_HTOTAL));
+    uint8_t pixels[M6569_HTOTAL * M6569_PIXELS_PER_TICK];
+    switch (vic->gunit.mode) {
+        case 0: _M6569_DECODE_LINE(_m6569_gunit_decode_mode0); break;
+        case 1: _M6569_DECODE_LINE(_m6569_gunit_decode_mode1); break;
+        case 2: _M6569_DECODE_LINE(_m6569_gunit_decode_mode2); break;
+        case 3: _M6569_DECODE_LINE(_m6569_gunit_decode_mode3); break;
+        case 4: _M6569_DECODE_LINE(_m6569_gunit_decode_mode4); break;
+        case 5: case 6: case 7: _M6569_DECODE_LINE(_m6569_gunit_decode_illegal); break;
+        default: _M6569_UNREACHABLE;
+    }
+    const size_t num_bytes = (size_t)line->num * M6569_PIXELS_PER_TICK;
+    uint8_t* dst = vic->crt.fb + (line->y * M6569_FRAMEBUFFER_WIDTH) + (line->x0 * M6569_PIXELS_PER_TICK);
+    if (0 != memcmp(dst, pixels, num_bytes)) {
+        memcpy(dst, pixels, num_bytes);
+        chips_dirty_lines_set(&vic->dirty_lines, line->y);
+    }
+    line->num = 0;
+}
+#undef _M6569_DECODE_LINE
+
+/*
+    The 'no video output' version of _m6569_decode_pixels(), this only
+    updates the state which is visible to the CPU (sprite collisions), and
+    the graphics sequencer state, but doesn't write any pixels. If no sprites
+    are displayed, sprite collisions can't happen and the whole color
+    decoding can be skipped.
+*/
+static inline void _m6569_decode_pixels_novideo(m6569_t* vic, uint8_t g_data) {
+    if (vic->sunit.disp_enabled != 0) {
+        uint8_t dummy[8];
+        _m6569_decode_pixels(vic, g_data, dummy);
+    }
+    else {
+        for (size_t i = 0; i < 8; i++) {
+            _m6569_gunit_tick(vic, g_data);
+        }
+    }
+}
+
 /* decode the next 8 pixels as debug visualization */
 static void _m6569_decode_pixels_debug(m6569_t* vic, uint8_t g_data, bool ba_pin, uint8_t* dst) {
     _m6569_decode_pixels(vic, g_data, dst);
@@ -1398,6 +1529,7 @@ static inline uint8_t _m6569_s_i_access(m6569_t* vic, uint32_t s_index) {
 // set BA pin if badline flag is set
 static inline uint64_t _m6569_ba(m6569_t* vic, uint64_t pins) {
     if (vic->rs.badline) {
+        CHIPS_STATS_INC(vic->stats.badline_ticks);
         pins |= M6569_BA;
     }
     return pins;
@@ -1597,19 +1729,59 @@ static uint64_t _m6569_tick(m6569_t* vic, uint64_t pins) {
     }
 
     //--- decode pixels into framebuffer
-    if (vic->debug_vis) {
+    if (vic->debug_vis && vic->crt.fb) {
+        // the debug visualization decodes each tick immediately
+        m6569_flush_video(vic);
         const size_t x = vic->rs.h_count;
         const size_t y = vic->rs.v_count;
         uint8_t* dst = vic->crt.fb + (y * M6569_FRAMEBUFFER_WIDTH) + (x * M6569_PIXELS_PER_TICK);
         _m6569_decode_pixels_debug(vic, g_data, 0 != (pins & M6569_BA), dst);
+        // the debug visualization may also touch the previous line
+        chips_dirty_lines_set(&vic->dirty_lines, y);
+        if ((x == 0) && (y > 0)) {
+            chips_dirty_lines_set(&vic->dirty_lines, y - 1);
+        }
     }
     else if ((vic->crt.x >= vic->crt.vis_x0) && (vic->crt.x < vic->crt.vis_x1) &&
              (vic->crt.y >= vic->crt.vis_y0) && (vic->crt.y < vic->crt.vis_y1))
     {
-        const size_t x = vic->crt.x - vic->crt.vis_x0;
-        const size_t y = vic->crt.y - vic->crt.vis_y0;
-        uint8_t* dst = vic->crt.fb + (y * M6569_FRAMEBUFFER_WIDTH) + (x * M6569_PIXELS_PER_TICK);
-        _m6569_decode_pixels(vic, g_data, dst);
+        if (vic->video_disabled) {
+            _m6569_decode_pixels_novideo(vic, g_data);
+        }
+        else {
+            const uint16_t x = vic->crt.x - vic->crt.vis_x0;
+            const uint16_t y = vic->crt.y - vic->crt.vis_y0;
+            m6569_line_t* line = &vic->line;
+            if ((line->num > 0) && ((line->y != y) || ((line->x0 + line->num) != x))) {
+                m6569_flush_video(vic);
+            }
+            if (vic->sunit.disp_enabled != 0) {
+                // sprites are displayed, decode this tick immediately
+                m6569_flush_video(vic);
+                uint8_t* dst = vic->crt.fb + (y * M6569_FRAMEBUFFER_WIDTH) + (x * M6569_PIXELS_PER_TICK);
+                uint64_t old_pixels;
+                memcpy(&old_pixels, dst, sizeof(old_pixels));
+                _m6569_decode_pixels(vic, g_data, dst);
+                if (0 != memcmp(&old_pixels, dst, sizeof(old_pixels))) {
+                    chips_dirty_lines_set(&vic->dirty_lines, y);
+                }
+            }
+            else {
+                // collect the tick in the line buffer, decoding happens in m6569_flush_video()
+                if (0 == line->num) {
+                    line->x0 = x;
+                    line->y = y;
+                }
+                const uint16_t i = line->num++;
+                line->g_data[i] = g_data;
+                line->c_data[i] = _m6569_gunit_cdata(vic);
+                line->brd[i] = (vic->brd.main ? 1 : 0) | (vic->brd.vert ? 2 : 0);
+            }
+        }
+    }
+    else if (vic->line.num > 0) {
+        // the beam has left the visible area, decode the whole line
+        m6569_flush_video(vic);
     }
     vic->rs.vc = vic->rs.next_vc;
     vic->vm.vmli = vic->vm.next_vmli;
@@ -1633,6 +1805,19 @@ uint64_t m6569_tick(m6569_t* vic, uint64_t pins) {
     return pins;
 }
 
+/* the beam position is advanced at the start of a tick, and the vertical
+   retrace starts in the tick which advances the horizontal counter to 4
+   in raster line _M6569_VRETRACEPOS (see _m6569_crt_next_crtline())
+*/
+uint32_t m6569_ticks_to_vsync(const m6569_t* vic) {
+    CHIPS_ASSERT(vic);
+    const uint32_t frame_ticks = M6569_HTOTAL * M6569_VTOTAL;
+    const uint32_t cur_pos = vic->rs.v_count * M6569_HTOTAL + vic->rs.h_count;
+    const uint32_t vsync_pos = _M6569_VRETRACEPOS * M6569_HTOTAL + 4;
+    const uint32_t ticks = (vsync_pos + frame_ticks - cur_pos) % frame_ticks;
+    return (0 == ticks) ? frame_ticks : ticks;
+}
+
 chips_rect_t m6569_screen(m6569_t* vic) {
     CHIPS_ASSERT(vic);
     return (chips_rect_t){
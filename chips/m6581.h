@@ -214,6 +214,7 @@ typedef struct {
     int nyquist_freq;
     int resonance_coeff_div_1024;
     int w0;
+    int w0_dt;      // w0 / (1<<6), updated together with w0
     int v_hp;
     int v_bp;
     int v_lp;
@@ -234,8 +235,8 @@ typedef struct {
     // sample generation state
     int sample_period;
     int sample_counter;
-    float sample_accum;
-    float sample_accum_count;
+    int sample_accum;           // sum of the integer output values since the last sample
+    int sample_accum_count;
     float sample_mag;
     float sample;
     // debug inspection
@@ -265,6 +266,14 @@ uint64_t m6581_tick(m6581_t* sid, uint64_t pins);
     #define CHIPS_ASSERT(c) assert(c)
 #endif
 
+#if defined(__GNUC__)
+#define _M6581_FORCE_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define _M6581_FORCE_INLINE __forceinline
+#else
+#define _M6581_FORCE_INLINE inline
+#endif
+
 /* extract 8-bit data bus from 64-bit pins */
 #define M6581_GET_DATA(p) ((uint8_t)(((p)&0xFF0000ULL)>>16))
 /* merge 8-bit data bus value into 64-bit pins */
@@ -302,8 +311,6 @@ static const uint8_t _m6581_env_gen_dr_divisors[256] = {
     1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1
 };
 
-static float _m6581_cutoff_freq[2048];
-
 static void _m6581_init_voice(m6581_voice_t* v) {
     memset(v, 0, sizeof(*v));
     v->noise_shift = 0x007FFFFC;
@@ -311,12 +318,15 @@ static void _m6581_init_voice(m6581_voice_t* v) {
     v->env_counter = 0x7FFF;
 }
 
-static void _m6581_init_cutoff_table() {
-    for (int i = 0; i < 2048; i++) {
-        float x = i / 8.0f;
-        float cf = -0.0156f * x * x + 48.473f * x - 45.074f;
-        _m6581_cutoff_freq[i] = cf <= 0 ? 0 : cf;
-    }
+/* map the 11-bit cutoff register value to the cutoff frequency, this is
+   only evaluated when the cutoff register is written (instead of a static
+   lookup table which would need to be initialized, and which wouldn't
+   be thread-safe when running multiple emulator instances in parallel)
+*/
+static float _m6581_cutoff_freq(uint16_t cutoff) {
+    float x = cutoff / 8.0f;
+    float cf = -0.0156f * x * x + 48.473f * x - 45.074f;
+    return cf <= 0 ? 0 : cf;
 }
 
 static void _m6581_set_filter_cutoff(m6581_filter_t*);
@@ -338,11 +348,10 @@ void m6581_init(m6581_t* sid, const m6581_desc_t* desc) {
     sid->sample_period = (desc->tick_hz * M6581_FIXEDPOINT_SCALE) / desc->sound_hz;
     sid->sample_counter = sid->sample_period;
     sid->sample_mag = desc->magnitude;
-    sid->sample_accum_count = 1.0f;
+    sid->sample_accum_count = 1;
     for (int i = 0; i < 3; i++) {
         _m6581_init_voice(&sid->voice[i]);
     }
-    _m6581_init_cutoff_table();
     _m6581_init_filter(&sid->filter, sid->sound_hz);
 }
 
@@ -356,8 +365,8 @@ void m6581_reset(m6581_t* sid) {
     _m6581_init_filter(&sid->filter, sid->sound_hz);
     sid->sample_counter = sid->sample_period;
     sid->sample = 0.0f;
-    sid->sample_accum = 0.0f;
-    sid->sample_accum_count = 1.0f;
+    sid->sample_accum = 0;
+    sid->sample_accum_count = 1;
     sid->pins = 0;
 }
 
@@ -498,7 +507,7 @@ static inline uint16_t _m6581_noise(m6581_voice_t* v) {
            (M6581_BIT(s,2)<<4);
 }
 
-static inline void _m6581_voice_tick(m6581_t* sid, int voice_index) {
+static _M6581_FORCE_INLINE void _m6581_voice_tick(m6581_t* sid, int voice_index) {
     m6581_voice_t* v = &sid->voice[voice_index];
 
     /* waveform generator */
@@ -573,7 +582,7 @@ static inline void _m6581_voice_tick(m6581_t* sid, int voice_index) {
     }
 }
 
-static inline void _m6581_voice_sync(m6581_t* sid, int voice_index) {
+static _M6581_FORCE_INLINE void _m6581_voice_sync(m6581_t* sid, int voice_index) {
     m6581_voice_t* v = &sid->voice[voice_index];
     m6581_voice_t* v_sync = &sid->voice[(voice_index+2)%3];
     if (v->sync && (v_sync->ctrl & M6581_CTRL_SYNC)) {
@@ -584,13 +593,14 @@ static inline void _m6581_voice_sync(m6581_t* sid, int voice_index) {
 /*--- FILTER IMPLEMENTATION ---------------------------------------------------*/
 static void _m6581_set_filter_cutoff(m6581_filter_t* f) {
     const float freq_domain_div_coeff = 2.0f * ((float)M_PI) * 1.048576f;
-    f->w0 = (int) (_m6581_cutoff_freq[f->cutoff] * freq_domain_div_coeff);
+    f->w0 = (int) (_m6581_cutoff_freq(f->cutoff) * freq_domain_div_coeff);
     const float nyquist_freq = (float) f->nyquist_freq;
     const float max_cutoff = nyquist_freq > 16000.0f ? 16000.0f : nyquist_freq;
     const int w0_max_dt = (int)(max_cutoff * freq_domain_div_coeff);
     if (f->w0 > w0_max_dt) {
         f->w0 = w0_max_dt;
     }
+    f->w0_dt = f->w0 / (1<<6);
 }
 
 static void _m6581_set_resonance(m6581_filter_t* f) {
@@ -622,7 +632,7 @@ static void _m6581_set_modevol(m6581_t* sid, uint8_t data) {
 }
 
 static inline int _m6581_filter_output(m6581_filter_t* f, int vi) {
-    int w0_dt = f->w0 / (1<<6);
+    const int w0_dt = f->w0_dt;
     vi = vi / (1<<7);
 
     int d_vlp = (w0_dt * f->v_bp) / (1<<14);
@@ -654,13 +664,14 @@ static uint64_t _m6581_tick(m6581_t* sid, uint64_t pins) {
     }
 
     /* tick wave and envelope generators */
-    for (int i = 0; i < 3; i++) {
-        _m6581_voice_tick(sid, i);
-    }
+    /* (explicitly unrolled so that the voice indices are compile-time constants) */
+    _m6581_voice_tick(sid, 0);
+    _m6581_voice_tick(sid, 1);
+    _m6581_voice_tick(sid, 2);
     /* handle voice synchronization */
-    for (int i = 0; i < 3; i++) {
-        _m6581_voice_sync(sid, i);
-    }
+    _m6581_voice_sync(sid, 0);
+    _m6581_voice_sync(sid, 1);
+    _m6581_voice_sync(sid, 2);
     /* filter */
     int sum_filtered_outp = 0;
     int sum_outp = 0;
@@ -680,19 +691,26 @@ static uint64_t _m6581_tick(m6581_t* sid, uint64_t pins) {
             }
         }
     }
-    int accu = (sum_outp + _m6581_filter_output(&sid->filter, sum_filtered_outp) + M6581_DCMIXER) * sid->filter.volume;
-    int sample = accu / (1<<12);
-    sid->sample_accum += (sample / 16384.0f);
-    sid->sample_accum_count += 1.0f;
+    /* fast path: if no voice is routed through the filter and the filter
+       has settled, the filter output is zero and the filter state doesn't change
+    */
+    int filter_outp = 0;
+    if ((0 != sid->filter.voices) || (0 != (sid->filter.v_lp | sid->filter.v_bp | sid->filter.v_hp))) {
+        filter_outp = _m6581_filter_output(&sid->filter, sum_filtered_outp);
+    }
+    int accu = (sum_outp + filter_outp + M6581_DCMIXER) * sid->filter.volume;
+    // accumulate in integer, the conversion to float only happens once per output sample
+    sid->sample_accum += accu / (1<<12);
+    sid->sample_accum_count++;
 
     /* new sample? */
     sid->sample_counter -= M6581_FIXEDPOINT_SCALE;
     if (sid->sample_counter <= 0) {
         sid->sample_counter += sid->sample_period;
-        float s = sid->sample_accum / sid->sample_accum_count;
+        float s = (float)sid->sample_accum / ((float)sid->sample_accum_count * 16384.0f);
         sid->sample = sid->sample_mag * s;
-        sid->sample_accum = 0.0f;
-        sid->sample_accum_count = 0.0f;
+        sid->sample_accum = 0;
+        sid->sample_accum_count = 0;
         pins |= M6581_SAMPLE;
     }
     else {
@@ -28,6 +28,22 @@
            CSS -->|           |
                   +-----------+
 
+    ## Row Fetching
+
+    By default the MC6847 calls the fetch callback once per video memory
+    byte with the address on the address bus pins, and the callback
+    returns the data bus pins (and may also set the INV, AS and INT/EXT
+    mode select pins if those are wired to the video memory data bus).
+
+    Alternatively, a row-fetch callback can be provided which copies all
+    video memory bytes of a scanline (16 or 32 bytes) in one call. Since
+    the row-fetch callback doesn't return pins, the data bus bits which
+    are wired to the INV, AS and INT/EXT pins must be described with the
+    inv_mask, as_mask and intext_mask setup parameters instead.
+
+    Pixels are decoded with precomputed bit-expansion tables, so that most
+    video memory bytes only need a table lookup and a few bit operations.
+
     FIXME: documentation
 
     ## zlib/libpng license
@@ -250,17 +266,26 @@ extern "C" {
 
 // a memory-fetch callback, used to read video memory bytes into the MC6847
 typedef uint64_t (*mc6847_fetch_t)(uint64_t pins, void* user_data);
+// an optional row-fetch callback, copies num_bytes video memory bytes starting at addr into dst
+typedef void (*mc6847_fetch_row_t)(uint16_t addr, uint8_t* dst, size_t num_bytes, void* user_data);
 
 // the mc6847 setup parameters
 typedef struct {
     // the CPU tick rate in hz
     int tick_hz;
-    // pointer to an uint8_t framebuffer where video image is written to (must be at least 512*244 bytes)
+    // pointer to an uint8_t framebuffer where video image is written to (must be at least 512*244 bytes),
+    // or null for headless operation (only the sync signals are generated)
     chips_range_t framebuffer;
     // memory-fetch callback
     mc6847_fetch_t fetch_cb;
-    // optional user-data for the fetch callback
+    // optional row-fetch callback, used instead of fetch_cb when provided
+    mc6847_fetch_row_t fetch_row_cb;
+    // optional user-data for the fetch callbacks
     void* user_data;
+    // with fetch_row_cb: data bus bits wired to the INV, AS and INT/EXT pins (0 if not wired)
+    uint8_t inv_mask;
+    uint8_t as_mask;
+    uint8_t intext_mask;
 } mc6847_desc_t;
 
 // the mc6847 state struct
@@ -278,10 +303,15 @@ typedef struct {
     // true during field-sync
     bool fs;
 
-    // the fetch callback function
+    // the fetch callback functions
     mc6847_fetch_t fetch_cb;
+    mc6847_fetch_row_t fetch_row_cb;
     // optional user-data for the fetch-callback
     void* user_data;
+    // data bus bits wired to the INV, AS and INT/EXT pins (only with fetch_row_cb)
+    uint8_t inv_mask;
+    uint8_t as_mask;
+    uint8_t intext_mask;
     // pointer to uint8_t buffer where decoded video image is written too
     uint8_t* fb;
     // hardware colors
@@ -316,14 +346,18 @@ void mc6847_snapshot_onload(mc6847_t* snapshot, mc6847_t* sys);
 
 void mc6847_init(mc6847_t* vdg, const mc6847_desc_t* desc) {
     CHIPS_ASSERT(vdg && desc);
-    CHIPS_ASSERT(desc->framebuffer.ptr && (desc->framebuffer.size <= MC6847_FRAMEBUFFER_SIZE_BYTES));
-    CHIPS_ASSERT(desc->fetch_cb);
+    CHIPS_ASSERT((0 == desc->framebuffer.ptr) || (desc->framebuffer.size >= MC6847_FRAMEBUFFER_SIZE_BYTES));
+    CHIPS_ASSERT(desc->fetch_cb || desc->fetch_row_cb);
     CHIPS_ASSERT((desc->tick_hz > 0) && (desc->tick_hz < MC6847_TICK_HZ));
 
     memset(vdg, 0, sizeof(*vdg));
     vdg->fb = desc->framebuffer.ptr;
     vdg->fetch_cb = desc->fetch_cb;
+    vdg->fetch_row_cb = desc->fetch_row_cb;
     vdg->user_data = desc->user_data;
+    vdg->inv_mask = desc->inv_mask;
+    vdg->as_mask = desc->as_mask;
+    vdg->intext_mask = desc->intext_mask;
 
     /* compute counter periods, the MC6847 is always clocked at 3.579 MHz,
        and the frequency of how the tick function is called must be
@@ -454,6 +488,89 @@ static const uint8_t _mc6847_font[64 * 12] = {
     0x00, 0x00, 0x00, 0x18, 0x24, 0x04, 0x08, 0x08, 0x00, 0x08, 0x00, 0x00,
 };
 
+/*
+    bit-expansion tables, each entry has one byte per pixel which
+    is 0xFF if the pixel bit is set, or 0x00 if cleared (MSB first)
+
+    _mc6847_bits8:  8 bits to 8 pixels
+    _mc6847_bits4x2: 4 bits to 8 pixels (2 pixels per bit)
+*/
+#define _MC6847_B(v,b) ((((v)>>(b))&1)*0xFF)
+#define _MC6847_BITS8(v) { _MC6847_B(v,7), _MC6847_B(v,6), _MC6847_B(v,5), _MC6847_B(v,4), _MC6847_B(v,3), _MC6847_B(v,2), _MC6847_B(v,1), _MC6847_B(v,0) }
+#define _MC6847_BITS4X2(v) { _MC6847_B(v,3), _MC6847_B(v,3), _MC6847_B(v,2), _MC6847_B(v,2), _MC6847_B(v,1), _MC6847_B(v,1), _MC6847_B(v,0), _MC6847_B(v,0) }
+#define _MC6847_BITS8_X16(v) \
+    _MC6847_BITS8(v+0x0), _MC6847_BITS8(v+0x1), _MC6847_BITS8(v+0x2), _MC6847_BITS8(v+0x3), \
+    _MC6847_BITS8(v+0x4), _MC6847_BITS8(v+0x5), _MC6847_BITS8(v+0x6), _MC6847_BITS8(v+0x7), \
+    _MC6847_BITS8(v+0x8), _MC6847_BITS8(v+0x9), _MC6847_BITS8(v+0xA), _MC6847_BITS8(v+0xB), \
+    _MC6847_BITS8(v+0xC), _MC6847_BITS8(v+0xD), _MC6847_BITS8(v+0xE), _MC6847_BITS8(v+0xF)
+static const uint8_t _mc6847_bits8[256][8] = {
+    _MC6847_BITS8_X16(0x00), _MC6847_BITS8_X16(0x10), _MC6847_BITS8_X16(0x20), _MC6847_BITS8_X16(0x30),
+    _MC6847_BITS8_X16(0x40), _MC6847_BITS8_X16(0x50), _MC6847_BITS8_X16(0x60), _MC6847_BITS8_X16(0x70),
+    _MC6847_BITS8_X16(0x80), _MC6847_BITS8_X16(0x90), _MC6847_BITS8_X16(0xA0), _MC6847_BITS8_X16(0xB0),
+    _MC6847_BITS8_X16(0xC0), _MC6847_BITS8_X16(0xD0), _MC6847_BITS8_X16(0xE0), _MC6847_BITS8_X16(0xF0),
+};
+static const uint8_t _mc6847_bits4x2[16][8] = {
+    _MC6847_BITS4X2(0x0), _MC6847_BITS4X2(0x1), _MC6847_BITS4X2(0x2), _MC6847_BITS4X2(0x3),
+    _MC6847_BITS4X2(0x4), _MC6847_BITS4X2(0x5), _MC6847_BITS4X2(0x6), _MC6847_BITS4X2(0x7),
+    _MC6847_BITS4X2(0x8), _MC6847_BITS4X2(0x9), _MC6847_BITS4X2(0xA), _MC6847_BITS4X2(0xB),
+    _MC6847_BITS4X2(0xC), _MC6847_BITS4X2(0xD), _MC6847_BITS4X2(0xE), _MC6847_BITS4X2(0xF),
+};
+#undef _MC6847_BITS8_X16
+#undef _MC6847_BITS4X2
+#undef _MC6847_BITS8
+#undef _MC6847_B
+
+// expand 8 pixels from a bit-expansion table entry into 2 colors (replicated into all bytes)
+static inline void _mc6847_expand8(uint8_t* dst, const uint8_t* bits, uint64_t fg, uint64_t bg) {
+    uint64_t mask;
+    memcpy(&mask, bits, sizeof(mask));
+    const uint64_t pixels = (fg & mask) | (bg & ~mask);
+    memcpy(dst, &pixels, sizeof(pixels));
+}
+
+// replicate a color index into all bytes of an uint64_t
+static inline uint64_t _mc6847_color8(uint8_t c) {
+    return c * 0x0101010101010101ULL;
+}
+
+// per-byte mode select pins in the row fetch buffer
+#define _MC6847_ROW_INV     (1<<0)
+#define _MC6847_ROW_AS      (1<<1)
+#define _MC6847_ROW_INTEXT  (1<<2)
+
+static inline uint8_t _mc6847_row_ctrl(uint64_t pins) {
+    return ((pins & MC6847_INV) ? _MC6847_ROW_INV : 0) |
+           ((pins & MC6847_AS) ? _MC6847_ROW_AS : 0) |
+           ((pins & MC6847_INTEXT) ? _MC6847_ROW_INTEXT : 0);
+}
+
+/*  fetch the video memory bytes of a scanline and the state of the
+    INV, AS and INT/EXT pins for each byte, returns the pin mask
+    after the last fetch
+*/
+static uint64_t _mc6847_fetch_row(mc6847_t* vdg, uint64_t pins, uint16_t addr, size_t num_bytes, uint8_t* data, uint8_t* ctrl) {
+    if (vdg->fetch_row_cb) {
+        vdg->fetch_row_cb(addr, data, num_bytes, vdg->user_data);
+        for (size_t i = 0; i < num_bytes; i++) {
+            const uint8_t d = data[i];
+            if (vdg->inv_mask)    { pins = (d & vdg->inv_mask) ? (pins | MC6847_INV) : (pins & ~MC6847_INV); }
+            if (vdg->as_mask)     { pins = (d & vdg->as_mask) ? (pins | MC6847_AS) : (pins & ~MC6847_AS); }
+            if (vdg->intext_mask) { pins = (d & vdg->intext_mask) ? (pins | MC6847_INTEXT) : (pins & ~MC6847_INTEXT); }
+            ctrl[i] = _mc6847_row_ctrl(pins);
+        }
+        MC6847_SET_ADDR(pins, addr + num_bytes - 1);
+        MC6847_SET_DATA(pins, data[num_bytes - 1]);
+    }
+    else {
+        for (size_t i = 0; i < num_bytes; i++) {
+            MC6847_SET_ADDR(pins, addr + i);
+            pins = vdg->fetch_cb(pins, vdg->user_data);
+            data[i] = MC6847_GET_DATA(pins);
+            ctrl[i] = _mc6847_row_ctrl(pins);
+        }
+    }
+    return pins;
+}
 
 static inline uint8_t _mc6847_border_color(uint64_t pins) {
     if (pins & MC6847_AG) {
@@ -477,12 +594,12 @@ static void _mc6847_decode_border(mc6847_t* vdg, uint64_t pins, size_t y) {
 static uint64_t _mc6847_decode_scanline(mc6847_t* vdg, uint64_t pins, size_t y) {
     uint8_t* dst = &(vdg->fb[(y + MC6847_TOP_BORDER_LINES) * MC6847_FRAMEBUFFER_WIDTH]);
     uint8_t bc = _mc6847_border_color(pins);
-    void* ud = vdg->user_data;
+    uint8_t data[32];
+    uint8_t ctrl[32];
 
     // left border
-    for (size_t i = 0; i < MC6847_BORDER_PIXELS; i++) {
-        *dst++ = bc;
-    }
+    memset(dst, bc, MC6847_BORDER_PIXELS);
+    dst += MC6847_BORDER_PIXELS;
 
     // visible scanline
     if (pins & MC6847_AG) {
@@ -496,20 +613,23 @@ static uint64_t _mc6847_decode_scanline(mc6847_t* vdg, uint64_t pins, size_t y)
                     10:    RG3, 128x192, 16 bytes per row
                     11:    RG6, 256x192, 32 bytes per row
             */
-            size_t dots_per_bit  = (sub_mode < 3) ? 2 : 1;
             size_t bytes_per_row = (sub_mode < 3) ? 16 : 32;
             size_t row_height = (pins & MC6847_GM2) ? 1 : (pins & MC6847_GM1) ? 2 : 3;
             uint16_t addr = (y / row_height) * bytes_per_row;
-            uint8_t fg_color = (pins & MC6847_CSS) ? MC6847_HWCOLOR_GFX_BUFF : MC6847_HWCOLOR_GFX_GREEN;
-            for (size_t x = 0; x < bytes_per_row; x++) {
-                MC6847_SET_ADDR(pins, addr++);
-                pins = vdg->fetch_cb(pins, ud);
-                uint8_t m = MC6847_GET_DATA(pins);
-                for (int p = 7; p >= 0; p--) {
-                    uint8_t c = ((m>>p) & 1) ? fg_color : MC6847_HWCOLOR_BLACK;
-                    for (size_t d = 0; d < dots_per_bit; d++) {
-                        *dst++ = c;
-                    }
+            const uint64_t fg = _mc6847_color8((pins & MC6847_CSS) ? MC6847_HWCOLOR_GFX_BUFF : MC6847_HWCOLOR_GFX_GREEN);
+            const uint64_t bg = _mc6847_color8(MC6847_HWCOLOR_BLACK);
+            pins = _mc6847_fetch_row(vdg, pins, addr, bytes_per_row, data, ctrl);
+            if (sub_mode < 3) {
+                // 2 dots per bit
+                for (size_t x = 0; x < bytes_per_row; x++, dst += 16) {
+                    const uint8_t m = data[x];
+                    _mc6847_expand8(dst, _mc6847_bits4x2[m>>4], fg, bg);
+                    _mc6847_expand8(dst + 8, _mc6847_bits4x2[m & 0xF], fg, bg);
+                }
+            }
+            else {
+                for (size_t x = 0; x < bytes_per_row; x++, dst += 8) {
+                    _mc6847_expand8(dst, _mc6847_bits8[data[x]], fg, bg);
                 }
             }
         }
@@ -527,15 +647,12 @@ static uint64_t _mc6847_decode_scanline(mc6847_t* vdg, uint64_t pins, size_t y)
             size_t bytes_per_row = (sub_mode == 0) ? 16 : 32;
             size_t row_height = (pins & MC6847_GM2) ? ((pins & MC6847_GM1) ? 1 : 2) : 3;
             uint16_t addr = (y / row_height) * bytes_per_row;
+            pins = _mc6847_fetch_row(vdg, pins, addr, bytes_per_row, data, ctrl);
             for (size_t x = 0; x < bytes_per_row; x++) {
-                MC6847_SET_ADDR(pins, addr++);
-                pins = vdg->fetch_cb(pins, ud);
-                uint8_t m = MC6847_GET_DATA(pins);
+                const uint8_t m = data[x];
                 for (int p = 6; p >= 0; p -= 2) {
-                    const uint8_t c = ((m>>p) & 3) + color_offset;
-                    for (size_t d = 0; d < dots_per_2bit; d++) {
-                        *dst++ = c;
-                    }
+                    memset(dst, ((m>>p) & 3) + color_offset, dots_per_2bit);
+                    dst += dots_per_2bit;
                 }
             }
         }
@@ -545,21 +662,22 @@ static uint64_t _mc6847_decode_scanline(mc6847_t* vdg, uint64_t pins, size_t y)
 
         // the vidmem src address and offset into the font data
         uint16_t addr = (y / 12) * 32;
-        uint8_t m; // the pixel bitmask
         size_t chr_y = y % 12;
         // bit shifters to extract a 2x2 or 2x3 semigraphics 2-bit stack
         size_t shift_2x2 = (1 - (chr_y / 6))*2;
         size_t shift_2x3 = (2 - (chr_y / 4))*2;
-        uint8_t alnum_fg = (pins & MC6847_CSS) ? MC6847_HWCOLOR_ALNUM_ORANGE : MC6847_HWCOLOR_ALNUM_GREEN;
-        uint8_t alnum_bg = (pins & MC6847_CSS) ? MC6847_HWCOLOR_ALNUM_DARK_ORANGE : MC6847_HWCOLOR_ALNUM_DARK_GREEN;
-        for (size_t x = 0; x < 32; x++) {
-            MC6847_SET_ADDR(pins, addr++);
-            pins = vdg->fetch_cb(pins, ud);
-            uint8_t chr = MC6847_GET_DATA(pins);
-            if (pins & MC6847_AS) {
+        const uint64_t alnum_fg = _mc6847_color8((pins & MC6847_CSS) ? MC6847_HWCOLOR_ALNUM_ORANGE : MC6847_HWCOLOR_ALNUM_GREEN);
+        const uint64_t alnum_bg = _mc6847_color8((pins & MC6847_CSS) ? MC6847_HWCOLOR_ALNUM_DARK_ORANGE : MC6847_HWCOLOR_ALNUM_DARK_GREEN);
+        const uint64_t black = _mc6847_color8(MC6847_HWCOLOR_BLACK);
+        const uint8_t css_offset = (pins & MC6847_CSS) ? 4 : 0;
+        pins = _mc6847_fetch_row(vdg, pins, addr, 32, data, ctrl);
+        for (size_t x = 0; x < 32; x++, dst += 8) {
+            const uint8_t chr = data[x];
+            if (ctrl[x] & _MC6847_ROW_AS) {
                 // semigraphics mode
+                uint8_t m; // the pixel bitmask
                 uint8_t fg_color;
-                if (pins & MC6847_INTEXT) {
+                if (ctrl[x] & _MC6847_ROW_INTEXT) {
                     /*  2x3 semigraphics, 2 color sets at 4 colors (selected by CSS pin)
                         |C1|C0|L5|L4|L3|L2|L1|L0|
 
@@ -575,7 +693,7 @@ static uint64_t _mc6847_decode_scanline(mc6847_t* vdg, uint64_t pins, size_t y)
                     // extract the 2 horizontal bits from one of the 3 stacks
                     m = (chr>>shift_2x3) & 3;
                     // 2 bits of color, CSS bit selects upper or lower half of color palette
-                    fg_color = ((chr>>6)&3) + ((pins & MC6847_CSS) ? 4:0);
+                    fg_color = ((chr>>6)&3) + css_offset;
                 }
                 else {
                     /*  2x2 semigraphics, 8 colors + black
@@ -594,30 +712,23 @@ static uint64_t _mc6847_decode_scanline(mc6847_t* vdg, uint64_t pins, size_t y)
                     fg_color = (chr>>4) & 7;
                 }
                 // write the horizontal pixel blocks (2 blocks @ 4 pixel each)
-                for (int p = 1; p>=0; p--) {
-                    uint8_t c = (m & (1<<p)) ? fg_color : MC6847_HWCOLOR_BLACK;
-                    *dst++=c; *dst++=c; *dst++=c; *dst++=c;
-                }
+                _mc6847_expand8(dst, _mc6847_bits4x2[((m & 2) ? 0xC : 0) | ((m & 1) ? 0x3 : 0)], _mc6847_color8(fg_color), black);
             }
             else {
                 /*  alphanumeric mode
                     FIXME: INT_EXT (switch between internal and external font
                 */
                 uint8_t m = _mc6847_font[(chr&0x3F)*12 + chr_y];
-                if (pins & MC6847_INV) {
+                if (ctrl[x] & _MC6847_ROW_INV) {
                     m = ~m;
                 }
-                for (int p = 7; p >= 0; p--) {
-                    *dst++ = m & (1<<p) ? alnum_fg : alnum_bg;
-                }
+                _mc6847_expand8(dst, _mc6847_bits8[m], alnum_fg, alnum_bg);
             }
         }
     }
 
     // right border
-    for (size_t i = 0; i < MC6847_BORDER_PIXELS; i++) {
-        *dst++ = bc;
-    }
+    memset(dst, bc, MC6847_BORDER_PIXELS);
 
     return pins;
 }
@@ -650,8 +761,8 @@ uint64_t mc6847_tick(mc6847_t* vdg, uint64_t pins) {
             vdg->l_count = 0;
             vdg->fs = false;
         }
-        if (vdg->l_count < MC6847_VBLANK_LINES) {
-            // inside vblank area, nothing to do
+        if ((vdg->l_count < MC6847_VBLANK_LINES) || (0 == vdg->fb)) {
+            // inside vblank area or headless, nothing to do
         }
         else if (vdg->l_count < MC6847_DISPLAY_START) {
             // top border
@@ -676,6 +787,7 @@ uint64_t mc6847_tick(mc6847_t* vdg, uint64_t pins) {
 void mc6847_snapshot_onsave(mc6847_t* snapshot) {
     CHIPS_ASSERT(snapshot);
     snapshot->fetch_cb = 0;
+    snapshot->fetch_row_cb = 0;
     snapshot->user_data = 0;
     snapshot->fb = 0;
 }
@@ -683,6 +795,7 @@ void mc6847_snapshot_onsave(mc6847_t* snapshot) {
 void mc6847_snapshot_onload(mc6847_t* snapshot, mc6847_t* sys) {
     CHIPS_ASSERT(snapshot && sys);
     snapshot->fetch_cb = sys->fetch_cb;
+    snapshot->fetch_row_cb = sys->fetch_row_cb;
     snapshot->user_data = sys->user_data;
     snapshot->fb = sys->fb;
 }
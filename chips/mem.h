@@ -18,13 +18,41 @@
     CHIPS_ASSERT(c)
     ~~~
 
+    Optionally define the following macro before including mem.h (this
+    must be consistent in all source files since it changes the mem_t
+    struct layout):
+
+    ~~~C
+    MEM_TRACK_ACCESS
+    ~~~
+        enable per-page access tracking (see below)
+
+    ~~~C
+    MEM_PAGE_SHIFT
+    ~~~
+        the page size as power of 2, between 10 (1 KByte, default) and
+        14 (16 KByte), larger pages make mapping changes cheaper, but all
+        mappings must be aligned to the page size (this is checked with
+        assertions)
+
+    ~~~C
+    MEM_COMPACT_PAGES
+    ~~~
+        store page items as 32-bit offsets instead of host pointers
+        (see 'Compact Page Tables' below)
+
     ## Feature Overview
 
     - maps 16-bit addresses to host system addresses with 1 KByte page-size
-      granularity
+      granularity (configurable up to 16 KByte)
     - memory pages can be mapped as RAM, ROM or RAM-behind-ROM (where
       read accesses are mapped to a different memory page then write accesses)
     - 4 independent page-table layers to simplify bank-switching implementations
+    - precomputed bank configurations which can be switched in with a
+      single call
+    - conditional write watchpoints on CPU-visible addresses
+    - optional per-page accessed/dirty tracking
+    - optional compact, position-independent page tables
 
     ## Usage
 
@@ -82,6 +110,163 @@
     - **unmapped page**: the read-pointer points to the internal junk-read-page, and
       the write-pointer to the internal junk-write-page
 
+    ## Bank Configurations
+
+    Systems which switch between a fixed set of memory configurations
+    (for instance the CPC gate array RAM/ROM configurations) can precompute
+    each configuration into a mem_bank_t once, and then switch a whole
+    layer over to a configuration with a single call, instead of calling
+    the mem_map_*() functions for each memory range on each bank switch:
+
+    ~~~C
+    void mem_bank_init(mem_bank_t* bank)
+    ~~~
+        Initializes a bank configuration with all pages unmapped.
+
+    ~~~C
+    void mem_bank_map_ram(mem_bank_t* bank, uint16_t addr, uint32_t size, uint8_t* ptr)
+    void mem_bank_map_rom(mem_bank_t* bank, uint16_t addr, uint32_t size, const uint8_t* ptr)
+    void mem_bank_map_rw(mem_bank_t* bank, uint16_t addr, uint32_t size, const uint8_t* read_ptr, uint8_t* write_ptr)
+    ~~~
+        Same as the mem_map_*() functions, but only record the mapping
+        in the bank configuration.
+
+    ~~~C
+    void mem_map_bank(mem_t* mem, size_t layer, const mem_bank_t* bank)
+    ~~~
+        Replaces the mapping of a layer with the bank configuration. If the
+        bank configuration maps all pages into layer 0, the CPU-visible
+        page table is replaced with a single copy, otherwise only pages
+        with a changed mapping are updated.
+
+    A mem_bank_t can also be filled on the fly (for mapping logic which
+    doesn't fit into a precomputed table) to get the 'only update changed
+    pages' behaviour.
+
+    Note that mem_bank_t contains host pointers, so mem_bank_t items should
+    not be part of system snapshots (instead recompute them after
+    loading a snapshot if needed).
+
+    ## Watchpoints
+
+    A watchpoint triggers when a byte or 16-bit word at a CPU-visible address
+    is written through mem_wr() (or mem_wr16() and mem_write_range()) and the
+    new value matches a condition:
+
+    ~~~C
+    int mem_watch_add(mem_t* mem, uint16_t addr, int num_bytes, int cond, uint16_t val)
+    ~~~
+        Adds a watchpoint and returns its index, or -1 if all
+        MEM_MAX_WATCHPOINTS slots are used. num_bytes is 1 or 2, cond is
+        one of:
+
+        - MEM_WATCH_COND_EQUAL: new value == val
+        - MEM_WATCH_COND_NONEQUAL: new value != val
+        - MEM_WATCH_COND_GREATER: new value > val
+        - MEM_WATCH_COND_LESS: new value < val
+        - MEM_WATCH_COND_GREATER_EQUAL: new value >= val
+        - MEM_WATCH_COND_LESS_EQUAL: new value <= val
+        - MEM_WATCH_COND_ANY: any write (val is ignored)
+
+        For 16-bit watchpoints, writing either of the two bytes evaluates
+        the condition on the resulting 16-bit value.
+
+    ~~~C
+    void mem_watch_clear(mem_t* mem)
+    ~~~
+        Removes all watchpoints and resets the hit state.
+
+    Triggered watchpoints don't stop the emulation, instead the hit
+    count and the most recent hit are recorded in mem_t.watch
+    (num_hits, hit_index, hit_addr and hit_val) where the host can
+    inspect them after xxx_exec() returns, call mem_watch_reset_hits()
+    to reset the hit state.
+
+    Only pages containing a watched address take the slow path in mem_wr(),
+    writes to all other pages only pay for a single bit test. Watchpoints
+    observe writes (including writes to ROM areas, which don't change
+    memory), memory changes through bank switching or through host pointers
+    are not detected.
+
+    The watchpoint state is part of mem_t and is included in system
+    snapshots.
+
+    ## Compact Page Tables
+
+    By default each page item consists of two host pointers (16 bytes on
+    64-bit platforms), when compiled with MEM_COMPACT_PAGES, a page item
+    instead consists of two signed 32-bit byte offsets relative to the
+    start of the mem_t instance which owns the page table. This halves
+    the size of the CPU-visible page table and the layers and makes the
+    page tables position-independent:
+
+    - mem_snapshot_onsave() and mem_snapshot_onload() don't need to patch
+      any pointers
+    - a system instance can be moved or copied to a different memory
+      location with a plain memcpy() as long as all memory mapped into its
+      mem_t instances is part of the moved memory block
+
+    Without MEM_COMPACT_PAGES, call mem_relocate() after copying a
+    system instance to fix up the page pointers into the copied block.
+
+    The price is one additional add in mem_rd() and mem_wr(), and
+    mem_t contains its own unmapped-read and junk-write pages (2 pages
+    of additional memory per mem_t instance) so that they can be reached
+    through offsets.
+
+    All mapped memory must be within +/-2 GBytes of the mem_t instance
+    (this is checked with assertions), in practice the mapped memory
+    should be part of the same system struct as the mem_t, which means
+    this mode doesn't work well together with ROM images that are
+    borrowed from outside the system (e.g. C64_BORROWED_ROMS).
+
+    mem_bank_t isn't owned by a mem_t instance and keeps using host
+    pointers, they are converted to offsets in mem_map_bank().
+
+    ## Access Tracking
+
+    When compiled with MEM_TRACK_ACCESS, mem_t.track contains 3 bit masks
+    with one bit per CPU-visible 1 KByte page:
+
+    - **read_pages**: the page has been read through mem_rd() (or mem_rd16())
+    - **written_pages**: the page has been written through mem_wr() (or
+      mem_wr16(), mem_write_range() and mem_layer_wr())
+    - **mapped_pages**: the host memory mapped to the page has changed
+      (for instance through bank switching)
+
+    The bits accumulate until cleared with:
+
+    ~~~C
+    void mem_track_clear(mem_t* mem)
+    ~~~
+
+    The typical usage is to inspect the bits after xxx_exec() (or when
+    needed) to find out which pages need to be processed (for instance by
+    a memory viewer, a disassembler cache or a delta snapshot), and then
+    clear the bits. Written bits are also set for writes into ROM pages
+    (which don't change memory), and memory changes through host pointers
+    are not detected.
+
+    Loading a snapshot sets all written and mapped bits.
+
+    To find out which pages of a host memory range (usually the RAM of a
+    system) have been written, call:
+
+    ~~~C
+    void mem_track_collect_writes(mem_t* mem, const uint8_t* ptr, size_t size, uint64_t* pages)
+    ~~~
+
+    This sets one bit per MEM_PAGE_SIZE bytes of the host memory range in
+    the bit array 'pages' for each written page whose write pointer points
+    into the range, and clears all written bits. Since the written bits
+    don't remember where the write went to, this must be called before the
+    memory mapping of written pages changes. This is used by the delta
+    snapshot functions of the system emulators, which take over the written
+    bits of their mem_t instances.
+
+    Without MEM_TRACK_ACCESS, no tracking code is compiled into mem_rd()
+    and mem_wr().
+
     ## zlib/libpng license
 
     Copyright (c) 2018 Andre Weissflog
@@ -112,26 +297,109 @@ extern "C" {
 #define MEM_ADDR_RANGE (1U<<16)
 #define MEM_ADDR_MASK (MEM_ADDR_RANGE-1)
 
-/* page size (1 KByte) */
+/* page size (1 KByte by default) */
+#ifndef MEM_PAGE_SHIFT
 #define MEM_PAGE_SHIFT (10U)
+#endif
+#if (MEM_PAGE_SHIFT < 10) || (MEM_PAGE_SHIFT > 14)
+#error "MEM_PAGE_SHIFT must be between 10 and 14"
+#endif
 #define MEM_PAGE_SIZE (1U<<MEM_PAGE_SHIFT)
 #define MEM_PAGE_MASK (MEM_PAGE_SIZE-1)
 
 #define MEM_NUM_PAGES (MEM_ADDR_RANGE / MEM_PAGE_SIZE)
 #define MEM_NUM_LAYERS (4U)
 
+/* max number of write watchpoints */
+#define MEM_MAX_WATCHPOINTS (16)
+
+/* watchpoint conditions */
+#define MEM_WATCH_COND_EQUAL (0)
+#define MEM_WATCH_COND_NONEQUAL (1)
+#define MEM_WATCH_COND_GREATER (2)
+#define MEM_WATCH_COND_LESS (3)
+#define MEM_WATCH_COND_GREATER_EQUAL (4)
+#define MEM_WATCH_COND_LESS_EQUAL (5)
+#define MEM_WATCH_COND_ANY (6)
+
+#if defined(MEM_COMPACT_PAGES)
+/* a memory page item maps a chunk of emulator memory to host memory, as
+   byte offsets relative to the owning mem_t instance (0: not mapped)
+*/
+typedef struct {
+    int32_t read_offset;
+    int32_t write_offset;
+} mem_page_t;
+
+/* a page item in a bank configuration, bank configurations are not owned by a mem_t and keep host pointers */
+typedef struct {
+    uint8_t* read_ptr;
+    uint8_t* write_ptr;
+} mem_bank_page_t;
+#else
 /* a memory page item maps a chunk of emulator memory to host memory */
 typedef struct {
     uint8_t* read_ptr;
     uint8_t* write_ptr;
 } mem_page_t;
 
-/* a memory instance is a 2-dimensional table of memory pages */
+typedef mem_page_t mem_bank_page_t;
+#endif
+
+/* a precomputed mapping of all pages in a layer */
+typedef struct {
+    mem_bank_page_t pages[MEM_NUM_PAGES];
+    uint64_t mapped;        /* bit mask of mapped pages */
+} mem_bank_t;
+
+/* a write watchpoint */
+typedef struct {
+    uint16_t addr;
+    uint8_t num_bytes;      /* 1 or 2 */
+    uint8_t cond;           /* MEM_WATCH_COND_* */
+    uint16_t val;
+} mem_watchpoint_t;
+
+/* watchpoint state */
+typedef struct {
+    uint64_t pages;         /* bit mask of pages which contain watched addresses */
+    int num_points;
+    mem_watchpoint_t points[MEM_MAX_WATCHPOINTS];
+    uint32_t num_hits;      /* number of triggered watchpoints since last reset */
+    int hit_index;          /* index of most recently triggered watchpoint */
+    uint16_t hit_addr;      /* address written by most recent hit */
+    uint16_t hit_val;       /* watched value after the most recent hit */
+} mem_watch_t;
+
+#if defined(MEM_TRACK_ACCESS)
+/* per-page access tracking (one bit per CPU-visible page) */
+typedef struct {
+    uint64_t read_pages;    /* pages read since last mem_track_clear() */
+    uint64_t written_pages; /* pages written since last mem_track_clear() */
+    uint64_t mapped_pages;  /* pages with changed mapping since last mem_track_clear() */
+} mem_track_t;
+#endif
+
+/* a memory instance is a 2-dimensional table of memory pages, the state
+   used by mem_rd() and mem_wr() comes first, the layers which are only
+   needed when the memory mapping changes are last
+*/
 typedef struct {
     /* the pages that are actually visible to the emulated CPU */
     mem_page_t page_table[MEM_NUM_PAGES];
+    /* write watchpoints */
+    mem_watch_t watch;
+    #if defined(MEM_TRACK_ACCESS)
+    /* access tracking */
+    mem_track_t track;
+    #endif
     /* memory-mapped layers, layer 0 is highest priority */
     mem_page_t layers[MEM_NUM_LAYERS][MEM_NUM_PAGES];
+    #if defined(MEM_COMPACT_PAGES)
+    /* the special pages for unmapped reads and junk writes must be reachable through offsets */
+    uint8_t unmapped_page[MEM_PAGE_SIZE];
+    uint8_t junk_page[MEM_PAGE_SIZE];
+    #endif
 } mem_t;
 
 /* initialize a new mem instance */
@@ -148,16 +416,60 @@ void mem_unmap_layer(mem_t* mem, size_t layer);
 void mem_unmap_all(mem_t* mem);
 /* get the host-memory read-ptr of an emulator memory address */
 uint8_t* mem_readptr(mem_t* mem, uint16_t addr);
+/* initialize a bank configuration with all pages unmapped */
+void mem_bank_init(mem_bank_t* bank);
+/* map a range of RAM in a bank configuration */
+void mem_bank_map_ram(mem_bank_t* bank, uint16_t addr, uint32_t size, uint8_t* ptr);
+/* map a range of ROM in a bank configuration */
+void mem_bank_map_rom(mem_bank_t* bank, uint16_t addr, uint32_t size, const uint8_t* ptr);
+/* map a range of memory to different read/write pointers in a bank configuration */
+void mem_bank_map_rw(mem_bank_t* bank, uint16_t addr, uint32_t size, const uint8_t* read_ptr, uint8_t* write_ptr);
+/* replace the mapping of a layer with a bank configuration, also updates the CPU-visible page-table */
+void mem_map_bank(mem_t* mem, size_t layer, const mem_bank_t* bank);
 /* copy a range of bytes into memory via mem_wr() */
 void mem_write_range(mem_t* mem, uint16_t addr, const uint8_t* src, uint32_t num_bytes);
+/* add a write watchpoint, returns watchpoint index or -1 if no free slots */
+int mem_watch_add(mem_t* mem, uint16_t addr, int num_bytes, int cond, uint16_t val);
+/* remove all watchpoints */
+void mem_watch_clear(mem_t* mem);
+/* reset the watchpoint hit state */
+void mem_watch_reset_hits(mem_t* mem);
+/* slow-path write into a watched page (called by mem_wr()) */
+void mem_watch_wr(mem_t* mem, uint16_t addr, uint8_t data);
+#if defined(MEM_TRACK_ACCESS)
+/* clear the page access tracking bits */
+void mem_track_clear(mem_t* mem);
+/* mark the written pages which are mapped into a host memory range in a bit array, and clear the written bits */
+void mem_track_collect_writes(mem_t* mem, const uint8_t* ptr, size_t size, uint64_t* pages);
+#endif
 
 /* read a byte at 16-bit address */
 static inline uint8_t mem_rd(mem_t* mem, uint16_t addr) {
+    #if defined(MEM_TRACK_ACCESS)
+    mem->track.read_pages |= 1ULL << (addr>>MEM_PAGE_SHIFT);
+    #endif
+    #if defined(MEM_COMPACT_PAGES)
+    // the offset may be negative, adding the unsigned page mask directly would make it unsigned
+    return ((const uint8_t*)mem)[mem->page_table[addr>>MEM_PAGE_SHIFT].read_offset + (int32_t)(addr & MEM_PAGE_MASK)];
+    #else
     return mem->page_table[addr>>MEM_PAGE_SHIFT].read_ptr[addr & MEM_PAGE_MASK];
+    #endif
 }
 /* write a byte to 16-bit address */
 static inline void mem_wr(mem_t* mem, uint16_t addr, uint8_t data) {
-    mem->page_table[addr>>MEM_PAGE_SHIFT].write_ptr[addr & MEM_PAGE_MASK] = data;
+    #if defined(MEM_TRACK_ACCESS)
+    mem->track.written_pages |= 1ULL << (addr>>MEM_PAGE_SHIFT);
+    #endif
+    if (mem->watch.pages & (1ULL << (addr>>MEM_PAGE_SHIFT))) {
+        mem_watch_wr(mem, addr, data);
+    }
+    else {
+        #if defined(MEM_COMPACT_PAGES)
+        ((uint8_t*)mem)[mem->page_table[addr>>MEM_PAGE_SHIFT].write_offset + (int32_t)(addr & MEM_PAGE_MASK)] = data;
+        #else
+        mem->page_table[addr>>MEM_PAGE_SHIFT].write_ptr[addr & MEM_PAGE_MASK] = data;
+        #endif
+    }
 }
 /* helper method to write a 16-bit value, does 2 mem_wr() */
 static inline void mem_wr16(mem_t* mem, uint16_t addr, uint16_t data) {
@@ -176,7 +488,9 @@ uint8_t mem_layer_rd(mem_t* mem, size_t layer, uint16_t addr);
 /* write a byte to a specific layer (slow!) */
 void mem_layer_wr(mem_t* mem, size_t layer, uint16_t addr, uint8_t data);
 
-/* convert any internal pointers to offsets (helper function for serialization) */
+/* fix up a mem_t which has been copied as part of a memory block from src_base to dst_base */
+void mem_relocate(mem_t* mem, const void* src_base, size_t size, void* dst_base);
+/* convert any internal pointers to offsets (helper function for serialization, no-op with MEM_COMPACT_PAGES) */
 void mem_snapshot_onsave(mem_t* snapshot, void* base);
 /* ...and the reverse */
 void mem_snapshot_onload(mem_t* snapshot, void* base);
@@ -193,24 +507,127 @@ void mem_snapshot_onload(mem_t* snapshot, void* base);
     #define CHIPS_ASSERT(c) assert(c)
 #endif
 
-// a dummy page for currently unmapped memory
-static uint8_t _mem_unmapped_page[MEM_PAGE_SIZE];
+#if defined(MEM_COMPACT_PAGES)
+// the special pages are part of mem_t
+#define _MEM_UNMAPPED_PAGE(m) ((m)->unmapped_page)
+#define _MEM_JUNK_PAGE(m) ((m)->junk_page)
+// ROM pages in bank configurations get their junk page in mem_map_bank()
+#define _MEM_BANK_JUNK_PAGE (0)
+
+static inline int32_t _mem_offset(const mem_t* m, const uint8_t* ptr) {
+    const ptrdiff_t offset = ptr - (const uint8_t*)m;
+    // offset 0 is reserved for 'not mapped', and points into mem_t.page_table anyway
+    CHIPS_ASSERT((offset != 0) && (offset >= INT32_MIN) && (offset <= INT32_MAX));
+    return (int32_t)offset;
+}
+
+static inline bool _mem_page_mapped(const mem_page_t* page) {
+    return page->read_offset != 0;
+}
+
+static inline uint8_t* _mem_page_read_ptr(mem_t* m, const mem_page_t* page) {
+    return page->read_offset ? ((uint8_t*)m + page->read_offset) : 0;
+}
+
+static inline uint8_t* _mem_page_write_ptr(mem_t* m, const mem_page_t* page) {
+    return page->write_offset ? ((uint8_t*)m + page->write_offset) : 0;
+}
+
+static inline bool _mem_page_equal(const mem_page_t* p0, const mem_page_t* p1) {
+    return (p0->read_offset == p1->read_offset) && (p0->write_offset == p1->write_offset);
+}
+
+static inline void _mem_page_copy(mem_page_t* dst, const mem_page_t* src) {
+    dst->read_offset = src->read_offset;
+    dst->write_offset = src->write_offset;
+}
+
+static inline void _mem_page_set(mem_t* m, mem_page_t* page, const uint8_t* read_ptr, uint8_t* write_ptr) {
+    if (read_ptr && !write_ptr) {
+        write_ptr = _MEM_JUNK_PAGE(m);
+    }
+    page->read_offset = read_ptr ? _mem_offset(m, read_ptr) : 0;
+    page->write_offset = write_ptr ? _mem_offset(m, write_ptr) : 0;
+}
+#else
+/* a dummy page for currently unmapped memory, this is initialized at compile
+   time and never written, so that mem_init() doesn't touch any global state
+   (and can be called for multiple instances in parallel)
+*/
+#define _MEM_FF4 0xFF,0xFF,0xFF,0xFF
+#define _MEM_FF16 _MEM_FF4,_MEM_FF4,_MEM_FF4,_MEM_FF4
+#define _MEM_FF64 _MEM_FF16,_MEM_FF16,_MEM_FF16,_MEM_FF16
+#define _MEM_FF256 _MEM_FF64,_MEM_FF64,_MEM_FF64,_MEM_FF64
+#define _MEM_FF1K _MEM_FF256,_MEM_FF256,_MEM_FF256,_MEM_FF256
+#define _MEM_FF4K _MEM_FF1K,_MEM_FF1K,_MEM_FF1K,_MEM_FF1K
+#if MEM_PAGE_SHIFT == 10
+#define _MEM_FF_PAGE _MEM_FF1K
+#elif MEM_PAGE_SHIFT == 11
+#define _MEM_FF_PAGE _MEM_FF1K,_MEM_FF1K
+#elif MEM_PAGE_SHIFT == 12
+#define _MEM_FF_PAGE _MEM_FF4K
+#elif MEM_PAGE_SHIFT == 13
+#define _MEM_FF_PAGE _MEM_FF4K,_MEM_FF4K
+#else
+#define _MEM_FF_PAGE _MEM_FF4K,_MEM_FF4K,_MEM_FF4K,_MEM_FF4K
+#endif
+static const uint8_t _mem_unmapped_page[MEM_PAGE_SIZE] = { _MEM_FF_PAGE };
 // a write-only 'junk table' for writes to ROM areas
 static uint8_t _mem_junk_page[MEM_PAGE_SIZE];
 
+#define _MEM_UNMAPPED_PAGE(m) ((uint8_t*)_mem_unmapped_page)
+#define _MEM_JUNK_PAGE(m) (_mem_junk_page)
+#define _MEM_BANK_JUNK_PAGE (_mem_junk_page)
+
+static inline bool _mem_page_mapped(const mem_page_t* page) {
+    return page->read_ptr != 0;
+}
+
+static inline uint8_t* _mem_page_read_ptr(mem_t* m, const mem_page_t* page) {
+    (void)m;
+    return page->read_ptr;
+}
+
+static inline uint8_t* _mem_page_write_ptr(mem_t* m, const mem_page_t* page) {
+    (void)m;
+    return page->write_ptr;
+}
+
+static inline bool _mem_page_equal(const mem_page_t* p0, const mem_page_t* p1) {
+    return (p0->read_ptr == p1->read_ptr) && (p0->write_ptr == p1->write_ptr);
+}
+
+static inline void _mem_page_copy(mem_page_t* dst, const mem_page_t* src) {
+    dst->read_ptr = src->read_ptr;
+    dst->write_ptr = src->write_ptr;
+}
+
+static inline void _mem_page_set(mem_t* m, mem_page_t* page, const uint8_t* read_ptr, uint8_t* write_ptr) {
+    (void)m;
+    page->read_ptr = (uint8_t*)read_ptr;
+    page->write_ptr = write_ptr;
+}
+#endif
+
 void mem_init(mem_t* m) {
     CHIPS_ASSERT(m);
     *m = (mem_t){0};
-    memset(_mem_unmapped_page, 0xFF, sizeof(_mem_unmapped_page));
+    m->watch.hit_index = -1;
+    #if defined(MEM_COMPACT_PAGES)
+    memset(_MEM_UNMAPPED_PAGE(m), 0xFF, MEM_PAGE_SIZE);
+    #endif
     mem_unmap_all(m);
 }
 
 /* this sets the CPU-visible mapping of a page in the page-table */
 static void _mem_update_page_table(mem_t* m, size_t page_index) {
+    #if defined(MEM_TRACK_ACCESS)
+    const mem_page_t old_page = m->page_table[page_index];
+    #endif
     /* find highest priority layer which maps this memory page */
     size_t layer_index;
     for (layer_index = 0; layer_index < MEM_NUM_LAYERS; layer_index++) {
-        if (m->layers[layer_index][page_index].read_ptr) {
+        if (_mem_page_mapped(&m->layers[layer_index][page_index])) {
             /* found highest priority layer with valid mapping */
             break;
         }
@@ -245,38 +662,55 @@ static void _mem_update_page_table(mem_t* m, size_t page_index) {
         */
         // m->page_table[page_index] = m->layers[layer_index][page_index];
 
-        m->page_table[page_index].read_ptr = m->layers[layer_index][page_index].read_ptr;
-        m->page_table[page_index].write_ptr = m->layers[layer_index][page_index].write_ptr;
+        _mem_page_copy(&m->page_table[page_index], &m->layers[layer_index][page_index]);
     }
     else {
         /* no mapping exists for this page, set to special 'unmapped page' */
-        m->page_table[page_index].read_ptr = _mem_unmapped_page;
-        m->page_table[page_index].write_ptr = _mem_junk_page;
+        _mem_page_set(m, &m->page_table[page_index], _MEM_UNMAPPED_PAGE(m), _MEM_JUNK_PAGE(m));
+    }
+    #if defined(MEM_TRACK_ACCESS)
+    if (!_mem_page_equal(&m->page_table[page_index], &old_page)) {
+        m->track.mapped_pages |= 1ULL << page_index;
     }
+    #endif
 }
 
-static void _mem_map(mem_t* m, size_t layer, uint16_t addr, uint32_t size, const uint8_t* read_ptr, uint8_t* write_ptr) {
-    CHIPS_ASSERT(m);
-    CHIPS_ASSERT(layer < MEM_NUM_LAYERS);
+/* write the mapping of an address range into an array of page items, returns bit mask of mapped pages */
+static uint64_t _mem_map_pages(mem_bank_page_t* pages, uint16_t addr, uint32_t size, const uint8_t* read_ptr, uint8_t* write_ptr) {
     CHIPS_ASSERT((addr & MEM_PAGE_MASK) == 0);
     CHIPS_ASSERT((size & MEM_PAGE_MASK) == 0);
     CHIPS_ASSERT(size <= MEM_ADDR_RANGE);
     const size_t num = size>>MEM_PAGE_SHIFT;
     CHIPS_ASSERT(num <= MEM_NUM_PAGES);
+    uint64_t mask = 0;
     for (size_t i = 0; i < num; i++) {
-        const uint16_t offset = i * MEM_PAGE_SIZE;
+        const uint32_t offset = i * MEM_PAGE_SIZE;
         // the page_index will wrap-around
         const uint16_t page_index = ((addr+offset) & MEM_ADDR_MASK) >> MEM_PAGE_SHIFT;
         CHIPS_ASSERT(page_index <= MEM_NUM_PAGES);
-        mem_page_t* page = &m->layers[layer][page_index];
+        mem_bank_page_t* page = &pages[page_index];
         page->read_ptr = (uint8_t*)read_ptr + offset;
         if (0 != write_ptr) {
             page->write_ptr = write_ptr + offset;
         }
         else {
-            page->write_ptr = _mem_junk_page;
+            page->write_ptr = _MEM_BANK_JUNK_PAGE;
+        }
+        mask |= 1ULL << page_index;
+    }
+    return mask;
+}
+
+static void _mem_map(mem_t* m, size_t layer, uint16_t addr, uint32_t size, const uint8_t* read_ptr, uint8_t* write_ptr) {
+    CHIPS_ASSERT(m);
+    CHIPS_ASSERT(layer < MEM_NUM_LAYERS);
+    mem_bank_page_t pages[MEM_NUM_PAGES];
+    uint64_t mask = _mem_map_pages(pages, addr, size, read_ptr, write_ptr);
+    for (size_t page_index = 0; mask != 0; page_index++, mask >>= 1) {
+        if (mask & 1) {
+            _mem_page_set(m, &m->layers[layer][page_index], pages[page_index].read_ptr, pages[page_index].write_ptr);
+            _mem_update_page_table(m, page_index);
         }
-        _mem_update_page_table(m, page_index);
     }
 }
 
@@ -299,9 +733,7 @@ void mem_unmap_layer(mem_t* m, size_t layer) {
     CHIPS_ASSERT(m);
     CHIPS_ASSERT(layer < MEM_NUM_LAYERS);
     for (size_t page_index = 0; page_index < MEM_NUM_PAGES; page_index++) {
-        mem_page_t* page = &m->layers[layer][page_index];
-        page->read_ptr = 0;
-        page->write_ptr = 0;
+        _mem_page_set(m, &m->layers[layer][page_index], 0, 0);
         _mem_update_page_table(m, page_index);
     }
 }
@@ -309,9 +741,7 @@ void mem_unmap_layer(mem_t* m, size_t layer) {
 void mem_unmap_all(mem_t* m) {
     for (size_t layer_index = 0; layer_index < MEM_NUM_LAYERS; layer_index++) {
         for (size_t page_index = 0; page_index < MEM_NUM_PAGES; page_index++) {
-            mem_page_t* page = &m->layers[layer_index][page_index];
-            page->read_ptr = 0;
-            page->write_ptr = 0;
+            _mem_page_set(m, &m->layers[layer_index][page_index], 0, 0);
         }
     }
     for (size_t page_index = 0; page_index < MEM_NUM_PAGES; page_index++) {
@@ -319,9 +749,67 @@ void mem_unmap_all(mem_t* m) {
     }
 }
 
+void mem_bank_init(mem_bank_t* bank) {
+    CHIPS_ASSERT(bank);
+    memset(bank, 0, sizeof(mem_bank_t));
+}
+
+void mem_bank_map_ram(mem_bank_t* bank, uint16_t addr, uint32_t size, uint8_t* ptr) {
+    CHIPS_ASSERT(bank && ptr);
+    bank->mapped |= _mem_map_pages(bank->pages, addr, size, ptr, ptr);
+}
+
+void mem_bank_map_rom(mem_bank_t* bank, uint16_t addr, uint32_t size, const uint8_t* ptr) {
+    CHIPS_ASSERT(bank && ptr);
+    bank->mapped |= _mem_map_pages(bank->pages, addr, size, ptr, 0);
+}
+
+void mem_bank_map_rw(mem_bank_t* bank, uint16_t addr, uint32_t size, const uint8_t* read_ptr, uint8_t* write_ptr) {
+    CHIPS_ASSERT(bank && read_ptr && write_ptr);
+    bank->mapped |= _mem_map_pages(bank->pages, addr, size, read_ptr, write_ptr);
+}
+
+void mem_map_bank(mem_t* m, size_t layer, const mem_bank_t* bank) {
+    CHIPS_ASSERT(m && bank);
+    CHIPS_ASSERT(layer < MEM_NUM_LAYERS);
+    const uint64_t all_pages = ~0ULL >> (64 - MEM_NUM_PAGES);
+    if ((0 == layer) && (bank->mapped == all_pages)) {
+        // layer 0 has the highest priority, so if all pages are mapped
+        // the bank configuration is identical with the CPU-visible page table
+        #if defined(MEM_COMPACT_PAGES)
+        for (size_t page_index = 0; page_index < MEM_NUM_PAGES; page_index++) {
+            const mem_bank_page_t* bank_page = &bank->pages[page_index];
+            _mem_page_set(m, &m->layers[0][page_index], bank_page->read_ptr, bank_page->write_ptr);
+        }
+        #else
+        memcpy(m->layers[0], bank->pages, sizeof(m->layers[0]));
+        #endif
+        #if defined(MEM_TRACK_ACCESS)
+        for (size_t page_index = 0; page_index < MEM_NUM_PAGES; page_index++) {
+            if (!_mem_page_equal(&m->page_table[page_index], &m->layers[0][page_index])) {
+                m->track.mapped_pages |= 1ULL << page_index;
+            }
+        }
+        #endif
+        memcpy(m->page_table, m->layers[0], sizeof(m->page_table));
+    }
+    else {
+        for (size_t page_index = 0; page_index < MEM_NUM_PAGES; page_index++) {
+            mem_page_t* page = &m->layers[layer][page_index];
+            const mem_bank_page_t* bank_page = &bank->pages[page_index];
+            mem_page_t new_page;
+            _mem_page_set(m, &new_page, bank_page->read_ptr, bank_page->write_ptr);
+            if (!_mem_page_equal(page, &new_page)) {
+                _mem_page_copy(page, &new_page);
+                _mem_update_page_table(m, page_index);
+            }
+        }
+    }
+}
+
 uint8_t* mem_readptr(mem_t* m, uint16_t addr) {
     CHIPS_ASSERT(m);
-    return (uint8_t*) &(m->page_table[addr>>MEM_PAGE_SHIFT].read_ptr[addr&MEM_PAGE_MASK]);
+    return _mem_page_read_ptr(m, &m->page_table[addr>>MEM_PAGE_SHIFT]) + (addr&MEM_PAGE_MASK);
 }
 
 void mem_write_range(mem_t* m, uint16_t addr, const uint8_t* src, uint32_t num_bytes) {
@@ -330,10 +818,129 @@ void mem_write_range(mem_t* m, uint16_t addr, const uint8_t* src, uint32_t num_b
     }
 }
 
+int mem_watch_add(mem_t* m, uint16_t addr, int num_bytes, int cond, uint16_t val) {
+    CHIPS_ASSERT(m);
+    CHIPS_ASSERT((num_bytes == 1) || (num_bytes == 2));
+    CHIPS_ASSERT((cond >= MEM_WATCH_COND_EQUAL) && (cond <= MEM_WATCH_COND_ANY));
+    mem_watch_t* w = &m->watch;
+    if (w->num_points >= MEM_MAX_WATCHPOINTS) {
+        return -1;
+    }
+    const int index = w->num_points++;
+    mem_watchpoint_t* wp = &w->points[index];
+    wp->addr = addr;
+    wp->num_bytes = (uint8_t) num_bytes;
+    wp->cond = (uint8_t) cond;
+    wp->val = (num_bytes == 1) ? (val & 0xFF) : val;
+    w->pages |= 1ULL << (addr>>MEM_PAGE_SHIFT);
+    if (num_bytes == 2) {
+        w->pages |= 1ULL << (((addr+1) & MEM_ADDR_MASK)>>MEM_PAGE_SHIFT);
+    }
+    return index;
+}
+
+void mem_watch_clear(mem_t* m) {
+    CHIPS_ASSERT(m);
+    memset(&m->watch, 0, sizeof(m->watch));
+    m->watch.hit_index = -1;
+}
+
+void mem_watch_reset_hits(mem_t* m) {
+    CHIPS_ASSERT(m);
+    m->watch.num_hits = 0;
+    m->watch.hit_index = -1;
+    m->watch.hit_addr = 0;
+    m->watch.hit_val = 0;
+}
+
+#if defined(MEM_TRACK_ACCESS)
+void mem_track_clear(mem_t* m) {
+    CHIPS_ASSERT(m);
+    m->track.read_pages = 0;
+    m->track.written_pages = 0;
+    m->track.mapped_pages = 0;
+}
+
+void mem_track_collect_writes(mem_t* m, const uint8_t* ptr, size_t size, uint64_t* pages) {
+    CHIPS_ASSERT(m && ptr && (size > 0) && pages);
+    uint64_t written = m->track.written_pages;
+    for (size_t page_index = 0; written; page_index++, written >>= 1) {
+        if (written & 1) {
+            const uintptr_t write_addr = (uintptr_t) _mem_page_write_ptr(m, &m->page_table[page_index]);
+            if ((write_addr >= (uintptr_t)ptr) && (write_addr < ((uintptr_t)ptr + size))) {
+                // the mapped page doesn't need to be aligned with the pages of the host range
+                const size_t offset = (size_t)(write_addr - (uintptr_t)ptr);
+                const size_t first = offset >> MEM_PAGE_SHIFT;
+                size_t last = (offset + MEM_PAGE_SIZE - 1) >> MEM_PAGE_SHIFT;
+                if (last > ((size - 1) >> MEM_PAGE_SHIFT)) {
+                    last = (size - 1) >> MEM_PAGE_SHIFT;
+                }
+                for (size_t i = first; i <= last; i++) {
+                    pages[i >> 6] |= 1ULL << (i & 63);
+                }
+            }
+        }
+    }
+    m->track.written_pages = 0;
+}
+#endif
+
+// read back a byte where mem_wr() would have stored it (or the ROM byte for read-only pages)
+static inline uint8_t _mem_watch_peek(mem_t* m, uint16_t addr) {
+    const mem_page_t* page = &m->page_table[addr>>MEM_PAGE_SHIFT];
+    const uint8_t* write_ptr = _mem_page_write_ptr(m, page);
+    const uint8_t* ptr = (write_ptr == _MEM_JUNK_PAGE(m)) ? _mem_page_read_ptr(m, page) : write_ptr;
+    return ptr[addr & MEM_PAGE_MASK];
+}
+
+void mem_watch_wr(mem_t* m, uint16_t addr, uint8_t data) {
+    _mem_page_write_ptr(m, &m->page_table[addr>>MEM_PAGE_SHIFT])[addr & MEM_PAGE_MASK] = data;
+    mem_watch_t* w = &m->watch;
+    for (int i = 0; i < w->num_points; i++) {
+        const mem_watchpoint_t* wp = &w->points[i];
+        int val;
+        if (wp->num_bytes == 1) {
+            if (addr != wp->addr) {
+                continue;
+            }
+            val = data;
+        }
+        else {
+            const uint16_t addr_hi = (wp->addr + 1) & MEM_ADDR_MASK;
+            if (addr == wp->addr) {
+                val = (_mem_watch_peek(m, addr_hi) << 8) | data;
+            }
+            else if (addr == addr_hi) {
+                val = (data << 8) | _mem_watch_peek(m, wp->addr);
+            }
+            else {
+                continue;
+            }
+        }
+        bool hit = false;
+        switch (wp->cond) {
+            case MEM_WATCH_COND_EQUAL:          hit = val == wp->val; break;
+            case MEM_WATCH_COND_NONEQUAL:       hit = val != wp->val; break;
+            case MEM_WATCH_COND_GREATER:        hit = val > wp->val; break;
+            case MEM_WATCH_COND_LESS:           hit = val < wp->val; break;
+            case MEM_WATCH_COND_GREATER_EQUAL:  hit = val >= wp->val; break;
+            case MEM_WATCH_COND_LESS_EQUAL:     hit = val <= wp->val; break;
+            default:                            hit = true; break;
+        }
+        if (hit) {
+            w->num_hits++;
+            w->hit_index = i;
+            w->hit_addr = addr;
+            w->hit_val = (uint16_t) val;
+        }
+    }
+}
+
 uint8_t mem_layer_rd(mem_t* mem, size_t layer, uint16_t addr) {
     CHIPS_ASSERT(layer < MEM_NUM_LAYERS);
-    if (mem->layers[layer][addr>>MEM_PAGE_SHIFT].read_ptr) {
-        return mem->layers[layer][addr>>MEM_PAGE_SHIFT].read_ptr[addr&MEM_PAGE_MASK];
+    const uint8_t* ptr = _mem_page_read_ptr(mem, &mem->layers[layer][addr>>MEM_PAGE_SHIFT]);
+    if (ptr) {
+        return ptr[addr&MEM_PAGE_MASK];
     }
     else {
         return 0xFF;
@@ -342,11 +949,86 @@ uint8_t mem_layer_rd(mem_t* mem, size_t layer, uint16_t addr) {
 
 void mem_layer_wr(mem_t* mem, size_t layer, uint16_t addr, uint8_t data) {
     CHIPS_ASSERT(layer < MEM_NUM_LAYERS);
-    if (mem->layers[layer][addr>>MEM_PAGE_SHIFT].write_ptr) {
-        mem->layers[layer][addr>>MEM_PAGE_SHIFT].write_ptr[addr&MEM_PAGE_MASK] = data;
+    #if defined(MEM_TRACK_ACCESS)
+    mem->track.written_pages |= 1ULL << (addr>>MEM_PAGE_SHIFT);
+    #endif
+    uint8_t* ptr = _mem_page_write_ptr(mem, &mem->layers[layer][addr>>MEM_PAGE_SHIFT]);
+    if (ptr) {
+        ptr[addr&MEM_PAGE_MASK] = data;
+    }
+}
+
+#if defined(MEM_COMPACT_PAGES)
+/* offsets into the copied block are still valid, only offsets to memory outside
+   the block must be adjusted by the distance the mem_t has moved
+*/
+static void _mem_relocate_offset(int32_t* offset, const uint8_t* src_mem, const uint8_t* src_base, size_t size, intptr_t dist) {
+    if (*offset != 0) {
+        const uint8_t* ptr = src_mem + *offset;
+        if ((ptr < src_base) || (ptr >= (src_base + size))) {
+            *offset = (int32_t)(*offset - dist);
+        }
     }
 }
 
+void mem_relocate(mem_t* mem, const void* src_base, size_t size, void* dst_base) {
+    CHIPS_ASSERT(mem && src_base && dst_base);
+    const intptr_t dist = (const uint8_t*)dst_base - (const uint8_t*)src_base;
+    const uint8_t* src_mem = (const uint8_t*)mem - dist;
+    for (size_t page = 0; page < MEM_NUM_PAGES; page++) {
+        _mem_relocate_offset(&mem->page_table[page].read_offset, src_mem, (const uint8_t*)src_base, size, dist);
+        _mem_relocate_offset(&mem->page_table[page].write_offset, src_mem, (const uint8_t*)src_base, size, dist);
+    }
+    for (size_t layer = 0; layer < MEM_NUM_LAYERS; layer++) {
+        for (size_t page = 0; page < MEM_NUM_PAGES; page++) {
+            _mem_relocate_offset(&mem->layers[layer][page].read_offset, src_mem, (const uint8_t*)src_base, size, dist);
+            _mem_relocate_offset(&mem->layers[layer][page].write_offset, src_mem, (const uint8_t*)src_base, size, dist);
+        }
+    }
+}
+#else
+/* pointers into the copied block are moved into the new block, all other
+   pointers (including the shared unmapped and junk pages) are unchanged
+*/
+static void _mem_relocate_ptr(uint8_t** ptr_ptr, const uint8_t* src_base, size_t size, uint8_t* dst_base) {
+    const uint8_t* ptr = *ptr_ptr;
+    if ((ptr >= src_base) && (ptr < (src_base + size))) {
+        *ptr_ptr = dst_base + (ptr - src_base);
+    }
+}
+
+void mem_relocate(mem_t* mem, const void* src_base, size_t size, void* dst_base) {
+    CHIPS_ASSERT(mem && src_base && dst_base);
+    for (size_t page = 0; page < MEM_NUM_PAGES; page++) {
+        _mem_relocate_ptr(&mem->page_table[page].read_ptr, (const uint8_t*)src_base, size, (uint8_t*)dst_base);
+        _mem_relocate_ptr(&mem->page_table[page].write_ptr, (const uint8_t*)src_base, size, (uint8_t*)dst_base);
+    }
+    for (size_t layer = 0; layer < MEM_NUM_LAYERS; layer++) {
+        for (size_t page = 0; page < MEM_NUM_PAGES; page++) {
+            _mem_relocate_ptr(&mem->layers[layer][page].read_ptr, (const uint8_t*)src_base, size, (uint8_t*)dst_base);
+            _mem_relocate_ptr(&mem->layers[layer][page].write_ptr, (const uint8_t*)src_base, size, (uint8_t*)dst_base);
+        }
+    }
+}
+#endif
+
+#if defined(MEM_COMPACT_PAGES)
+// page offsets are relative to mem_t, so there's nothing to patch
+void mem_snapshot_onsave(mem_t* snapshot, void* base) {
+    (void)snapshot; (void)base;
+}
+
+void mem_snapshot_onload(mem_t* snapshot, void* base) {
+    (void)base;
+    #if defined(MEM_TRACK_ACCESS)
+    /* all memory content may have changed */
+    snapshot->track.written_pages = ~0ULL;
+    snapshot->track.mapped_pages = ~0ULL;
+    #else
+    (void)snapshot;
+    #endif
+}
+#else
 #define MEM_SPECIAL_OFFSET_NULLPTR (-1)
 #define MEM_SPECIAL_OFFSET_UNMAPPED_PAGE (-2)
 #define MEM_SPECIAL_OFFSET_JUNK_PAGE (-3)
@@ -375,7 +1057,7 @@ static void mem_offset_to_ptr(uint8_t** ptr_ptr, uint8_t* base) {
             *ptr_ptr = 0;
             break;
         case MEM_SPECIAL_OFFSET_UNMAPPED_PAGE:
-            *ptr_ptr = _mem_unmapped_page;
+            *ptr_ptr = _MEM_UNMAPPED_PAGE(0);
             break;
         case MEM_SPECIAL_OFFSET_JUNK_PAGE:
             *ptr_ptr = _mem_junk_page;
@@ -412,6 +1094,12 @@ void mem_snapshot_onload(mem_t* snapshot, void* base) {
             mem_offset_to_ptr(&snapshot->layers[layer][page].write_ptr, base8);
         }
     }
+    #if defined(MEM_TRACK_ACCESS)
+    /* all memory content may have changed */
+    snapshot->track.written_pages = ~0ULL;
+    snapshot->track.mapped_pages = ~0ULL;
+    #endif
 }
+#endif
 
 #endif /* CHIPS_IMPL */
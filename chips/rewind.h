@@ -0,0 +1,343 @@
+#pragma once
+/*#
+    # rewind.h
+
+    A fixed-size snapshot ring buffer for rewinding emulator state.
+
+    Do this:
+    ~~~C
+    #define CHIPS_IMPL
+    ~~~
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Optionally provide the following macros with your own implementation
+
+    ~~~C
+    CHIPS_ASSERT(c)
+    ~~~
+        your own assert macro (default: assert(c))
+
+    You need to include the following headers before including rewind.h:
+
+    - chips/chips_common.h
+
+    ## Overview
+
+    The rewind buffer stores a sequence of same-size snapshots (for instance
+    one zx_t snapshot per frame created with zx_save_snapshot()) in a
+    memory buffer provided by the caller. The rewind buffer never allocates
+    memory, when the buffer is full the oldest snapshots are dropped.
+
+    Snapshots are stored compressed, every 'keyframe_interval' snapshots a
+    full keyframe is stored, and in between only the XOR difference to the
+    previous snapshot is stored. Both keyframes and differences are
+    run-length-compressed (runs of zero bytes are skipped), since
+    a keyframe mostly consists of zero-initialized memory, and the
+    difference between two frames is mostly zero, this typically
+    compresses very well.
+
+    Pushing a new snapshot has a fixed cost (one compression pass over the
+    snapshot), restoring a snapshot needs to decode the closest keyframe
+    and at most keyframe_interval-1 differences.
+
+    ## Functions
+
+    ~~~C
+    void rewind_init(rewind_t* rw, const rewind_desc_t* desc)
+    ~~~
+        Initialize a rewind_t instance:
+
+        ~~~C
+        typedef struct {
+            chips_range_t buffer;       // memory buffer for the rewind history
+            size_t snapshot_size;       // size of a single snapshot in bytes
+            int keyframe_interval;      // number of snapshots between keyframes (default: 32)
+        } rewind_desc_t;
+        ~~~
+
+        The buffer must be at least REWIND_MIN_BUFFER_SIZE(snapshot_size) bytes.
+        For the system emulators, use the XXX_SNAPSHOT_SIZE constant as
+        snapshot_size (e.g. ZX_SNAPSHOT_SIZE), this skips the output-only
+        parts at the end of the system struct.
+
+    ~~~C
+    void rewind_clear(rewind_t* rw)
+    ~~~
+        Drop all snapshots.
+
+    ~~~C
+    void rewind_push(rewind_t* rw, const void* snapshot)
+    ~~~
+        Push a new snapshot, this may drop the oldest snapshots if the buffer
+        is full.
+
+    ~~~C
+    int rewind_num_frames(rewind_t* rw)
+    ~~~
+        Get the number of snapshots in the buffer.
+
+    ~~~C
+    bool rewind_seek(rewind_t* rw, int frames_back, void* dst)
+    ~~~
+        Decode the snapshot 'frames_back' frames before the most recent
+        snapshot into dst (0 is the most recent snapshot), and drop all
+        newer snapshots, so that the next rewind_push() continues the
+        history at this point. Returns false if there are not enough
+        snapshots in the buffer. To rewind continuously, call rewind_seek(rw, 1, dst)
+        once per frame and load the resulting snapshot.
+
+    ## zlib/libpng license
+
+    Copyright (c) 2018 Andre Weissflog
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// max number of snapshots in the rewind buffer
+#define REWIND_MAX_FRAMES (4096)
+// default number of snapshots between keyframes
+#define REWIND_DEFAULT_KEYFRAME_INTERVAL (32)
+// worst-case size of a compressed snapshot
+#define REWIND_MAX_ENCODED_SIZE(snapshot_size) ((snapshot_size) + 4 * (((snapshot_size) / 0xFFFF) + 2))
+// minimal buffer size for a snapshot size
+#define REWIND_MIN_BUFFER_SIZE(snapshot_size) ((snapshot_size) + 2 * REWIND_MAX_ENCODED_SIZE(snapshot_size))
+
+// setup parameters for rewind_init()
+typedef struct {
+    chips_range_t buffer;       // memory buffer for the rewind history
+    size_t snapshot_size;       // size of a single snapshot in bytes
+    int keyframe_interval;      // number of snapshots between keyframes (default: 32)
+} rewind_desc_t;
+
+// a compressed snapshot in the rewind buffer
+typedef struct {
+    uint32_t offset;    // byte offset into data buffer
+    uint32_t size;      // compressed size in bytes
+    bool keyframe;      // true if this is a keyframe, false if XOR difference to previous frame
+} rewind_frame_t;
+
+// rewind buffer state
+typedef struct {
+    bool valid;
+    size_t snapshot_size;
+    int keyframe_interval;
+    int frames_since_keyframe;
+    uint8_t* prev;          // uncompressed copy of most recent snapshot
+    uint8_t* data;          // ring buffer for compressed snapshots
+    size_t data_size;
+    int first;              // index of oldest frame in frames[]
+    int num;                // number of frames in buffer
+    rewind_frame_t frames[REWIND_MAX_FRAMES];
+} rewind_t;
+
+// initialize a rewind buffer
+void rewind_init(rewind_t* rw, const rewind_desc_t* desc);
+// drop all snapshots
+void rewind_clear(rewind_t* rw);
+// push a new snapshot
+void rewind_push(rewind_t* rw, const void* snapshot);
+// get number of snapshots in the buffer
+int rewind_num_frames(rewind_t* rw);
+// decode snapshot at 'frames_back' into dst and drop all newer snapshots
+bool rewind_seek(rewind_t* rw, int frames_back, void* dst);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_IMPL
+#include <string.h> // memset, memcpy
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+#define _REWIND_MAX_RUN (0xFFFF)
+#define _REWIND_MIN_SKIP (4)
+
+void rewind_init(rewind_t* rw, const rewind_desc_t* desc) {
+    CHIPS_ASSERT(rw && desc);
+    CHIPS_ASSERT(desc->buffer.ptr && (desc->snapshot_size > 0));
+    CHIPS_ASSERT(desc->buffer.size >= REWIND_MIN_BUFFER_SIZE(desc->snapshot_size));
+    CHIPS_ASSERT(desc->buffer.size <= UINT32_MAX);
+    memset(rw, 0, sizeof(rewind_t));
+    rw->valid = true;
+    rw->snapshot_size = desc->snapshot_size;
+    rw->keyframe_interval = (desc->keyframe_interval > 0) ? desc->keyframe_interval : REWIND_DEFAULT_KEYFRAME_INTERVAL;
+    rw->prev = (uint8_t*) desc->buffer.ptr;
+    rw->data = rw->prev + desc->snapshot_size;
+    rw->data_size = desc->buffer.size - desc->snapshot_size;
+}
+
+void rewind_clear(rewind_t* rw) {
+    CHIPS_ASSERT(rw && rw->valid);
+    rw->first = 0;
+    rw->num = 0;
+    rw->frames_since_keyframe = 0;
+}
+
+int rewind_num_frames(rewind_t* rw) {
+    CHIPS_ASSERT(rw && rw->valid);
+    return rw->num;
+}
+
+static inline rewind_frame_t* _rewind_frame(rewind_t* rw, int i) {
+    return &rw->frames[(rw->first + i) % REWIND_MAX_FRAMES];
+}
+
+/*
+    Compress the XOR difference between src and ref (or src alone if ref is
+    null), a compressed snapshot is a sequence of:
+
+    - 16-bit number of bytes to skip (XOR result is zero)
+    - 16-bit number of literal bytes
+    - the literal bytes (XOR of src and ref)
+
+    Zero runs shorter than _REWIND_MIN_SKIP are stored as literals, so
+    that the compressed size is never much bigger than the input.
+*/
+static size_t _rewind_encode(const uint8_t* src, const uint8_t* ref, size_t num_bytes, uint8_t* dst) {
+    size_t pos = 0;
+    size_t out = 0;
+    while (pos < num_bytes) {
+        size_t skip = 0;
+        while (((pos + skip) < num_bytes) && (skip < _REWIND_MAX_RUN) && (0 == (src[pos+skip] ^ (ref ? ref[pos+skip] : 0)))) {
+            skip++;
+        }
+        pos += skip;
+        const size_t lit_start = pos;
+        while ((pos < num_bytes) && ((pos - lit_start) < _REWIND_MAX_RUN)) {
+            if (0 == (src[pos] ^ (ref ? ref[pos] : 0))) {
+                size_t zeros = 1;
+                while ((zeros < _REWIND_MIN_SKIP) && ((pos + zeros) < num_bytes) && (0 == (src[pos+zeros] ^ (ref ? ref[pos+zeros] : 0)))) {
+                    zeros++;
+                }
+                if ((zeros == _REWIND_MIN_SKIP) || ((pos + zeros) == num_bytes)) {
+                    break;
+                }
+            }
+            pos++;
+        }
+        const size_t num_lit = pos - lit_start;
+        dst[out++] = (uint8_t) skip;
+        dst[out++] = (uint8_t) (skip >> 8);
+        dst[out++] = (uint8_t) num_lit;
+        dst[out++] = (uint8_t) (num_lit >> 8);
+        for (size_t i = lit_start; i < pos; i++) {
+            dst[out++] = src[i] ^ (ref ? ref[i] : 0);
+        }
+    }
+    return out;
+}
+
+// XOR a compressed snapshot into dst
+static void _rewind_decode(const uint8_t* src, size_t src_size, uint8_t* dst, size_t num_bytes) {
+    size_t in = 0;
+    size_t pos = 0;
+    while ((in + 4) <= src_size) {
+        const size_t skip = src[in] | (src[in+1]<<8);
+        const size_t num_lit = src[in+2] | (src[in+3]<<8);
+        in += 4;
+        pos += skip;
+        CHIPS_ASSERT(((pos + num_lit) <= num_bytes) && ((in + num_lit) <= src_size));
+        for (size_t i = 0; i < num_lit; i++) {
+            dst[pos++] ^= src[in++];
+        }
+    }
+    (void)num_bytes;
+}
+
+// drop the oldest keyframe and all its depending difference frames
+static void _rewind_drop_oldest(rewind_t* rw) {
+    CHIPS_ASSERT(rw->num > 0);
+    do {
+        rw->first = (rw->first + 1) % REWIND_MAX_FRAMES;
+        rw->num--;
+    } while ((rw->num > 0) && !_rewind_frame(rw, 0)->keyframe);
+}
+
+// find a free location for a compressed snapshot, dropping old snapshots as needed
+static size_t _rewind_alloc(rewind_t* rw, size_t num_bytes) {
+    CHIPS_ASSERT(num_bytes <= rw->data_size);
+    if (rw->num == REWIND_MAX_FRAMES) {
+        _rewind_drop_oldest(rw);
+    }
+    size_t pos = 0;
+    if (rw->num > 0) {
+        const rewind_frame_t* newest = _rewind_frame(rw, rw->num - 1);
+        pos = newest->offset + newest->size;
+    }
+    if ((pos + num_bytes) > rw->data_size) {
+        pos = 0;
+    }
+    while (rw->num > 0) {
+        const rewind_frame_t* oldest = _rewind_frame(rw, 0);
+        const size_t start = oldest->offset;
+        const size_t end = oldest->offset + oldest->size;
+        if ((end <= pos) || (start >= (pos + num_bytes))) {
+            break;
+        }
+        _rewind_drop_oldest(rw);
+    }
+    return pos;
+}
+
+void rewind_push(rewind_t* rw, const void* snapshot) {
+    CHIPS_ASSERT(rw && rw->valid && snapshot);
+    const size_t pos = _rewind_alloc(rw, REWIND_MAX_ENCODED_SIZE(rw->snapshot_size));
+    const bool keyframe = (rw->num == 0) || (rw->frames_since_keyframe >= rw->keyframe_interval);
+    const size_t size = _rewind_encode((const uint8_t*)snapshot, keyframe ? 0 : rw->prev, rw->snapshot_size, rw->data + pos);
+    rewind_frame_t* frame = _rewind_frame(rw, rw->num++);
+    frame->offset = (uint32_t) pos;
+    frame->size = (uint32_t) size;
+    frame->keyframe = keyframe;
+    rw->frames_since_keyframe = keyframe ? 1 : rw->frames_since_keyframe + 1;
+    memcpy(rw->prev, snapshot, rw->snapshot_size);
+}
+
+bool rewind_seek(rewind_t* rw, int frames_back, void* dst) {
+    CHIPS_ASSERT(rw && rw->valid && dst);
+    if ((frames_back < 0) || (frames_back >= rw->num)) {
+        return false;
+    }
+    const int target = rw->num - 1 - frames_back;
+    int key = target;
+    while (!_rewind_frame(rw, key)->keyframe) {
+        key--;
+        CHIPS_ASSERT(key >= 0);
+    }
+    memset(dst, 0, rw->snapshot_size);
+    for (int i = key; i <= target; i++) {
+        const rewind_frame_t* frame = _rewind_frame(rw, i);
+        _rewind_decode(rw->data + frame->offset, frame->size, (uint8_t*)dst, rw->snapshot_size);
+    }
+    rw->num = target + 1;
+    rw->frames_since_keyframe = target - key + 1;
+    memcpy(rw->prev, dst, rw->snapshot_size);
+    return true;
+}
+
+#undef _REWIND_MAX_RUN
+#undef _REWIND_MIN_SKIP
+#endif // CHIPS_IMPL
@@ -26,6 +26,21 @@
         - no DMA mode
         - no interrupt-driven operation
 
+    ## Sector Data Fast Path
+
+    By default, sector data is read one byte at a time through the read_cb
+    callback. If the optional sectordata_cb callback is provided, the
+    controller instead asks the drive once per sector for a pointer to
+    the entire sector data, and serves data register reads of the READ_DATA
+    command directly from this pointer. The pointer must remain valid until
+    the next READ_DATA command, or until upd765_invalidate_sector() is called
+    (for instance when the disc is ejected or the drive motor is switched
+    off). Writes always go through write_cb.
+
+    Host code which doesn't need the per-byte handshake (e.g. a turbo loader
+    trap) can transfer an entire sector with upd765_dma_read(), this
+    yields the same result as reading the data register max_bytes times.
+
     ## TODO
         - DOCS!
         - cleanup callbacks
@@ -211,6 +226,8 @@ typedef int (*upd765_seeksector_cb)(int drive, int side, upd765_sectorinfo_t* in
 typedef int (*upd765_read_cb)(int drive, int side, void* user_data, uint8_t* out_data);
 /* callback to write the next sector data byte */
 typedef int (*upd765_write_cb)(int drive, int side, void* user_data, uint8_t data);
+/* optional callback to get pointer and size of the entire current sector data (see "Sector Data Fast Path") */
+typedef int (*upd765_sectordata_cb)(int drive, int side, void* user_data, const uint8_t** out_ptr, int* out_size);
 /* callback to read info about first sector on current reack */
 typedef int (*upd765_trackinfo_cb)(int drive, int side, void* user_data, upd765_sectorinfo_t* out_info);
 /* callback to get info about disk drive (called on SENSE_DRIVE_STATUS command) */
@@ -222,6 +239,7 @@ typedef struct {
     upd765_seeksector_cb seeksector_cb;
     upd765_read_cb read_cb;
     upd765_write_cb write_cb;
+    upd765_sectordata_cb sectordata_cb;     /* optional */
     upd765_trackinfo_cb trackinfo_cb;
     upd765_driveinfo_cb driveinfo_cb;
     void* user_data;
@@ -241,11 +259,17 @@ typedef struct {
     upd765_driveinfo_t drive_info;      /* only valid after SENSE_DRIVE_CMD */
     uint8_t st[4];
 
+    /* sector data fast path state */
+    const uint8_t* sector_ptr;  /* current sector data, 0 if not fetched yet */
+    int sector_size;            /* size of current sector data */
+    int sector_pos;             /* read position in current sector data */
+
     /* callback functions */
     upd765_seektrack_cb seektrack_cb;
     upd765_seeksector_cb seeksector_cb;
     upd765_read_cb read_cb;
     upd765_write_cb write_cb;
+    upd765_sectordata_cb sectordata_cb;
     upd765_trackinfo_cb trackinfo_cb;
     upd765_driveinfo_cb driveinfo_cb;
     void* user_data;
@@ -261,6 +285,10 @@ void upd765_init(upd765_t* upd, const upd765_desc_t* desc);
 void upd765_reset(upd765_t* upd);
 /* perform an IO request on the upd765 */
 uint64_t upd765_iorq(upd765_t* upd, uint64_t pins);
+/* read up to max_bytes of sector data in one go (same as reading the data register), returns number of bytes read */
+int upd765_dma_read(upd765_t* upd, uint8_t* dst, int max_bytes);
+/* drop the fetched sector data pointer (call when the disc or drive state changes from the outside) */
+void upd765_invalidate_sector(upd765_t* upd);
 // prepare upd765_t snapshot for saving
 void upd765_snapshot_onsave(upd765_t* snapshot);
 // fixup upd765_t snapshot after loading
@@ -415,6 +443,9 @@ static void _upd765_cmd(upd765_t* upd) {
                 const int fdd_index = upd->st[0] & 3;
                 const int side = (upd->st[0] & 4) >> 2;
                 const int res = upd->seeksector_cb(fdd_index, side, &upd->sector_info, upd->user_data);
+                upd->sector_ptr = 0;
+                upd->sector_size = 0;
+                upd->sector_pos = 0;
                 if (UPD765_RESULT_SUCCESS == res) {
                     _upd765_to_phase_exec(upd);
                 }
@@ -550,6 +581,30 @@ static void _upd765_cmd(upd765_t* upd) {
     }
 }
 
+/* sector data fast path, serve the next data byte from the current sector
+   data (fetched once per sector), same results as the byte-wise read_cb
+*/
+static int _upd765_sector_rd(upd765_t* upd, int fdd_index, int side, uint8_t* out_data) {
+    if (0 == upd->sector_ptr) {
+        const int res = upd->sectordata_cb(fdd_index, side, upd->user_data, &upd->sector_ptr, &upd->sector_size);
+        if ((res != UPD765_RESULT_SUCCESS) || (0 == upd->sector_ptr)) {
+            upd->sector_ptr = 0;
+            upd->sector_size = 0;
+            return (res != UPD765_RESULT_SUCCESS) ? res : UPD765_RESULT_NOT_READY;
+        }
+    }
+    if (upd->sector_pos < upd->sector_size) {
+        *out_data = upd->sector_ptr[upd->sector_pos++];
+        if (upd->sector_pos < upd->sector_size) {
+            return UPD765_RESULT_SUCCESS;
+        }
+        else {
+            return UPD765_RESULT_END_OF_SECTOR;
+        }
+    }
+    return UPD765_RESULT_NOT_FOUND;
+}
+
 /* called when a byte is read during the exec phase */
 static uint8_t _upd765_exec_rd(upd765_t* upd) {
     CHIPS_ASSERT(upd->phase == UPD765_PHASE_EXEC);
@@ -560,7 +615,13 @@ static uint8_t _upd765_exec_rd(upd765_t* upd) {
                 /* read next sector data byte from FDD */
                 const int fdd_index = upd->st[0] & 3;
                 const int side = (upd->st[0] & 4) >> 2;
-                const int res = upd->read_cb(fdd_index, side, upd->user_data, &data);
+                int res;
+                if (upd->sectordata_cb) {
+                    res = _upd765_sector_rd(upd, fdd_index, side, &data);
+                }
+                else {
+                    res = upd->read_cb(fdd_index, side, upd->user_data, &data);
+                }
                 if (res != UPD765_RESULT_SUCCESS) {
                     if (res & UPD765_RESULT_NOT_READY) {
                         upd->st[0] |= UPD765_ST0_NR;
@@ -683,6 +744,7 @@ void upd765_init(upd765_t* upd, const upd765_desc_t* desc) {
     upd->seeksector_cb = desc->seeksector_cb;
     upd->read_cb = desc->read_cb;
     upd->write_cb = desc->write_cb;
+    upd->sectordata_cb = desc->sectordata_cb;
     upd->trackinfo_cb = desc->trackinfo_cb;
     upd->driveinfo_cb = desc->driveinfo_cb;
     upd->user_data = desc->user_data;
@@ -717,11 +779,28 @@ uint64_t upd765_iorq(upd765_t* upd, uint64_t pins) {
     return pins;
 }
 
+int upd765_dma_read(upd765_t* upd, uint8_t* dst, int max_bytes) {
+    CHIPS_ASSERT(upd && dst && (max_bytes >= 0));
+    int num_bytes = 0;
+    while ((num_bytes < max_bytes) && (UPD765_PHASE_EXEC == upd->phase) && (UPD765_CMD_READ_DATA == upd->cmd)) {
+        dst[num_bytes++] = _upd765_exec_rd(upd);
+    }
+    return num_bytes;
+}
+
+void upd765_invalidate_sector(upd765_t* upd) {
+    CHIPS_ASSERT(upd);
+    upd->sector_ptr = 0;
+}
+
 void upd765_snapshot_onsave(upd765_t* snapshot) {
     CHIPS_ASSERT(snapshot);
     snapshot->seektrack_cb = 0;
     snapshot->seeksector_cb = 0;
     snapshot->read_cb = 0;
+    snapshot->write_cb = 0;
+    snapshot->sectordata_cb = 0;
+    snapshot->sector_ptr = 0;
     snapshot->trackinfo_cb = 0;
     snapshot->driveinfo_cb = 0;
     snapshot->user_data = 0;
@@ -732,6 +811,9 @@ void upd765_snapshot_onload(upd765_t* snapshot, upd765_t* sys) {
     snapshot->seektrack_cb = sys->seektrack_cb;
     snapshot->seeksector_cb = sys->seeksector_cb;
     snapshot->read_cb = sys->read_cb;
+    snapshot->write_cb = sys->write_cb;
+    snapshot->sectordata_cb = sys->sectordata_cb;
+    snapshot->sector_ptr = 0;
     snapshot->trackinfo_cb = sys->trackinfo_cb;
     snapshot->driveinfo_cb = sys->driveinfo_cb;
     snapshot->user_data = sys->user_data;
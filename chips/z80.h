@@ -16,6 +16,27 @@
     #define CHIPS_ASSERT(x) your_own_asset_macro(x)
     ~~~
 
+    ~~~C
+    #define Z80_COMPUTED_GOTO
+    ~~~
+        if defined, the decoder dispatches the next step with a computed
+        goto through a label table instead of a switch statement, this
+        is only supported on GCC and Clang (on other compilers the switch
+        statement is used), note that the tick function can't be
+        inlined into z80_exec() in this mode
+
+    ~~~C
+    #define Z80_LAZY_FLAGS
+    ~~~
+        if defined, the 8-bit arithmetic and logic instructions (ADD, ADC,
+        SUB, SBC, AND, XOR, OR, CP, NEG, INC, DEC) only store their operands
+        and result, and the flags are computed from those when they are
+        actually needed (conditional jumps only compute the tested flag),
+        in this mode the F register (and the AF register pair) is only
+        valid after calling z80_sync_flags(), this must also be called
+        before F or AF is modified from the outside, must be the same for
+        all files which include z80.h
+
     ## Emulated Pins
     ***********************************
     *           +-----------+         *
@@ -63,6 +84,40 @@
         Helper function to detect whether the z80_t instance has completed
         an instruction.
 
+    ~~~C
+    void z80_sync_flags(z80_t* cpu)
+    ~~~
+        Computes any lazily evaluated flags into the F register, call this
+        before accessing F or AF from the outside when Z80_LAZY_FLAGS is
+        defined (otherwise this function does nothing).
+
+    ~~~C
+    uint64_t z80_exec(z80_t* cpu, mem_t* mem, uint64_t pins, uint32_t num_ticks, z80_tick_t tick_cb, void* user_data)
+    ~~~
+        Run the z80_t instance for `num_ticks` clock cycles. Plain memory
+        reads and writes are served directly from the `mem_t` page table, and idle
+        ticks are skipped, the system tick callback is only invoked for
+        ticks with the Z80_IORQ (this includes interrupt acknowledge), Z80_WAIT
+        or Z80_RETI pin set, and always for the last tick. The callback
+        receives the number of ticks since it was last called (including the
+        current tick), so that the system can catch up its other chips.
+        Returns the pin mask of the last tick.
+
+        z80_exec() is only available when chips/mem.h is included before z80.h,
+        in this case Z80_HAS_EXEC is defined.
+
+        See the HOWTO section for the rules a system must follow to get
+        the same results as with z80_tick().
+
+    ~~~C
+    void z80_serialize(z80_t* cpu, chips_stream_t* stream)
+    ~~~
+        Write the z80_t state into a stream, or read it from a stream
+        (depending on how the stream was created, see chips_common.h).
+
+        z80_serialize() is only available when chips/chips_common.h is
+        included before z80.h.
+
     ## HOWTO
 
     Initialize a new z80_t instance and start ticking it:
@@ -201,6 +256,48 @@
             // the Z80_INT pin will now be set if any of the chips wants to issue an interrupt request
         }
     ~~~
+
+    ## Batched execution with z80_exec()
+
+    When most clock cycles of an emulated system are plain memory accesses
+    without side effects, the per-tick roundtrip through the system tick
+    function can be avoided with z80_exec(). The job of the system tick
+    function moves into a callback which is only called for 'interesting'
+    ticks (IO requests, interrupt acknowledge, wait states, RETI and the
+    last tick of the batch):
+
+    ~~~C
+        static uint64_t tick(uint32_t num_ticks, uint64_t pins, void* user_data) {
+            sys_t* sys = (sys_t*) user_data;
+            // advance the other chips by num_ticks
+            ...
+            if (pins & Z80_MREQ) {
+                // a memory access in the last tick of the batch
+                ...
+            }
+            else if (pins & Z80_IORQ) {
+                // handle IO request or interrupt acknowledge
+                ...
+            }
+            return pins;
+        }
+        ...
+        while (!done) {
+            // run until the next 'device event' (e.g. an INT pin change)
+            uint32_t num_ticks = ticks_until_next_event(&sys);
+            pins = z80_exec(&cpu, &mem, pins, num_ticks, tick, &sys);
+        }
+    ~~~
+
+    z80_exec() yields the same results as calling z80_tick() in a loop as long
+    as the system follows these rules:
+
+    - the batch size must never cross a tick where the system needs to change
+      an input pin (Z80_INT, Z80_NMI, Z80_WAIT) or needs to observe a memory
+      access (e.g. memory contention or memory mapped IO)
+    - the other chips must be able to 'catch up' the skipped ticks when
+      the callback is invoked
+    - the memory mapping may only be changed from inside the callback
 #*/
 /*
     zlib/libpng license
@@ -363,6 +460,13 @@ typedef struct {
     uint16_t af2, bc2, de2, hl2; // shadow register bank
     uint8_t im;
     bool iff1, iff2;
+    #if defined(Z80_LAZY_FLAGS)
+    // operands and result of the last flag-setting ALU instruction
+    uint8_t lf_kind;    // _Z80_LF_NONE if F is up to date
+    uint8_t lf_acc;
+    uint8_t lf_val;
+    uint16_t lf_res;
+    #endif
 } z80_t;
 
 // initialize a new Z80 instance and return initial pin mask
@@ -375,6 +479,22 @@ uint64_t z80_tick(z80_t* cpu, uint64_t pins);
 uint64_t z80_prefetch(z80_t* cpu, uint16_t new_pc);
 // return true when full instruction has finished
 bool z80_opdone(z80_t* cpu);
+// compute lazily evaluated flags into the F register (see Z80_LAZY_FLAGS)
+void z80_sync_flags(z80_t* cpu);
+
+#if defined(MEM_NUM_LAYERS)
+// z80_exec() is available (mem.h was included before z80.h)
+#define Z80_HAS_EXEC (1)
+// system tick callback for z80_exec(), called with the number of ticks since the last call
+typedef uint64_t (*z80_tick_t)(uint32_t num_ticks, uint64_t pins, void* user_data);
+// execute a number of ticks, handling plain memory accesses via mem_t, return new pin mask
+uint64_t z80_exec(z80_t* cpu, mem_t* mem, uint64_t pins, uint32_t num_ticks, z80_tick_t tick_cb, void* user_data);
+#endif
+
+#if defined(CHIPS_FOURCC)
+// write z80_t state to a stream or read it from a stream
+void z80_serialize(z80_t* cpu, chips_stream_t* stream);
+#endif
 
 #ifdef __cplusplus
 } // extern C
@@ -390,10 +510,25 @@ bool z80_opdone(z80_t* cpu);
 
 #if defined(__GNUC__)
 #define _Z80_UNREACHABLE __builtin_unreachable()
+#define _Z80_FORCE_INLINE inline __attribute__((always_inline))
 #elif defined(_MSC_VER)
 #define _Z80_UNREACHABLE __assume(0)
+#define _Z80_FORCE_INLINE __forceinline
 #else
 #define _Z80_UNREACHABLE
+#define _Z80_FORCE_INLINE inline
+#endif
+
+// computed-goto decoder dispatch (GCC and Clang only)
+#if defined(Z80_COMPUTED_GOTO) && defined(__GNUC__)
+#define _Z80_USE_COMPUTED_GOTO
+// GCC refuses to inline a function which stores label addresses in a static table
+#define _Z80_TICK_INLINE
+#define _Z80_CASE(n) _Z80_CASE_LABEL(n)
+#define _Z80_CASE_LABEL(n) case n: _z80_step_##n
+#else
+#define _Z80_TICK_INLINE _Z80_FORCE_INLINE
+#define _Z80_CASE(n) case n
 #endif
 
 // extra/special decoder steps
@@ -535,6 +670,141 @@ static inline uint8_t _z80_sziff2_flags(z80_t* cpu, uint8_t val) {
     return (cpu->f & Z80_CF) | _z80_sz_flags(val) | (val & (Z80_YF|Z80_XF)) | (cpu->iff2 ? Z80_PF : 0);
 }
 
+#if defined(Z80_LAZY_FLAGS)
+// kinds of lazily evaluated flags
+#define _Z80_LF_NONE    (0)     // F is up to date
+#define _Z80_LF_ADD     (1)     // ADD, ADC
+#define _Z80_LF_SUB     (2)     // SUB, SBC, NEG
+#define _Z80_LF_CP      (3)     // CP
+#define _Z80_LF_AND     (4)     // AND
+#define _Z80_LF_XOR_OR  (5)     // XOR, OR
+#define _Z80_LF_INC     (6)     // INC, the unaffected carry flag is kept in F
+#define _Z80_LF_DEC     (7)     // DEC, the unaffected carry flag is kept in F
+
+static inline void _z80_lazy_flags(z80_t* cpu, uint8_t kind, uint8_t acc, uint8_t val, uint32_t res) {
+    cpu->lf_kind = kind;
+    cpu->lf_acc = acc;
+    cpu->lf_val = val;
+    cpu->lf_res = (uint16_t)res;
+}
+
+static void _z80_materialize_flags(z80_t* cpu) {
+    const uint8_t acc = cpu->lf_acc;
+    const uint8_t val = cpu->lf_val;
+    const uint32_t res = cpu->lf_res;
+    switch (cpu->lf_kind) {
+        case _Z80_LF_ADD:       cpu->f = _z80_add_flags(acc, val, res); break;
+        case _Z80_LF_SUB:       cpu->f = _z80_sub_flags(acc, val, res); break;
+        case _Z80_LF_CP:        cpu->f = _z80_cp_flags(acc, val, res); break;
+        case _Z80_LF_AND:       cpu->f = _z80_szp_flags[res & 0xFF] | Z80_HF; break;
+        case _Z80_LF_XOR_OR:    cpu->f = _z80_szp_flags[res & 0xFF]; break;
+        case _Z80_LF_INC:
+            cpu->f = (cpu->f & Z80_CF) | _z80_sz_flags(res) | (res & (Z80_XF|Z80_YF)) | ((res ^ val) & Z80_HF) | ((res == 0x80) ? Z80_VF : 0);
+            break;
+        case _Z80_LF_DEC:
+            cpu->f = (cpu->f & Z80_CF) | Z80_NF | _z80_sz_flags(res) | (res & (Z80_XF|Z80_YF)) | ((res ^ val) & Z80_HF) | ((res == 0x7F) ? Z80_VF : 0);
+            break;
+        default: break;
+    }
+    cpu->lf_kind = _Z80_LF_NONE;
+}
+
+static inline uint8_t _z80_get_f(z80_t* cpu) {
+    if (cpu->lf_kind != _Z80_LF_NONE) {
+        _z80_materialize_flags(cpu);
+    }
+    return cpu->f;
+}
+
+// compute single flags without materializing F
+static inline bool _z80_lazy_zf(z80_t* cpu) {
+    return (cpu->lf_kind != _Z80_LF_NONE) ? (0 == (cpu->lf_res & 0xFF)) : (0 != (cpu->f & Z80_ZF));
+}
+
+static inline bool _z80_lazy_sf(z80_t* cpu) {
+    return (cpu->lf_kind != _Z80_LF_NONE) ? (0 != (cpu->lf_res & 0x80)) : (0 != (cpu->f & Z80_SF));
+}
+
+static inline uint8_t _z80_lazy_cf(z80_t* cpu) {
+    switch (cpu->lf_kind) {
+        case _Z80_LF_ADD:
+        case _Z80_LF_SUB:
+        case _Z80_LF_CP:
+            return (cpu->lf_res >> 8) & Z80_CF;
+        case _Z80_LF_AND:
+        case _Z80_LF_XOR_OR:
+            return 0;
+        default:
+            return cpu->f & Z80_CF;
+    }
+}
+
+static inline void _z80_add8(z80_t* cpu, uint8_t val) {
+    uint32_t res = cpu->a + val;
+    _z80_lazy_flags(cpu, _Z80_LF_ADD, cpu->a, val, res);
+    cpu->a = (uint8_t)res;
+}
+
+static inline void _z80_adc8(z80_t* cpu, uint8_t val) {
+    uint32_t res = cpu->a + val + _z80_lazy_cf(cpu);
+    _z80_lazy_flags(cpu, _Z80_LF_ADD, cpu->a, val, res);
+    cpu->a = (uint8_t)res;
+}
+
+static inline void _z80_sub8(z80_t* cpu, uint8_t val) {
+    uint32_t res = (uint32_t) ((int)cpu->a - (int)val);
+    _z80_lazy_flags(cpu, _Z80_LF_SUB, cpu->a, val, res);
+    cpu->a = (uint8_t)res;
+}
+
+static inline void _z80_sbc8(z80_t* cpu, uint8_t val) {
+    uint32_t res = (uint32_t) ((int)cpu->a - (int)val - _z80_lazy_cf(cpu));
+    _z80_lazy_flags(cpu, _Z80_LF_SUB, cpu->a, val, res);
+    cpu->a = (uint8_t)res;
+}
+
+static inline void _z80_and8(z80_t* cpu, uint8_t val) {
+    cpu->a &= val;
+    _z80_lazy_flags(cpu, _Z80_LF_AND, 0, 0, cpu->a);
+}
+
+static inline void _z80_xor8(z80_t* cpu, uint8_t val) {
+    cpu->a ^= val;
+    _z80_lazy_flags(cpu, _Z80_LF_XOR_OR, 0, 0, cpu->a);
+}
+
+static inline void _z80_or8(z80_t* cpu, uint8_t val) {
+    cpu->a |= val;
+    _z80_lazy_flags(cpu, _Z80_LF_XOR_OR, 0, 0, cpu->a);
+}
+
+static inline void _z80_cp8(z80_t* cpu, uint8_t val) {
+    uint32_t res = (uint32_t) ((int)cpu->a - (int)val);
+    _z80_lazy_flags(cpu, _Z80_LF_CP, cpu->a, val, res);
+}
+
+static inline void _z80_neg8(z80_t* cpu) {
+    uint32_t res = (uint32_t) (0 - (int)cpu->a);
+    _z80_lazy_flags(cpu, _Z80_LF_SUB, 0, cpu->a, res);
+    cpu->a = (uint8_t)res;
+}
+
+static inline uint8_t _z80_inc8(z80_t* cpu, uint8_t val) {
+    uint8_t res = val + 1;
+    // the carry flag isn't affected
+    cpu->f = _z80_lazy_cf(cpu);
+    _z80_lazy_flags(cpu, _Z80_LF_INC, 0, val, res);
+    return res;
+}
+
+static inline uint8_t _z80_dec8(z80_t* cpu, uint8_t val) {
+    uint8_t res = val - 1;
+    // the carry flag isn't affected
+    cpu->f = _z80_lazy_cf(cpu);
+    _z80_lazy_flags(cpu, _Z80_LF_DEC, 0, val, res);
+    return res;
+}
+#else
 static inline void _z80_add8(z80_t* cpu, uint8_t val) {
     uint32_t res = cpu->a + val;
     cpu->f = _z80_add_flags(cpu->a, val, res);
@@ -604,6 +874,7 @@ static inline uint8_t _z80_dec8(z80_t* cpu, uint8_t val) {
     cpu->f = f | (cpu->f & Z80_CF);
     return res;
 }
+#endif
 
 static inline void _z80_ex_de_hl(z80_t* cpu) {
     uint16_t tmp = cpu->hl;
@@ -1037,6 +1308,17 @@ uint64_t z80_prefetch(z80_t* cpu, uint16_t new_pc) {
     return 0;
 }
 
+void z80_sync_flags(z80_t* cpu) {
+    CHIPS_ASSERT(cpu);
+    #if defined(Z80_LAZY_FLAGS)
+    if (cpu->lf_kind != _Z80_LF_NONE) {
+        _z80_materialize_flags(cpu);
+    }
+    #else
+    (void)cpu;
+    #endif
+}
+
 // pin helper macros
 #define _sa(ab)             pins=_z80_set_ab(pins,ab)
 #define _sax(ab,x)          pins=_z80_set_ab_x(pins,ab,x)
@@ -1056,6 +1338,18 @@ uint64_t z80_prefetch(z80_t* cpu, uint16_t new_pc) {
 #define _ioread(ab)     _sax(ab,Z80_IORQ|Z80_RD)
 #define _iowrite(ab,d)  _sadx(ab,d,Z80_IORQ|Z80_WR)
 #define _wait()         {if(pins&Z80_WAIT)goto step_to;}
+#if defined(Z80_LAZY_FLAGS)
+#define _sync_flags()   {if(cpu->lf_kind!=_Z80_LF_NONE){_z80_materialize_flags(cpu);}}
+#define _cc_nz          (!_z80_lazy_zf(cpu))
+#define _cc_z           (_z80_lazy_zf(cpu))
+#define _cc_nc          (!_z80_lazy_cf(cpu))
+#define _cc_c           (_z80_lazy_cf(cpu))
+#define _cc_po          (!(_z80_get_f(cpu)&Z80_PF))
+#define _cc_pe          (_z80_get_f(cpu)&Z80_PF)
+#define _cc_p           (!_z80_lazy_sf(cpu))
+#define _cc_m           (_z80_lazy_sf(cpu))
+#else
+#define _sync_flags()
 #define _cc_nz          (!(cpu->f&Z80_ZF))
 #define _cc_z           (cpu->f&Z80_ZF)
 #define _cc_nc          (!(cpu->f&Z80_CF))
@@ -1064,1722 +1358,1946 @@ uint64_t z80_prefetch(z80_t* cpu, uint16_t new_pc) {
 #define _cc_pe          (cpu->f&Z80_PF)
 #define _cc_p           (!(cpu->f&Z80_SF))
 #define _cc_m           (cpu->f&Z80_SF)
+#endif
 
-uint64_t z80_tick(z80_t* cpu, uint64_t pins) {
+// the actual tick function is shared between z80_tick() and z80_exec()
+static _Z80_TICK_INLINE uint64_t _z80_tick(z80_t* cpu, uint64_t pins) {
     pins &= ~(Z80_CTRL_PIN_MASK|Z80_RETI);
+    #if defined(_Z80_USE_COMPUTED_GOTO)
+    // the switch statement below is skipped, its case labels double as goto targets
+    static const void* const _z80_step_table[] = {
+        // <% step_table
+        &&_z80_step_0,&&_z80_step_1,&&_z80_step_2,&&_z80_step_3,&&_z80_step_4,&&_z80_step_5,&&_z80_step_6,&&_z80_step_7,
+        &&_z80_step_8,&&_z80_step_9,&&_z80_step_10,&&_z80_step_11,&&_z80_step_12,&&_z80_step_13,&&_z80_step_14,&&_z80_step_15,
+        &&_z80_step_16,&&_z80_step_17,&&_z80_step_18,&&_z80_step_19,&&_z80_step_20,&&_z80_step_21,&&_z80_step_22,&&_z80_step_23,
+        &&_z80_step_24,&&_z80_step_25,&&_z80_step_26,&&_z80_step_27,&&_z80_step_28,&&_z80_step_29,&&_z80_step_30,&&_z80_step_31,
+        &&_z80_step_32,&&_z80_step_33,&&_z80_step_34,&&_z80_step_35,&&_z80_step_36,&&_z80_step_37,&&_z80_step_38,&&_z80_step_39,
+        &&_z80_step_40,&&_z80_step_41,&&_z80_step_42,&&_z80_step_43,&&_z80_step_44,&&_z80_step_45,&&_z80_step_46,&&_z80_step_47,
+        &&_z80_step_48,&&_z80_step_49,&&_z80_step_50,&&_z80_step_51,&&_z80_step_52,&&_z80_step_53,&&_z80_step_54,&&_z80_step_55,
+        &&_z80_step_56,&&_z80_step_57,&&_z80_step_58,&&_z80_step_59,&&_z80_step_60,&&_z80_step_61,&&_z80_step_62,&&_z80_step_63,
+        &&_z80_step_64,&&_z80_step_65,&&_z80_step_66,&&_z80_step_67,&&_z80_step_68,&&_z80_step_69,&&_z80_step_70,&&_z80_step_71,
+        &&_z80_step_72,&&_z80_step_73,&&_z80_step_74,&&_z80_step_75,&&_z80_step_76,&&_z80_step_77,&&_z80_step_78,&&_z80_step_79,
+        &&_z80_step_80,&&_z80_step_81,&&_z80_step_82,&&_z80_step_83,&&_z80_step_84,&&_z80_step_85,&&_z80_step_86,&&_z80_step_87,
+        &&_z80_step_88,&&_z80_step_89,&&_z80_step_90,&&_z80_step_91,&&_z80_step_92,&&_z80_step_93,&&_z80_step_94,&&_z80_step_95,
+        &&_z80_step_96,&&_z80_step_97,&&_z80_step_98,&&_z80_step_99,&&_z80_step_100,&&_z80_step_101,&&_z80_step_102,&&_z80_step_103,
+        &&_z80_step_104,&&_z80_step_105,&&_z80_step_106,&&_z80_step_107,&&_z80_step_108,&&_z80_step_109,&&_z80_step_110,&&_z80_step_111,
+        &&_z80_step_112,&&_z80_step_113,&&_z80_step_114,&&_z80_step_115,&&_z80_step_116,&&_z80_step_117,&&_z80_step_118,&&_z80_step_119,
+        &&_z80_step_120,&&_z80_step_121,&&_z80_step_122,&&_z80_step_123,&&_z80_step_124,&&_z80_step_125,&&_z80_step_126,&&_z80_step_127,
+        &&_z80_step_128,&&_z80_step_129,&&_z80_step_130,&&_z80_step_131,&&_z80_step_132,&&_z80_step_133,&&_z80_step_134,&&_z80_step_135,
+        &&_z80_step_136,&&_z80_step_137,&&_z80_step_138,&&_z80_step_139,&&_z80_step_140,&&_z80_step_141,&&_z80_step_142,&&_z80_step_143,
+        &&_z80_step_144,&&_z80_step_145,&&_z80_step_146,&&_z80_step_147,&&_z80_step_148,&&_z80_step_149,&&_z80_step_150,&&_z80_step_151,
+        &&_z80_step_152,&&_z80_step_153,&&_z80_step_154,&&_z80_step_155,&&_z80_step_156,&&_z80_step_157,&&_z80_step_158,&&_z80_step_159,
+        &&_z80_step_160,&&_z80_step_161,&&_z80_step_162,&&_z80_step_163,&&_z80_step_164,&&_z80_step_165,&&_z80_step_166,&&_z80_step_167,
+        &&_z80_step_168,&&_z80_step_169,&&_z80_step_170,&&_z80_step_171,&&_z80_step_172,&&_z80_step_173,&&_z80_step_174,&&_z80_step_175,
+        &&_z80_step_176,&&_z80_step_177,&&_z80_step_178,&&_z80_step_179,&&_z80_step_180,&&_z80_step_181,&&_z80_step_182,&&_z80_step_183,
+        &&_z80_step_184,&&_z80_step_185,&&_z80_step_186,&&_z80_step_187,&&_z80_step_188,&&_z80_step_189,&&_z80_step_190,&&_z80_step_191,
+        &&_z80_step_192,&&_z80_step_193,&&_z80_step_194,&&_z80_step_195,&&_z80_step_196,&&_z80_step_197,&&_z80_step_198,&&_z80_step_199,
+        &&_z80_step_200,&&_z80_step_201,&&_z80_step_202,&&_z80_step_203,&&_z80_step_204,&&_z80_step_205,&&_z80_step_206,&&_z80_step_207,
+        &&_z80_step_208,&&_z80_step_209,&&_z80_step_210,&&_z80_step_211,&&_z80_step_212,&&_z80_step_213,&&_z80_step_214,&&_z80_step_215,
+        &&_z80_step_216,&&_z80_step_217,&&_z80_step_218,&&_z80_step_219,&&_z80_step_220,&&_z80_step_221,&&_z80_step_222,&&_z80_step_223,
+        &&_z80_step_224,&&_z80_step_225,&&_z80_step_226,&&_z80_step_227,&&_z80_step_228,&&_z80_step_229,&&_z80_step_230,&&_z80_step_231,
+        &&_z80_step_232,&&_z80_step_233,&&_z80_step_234,&&_z80_step_235,&&_z80_step_236,&&_z80_step_237,&&_z80_step_238,&&_z80_step_239,
+        &&_z80_step_240,&&_z80_step_241,&&_z80_step_242,&&_z80_step_243,&&_z80_step_244,&&_z80_step_245,&&_z80_step_246,&&_z80_step_247,
+        &&_z80_step_248,&&_z80_step_249,&&_z80_step_250,&&_z80_step_251,&&_z80_step_252,&&_z80_step_253,&&_z80_step_254,&&_z80_step_255,
+        &&_z80_step_256,&&_z80_step_257,&&_z80_step_258,&&_z80_step_259,&&_z80_step_260,&&_z80_step_261,&&_z80_step_262,&&_z80_step_263,
+        &&_z80_step_264,&&_z80_step_265,&&_z80_step_266,&&_z80_step_267,&&_z80_step_268,&&_z80_step_269,&&_z80_step_270,&&_z80_step_271,
+        &&_z80_step_272,&&_z80_step_273,&&_z80_step_274,&&_z80_step_275,&&_z80_step_276,&&_z80_step_277,&&_z80_step_278,&&_z80_step_279,
+        &&_z80_step_280,&&_z80_step_281,&&_z80_step_282,&&_z80_step_283,&&_z80_step_284,&&_z80_step_285,&&_z80_step_286,&&_z80_step_287,
+        &&_z80_step_288,&&_z80_step_289,&&_z80_step_290,&&_z80_step_291,&&_z80_step_292,&&_z80_step_293,&&_z80_step_294,&&_z80_step_295,
+        &&_z80_step_296,&&_z80_step_297,&&_z80_step_298,&&_z80_step_299,&&_z80_step_300,&&_z80_step_301,&&_z80_step_302,&&_z80_step_303,
+        &&_z80_step_304,&&_z80_step_305,&&_z80_step_306,&&_z80_step_307,&&_z80_step_308,&&_z80_step_309,&&_z80_step_310,&&_z80_step_311,
+        &&_z80_step_312,&&_z80_step_313,&&_z80_step_314,&&_z80_step_315,&&_z80_step_316,&&_z80_step_317,&&_z80_step_318,&&_z80_step_319,
+        &&_z80_step_320,&&_z80_step_321,&&_z80_step_322,&&_z80_step_323,&&_z80_step_324,&&_z80_step_325,&&_z80_step_326,&&_z80_step_327,
+        &&_z80_step_328,&&_z80_step_329,&&_z80_step_330,&&_z80_step_331,&&_z80_step_332,&&_z80_step_333,&&_z80_step_334,&&_z80_step_335,
+        &&_z80_step_336,&&_z80_step_337,&&_z80_step_338,&&_z80_step_339,&&_z80_step_340,&&_z80_step_341,&&_z80_step_342,&&_z80_step_343,
+        &&_z80_step_344,&&_z80_step_345,&&_z80_step_346,&&_z80_step_347,&&_z80_step_348,&&_z80_step_349,&&_z80_step_350,&&_z80_step_351,
+        &&_z80_step_352,&&_z80_step_353,&&_z80_step_354,&&_z80_step_355,&&_z80_step_356,&&_z80_step_357,&&_z80_step_358,&&_z80_step_359,
+        &&_z80_step_360,&&_z80_step_361,&&_z80_step_362,&&_z80_step_363,&&_z80_step_364,&&_z80_step_365,&&_z80_step_366,&&_z80_step_367,
+        &&_z80_step_368,&&_z80_step_369,&&_z80_step_370,&&_z80_step_371,&&_z80_step_372,&&_z80_step_373,&&_z80_step_374,&&_z80_step_375,
+        &&_z80_step_376,&&_z80_step_377,&&_z80_step_378,&&_z80_step_379,&&_z80_step_380,&&_z80_step_381,&&_z80_step_382,&&_z80_step_383,
+        &&_z80_step_384,&&_z80_step_385,&&_z80_step_386,&&_z80_step_387,&&_z80_step_388,&&_z80_step_389,&&_z80_step_390,&&_z80_step_391,
+        &&_z80_step_392,&&_z80_step_393,&&_z80_step_394,&&_z80_step_395,&&_z80_step_396,&&_z80_step_397,&&_z80_step_398,&&_z80_step_399,
+        &&_z80_step_400,&&_z80_step_401,&&_z80_step_402,&&_z80_step_403,&&_z80_step_404,&&_z80_step_405,&&_z80_step_406,&&_z80_step_407,
+        &&_z80_step_408,&&_z80_step_409,&&_z80_step_410,&&_z80_step_411,&&_z80_step_412,&&_z80_step_413,&&_z80_step_414,&&_z80_step_415,
+        &&_z80_step_416,&&_z80_step_417,&&_z80_step_418,&&_z80_step_419,&&_z80_step_420,&&_z80_step_421,&&_z80_step_422,&&_z80_step_423,
+        &&_z80_step_424,&&_z80_step_425,&&_z80_step_426,&&_z80_step_427,&&_z80_step_428,&&_z80_step_429,&&_z80_step_430,&&_z80_step_431,
+        &&_z80_step_432,&&_z80_step_433,&&_z80_step_434,&&_z80_step_435,&&_z80_step_436,&&_z80_step_437,&&_z80_step_438,&&_z80_step_439,
+        &&_z80_step_440,&&_z80_step_441,&&_z80_step_442,&&_z80_step_443,&&_z80_step_444,&&_z80_step_445,&&_z80_step_446,&&_z80_step_447,
+        &&_z80_step_448,&&_z80_step_449,&&_z80_step_450,&&_z80_step_451,&&_z80_step_452,&&_z80_step_453,&&_z80_step_454,&&_z80_step_455,
+        &&_z80_step_456,&&_z80_step_457,&&_z80_step_458,&&_z80_step_459,&&_z80_step_460,&&_z80_step_461,&&_z80_step_462,&&_z80_step_463,
+        &&_z80_step_464,&&_z80_step_465,&&_z80_step_466,&&_z80_step_467,&&_z80_step_468,&&_z80_step_469,&&_z80_step_470,&&_z80_step_471,
+        &&_z80_step_472,&&_z80_step_473,&&_z80_step_474,&&_z80_step_475,&&_z80_step_476,&&_z80_step_477,&&_z80_step_478,&&_z80_step_479,
+        &&_z80_step_480,&&_z80_step_481,&&_z80_step_482,&&_z80_step_483,&&_z80_step_484,&&_z80_step_485,&&_z80_step_486,&&_z80_step_487,
+        &&_z80_step_488,&&_z80_step_489,&&_z80_step_490,&&_z80_step_491,&&_z80_step_492,&&_z80_step_493,&&_z80_step_494,&&_z80_step_495,
+        &&_z80_step_496,&&_z80_step_497,&&_z80_step_498,&&_z80_step_499,&&_z80_step_500,&&_z80_step_501,&&_z80_step_502,&&_z80_step_503,
+        &&_z80_step_504,&&_z80_step_505,&&_z80_step_506,&&_z80_step_507,&&_z80_step_508,&&_z80_step_509,&&_z80_step_510,&&_z80_step_511,
+        &&_z80_step_512,&&_z80_step_513,&&_z80_step_514,&&_z80_step_515,&&_z80_step_516,&&_z80_step_517,&&_z80_step_518,&&_z80_step_519,
+        &&_z80_step_520,&&_z80_step_521,&&_z80_step_522,&&_z80_step_523,&&_z80_step_524,&&_z80_step_525,&&_z80_step_526,&&_z80_step_527,
+        &&_z80_step_528,&&_z80_step_529,&&_z80_step_530,&&_z80_step_531,&&_z80_step_532,&&_z80_step_533,&&_z80_step_534,&&_z80_step_535,
+        &&_z80_step_536,&&_z80_step_537,&&_z80_step_538,&&_z80_step_539,&&_z80_step_540,&&_z80_step_541,&&_z80_step_542,&&_z80_step_543,
+        &&_z80_step_544,&&_z80_step_545,&&_z80_step_546,&&_z80_step_547,&&_z80_step_548,&&_z80_step_549,&&_z80_step_550,&&_z80_step_551,
+        &&_z80_step_552,&&_z80_step_553,&&_z80_step_554,&&_z80_step_555,&&_z80_step_556,&&_z80_step_557,&&_z80_step_558,&&_z80_step_559,
+        &&_z80_step_560,&&_z80_step_561,&&_z80_step_562,&&_z80_step_563,&&_z80_step_564,&&_z80_step_565,&&_z80_step_566,&&_z80_step_567,
+        &&_z80_step_568,&&_z80_step_569,&&_z80_step_570,&&_z80_step_571,&&_z80_step_572,&&_z80_step_573,&&_z80_step_574,&&_z80_step_575,
+        &&_z80_step_576,&&_z80_step_577,&&_z80_step_578,&&_z80_step_579,&&_z80_step_580,&&_z80_step_581,&&_z80_step_582,&&_z80_step_583,
+        &&_z80_step_584,&&_z80_step_585,&&_z80_step_586,&&_z80_step_587,&&_z80_step_588,&&_z80_step_589,&&_z80_step_590,&&_z80_step_591,
+        &&_z80_step_592,&&_z80_step_593,&&_z80_step_594,&&_z80_step_595,&&_z80_step_596,&&_z80_step_597,&&_z80_step_598,&&_z80_step_599,
+        &&_z80_step_600,&&_z80_step_601,&&_z80_step_602,&&_z80_step_603,&&_z80_step_604,&&_z80_step_605,&&_z80_step_606,&&_z80_step_607,
+        &&_z80_step_608,&&_z80_step_609,&&_z80_step_610,&&_z80_step_611,&&_z80_step_612,&&_z80_step_613,&&_z80_step_614,&&_z80_step_615,
+        &&_z80_step_616,&&_z80_step_617,&&_z80_step_618,&&_z80_step_619,&&_z80_step_620,&&_z80_step_621,&&_z80_step_622,&&_z80_step_623,
+        &&_z80_step_624,&&_z80_step_625,&&_z80_step_626,&&_z80_step_627,&&_z80_step_628,&&_z80_step_629,&&_z80_step_630,&&_z80_step_631,
+        &&_z80_step_632,&&_z80_step_633,&&_z80_step_634,&&_z80_step_635,&&_z80_step_636,&&_z80_step_637,&&_z80_step_638,&&_z80_step_639,
+        &&_z80_step_640,&&_z80_step_641,&&_z80_step_642,&&_z80_step_643,&&_z80_step_644,&&_z80_step_645,&&_z80_step_646,&&_z80_step_647,
+        &&_z80_step_648,&&_z80_step_649,&&_z80_step_650,&&_z80_step_651,&&_z80_step_652,&&_z80_step_653,&&_z80_step_654,&&_z80_step_655,
+        &&_z80_step_656,&&_z80_step_657,&&_z80_step_658,&&_z80_step_659,&&_z80_step_660,&&_z80_step_661,&&_z80_step_662,&&_z80_step_663,
+        &&_z80_step_664,&&_z80_step_665,&&_z80_step_666,&&_z80_step_667,&&_z80_step_668,&&_z80_step_669,&&_z80_step_670,&&_z80_step_671,
+        &&_z80_step_672,&&_z80_step_673,&&_z80_step_674,&&_z80_step_675,&&_z80_step_676,&&_z80_step_677,&&_z80_step_678,&&_z80_step_679,
+        &&_z80_step_680,&&_z80_step_681,&&_z80_step_682,&&_z80_step_683,&&_z80_step_684,&&_z80_step_685,&&_z80_step_686,&&_z80_step_687,
+        &&_z80_step_688,&&_z80_step_689,&&_z80_step_690,&&_z80_step_691,&&_z80_step_692,&&_z80_step_693,&&_z80_step_694,&&_z80_step_695,
+        &&_z80_step_696,&&_z80_step_697,&&_z80_step_698,&&_z80_step_699,&&_z80_step_700,&&_z80_step_701,&&_z80_step_702,&&_z80_step_703,
+        &&_z80_step_704,&&_z80_step_705,&&_z80_step_706,&&_z80_step_707,&&_z80_step_708,&&_z80_step_709,&&_z80_step_710,&&_z80_step_711,
+        &&_z80_step_712,&&_z80_step_713,&&_z80_step_714,&&_z80_step_715,&&_z80_step_716,&&_z80_step_717,&&_z80_step_718,&&_z80_step_719,
+        &&_z80_step_720,&&_z80_step_721,&&_z80_step_722,&&_z80_step_723,&&_z80_step_724,&&_z80_step_725,&&_z80_step_726,&&_z80_step_727,
+        &&_z80_step_728,&&_z80_step_729,&&_z80_step_730,&&_z80_step_731,&&_z80_step_732,&&_z80_step_733,&&_z80_step_734,&&_z80_step_735,
+        &&_z80_step_736,&&_z80_step_737,&&_z80_step_738,&&_z80_step_739,&&_z80_step_740,&&_z80_step_741,&&_z80_step_742,&&_z80_step_743,
+        &&_z80_step_744,&&_z80_step_745,&&_z80_step_746,&&_z80_step_747,&&_z80_step_748,&&_z80_step_749,&&_z80_step_750,&&_z80_step_751,
+        &&_z80_step_752,&&_z80_step_753,&&_z80_step_754,&&_z80_step_755,&&_z80_step_756,&&_z80_step_757,&&_z80_step_758,&&_z80_step_759,
+        &&_z80_step_760,&&_z80_step_761,&&_z80_step_762,&&_z80_step_763,&&_z80_step_764,&&_z80_step_765,&&_z80_step_766,&&_z80_step_767,
+        &&_z80_step_768,&&_z80_step_769,&&_z80_step_770,&&_z80_step_771,&&_z80_step_772,&&_z80_step_773,&&_z80_step_774,&&_z80_step_775,
+        &&_z80_step_776,&&_z80_step_777,&&_z80_step_778,&&_z80_step_779,&&_z80_step_780,&&_z80_step_781,&&_z80_step_782,&&_z80_step_783,
+        &&_z80_step_784,&&_z80_step_785,&&_z80_step_786,&&_z80_step_787,&&_z80_step_788,&&_z80_step_789,&&_z80_step_790,&&_z80_step_791,
+        &&_z80_step_792,&&_z80_step_793,&&_z80_step_794,&&_z80_step_795,&&_z80_step_796,&&_z80_step_797,&&_z80_step_798,&&_z80_step_799,
+        &&_z80_step_800,&&_z80_step_801,&&_z80_step_802,&&_z80_step_803,&&_z80_step_804,&&_z80_step_805,&&_z80_step_806,&&_z80_step_807,
+        &&_z80_step_808,&&_z80_step_809,&&_z80_step_810,&&_z80_step_811,&&_z80_step_812,&&_z80_step_813,&&_z80_step_814,&&_z80_step_815,
+        &&_z80_step_816,&&_z80_step_817,&&_z80_step_818,&&_z80_step_819,&&_z80_step_820,&&_z80_step_821,&&_z80_step_822,&&_z80_step_823,
+        &&_z80_step_824,&&_z80_step_825,&&_z80_step_826,&&_z80_step_827,&&_z80_step_828,&&_z80_step_829,&&_z80_step_830,&&_z80_step_831,
+        &&_z80_step_832,&&_z80_step_833,&&_z80_step_834,&&_z80_step_835,&&_z80_step_836,&&_z80_step_837,&&_z80_step_838,&&_z80_step_839,
+        &&_z80_step_840,&&_z80_step_841,&&_z80_step_842,&&_z80_step_843,&&_z80_step_844,&&_z80_step_845,&&_z80_step_846,&&_z80_step_847,
+        &&_z80_step_848,&&_z80_step_849,&&_z80_step_850,&&_z80_step_851,&&_z80_step_852,&&_z80_step_853,&&_z80_step_854,&&_z80_step_855,
+        &&_z80_step_856,&&_z80_step_857,&&_z80_step_858,&&_z80_step_859,&&_z80_step_860,&&_z80_step_861,&&_z80_step_862,&&_z80_step_863,
+        &&_z80_step_864,&&_z80_step_865,&&_z80_step_866,&&_z80_step_867,&&_z80_step_868,&&_z80_step_869,&&_z80_step_870,&&_z80_step_871,
+        &&_z80_step_872,&&_z80_step_873,&&_z80_step_874,&&_z80_step_875,&&_z80_step_876,&&_z80_step_877,&&_z80_step_878,&&_z80_step_879,
+        &&_z80_step_880,&&_z80_step_881,&&_z80_step_882,&&_z80_step_883,&&_z80_step_884,&&_z80_step_885,&&_z80_step_886,&&_z80_step_887,
+        &&_z80_step_888,&&_z80_step_889,&&_z80_step_890,&&_z80_step_891,&&_z80_step_892,&&_z80_step_893,&&_z80_step_894,&&_z80_step_895,
+        &&_z80_step_896,&&_z80_step_897,&&_z80_step_898,&&_z80_step_899,&&_z80_step_900,&&_z80_step_901,&&_z80_step_902,&&_z80_step_903,
+        &&_z80_step_904,&&_z80_step_905,&&_z80_step_906,&&_z80_step_907,&&_z80_step_908,&&_z80_step_909,&&_z80_step_910,&&_z80_step_911,
+        &&_z80_step_912,&&_z80_step_913,&&_z80_step_914,&&_z80_step_915,&&_z80_step_916,&&_z80_step_917,&&_z80_step_918,&&_z80_step_919,
+        &&_z80_step_920,&&_z80_step_921,&&_z80_step_922,&&_z80_step_923,&&_z80_step_924,&&_z80_step_925,&&_z80_step_926,&&_z80_step_927,
+        &&_z80_step_928,&&_z80_step_929,&&_z80_step_930,&&_z80_step_931,&&_z80_step_932,&&_z80_step_933,&&_z80_step_934,&&_z80_step_935,
+        &&_z80_step_936,&&_z80_step_937,&&_z80_step_938,&&_z80_step_939,&&_z80_step_940,&&_z80_step_941,&&_z80_step_942,&&_z80_step_943,
+        &&_z80_step_944,&&_z80_step_945,&&_z80_step_946,&&_z80_step_947,&&_z80_step_948,&&_z80_step_949,&&_z80_step_950,&&_z80_step_951,
+        &&_z80_step_952,&&_z80_step_953,&&_z80_step_954,&&_z80_step_955,&&_z80_step_956,&&_z80_step_957,&&_z80_step_958,&&_z80_step_959,
+        &&_z80_step_960,&&_z80_step_961,&&_z80_step_962,&&_z80_step_963,&&_z80_step_964,&&_z80_step_965,&&_z80_step_966,&&_z80_step_967,
+        &&_z80_step_968,&&_z80_step_969,&&_z80_step_970,&&_z80_step_971,&&_z80_step_972,&&_z80_step_973,&&_z80_step_974,&&_z80_step_975,
+        &&_z80_step_976,&&_z80_step_977,&&_z80_step_978,&&_z80_step_979,&&_z80_step_980,&&_z80_step_981,&&_z80_step_982,&&_z80_step_983,
+        &&_z80_step_984,&&_z80_step_985,&&_z80_step_986,&&_z80_step_987,&&_z80_step_988,&&_z80_step_989,&&_z80_step_990,&&_z80_step_991,
+        &&_z80_step_992,&&_z80_step_993,&&_z80_step_994,&&_z80_step_995,&&_z80_step_996,&&_z80_step_997,&&_z80_step_998,&&_z80_step_999,
+        &&_z80_step_1000,&&_z80_step_1001,&&_z80_step_1002,&&_z80_step_1003,&&_z80_step_1004,&&_z80_step_1005,&&_z80_step_1006,&&_z80_step_1007,
+        &&_z80_step_1008,&&_z80_step_1009,&&_z80_step_1010,&&_z80_step_1011,&&_z80_step_1012,&&_z80_step_1013,&&_z80_step_1014,&&_z80_step_1015,
+        &&_z80_step_1016,&&_z80_step_1017,&&_z80_step_1018,&&_z80_step_1019,&&_z80_step_1020,&&_z80_step_1021,&&_z80_step_1022,&&_z80_step_1023,
+        &&_z80_step_1024,&&_z80_step_1025,&&_z80_step_1026,&&_z80_step_1027,&&_z80_step_1028,&&_z80_step_1029,&&_z80_step_1030,&&_z80_step_1031,
+        &&_z80_step_1032,&&_z80_step_1033,&&_z80_step_1034,&&_z80_step_1035,&&_z80_step_1036,&&_z80_step_1037,&&_z80_step_1038,&&_z80_step_1039,
+        &&_z80_step_1040,&&_z80_step_1041,&&_z80_step_1042,&&_z80_step_1043,&&_z80_step_1044,&&_z80_step_1045,&&_z80_step_1046,&&_z80_step_1047,
+        &&_z80_step_1048,&&_z80_step_1049,&&_z80_step_1050,&&_z80_step_1051,&&_z80_step_1052,&&_z80_step_1053,&&_z80_step_1054,&&_z80_step_1055,
+        &&_z80_step_1056,&&_z80_step_1057,&&_z80_step_1058,&&_z80_step_1059,&&_z80_step_1060,&&_z80_step_1061,&&_z80_step_1062,&&_z80_step_1063,
+        &&_z80_step_1064,&&_z80_step_1065,&&_z80_step_1066,&&_z80_step_1067,&&_z80_step_1068,&&_z80_step_1069,&&_z80_step_1070,&&_z80_step_1071,
+        &&_z80_step_1072,&&_z80_step_1073,&&_z80_step_1074,&&_z80_step_1075,&&_z80_step_1076,&&_z80_step_1077,&&_z80_step_1078,&&_z80_step_1079,
+        &&_z80_step_1080,&&_z80_step_1081,&&_z80_step_1082,&&_z80_step_1083,&&_z80_step_1084,&&_z80_step_1085,&&_z80_step_1086,&&_z80_step_1087,
+        &&_z80_step_1088,&&_z80_step_1089,&&_z80_step_1090,&&_z80_step_1091,&&_z80_step_1092,&&_z80_step_1093,&&_z80_step_1094,&&_z80_step_1095,
+        &&_z80_step_1096,&&_z80_step_1097,&&_z80_step_1098,&&_z80_step_1099,&&_z80_step_1100,&&_z80_step_1101,&&_z80_step_1102,&&_z80_step_1103,
+        &&_z80_step_1104,&&_z80_step_1105,&&_z80_step_1106,&&_z80_step_1107,&&_z80_step_1108,&&_z80_step_1109,&&_z80_step_1110,&&_z80_step_1111,
+        &&_z80_step_1112,&&_z80_step_1113,&&_z80_step_1114,&&_z80_step_1115,&&_z80_step_1116,&&_z80_step_1117,&&_z80_step_1118,&&_z80_step_1119,
+        &&_z80_step_1120,&&_z80_step_1121,&&_z80_step_1122,&&_z80_step_1123,&&_z80_step_1124,&&_z80_step_1125,&&_z80_step_1126,&&_z80_step_1127,
+        &&_z80_step_1128,&&_z80_step_1129,&&_z80_step_1130,&&_z80_step_1131,&&_z80_step_1132,&&_z80_step_1133,&&_z80_step_1134,&&_z80_step_1135,
+        &&_z80_step_1136,&&_z80_step_1137,&&_z80_step_1138,&&_z80_step_1139,&&_z80_step_1140,&&_z80_step_1141,&&_z80_step_1142,&&_z80_step_1143,
+        &&_z80_step_1144,&&_z80_step_1145,&&_z80_step_1146,&&_z80_step_1147,&&_z80_step_1148,&&_z80_step_1149,&&_z80_step_1150,&&_z80_step_1151,
+        &&_z80_step_1152,&&_z80_step_1153,&&_z80_step_1154,&&_z80_step_1155,&&_z80_step_1156,&&_z80_step_1157,&&_z80_step_1158,&&_z80_step_1159,
+        &&_z80_step_1160,&&_z80_step_1161,&&_z80_step_1162,&&_z80_step_1163,&&_z80_step_1164,&&_z80_step_1165,&&_z80_step_1166,&&_z80_step_1167,
+        &&_z80_step_1168,&&_z80_step_1169,&&_z80_step_1170,&&_z80_step_1171,&&_z80_step_1172,&&_z80_step_1173,&&_z80_step_1174,&&_z80_step_1175,
+        &&_z80_step_1176,&&_z80_step_1177,&&_z80_step_1178,&&_z80_step_1179,&&_z80_step_1180,&&_z80_step_1181,&&_z80_step_1182,&&_z80_step_1183,
+        &&_z80_step_1184,&&_z80_step_1185,&&_z80_step_1186,&&_z80_step_1187,&&_z80_step_1188,&&_z80_step_1189,&&_z80_step_1190,&&_z80_step_1191,
+        &&_z80_step_1192,&&_z80_step_1193,&&_z80_step_1194,&&_z80_step_1195,&&_z80_step_1196,&&_z80_step_1197,&&_z80_step_1198,&&_z80_step_1199,
+        &&_z80_step_1200,&&_z80_step_1201,&&_z80_step_1202,&&_z80_step_1203,&&_z80_step_1204,&&_z80_step_1205,&&_z80_step_1206,&&_z80_step_1207,
+        &&_z80_step_1208,&&_z80_step_1209,&&_z80_step_1210,&&_z80_step_1211,&&_z80_step_1212,&&_z80_step_1213,&&_z80_step_1214,&&_z80_step_1215,
+        &&_z80_step_1216,&&_z80_step_1217,&&_z80_step_1218,&&_z80_step_1219,&&_z80_step_1220,&&_z80_step_1221,&&_z80_step_1222,&&_z80_step_1223,
+        &&_z80_step_1224,&&_z80_step_1225,&&_z80_step_1226,&&_z80_step_1227,&&_z80_step_1228,&&_z80_step_1229,&&_z80_step_1230,&&_z80_step_1231,
+        &&_z80_step_1232,&&_z80_step_1233,&&_z80_step_1234,&&_z80_step_1235,&&_z80_step_1236,&&_z80_step_1237,&&_z80_step_1238,&&_z80_step_1239,
+        &&_z80_step_1240,&&_z80_step_1241,&&_z80_step_1242,&&_z80_step_1243,&&_z80_step_1244,&&_z80_step_1245,&&_z80_step_1246,&&_z80_step_1247,
+        &&_z80_step_1248,&&_z80_step_1249,&&_z80_step_1250,&&_z80_step_1251,&&_z80_step_1252,&&_z80_step_1253,&&_z80_step_1254,&&_z80_step_1255,
+        &&_z80_step_1256,&&_z80_step_1257,&&_z80_step_1258,&&_z80_step_1259,&&_z80_step_1260,&&_z80_step_1261,&&_z80_step_1262,&&_z80_step_1263,
+        &&_z80_step_1264,&&_z80_step_1265,&&_z80_step_1266,&&_z80_step_1267,&&_z80_step_1268,&&_z80_step_1269,&&_z80_step_1270,&&_z80_step_1271,
+        &&_z80_step_1272,&&_z80_step_1273,&&_z80_step_1274,&&_z80_step_1275,&&_z80_step_1276,&&_z80_step_1277,&&_z80_step_1278,&&_z80_step_1279,
+        &&_z80_step_1280,&&_z80_step_1281,&&_z80_step_1282,&&_z80_step_1283,&&_z80_step_1284,&&_z80_step_1285,&&_z80_step_1286,&&_z80_step_1287,
+        &&_z80_step_1288,&&_z80_step_1289,&&_z80_step_1290,&&_z80_step_1291,&&_z80_step_1292,&&_z80_step_1293,&&_z80_step_1294,&&_z80_step_1295,
+        &&_z80_step_1296,&&_z80_step_1297,&&_z80_step_1298,&&_z80_step_1299,&&_z80_step_1300,&&_z80_step_1301,&&_z80_step_1302,&&_z80_step_1303,
+        &&_z80_step_1304,&&_z80_step_1305,&&_z80_step_1306,&&_z80_step_1307,&&_z80_step_1308,&&_z80_step_1309,&&_z80_step_1310,&&_z80_step_1311,
+        &&_z80_step_1312,&&_z80_step_1313,&&_z80_step_1314,&&_z80_step_1315,&&_z80_step_1316,&&_z80_step_1317,&&_z80_step_1318,&&_z80_step_1319,
+        &&_z80_step_1320,&&_z80_step_1321,&&_z80_step_1322,&&_z80_step_1323,&&_z80_step_1324,&&_z80_step_1325,&&_z80_step_1326,&&_z80_step_1327,
+        &&_z80_step_1328,&&_z80_step_1329,&&_z80_step_1330,&&_z80_step_1331,&&_z80_step_1332,&&_z80_step_1333,&&_z80_step_1334,&&_z80_step_1335,
+        &&_z80_step_1336,&&_z80_step_1337,&&_z80_step_1338,&&_z80_step_1339,&&_z80_step_1340,&&_z80_step_1341,&&_z80_step_1342,&&_z80_step_1343,
+        &&_z80_step_1344,&&_z80_step_1345,&&_z80_step_1346,&&_z80_step_1347,&&_z80_step_1348,&&_z80_step_1349,&&_z80_step_1350,&&_z80_step_1351,
+        &&_z80_step_1352,&&_z80_step_1353,&&_z80_step_1354,&&_z80_step_1355,&&_z80_step_1356,&&_z80_step_1357,&&_z80_step_1358,&&_z80_step_1359,
+        &&_z80_step_1360,&&_z80_step_1361,&&_z80_step_1362,&&_z80_step_1363,&&_z80_step_1364,&&_z80_step_1365,&&_z80_step_1366,&&_z80_step_1367,
+        &&_z80_step_1368,&&_z80_step_1369,&&_z80_step_1370,&&_z80_step_1371,&&_z80_step_1372,&&_z80_step_1373,&&_z80_step_1374,&&_z80_step_1375,
+        &&_z80_step_1376,&&_z80_step_1377,&&_z80_step_1378,&&_z80_step_1379,&&_z80_step_1380,&&_z80_step_1381,&&_z80_step_1382,&&_z80_step_1383,
+        &&_z80_step_1384,&&_z80_step_1385,&&_z80_step_1386,&&_z80_step_1387,&&_z80_step_1388,&&_z80_step_1389,&&_z80_step_1390,&&_z80_step_1391,
+        &&_z80_step_1392,&&_z80_step_1393,&&_z80_step_1394,&&_z80_step_1395,&&_z80_step_1396,&&_z80_step_1397,&&_z80_step_1398,&&_z80_step_1399,
+        &&_z80_step_1400,&&_z80_step_1401,&&_z80_step_1402,&&_z80_step_1403,&&_z80_step_1404,&&_z80_step_1405,&&_z80_step_1406,&&_z80_step_1407,
+        &&_z80_step_1408,&&_z80_step_1409,&&_z80_step_1410,&&_z80_step_1411,&&_z80_step_1412,&&_z80_step_1413,&&_z80_step_1414,&&_z80_step_1415,
+        &&_z80_step_1416,&&_z80_step_1417,&&_z80_step_1418,&&_z80_step_1419,&&_z80_step_1420,&&_z80_step_1421,&&_z80_step_1422,&&_z80_step_1423,
+        &&_z80_step_1424,&&_z80_step_1425,&&_z80_step_1426,&&_z80_step_1427,&&_z80_step_1428,&&_z80_step_1429,&&_z80_step_1430,&&_z80_step_1431,
+        &&_z80_step_1432,&&_z80_step_1433,&&_z80_step_1434,&&_z80_step_1435,&&_z80_step_1436,&&_z80_step_1437,&&_z80_step_1438,&&_z80_step_1439,
+        &&_z80_step_1440,&&_z80_step_1441,&&_z80_step_1442,&&_z80_step_1443,&&_z80_step_1444,&&_z80_step_1445,&&_z80_step_1446,&&_z80_step_1447,
+        &&_z80_step_1448,&&_z80_step_1449,&&_z80_step_1450,&&_z80_step_1451,&&_z80_step_1452,&&_z80_step_1453,&&_z80_step_1454,&&_z80_step_1455,
+        &&_z80_step_1456,&&_z80_step_1457,&&_z80_step_1458,&&_z80_step_1459,&&_z80_step_1460,&&_z80_step_1461,&&_z80_step_1462,&&_z80_step_1463,
+        &&_z80_step_1464,&&_z80_step_1465,&&_z80_step_1466,&&_z80_step_1467,&&_z80_step_1468,&&_z80_step_1469,&&_z80_step_1470,&&_z80_step_1471,
+        &&_z80_step_1472,&&_z80_step_1473,&&_z80_step_1474,&&_z80_step_1475,&&_z80_step_1476,&&_z80_step_1477,&&_z80_step_1478,&&_z80_step_1479,
+        &&_z80_step_1480,&&_z80_step_1481,&&_z80_step_1482,&&_z80_step_1483,&&_z80_step_1484,&&_z80_step_1485,&&_z80_step_1486,&&_z80_step_1487,
+        &&_z80_step_1488,&&_z80_step_1489,&&_z80_step_1490,&&_z80_step_1491,&&_z80_step_1492,&&_z80_step_1493,&&_z80_step_1494,&&_z80_step_1495,
+        &&_z80_step_1496,&&_z80_step_1497,&&_z80_step_1498,&&_z80_step_1499,&&_z80_step_1500,&&_z80_step_1501,&&_z80_step_1502,&&_z80_step_1503,
+        &&_z80_step_1504,&&_z80_step_1505,&&_z80_step_1506,&&_z80_step_1507,&&_z80_step_1508,&&_z80_step_1509,&&_z80_step_1510,&&_z80_step_1511,
+        &&_z80_step_1512,&&_z80_step_1513,&&_z80_step_1514,&&_z80_step_1515,&&_z80_step_1516,&&_z80_step_1517,&&_z80_step_1518,&&_z80_step_1519,
+        &&_z80_step_1520,&&_z80_step_1521,&&_z80_step_1522,&&_z80_step_1523,&&_z80_step_1524,&&_z80_step_1525,&&_z80_step_1526,&&_z80_step_1527,
+        &&_z80_step_1528,&&_z80_step_1529,&&_z80_step_1530,&&_z80_step_1531,&&_z80_step_1532,&&_z80_step_1533,&&_z80_step_1534,&&_z80_step_1535,
+        &&_z80_step_1536,&&_z80_step_1537,&&_z80_step_1538,&&_z80_step_1539,&&_z80_step_1540,&&_z80_step_1541,&&_z80_step_1542,&&_z80_step_1543,
+        &&_z80_step_1544,&&_z80_step_1545,&&_z80_step_1546,&&_z80_step_1547,&&_z80_step_1548,&&_z80_step_1549,&&_z80_step_1550,&&_z80_step_1551,
+        &&_z80_step_1552,&&_z80_step_1553,&&_z80_step_1554,&&_z80_step_1555,&&_z80_step_1556,&&_z80_step_1557,&&_z80_step_1558,&&_z80_step_1559,
+        &&_z80_step_1560,&&_z80_step_1561,&&_z80_step_1562,&&_z80_step_1563,&&_z80_step_1564,&&_z80_step_1565,&&_z80_step_1566,&&_z80_step_1567,
+        &&_z80_step_1568,&&_z80_step_1569,&&_z80_step_1570,&&_z80_step_1571,&&_z80_step_1572,&&_z80_step_1573,&&_z80_step_1574,&&_z80_step_1575,
+        &&_z80_step_1576,&&_z80_step_1577,&&_z80_step_1578,&&_z80_step_1579,&&_z80_step_1580,&&_z80_step_1581,&&_z80_step_1582,&&_z80_step_1583,
+        &&_z80_step_1584,&&_z80_step_1585,&&_z80_step_1586,&&_z80_step_1587,&&_z80_step_1588,&&_z80_step_1589,&&_z80_step_1590,&&_z80_step_1591,
+        &&_z80_step_1592,&&_z80_step_1593,&&_z80_step_1594,&&_z80_step_1595,&&_z80_step_1596,&&_z80_step_1597,&&_z80_step_1598,&&_z80_step_1599,
+        &&_z80_step_1600,&&_z80_step_1601,&&_z80_step_1602,&&_z80_step_1603,&&_z80_step_1604,&&_z80_step_1605,&&_z80_step_1606,&&_z80_step_1607,
+        &&_z80_step_1608,&&_z80_step_1609,&&_z80_step_1610,&&_z80_step_1611,&&_z80_step_1612,&&_z80_step_1613,&&_z80_step_1614,&&_z80_step_1615,
+        &&_z80_step_1616,&&_z80_step_1617,&&_z80_step_1618,&&_z80_step_1619,&&_z80_step_1620,&&_z80_step_1621,&&_z80_step_1622,&&_z80_step_1623,
+        &&_z80_step_1624,&&_z80_step_1625,&&_z80_step_1626,&&_z80_step_1627,&&_z80_step_1628,&&_z80_step_1629,&&_z80_step_1630,&&_z80_step_1631,
+        &&_z80_step_1632,&&_z80_step_1633,&&_z80_step_1634,&&_z80_step_1635,&&_z80_step_1636,&&_z80_step_1637,&&_z80_step_1638,&&_z80_step_1639,
+        &&_z80_step_1640,&&_z80_step_1641,&&_z80_step_1642,&&_z80_step_1643,&&_z80_step_1644,&&_z80_step_1645,&&_z80_step_1646,&&_z80_step_1647,
+        &&_z80_step_1648,&&_z80_step_1649,&&_z80_step_1650,&&_z80_step_1651,&&_z80_step_1652,&&_z80_step_1653,&&_z80_step_1654,&&_z80_step_1655,
+        &&_z80_step_1656,&&_z80_step_1657,&&_z80_step_1658,&&_z80_step_1659,&&_z80_step_1660,&&_z80_step_1661,&&_z80_step_1662,&&_z80_step_1663,
+        &&_z80_step_1664,&&_z80_step_1665,&&_z80_step_1666,&&_z80_step_1667,&&_z80_step_1668,&&_z80_step_1669,&&_z80_step_1670,&&_z80_step_1671,
+        &&_z80_step_1672,&&_z80_step_1673,&&_z80_step_1674,&&_z80_step_1675,&&_z80_step_1676,&&_z80_step_1677,&&_z80_step_1678,&&_z80_step_1679,
+        &&_z80_step_1680,&&_z80_step_1681,&&_z80_step_1682,&&_z80_step_1683,&&_z80_step_1684,&&_z80_step_1685,&&_z80_step_1686,&&_z80_step_1687,
+        &&_z80_step_1688,&&_z80_step_1689,&&_z80_step_1690,&&_z80_step_1691,&&_z80_step_1692,&&_z80_step_1693,&&_z80_step_1694,&&_z80_step_1695,
+        &&_z80_step_1696,&&_z80_step_1697,&&_z80_step_1698,&&_z80_step_1699,&&_z80_step_1700,&&_z80_step_1701,&&_z80_step_1702,&&_z80_step_1703,
+        &&_z80_step_1704,&&_z80_step_1705,&&_z80_step_1706,&&_z80_step_1707,&&_z80_step_1708,
+        // %>
+    };
+    goto *_z80_step_table[cpu->step];
+    #endif
     switch (cpu->step) {
         // <% decoder
-        case    0: _fetch(); // NOP (0)
-        case    1: _goto(512); // LD BC,nn (0)
-        case    2: _goto(518); // LD (BC),A (0)
-        case    3: cpu->bc++;_goto(521); // INC BC (0)
-        case    4: cpu->b=_z80_inc8(cpu,cpu->b);_fetch(); // INC B (0)
-        case    5: cpu->b=_z80_dec8(cpu,cpu->b);_fetch(); // DEC B (0)
-        case    6: _goto(523); // LD B,n (0)
-        case    7: _z80_rlca(cpu);_fetch(); // RLCA (0)
-        case    8: _z80_ex_af_af2(cpu);_fetch(); // EX AF,AF' (0)
-        case    9: _z80_add16(cpu,cpu->bc);_goto(526); // ADD HL,BC (0)
-        case   10: _goto(533); // LD A,(BC) (0)
-        case   11: cpu->bc--;_goto(536); // DEC BC (0)
-        case   12: cpu->c=_z80_inc8(cpu,cpu->c);_fetch(); // INC C (0)
-        case   13: cpu->c=_z80_dec8(cpu,cpu->c);_fetch(); // DEC C (0)
-        case   14: _goto(538); // LD C,n (0)
-        case   15: _z80_rrca(cpu);_fetch(); // RRCA (0)
-        case   16: _goto(541); // DJNZ d (0)
-        case   17: _goto(550); // LD DE,nn (0)
-        case   18: _goto(556); // LD (DE),A (0)
-        case   19: cpu->de++;_goto(559); // INC DE (0)
-        case   20: cpu->d=_z80_inc8(cpu,cpu->d);_fetch(); // INC D (0)
-        case   21: cpu->d=_z80_dec8(cpu,cpu->d);_fetch(); // DEC D (0)
-        case   22: _goto(561); // LD D,n (0)
-        case   23: _z80_rla(cpu);_fetch(); // RLA (0)
-        case   24: _goto(564); // JR d (0)
-        case   25: _z80_add16(cpu,cpu->de);_goto(572); // ADD HL,DE (0)
-        case   26: _goto(579); // LD A,(DE) (0)
-        case   27: cpu->de--;_goto(582); // DEC DE (0)
-        case   28: cpu->e=_z80_inc8(cpu,cpu->e);_fetch(); // INC E (0)
-        case   29: cpu->e=_z80_dec8(cpu,cpu->e);_fetch(); // DEC E (0)
-        case   30: _goto(584); // LD E,n (0)
-        case   31: _z80_rra(cpu);_fetch(); // RRA (0)
-        case   32: _goto(587); // JR NZ,d (0)
-        case   33: _goto(595); // LD HL,nn (0)
-        case   34: _goto(601); // LD (nn),HL (0)
-        case   35: cpu->hlx[cpu->hlx_idx].hl++;_goto(613); // INC HL (0)
-        case   36: cpu->hlx[cpu->hlx_idx].h=_z80_inc8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // INC H (0)
-        case   37: cpu->hlx[cpu->hlx_idx].h=_z80_dec8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // DEC H (0)
-        case   38: _goto(615); // LD H,n (0)
-        case   39: _z80_daa(cpu);_fetch(); // DAA (0)
-        case   40: _goto(618); // JR Z,d (0)
-        case   41: _z80_add16(cpu,cpu->hlx[cpu->hlx_idx].hl);_goto(626); // ADD HL,HL (0)
-        case   42: _goto(633); // LD HL,(nn) (0)
-        case   43: cpu->hlx[cpu->hlx_idx].hl--;_goto(645); // DEC HL (0)
-        case   44: cpu->hlx[cpu->hlx_idx].l=_z80_inc8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // INC L (0)
-        case   45: cpu->hlx[cpu->hlx_idx].l=_z80_dec8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // DEC L (0)
-        case   46: _goto(647); // LD L,n (0)
-        case   47: _z80_cpl(cpu);_fetch(); // CPL (0)
-        case   48: _goto(650); // JR NC,d (0)
-        case   49: _goto(658); // LD SP,nn (0)
-        case   50: _goto(664); // LD (nn),A (0)
-        case   51: cpu->sp++;_goto(673); // INC SP (0)
-        case   52: _goto(675); // INC (HL) (0)
-        case   53: _goto(682); // DEC (HL) (0)
-        case   54: _goto(689); // LD (HL),n (0)
-        case   55: _z80_scf(cpu);_fetch(); // SCF (0)
-        case   56: _goto(695); // JR C,d (0)
-        case   57: _z80_add16(cpu,cpu->sp);_goto(703); // ADD HL,SP (0)
-        case   58: _goto(710); // LD A,(nn) (0)
-        case   59: cpu->sp--;_goto(719); // DEC SP (0)
-        case   60: cpu->a=_z80_inc8(cpu,cpu->a);_fetch(); // INC A (0)
-        case   61: cpu->a=_z80_dec8(cpu,cpu->a);_fetch(); // DEC A (0)
-        case   62: _goto(721); // LD A,n (0)
-        case   63: _z80_ccf(cpu);_fetch(); // CCF (0)
-        case   64: cpu->b=cpu->b;_fetch(); // LD B,B (0)
-        case   65: cpu->b=cpu->c;_fetch(); // LD B,C (0)
-        case   66: cpu->b=cpu->d;_fetch(); // LD B,D (0)
-        case   67: cpu->b=cpu->e;_fetch(); // LD B,E (0)
-        case   68: cpu->b=cpu->hlx[cpu->hlx_idx].h;_fetch(); // LD B,H (0)
-        case   69: cpu->b=cpu->hlx[cpu->hlx_idx].l;_fetch(); // LD B,L (0)
-        case   70: _goto(724); // LD B,(HL) (0)
-        case   71: cpu->b=cpu->a;_fetch(); // LD B,A (0)
-        case   72: cpu->c=cpu->b;_fetch(); // LD C,B (0)
-        case   73: cpu->c=cpu->c;_fetch(); // LD C,C (0)
-        case   74: cpu->c=cpu->d;_fetch(); // LD C,D (0)
-        case   75: cpu->c=cpu->e;_fetch(); // LD C,E (0)
-        case   76: cpu->c=cpu->hlx[cpu->hlx_idx].h;_fetch(); // LD C,H (0)
-        case   77: cpu->c=cpu->hlx[cpu->hlx_idx].l;_fetch(); // LD C,L (0)
-        case   78: _goto(727); // LD C,(HL) (0)
-        case   79: cpu->c=cpu->a;_fetch(); // LD C,A (0)
-        case   80: cpu->d=cpu->b;_fetch(); // LD D,B (0)
-        case   81: cpu->d=cpu->c;_fetch(); // LD D,C (0)
-        case   82: cpu->d=cpu->d;_fetch(); // LD D,D (0)
-        case   83: cpu->d=cpu->e;_fetch(); // LD D,E (0)
-        case   84: cpu->d=cpu->hlx[cpu->hlx_idx].h;_fetch(); // LD D,H (0)
-        case   85: cpu->d=cpu->hlx[cpu->hlx_idx].l;_fetch(); // LD D,L (0)
-        case   86: _goto(730); // LD D,(HL) (0)
-        case   87: cpu->d=cpu->a;_fetch(); // LD D,A (0)
-        case   88: cpu->e=cpu->b;_fetch(); // LD E,B (0)
-        case   89: cpu->e=cpu->c;_fetch(); // LD E,C (0)
-        case   90: cpu->e=cpu->d;_fetch(); // LD E,D (0)
-        case   91: cpu->e=cpu->e;_fetch(); // LD E,E (0)
-        case   92: cpu->e=cpu->hlx[cpu->hlx_idx].h;_fetch(); // LD E,H (0)
-        case   93: cpu->e=cpu->hlx[cpu->hlx_idx].l;_fetch(); // LD E,L (0)
-        case   94: _goto(733); // LD E,(HL) (0)
-        case   95: cpu->e=cpu->a;_fetch(); // LD E,A (0)
-        case   96: cpu->hlx[cpu->hlx_idx].h=cpu->b;_fetch(); // LD H,B (0)
-        case   97: cpu->hlx[cpu->hlx_idx].h=cpu->c;_fetch(); // LD H,C (0)
-        case   98: cpu->hlx[cpu->hlx_idx].h=cpu->d;_fetch(); // LD H,D (0)
-        case   99: cpu->hlx[cpu->hlx_idx].h=cpu->e;_fetch(); // LD H,E (0)
-        case  100: cpu->hlx[cpu->hlx_idx].h=cpu->hlx[cpu->hlx_idx].h;_fetch(); // LD H,H (0)
-        case  101: cpu->hlx[cpu->hlx_idx].h=cpu->hlx[cpu->hlx_idx].l;_fetch(); // LD H,L (0)
-        case  102: _goto(736); // LD H,(HL) (0)
-        case  103: cpu->hlx[cpu->hlx_idx].h=cpu->a;_fetch(); // LD H,A (0)
-        case  104: cpu->hlx[cpu->hlx_idx].l=cpu->b;_fetch(); // LD L,B (0)
-        case  105: cpu->hlx[cpu->hlx_idx].l=cpu->c;_fetch(); // LD L,C (0)
-        case  106: cpu->hlx[cpu->hlx_idx].l=cpu->d;_fetch(); // LD L,D (0)
-        case  107: cpu->hlx[cpu->hlx_idx].l=cpu->e;_fetch(); // LD L,E (0)
-        case  108: cpu->hlx[cpu->hlx_idx].l=cpu->hlx[cpu->hlx_idx].h;_fetch(); // LD L,H (0)
-        case  109: cpu->hlx[cpu->hlx_idx].l=cpu->hlx[cpu->hlx_idx].l;_fetch(); // LD L,L (0)
-        case  110: _goto(739); // LD L,(HL) (0)
-        case  111: cpu->hlx[cpu->hlx_idx].l=cpu->a;_fetch(); // LD L,A (0)
-        case  112: _goto(742); // LD (HL),B (0)
-        case  113: _goto(745); // LD (HL),C (0)
-        case  114: _goto(748); // LD (HL),D (0)
-        case  115: _goto(751); // LD (HL),E (0)
-        case  116: _goto(754); // LD (HL),H (0)
-        case  117: _goto(757); // LD (HL),L (0)
-        case  118: pins=_z80_halt(cpu,pins);_fetch(); // HALT (0)
-        case  119: _goto(760); // LD (HL),A (0)
-        case  120: cpu->a=cpu->b;_fetch(); // LD A,B (0)
-        case  121: cpu->a=cpu->c;_fetch(); // LD A,C (0)
-        case  122: cpu->a=cpu->d;_fetch(); // LD A,D (0)
-        case  123: cpu->a=cpu->e;_fetch(); // LD A,E (0)
-        case  124: cpu->a=cpu->hlx[cpu->hlx_idx].h;_fetch(); // LD A,H (0)
-        case  125: cpu->a=cpu->hlx[cpu->hlx_idx].l;_fetch(); // LD A,L (0)
-        case  126: _goto(763); // LD A,(HL) (0)
-        case  127: cpu->a=cpu->a;_fetch(); // LD A,A (0)
-        case  128: _z80_add8(cpu,cpu->b);_fetch(); // ADD B (0)
-        case  129: _z80_add8(cpu,cpu->c);_fetch(); // ADD C (0)
-        case  130: _z80_add8(cpu,cpu->d);_fetch(); // ADD D (0)
-        case  131: _z80_add8(cpu,cpu->e);_fetch(); // ADD E (0)
-        case  132: _z80_add8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // ADD H (0)
-        case  133: _z80_add8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // ADD L (0)
-        case  134: _goto(766); // ADD (HL) (0)
-        case  135: _z80_add8(cpu,cpu->a);_fetch(); // ADD A (0)
-        case  136: _z80_adc8(cpu,cpu->b);_fetch(); // ADC B (0)
-        case  137: _z80_adc8(cpu,cpu->c);_fetch(); // ADC C (0)
-        case  138: _z80_adc8(cpu,cpu->d);_fetch(); // ADC D (0)
-        case  139: _z80_adc8(cpu,cpu->e);_fetch(); // ADC E (0)
-        case  140: _z80_adc8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // ADC H (0)
-        case  141: _z80_adc8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // ADC L (0)
-        case  142: _goto(769); // ADC (HL) (0)
-        case  143: _z80_adc8(cpu,cpu->a);_fetch(); // ADC A (0)
-        case  144: _z80_sub8(cpu,cpu->b);_fetch(); // SUB B (0)
-        case  145: _z80_sub8(cpu,cpu->c);_fetch(); // SUB C (0)
-        case  146: _z80_sub8(cpu,cpu->d);_fetch(); // SUB D (0)
-        case  147: _z80_sub8(cpu,cpu->e);_fetch(); // SUB E (0)
-        case  148: _z80_sub8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // SUB H (0)
-        case  149: _z80_sub8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // SUB L (0)
-        case  150: _goto(772); // SUB (HL) (0)
-        case  151: _z80_sub8(cpu,cpu->a);_fetch(); // SUB A (0)
-        case  152: _z80_sbc8(cpu,cpu->b);_fetch(); // SBC B (0)
-        case  153: _z80_sbc8(cpu,cpu->c);_fetch(); // SBC C (0)
-        case  154: _z80_sbc8(cpu,cpu->d);_fetch(); // SBC D (0)
-        case  155: _z80_sbc8(cpu,cpu->e);_fetch(); // SBC E (0)
-        case  156: _z80_sbc8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // SBC H (0)
-        case  157: _z80_sbc8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // SBC L (0)
-        case  158: _goto(775); // SBC (HL) (0)
-        case  159: _z80_sbc8(cpu,cpu->a);_fetch(); // SBC A (0)
-        case  160: _z80_and8(cpu,cpu->b);_fetch(); // AND B (0)
-        case  161: _z80_and8(cpu,cpu->c);_fetch(); // AND C (0)
-        case  162: _z80_and8(cpu,cpu->d);_fetch(); // AND D (0)
-        case  163: _z80_and8(cpu,cpu->e);_fetch(); // AND E (0)
-        case  164: _z80_and8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // AND H (0)
-        case  165: _z80_and8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // AND L (0)
-        case  166: _goto(778); // AND (HL) (0)
-        case  167: _z80_and8(cpu,cpu->a);_fetch(); // AND A (0)
-        case  168: _z80_xor8(cpu,cpu->b);_fetch(); // XOR B (0)
-        case  169: _z80_xor8(cpu,cpu->c);_fetch(); // XOR C (0)
-        case  170: _z80_xor8(cpu,cpu->d);_fetch(); // XOR D (0)
-        case  171: _z80_xor8(cpu,cpu->e);_fetch(); // XOR E (0)
-        case  172: _z80_xor8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // XOR H (0)
-        case  173: _z80_xor8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // XOR L (0)
-        case  174: _goto(781); // XOR (HL) (0)
-        case  175: _z80_xor8(cpu,cpu->a);_fetch(); // XOR A (0)
-        case  176: _z80_or8(cpu,cpu->b);_fetch(); // OR B (0)
-        case  177: _z80_or8(cpu,cpu->c);_fetch(); // OR C (0)
-        case  178: _z80_or8(cpu,cpu->d);_fetch(); // OR D (0)
-        case  179: _z80_or8(cpu,cpu->e);_fetch(); // OR E (0)
-        case  180: _z80_or8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // OR H (0)
-        case  181: _z80_or8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // OR L (0)
-        case  182: _goto(784); // OR (HL) (0)
-        case  183: _z80_or8(cpu,cpu->a);_fetch(); // OR A (0)
-        case  184: _z80_cp8(cpu,cpu->b);_fetch(); // CP B (0)
-        case  185: _z80_cp8(cpu,cpu->c);_fetch(); // CP C (0)
-        case  186: _z80_cp8(cpu,cpu->d);_fetch(); // CP D (0)
-        case  187: _z80_cp8(cpu,cpu->e);_fetch(); // CP E (0)
-        case  188: _z80_cp8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // CP H (0)
-        case  189: _z80_cp8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // CP L (0)
-        case  190: _goto(787); // CP (HL) (0)
-        case  191: _z80_cp8(cpu,cpu->a);_fetch(); // CP A (0)
-        case  192: if(!_cc_nz){_goto(790+6);};_goto(790); // RET NZ (0)
-        case  193: _goto(797); // POP BC (0)
-        case  194: _goto(803); // JP NZ,nn (0)
-        case  195: _goto(809); // JP nn (0)
-        case  196: _goto(815); // CALL NZ,nn (0)
-        case  197: _goto(828); // PUSH BC (0)
-        case  198: _goto(835); // ADD n (0)
-        case  199: _goto(838); // RST 0h (0)
-        case  200: if(!_cc_z){_goto(845+6);};_goto(845); // RET Z (0)
-        case  201: _goto(852); // RET (0)
-        case  202: _goto(858); // JP Z,nn (0)
-        case  203: _fetch_cb();goto step_to; // CB prefix (0)
-        case  204: _goto(864); // CALL Z,nn (0)
-        case  205: _goto(877); // CALL nn (0)
-        case  206: _goto(890); // ADC n (0)
-        case  207: _goto(893); // RST 8h (0)
-        case  208: if(!_cc_nc){_goto(900+6);};_goto(900); // RET NC (0)
-        case  209: _goto(907); // POP DE (0)
-        case  210: _goto(913); // JP NC,nn (0)
-        case  211: _goto(919); // OUT (n),A (0)
-        case  212: _goto(926); // CALL NC,nn (0)
-        case  213: _goto(939); // PUSH DE (0)
-        case  214: _goto(946); // SUB n (0)
-        case  215: _goto(949); // RST 10h (0)
-        case  216: if(!_cc_c){_goto(956+6);};_goto(956); // RET C (0)
-        case  217: _z80_exx(cpu);_fetch(); // EXX (0)
-        case  218: _goto(963); // JP C,nn (0)
-        case  219: _goto(969); // IN A,(n) (0)
-        case  220: _goto(976); // CALL C,nn (0)
-        case  221: _fetch_dd();goto step_to; // DD prefix (0)
-        case  222: _goto(989); // SBC n (0)
-        case  223: _goto(992); // RST 18h (0)
-        case  224: if(!_cc_po){_goto(999+6);};_goto(999); // RET PO (0)
-        case  225: _goto(1006); // POP HL (0)
-        case  226: _goto(1012); // JP PO,nn (0)
-        case  227: _goto(1018); // EX (SP),HL (0)
-        case  228: _goto(1033); // CALL PO,nn (0)
-        case  229: _goto(1046); // PUSH HL (0)
-        case  230: _goto(1053); // AND n (0)
-        case  231: _goto(1056); // RST 20h (0)
-        case  232: if(!_cc_pe){_goto(1063+6);};_goto(1063); // RET PE (0)
-        case  233: cpu->pc=cpu->hlx[cpu->hlx_idx].hl;_fetch(); // JP HL (0)
-        case  234: _goto(1070); // JP PE,nn (0)
-        case  235: _z80_ex_de_hl(cpu);_fetch(); // EX DE,HL (0)
-        case  236: _goto(1076); // CALL PE,nn (0)
-        case  237: _fetch_ed();goto step_to; // ED prefix (0)
-        case  238: _goto(1089); // XOR n (0)
-        case  239: _goto(1092); // RST 28h (0)
-        case  240: if(!_cc_p){_goto(1099+6);};_goto(1099); // RET P (0)
-        case  241: _goto(1106); // POP AF (0)
-        case  242: _goto(1112); // JP P,nn (0)
-        case  243: cpu->iff1=cpu->iff2=false;_fetch(); // DI (0)
-        case  244: _goto(1118); // CALL P,nn (0)
-        case  245: _goto(1131); // PUSH AF (0)
-        case  246: _goto(1138); // OR n (0)
-        case  247: _goto(1141); // RST 30h (0)
-        case  248: if(!_cc_m){_goto(1148+6);};_goto(1148); // RET M (0)
-        case  249: cpu->sp=cpu->hlx[cpu->hlx_idx].hl;_goto(1155); // LD SP,HL (0)
-        case  250: _goto(1157); // JP M,nn (0)
-        case  251: cpu->iff1=cpu->iff2=false;pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2=true;goto step_to; // EI (0)
-        case  252: _goto(1163); // CALL M,nn (0)
-        case  253: _fetch_fd();goto step_to; // FD prefix (0)
-        case  254: _goto(1176); // CP n (0)
-        case  255: _goto(1179); // RST 38h (0)
-        case  256: _fetch(); // ED NOP (0)
-        case  257: _fetch(); // ED NOP (0)
-        case  258: _fetch(); // ED NOP (0)
-        case  259: _fetch(); // ED NOP (0)
-        case  260: _fetch(); // ED NOP (0)
-        case  261: _fetch(); // ED NOP (0)
-        case  262: _fetch(); // ED NOP (0)
-        case  263: _fetch(); // ED NOP (0)
-        case  264: _fetch(); // ED NOP (0)
-        case  265: _fetch(); // ED NOP (0)
-        case  266: _fetch(); // ED NOP (0)
-        case  267: _fetch(); // ED NOP (0)
-        case  268: _fetch(); // ED NOP (0)
-        case  269: _fetch(); // ED NOP (0)
-        case  270: _fetch(); // ED NOP (0)
-        case  271: _fetch(); // ED NOP (0)
-        case  272: _fetch(); // ED NOP (0)
-        case  273: _fetch(); // ED NOP (0)
-        case  274: _fetch(); // ED NOP (0)
-        case  275: _fetch(); // ED NOP (0)
-        case  276: _fetch(); // ED NOP (0)
-        case  277: _fetch(); // ED NOP (0)
-        case  278: _fetch(); // ED NOP (0)
-        case  279: _fetch(); // ED NOP (0)
-        case  280: _fetch(); // ED NOP (0)
-        case  281: _fetch(); // ED NOP (0)
-        case  282: _fetch(); // ED NOP (0)
-        case  283: _fetch(); // ED NOP (0)
-        case  284: _fetch(); // ED NOP (0)
-        case  285: _fetch(); // ED NOP (0)
-        case  286: _fetch(); // ED NOP (0)
-        case  287: _fetch(); // ED NOP (0)
-        case  288: _fetch(); // ED NOP (0)
-        case  289: _fetch(); // ED NOP (0)
-        case  290: _fetch(); // ED NOP (0)
-        case  291: _fetch(); // ED NOP (0)
-        case  292: _fetch(); // ED NOP (0)
-        case  293: _fetch(); // ED NOP (0)
-        case  294: _fetch(); // ED NOP (0)
-        case  295: _fetch(); // ED NOP (0)
-        case  296: _fetch(); // ED NOP (0)
-        case  297: _fetch(); // ED NOP (0)
-        case  298: _fetch(); // ED NOP (0)
-        case  299: _fetch(); // ED NOP (0)
-        case  300: _fetch(); // ED NOP (0)
-        case  301: _fetch(); // ED NOP (0)
-        case  302: _fetch(); // ED NOP (0)
-        case  303: _fetch(); // ED NOP (0)
-        case  304: _fetch(); // ED NOP (0)
-        case  305: _fetch(); // ED NOP (0)
-        case  306: _fetch(); // ED NOP (0)
-        case  307: _fetch(); // ED NOP (0)
-        case  308: _fetch(); // ED NOP (0)
-        case  309: _fetch(); // ED NOP (0)
-        case  310: _fetch(); // ED NOP (0)
-        case  311: _fetch(); // ED NOP (0)
-        case  312: _fetch(); // ED NOP (0)
-        case  313: _fetch(); // ED NOP (0)
-        case  314: _fetch(); // ED NOP (0)
-        case  315: _fetch(); // ED NOP (0)
-        case  316: _fetch(); // ED NOP (0)
-        case  317: _fetch(); // ED NOP (0)
-        case  318: _fetch(); // ED NOP (0)
-        case  319: _fetch(); // ED NOP (0)
-        case  320: _goto(1186); // IN B,(C) (0)
-        case  321: _goto(1190); // OUT (C),B (0)
-        case  322: _z80_sbc16(cpu,cpu->bc);_goto(1194); // SBC HL,BC (0)
-        case  323: _goto(1201); // LD (nn),BC (0)
-        case  324: _z80_neg8(cpu);_fetch(); // NEG (0)
-        case  325: _goto(1213); // RETN (0)
-        case  326: cpu->im=0;_fetch(); // IM 0 (0)
-        case  327: _goto(1219); // LD I,A (0)
-        case  328: _goto(1220); // IN C,(C) (0)
-        case  329: _goto(1224); // OUT (C),C (0)
-        case  330: _z80_adc16(cpu,cpu->bc);_goto(1228); // ADC HL,BC (0)
-        case  331: _goto(1235); // LD BC,(nn) (0)
-        case  332: _z80_neg8(cpu);_fetch(); // NEG (0)
-        case  333: _goto(1247); // RETI (0)
-        case  334: cpu->im=0;_fetch(); // IM 0 (0)
-        case  335: _goto(1253); // LD R,A (0)
-        case  336: _goto(1254); // IN D,(C) (0)
-        case  337: _goto(1258); // OUT (C),D (0)
-        case  338: _z80_sbc16(cpu,cpu->de);_goto(1262); // SBC HL,DE (0)
-        case  339: _goto(1269); // LD (nn),DE (0)
-        case  340: _z80_neg8(cpu);_fetch(); // NEG (0)
-        case  341: _goto(1247); // RETI (0)
-        case  342: cpu->im=1;_fetch(); // IM 1 (0)
-        case  343: _goto(1282); // LD A,I (0)
-        case  344: _goto(1283); // IN E,(C) (0)
-        case  345: _goto(1287); // OUT (C),E (0)
-        case  346: _z80_adc16(cpu,cpu->de);_goto(1291); // ADC HL,DE (0)
-        case  347: _goto(1298); // LD DE,(nn) (0)
-        case  348: _z80_neg8(cpu);_fetch(); // NEG (0)
-        case  349: _goto(1247); // RETI (0)
-        case  350: cpu->im=2;_fetch(); // IM 2 (0)
-        case  351: _goto(1311); // LD A,R (0)
-        case  352: _goto(1312); // IN H,(C) (0)
-        case  353: _goto(1316); // OUT (C),H (0)
-        case  354: _z80_sbc16(cpu,cpu->hl);_goto(1320); // SBC HL,HL (0)
-        case  355: _goto(1327); // LD (nn),HL (0)
-        case  356: _z80_neg8(cpu);_fetch(); // NEG (0)
-        case  357: _goto(1247); // RETI (0)
-        case  358: cpu->im=0;_fetch(); // IM 0 (0)
-        case  359: _goto(1340); // RRD (0)
-        case  360: _goto(1350); // IN L,(C) (0)
-        case  361: _goto(1354); // OUT (C),L (0)
-        case  362: _z80_adc16(cpu,cpu->hl);_goto(1358); // ADC HL,HL (0)
-        case  363: _goto(1365); // LD HL,(nn) (0)
-        case  364: _z80_neg8(cpu);_fetch(); // NEG (0)
-        case  365: _goto(1247); // RETI (0)
-        case  366: cpu->im=0;_fetch(); // IM 0 (0)
-        case  367: _goto(1378); // RLD (0)
-        case  368: _goto(1388); // IN (C) (0)
-        case  369: _goto(1392); // OUT (C),0 (0)
-        case  370: _z80_sbc16(cpu,cpu->sp);_goto(1396); // SBC HL,SP (0)
-        case  371: _goto(1403); // LD (nn),SP (0)
-        case  372: _z80_neg8(cpu);_fetch(); // NEG (0)
-        case  373: _goto(1247); // RETI (0)
-        case  374: cpu->im=1;_fetch(); // IM 1 (0)
-        case  375: _fetch(); // ED NOP (0)
-        case  376: _goto(1416); // IN A,(C) (0)
-        case  377: _goto(1420); // OUT (C),A (0)
-        case  378: _z80_adc16(cpu,cpu->sp);_goto(1424); // ADC HL,SP (0)
-        case  379: _goto(1431); // LD SP,(nn) (0)
-        case  380: _z80_neg8(cpu);_fetch(); // NEG (0)
-        case  381: _goto(1247); // RETI (0)
-        case  382: cpu->im=2;_fetch(); // IM 2 (0)
-        case  383: _fetch(); // ED NOP (0)
-        case  384: _fetch(); // ED NOP (0)
-        case  385: _fetch(); // ED NOP (0)
-        case  386: _fetch(); // ED NOP (0)
-        case  387: _fetch(); // ED NOP (0)
-        case  388: _fetch(); // ED NOP (0)
-        case  389: _fetch(); // ED NOP (0)
-        case  390: _fetch(); // ED NOP (0)
-        case  391: _fetch(); // ED NOP (0)
-        case  392: _fetch(); // ED NOP (0)
-        case  393: _fetch(); // ED NOP (0)
-        case  394: _fetch(); // ED NOP (0)
-        case  395: _fetch(); // ED NOP (0)
-        case  396: _fetch(); // ED NOP (0)
-        case  397: _fetch(); // ED NOP (0)
-        case  398: _fetch(); // ED NOP (0)
-        case  399: _fetch(); // ED NOP (0)
-        case  400: _fetch(); // ED NOP (0)
-        case  401: _fetch(); // ED NOP (0)
-        case  402: _fetch(); // ED NOP (0)
-        case  403: _fetch(); // ED NOP (0)
-        case  404: _fetch(); // ED NOP (0)
-        case  405: _fetch(); // ED NOP (0)
-        case  406: _fetch(); // ED NOP (0)
-        case  407: _fetch(); // ED NOP (0)
-        case  408: _fetch(); // ED NOP (0)
-        case  409: _fetch(); // ED NOP (0)
-        case  410: _fetch(); // ED NOP (0)
-        case  411: _fetch(); // ED NOP (0)
-        case  412: _fetch(); // ED NOP (0)
-        case  413: _fetch(); // ED NOP (0)
-        case  414: _fetch(); // ED NOP (0)
-        case  415: _fetch(); // ED NOP (0)
-        case  416: _goto(1444); // LDI (0)
-        case  417: _goto(1452); // CPI (0)
-        case  418: _goto(1460); // INI (0)
-        case  419: _goto(1468); // OUTI (0)
-        case  420: _fetch(); // ED NOP (0)
-        case  421: _fetch(); // ED NOP (0)
-        case  422: _fetch(); // ED NOP (0)
-        case  423: _fetch(); // ED NOP (0)
-        case  424: _goto(1476); // LDD (0)
-        case  425: _goto(1484); // CPD (0)
-        case  426: _goto(1492); // IND (0)
-        case  427: _goto(1500); // OUTD (0)
-        case  428: _fetch(); // ED NOP (0)
-        case  429: _fetch(); // ED NOP (0)
-        case  430: _fetch(); // ED NOP (0)
-        case  431: _fetch(); // ED NOP (0)
-        case  432: _goto(1508); // LDIR (0)
-        case  433: _goto(1521); // CPIR (0)
-        case  434: _goto(1534); // INIR (0)
-        case  435: _goto(1547); // OTIR (0)
-        case  436: _fetch(); // ED NOP (0)
-        case  437: _fetch(); // ED NOP (0)
-        case  438: _fetch(); // ED NOP (0)
-        case  439: _fetch(); // ED NOP (0)
-        case  440: _goto(1560); // LDDR (0)
-        case  441: _goto(1573); // CPDR (0)
-        case  442: _goto(1586); // INDR (0)
-        case  443: _goto(1599); // OTDR (0)
-        case  444: _fetch(); // ED NOP (0)
-        case  445: _fetch(); // ED NOP (0)
-        case  446: _fetch(); // ED NOP (0)
-        case  447: _fetch(); // ED NOP (0)
-        case  448: _fetch(); // ED NOP (0)
-        case  449: _fetch(); // ED NOP (0)
-        case  450: _fetch(); // ED NOP (0)
-        case  451: _fetch(); // ED NOP (0)
-        case  452: _fetch(); // ED NOP (0)
-        case  453: _fetch(); // ED NOP (0)
-        case  454: _fetch(); // ED NOP (0)
-        case  455: _fetch(); // ED NOP (0)
-        case  456: _fetch(); // ED NOP (0)
-        case  457: _fetch(); // ED NOP (0)
-        case  458: _fetch(); // ED NOP (0)
-        case  459: _fetch(); // ED NOP (0)
-        case  460: _fetch(); // ED NOP (0)
-        case  461: _fetch(); // ED NOP (0)
-        case  462: _fetch(); // ED NOP (0)
-        case  463: _fetch(); // ED NOP (0)
-        case  464: _fetch(); // ED NOP (0)
-        case  465: _fetch(); // ED NOP (0)
-        case  466: _fetch(); // ED NOP (0)
-        case  467: _fetch(); // ED NOP (0)
-        case  468: _fetch(); // ED NOP (0)
-        case  469: _fetch(); // ED NOP (0)
-        case  470: _fetch(); // ED NOP (0)
-        case  471: _fetch(); // ED NOP (0)
-        case  472: _fetch(); // ED NOP (0)
-        case  473: _fetch(); // ED NOP (0)
-        case  474: _fetch(); // ED NOP (0)
-        case  475: _fetch(); // ED NOP (0)
-        case  476: _fetch(); // ED NOP (0)
-        case  477: _fetch(); // ED NOP (0)
-        case  478: _fetch(); // ED NOP (0)
-        case  479: _fetch(); // ED NOP (0)
-        case  480: _fetch(); // ED NOP (0)
-        case  481: _fetch(); // ED NOP (0)
-        case  482: _fetch(); // ED NOP (0)
-        case  483: _fetch(); // ED NOP (0)
-        case  484: _fetch(); // ED NOP (0)
-        case  485: _fetch(); // ED NOP (0)
-        case  486: _fetch(); // ED NOP (0)
-        case  487: _fetch(); // ED NOP (0)
-        case  488: _fetch(); // ED NOP (0)
-        case  489: _fetch(); // ED NOP (0)
-        case  490: _fetch(); // ED NOP (0)
-        case  491: _fetch(); // ED NOP (0)
-        case  492: _fetch(); // ED NOP (0)
-        case  493: _fetch(); // ED NOP (0)
-        case  494: _fetch(); // ED NOP (0)
-        case  495: _fetch(); // ED NOP (0)
-        case  496: _fetch(); // ED NOP (0)
-        case  497: _fetch(); // ED NOP (0)
-        case  498: _fetch(); // ED NOP (0)
-        case  499: _fetch(); // ED NOP (0)
-        case  500: _fetch(); // ED NOP (0)
-        case  501: _fetch(); // ED NOP (0)
-        case  502: _fetch(); // ED NOP (0)
-        case  503: _fetch(); // ED NOP (0)
-        case  504: _fetch(); // ED NOP (0)
-        case  505: _fetch(); // ED NOP (0)
-        case  506: _fetch(); // ED NOP (0)
-        case  507: _fetch(); // ED NOP (0)
-        case  508: _fetch(); // ED NOP (0)
-        case  509: _fetch(); // ED NOP (0)
-        case  510: _fetch(); // ED NOP (0)
-        case  511: _fetch(); // ED NOP (0)
-        case  512: _wait();_mread(cpu->pc++);_goto(513); // LD BC,nn (1)
-        case  513: cpu->c=_gd();_goto(514); // LD BC,nn (2)
-        case  514: _goto(515); // LD BC,nn (3)
-        case  515: _wait();_mread(cpu->pc++);_goto(516); // LD BC,nn (4)
-        case  516: cpu->b=_gd();_goto(517); // LD BC,nn (5)
-        case  517: _fetch(); // LD BC,nn (6)
-        case  518: _wait();_mwrite(cpu->bc,cpu->a);cpu->wzl=cpu->c+1;cpu->wzh=cpu->a;_goto(519); // LD (BC),A (1)
-        case  519: _goto(520); // LD (BC),A (2)
-        case  520: _fetch(); // LD (BC),A (3)
-        case  521: _goto(522); // INC BC (1)
-        case  522: _fetch(); // INC BC (2)
-        case  523: _wait();_mread(cpu->pc++);_goto(524); // LD B,n (1)
-        case  524: cpu->b=_gd();_goto(525); // LD B,n (2)
-        case  525: _fetch(); // LD B,n (3)
-        case  526: _goto(527); // ADD HL,BC (1)
-        case  527: _goto(528); // ADD HL,BC (2)
-        case  528: _goto(529); // ADD HL,BC (3)
-        case  529: _goto(530); // ADD HL,BC (4)
-        case  530: _goto(531); // ADD HL,BC (5)
-        case  531: _goto(532); // ADD HL,BC (6)
-        case  532: _fetch(); // ADD HL,BC (7)
-        case  533: _wait();_mread(cpu->bc);_goto(534); // LD A,(BC) (1)
-        case  534: cpu->a=_gd();cpu->wz=cpu->bc+1;_goto(535); // LD A,(BC) (2)
-        case  535: _fetch(); // LD A,(BC) (3)
-        case  536: _goto(537); // DEC BC (1)
-        case  537: _fetch(); // DEC BC (2)
-        case  538: _wait();_mread(cpu->pc++);_goto(539); // LD C,n (1)
-        case  539: cpu->c=_gd();_goto(540); // LD C,n (2)
-        case  540: _fetch(); // LD C,n (3)
-        case  541: _goto(542); // DJNZ d (1)
-        case  542: _wait();_mread(cpu->pc++);_goto(543); // DJNZ d (2)
-        case  543: cpu->dlatch=_gd();if(--cpu->b==0){_goto(544+5);};_goto(544); // DJNZ d (3)
-        case  544: cpu->pc+=(int8_t)cpu->dlatch;cpu->wz=cpu->pc;_goto(545); // DJNZ d (4)
-        case  545: _goto(546); // DJNZ d (5)
-        case  546: _goto(547); // DJNZ d (6)
-        case  547: _goto(548); // DJNZ d (7)
-        case  548: _goto(549); // DJNZ d (8)
-        case  549: _fetch(); // DJNZ d (9)
-        case  550: _wait();_mread(cpu->pc++);_goto(551); // LD DE,nn (1)
-        case  551: cpu->e=_gd();_goto(552); // LD DE,nn (2)
-        case  552: _goto(553); // LD DE,nn (3)
-        case  553: _wait();_mread(cpu->pc++);_goto(554); // LD DE,nn (4)
-        case  554: cpu->d=_gd();_goto(555); // LD DE,nn (5)
-        case  555: _fetch(); // LD DE,nn (6)
-        case  556: _wait();_mwrite(cpu->de,cpu->a);cpu->wzl=cpu->e+1;cpu->wzh=cpu->a;_goto(557); // LD (DE),A (1)
-        case  557: _goto(558); // LD (DE),A (2)
-        case  558: _fetch(); // LD (DE),A (3)
-        case  559: _goto(560); // INC DE (1)
-        case  560: _fetch(); // INC DE (2)
-        case  561: _wait();_mread(cpu->pc++);_goto(562); // LD D,n (1)
-        case  562: cpu->d=_gd();_goto(563); // LD D,n (2)
-        case  563: _fetch(); // LD D,n (3)
-        case  564: _wait();_mread(cpu->pc++);_goto(565); // JR d (1)
-        case  565: cpu->dlatch=_gd();_goto(566); // JR d (2)
-        case  566: cpu->pc+=(int8_t)cpu->dlatch;cpu->wz=cpu->pc;_goto(567); // JR d (3)
-        case  567: _goto(568); // JR d (4)
-        case  568: _goto(569); // JR d (5)
-        case  569: _goto(570); // JR d (6)
-        case  570: _goto(571); // JR d (7)
-        case  571: _fetch(); // JR d (8)
-        case  572: _goto(573); // ADD HL,DE (1)
-        case  573: _goto(574); // ADD HL,DE (2)
-        case  574: _goto(575); // ADD HL,DE (3)
-        case  575: _goto(576); // ADD HL,DE (4)
-        case  576: _goto(577); // ADD HL,DE (5)
-        case  577: _goto(578); // ADD HL,DE (6)
-        case  578: _fetch(); // ADD HL,DE (7)
-        case  579: _wait();_mread(cpu->de);_goto(580); // LD A,(DE) (1)
-        case  580: cpu->a=_gd();cpu->wz=cpu->de+1;_goto(581); // LD A,(DE) (2)
-        case  581: _fetch(); // LD A,(DE) (3)
-        case  582: _goto(583); // DEC DE (1)
-        case  583: _fetch(); // DEC DE (2)
-        case  584: _wait();_mread(cpu->pc++);_goto(585); // LD E,n (1)
-        case  585: cpu->e=_gd();_goto(586); // LD E,n (2)
-        case  586: _fetch(); // LD E,n (3)
-        case  587: _wait();_mread(cpu->pc++);_goto(588); // JR NZ,d (1)
-        case  588: cpu->dlatch=_gd();if(!(_cc_nz)){_goto(589+5);};_goto(589); // JR NZ,d (2)
-        case  589: cpu->pc+=(int8_t)cpu->dlatch;cpu->wz=cpu->pc;_goto(590); // JR NZ,d (3)
-        case  590: _goto(591); // JR NZ,d (4)
-        case  591: _goto(592); // JR NZ,d (5)
-        case  592: _goto(593); // JR NZ,d (6)
-        case  593: _goto(594); // JR NZ,d (7)
-        case  594: _fetch(); // JR NZ,d (8)
-        case  595: _wait();_mread(cpu->pc++);_goto(596); // LD HL,nn (1)
-        case  596: cpu->hlx[cpu->hlx_idx].l=_gd();_goto(597); // LD HL,nn (2)
-        case  597: _goto(598); // LD HL,nn (3)
-        case  598: _wait();_mread(cpu->pc++);_goto(599); // LD HL,nn (4)
-        case  599: cpu->hlx[cpu->hlx_idx].h=_gd();_goto(600); // LD HL,nn (5)
-        case  600: _fetch(); // LD HL,nn (6)
-        case  601: _wait();_mread(cpu->pc++);_goto(602); // LD (nn),HL (1)
-        case  602: cpu->wzl=_gd();_goto(603); // LD (nn),HL (2)
-        case  603: _goto(604); // LD (nn),HL (3)
-        case  604: _wait();_mread(cpu->pc++);_goto(605); // LD (nn),HL (4)
-        case  605: cpu->wzh=_gd();_goto(606); // LD (nn),HL (5)
-        case  606: _goto(607); // LD (nn),HL (6)
-        case  607: _wait();_mwrite(cpu->wz++,cpu->hlx[cpu->hlx_idx].l);_goto(608); // LD (nn),HL (7)
-        case  608: _goto(609); // LD (nn),HL (8)
-        case  609: _goto(610); // LD (nn),HL (9)
-        case  610: _wait();_mwrite(cpu->wz,cpu->hlx[cpu->hlx_idx].h);_goto(611); // LD (nn),HL (10)
-        case  611: _goto(612); // LD (nn),HL (11)
-        case  612: _fetch(); // LD (nn),HL (12)
-        case  613: _goto(614); // INC HL (1)
-        case  614: _fetch(); // INC HL (2)
-        case  615: _wait();_mread(cpu->pc++);_goto(616); // LD H,n (1)
-        case  616: cpu->hlx[cpu->hlx_idx].h=_gd();_goto(617); // LD H,n (2)
-        case  617: _fetch(); // LD H,n (3)
-        case  618: _wait();_mread(cpu->pc++);_goto(619); // JR Z,d (1)
-        case  619: cpu->dlatch=_gd();if(!(_cc_z)){_goto(620+5);};_goto(620); // JR Z,d (2)
-        case  620: cpu->pc+=(int8_t)cpu->dlatch;cpu->wz=cpu->pc;_goto(621); // JR Z,d (3)
-        case  621: _goto(622); // JR Z,d (4)
-        case  622: _goto(623); // JR Z,d (5)
-        case  623: _goto(624); // JR Z,d (6)
-        case  624: _goto(625); // JR Z,d (7)
-        case  625: _fetch(); // JR Z,d (8)
-        case  626: _goto(627); // ADD HL,HL (1)
-        case  627: _goto(628); // ADD HL,HL (2)
-        case  628: _goto(629); // ADD HL,HL (3)
-        case  629: _goto(630); // ADD HL,HL (4)
-        case  630: _goto(631); // ADD HL,HL (5)
-        case  631: _goto(632); // ADD HL,HL (6)
-        case  632: _fetch(); // ADD HL,HL (7)
-        case  633: _wait();_mread(cpu->pc++);_goto(634); // LD HL,(nn) (1)
-        case  634: cpu->wzl=_gd();_goto(635); // LD HL,(nn) (2)
-        case  635: _goto(636); // LD HL,(nn) (3)
-        case  636: _wait();_mread(cpu->pc++);_goto(637); // LD HL,(nn) (4)
-        case  637: cpu->wzh=_gd();_goto(638); // LD HL,(nn) (5)
-        case  638: _goto(639); // LD HL,(nn) (6)
-        case  639: _wait();_mread(cpu->wz++);_goto(640); // LD HL,(nn) (7)
-        case  640: cpu->hlx[cpu->hlx_idx].l=_gd();_goto(641); // LD HL,(nn) (8)
-        case  641: _goto(642); // LD HL,(nn) (9)
-        case  642: _wait();_mread(cpu->wz);_goto(643); // LD HL,(nn) (10)
-        case  643: cpu->hlx[cpu->hlx_idx].h=_gd();_goto(644); // LD HL,(nn) (11)
-        case  644: _fetch(); // LD HL,(nn) (12)
-        case  645: _goto(646); // DEC HL (1)
-        case  646: _fetch(); // DEC HL (2)
-        case  647: _wait();_mread(cpu->pc++);_goto(648); // LD L,n (1)
-        case  648: cpu->hlx[cpu->hlx_idx].l=_gd();_goto(649); // LD L,n (2)
-        case  649: _fetch(); // LD L,n (3)
-        case  650: _wait();_mread(cpu->pc++);_goto(651); // JR NC,d (1)
-        case  651: cpu->dlatch=_gd();if(!(_cc_nc)){_goto(652+5);};_goto(652); // JR NC,d (2)
-        case  652: cpu->pc+=(int8_t)cpu->dlatch;cpu->wz=cpu->pc;_goto(653); // JR NC,d (3)
-        case  653: _goto(654); // JR NC,d (4)
-        case  654: _goto(655); // JR NC,d (5)
-        case  655: _goto(656); // JR NC,d (6)
-        case  656: _goto(657); // JR NC,d (7)
-        case  657: _fetch(); // JR NC,d (8)
-        case  658: _wait();_mread(cpu->pc++);_goto(659); // LD SP,nn (1)
-        case  659: cpu->spl=_gd();_goto(660); // LD SP,nn (2)
-        case  660: _goto(661); // LD SP,nn (3)
-        case  661: _wait();_mread(cpu->pc++);_goto(662); // LD SP,nn (4)
-        case  662: cpu->sph=_gd();_goto(663); // LD SP,nn (5)
-        case  663: _fetch(); // LD SP,nn (6)
-        case  664: _wait();_mread(cpu->pc++);_goto(665); // LD (nn),A (1)
-        case  665: cpu->wzl=_gd();_goto(666); // LD (nn),A (2)
-        case  666: _goto(667); // LD (nn),A (3)
-        case  667: _wait();_mread(cpu->pc++);_goto(668); // LD (nn),A (4)
-        case  668: cpu->wzh=_gd();_goto(669); // LD (nn),A (5)
-        case  669: _goto(670); // LD (nn),A (6)
-        case  670: _wait();_mwrite(cpu->wz++,cpu->a);cpu->wzh=cpu->a;_goto(671); // LD (nn),A (7)
-        case  671: _goto(672); // LD (nn),A (8)
-        case  672: _fetch(); // LD (nn),A (9)
-        case  673: _goto(674); // INC SP (1)
-        case  674: _fetch(); // INC SP (2)
-        case  675: _wait();_mread(cpu->addr);_goto(676); // INC (HL) (1)
-        case  676: cpu->dlatch=_gd();cpu->dlatch=_z80_inc8(cpu,cpu->dlatch);_goto(677); // INC (HL) (2)
-        case  677: _goto(678); // INC (HL) (3)
-        case  678: _goto(679); // INC (HL) (4)
-        case  679: _wait();_mwrite(cpu->addr,cpu->dlatch);_goto(680); // INC (HL) (5)
-        case  680: _goto(681); // INC (HL) (6)
-        case  681: _fetch(); // INC (HL) (7)
-        case  682: _wait();_mread(cpu->addr);_goto(683); // DEC (HL) (1)
-        case  683: cpu->dlatch=_gd();cpu->dlatch=_z80_dec8(cpu,cpu->dlatch);_goto(684); // DEC (HL) (2)
-        case  684: _goto(685); // DEC (HL) (3)
-        case  685: _goto(686); // DEC (HL) (4)
-        case  686: _wait();_mwrite(cpu->addr,cpu->dlatch);_goto(687); // DEC (HL) (5)
-        case  687: _goto(688); // DEC (HL) (6)
-        case  688: _fetch(); // DEC (HL) (7)
-        case  689: _wait();_mread(cpu->pc++);_goto(690); // LD (HL),n (1)
-        case  690: cpu->dlatch=_gd();_goto(691); // LD (HL),n (2)
-        case  691: _goto(692); // LD (HL),n (3)
-        case  692: _wait();_mwrite(cpu->addr,cpu->dlatch);_goto(693); // LD (HL),n (4)
-        case  693: _goto(694); // LD (HL),n (5)
-        case  694: _fetch(); // LD (HL),n (6)
-        case  695: _wait();_mread(cpu->pc++);_goto(696); // JR C,d (1)
-        case  696: cpu->dlatch=_gd();if(!(_cc_c)){_goto(697+5);};_goto(697); // JR C,d (2)
-        case  697: cpu->pc+=(int8_t)cpu->dlatch;cpu->wz=cpu->pc;_goto(698); // JR C,d (3)
-        case  698: _goto(699); // JR C,d (4)
-        case  699: _goto(700); // JR C,d (5)
-        case  700: _goto(701); // JR C,d (6)
-        case  701: _goto(702); // JR C,d (7)
-        case  702: _fetch(); // JR C,d (8)
-        case  703: _goto(704); // ADD HL,SP (1)
-        case  704: _goto(705); // ADD HL,SP (2)
-        case  705: _goto(706); // ADD HL,SP (3)
-        case  706: _goto(707); // ADD HL,SP (4)
-        case  707: _goto(708); // ADD HL,SP (5)
-        case  708: _goto(709); // ADD HL,SP (6)
-        case  709: _fetch(); // ADD HL,SP (7)
-        case  710: _wait();_mread(cpu->pc++);_goto(711); // LD A,(nn) (1)
-        case  711: cpu->wzl=_gd();_goto(712); // LD A,(nn) (2)
-        case  712: _goto(713); // LD A,(nn) (3)
-        case  713: _wait();_mread(cpu->pc++);_goto(714); // LD A,(nn) (4)
-        case  714: cpu->wzh=_gd();_goto(715); // LD A,(nn) (5)
-        case  715: _goto(716); // LD A,(nn) (6)
-        case  716: _wait();_mread(cpu->wz++);_goto(717); // LD A,(nn) (7)
-        case  717: cpu->a=_gd();_goto(718); // LD A,(nn) (8)
-        case  718: _fetch(); // LD A,(nn) (9)
-        case  719: _goto(720); // DEC SP (1)
-        case  720: _fetch(); // DEC SP (2)
-        case  721: _wait();_mread(cpu->pc++);_goto(722); // LD A,n (1)
-        case  722: cpu->a=_gd();_goto(723); // LD A,n (2)
-        case  723: _fetch(); // LD A,n (3)
-        case  724: _wait();_mread(cpu->addr);_goto(725); // LD B,(HL) (1)
-        case  725: cpu->b=_gd();_goto(726); // LD B,(HL) (2)
-        case  726: _fetch(); // LD B,(HL) (3)
-        case  727: _wait();_mread(cpu->addr);_goto(728); // LD C,(HL) (1)
-        case  728: cpu->c=_gd();_goto(729); // LD C,(HL) (2)
-        case  729: _fetch(); // LD C,(HL) (3)
-        case  730: _wait();_mread(cpu->addr);_goto(731); // LD D,(HL) (1)
-        case  731: cpu->d=_gd();_goto(732); // LD D,(HL) (2)
-        case  732: _fetch(); // LD D,(HL) (3)
-        case  733: _wait();_mread(cpu->addr);_goto(734); // LD E,(HL) (1)
-        case  734: cpu->e=_gd();_goto(735); // LD E,(HL) (2)
-        case  735: _fetch(); // LD E,(HL) (3)
-        case  736: _wait();_mread(cpu->addr);_goto(737); // LD H,(HL) (1)
-        case  737: cpu->h=_gd();_goto(738); // LD H,(HL) (2)
-        case  738: _fetch(); // LD H,(HL) (3)
-        case  739: _wait();_mread(cpu->addr);_goto(740); // LD L,(HL) (1)
-        case  740: cpu->l=_gd();_goto(741); // LD L,(HL) (2)
-        case  741: _fetch(); // LD L,(HL) (3)
-        case  742: _wait();_mwrite(cpu->addr,cpu->b);_goto(743); // LD (HL),B (1)
-        case  743: _goto(744); // LD (HL),B (2)
-        case  744: _fetch(); // LD (HL),B (3)
-        case  745: _wait();_mwrite(cpu->addr,cpu->c);_goto(746); // LD (HL),C (1)
-        case  746: _goto(747); // LD (HL),C (2)
-        case  747: _fetch(); // LD (HL),C (3)
-        case  748: _wait();_mwrite(cpu->addr,cpu->d);_goto(749); // LD (HL),D (1)
-        case  749: _goto(750); // LD (HL),D (2)
-        case  750: _fetch(); // LD (HL),D (3)
-        case  751: _wait();_mwrite(cpu->addr,cpu->e);_goto(752); // LD (HL),E (1)
-        case  752: _goto(753); // LD (HL),E (2)
-        case  753: _fetch(); // LD (HL),E (3)
-        case  754: _wait();_mwrite(cpu->addr,cpu->h);_goto(755); // LD (HL),H (1)
-        case  755: _goto(756); // LD (HL),H (2)
-        case  756: _fetch(); // LD (HL),H (3)
-        case  757: _wait();_mwrite(cpu->addr,cpu->l);_goto(758); // LD (HL),L (1)
-        case  758: _goto(759); // LD (HL),L (2)
-        case  759: _fetch(); // LD (HL),L (3)
-        case  760: _wait();_mwrite(cpu->addr,cpu->a);_goto(761); // LD (HL),A (1)
-        case  761: _goto(762); // LD (HL),A (2)
-        case  762: _fetch(); // LD (HL),A (3)
-        case  763: _wait();_mread(cpu->addr);_goto(764); // LD A,(HL) (1)
-        case  764: cpu->a=_gd();_goto(765); // LD A,(HL) (2)
-        case  765: _fetch(); // LD A,(HL) (3)
-        case  766: _wait();_mread(cpu->addr);_goto(767); // ADD (HL) (1)
-        case  767: cpu->dlatch=_gd();_goto(768); // ADD (HL) (2)
-        case  768: _z80_add8(cpu,cpu->dlatch);_fetch(); // ADD (HL) (3)
-        case  769: _wait();_mread(cpu->addr);_goto(770); // ADC (HL) (1)
-        case  770: cpu->dlatch=_gd();_goto(771); // ADC (HL) (2)
-        case  771: _z80_adc8(cpu,cpu->dlatch);_fetch(); // ADC (HL) (3)
-        case  772: _wait();_mread(cpu->addr);_goto(773); // SUB (HL) (1)
-        case  773: cpu->dlatch=_gd();_goto(774); // SUB (HL) (2)
-        case  774: _z80_sub8(cpu,cpu->dlatch);_fetch(); // SUB (HL) (3)
-        case  775: _wait();_mread(cpu->addr);_goto(776); // SBC (HL) (1)
-        case  776: cpu->dlatch=_gd();_goto(777); // SBC (HL) (2)
-        case  777: _z80_sbc8(cpu,cpu->dlatch);_fetch(); // SBC (HL) (3)
-        case  778: _wait();_mread(cpu->addr);_goto(779); // AND (HL) (1)
-        case  779: cpu->dlatch=_gd();_goto(780); // AND (HL) (2)
-        case  780: _z80_and8(cpu,cpu->dlatch);_fetch(); // AND (HL) (3)
-        case  781: _wait();_mread(cpu->addr);_goto(782); // XOR (HL) (1)
-        case  782: cpu->dlatch=_gd();_goto(783); // XOR (HL) (2)
-        case  783: _z80_xor8(cpu,cpu->dlatch);_fetch(); // XOR (HL) (3)
-        case  784: _wait();_mread(cpu->addr);_goto(785); // OR (HL) (1)
-        case  785: cpu->dlatch=_gd();_goto(786); // OR (HL) (2)
-        case  786: _z80_or8(cpu,cpu->dlatch);_fetch(); // OR (HL) (3)
-        case  787: _wait();_mread(cpu->addr);_goto(788); // CP (HL) (1)
-        case  788: cpu->dlatch=_gd();_goto(789); // CP (HL) (2)
-        case  789: _z80_cp8(cpu,cpu->dlatch);_fetch(); // CP (HL) (3)
-        case  790: _goto(791); // RET NZ (1)
-        case  791: _wait();_mread(cpu->sp++);_goto(792); // RET NZ (2)
-        case  792: cpu->wzl=_gd();_goto(793); // RET NZ (3)
-        case  793: _goto(794); // RET NZ (4)
-        case  794: _wait();_mread(cpu->sp++);_goto(795); // RET NZ (5)
-        case  795: cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(796); // RET NZ (6)
-        case  796: _fetch(); // RET NZ (7)
-        case  797: _wait();_mread(cpu->sp++);_goto(798); // POP BC (1)
-        case  798: cpu->c=_gd();_goto(799); // POP BC (2)
-        case  799: _goto(800); // POP BC (3)
-        case  800: _wait();_mread(cpu->sp++);_goto(801); // POP BC (4)
-        case  801: cpu->b=_gd();_goto(802); // POP BC (5)
-        case  802: _fetch(); // POP BC (6)
-        case  803: _wait();_mread(cpu->pc++);_goto(804); // JP NZ,nn (1)
-        case  804: cpu->wzl=_gd();_goto(805); // JP NZ,nn (2)
-        case  805: _goto(806); // JP NZ,nn (3)
-        case  806: _wait();_mread(cpu->pc++);_goto(807); // JP NZ,nn (4)
-        case  807: cpu->wzh=_gd();if(_cc_nz){cpu->pc=cpu->wz;};_goto(808); // JP NZ,nn (5)
-        case  808: _fetch(); // JP NZ,nn (6)
-        case  809: _wait();_mread(cpu->pc++);_goto(810); // JP nn (1)
-        case  810: cpu->wzl=_gd();_goto(811); // JP nn (2)
-        case  811: _goto(812); // JP nn (3)
-        case  812: _wait();_mread(cpu->pc++);_goto(813); // JP nn (4)
-        case  813: cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(814); // JP nn (5)
-        case  814: _fetch(); // JP nn (6)
-        case  815: _wait();_mread(cpu->pc++);_goto(816); // CALL NZ,nn (1)
-        case  816: cpu->wzl=_gd();_goto(817); // CALL NZ,nn (2)
-        case  817: _goto(818); // CALL NZ,nn (3)
-        case  818: _wait();_mread(cpu->pc++);_goto(819); // CALL NZ,nn (4)
-        case  819: cpu->wzh=_gd();if (!_cc_nz){_goto(820+7);};_goto(820); // CALL NZ,nn (5)
-        case  820: _goto(821); // CALL NZ,nn (6)
-        case  821: _goto(822); // CALL NZ,nn (7)
-        case  822: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(823); // CALL NZ,nn (8)
-        case  823: _goto(824); // CALL NZ,nn (9)
-        case  824: _goto(825); // CALL NZ,nn (10)
-        case  825: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(826); // CALL NZ,nn (11)
-        case  826: _goto(827); // CALL NZ,nn (12)
-        case  827: _fetch(); // CALL NZ,nn (13)
-        case  828: _goto(829); // PUSH BC (1)
-        case  829: _wait();_mwrite(--cpu->sp,cpu->b);_goto(830); // PUSH BC (2)
-        case  830: _goto(831); // PUSH BC (3)
-        case  831: _goto(832); // PUSH BC (4)
-        case  832: _wait();_mwrite(--cpu->sp,cpu->c);_goto(833); // PUSH BC (5)
-        case  833: _goto(834); // PUSH BC (6)
-        case  834: _fetch(); // PUSH BC (7)
-        case  835: _wait();_mread(cpu->pc++);_goto(836); // ADD n (1)
-        case  836: cpu->dlatch=_gd();_goto(837); // ADD n (2)
-        case  837: _z80_add8(cpu,cpu->dlatch);_fetch(); // ADD n (3)
-        case  838: _goto(839); // RST 0h (1)
-        case  839: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(840); // RST 0h (2)
-        case  840: _goto(841); // RST 0h (3)
-        case  841: _goto(842); // RST 0h (4)
-        case  842: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=0x00;cpu->pc=cpu->wz;_goto(843); // RST 0h (5)
-        case  843: _goto(844); // RST 0h (6)
-        case  844: _fetch(); // RST 0h (7)
-        case  845: _goto(846); // RET Z (1)
-        case  846: _wait();_mread(cpu->sp++);_goto(847); // RET Z (2)
-        case  847: cpu->wzl=_gd();_goto(848); // RET Z (3)
-        case  848: _goto(849); // RET Z (4)
-        case  849: _wait();_mread(cpu->sp++);_goto(850); // RET Z (5)
-        case  850: cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(851); // RET Z (6)
-        case  851: _fetch(); // RET Z (7)
-        case  852: _wait();_mread(cpu->sp++);_goto(853); // RET (1)
-        case  853: cpu->wzl=_gd();_goto(854); // RET (2)
-        case  854: _goto(855); // RET (3)
-        case  855: _wait();_mread(cpu->sp++);_goto(856); // RET (4)
-        case  856: cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(857); // RET (5)
-        case  857: _fetch(); // RET (6)
-        case  858: _wait();_mread(cpu->pc++);_goto(859); // JP Z,nn (1)
-        case  859: cpu->wzl=_gd();_goto(860); // JP Z,nn (2)
-        case  860: _goto(861); // JP Z,nn (3)
-        case  861: _wait();_mread(cpu->pc++);_goto(862); // JP Z,nn (4)
-        case  862: cpu->wzh=_gd();if(_cc_z){cpu->pc=cpu->wz;};_goto(863); // JP Z,nn (5)
-        case  863: _fetch(); // JP Z,nn (6)
-        case  864: _wait();_mread(cpu->pc++);_goto(865); // CALL Z,nn (1)
-        case  865: cpu->wzl=_gd();_goto(866); // CALL Z,nn (2)
-        case  866: _goto(867); // CALL Z,nn (3)
-        case  867: _wait();_mread(cpu->pc++);_goto(868); // CALL Z,nn (4)
-        case  868: cpu->wzh=_gd();if (!_cc_z){_goto(869+7);};_goto(869); // CALL Z,nn (5)
-        case  869: _goto(870); // CALL Z,nn (6)
-        case  870: _goto(871); // CALL Z,nn (7)
-        case  871: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(872); // CALL Z,nn (8)
-        case  872: _goto(873); // CALL Z,nn (9)
-        case  873: _goto(874); // CALL Z,nn (10)
-        case  874: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(875); // CALL Z,nn (11)
-        case  875: _goto(876); // CALL Z,nn (12)
-        case  876: _fetch(); // CALL Z,nn (13)
-        case  877: _wait();_mread(cpu->pc++);_goto(878); // CALL nn (1)
-        case  878: cpu->wzl=_gd();_goto(879); // CALL nn (2)
-        case  879: _goto(880); // CALL nn (3)
-        case  880: _wait();_mread(cpu->pc++);_goto(881); // CALL nn (4)
-        case  881: cpu->wzh=_gd();_goto(882); // CALL nn (5)
-        case  882: _goto(883); // CALL nn (6)
-        case  883: _goto(884); // CALL nn (7)
-        case  884: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(885); // CALL nn (8)
-        case  885: _goto(886); // CALL nn (9)
-        case  886: _goto(887); // CALL nn (10)
-        case  887: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(888); // CALL nn (11)
-        case  888: _goto(889); // CALL nn (12)
-        case  889: _fetch(); // CALL nn (13)
-        case  890: _wait();_mread(cpu->pc++);_goto(891); // ADC n (1)
-        case  891: cpu->dlatch=_gd();_goto(892); // ADC n (2)
-        case  892: _z80_adc8(cpu,cpu->dlatch);_fetch(); // ADC n (3)
-        case  893: _goto(894); // RST 8h (1)
-        case  894: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(895); // RST 8h (2)
-        case  895: _goto(896); // RST 8h (3)
-        case  896: _goto(897); // RST 8h (4)
-        case  897: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=0x08;cpu->pc=cpu->wz;_goto(898); // RST 8h (5)
-        case  898: _goto(899); // RST 8h (6)
-        case  899: _fetch(); // RST 8h (7)
-        case  900: _goto(901); // RET NC (1)
-        case  901: _wait();_mread(cpu->sp++);_goto(902); // RET NC (2)
-        case  902: cpu->wzl=_gd();_goto(903); // RET NC (3)
-        case  903: _goto(904); // RET NC (4)
-        case  904: _wait();_mread(cpu->sp++);_goto(905); // RET NC (5)
-        case  905: cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(906); // RET NC (6)
-        case  906: _fetch(); // RET NC (7)
-        case  907: _wait();_mread(cpu->sp++);_goto(908); // POP DE (1)
-        case  908: cpu->e=_gd();_goto(909); // POP DE (2)
-        case  909: _goto(910); // POP DE (3)
-        case  910: _wait();_mread(cpu->sp++);_goto(911); // POP DE (4)
-        case  911: cpu->d=_gd();_goto(912); // POP DE (5)
-        case  912: _fetch(); // POP DE (6)
-        case  913: _wait();_mread(cpu->pc++);_goto(914); // JP NC,nn (1)
-        case  914: cpu->wzl=_gd();_goto(915); // JP NC,nn (2)
-        case  915: _goto(916); // JP NC,nn (3)
-        case  916: _wait();_mread(cpu->pc++);_goto(917); // JP NC,nn (4)
-        case  917: cpu->wzh=_gd();if(_cc_nc){cpu->pc=cpu->wz;};_goto(918); // JP NC,nn (5)
-        case  918: _fetch(); // JP NC,nn (6)
-        case  919: _wait();_mread(cpu->pc++);_goto(920); // OUT (n),A (1)
-        case  920: cpu->wzl=_gd();cpu->wzh=cpu->a;_goto(921); // OUT (n),A (2)
-        case  921: _goto(922); // OUT (n),A (3)
-        case  922: _iowrite(cpu->wz,cpu->a);_goto(923); // OUT (n),A (4)
-        case  923: _wait();cpu->wzl++;_goto(924); // OUT (n),A (5)
-        case  924: _goto(925); // OUT (n),A (6)
-        case  925: _fetch(); // OUT (n),A (7)
-        case  926: _wait();_mread(cpu->pc++);_goto(927); // CALL NC,nn (1)
-        case  927: cpu->wzl=_gd();_goto(928); // CALL NC,nn (2)
-        case  928: _goto(929); // CALL NC,nn (3)
-        case  929: _wait();_mread(cpu->pc++);_goto(930); // CALL NC,nn (4)
-        case  930: cpu->wzh=_gd();if (!_cc_nc){_goto(931+7);};_goto(931); // CALL NC,nn (5)
-        case  931: _goto(932); // CALL NC,nn (6)
-        case  932: _goto(933); // CALL NC,nn (7)
-        case  933: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(934); // CALL NC,nn (8)
-        case  934: _goto(935); // CALL NC,nn (9)
-        case  935: _goto(936); // CALL NC,nn (10)
-        case  936: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(937); // CALL NC,nn (11)
-        case  937: _goto(938); // CALL NC,nn (12)
-        case  938: _fetch(); // CALL NC,nn (13)
-        case  939: _goto(940); // PUSH DE (1)
-        case  940: _wait();_mwrite(--cpu->sp,cpu->d);_goto(941); // PUSH DE (2)
-        case  941: _goto(942); // PUSH DE (3)
-        case  942: _goto(943); // PUSH DE (4)
-        case  943: _wait();_mwrite(--cpu->sp,cpu->e);_goto(944); // PUSH DE (5)
-        case  944: _goto(945); // PUSH DE (6)
-        case  945: _fetch(); // PUSH DE (7)
-        case  946: _wait();_mread(cpu->pc++);_goto(947); // SUB n (1)
-        case  947: cpu->dlatch=_gd();_goto(948); // SUB n (2)
-        case  948: _z80_sub8(cpu,cpu->dlatch);_fetch(); // SUB n (3)
-        case  949: _goto(950); // RST 10h (1)
-        case  950: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(951); // RST 10h (2)
-        case  951: _goto(952); // RST 10h (3)
-        case  952: _goto(953); // RST 10h (4)
-        case  953: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=0x10;cpu->pc=cpu->wz;_goto(954); // RST 10h (5)
-        case  954: _goto(955); // RST 10h (6)
-        case  955: _fetch(); // RST 10h (7)
-        case  956: _goto(957); // RET C (1)
-        case  957: _wait();_mread(cpu->sp++);_goto(958); // RET C (2)
-        case  958: cpu->wzl=_gd();_goto(959); // RET C (3)
-        case  959: _goto(960); // RET C (4)
-        case  960: _wait();_mread(cpu->sp++);_goto(961); // RET C (5)
-        case  961: cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(962); // RET C (6)
-        case  962: _fetch(); // RET C (7)
-        case  963: _wait();_mread(cpu->pc++);_goto(964); // JP C,nn (1)
-        case  964: cpu->wzl=_gd();_goto(965); // JP C,nn (2)
-        case  965: _goto(966); // JP C,nn (3)
-        case  966: _wait();_mread(cpu->pc++);_goto(967); // JP C,nn (4)
-        case  967: cpu->wzh=_gd();if(_cc_c){cpu->pc=cpu->wz;};_goto(968); // JP C,nn (5)
-        case  968: _fetch(); // JP C,nn (6)
-        case  969: _wait();_mread(cpu->pc++);_goto(970); // IN A,(n) (1)
-        case  970: cpu->wzl=_gd();cpu->wzh=cpu->a;_goto(971); // IN A,(n) (2)
-        case  971: _goto(972); // IN A,(n) (3)
-        case  972: _goto(973); // IN A,(n) (4)
-        case  973: _wait();_ioread(cpu->wz++);_goto(974); // IN A,(n) (5)
-        case  974: cpu->a=_gd();_goto(975); // IN A,(n) (6)
-        case  975: _fetch(); // IN A,(n) (7)
-        case  976: _wait();_mread(cpu->pc++);_goto(977); // CALL C,nn (1)
-        case  977: cpu->wzl=_gd();_goto(978); // CALL C,nn (2)
-        case  978: _goto(979); // CALL C,nn (3)
-        case  979: _wait();_mread(cpu->pc++);_goto(980); // CALL C,nn (4)
-        case  980: cpu->wzh=_gd();if (!_cc_c){_goto(981+7);};_goto(981); // CALL C,nn (5)
-        case  981: _goto(982); // CALL C,nn (6)
-        case  982: _goto(983); // CALL C,nn (7)
-        case  983: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(984); // CALL C,nn (8)
-        case  984: _goto(985); // CALL C,nn (9)
-        case  985: _goto(986); // CALL C,nn (10)
-        case  986: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(987); // CALL C,nn (11)
-        case  987: _goto(988); // CALL C,nn (12)
-        case  988: _fetch(); // CALL C,nn (13)
-        case  989: _wait();_mread(cpu->pc++);_goto(990); // SBC n (1)
-        case  990: cpu->dlatch=_gd();_goto(991); // SBC n (2)
-        case  991: _z80_sbc8(cpu,cpu->dlatch);_fetch(); // SBC n (3)
-        case  992: _goto(993); // RST 18h (1)
-        case  993: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(994); // RST 18h (2)
-        case  994: _goto(995); // RST 18h (3)
-        case  995: _goto(996); // RST 18h (4)
-        case  996: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=0x18;cpu->pc=cpu->wz;_goto(997); // RST 18h (5)
-        case  997: _goto(998); // RST 18h (6)
-        case  998: _fetch(); // RST 18h (7)
-        case  999: _goto(1000); // RET PO (1)
-        case 1000: _wait();_mread(cpu->sp++);_goto(1001); // RET PO (2)
-        case 1001: cpu->wzl=_gd();_goto(1002); // RET PO (3)
-        case 1002: _goto(1003); // RET PO (4)
-        case 1003: _wait();_mread(cpu->sp++);_goto(1004); // RET PO (5)
-        case 1004: cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(1005); // RET PO (6)
-        case 1005: _fetch(); // RET PO (7)
-        case 1006: _wait();_mread(cpu->sp++);_goto(1007); // POP HL (1)
-        case 1007: cpu->hlx[cpu->hlx_idx].l=_gd();_goto(1008); // POP HL (2)
-        case 1008: _goto(1009); // POP HL (3)
-        case 1009: _wait();_mread(cpu->sp++);_goto(1010); // POP HL (4)
-        case 1010: cpu->hlx[cpu->hlx_idx].h=_gd();_goto(1011); // POP HL (5)
-        case 1011: _fetch(); // POP HL (6)
-        case 1012: _wait();_mread(cpu->pc++);_goto(1013); // JP PO,nn (1)
-        case 1013: cpu->wzl=_gd();_goto(1014); // JP PO,nn (2)
-        case 1014: _goto(1015); // JP PO,nn (3)
-        case 1015: _wait();_mread(cpu->pc++);_goto(1016); // JP PO,nn (4)
-        case 1016: cpu->wzh=_gd();if(_cc_po){cpu->pc=cpu->wz;};_goto(1017); // JP PO,nn (5)
-        case 1017: _fetch(); // JP PO,nn (6)
-        case 1018: _wait();_mread(cpu->sp);_goto(1019); // EX (SP),HL (1)
-        case 1019: cpu->wzl=_gd();_goto(1020); // EX (SP),HL (2)
-        case 1020: _goto(1021); // EX (SP),HL (3)
-        case 1021: _wait();_mread(cpu->sp+1);_goto(1022); // EX (SP),HL (4)
-        case 1022: cpu->wzh=_gd();_goto(1023); // EX (SP),HL (5)
-        case 1023: _goto(1024); // EX (SP),HL (6)
-        case 1024: _goto(1025); // EX (SP),HL (7)
-        case 1025: _wait();_mwrite(cpu->sp+1,cpu->hlx[cpu->hlx_idx].h);_goto(1026); // EX (SP),HL (8)
-        case 1026: _goto(1027); // EX (SP),HL (9)
-        case 1027: _goto(1028); // EX (SP),HL (10)
-        case 1028: _wait();_mwrite(cpu->sp,cpu->hlx[cpu->hlx_idx].l);cpu->hlx[cpu->hlx_idx].hl=cpu->wz;_goto(1029); // EX (SP),HL (11)
-        case 1029: _goto(1030); // EX (SP),HL (12)
-        case 1030: _goto(1031); // EX (SP),HL (13)
-        case 1031: _goto(1032); // EX (SP),HL (14)
-        case 1032: _fetch(); // EX (SP),HL (15)
-        case 1033: _wait();_mread(cpu->pc++);_goto(1034); // CALL PO,nn (1)
-        case 1034: cpu->wzl=_gd();_goto(1035); // CALL PO,nn (2)
-        case 1035: _goto(1036); // CALL PO,nn (3)
-        case 1036: _wait();_mread(cpu->pc++);_goto(1037); // CALL PO,nn (4)
-        case 1037: cpu->wzh=_gd();if (!_cc_po){_goto(1038+7);};_goto(1038); // CALL PO,nn (5)
-        case 1038: _goto(1039); // CALL PO,nn (6)
-        case 1039: _goto(1040); // CALL PO,nn (7)
-        case 1040: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1041); // CALL PO,nn (8)
-        case 1041: _goto(1042); // CALL PO,nn (9)
-        case 1042: _goto(1043); // CALL PO,nn (10)
-        case 1043: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(1044); // CALL PO,nn (11)
-        case 1044: _goto(1045); // CALL PO,nn (12)
-        case 1045: _fetch(); // CALL PO,nn (13)
-        case 1046: _goto(1047); // PUSH HL (1)
-        case 1047: _wait();_mwrite(--cpu->sp,cpu->hlx[cpu->hlx_idx].h);_goto(1048); // PUSH HL (2)
-        case 1048: _goto(1049); // PUSH HL (3)
-        case 1049: _goto(1050); // PUSH HL (4)
-        case 1050: _wait();_mwrite(--cpu->sp,cpu->hlx[cpu->hlx_idx].l);_goto(1051); // PUSH HL (5)
-        case 1051: _goto(1052); // PUSH HL (6)
-        case 1052: _fetch(); // PUSH HL (7)
-        case 1053: _wait();_mread(cpu->pc++);_goto(1054); // AND n (1)
-        case 1054: cpu->dlatch=_gd();_goto(1055); // AND n (2)
-        case 1055: _z80_and8(cpu,cpu->dlatch);_fetch(); // AND n (3)
-        case 1056: _goto(1057); // RST 20h (1)
-        case 1057: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1058); // RST 20h (2)
-        case 1058: _goto(1059); // RST 20h (3)
-        case 1059: _goto(1060); // RST 20h (4)
-        case 1060: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=0x20;cpu->pc=cpu->wz;_goto(1061); // RST 20h (5)
-        case 1061: _goto(1062); // RST 20h (6)
-        case 1062: _fetch(); // RST 20h (7)
-        case 1063: _goto(1064); // RET PE (1)
-        case 1064: _wait();_mread(cpu->sp++);_goto(1065); // RET PE (2)
-        case 1065: cpu->wzl=_gd();_goto(1066); // RET PE (3)
-        case 1066: _goto(1067); // RET PE (4)
-        case 1067: _wait();_mread(cpu->sp++);_goto(1068); // RET PE (5)
-        case 1068: cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(1069); // RET PE (6)
-        case 1069: _fetch(); // RET PE (7)
-        case 1070: _wait();_mread(cpu->pc++);_goto(1071); // JP PE,nn (1)
-        case 1071: cpu->wzl=_gd();_goto(1072); // JP PE,nn (2)
-        case 1072: _goto(1073); // JP PE,nn (3)
-        case 1073: _wait();_mread(cpu->pc++);_goto(1074); // JP PE,nn (4)
-        case 1074: cpu->wzh=_gd();if(_cc_pe){cpu->pc=cpu->wz;};_goto(1075); // JP PE,nn (5)
-        case 1075: _fetch(); // JP PE,nn (6)
-        case 1076: _wait();_mread(cpu->pc++);_goto(1077); // CALL PE,nn (1)
-        case 1077: cpu->wzl=_gd();_goto(1078); // CALL PE,nn (2)
-        case 1078: _goto(1079); // CALL PE,nn (3)
-        case 1079: _wait();_mread(cpu->pc++);_goto(1080); // CALL PE,nn (4)
-        case 1080: cpu->wzh=_gd();if (!_cc_pe){_goto(1081+7);};_goto(1081); // CALL PE,nn (5)
-        case 1081: _goto(1082); // CALL PE,nn (6)
-        case 1082: _goto(1083); // CALL PE,nn (7)
-        case 1083: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1084); // CALL PE,nn (8)
-        case 1084: _goto(1085); // CALL PE,nn (9)
-        case 1085: _goto(1086); // CALL PE,nn (10)
-        case 1086: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(1087); // CALL PE,nn (11)
-        case 1087: _goto(1088); // CALL PE,nn (12)
-        case 1088: _fetch(); // CALL PE,nn (13)
-        case 1089: _wait();_mread(cpu->pc++);_goto(1090); // XOR n (1)
-        case 1090: cpu->dlatch=_gd();_goto(1091); // XOR n (2)
-        case 1091: _z80_xor8(cpu,cpu->dlatch);_fetch(); // XOR n (3)
-        case 1092: _goto(1093); // RST 28h (1)
-        case 1093: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1094); // RST 28h (2)
-        case 1094: _goto(1095); // RST 28h (3)
-        case 1095: _goto(1096); // RST 28h (4)
-        case 1096: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=0x28;cpu->pc=cpu->wz;_goto(1097); // RST 28h (5)
-        case 1097: _goto(1098); // RST 28h (6)
-        case 1098: _fetch(); // RST 28h (7)
-        case 1099: _goto(1100); // RET P (1)
-        case 1100: _wait();_mread(cpu->sp++);_goto(1101); // RET P (2)
-        case 1101: cpu->wzl=_gd();_goto(1102); // RET P (3)
-        case 1102: _goto(1103); // RET P (4)
-        case 1103: _wait();_mread(cpu->sp++);_goto(1104); // RET P (5)
-        case 1104: cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(1105); // RET P (6)
-        case 1105: _fetch(); // RET P (7)
-        case 1106: _wait();_mread(cpu->sp++);_goto(1107); // POP AF (1)
-        case 1107: cpu->f=_gd();_goto(1108); // POP AF (2)
-        case 1108: _goto(1109); // POP AF (3)
-        case 1109: _wait();_mread(cpu->sp++);_goto(1110); // POP AF (4)
-        case 1110: cpu->a=_gd();_goto(1111); // POP AF (5)
-        case 1111: _fetch(); // POP AF (6)
-        case 1112: _wait();_mread(cpu->pc++);_goto(1113); // JP P,nn (1)
-        case 1113: cpu->wzl=_gd();_goto(1114); // JP P,nn (2)
-        case 1114: _goto(1115); // JP P,nn (3)
-        case 1115: _wait();_mread(cpu->pc++);_goto(1116); // JP P,nn (4)
-        case 1116: cpu->wzh=_gd();if(_cc_p){cpu->pc=cpu->wz;};_goto(1117); // JP P,nn (5)
-        case 1117: _fetch(); // JP P,nn (6)
-        case 1118: _wait();_mread(cpu->pc++);_goto(1119); // CALL P,nn (1)
-        case 1119: cpu->wzl=_gd();_goto(1120); // CALL P,nn (2)
-        case 1120: _goto(1121); // CALL P,nn (3)
-        case 1121: _wait();_mread(cpu->pc++);_goto(1122); // CALL P,nn (4)
-        case 1122: cpu->wzh=_gd();if (!_cc_p){_goto(1123+7);};_goto(1123); // CALL P,nn (5)
-        case 1123: _goto(1124); // CALL P,nn (6)
-        case 1124: _goto(1125); // CALL P,nn (7)
-        case 1125: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1126); // CALL P,nn (8)
-        case 1126: _goto(1127); // CALL P,nn (9)
-        case 1127: _goto(1128); // CALL P,nn (10)
-        case 1128: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(1129); // CALL P,nn (11)
-        case 1129: _goto(1130); // CALL P,nn (12)
-        case 1130: _fetch(); // CALL P,nn (13)
-        case 1131: _goto(1132); // PUSH AF (1)
-        case 1132: _wait();_mwrite(--cpu->sp,cpu->a);_goto(1133); // PUSH AF (2)
-        case 1133: _goto(1134); // PUSH AF (3)
-        case 1134: _goto(1135); // PUSH AF (4)
-        case 1135: _wait();_mwrite(--cpu->sp,cpu->f);_goto(1136); // PUSH AF (5)
-        case 1136: _goto(1137); // PUSH AF (6)
-        case 1137: _fetch(); // PUSH AF (7)
-        case 1138: _wait();_mread(cpu->pc++);_goto(1139); // OR n (1)
-        case 1139: cpu->dlatch=_gd();_goto(1140); // OR n (2)
-        case 1140: _z80_or8(cpu,cpu->dlatch);_fetch(); // OR n (3)
-        case 1141: _goto(1142); // RST 30h (1)
-        case 1142: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1143); // RST 30h (2)
-        case 1143: _goto(1144); // RST 30h (3)
-        case 1144: _goto(1145); // RST 30h (4)
-        case 1145: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=0x30;cpu->pc=cpu->wz;_goto(1146); // RST 30h (5)
-        case 1146: _goto(1147); // RST 30h (6)
-        case 1147: _fetch(); // RST 30h (7)
-        case 1148: _goto(1149); // RET M (1)
-        case 1149: _wait();_mread(cpu->sp++);_goto(1150); // RET M (2)
-        case 1150: cpu->wzl=_gd();_goto(1151); // RET M (3)
-        case 1151: _goto(1152); // RET M (4)
-        case 1152: _wait();_mread(cpu->sp++);_goto(1153); // RET M (5)
-        case 1153: cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(1154); // RET M (6)
-        case 1154: _fetch(); // RET M (7)
-        case 1155: _goto(1156); // LD SP,HL (1)
-        case 1156: _fetch(); // LD SP,HL (2)
-        case 1157: _wait();_mread(cpu->pc++);_goto(1158); // JP M,nn (1)
-        case 1158: cpu->wzl=_gd();_goto(1159); // JP M,nn (2)
-        case 1159: _goto(1160); // JP M,nn (3)
-        case 1160: _wait();_mread(cpu->pc++);_goto(1161); // JP M,nn (4)
-        case 1161: cpu->wzh=_gd();if(_cc_m){cpu->pc=cpu->wz;};_goto(1162); // JP M,nn (5)
-        case 1162: _fetch(); // JP M,nn (6)
-        case 1163: _wait();_mread(cpu->pc++);_goto(1164); // CALL M,nn (1)
-        case 1164: cpu->wzl=_gd();_goto(1165); // CALL M,nn (2)
-        case 1165: _goto(1166); // CALL M,nn (3)
-        case 1166: _wait();_mread(cpu->pc++);_goto(1167); // CALL M,nn (4)
-        case 1167: cpu->wzh=_gd();if (!_cc_m){_goto(1168+7);};_goto(1168); // CALL M,nn (5)
-        case 1168: _goto(1169); // CALL M,nn (6)
-        case 1169: _goto(1170); // CALL M,nn (7)
-        case 1170: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1171); // CALL M,nn (8)
-        case 1171: _goto(1172); // CALL M,nn (9)
-        case 1172: _goto(1173); // CALL M,nn (10)
-        case 1173: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(1174); // CALL M,nn (11)
-        case 1174: _goto(1175); // CALL M,nn (12)
-        case 1175: _fetch(); // CALL M,nn (13)
-        case 1176: _wait();_mread(cpu->pc++);_goto(1177); // CP n (1)
-        case 1177: cpu->dlatch=_gd();_goto(1178); // CP n (2)
-        case 1178: _z80_cp8(cpu,cpu->dlatch);_fetch(); // CP n (3)
-        case 1179: _goto(1180); // RST 38h (1)
-        case 1180: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1181); // RST 38h (2)
-        case 1181: _goto(1182); // RST 38h (3)
-        case 1182: _goto(1183); // RST 38h (4)
-        case 1183: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=0x38;cpu->pc=cpu->wz;_goto(1184); // RST 38h (5)
-        case 1184: _goto(1185); // RST 38h (6)
-        case 1185: _fetch(); // RST 38h (7)
-        case 1186: _goto(1187); // IN B,(C) (1)
-        case 1187: _wait();_ioread(cpu->bc);_goto(1188); // IN B,(C) (2)
-        case 1188: cpu->dlatch=_gd();cpu->wz=cpu->bc+1;_goto(1189); // IN B,(C) (3)
-        case 1189: cpu->b=_z80_in(cpu,cpu->dlatch);_fetch(); // IN B,(C) (4)
-        case 1190: _iowrite(cpu->bc,cpu->b);_goto(1191); // OUT (C),B (1)
-        case 1191: _wait();cpu->wz=cpu->bc+1;_goto(1192); // OUT (C),B (2)
-        case 1192: _goto(1193); // OUT (C),B (3)
-        case 1193: _fetch(); // OUT (C),B (4)
-        case 1194: _goto(1195); // SBC HL,BC (1)
-        case 1195: _goto(1196); // SBC HL,BC (2)
-        case 1196: _goto(1197); // SBC HL,BC (3)
-        case 1197: _goto(1198); // SBC HL,BC (4)
-        case 1198: _goto(1199); // SBC HL,BC (5)
-        case 1199: _goto(1200); // SBC HL,BC (6)
-        case 1200: _fetch(); // SBC HL,BC (7)
-        case 1201: _wait();_mread(cpu->pc++);_goto(1202); // LD (nn),BC (1)
-        case 1202: cpu->wzl=_gd();_goto(1203); // LD (nn),BC (2)
-        case 1203: _goto(1204); // LD (nn),BC (3)
-        case 1204: _wait();_mread(cpu->pc++);_goto(1205); // LD (nn),BC (4)
-        case 1205: cpu->wzh=_gd();_goto(1206); // LD (nn),BC (5)
-        case 1206: _goto(1207); // LD (nn),BC (6)
-        case 1207: _wait();_mwrite(cpu->wz++,cpu->c);_goto(1208); // LD (nn),BC (7)
-        case 1208: _goto(1209); // LD (nn),BC (8)
-        case 1209: _goto(1210); // LD (nn),BC (9)
-        case 1210: _wait();_mwrite(cpu->wz,cpu->b);_goto(1211); // LD (nn),BC (10)
-        case 1211: _goto(1212); // LD (nn),BC (11)
-        case 1212: _fetch(); // LD (nn),BC (12)
-        case 1213: _wait();_mread(cpu->sp++);_goto(1214); // RETN (1)
-        case 1214: cpu->wzl=_gd();_goto(1215); // RETN (2)
-        case 1215: _goto(1216); // RETN (3)
-        case 1216: _wait();_mread(cpu->sp++);_goto(1217); // RETN (4)
-        case 1217: cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(1218); // RETN (5)
-        case 1218: pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2;goto step_to; // RETN (6)
-        case 1219: cpu->i=cpu->a;_fetch(); // LD I,A (1)
-        case 1220: _goto(1221); // IN C,(C) (1)
-        case 1221: _wait();_ioread(cpu->bc);_goto(1222); // IN C,(C) (2)
-        case 1222: cpu->dlatch=_gd();cpu->wz=cpu->bc+1;_goto(1223); // IN C,(C) (3)
-        case 1223: cpu->c=_z80_in(cpu,cpu->dlatch);_fetch(); // IN C,(C) (4)
-        case 1224: _iowrite(cpu->bc,cpu->c);_goto(1225); // OUT (C),C (1)
-        case 1225: _wait();cpu->wz=cpu->bc+1;_goto(1226); // OUT (C),C (2)
-        case 1226: _goto(1227); // OUT (C),C (3)
-        case 1227: _fetch(); // OUT (C),C (4)
-        case 1228: _goto(1229); // ADC HL,BC (1)
-        case 1229: _goto(1230); // ADC HL,BC (2)
-        case 1230: _goto(1231); // ADC HL,BC (3)
-        case 1231: _goto(1232); // ADC HL,BC (4)
-        case 1232: _goto(1233); // ADC HL,BC (5)
-        case 1233: _goto(1234); // ADC HL,BC (6)
-        case 1234: _fetch(); // ADC HL,BC (7)
-        case 1235: _wait();_mread(cpu->pc++);_goto(1236); // LD BC,(nn) (1)
-        case 1236: cpu->wzl=_gd();_goto(1237); // LD BC,(nn) (2)
-        case 1237: _goto(1238); // LD BC,(nn) (3)
-        case 1238: _wait();_mread(cpu->pc++);_goto(1239); // LD BC,(nn) (4)
-        case 1239: cpu->wzh=_gd();_goto(1240); // LD BC,(nn) (5)
-        case 1240: _goto(1241); // LD BC,(nn) (6)
-        case 1241: _wait();_mread(cpu->wz++);_goto(1242); // LD BC,(nn) (7)
-        case 1242: cpu->c=_gd();_goto(1243); // LD BC,(nn) (8)
-        case 1243: _goto(1244); // LD BC,(nn) (9)
-        case 1244: _wait();_mread(cpu->wz);_goto(1245); // LD BC,(nn) (10)
-        case 1245: cpu->b=_gd();_goto(1246); // LD BC,(nn) (11)
-        case 1246: _fetch(); // LD BC,(nn) (12)
-        case 1247: _wait();_mread(cpu->sp++);_goto(1248); // RETI (1)
-        case 1248: cpu->wzl=_gd();pins|=Z80_RETI;_goto(1249); // RETI (2)
-        case 1249: _goto(1250); // RETI (3)
-        case 1250: _wait();_mread(cpu->sp++);_goto(1251); // RETI (4)
-        case 1251: cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(1252); // RETI (5)
-        case 1252: pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2;goto step_to; // RETI (6)
-        case 1253: cpu->r=cpu->a;_fetch(); // LD R,A (1)
-        case 1254: _goto(1255); // IN D,(C) (1)
-        case 1255: _wait();_ioread(cpu->bc);_goto(1256); // IN D,(C) (2)
-        case 1256: cpu->dlatch=_gd();cpu->wz=cpu->bc+1;_goto(1257); // IN D,(C) (3)
-        case 1257: cpu->d=_z80_in(cpu,cpu->dlatch);_fetch(); // IN D,(C) (4)
-        case 1258: _iowrite(cpu->bc,cpu->d);_goto(1259); // OUT (C),D (1)
-        case 1259: _wait();cpu->wz=cpu->bc+1;_goto(1260); // OUT (C),D (2)
-        case 1260: _goto(1261); // OUT (C),D (3)
-        case 1261: _fetch(); // OUT (C),D (4)
-        case 1262: _goto(1263); // SBC HL,DE (1)
-        case 1263: _goto(1264); // SBC HL,DE (2)
-        case 1264: _goto(1265); // SBC HL,DE (3)
-        case 1265: _goto(1266); // SBC HL,DE (4)
-        case 1266: _goto(1267); // SBC HL,DE (5)
-        case 1267: _goto(1268); // SBC HL,DE (6)
-        case 1268: _fetch(); // SBC HL,DE (7)
-        case 1269: _wait();_mread(cpu->pc++);_goto(1270); // LD (nn),DE (1)
-        case 1270: cpu->wzl=_gd();_goto(1271); // LD (nn),DE (2)
-        case 1271: _goto(1272); // LD (nn),DE (3)
-        case 1272: _wait();_mread(cpu->pc++);_goto(1273); // LD (nn),DE (4)
-        case 1273: cpu->wzh=_gd();_goto(1274); // LD (nn),DE (5)
-        case 1274: _goto(1275); // LD (nn),DE (6)
-        case 1275: _wait();_mwrite(cpu->wz++,cpu->e);_goto(1276); // LD (nn),DE (7)
-        case 1276: _goto(1277); // LD (nn),DE (8)
-        case 1277: _goto(1278); // LD (nn),DE (9)
-        case 1278: _wait();_mwrite(cpu->wz,cpu->d);_goto(1279); // LD (nn),DE (10)
-        case 1279: _goto(1280); // LD (nn),DE (11)
-        case 1280: _fetch(); // LD (nn),DE (12)
-        case 1281: pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2;goto step_to; // RETI (6)
-        case 1282: cpu->a=cpu->i;cpu->f=_z80_sziff2_flags(cpu, cpu->i);_fetch(); // LD A,I (1)
-        case 1283: _goto(1284); // IN E,(C) (1)
-        case 1284: _wait();_ioread(cpu->bc);_goto(1285); // IN E,(C) (2)
-        case 1285: cpu->dlatch=_gd();cpu->wz=cpu->bc+1;_goto(1286); // IN E,(C) (3)
-        case 1286: cpu->e=_z80_in(cpu,cpu->dlatch);_fetch(); // IN E,(C) (4)
-        case 1287: _iowrite(cpu->bc,cpu->e);_goto(1288); // OUT (C),E (1)
-        case 1288: _wait();cpu->wz=cpu->bc+1;_goto(1289); // OUT (C),E (2)
-        case 1289: _goto(1290); // OUT (C),E (3)
-        case 1290: _fetch(); // OUT (C),E (4)
-        case 1291: _goto(1292); // ADC HL,DE (1)
-        case 1292: _goto(1293); // ADC HL,DE (2)
-        case 1293: _goto(1294); // ADC HL,DE (3)
-        case 1294: _goto(1295); // ADC HL,DE (4)
-        case 1295: _goto(1296); // ADC HL,DE (5)
-        case 1296: _goto(1297); // ADC HL,DE (6)
-        case 1297: _fetch(); // ADC HL,DE (7)
-        case 1298: _wait();_mread(cpu->pc++);_goto(1299); // LD DE,(nn) (1)
-        case 1299: cpu->wzl=_gd();_goto(1300); // LD DE,(nn) (2)
-        case 1300: _goto(1301); // LD DE,(nn) (3)
-        case 1301: _wait();_mread(cpu->pc++);_goto(1302); // LD DE,(nn) (4)
-        case 1302: cpu->wzh=_gd();_goto(1303); // LD DE,(nn) (5)
-        case 1303: _goto(1304); // LD DE,(nn) (6)
-        case 1304: _wait();_mread(cpu->wz++);_goto(1305); // LD DE,(nn) (7)
-        case 1305: cpu->e=_gd();_goto(1306); // LD DE,(nn) (8)
-        case 1306: _goto(1307); // LD DE,(nn) (9)
-        case 1307: _wait();_mread(cpu->wz);_goto(1308); // LD DE,(nn) (10)
-        case 1308: cpu->d=_gd();_goto(1309); // LD DE,(nn) (11)
-        case 1309: _fetch(); // LD DE,(nn) (12)
-        case 1310: pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2;goto step_to; // RETI (6)
-        case 1311: cpu->a=cpu->r;cpu->f=_z80_sziff2_flags(cpu, cpu->r);_fetch(); // LD A,R (1)
-        case 1312: _goto(1313); // IN H,(C) (1)
-        case 1313: _wait();_ioread(cpu->bc);_goto(1314); // IN H,(C) (2)
-        case 1314: cpu->dlatch=_gd();cpu->wz=cpu->bc+1;_goto(1315); // IN H,(C) (3)
-        case 1315: cpu->h=_z80_in(cpu,cpu->dlatch);_fetch(); // IN H,(C) (4)
-        case 1316: _iowrite(cpu->bc,cpu->h);_goto(1317); // OUT (C),H (1)
-        case 1317: _wait();cpu->wz=cpu->bc+1;_goto(1318); // OUT (C),H (2)
-        case 1318: _goto(1319); // OUT (C),H (3)
-        case 1319: _fetch(); // OUT (C),H (4)
-        case 1320: _goto(1321); // SBC HL,HL (1)
-        case 1321: _goto(1322); // SBC HL,HL (2)
-        case 1322: _goto(1323); // SBC HL,HL (3)
-        case 1323: _goto(1324); // SBC HL,HL (4)
-        case 1324: _goto(1325); // SBC HL,HL (5)
-        case 1325: _goto(1326); // SBC HL,HL (6)
-        case 1326: _fetch(); // SBC HL,HL (7)
-        case 1327: _wait();_mread(cpu->pc++);_goto(1328); // LD (nn),HL (1)
-        case 1328: cpu->wzl=_gd();_goto(1329); // LD (nn),HL (2)
-        case 1329: _goto(1330); // LD (nn),HL (3)
-        case 1330: _wait();_mread(cpu->pc++);_goto(1331); // LD (nn),HL (4)
-        case 1331: cpu->wzh=_gd();_goto(1332); // LD (nn),HL (5)
-        case 1332: _goto(1333); // LD (nn),HL (6)
-        case 1333: _wait();_mwrite(cpu->wz++,cpu->l);_goto(1334); // LD (nn),HL (7)
-        case 1334: _goto(1335); // LD (nn),HL (8)
-        case 1335: _goto(1336); // LD (nn),HL (9)
-        case 1336: _wait();_mwrite(cpu->wz,cpu->h);_goto(1337); // LD (nn),HL (10)
-        case 1337: _goto(1338); // LD (nn),HL (11)
-        case 1338: _fetch(); // LD (nn),HL (12)
-        case 1339: pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2;goto step_to; // RETI (6)
-        case 1340: _wait();_mread(cpu->hl);_goto(1341); // RRD (1)
-        case 1341: cpu->dlatch=_gd();_goto(1342); // RRD (2)
-        case 1342: cpu->dlatch=_z80_rrd(cpu,cpu->dlatch);_goto(1343); // RRD (3)
-        case 1343: _goto(1344); // RRD (4)
-        case 1344: _goto(1345); // RRD (5)
-        case 1345: _goto(1346); // RRD (6)
-        case 1346: _goto(1347); // RRD (7)
-        case 1347: _wait();_mwrite(cpu->hl,cpu->dlatch);cpu->wz=cpu->hl+1;_goto(1348); // RRD (8)
-        case 1348: _goto(1349); // RRD (9)
-        case 1349: _fetch(); // RRD (10)
-        case 1350: _goto(1351); // IN L,(C) (1)
-        case 1351: _wait();_ioread(cpu->bc);_goto(1352); // IN L,(C) (2)
-        case 1352: cpu->dlatch=_gd();cpu->wz=cpu->bc+1;_goto(1353); // IN L,(C) (3)
-        case 1353: cpu->l=_z80_in(cpu,cpu->dlatch);_fetch(); // IN L,(C) (4)
-        case 1354: _iowrite(cpu->bc,cpu->l);_goto(1355); // OUT (C),L (1)
-        case 1355: _wait();cpu->wz=cpu->bc+1;_goto(1356); // OUT (C),L (2)
-        case 1356: _goto(1357); // OUT (C),L (3)
-        case 1357: _fetch(); // OUT (C),L (4)
-        case 1358: _goto(1359); // ADC HL,HL (1)
-        case 1359: _goto(1360); // ADC HL,HL (2)
-        case 1360: _goto(1361); // ADC HL,HL (3)
-        case 1361: _goto(1362); // ADC HL,HL (4)
-        case 1362: _goto(1363); // ADC HL,HL (5)
-        case 1363: _goto(1364); // ADC HL,HL (6)
-        case 1364: _fetch(); // ADC HL,HL (7)
-        case 1365: _wait();_mread(cpu->pc++);_goto(1366); // LD HL,(nn) (1)
-        case 1366: cpu->wzl=_gd();_goto(1367); // LD HL,(nn) (2)
-        case 1367: _goto(1368); // LD HL,(nn) (3)
-        case 1368: _wait();_mread(cpu->pc++);_goto(1369); // LD HL,(nn) (4)
-        case 1369: cpu->wzh=_gd();_goto(1370); // LD HL,(nn) (5)
-        case 1370: _goto(1371); // LD HL,(nn) (6)
-        case 1371: _wait();_mread(cpu->wz++);_goto(1372); // LD HL,(nn) (7)
-        case 1372: cpu->l=_gd();_goto(1373); // LD HL,(nn) (8)
-        case 1373: _goto(1374); // LD HL,(nn) (9)
-        case 1374: _wait();_mread(cpu->wz);_goto(1375); // LD HL,(nn) (10)
-        case 1375: cpu->h=_gd();_goto(1376); // LD HL,(nn) (11)
-        case 1376: _fetch(); // LD HL,(nn) (12)
-        case 1377: pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2;goto step_to; // RETI (6)
-        case 1378: _wait();_mread(cpu->hl);_goto(1379); // RLD (1)
-        case 1379: cpu->dlatch=_gd();_goto(1380); // RLD (2)
-        case 1380: cpu->dlatch=_z80_rld(cpu,cpu->dlatch);_goto(1381); // RLD (3)
-        case 1381: _goto(1382); // RLD (4)
-        case 1382: _goto(1383); // RLD (5)
-        case 1383: _goto(1384); // RLD (6)
-        case 1384: _goto(1385); // RLD (7)
-        case 1385: _wait();_mwrite(cpu->hl,cpu->dlatch);cpu->wz=cpu->hl+1;_goto(1386); // RLD (8)
-        case 1386: _goto(1387); // RLD (9)
-        case 1387: _fetch(); // RLD (10)
-        case 1388: _goto(1389); // IN (C) (1)
-        case 1389: _wait();_ioread(cpu->bc);_goto(1390); // IN (C) (2)
-        case 1390: cpu->dlatch=_gd();cpu->wz=cpu->bc+1;_goto(1391); // IN (C) (3)
-        case 1391: _z80_in(cpu,cpu->dlatch);_fetch(); // IN (C) (4)
-        case 1392: _iowrite(cpu->bc,0);_goto(1393); // OUT (C),0 (1)
-        case 1393: _wait();cpu->wz=cpu->bc+1;_goto(1394); // OUT (C),0 (2)
-        case 1394: _goto(1395); // OUT (C),0 (3)
-        case 1395: _fetch(); // OUT (C),0 (4)
-        case 1396: _goto(1397); // SBC HL,SP (1)
-        case 1397: _goto(1398); // SBC HL,SP (2)
-        case 1398: _goto(1399); // SBC HL,SP (3)
-        case 1399: _goto(1400); // SBC HL,SP (4)
-        case 1400: _goto(1401); // SBC HL,SP (5)
-        case 1401: _goto(1402); // SBC HL,SP (6)
-        case 1402: _fetch(); // SBC HL,SP (7)
-        case 1403: _wait();_mread(cpu->pc++);_goto(1404); // LD (nn),SP (1)
-        case 1404: cpu->wzl=_gd();_goto(1405); // LD (nn),SP (2)
-        case 1405: _goto(1406); // LD (nn),SP (3)
-        case 1406: _wait();_mread(cpu->pc++);_goto(1407); // LD (nn),SP (4)
-        case 1407: cpu->wzh=_gd();_goto(1408); // LD (nn),SP (5)
-        case 1408: _goto(1409); // LD (nn),SP (6)
-        case 1409: _wait();_mwrite(cpu->wz++,cpu->spl);_goto(1410); // LD (nn),SP (7)
-        case 1410: _goto(1411); // LD (nn),SP (8)
-        case 1411: _goto(1412); // LD (nn),SP (9)
-        case 1412: _wait();_mwrite(cpu->wz,cpu->sph);_goto(1413); // LD (nn),SP (10)
-        case 1413: _goto(1414); // LD (nn),SP (11)
-        case 1414: _fetch(); // LD (nn),SP (12)
-        case 1415: pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2;goto step_to; // RETI (6)
-        case 1416: _goto(1417); // IN A,(C) (1)
-        case 1417: _wait();_ioread(cpu->bc);_goto(1418); // IN A,(C) (2)
-        case 1418: cpu->dlatch=_gd();cpu->wz=cpu->bc+1;_goto(1419); // IN A,(C) (3)
-        case 1419: cpu->a=_z80_in(cpu,cpu->dlatch);_fetch(); // IN A,(C) (4)
-        case 1420: _iowrite(cpu->bc,cpu->a);_goto(1421); // OUT (C),A (1)
-        case 1421: _wait();cpu->wz=cpu->bc+1;_goto(1422); // OUT (C),A (2)
-        case 1422: _goto(1423); // OUT (C),A (3)
-        case 1423: _fetch(); // OUT (C),A (4)
-        case 1424: _goto(1425); // ADC HL,SP (1)
-        case 1425: _goto(1426); // ADC HL,SP (2)
-        case 1426: _goto(1427); // ADC HL,SP (3)
-        case 1427: _goto(1428); // ADC HL,SP (4)
-        case 1428: _goto(1429); // ADC HL,SP (5)
-        case 1429: _goto(1430); // ADC HL,SP (6)
-        case 1430: _fetch(); // ADC HL,SP (7)
-        case 1431: _wait();_mread(cpu->pc++);_goto(1432); // LD SP,(nn) (1)
-        case 1432: cpu->wzl=_gd();_goto(1433); // LD SP,(nn) (2)
-        case 1433: _goto(1434); // LD SP,(nn) (3)
-        case 1434: _wait();_mread(cpu->pc++);_goto(1435); // LD SP,(nn) (4)
-        case 1435: cpu->wzh=_gd();_goto(1436); // LD SP,(nn) (5)
-        case 1436: _goto(1437); // LD SP,(nn) (6)
-        case 1437: _wait();_mread(cpu->wz++);_goto(1438); // LD SP,(nn) (7)
-        case 1438: cpu->spl=_gd();_goto(1439); // LD SP,(nn) (8)
-        case 1439: _goto(1440); // LD SP,(nn) (9)
-        case 1440: _wait();_mread(cpu->wz);_goto(1441); // LD SP,(nn) (10)
-        case 1441: cpu->sph=_gd();_goto(1442); // LD SP,(nn) (11)
-        case 1442: _fetch(); // LD SP,(nn) (12)
-        case 1443: pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2;goto step_to; // RETI (6)
-        case 1444: _wait();_mread(cpu->hl++);_goto(1445); // LDI (1)
-        case 1445: cpu->dlatch=_gd();_goto(1446); // LDI (2)
-        case 1446: _goto(1447); // LDI (3)
-        case 1447: _wait();_mwrite(cpu->de++,cpu->dlatch);_goto(1448); // LDI (4)
-        case 1448: _goto(1449); // LDI (5)
-        case 1449: _z80_ldi_ldd(cpu,cpu->dlatch);_goto(1450); // LDI (6)
-        case 1450: _goto(1451); // LDI (7)
-        case 1451: _fetch(); // LDI (8)
-        case 1452: _wait();_mread(cpu->hl++);_goto(1453); // CPI (1)
-        case 1453: cpu->dlatch=_gd();_goto(1454); // CPI (2)
-        case 1454: cpu->wz++;_z80_cpi_cpd(cpu,cpu->dlatch);_goto(1455); // CPI (3)
-        case 1455: _goto(1456); // CPI (4)
-        case 1456: _goto(1457); // CPI (5)
-        case 1457: _goto(1458); // CPI (6)
-        case 1458: _goto(1459); // CPI (7)
-        case 1459: _fetch(); // CPI (8)
-        case 1460: _goto(1461); // INI (1)
-        case 1461: _goto(1462); // INI (2)
-        case 1462: _wait();_ioread(cpu->bc);_goto(1463); // INI (3)
-        case 1463: cpu->dlatch=_gd();cpu->wz=cpu->bc+1;cpu->b--;;_goto(1464); // INI (4)
-        case 1464: _goto(1465); // INI (5)
-        case 1465: _wait();_mwrite(cpu->hl++,cpu->dlatch);_z80_ini_ind(cpu,cpu->dlatch,cpu->c+1);_goto(1466); // INI (6)
-        case 1466: _goto(1467); // INI (7)
-        case 1467: _fetch(); // INI (8)
-        case 1468: _goto(1469); // OUTI (1)
-        case 1469: _wait();_mread(cpu->hl++);_goto(1470); // OUTI (2)
-        case 1470: cpu->dlatch=_gd();cpu->b--;_goto(1471); // OUTI (3)
-        case 1471: _goto(1472); // OUTI (4)
-        case 1472: _iowrite(cpu->bc,cpu->dlatch);_goto(1473); // OUTI (5)
-        case 1473: _wait();cpu->wz=cpu->bc+1;_z80_outi_outd(cpu,cpu->dlatch);_goto(1474); // OUTI (6)
-        case 1474: _goto(1475); // OUTI (7)
-        case 1475: _fetch(); // OUTI (8)
-        case 1476: _wait();_mread(cpu->hl--);_goto(1477); // LDD (1)
-        case 1477: cpu->dlatch=_gd();_goto(1478); // LDD (2)
-        case 1478: _goto(1479); // LDD (3)
-        case 1479: _wait();_mwrite(cpu->de--,cpu->dlatch);_goto(1480); // LDD (4)
-        case 1480: _goto(1481); // LDD (5)
-        case 1481: _z80_ldi_ldd(cpu,cpu->dlatch);_goto(1482); // LDD (6)
-        case 1482: _goto(1483); // LDD (7)
-        case 1483: _fetch(); // LDD (8)
-        case 1484: _wait();_mread(cpu->hl--);_goto(1485); // CPD (1)
-        case 1485: cpu->dlatch=_gd();_goto(1486); // CPD (2)
-        case 1486: cpu->wz--;_z80_cpi_cpd(cpu,cpu->dlatch);_goto(1487); // CPD (3)
-        case 1487: _goto(1488); // CPD (4)
-        case 1488: _goto(1489); // CPD (5)
-        case 1489: _goto(1490); // CPD (6)
-        case 1490: _goto(1491); // CPD (7)
-        case 1491: _fetch(); // CPD (8)
-        case 1492: _goto(1493); // IND (1)
-        case 1493: _goto(1494); // IND (2)
-        case 1494: _wait();_ioread(cpu->bc);_goto(1495); // IND (3)
-        case 1495: cpu->dlatch=_gd();cpu->wz=cpu->bc-1;cpu->b--;;_goto(1496); // IND (4)
-        case 1496: _goto(1497); // IND (5)
-        case 1497: _wait();_mwrite(cpu->hl--,cpu->dlatch);_z80_ini_ind(cpu,cpu->dlatch,cpu->c-1);_goto(1498); // IND (6)
-        case 1498: _goto(1499); // IND (7)
-        case 1499: _fetch(); // IND (8)
-        case 1500: _goto(1501); // OUTD (1)
-        case 1501: _wait();_mread(cpu->hl--);_goto(1502); // OUTD (2)
-        case 1502: cpu->dlatch=_gd();cpu->b--;_goto(1503); // OUTD (3)
-        case 1503: _goto(1504); // OUTD (4)
-        case 1504: _iowrite(cpu->bc,cpu->dlatch);_goto(1505); // OUTD (5)
-        case 1505: _wait();cpu->wz=cpu->bc-1;_z80_outi_outd(cpu,cpu->dlatch);_goto(1506); // OUTD (6)
-        case 1506: _goto(1507); // OUTD (7)
-        case 1507: _fetch(); // OUTD (8)
-        case 1508: _wait();_mread(cpu->hl++);_goto(1509); // LDIR (1)
-        case 1509: cpu->dlatch=_gd();_goto(1510); // LDIR (2)
-        case 1510: _goto(1511); // LDIR (3)
-        case 1511: _wait();_mwrite(cpu->de++,cpu->dlatch);_goto(1512); // LDIR (4)
-        case 1512: _goto(1513); // LDIR (5)
-        case 1513: if(!_z80_ldi_ldd(cpu,cpu->dlatch)){_goto(1514+5);};_goto(1514); // LDIR (6)
-        case 1514: _goto(1515); // LDIR (7)
-        case 1515: cpu->wz=--cpu->pc;--cpu->pc;;_goto(1516); // LDIR (8)
-        case 1516: _goto(1517); // LDIR (9)
-        case 1517: _goto(1518); // LDIR (10)
-        case 1518: _goto(1519); // LDIR (11)
-        case 1519: _goto(1520); // LDIR (12)
-        case 1520: _fetch(); // LDIR (13)
-        case 1521: _wait();_mread(cpu->hl++);_goto(1522); // CPIR (1)
-        case 1522: cpu->dlatch=_gd();_goto(1523); // CPIR (2)
-        case 1523: cpu->wz++;if(!_z80_cpi_cpd(cpu,cpu->dlatch)){_goto(1524+5);};_goto(1524); // CPIR (3)
-        case 1524: _goto(1525); // CPIR (4)
-        case 1525: _goto(1526); // CPIR (5)
-        case 1526: _goto(1527); // CPIR (6)
-        case 1527: _goto(1528); // CPIR (7)
-        case 1528: cpu->wz=--cpu->pc;--cpu->pc;_goto(1529); // CPIR (8)
-        case 1529: _goto(1530); // CPIR (9)
-        case 1530: _goto(1531); // CPIR (10)
-        case 1531: _goto(1532); // CPIR (11)
-        case 1532: _goto(1533); // CPIR (12)
-        case 1533: _fetch(); // CPIR (13)
-        case 1534: _goto(1535); // INIR (1)
-        case 1535: _goto(1536); // INIR (2)
-        case 1536: _wait();_ioread(cpu->bc);_goto(1537); // INIR (3)
-        case 1537: cpu->dlatch=_gd();cpu->wz=cpu->bc+1;cpu->b--;;_goto(1538); // INIR (4)
-        case 1538: _goto(1539); // INIR (5)
-        case 1539: _wait();_mwrite(cpu->hl++,cpu->dlatch);if (!_z80_ini_ind(cpu,cpu->dlatch,cpu->c+1)){_goto(1540+5);};_goto(1540); // INIR (6)
-        case 1540: _goto(1541); // INIR (7)
-        case 1541: cpu->wz=--cpu->pc;--cpu->pc;_goto(1542); // INIR (8)
-        case 1542: _goto(1543); // INIR (9)
-        case 1543: _goto(1544); // INIR (10)
-        case 1544: _goto(1545); // INIR (11)
-        case 1545: _goto(1546); // INIR (12)
-        case 1546: _fetch(); // INIR (13)
-        case 1547: _goto(1548); // OTIR (1)
-        case 1548: _wait();_mread(cpu->hl++);_goto(1549); // OTIR (2)
-        case 1549: cpu->dlatch=_gd();cpu->b--;_goto(1550); // OTIR (3)
-        case 1550: _goto(1551); // OTIR (4)
-        case 1551: _iowrite(cpu->bc,cpu->dlatch);_goto(1552); // OTIR (5)
-        case 1552: _wait();cpu->wz=cpu->bc+1;if(!_z80_outi_outd(cpu,cpu->dlatch)){_goto(1553+5);};_goto(1553); // OTIR (6)
-        case 1553: _goto(1554); // OTIR (7)
-        case 1554: cpu->wz=--cpu->pc;--cpu->pc;_goto(1555); // OTIR (8)
-        case 1555: _goto(1556); // OTIR (9)
-        case 1556: _goto(1557); // OTIR (10)
-        case 1557: _goto(1558); // OTIR (11)
-        case 1558: _goto(1559); // OTIR (12)
-        case 1559: _fetch(); // OTIR (13)
-        case 1560: _wait();_mread(cpu->hl--);_goto(1561); // LDDR (1)
-        case 1561: cpu->dlatch=_gd();_goto(1562); // LDDR (2)
-        case 1562: _goto(1563); // LDDR (3)
-        case 1563: _wait();_mwrite(cpu->de--,cpu->dlatch);_goto(1564); // LDDR (4)
-        case 1564: _goto(1565); // LDDR (5)
-        case 1565: if(!_z80_ldi_ldd(cpu,cpu->dlatch)){_goto(1566+5);};_goto(1566); // LDDR (6)
-        case 1566: _goto(1567); // LDDR (7)
-        case 1567: cpu->wz=--cpu->pc;--cpu->pc;;_goto(1568); // LDDR (8)
-        case 1568: _goto(1569); // LDDR (9)
-        case 1569: _goto(1570); // LDDR (10)
-        case 1570: _goto(1571); // LDDR (11)
-        case 1571: _goto(1572); // LDDR (12)
-        case 1572: _fetch(); // LDDR (13)
-        case 1573: _wait();_mread(cpu->hl--);_goto(1574); // CPDR (1)
-        case 1574: cpu->dlatch=_gd();_goto(1575); // CPDR (2)
-        case 1575: cpu->wz--;if(!_z80_cpi_cpd(cpu,cpu->dlatch)){_goto(1576+5);};_goto(1576); // CPDR (3)
-        case 1576: _goto(1577); // CPDR (4)
-        case 1577: _goto(1578); // CPDR (5)
-        case 1578: _goto(1579); // CPDR (6)
-        case 1579: _goto(1580); // CPDR (7)
-        case 1580: cpu->wz=--cpu->pc;--cpu->pc;_goto(1581); // CPDR (8)
-        case 1581: _goto(1582); // CPDR (9)
-        case 1582: _goto(1583); // CPDR (10)
-        case 1583: _goto(1584); // CPDR (11)
-        case 1584: _goto(1585); // CPDR (12)
-        case 1585: _fetch(); // CPDR (13)
-        case 1586: _goto(1587); // INDR (1)
-        case 1587: _goto(1588); // INDR (2)
-        case 1588: _wait();_ioread(cpu->bc);_goto(1589); // INDR (3)
-        case 1589: cpu->dlatch=_gd();cpu->wz=cpu->bc-1;cpu->b--;;_goto(1590); // INDR (4)
-        case 1590: _goto(1591); // INDR (5)
-        case 1591: _wait();_mwrite(cpu->hl--,cpu->dlatch);if (!_z80_ini_ind(cpu,cpu->dlatch,cpu->c-1)){_goto(1592+5);};_goto(1592); // INDR (6)
-        case 1592: _goto(1593); // INDR (7)
-        case 1593: cpu->wz=--cpu->pc;--cpu->pc;_goto(1594); // INDR (8)
-        case 1594: _goto(1595); // INDR (9)
-        case 1595: _goto(1596); // INDR (10)
-        case 1596: _goto(1597); // INDR (11)
-        case 1597: _goto(1598); // INDR (12)
-        case 1598: _fetch(); // INDR (13)
-        case 1599: _goto(1600); // OTDR (1)
-        case 1600: _wait();_mread(cpu->hl--);_goto(1601); // OTDR (2)
-        case 1601: cpu->dlatch=_gd();cpu->b--;_goto(1602); // OTDR (3)
-        case 1602: _goto(1603); // OTDR (4)
-        case 1603: _iowrite(cpu->bc,cpu->dlatch);_goto(1604); // OTDR (5)
-        case 1604: _wait();cpu->wz=cpu->bc-1;if(!_z80_outi_outd(cpu,cpu->dlatch)){_goto(1605+5);};_goto(1605); // OTDR (6)
-        case 1605: _goto(1606); // OTDR (7)
-        case 1606: cpu->wz=--cpu->pc;--cpu->pc;_goto(1607); // OTDR (8)
-        case 1607: _goto(1608); // OTDR (9)
-        case 1608: _goto(1609); // OTDR (10)
-        case 1609: _goto(1610); // OTDR (11)
-        case 1610: _goto(1611); // OTDR (12)
-        case 1611: _fetch(); // OTDR (13)
-        case 1612: {uint8_t z=cpu->opcode&7;_z80_cb_action(cpu,z,z);};_fetch(); // cb (0)
-        case 1613: _goto(1614); // cbhl (0)
-        case 1614: _wait();_mread(cpu->hl);_goto(1615); // cbhl (1)
-        case 1615: cpu->dlatch=_gd();if(!_z80_cb_action(cpu,6,6)){_goto(1616+3);};_goto(1616); // cbhl (2)
-        case 1616: _goto(1617); // cbhl (3)
-        case 1617: _goto(1618); // cbhl (4)
-        case 1618: _wait();_mwrite(cpu->hl,cpu->dlatch);_goto(1619); // cbhl (5)
-        case 1619: _goto(1620); // cbhl (6)
-        case 1620: _fetch(); // cbhl (7)
-        case 1621: _wait();_mread(cpu->pc++);_goto(1622); // ddfdcb (0)
-        case 1622: _z80_ddfdcb_addr(cpu,pins);_goto(1623); // ddfdcb (1)
-        case 1623: _goto(1624); // ddfdcb (2)
-        case 1624: _wait();_mread(cpu->pc++);_goto(1625); // ddfdcb (3)
-        case 1625: cpu->opcode=_gd();_goto(1626); // ddfdcb (4)
-        case 1626: _goto(1627); // ddfdcb (5)
-        case 1627: _goto(1628); // ddfdcb (6)
-        case 1628: _goto(1629); // ddfdcb (7)
-        case 1629: _wait();_mread(cpu->addr);_goto(1630); // ddfdcb (8)
-        case 1630: cpu->dlatch=_gd();if(!_z80_cb_action(cpu,6,cpu->opcode&7)){_goto(1631+3);};_goto(1631); // ddfdcb (9)
-        case 1631: _goto(1632); // ddfdcb (10)
-        case 1632: _goto(1633); // ddfdcb (11)
-        case 1633: _wait();_mwrite(cpu->addr,cpu->dlatch);_goto(1634); // ddfdcb (12)
-        case 1634: _goto(1635); // ddfdcb (13)
-        case 1635: _fetch(); // ddfdcb (14)
-        case 1636: cpu->iff1=cpu->iff2=false;_goto(1637); // int_im0 (0)
-        case 1637: pins|=(Z80_M1|Z80_IORQ);_goto(1638); // int_im0 (1)
-        case 1638: _wait();cpu->opcode=_z80_get_db(pins);_goto(1639); // int_im0 (2)
-        case 1639: pins=_z80_refresh(cpu,pins);_goto(1640); // int_im0 (3)
-        case 1640: cpu->addr=cpu->hl;_goto(cpu->opcode);_goto(1641); // int_im0 (4)
-        case 1641: _fetch(); // int_im0 (5)
-        case 1642: cpu->iff1=cpu->iff2=false;_goto(1643); // int_im1 (0)
-        case 1643: pins|=(Z80_M1|Z80_IORQ);_goto(1644); // int_im1 (1)
-        case 1644: _wait();_goto(1645); // int_im1 (2)
-        case 1645: pins=_z80_refresh(cpu,pins);_goto(1646); // int_im1 (3)
-        case 1646: _goto(1647); // int_im1 (4)
-        case 1647: _goto(1648); // int_im1 (5)
-        case 1648: _goto(1649); // int_im1 (6)
-        case 1649: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1650); // int_im1 (7)
-        case 1650: _goto(1651); // int_im1 (8)
-        case 1651: _goto(1652); // int_im1 (9)
-        case 1652: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=cpu->pc=0x0038;_goto(1653); // int_im1 (10)
-        case 1653: _goto(1654); // int_im1 (11)
-        case 1654: _fetch(); // int_im1 (12)
-        case 1655: cpu->iff1=cpu->iff2=false;_goto(1656); // int_im2 (0)
-        case 1656: pins|=(Z80_M1|Z80_IORQ);_goto(1657); // int_im2 (1)
-        case 1657: _wait();cpu->dlatch=_z80_get_db(pins);_goto(1658); // int_im2 (2)
-        case 1658: pins=_z80_refresh(cpu,pins);_goto(1659); // int_im2 (3)
-        case 1659: _goto(1660); // int_im2 (4)
-        case 1660: _goto(1661); // int_im2 (5)
-        case 1661: _goto(1662); // int_im2 (6)
-        case 1662: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1663); // int_im2 (7)
-        case 1663: _goto(1664); // int_im2 (8)
-        case 1664: _goto(1665); // int_im2 (9)
-        case 1665: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wzl=cpu->dlatch;cpu->wzh=cpu->i;_goto(1666); // int_im2 (10)
-        case 1666: _goto(1667); // int_im2 (11)
-        case 1667: _goto(1668); // int_im2 (12)
-        case 1668: _wait();_mread(cpu->wz++);_goto(1669); // int_im2 (13)
-        case 1669: cpu->dlatch=_gd();_goto(1670); // int_im2 (14)
-        case 1670: _goto(1671); // int_im2 (15)
-        case 1671: _wait();_mread(cpu->wz);_goto(1672); // int_im2 (16)
-        case 1672: cpu->wzh=_gd();cpu->wzl=cpu->dlatch;cpu->pc=cpu->wz;_goto(1673); // int_im2 (17)
-        case 1673: _fetch(); // int_im2 (18)
-        case 1674: _wait();cpu->iff1=false;_goto(1675); // nmi (0)
-        case 1675: pins=_z80_refresh(cpu,pins);_goto(1676); // nmi (1)
-        case 1676: _goto(1677); // nmi (2)
-        case 1677: _goto(1678); // nmi (3)
-        case 1678: _goto(1679); // nmi (4)
-        case 1679: _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1680); // nmi (5)
-        case 1680: _goto(1681); // nmi (6)
-        case 1681: _goto(1682); // nmi (7)
-        case 1682: _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=cpu->pc=0x0066;_goto(1683); // nmi (8)
-        case 1683: _goto(1684); // nmi (9)
-        case 1684: _fetch(); // nmi (10)
+        _Z80_CASE(   0): _fetch(); // NOP (0)
+        _Z80_CASE(   1): _goto(512); // LD BC,nn (0)
+        _Z80_CASE(   2): _goto(518); // LD (BC),A (0)
+        _Z80_CASE(   3): cpu->bc++;_goto(521); // INC BC (0)
+        _Z80_CASE(   4): cpu->b=_z80_inc8(cpu,cpu->b);_fetch(); // INC B (0)
+        _Z80_CASE(   5): cpu->b=_z80_dec8(cpu,cpu->b);_fetch(); // DEC B (0)
+        _Z80_CASE(   6): _goto(523); // LD B,n (0)
+        _Z80_CASE(   7): _sync_flags();_z80_rlca(cpu);_fetch(); // RLCA (0)
+        _Z80_CASE(   8): _sync_flags();_z80_ex_af_af2(cpu);_fetch(); // EX AF,AF' (0)
+        _Z80_CASE(   9): _sync_flags();_z80_add16(cpu,cpu->bc);_goto(526); // ADD HL,BC (0)
+        _Z80_CASE(  10): _goto(533); // LD A,(BC) (0)
+        _Z80_CASE(  11): cpu->bc--;_goto(536); // DEC BC (0)
+        _Z80_CASE(  12): cpu->c=_z80_inc8(cpu,cpu->c);_fetch(); // INC C (0)
+        _Z80_CASE(  13): cpu->c=_z80_dec8(cpu,cpu->c);_fetch(); // DEC C (0)
+        _Z80_CASE(  14): _goto(538); // LD C,n (0)
+        _Z80_CASE(  15): _sync_flags();_z80_rrca(cpu);_fetch(); // RRCA (0)
+        _Z80_CASE(  16): _goto(541); // DJNZ d (0)
+        _Z80_CASE(  17): _goto(550); // LD DE,nn (0)
+        _Z80_CASE(  18): _goto(556); // LD (DE),A (0)
+        _Z80_CASE(  19): cpu->de++;_goto(559); // INC DE (0)
+        _Z80_CASE(  20): cpu->d=_z80_inc8(cpu,cpu->d);_fetch(); // INC D (0)
+        _Z80_CASE(  21): cpu->d=_z80_dec8(cpu,cpu->d);_fetch(); // DEC D (0)
+        _Z80_CASE(  22): _goto(561); // LD D,n (0)
+        _Z80_CASE(  23): _sync_flags();_z80_rla(cpu);_fetch(); // RLA (0)
+        _Z80_CASE(  24): _goto(564); // JR d (0)
+        _Z80_CASE(  25): _sync_flags();_z80_add16(cpu,cpu->de);_goto(572); // ADD HL,DE (0)
+        _Z80_CASE(  26): _goto(579); // LD A,(DE) (0)
+        _Z80_CASE(  27): cpu->de--;_goto(582); // DEC DE (0)
+        _Z80_CASE(  28): cpu->e=_z80_inc8(cpu,cpu->e);_fetch(); // INC E (0)
+        _Z80_CASE(  29): cpu->e=_z80_dec8(cpu,cpu->e);_fetch(); // DEC E (0)
+        _Z80_CASE(  30): _goto(584); // LD E,n (0)
+        _Z80_CASE(  31): _sync_flags();_z80_rra(cpu);_fetch(); // RRA (0)
+        _Z80_CASE(  32): _goto(587); // JR NZ,d (0)
+        _Z80_CASE(  33): _goto(595); // LD HL,nn (0)
+        _Z80_CASE(  34): _goto(601); // LD (nn),HL (0)
+        _Z80_CASE(  35): cpu->hlx[cpu->hlx_idx].hl++;_goto(613); // INC HL (0)
+        _Z80_CASE(  36): cpu->hlx[cpu->hlx_idx].h=_z80_inc8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // INC H (0)
+        _Z80_CASE(  37): cpu->hlx[cpu->hlx_idx].h=_z80_dec8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // DEC H (0)
+        _Z80_CASE(  38): _goto(615); // LD H,n (0)
+        _Z80_CASE(  39): _sync_flags();_z80_daa(cpu);_fetch(); // DAA (0)
+        _Z80_CASE(  40): _goto(618); // JR Z,d (0)
+        _Z80_CASE(  41): _sync_flags();_z80_add16(cpu,cpu->hlx[cpu->hlx_idx].hl);_goto(626); // ADD HL,HL (0)
+        _Z80_CASE(  42): _goto(633); // LD HL,(nn) (0)
+        _Z80_CASE(  43): cpu->hlx[cpu->hlx_idx].hl--;_goto(645); // DEC HL (0)
+        _Z80_CASE(  44): cpu->hlx[cpu->hlx_idx].l=_z80_inc8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // INC L (0)
+        _Z80_CASE(  45): cpu->hlx[cpu->hlx_idx].l=_z80_dec8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // DEC L (0)
+        _Z80_CASE(  46): _goto(647); // LD L,n (0)
+        _Z80_CASE(  47): _sync_flags();_z80_cpl(cpu);_fetch(); // CPL (0)
+        _Z80_CASE(  48): _goto(650); // JR NC,d (0)
+        _Z80_CASE(  49): _goto(658); // LD SP,nn (0)
+        _Z80_CASE(  50): _goto(664); // LD (nn),A (0)
+        _Z80_CASE(  51): cpu->sp++;_goto(673); // INC SP (0)
+        _Z80_CASE(  52): _goto(675); // INC (HL) (0)
+        _Z80_CASE(  53): _goto(682); // DEC (HL) (0)
+        _Z80_CASE(  54): _goto(689); // LD (HL),n (0)
+        _Z80_CASE(  55): _sync_flags();_z80_scf(cpu);_fetch(); // SCF (0)
+        _Z80_CASE(  56): _goto(695); // JR C,d (0)
+        _Z80_CASE(  57): _sync_flags();_z80_add16(cpu,cpu->sp);_goto(703); // ADD HL,SP (0)
+        _Z80_CASE(  58): _goto(710); // LD A,(nn) (0)
+        _Z80_CASE(  59): cpu->sp--;_goto(719); // DEC SP (0)
+        _Z80_CASE(  60): cpu->a=_z80_inc8(cpu,cpu->a);_fetch(); // INC A (0)
+        _Z80_CASE(  61): cpu->a=_z80_dec8(cpu,cpu->a);_fetch(); // DEC A (0)
+        _Z80_CASE(  62): _goto(721); // LD A,n (0)
+        _Z80_CASE(  63): _sync_flags();_z80_ccf(cpu);_fetch(); // CCF (0)
+        _Z80_CASE(  64): cpu->b=cpu->b;_fetch(); // LD B,B (0)
+        _Z80_CASE(  65): cpu->b=cpu->c;_fetch(); // LD B,C (0)
+        _Z80_CASE(  66): cpu->b=cpu->d;_fetch(); // LD B,D (0)
+        _Z80_CASE(  67): cpu->b=cpu->e;_fetch(); // LD B,E (0)
+        _Z80_CASE(  68): cpu->b=cpu->hlx[cpu->hlx_idx].h;_fetch(); // LD B,H (0)
+        _Z80_CASE(  69): cpu->b=cpu->hlx[cpu->hlx_idx].l;_fetch(); // LD B,L (0)
+        _Z80_CASE(  70): _goto(724); // LD B,(HL) (0)
+        _Z80_CASE(  71): cpu->b=cpu->a;_fetch(); // LD B,A (0)
+        _Z80_CASE(  72): cpu->c=cpu->b;_fetch(); // LD C,B (0)
+        _Z80_CASE(  73): cpu->c=cpu->c;_fetch(); // LD C,C (0)
+        _Z80_CASE(  74): cpu->c=cpu->d;_fetch(); // LD C,D (0)
+        _Z80_CASE(  75): cpu->c=cpu->e;_fetch(); // LD C,E (0)
+        _Z80_CASE(  76): cpu->c=cpu->hlx[cpu->hlx_idx].h;_fetch(); // LD C,H (0)
+        _Z80_CASE(  77): cpu->c=cpu->hlx[cpu->hlx_idx].l;_fetch(); // LD C,L (0)
+        _Z80_CASE(  78): _goto(727); // LD C,(HL) (0)
+        _Z80_CASE(  79): cpu->c=cpu->a;_fetch(); // LD C,A (0)
+        _Z80_CASE(  80): cpu->d=cpu->b;_fetch(); // LD D,B (0)
+        _Z80_CASE(  81): cpu->d=cpu->c;_fetch(); // LD D,C (0)
+        _Z80_CASE(  82): cpu->d=cpu->d;_fetch(); // LD D,D (0)
+        _Z80_CASE(  83): cpu->d=cpu->e;_fetch(); // LD D,E (0)
+        _Z80_CASE(  84): cpu->d=cpu->hlx[cpu->hlx_idx].h;_fetch(); // LD D,H (0)
+        _Z80_CASE(  85): cpu->d=cpu->hlx[cpu->hlx_idx].l;_fetch(); // LD D,L (0)
+        _Z80_CASE(  86): _goto(730); // LD D,(HL) (0)
+        _Z80_CASE(  87): cpu->d=cpu->a;_fetch(); // LD D,A (0)
+        _Z80_CASE(  88): cpu->e=cpu->b;_fetch(); // LD E,B (0)
+        _Z80_CASE(  89): cpu->e=cpu->c;_fetch(); // LD E,C (0)
+        _Z80_CASE(  90): cpu->e=cpu->d;_fetch(); // LD E,D (0)
+        _Z80_CASE(  91): cpu->e=cpu->e;_fetch(); // LD E,E (0)
+        _Z80_CASE(  92): cpu->e=cpu->hlx[cpu->hlx_idx].h;_fetch(); // LD E,H (0)
+        _Z80_CASE(  93): cpu->e=cpu->hlx[cpu->hlx_idx].l;_fetch(); // LD E,L (0)
+        _Z80_CASE(  94): _goto(733); // LD E,(HL) (0)
+        _Z80_CASE(  95): cpu->e=cpu->a;_fetch(); // LD E,A (0)
+        _Z80_CASE(  96): cpu->hlx[cpu->hlx_idx].h=cpu->b;_fetch(); // LD H,B (0)
+        _Z80_CASE(  97): cpu->hlx[cpu->hlx_idx].h=cpu->c;_fetch(); // LD H,C (0)
+        _Z80_CASE(  98): cpu->hlx[cpu->hlx_idx].h=cpu->d;_fetch(); // LD H,D (0)
+        _Z80_CASE(  99): cpu->hlx[cpu->hlx_idx].h=cpu->e;_fetch(); // LD H,E (0)
+        _Z80_CASE( 100): cpu->hlx[cpu->hlx_idx].h=cpu->hlx[cpu->hlx_idx].h;_fetch(); // LD H,H (0)
+        _Z80_CASE( 101): cpu->hlx[cpu->hlx_idx].h=cpu->hlx[cpu->hlx_idx].l;_fetch(); // LD H,L (0)
+        _Z80_CASE( 102): _goto(736); // LD H,(HL) (0)
+        _Z80_CASE( 103): cpu->hlx[cpu->hlx_idx].h=cpu->a;_fetch(); // LD H,A (0)
+        _Z80_CASE( 104): cpu->hlx[cpu->hlx_idx].l=cpu->b;_fetch(); // LD L,B (0)
+        _Z80_CASE( 105): cpu->hlx[cpu->hlx_idx].l=cpu->c;_fetch(); // LD L,C (0)
+        _Z80_CASE( 106): cpu->hlx[cpu->hlx_idx].l=cpu->d;_fetch(); // LD L,D (0)
+        _Z80_CASE( 107): cpu->hlx[cpu->hlx_idx].l=cpu->e;_fetch(); // LD L,E (0)
+        _Z80_CASE( 108): cpu->hlx[cpu->hlx_idx].l=cpu->hlx[cpu->hlx_idx].h;_fetch(); // LD L,H (0)
+        _Z80_CASE( 109): cpu->hlx[cpu->hlx_idx].l=cpu->hlx[cpu->hlx_idx].l;_fetch(); // LD L,L (0)
+        _Z80_CASE( 110): _goto(739); // LD L,(HL) (0)
+        _Z80_CASE( 111): cpu->hlx[cpu->hlx_idx].l=cpu->a;_fetch(); // LD L,A (0)
+        _Z80_CASE( 112): _goto(742); // LD (HL),B (0)
+        _Z80_CASE( 113): _goto(745); // LD (HL),C (0)
+        _Z80_CASE( 114): _goto(748); // LD (HL),D (0)
+        _Z80_CASE( 115): _goto(751); // LD (HL),E (0)
+        _Z80_CASE( 116): _goto(754); // LD (HL),H (0)
+        _Z80_CASE( 117): _goto(757); // LD (HL),L (0)
+        _Z80_CASE( 118): pins=_z80_halt(cpu,pins);_fetch(); // HALT (0)
+        _Z80_CASE( 119): _goto(760); // LD (HL),A (0)
+        _Z80_CASE( 120): cpu->a=cpu->b;_fetch(); // LD A,B (0)
+        _Z80_CASE( 121): cpu->a=cpu->c;_fetch(); // LD A,C (0)
+        _Z80_CASE( 122): cpu->a=cpu->d;_fetch(); // LD A,D (0)
+        _Z80_CASE( 123): cpu->a=cpu->e;_fetch(); // LD A,E (0)
+        _Z80_CASE( 124): cpu->a=cpu->hlx[cpu->hlx_idx].h;_fetch(); // LD A,H (0)
+        _Z80_CASE( 125): cpu->a=cpu->hlx[cpu->hlx_idx].l;_fetch(); // LD A,L (0)
+        _Z80_CASE( 126): _goto(763); // LD A,(HL) (0)
+        _Z80_CASE( 127): cpu->a=cpu->a;_fetch(); // LD A,A (0)
+        _Z80_CASE( 128): _z80_add8(cpu,cpu->b);_fetch(); // ADD B (0)
+        _Z80_CASE( 129): _z80_add8(cpu,cpu->c);_fetch(); // ADD C (0)
+        _Z80_CASE( 130): _z80_add8(cpu,cpu->d);_fetch(); // ADD D (0)
+        _Z80_CASE( 131): _z80_add8(cpu,cpu->e);_fetch(); // ADD E (0)
+        _Z80_CASE( 132): _z80_add8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // ADD H (0)
+        _Z80_CASE( 133): _z80_add8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // ADD L (0)
+        _Z80_CASE( 134): _goto(766); // ADD (HL) (0)
+        _Z80_CASE( 135): _z80_add8(cpu,cpu->a);_fetch(); // ADD A (0)
+        _Z80_CASE( 136): _z80_adc8(cpu,cpu->b);_fetch(); // ADC B (0)
+        _Z80_CASE( 137): _z80_adc8(cpu,cpu->c);_fetch(); // ADC C (0)
+        _Z80_CASE( 138): _z80_adc8(cpu,cpu->d);_fetch(); // ADC D (0)
+        _Z80_CASE( 139): _z80_adc8(cpu,cpu->e);_fetch(); // ADC E (0)
+        _Z80_CASE( 140): _z80_adc8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // ADC H (0)
+        _Z80_CASE( 141): _z80_adc8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // ADC L (0)
+        _Z80_CASE( 142): _goto(769); // ADC (HL) (0)
+        _Z80_CASE( 143): _z80_adc8(cpu,cpu->a);_fetch(); // ADC A (0)
+        _Z80_CASE( 144): _z80_sub8(cpu,cpu->b);_fetch(); // SUB B (0)
+        _Z80_CASE( 145): _z80_sub8(cpu,cpu->c);_fetch(); // SUB C (0)
+        _Z80_CASE( 146): _z80_sub8(cpu,cpu->d);_fetch(); // SUB D (0)
+        _Z80_CASE( 147): _z80_sub8(cpu,cpu->e);_fetch(); // SUB E (0)
+        _Z80_CASE( 148): _z80_sub8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // SUB H (0)
+        _Z80_CASE( 149): _z80_sub8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // SUB L (0)
+        _Z80_CASE( 150): _goto(772); // SUB (HL) (0)
+        _Z80_CASE( 151): _z80_sub8(cpu,cpu->a);_fetch(); // SUB A (0)
+        _Z80_CASE( 152): _z80_sbc8(cpu,cpu->b);_fetch(); // SBC B (0)
+        _Z80_CASE( 153): _z80_sbc8(cpu,cpu->c);_fetch(); // SBC C (0)
+        _Z80_CASE( 154): _z80_sbc8(cpu,cpu->d);_fetch(); // SBC D (0)
+        _Z80_CASE( 155): _z80_sbc8(cpu,cpu->e);_fetch(); // SBC E (0)
+        _Z80_CASE( 156): _z80_sbc8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // SBC H (0)
+        _Z80_CASE( 157): _z80_sbc8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // SBC L (0)
+        _Z80_CASE( 158): _goto(775); // SBC (HL) (0)
+        _Z80_CASE( 159): _z80_sbc8(cpu,cpu->a);_fetch(); // SBC A (0)
+        _Z80_CASE( 160): _z80_and8(cpu,cpu->b);_fetch(); // AND B (0)
+        _Z80_CASE( 161): _z80_and8(cpu,cpu->c);_fetch(); // AND C (0)
+        _Z80_CASE( 162): _z80_and8(cpu,cpu->d);_fetch(); // AND D (0)
+        _Z80_CASE( 163): _z80_and8(cpu,cpu->e);_fetch(); // AND E (0)
+        _Z80_CASE( 164): _z80_and8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // AND H (0)
+        _Z80_CASE( 165): _z80_and8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // AND L (0)
+        _Z80_CASE( 166): _goto(778); // AND (HL) (0)
+        _Z80_CASE( 167): _z80_and8(cpu,cpu->a);_fetch(); // AND A (0)
+        _Z80_CASE( 168): _z80_xor8(cpu,cpu->b);_fetch(); // XOR B (0)
+        _Z80_CASE( 169): _z80_xor8(cpu,cpu->c);_fetch(); // XOR C (0)
+        _Z80_CASE( 170): _z80_xor8(cpu,cpu->d);_fetch(); // XOR D (0)
+        _Z80_CASE( 171): _z80_xor8(cpu,cpu->e);_fetch(); // XOR E (0)
+        _Z80_CASE( 172): _z80_xor8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // XOR H (0)
+        _Z80_CASE( 173): _z80_xor8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // XOR L (0)
+        _Z80_CASE( 174): _goto(781); // XOR (HL) (0)
+        _Z80_CASE( 175): _z80_xor8(cpu,cpu->a);_fetch(); // XOR A (0)
+        _Z80_CASE( 176): _z80_or8(cpu,cpu->b);_fetch(); // OR B (0)
+        _Z80_CASE( 177): _z80_or8(cpu,cpu->c);_fetch(); // OR C (0)
+        _Z80_CASE( 178): _z80_or8(cpu,cpu->d);_fetch(); // OR D (0)
+        _Z80_CASE( 179): _z80_or8(cpu,cpu->e);_fetch(); // OR E (0)
+        _Z80_CASE( 180): _z80_or8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // OR H (0)
+        _Z80_CASE( 181): _z80_or8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // OR L (0)
+        _Z80_CASE( 182): _goto(784); // OR (HL) (0)
+        _Z80_CASE( 183): _z80_or8(cpu,cpu->a);_fetch(); // OR A (0)
+        _Z80_CASE( 184): _z80_cp8(cpu,cpu->b);_fetch(); // CP B (0)
+        _Z80_CASE( 185): _z80_cp8(cpu,cpu->c);_fetch(); // CP C (0)
+        _Z80_CASE( 186): _z80_cp8(cpu,cpu->d);_fetch(); // CP D (0)
+        _Z80_CASE( 187): _z80_cp8(cpu,cpu->e);_fetch(); // CP E (0)
+        _Z80_CASE( 188): _z80_cp8(cpu,cpu->hlx[cpu->hlx_idx].h);_fetch(); // CP H (0)
+        _Z80_CASE( 189): _z80_cp8(cpu,cpu->hlx[cpu->hlx_idx].l);_fetch(); // CP L (0)
+        _Z80_CASE( 190): _goto(787); // CP (HL) (0)
+        _Z80_CASE( 191): _z80_cp8(cpu,cpu->a);_fetch(); // CP A (0)
+        _Z80_CASE( 192): if(!_cc_nz){_goto(790+6);};_goto(790); // RET NZ (0)
+        _Z80_CASE( 193): _goto(797); // POP BC (0)
+        _Z80_CASE( 194): _goto(803); // JP NZ,nn (0)
+        _Z80_CASE( 195): _goto(809); // JP nn (0)
+        _Z80_CASE( 196): _goto(815); // CALL NZ,nn (0)
+        _Z80_CASE( 197): _goto(828); // PUSH BC (0)
+        _Z80_CASE( 198): _goto(835); // ADD n (0)
+        _Z80_CASE( 199): _goto(838); // RST 0h (0)
+        _Z80_CASE( 200): if(!_cc_z){_goto(845+6);};_goto(845); // RET Z (0)
+        _Z80_CASE( 201): _goto(852); // RET (0)
+        _Z80_CASE( 202): _goto(858); // JP Z,nn (0)
+        _Z80_CASE( 203): _fetch_cb();goto step_to; // CB prefix (0)
+        _Z80_CASE( 204): _goto(864); // CALL Z,nn (0)
+        _Z80_CASE( 205): _goto(877); // CALL nn (0)
+        _Z80_CASE( 206): _goto(890); // ADC n (0)
+        _Z80_CASE( 207): _goto(893); // RST 8h (0)
+        _Z80_CASE( 208): if(!_cc_nc){_goto(900+6);};_goto(900); // RET NC (0)
+        _Z80_CASE( 209): _goto(907); // POP DE (0)
+        _Z80_CASE( 210): _goto(913); // JP NC,nn (0)
+        _Z80_CASE( 211): _goto(919); // OUT (n),A (0)
+        _Z80_CASE( 212): _goto(926); // CALL NC,nn (0)
+        _Z80_CASE( 213): _goto(939); // PUSH DE (0)
+        _Z80_CASE( 214): _goto(946); // SUB n (0)
+        _Z80_CASE( 215): _goto(949); // RST 10h (0)
+        _Z80_CASE( 216): if(!_cc_c){_goto(956+6);};_goto(956); // RET C (0)
+        _Z80_CASE( 217): _z80_exx(cpu);_fetch(); // EXX (0)
+        _Z80_CASE( 218): _goto(963); // JP C,nn (0)
+        _Z80_CASE( 219): _goto(969); // IN A,(n) (0)
+        _Z80_CASE( 220): _goto(976); // CALL C,nn (0)
+        _Z80_CASE( 221): _fetch_dd();goto step_to; // DD prefix (0)
+        _Z80_CASE( 222): _goto(989); // SBC n (0)
+        _Z80_CASE( 223): _goto(992); // RST 18h (0)
+        _Z80_CASE( 224): if(!_cc_po){_goto(999+6);};_goto(999); // RET PO (0)
+        _Z80_CASE( 225): _goto(1006); // POP HL (0)
+        _Z80_CASE( 226): _goto(1012); // JP PO,nn (0)
+        _Z80_CASE( 227): _goto(1018); // EX (SP),HL (0)
+        _Z80_CASE( 228): _goto(1033); // CALL PO,nn (0)
+        _Z80_CASE( 229): _goto(1046); // PUSH HL (0)
+        _Z80_CASE( 230): _goto(1053); // AND n (0)
+        _Z80_CASE( 231): _goto(1056); // RST 20h (0)
+        _Z80_CASE( 232): if(!_cc_pe){_goto(1063+6);};_goto(1063); // RET PE (0)
+        _Z80_CASE( 233): cpu->pc=cpu->hlx[cpu->hlx_idx].hl;_fetch(); // JP HL (0)
+        _Z80_CASE( 234): _goto(1070); // JP PE,nn (0)
+        _Z80_CASE( 235): _z80_ex_de_hl(cpu);_fetch(); // EX DE,HL (0)
+        _Z80_CASE( 236): _goto(1076); // CALL PE,nn (0)
+        _Z80_CASE( 237): _fetch_ed();goto step_to; // ED prefix (0)
+        _Z80_CASE( 238): _goto(1089); // XOR n (0)
+        _Z80_CASE( 239): _goto(1092); // RST 28h (0)
+        _Z80_CASE( 240): if(!_cc_p){_goto(1099+6);};_goto(1099); // RET P (0)
+        _Z80_CASE( 241): _sync_flags();_goto(1106); // POP AF (0)
+        _Z80_CASE( 242): _goto(1112); // JP P,nn (0)
+        _Z80_CASE( 243): cpu->iff1=cpu->iff2=false;_fetch(); // DI (0)
+        _Z80_CASE( 244): _goto(1118); // CALL P,nn (0)
+        _Z80_CASE( 245): _sync_flags();_goto(1131); // PUSH AF (0)
+        _Z80_CASE( 246): _goto(1138); // OR n (0)
+        _Z80_CASE( 247): _goto(1141); // RST 30h (0)
+        _Z80_CASE( 248): if(!_cc_m){_goto(1148+6);};_goto(1148); // RET M (0)
+        _Z80_CASE( 249): cpu->sp=cpu->hlx[cpu->hlx_idx].hl;_goto(1155); // LD SP,HL (0)
+        _Z80_CASE( 250): _goto(1157); // JP M,nn (0)
+        _Z80_CASE( 251): cpu->iff1=cpu->iff2=false;pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2=true;goto step_to; // EI (0)
+        _Z80_CASE( 252): _goto(1163); // CALL M,nn (0)
+        _Z80_CASE( 253): _fetch_fd();goto step_to; // FD prefix (0)
+        _Z80_CASE( 254): _goto(1176); // CP n (0)
+        _Z80_CASE( 255): _goto(1179); // RST 38h (0)
+        _Z80_CASE( 256): _fetch(); // ED NOP (0)
+        _Z80_CASE( 257): _fetch(); // ED NOP (0)
+        _Z80_CASE( 258): _fetch(); // ED NOP (0)
+        _Z80_CASE( 259): _fetch(); // ED NOP (0)
+        _Z80_CASE( 260): _fetch(); // ED NOP (0)
+        _Z80_CASE( 261): _fetch(); // ED NOP (0)
+        _Z80_CASE( 262): _fetch(); // ED NOP (0)
+        _Z80_CASE( 263): _fetch(); // ED NOP (0)
+        _Z80_CASE( 264): _fetch(); // ED NOP (0)
+        _Z80_CASE( 265): _fetch(); // ED NOP (0)
+        _Z80_CASE( 266): _fetch(); // ED NOP (0)
+        _Z80_CASE( 267): _fetch(); // ED NOP (0)
+        _Z80_CASE( 268): _fetch(); // ED NOP (0)
+        _Z80_CASE( 269): _fetch(); // ED NOP (0)
+        _Z80_CASE( 270): _fetch(); // ED NOP (0)
+        _Z80_CASE( 271): _fetch(); // ED NOP (0)
+        _Z80_CASE( 272): _fetch(); // ED NOP (0)
+        _Z80_CASE( 273): _fetch(); // ED NOP (0)
+        _Z80_CASE( 274): _fetch(); // ED NOP (0)
+        _Z80_CASE( 275): _fetch(); // ED NOP (0)
+        _Z80_CASE( 276): _fetch(); // ED NOP (0)
+        _Z80_CASE( 277): _fetch(); // ED NOP (0)
+        _Z80_CASE( 278): _fetch(); // ED NOP (0)
+        _Z80_CASE( 279): _fetch(); // ED NOP (0)
+        _Z80_CASE( 280): _fetch(); // ED NOP (0)
+        _Z80_CASE( 281): _fetch(); // ED NOP (0)
+        _Z80_CASE( 282): _fetch(); // ED NOP (0)
+        _Z80_CASE( 283): _fetch(); // ED NOP (0)
+        _Z80_CASE( 284): _fetch(); // ED NOP (0)
+        _Z80_CASE( 285): _fetch(); // ED NOP (0)
+        _Z80_CASE( 286): _fetch(); // ED NOP (0)
+        _Z80_CASE( 287): _fetch(); // ED NOP (0)
+        _Z80_CASE( 288): _fetch(); // ED NOP (0)
+        _Z80_CASE( 289): _fetch(); // ED NOP (0)
+        _Z80_CASE( 290): _fetch(); // ED NOP (0)
+        _Z80_CASE( 291): _fetch(); // ED NOP (0)
+        _Z80_CASE( 292): _fetch(); // ED NOP (0)
+        _Z80_CASE( 293): _fetch(); // ED NOP (0)
+        _Z80_CASE( 294): _fetch(); // ED NOP (0)
+        _Z80_CASE( 295): _fetch(); // ED NOP (0)
+        _Z80_CASE( 296): _fetch(); // ED NOP (0)
+        _Z80_CASE( 297): _fetch(); // ED NOP (0)
+        _Z80_CASE( 298): _fetch(); // ED NOP (0)
+        _Z80_CASE( 299): _fetch(); // ED NOP (0)
+        _Z80_CASE( 300): _fetch(); // ED NOP (0)
+        _Z80_CASE( 301): _fetch(); // ED NOP (0)
+        _Z80_CASE( 302): _fetch(); // ED NOP (0)
+        _Z80_CASE( 303): _fetch(); // ED NOP (0)
+        _Z80_CASE( 304): _fetch(); // ED NOP (0)
+        _Z80_CASE( 305): _fetch(); // ED NOP (0)
+        _Z80_CASE( 306): _fetch(); // ED NOP (0)
+        _Z80_CASE( 307): _fetch(); // ED NOP (0)
+        _Z80_CASE( 308): _fetch(); // ED NOP (0)
+        _Z80_CASE( 309): _fetch(); // ED NOP (0)
+        _Z80_CASE( 310): _fetch(); // ED NOP (0)
+        _Z80_CASE( 311): _fetch(); // ED NOP (0)
+        _Z80_CASE( 312): _fetch(); // ED NOP (0)
+        _Z80_CASE( 313): _fetch(); // ED NOP (0)
+        _Z80_CASE( 314): _fetch(); // ED NOP (0)
+        _Z80_CASE( 315): _fetch(); // ED NOP (0)
+        _Z80_CASE( 316): _fetch(); // ED NOP (0)
+        _Z80_CASE( 317): _fetch(); // ED NOP (0)
+        _Z80_CASE( 318): _fetch(); // ED NOP (0)
+        _Z80_CASE( 319): _fetch(); // ED NOP (0)
+        _Z80_CASE( 320): _sync_flags();_goto(1186); // IN B,(C) (0)
+        _Z80_CASE( 321): _goto(1190); // OUT (C),B (0)
+        _Z80_CASE( 322): _sync_flags();_z80_sbc16(cpu,cpu->bc);_goto(1194); // SBC HL,BC (0)
+        _Z80_CASE( 323): _goto(1201); // LD (nn),BC (0)
+        _Z80_CASE( 324): _z80_neg8(cpu);_fetch(); // NEG (0)
+        _Z80_CASE( 325): _goto(1213); // RETN (0)
+        _Z80_CASE( 326): cpu->im=0;_fetch(); // IM 0 (0)
+        _Z80_CASE( 327): _goto(1219); // LD I,A (0)
+        _Z80_CASE( 328): _sync_flags();_goto(1220); // IN C,(C) (0)
+        _Z80_CASE( 329): _goto(1224); // OUT (C),C (0)
+        _Z80_CASE( 330): _sync_flags();_z80_adc16(cpu,cpu->bc);_goto(1228); // ADC HL,BC (0)
+        _Z80_CASE( 331): _goto(1235); // LD BC,(nn) (0)
+        _Z80_CASE( 332): _z80_neg8(cpu);_fetch(); // NEG (0)
+        _Z80_CASE( 333): _goto(1247); // RETI (0)
+        _Z80_CASE( 334): cpu->im=0;_fetch(); // IM 0 (0)
+        _Z80_CASE( 335): _goto(1253); // LD R,A (0)
+        _Z80_CASE( 336): _sync_flags();_goto(1254); // IN D,(C) (0)
+        _Z80_CASE( 337): _goto(1258); // OUT (C),D (0)
+        _Z80_CASE( 338): _sync_flags();_z80_sbc16(cpu,cpu->de);_goto(1262); // SBC HL,DE (0)
+        _Z80_CASE( 339): _goto(1269); // LD (nn),DE (0)
+        _Z80_CASE( 340): _z80_neg8(cpu);_fetch(); // NEG (0)
+        _Z80_CASE( 341): _goto(1247); // RETI (0)
+        _Z80_CASE( 342): cpu->im=1;_fetch(); // IM 1 (0)
+        _Z80_CASE( 343): _sync_flags();_goto(1282); // LD A,I (0)
+        _Z80_CASE( 344): _sync_flags();_goto(1283); // IN E,(C) (0)
+        _Z80_CASE( 345): _goto(1287); // OUT (C),E (0)
+        _Z80_CASE( 346): _sync_flags();_z80_adc16(cpu,cpu->de);_goto(1291); // ADC HL,DE (0)
+        _Z80_CASE( 347): _goto(1298); // LD DE,(nn) (0)
+        _Z80_CASE( 348): _z80_neg8(cpu);_fetch(); // NEG (0)
+        _Z80_CASE( 349): _goto(1247); // RETI (0)
+        _Z80_CASE( 350): cpu->im=2;_fetch(); // IM 2 (0)
+        _Z80_CASE( 351): _sync_flags();_goto(1311); // LD A,R (0)
+        _Z80_CASE( 352): _sync_flags();_goto(1312); // IN H,(C) (0)
+        _Z80_CASE( 353): _goto(1316); // OUT (C),H (0)
+        _Z80_CASE( 354): _sync_flags();_z80_sbc16(cpu,cpu->hl);_goto(1320); // SBC HL,HL (0)
+        _Z80_CASE( 355): _goto(1327); // LD (nn),HL (0)
+        _Z80_CASE( 356): _z80_neg8(cpu);_fetch(); // NEG (0)
+        _Z80_CASE( 357): _goto(1247); // RETI (0)
+        _Z80_CASE( 358): cpu->im=0;_fetch(); // IM 0 (0)
+        _Z80_CASE( 359): _sync_flags();_goto(1340); // RRD (0)
+        _Z80_CASE( 360): _sync_flags();_goto(1350); // IN L,(C) (0)
+        _Z80_CASE( 361): _goto(1354); // OUT (C),L (0)
+        _Z80_CASE( 362): _sync_flags();_z80_adc16(cpu,cpu->hl);_goto(1358); // ADC HL,HL (0)
+        _Z80_CASE( 363): _goto(1365); // LD HL,(nn) (0)
+        _Z80_CASE( 364): _z80_neg8(cpu);_fetch(); // NEG (0)
+        _Z80_CASE( 365): _goto(1247); // RETI (0)
+        _Z80_CASE( 366): cpu->im=0;_fetch(); // IM 0 (0)
+        _Z80_CASE( 367): _sync_flags();_goto(1378); // RLD (0)
+        _Z80_CASE( 368): _sync_flags();_goto(1388); // IN (C) (0)
+        _Z80_CASE( 369): _goto(1392); // OUT (C),0 (0)
+        _Z80_CASE( 370): _sync_flags();_z80_sbc16(cpu,cpu->sp);_goto(1396); // SBC HL,SP (0)
+        _Z80_CASE( 371): _goto(1403); // LD (nn),SP (0)
+        _Z80_CASE( 372): _z80_neg8(cpu);_fetch(); // NEG (0)
+        _Z80_CASE( 373): _goto(1247); // RETI (0)
+        _Z80_CASE( 374): cpu->im=1;_fetch(); // IM 1 (0)
+        _Z80_CASE( 375): _fetch(); // ED NOP (0)
+        _Z80_CASE( 376): _sync_flags();_goto(1416); // IN A,(C) (0)
+        _Z80_CASE( 377): _goto(1420); // OUT (C),A (0)
+        _Z80_CASE( 378): _sync_flags();_z80_adc16(cpu,cpu->sp);_goto(1424); // ADC HL,SP (0)
+        _Z80_CASE( 379): _goto(1431); // LD SP,(nn) (0)
+        _Z80_CASE( 380): _z80_neg8(cpu);_fetch(); // NEG (0)
+        _Z80_CASE( 381): _goto(1247); // RETI (0)
+        _Z80_CASE( 382): cpu->im=2;_fetch(); // IM 2 (0)
+        _Z80_CASE( 383): _fetch(); // ED NOP (0)
+        _Z80_CASE( 384): _fetch(); // ED NOP (0)
+        _Z80_CASE( 385): _fetch(); // ED NOP (0)
+        _Z80_CASE( 386): _fetch(); // ED NOP (0)
+        _Z80_CASE( 387): _fetch(); // ED NOP (0)
+        _Z80_CASE( 388): _fetch(); // ED NOP (0)
+        _Z80_CASE( 389): _fetch(); // ED NOP (0)
+        _Z80_CASE( 390): _fetch(); // ED NOP (0)
+        _Z80_CASE( 391): _fetch(); // ED NOP (0)
+        _Z80_CASE( 392): _fetch(); // ED NOP (0)
+        _Z80_CASE( 393): _fetch(); // ED NOP (0)
+        _Z80_CASE( 394): _fetch(); // ED NOP (0)
+        _Z80_CASE( 395): _fetch(); // ED NOP (0)
+        _Z80_CASE( 396): _fetch(); // ED NOP (0)
+        _Z80_CASE( 397): _fetch(); // ED NOP (0)
+        _Z80_CASE( 398): _fetch(); // ED NOP (0)
+        _Z80_CASE( 399): _fetch(); // ED NOP (0)
+        _Z80_CASE( 400): _fetch(); // ED NOP (0)
+        _Z80_CASE( 401): _fetch(); // ED NOP (0)
+        _Z80_CASE( 402): _fetch(); // ED NOP (0)
+        _Z80_CASE( 403): _fetch(); // ED NOP (0)
+        _Z80_CASE( 404): _fetch(); // ED NOP (0)
+        _Z80_CASE( 405): _fetch(); // ED NOP (0)
+        _Z80_CASE( 406): _fetch(); // ED NOP (0)
+        _Z80_CASE( 407): _fetch(); // ED NOP (0)
+        _Z80_CASE( 408): _fetch(); // ED NOP (0)
+        _Z80_CASE( 409): _fetch(); // ED NOP (0)
+        _Z80_CASE( 410): _fetch(); // ED NOP (0)
+        _Z80_CASE( 411): _fetch(); // ED NOP (0)
+        _Z80_CASE( 412): _fetch(); // ED NOP (0)
+        _Z80_CASE( 413): _fetch(); // ED NOP (0)
+        _Z80_CASE( 414): _fetch(); // ED NOP (0)
+        _Z80_CASE( 415): _fetch(); // ED NOP (0)
+        _Z80_CASE( 416): _sync_flags();_goto(1444); // LDI (0)
+        _Z80_CASE( 417): _sync_flags();_goto(1452); // CPI (0)
+        _Z80_CASE( 418): _sync_flags();_goto(1460); // INI (0)
+        _Z80_CASE( 419): _sync_flags();_goto(1468); // OUTI (0)
+        _Z80_CASE( 420): _fetch(); // ED NOP (0)
+        _Z80_CASE( 421): _fetch(); // ED NOP (0)
+        _Z80_CASE( 422): _fetch(); // ED NOP (0)
+        _Z80_CASE( 423): _fetch(); // ED NOP (0)
+        _Z80_CASE( 424): _sync_flags();_goto(1476); // LDD (0)
+        _Z80_CASE( 425): _sync_flags();_goto(1484); // CPD (0)
+        _Z80_CASE( 426): _sync_flags();_goto(1492); // IND (0)
+        _Z80_CASE( 427): _sync_flags();_goto(1500); // OUTD (0)
+        _Z80_CASE( 428): _fetch(); // ED NOP (0)
+        _Z80_CASE( 429): _fetch(); // ED NOP (0)
+        _Z80_CASE( 430): _fetch(); // ED NOP (0)
+        _Z80_CASE( 431): _fetch(); // ED NOP (0)
+        _Z80_CASE( 432): _sync_flags();_goto(1508); // LDIR (0)
+        _Z80_CASE( 433): _sync_flags();_goto(1521); // CPIR (0)
+        _Z80_CASE( 434): _sync_flags();_goto(1534); // INIR (0)
+        _Z80_CASE( 435): _sync_flags();_goto(1547); // OTIR (0)
+        _Z80_CASE( 436): _fetch(); // ED NOP (0)
+        _Z80_CASE( 437): _fetch(); // ED NOP (0)
+        _Z80_CASE( 438): _fetch(); // ED NOP (0)
+        _Z80_CASE( 439): _fetch(); // ED NOP (0)
+        _Z80_CASE( 440): _sync_flags();_goto(1560); // LDDR (0)
+        _Z80_CASE( 441): _sync_flags();_goto(1573); // CPDR (0)
+        _Z80_CASE( 442): _sync_flags();_goto(1586); // INDR (0)
+        _Z80_CASE( 443): _sync_flags();_goto(1599); // OTDR (0)
+        _Z80_CASE( 444): _fetch(); // ED NOP (0)
+        _Z80_CASE( 445): _fetch(); // ED NOP (0)
+        _Z80_CASE( 446): _fetch(); // ED NOP (0)
+        _Z80_CASE( 447): _fetch(); // ED NOP (0)
+        _Z80_CASE( 448): _fetch(); // ED NOP (0)
+        _Z80_CASE( 449): _fetch(); // ED NOP (0)
+        _Z80_CASE( 450): _fetch(); // ED NOP (0)
+        _Z80_CASE( 451): _fetch(); // ED NOP (0)
+        _Z80_CASE( 452): _fetch(); // ED NOP (0)
+        _Z80_CASE( 453): _fetch(); // ED NOP (0)
+        _Z80_CASE( 454): _fetch(); // ED NOP (0)
+        _Z80_CASE( 455): _fetch(); // ED NOP (0)
+        _Z80_CASE( 456): _fetch(); // ED NOP (0)
+        _Z80_CASE( 457): _fetch(); // ED NOP (0)
+        _Z80_CASE( 458): _fetch(); // ED NOP (0)
+        _Z80_CASE( 459): _fetch(); // ED NOP (0)
+        _Z80_CASE( 460): _fetch(); // ED NOP (0)
+        _Z80_CASE( 461): _fetch(); // ED NOP (0)
+        _Z80_CASE( 462): _fetch(); // ED NOP (0)
+        _Z80_CASE( 463): _fetch(); // ED NOP (0)
+        _Z80_CASE( 464): _fetch(); // ED NOP (0)
+        _Z80_CASE( 465): _fetch(); // ED NOP (0)
+        _Z80_CASE( 466): _fetch(); // ED NOP (0)
+        _Z80_CASE( 467): _fetch(); // ED NOP (0)
+        _Z80_CASE( 468): _fetch(); // ED NOP (0)
+        _Z80_CASE( 469): _fetch(); // ED NOP (0)
+        _Z80_CASE( 470): _fetch(); // ED NOP (0)
+        _Z80_CASE( 471): _fetch(); // ED NOP (0)
+        _Z80_CASE( 472): _fetch(); // ED NOP (0)
+        _Z80_CASE( 473): _fetch(); // ED NOP (0)
+        _Z80_CASE( 474): _fetch(); // ED NOP (0)
+        _Z80_CASE( 475): _fetch(); // ED NOP (0)
+        _Z80_CASE( 476): _fetch(); // ED NOP (0)
+        _Z80_CASE( 477): _fetch(); // ED NOP (0)
+        _Z80_CASE( 478): _fetch(); // ED NOP (0)
+        _Z80_CASE( 479): _fetch(); // ED NOP (0)
+        _Z80_CASE( 480): _fetch(); // ED NOP (0)
+        _Z80_CASE( 481): _fetch(); // ED NOP (0)
+        _Z80_CASE( 482): _fetch(); // ED NOP (0)
+        _Z80_CASE( 483): _fetch(); // ED NOP (0)
+        _Z80_CASE( 484): _fetch(); // ED NOP (0)
+        _Z80_CASE( 485): _fetch(); // ED NOP (0)
+        _Z80_CASE( 486): _fetch(); // ED NOP (0)
+        _Z80_CASE( 487): _fetch(); // ED NOP (0)
+        _Z80_CASE( 488): _fetch(); // ED NOP (0)
+        _Z80_CASE( 489): _fetch(); // ED NOP (0)
+        _Z80_CASE( 490): _fetch(); // ED NOP (0)
+        _Z80_CASE( 491): _fetch(); // ED NOP (0)
+        _Z80_CASE( 492): _fetch(); // ED NOP (0)
+        _Z80_CASE( 493): _fetch(); // ED NOP (0)
+        _Z80_CASE( 494): _fetch(); // ED NOP (0)
+        _Z80_CASE( 495): _fetch(); // ED NOP (0)
+        _Z80_CASE( 496): _fetch(); // ED NOP (0)
+        _Z80_CASE( 497): _fetch(); // ED NOP (0)
+        _Z80_CASE( 498): _fetch(); // ED NOP (0)
+        _Z80_CASE( 499): _fetch(); // ED NOP (0)
+        _Z80_CASE( 500): _fetch(); // ED NOP (0)
+        _Z80_CASE( 501): _fetch(); // ED NOP (0)
+        _Z80_CASE( 502): _fetch(); // ED NOP (0)
+        _Z80_CASE( 503): _fetch(); // ED NOP (0)
+        _Z80_CASE( 504): _fetch(); // ED NOP (0)
+        _Z80_CASE( 505): _fetch(); // ED NOP (0)
+        _Z80_CASE( 506): _fetch(); // ED NOP (0)
+        _Z80_CASE( 507): _fetch(); // ED NOP (0)
+        _Z80_CASE( 508): _fetch(); // ED NOP (0)
+        _Z80_CASE( 509): _fetch(); // ED NOP (0)
+        _Z80_CASE( 510): _fetch(); // ED NOP (0)
+        _Z80_CASE( 511): _fetch(); // ED NOP (0)
+        _Z80_CASE( 512): _wait();_mread(cpu->pc++);_goto(513); // LD BC,nn (1)
+        _Z80_CASE( 513): cpu->c=_gd();_goto(514); // LD BC,nn (2)
+        _Z80_CASE( 514): _goto(515); // LD BC,nn (3)
+        _Z80_CASE( 515): _wait();_mread(cpu->pc++);_goto(516); // LD BC,nn (4)
+        _Z80_CASE( 516): cpu->b=_gd();_goto(517); // LD BC,nn (5)
+        _Z80_CASE( 517): _fetch(); // LD BC,nn (6)
+        _Z80_CASE( 518): _wait();_mwrite(cpu->bc,cpu->a);cpu->wzl=cpu->c+1;cpu->wzh=cpu->a;_goto(519); // LD (BC),A (1)
+        _Z80_CASE( 519): _goto(520); // LD (BC),A (2)
+        _Z80_CASE( 520): _fetch(); // LD (BC),A (3)
+        _Z80_CASE( 521): _goto(522); // INC BC (1)
+        _Z80_CASE( 522): _fetch(); // INC BC (2)
+        _Z80_CASE( 523): _wait();_mread(cpu->pc++);_goto(524); // LD B,n (1)
+        _Z80_CASE( 524): cpu->b=_gd();_goto(525); // LD B,n (2)
+        _Z80_CASE( 525): _fetch(); // LD B,n (3)
+        _Z80_CASE( 526): _goto(527); // ADD HL,BC (1)
+        _Z80_CASE( 527): _goto(528); // ADD HL,BC (2)
+        _Z80_CASE( 528): _goto(529); // ADD HL,BC (3)
+        _Z80_CASE( 529): _goto(530); // ADD HL,BC (4)
+        _Z80_CASE( 530): _goto(531); // ADD HL,BC (5)
+        _Z80_CASE( 531): _goto(532); // ADD HL,BC (6)
+        _Z80_CASE( 532): _fetch(); // ADD HL,BC (7)
+        _Z80_CASE( 533): _wait();_mread(cpu->bc);_goto(534); // LD A,(BC) (1)
+        _Z80_CASE( 534): cpu->a=_gd();cpu->wz=cpu->bc+1;_goto(535); // LD A,(BC) (2)
+        _Z80_CASE( 535): _fetch(); // LD A,(BC) (3)
+        _Z80_CASE( 536): _goto(537); // DEC BC (1)
+        _Z80_CASE( 537): _fetch(); // DEC BC (2)
+        _Z80_CASE( 538): _wait();_mread(cpu->pc++);_goto(539); // LD C,n (1)
+        _Z80_CASE( 539): cpu->c=_gd();_goto(540); // LD C,n (2)
+        _Z80_CASE( 540): _fetch(); // LD C,n (3)
+        _Z80_CASE( 541): _goto(542); // DJNZ d (1)
+        _Z80_CASE( 542): _wait();_mread(cpu->pc++);_goto(543); // DJNZ d (2)
+        _Z80_CASE( 543): cpu->dlatch=_gd();if(--cpu->b==0){_goto(544+5);};_goto(544); // DJNZ d (3)
+        _Z80_CASE( 544): cpu->pc+=(int8_t)cpu->dlatch;cpu->wz=cpu->pc;_goto(545); // DJNZ d (4)
+        _Z80_CASE( 545): _goto(546); // DJNZ d (5)
+        _Z80_CASE( 546): _goto(547); // DJNZ d (6)
+        _Z80_CASE( 547): _goto(548); // DJNZ d (7)
+        _Z80_CASE( 548): _goto(549); // DJNZ d (8)
+        _Z80_CASE( 549): _fetch(); // DJNZ d (9)
+        _Z80_CASE( 550): _wait();_mread(cpu->pc++);_goto(551); // LD DE,nn (1)
+        _Z80_CASE( 551): cpu->e=_gd();_goto(552); // LD DE,nn (2)
+        _Z80_CASE( 552): _goto(553); // LD DE,nn (3)
+        _Z80_CASE( 553): _wait();_mread(cpu->pc++);_goto(554); // LD DE,nn (4)
+        _Z80_CASE( 554): cpu->d=_gd();_goto(555); // LD DE,nn (5)
+        _Z80_CASE( 555): _fetch(); // LD DE,nn (6)
+        _Z80_CASE( 556): _wait();_mwrite(cpu->de,cpu->a);cpu->wzl=cpu->e+1;cpu->wzh=cpu->a;_goto(557); // LD (DE),A (1)
+        _Z80_CASE( 557): _goto(558); // LD (DE),A (2)
+        _Z80_CASE( 558): _fetch(); // LD (DE),A (3)
+        _Z80_CASE( 559): _goto(560); // INC DE (1)
+        _Z80_CASE( 560): _fetch(); // INC DE (2)
+        _Z80_CASE( 561): _wait();_mread(cpu->pc++);_goto(562); // LD D,n (1)
+        _Z80_CASE( 562): cpu->d=_gd();_goto(563); // LD D,n (2)
+        _Z80_CASE( 563): _fetch(); // LD D,n (3)
+        _Z80_CASE( 564): _wait();_mread(cpu->pc++);_goto(565); // JR d (1)
+        _Z80_CASE( 565): cpu->dlatch=_gd();_goto(566); // JR d (2)
+        _Z80_CASE( 566): cpu->pc+=(int8_t)cpu->dlatch;cpu->wz=cpu->pc;_goto(567); // JR d (3)
+        _Z80_CASE( 567): _goto(568); // JR d (4)
+        _Z80_CASE( 568): _goto(569); // JR d (5)
+        _Z80_CASE( 569): _goto(570); // JR d (6)
+        _Z80_CASE( 570): _goto(571); // JR d (7)
+        _Z80_CASE( 571): _fetch(); // JR d (8)
+        _Z80_CASE( 572): _goto(573); // ADD HL,DE (1)
+        _Z80_CASE( 573): _goto(574); // ADD HL,DE (2)
+        _Z80_CASE( 574): _goto(575); // ADD HL,DE (3)
+        _Z80_CASE( 575): _goto(576); // ADD HL,DE (4)
+        _Z80_CASE( 576): _goto(577); // ADD HL,DE (5)
+        _Z80_CASE( 577): _goto(578); // ADD HL,DE (6)
+        _Z80_CASE( 578): _fetch(); // ADD HL,DE (7)
+        _Z80_CASE( 579): _wait();_mread(cpu->de);_goto(580); // LD A,(DE) (1)
+        _Z80_CASE( 580): cpu->a=_gd();cpu->wz=cpu->de+1;_goto(581); // LD A,(DE) (2)
+        _Z80_CASE( 581): _fetch(); // LD A,(DE) (3)
+        _Z80_CASE( 582): _goto(583); // DEC DE (1)
+        _Z80_CASE( 583): _fetch(); // DEC DE (2)
+        _Z80_CASE( 584): _wait();_mread(cpu->pc++);_goto(585); // LD E,n (1)
+        _Z80_CASE( 585): cpu->e=_gd();_goto(586); // LD E,n (2)
+        _Z80_CASE( 586): _fetch(); // LD E,n (3)
+        _Z80_CASE( 587): _wait();_mread(cpu->pc++);_goto(588); // JR NZ,d (1)
+        _Z80_CASE( 588): cpu->dlatch=_gd();if(!(_cc_nz)){_goto(589+5);};_goto(589); // JR NZ,d (2)
+        _Z80_CASE( 589): cpu->pc+=(int8_t)cpu->dlatch;cpu->wz=cpu->pc;_goto(590); // JR NZ,d (3)
+        _Z80_CASE( 590): _goto(591); // JR NZ,d (4)
+        _Z80_CASE( 591): _goto(592); // JR NZ,d (5)
+        _Z80_CASE( 592): _goto(593); // JR NZ,d (6)
+        _Z80_CASE( 593): _goto(594); // JR NZ,d (7)
+        _Z80_CASE( 594): _fetch(); // JR NZ,d (8)
+        _Z80_CASE( 595): _wait();_mread(cpu->pc++);_goto(596); // LD HL,nn (1)
+        _Z80_CASE( 596): cpu->hlx[cpu->hlx_idx].l=_gd();_goto(597); // LD HL,nn (2)
+        _Z80_CASE( 597): _goto(598); // LD HL,nn (3)
+        _Z80_CASE( 598): _wait();_mread(cpu->pc++);_goto(599); // LD HL,nn (4)
+        _Z80_CASE( 599): cpu->hlx[cpu->hlx_idx].h=_gd();_goto(600); // LD HL,nn (5)
+        _Z80_CASE( 600): _fetch(); // LD HL,nn (6)
+        _Z80_CASE( 601): _wait();_mread(cpu->pc++);_goto(602); // LD (nn),HL (1)
+        _Z80_CASE( 602): cpu->wzl=_gd();_goto(603); // LD (nn),HL (2)
+        _Z80_CASE( 603): _goto(604); // LD (nn),HL (3)
+        _Z80_CASE( 604): _wait();_mread(cpu->pc++);_goto(605); // LD (nn),HL (4)
+        _Z80_CASE( 605): cpu->wzh=_gd();_goto(606); // LD (nn),HL (5)
+        _Z80_CASE( 606): _goto(607); // LD (nn),HL (6)
+        _Z80_CASE( 607): _wait();_mwrite(cpu->wz++,cpu->hlx[cpu->hlx_idx].l);_goto(608); // LD (nn),HL (7)
+        _Z80_CASE( 608): _goto(609); // LD (nn),HL (8)
+        _Z80_CASE( 609): _goto(610); // LD (nn),HL (9)
+        _Z80_CASE( 610): _wait();_mwrite(cpu->wz,cpu->hlx[cpu->hlx_idx].h);_goto(611); // LD (nn),HL (10)
+        _Z80_CASE( 611): _goto(612); // LD (nn),HL (11)
+        _Z80_CASE( 612): _fetch(); // LD (nn),HL (12)
+        _Z80_CASE( 613): _goto(614); // INC HL (1)
+        _Z80_CASE( 614): _fetch(); // INC HL (2)
+        _Z80_CASE( 615): _wait();_mread(cpu->pc++);_goto(616); // LD H,n (1)
+        _Z80_CASE( 616): cpu->hlx[cpu->hlx_idx].h=_gd();_goto(617); // LD H,n (2)
+        _Z80_CASE( 617): _fetch(); // LD H,n (3)
+        _Z80_CASE( 618): _wait();_mread(cpu->pc++);_goto(619); // JR Z,d (1)
+        _Z80_CASE( 619): cpu->dlatch=_gd();if(!(_cc_z)){_goto(620+5);};_goto(620); // JR Z,d (2)
+        _Z80_CASE( 620): cpu->pc+=(int8_t)cpu->dlatch;cpu->wz=cpu->pc;_goto(621); // JR Z,d (3)
+        _Z80_CASE( 621): _goto(622); // JR Z,d (4)
+        _Z80_CASE( 622): _goto(623); // JR Z,d (5)
+        _Z80_CASE( 623): _goto(624); // JR Z,d (6)
+        _Z80_CASE( 624): _goto(625); // JR Z,d (7)
+        _Z80_CASE( 625): _fetch(); // JR Z,d (8)
+        _Z80_CASE( 626): _goto(627); // ADD HL,HL (1)
+        _Z80_CASE( 627): _goto(628); // ADD HL,HL (2)
+        _Z80_CASE( 628): _goto(629); // ADD HL,HL (3)
+        _Z80_CASE( 629): _goto(630); // ADD HL,HL (4)
+        _Z80_CASE( 630): _goto(631); // ADD HL,HL (5)
+        _Z80_CASE( 631): _goto(632); // ADD HL,HL (6)
+        _Z80_CASE( 632): _fetch(); // ADD HL,HL (7)
+        _Z80_CASE( 633): _wait();_mread(cpu->pc++);_goto(634); // LD HL,(nn) (1)
+        _Z80_CASE( 634): cpu->wzl=_gd();_goto(635); // LD HL,(nn) (2)
+        _Z80_CASE( 635): _goto(636); // LD HL,(nn) (3)
+        _Z80_CASE( 636): _wait();_mread(cpu->pc++);_goto(637); // LD HL,(nn) (4)
+        _Z80_CASE( 637): cpu->wzh=_gd();_goto(638); // LD HL,(nn) (5)
+        _Z80_CASE( 638): _goto(639); // LD HL,(nn) (6)
+        _Z80_CASE( 639): _wait();_mread(cpu->wz++);_goto(640); // LD HL,(nn) (7)
+        _Z80_CASE( 640): cpu->hlx[cpu->hlx_idx].l=_gd();_goto(641); // LD HL,(nn) (8)
+        _Z80_CASE( 641): _goto(642); // LD HL,(nn) (9)
+        _Z80_CASE( 642): _wait();_mread(cpu->wz);_goto(643); // LD HL,(nn) (10)
+        _Z80_CASE( 643): cpu->hlx[cpu->hlx_idx].h=_gd();_goto(644); // LD HL,(nn) (11)
+        _Z80_CASE( 644): _fetch(); // LD HL,(nn) (12)
+        _Z80_CASE( 645): _goto(646); // DEC HL (1)
+        _Z80_CASE( 646): _fetch(); // DEC HL (2)
+        _Z80_CASE( 647): _wait();_mread(cpu->pc++);_goto(648); // LD L,n (1)
+        _Z80_CASE( 648): cpu->hlx[cpu->hlx_idx].l=_gd();_goto(649); // LD L,n (2)
+        _Z80_CASE( 649): _fetch(); // LD L,n (3)
+        _Z80_CASE( 650): _wait();_mread(cpu->pc++);_goto(651); // JR NC,d (1)
+        _Z80_CASE( 651): cpu->dlatch=_gd();if(!(_cc_nc)){_goto(652+5);};_goto(652); // JR NC,d (2)
+        _Z80_CASE( 652): cpu->pc+=(int8_t)cpu->dlatch;cpu->wz=cpu->pc;_goto(653); // JR NC,d (3)
+        _Z80_CASE( 653): _goto(654); // JR NC,d (4)
+        _Z80_CASE( 654): _goto(655); // JR NC,d (5)
+        _Z80_CASE( 655): _goto(656); // JR NC,d (6)
+        _Z80_CASE( 656): _goto(657); // JR NC,d (7)
+        _Z80_CASE( 657): _fetch(); // JR NC,d (8)
+        _Z80_CASE( 658): _wait();_mread(cpu->pc++);_goto(659); // LD SP,nn (1)
+        _Z80_CASE( 659): cpu->spl=_gd();_goto(660); // LD SP,nn (2)
+        _Z80_CASE( 660): _goto(661); // LD SP,nn (3)
+        _Z80_CASE( 661): _wait();_mread(cpu->pc++);_goto(662); // LD SP,nn (4)
+        _Z80_CASE( 662): cpu->sph=_gd();_goto(663); // LD SP,nn (5)
+        _Z80_CASE( 663): _fetch(); // LD SP,nn (6)
+        _Z80_CASE( 664): _wait();_mread(cpu->pc++);_goto(665); // LD (nn),A (1)
+        _Z80_CASE( 665): cpu->wzl=_gd();_goto(666); // LD (nn),A (2)
+        _Z80_CASE( 666): _goto(667); // LD (nn),A (3)
+        _Z80_CASE( 667): _wait();_mread(cpu->pc++);_goto(668); // LD (nn),A (4)
+        _Z80_CASE( 668): cpu->wzh=_gd();_goto(669); // LD (nn),A (5)
+        _Z80_CASE( 669): _goto(670); // LD (nn),A (6)
+        _Z80_CASE( 670): _wait();_mwrite(cpu->wz++,cpu->a);cpu->wzh=cpu->a;_goto(671); // LD (nn),A (7)
+        _Z80_CASE( 671): _goto(672); // LD (nn),A (8)
+        _Z80_CASE( 672): _fetch(); // LD (nn),A (9)
+        _Z80_CASE( 673): _goto(674); // INC SP (1)
+        _Z80_CASE( 674): _fetch(); // INC SP (2)
+        _Z80_CASE( 675): _wait();_mread(cpu->addr);_goto(676); // INC (HL) (1)
+        _Z80_CASE( 676): cpu->dlatch=_gd();cpu->dlatch=_z80_inc8(cpu,cpu->dlatch);_goto(677); // INC (HL) (2)
+        _Z80_CASE( 677): _goto(678); // INC (HL) (3)
+        _Z80_CASE( 678): _goto(679); // INC (HL) (4)
+        _Z80_CASE( 679): _wait();_mwrite(cpu->addr,cpu->dlatch);_goto(680); // INC (HL) (5)
+        _Z80_CASE( 680): _goto(681); // INC (HL) (6)
+        _Z80_CASE( 681): _fetch(); // INC (HL) (7)
+        _Z80_CASE( 682): _wait();_mread(cpu->addr);_goto(683); // DEC (HL) (1)
+        _Z80_CASE( 683): cpu->dlatch=_gd();cpu->dlatch=_z80_dec8(cpu,cpu->dlatch);_goto(684); // DEC (HL) (2)
+        _Z80_CASE( 684): _goto(685); // DEC (HL) (3)
+        _Z80_CASE( 685): _goto(686); // DEC (HL) (4)
+        _Z80_CASE( 686): _wait();_mwrite(cpu->addr,cpu->dlatch);_goto(687); // DEC (HL) (5)
+        _Z80_CASE( 687): _goto(688); // DEC (HL) (6)
+        _Z80_CASE( 688): _fetch(); // DEC (HL) (7)
+        _Z80_CASE( 689): _wait();_mread(cpu->pc++);_goto(690); // LD (HL),n (1)
+        _Z80_CASE( 690): cpu->dlatch=_gd();_goto(691); // LD (HL),n (2)
+        _Z80_CASE( 691): _goto(692); // LD (HL),n (3)
+        _Z80_CASE( 692): _wait();_mwrite(cpu->addr,cpu->dlatch);_goto(693); // LD (HL),n (4)
+        _Z80_CASE( 693): _goto(694); // LD (HL),n (5)
+        _Z80_CASE( 694): _fetch(); // LD (HL),n (6)
+        _Z80_CASE( 695): _wait();_mread(cpu->pc++);_goto(696); // JR C,d (1)
+        _Z80_CASE( 696): cpu->dlatch=_gd();if(!(_cc_c)){_goto(697+5);};_goto(697); // JR C,d (2)
+        _Z80_CASE( 697): cpu->pc+=(int8_t)cpu->dlatch;cpu->wz=cpu->pc;_goto(698); // JR C,d (3)
+        _Z80_CASE( 698): _goto(699); // JR C,d (4)
+        _Z80_CASE( 699): _goto(700); // JR C,d (5)
+        _Z80_CASE( 700): _goto(701); // JR C,d (6)
+        _Z80_CASE( 701): _goto(702); // JR C,d (7)
+        _Z80_CASE( 702): _fetch(); // JR C,d (8)
+        _Z80_CASE( 703): _goto(704); // ADD HL,SP (1)
+        _Z80_CASE( 704): _goto(705); // ADD HL,SP (2)
+        _Z80_CASE( 705): _goto(706); // ADD HL,SP (3)
+        _Z80_CASE( 706): _goto(707); // ADD HL,SP (4)
+        _Z80_CASE( 707): _goto(708); // ADD HL,SP (5)
+        _Z80_CASE( 708): _goto(709); // ADD HL,SP (6)
+        _Z80_CASE( 709): _fetch(); // ADD HL,SP (7)
+        _Z80_CASE( 710): _wait();_mread(cpu->pc++);_goto(711); // LD A,(nn) (1)
+        _Z80_CASE( 711): cpu->wzl=_gd();_goto(712); // LD A,(nn) (2)
+        _Z80_CASE( 712): _goto(713); // LD A,(nn) (3)
+        _Z80_CASE( 713): _wait();_mread(cpu->pc++);_goto(714); // LD A,(nn) (4)
+        _Z80_CASE( 714): cpu->wzh=_gd();_goto(715); // LD A,(nn) (5)
+        _Z80_CASE( 715): _goto(716); // LD A,(nn) (6)
+        _Z80_CASE( 716): _wait();_mread(cpu->wz++);_goto(717); // LD A,(nn) (7)
+        _Z80_CASE( 717): cpu->a=_gd();_goto(718); // LD A,(nn) (8)
+        _Z80_CASE( 718): _fetch(); // LD A,(nn) (9)
+        _Z80_CASE( 719): _goto(720); // DEC SP (1)
+        _Z80_CASE( 720): _fetch(); // DEC SP (2)
+        _Z80_CASE( 721): _wait();_mread(cpu->pc++);_goto(722); // LD A,n (1)
+        _Z80_CASE( 722): cpu->a=_gd();_goto(723); // LD A,n (2)
+        _Z80_CASE( 723): _fetch(); // LD A,n (3)
+        _Z80_CASE( 724): _wait();_mread(cpu->addr);_goto(725); // LD B,(HL) (1)
+        _Z80_CASE( 725): cpu->b=_gd();_goto(726); // LD B,(HL) (2)
+        _Z80_CASE( 726): _fetch(); // LD B,(HL) (3)
+        _Z80_CASE( 727): _wait();_mread(cpu->addr);_goto(728); // LD C,(HL) (1)
+        _Z80_CASE( 728): cpu->c=_gd();_goto(729); // LD C,(HL) (2)
+        _Z80_CASE( 729): _fetch(); // LD C,(HL) (3)
+        _Z80_CASE( 730): _wait();_mread(cpu->addr);_goto(731); // LD D,(HL) (1)
+        _Z80_CASE( 731): cpu->d=_gd();_goto(732); // LD D,(HL) (2)
+        _Z80_CASE( 732): _fetch(); // LD D,(HL) (3)
+        _Z80_CASE( 733): _wait();_mread(cpu->addr);_goto(734); // LD E,(HL) (1)
+        _Z80_CASE( 734): cpu->e=_gd();_goto(735); // LD E,(HL) (2)
+        _Z80_CASE( 735): _fetch(); // LD E,(HL) (3)
+        _Z80_CASE( 736): _wait();_mread(cpu->addr);_goto(737); // LD H,(HL) (1)
+        _Z80_CASE( 737): cpu->h=_gd();_goto(738); // LD H,(HL) (2)
+        _Z80_CASE( 738): _fetch(); // LD H,(HL) (3)
+        _Z80_CASE( 739): _wait();_mread(cpu->addr);_goto(740); // LD L,(HL) (1)
+        _Z80_CASE( 740): cpu->l=_gd();_goto(741); // LD L,(HL) (2)
+        _Z80_CASE( 741): _fetch(); // LD L,(HL) (3)
+        _Z80_CASE( 742): _wait();_mwrite(cpu->addr,cpu->b);_goto(743); // LD (HL),B (1)
+        _Z80_CASE( 743): _goto(744); // LD (HL),B (2)
+        _Z80_CASE( 744): _fetch(); // LD (HL),B (3)
+        _Z80_CASE( 745): _wait();_mwrite(cpu->addr,cpu->c);_goto(746); // LD (HL),C (1)
+        _Z80_CASE( 746): _goto(747); // LD (HL),C (2)
+        _Z80_CASE( 747): _fetch(); // LD (HL),C (3)
+        _Z80_CASE( 748): _wait();_mwrite(cpu->addr,cpu->d);_goto(749); // LD (HL),D (1)
+        _Z80_CASE( 749): _goto(750); // LD (HL),D (2)
+        _Z80_CASE( 750): _fetch(); // LD (HL),D (3)
+        _Z80_CASE( 751): _wait();_mwrite(cpu->addr,cpu->e);_goto(752); // LD (HL),E (1)
+        _Z80_CASE( 752): _goto(753); // LD (HL),E (2)
+        _Z80_CASE( 753): _fetch(); // LD (HL),E (3)
+        _Z80_CASE( 754): _wait();_mwrite(cpu->addr,cpu->h);_goto(755); // LD (HL),H (1)
+        _Z80_CASE( 755): _goto(756); // LD (HL),H (2)
+        _Z80_CASE( 756): _fetch(); // LD (HL),H (3)
+        _Z80_CASE( 757): _wait();_mwrite(cpu->addr,cpu->l);_goto(758); // LD (HL),L (1)
+        _Z80_CASE( 758): _goto(759); // LD (HL),L (2)
+        _Z80_CASE( 759): _fetch(); // LD (HL),L (3)
+        _Z80_CASE( 760): _wait();_mwrite(cpu->addr,cpu->a);_goto(761); // LD (HL),A (1)
+        _Z80_CASE( 761): _goto(762); // LD (HL),A (2)
+        _Z80_CASE( 762): _fetch(); // LD (HL),A (3)
+        _Z80_CASE( 763): _wait();_mread(cpu->addr);_goto(764); // LD A,(HL) (1)
+        _Z80_CASE( 764): cpu->a=_gd();_goto(765); // LD A,(HL) (2)
+        _Z80_CASE( 765): _fetch(); // LD A,(HL) (3)
+        _Z80_CASE( 766): _wait();_mread(cpu->addr);_goto(767); // ADD (HL) (1)
+        _Z80_CASE( 767): cpu->dlatch=_gd();_goto(768); // ADD (HL) (2)
+        _Z80_CASE( 768): _z80_add8(cpu,cpu->dlatch);_fetch(); // ADD (HL) (3)
+        _Z80_CASE( 769): _wait();_mread(cpu->addr);_goto(770); // ADC (HL) (1)
+        _Z80_CASE( 770): cpu->dlatch=_gd();_goto(771); // ADC (HL) (2)
+        _Z80_CASE( 771): _z80_adc8(cpu,cpu->dlatch);_fetch(); // ADC (HL) (3)
+        _Z80_CASE( 772): _wait();_mread(cpu->addr);_goto(773); // SUB (HL) (1)
+        _Z80_CASE( 773): cpu->dlatch=_gd();_goto(774); // SUB (HL) (2)
+        _Z80_CASE( 774): _z80_sub8(cpu,cpu->dlatch);_fetch(); // SUB (HL) (3)
+        _Z80_CASE( 775): _wait();_mread(cpu->addr);_goto(776); // SBC (HL) (1)
+        _Z80_CASE( 776): cpu->dlatch=_gd();_goto(777); // SBC (HL) (2)
+        _Z80_CASE( 777): _z80_sbc8(cpu,cpu->dlatch);_fetch(); // SBC (HL) (3)
+        _Z80_CASE( 778): _wait();_mread(cpu->addr);_goto(779); // AND (HL) (1)
+        _Z80_CASE( 779): cpu->dlatch=_gd();_goto(780); // AND (HL) (2)
+        _Z80_CASE( 780): _z80_and8(cpu,cpu->dlatch);_fetch(); // AND (HL) (3)
+        _Z80_CASE( 781): _wait();_mread(cpu->addr);_goto(782); // XOR (HL) (1)
+        _Z80_CASE( 782): cpu->dlatch=_gd();_goto(783); // XOR (HL) (2)
+        _Z80_CASE( 783): _z80_xor8(cpu,cpu->dlatch);_fetch(); // XOR (HL) (3)
+        _Z80_CASE( 784): _wait();_mread(cpu->addr);_goto(785); // OR (HL) (1)
+        _Z80_CASE( 785): cpu->dlatch=_gd();_goto(786); // OR (HL) (2)
+        _Z80_CASE( 786): _z80_or8(cpu,cpu->dlatch);_fetch(); // OR (HL) (3)
+        _Z80_CASE( 787): _wait();_mread(cpu->addr);_goto(788); // CP (HL) (1)
+        _Z80_CASE( 788): cpu->dlatch=_gd();_goto(789); // CP (HL) (2)
+        _Z80_CASE( 789): _z80_cp8(cpu,cpu->dlatch);_fetch(); // CP (HL) (3)
+        _Z80_CASE( 790): _goto(791); // RET NZ (1)
+        _Z80_CASE( 791): _wait();_mread(cpu->sp++);_goto(792); // RET NZ (2)
+        _Z80_CASE( 792): cpu->wzl=_gd();_goto(793); // RET NZ (3)
+        _Z80_CASE( 793): _goto(794); // RET NZ (4)
+        _Z80_CASE( 794): _wait();_mread(cpu->sp++);_goto(795); // RET NZ (5)
+        _Z80_CASE( 795): cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(796); // RET NZ (6)
+        _Z80_CASE( 796): _fetch(); // RET NZ (7)
+        _Z80_CASE( 797): _wait();_mread(cpu->sp++);_goto(798); // POP BC (1)
+        _Z80_CASE( 798): cpu->c=_gd();_goto(799); // POP BC (2)
+        _Z80_CASE( 799): _goto(800); // POP BC (3)
+        _Z80_CASE( 800): _wait();_mread(cpu->sp++);_goto(801); // POP BC (4)
+        _Z80_CASE( 801): cpu->b=_gd();_goto(802); // POP BC (5)
+        _Z80_CASE( 802): _fetch(); // POP BC (6)
+        _Z80_CASE( 803): _wait();_mread(cpu->pc++);_goto(804); // JP NZ,nn (1)
+        _Z80_CASE( 804): cpu->wzl=_gd();_goto(805); // JP NZ,nn (2)
+        _Z80_CASE( 805): _goto(806); // JP NZ,nn (3)
+        _Z80_CASE( 806): _wait();_mread(cpu->pc++);_goto(807); // JP NZ,nn (4)
+        _Z80_CASE( 807): cpu->wzh=_gd();if(_cc_nz){cpu->pc=cpu->wz;};_goto(808); // JP NZ,nn (5)
+        _Z80_CASE( 808): _fetch(); // JP NZ,nn (6)
+        _Z80_CASE( 809): _wait();_mread(cpu->pc++);_goto(810); // JP nn (1)
+        _Z80_CASE( 810): cpu->wzl=_gd();_goto(811); // JP nn (2)
+        _Z80_CASE( 811): _goto(812); // JP nn (3)
+        _Z80_CASE( 812): _wait();_mread(cpu->pc++);_goto(813); // JP nn (4)
+        _Z80_CASE( 813): cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(814); // JP nn (5)
+        _Z80_CASE( 814): _fetch(); // JP nn (6)
+        _Z80_CASE( 815): _wait();_mread(cpu->pc++);_goto(816); // CALL NZ,nn (1)
+        _Z80_CASE( 816): cpu->wzl=_gd();_goto(817); // CALL NZ,nn (2)
+        _Z80_CASE( 817): _goto(818); // CALL NZ,nn (3)
+        _Z80_CASE( 818): _wait();_mread(cpu->pc++);_goto(819); // CALL NZ,nn (4)
+        _Z80_CASE( 819): cpu->wzh=_gd();if (!_cc_nz){_goto(820+7);};_goto(820); // CALL NZ,nn (5)
+        _Z80_CASE( 820): _goto(821); // CALL NZ,nn (6)
+        _Z80_CASE( 821): _goto(822); // CALL NZ,nn (7)
+        _Z80_CASE( 822): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(823); // CALL NZ,nn (8)
+        _Z80_CASE( 823): _goto(824); // CALL NZ,nn (9)
+        _Z80_CASE( 824): _goto(825); // CALL NZ,nn (10)
+        _Z80_CASE( 825): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(826); // CALL NZ,nn (11)
+        _Z80_CASE( 826): _goto(827); // CALL NZ,nn (12)
+        _Z80_CASE( 827): _fetch(); // CALL NZ,nn (13)
+        _Z80_CASE( 828): _goto(829); // PUSH BC (1)
+        _Z80_CASE( 829): _wait();_mwrite(--cpu->sp,cpu->b);_goto(830); // PUSH BC (2)
+        _Z80_CASE( 830): _goto(831); // PUSH BC (3)
+        _Z80_CASE( 831): _goto(832); // PUSH BC (4)
+        _Z80_CASE( 832): _wait();_mwrite(--cpu->sp,cpu->c);_goto(833); // PUSH BC (5)
+        _Z80_CASE( 833): _goto(834); // PUSH BC (6)
+        _Z80_CASE( 834): _fetch(); // PUSH BC (7)
+        _Z80_CASE( 835): _wait();_mread(cpu->pc++);_goto(836); // ADD n (1)
+        _Z80_CASE( 836): cpu->dlatch=_gd();_goto(837); // ADD n (2)
+        _Z80_CASE( 837): _z80_add8(cpu,cpu->dlatch);_fetch(); // ADD n (3)
+        _Z80_CASE( 838): _goto(839); // RST 0h (1)
+        _Z80_CASE( 839): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(840); // RST 0h (2)
+        _Z80_CASE( 840): _goto(841); // RST 0h (3)
+        _Z80_CASE( 841): _goto(842); // RST 0h (4)
+        _Z80_CASE( 842): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=0x00;cpu->pc=cpu->wz;_goto(843); // RST 0h (5)
+        _Z80_CASE( 843): _goto(844); // RST 0h (6)
+        _Z80_CASE( 844): _fetch(); // RST 0h (7)
+        _Z80_CASE( 845): _goto(846); // RET Z (1)
+        _Z80_CASE( 846): _wait();_mread(cpu->sp++);_goto(847); // RET Z (2)
+        _Z80_CASE( 847): cpu->wzl=_gd();_goto(848); // RET Z (3)
+        _Z80_CASE( 848): _goto(849); // RET Z (4)
+        _Z80_CASE( 849): _wait();_mread(cpu->sp++);_goto(850); // RET Z (5)
+        _Z80_CASE( 850): cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(851); // RET Z (6)
+        _Z80_CASE( 851): _fetch(); // RET Z (7)
+        _Z80_CASE( 852): _wait();_mread(cpu->sp++);_goto(853); // RET (1)
+        _Z80_CASE( 853): cpu->wzl=_gd();_goto(854); // RET (2)
+        _Z80_CASE( 854): _goto(855); // RET (3)
+        _Z80_CASE( 855): _wait();_mread(cpu->sp++);_goto(856); // RET (4)
+        _Z80_CASE( 856): cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(857); // RET (5)
+        _Z80_CASE( 857): _fetch(); // RET (6)
+        _Z80_CASE( 858): _wait();_mread(cpu->pc++);_goto(859); // JP Z,nn (1)
+        _Z80_CASE( 859): cpu->wzl=_gd();_goto(860); // JP Z,nn (2)
+        _Z80_CASE( 860): _goto(861); // JP Z,nn (3)
+        _Z80_CASE( 861): _wait();_mread(cpu->pc++);_goto(862); // JP Z,nn (4)
+        _Z80_CASE( 862): cpu->wzh=_gd();if(_cc_z){cpu->pc=cpu->wz;};_goto(863); // JP Z,nn (5)
+        _Z80_CASE( 863): _fetch(); // JP Z,nn (6)
+        _Z80_CASE( 864): _wait();_mread(cpu->pc++);_goto(865); // CALL Z,nn (1)
+        _Z80_CASE( 865): cpu->wzl=_gd();_goto(866); // CALL Z,nn (2)
+        _Z80_CASE( 866): _goto(867); // CALL Z,nn (3)
+        _Z80_CASE( 867): _wait();_mread(cpu->pc++);_goto(868); // CALL Z,nn (4)
+        _Z80_CASE( 868): cpu->wzh=_gd();if (!_cc_z){_goto(869+7);};_goto(869); // CALL Z,nn (5)
+        _Z80_CASE( 869): _goto(870); // CALL Z,nn (6)
+        _Z80_CASE( 870): _goto(871); // CALL Z,nn (7)
+        _Z80_CASE( 871): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(872); // CALL Z,nn (8)
+        _Z80_CASE( 872): _goto(873); // CALL Z,nn (9)
+        _Z80_CASE( 873): _goto(874); // CALL Z,nn (10)
+        _Z80_CASE( 874): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(875); // CALL Z,nn (11)
+        _Z80_CASE( 875): _goto(876); // CALL Z,nn (12)
+        _Z80_CASE( 876): _fetch(); // CALL Z,nn (13)
+        _Z80_CASE( 877): _wait();_mread(cpu->pc++);_goto(878); // CALL nn (1)
+        _Z80_CASE( 878): cpu->wzl=_gd();_goto(879); // CALL nn (2)
+        _Z80_CASE( 879): _goto(880); // CALL nn (3)
+        _Z80_CASE( 880): _wait();_mread(cpu->pc++);_goto(881); // CALL nn (4)
+        _Z80_CASE( 881): cpu->wzh=_gd();_goto(882); // CALL nn (5)
+        _Z80_CASE( 882): _goto(883); // CALL nn (6)
+        _Z80_CASE( 883): _goto(884); // CALL nn (7)
+        _Z80_CASE( 884): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(885); // CALL nn (8)
+        _Z80_CASE( 885): _goto(886); // CALL nn (9)
+        _Z80_CASE( 886): _goto(887); // CALL nn (10)
+        _Z80_CASE( 887): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(888); // CALL nn (11)
+        _Z80_CASE( 888): _goto(889); // CALL nn (12)
+        _Z80_CASE( 889): _fetch(); // CALL nn (13)
+        _Z80_CASE( 890): _wait();_mread(cpu->pc++);_goto(891); // ADC n (1)
+        _Z80_CASE( 891): cpu->dlatch=_gd();_goto(892); // ADC n (2)
+        _Z80_CASE( 892): _z80_adc8(cpu,cpu->dlatch);_fetch(); // ADC n (3)
+        _Z80_CASE( 893): _goto(894); // RST 8h (1)
+        _Z80_CASE( 894): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(895); // RST 8h (2)
+        _Z80_CASE( 895): _goto(896); // RST 8h (3)
+        _Z80_CASE( 896): _goto(897); // RST 8h (4)
+        _Z80_CASE( 897): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=0x08;cpu->pc=cpu->wz;_goto(898); // RST 8h (5)
+        _Z80_CASE( 898): _goto(899); // RST 8h (6)
+        _Z80_CASE( 899): _fetch(); // RST 8h (7)
+        _Z80_CASE( 900): _goto(901); // RET NC (1)
+        _Z80_CASE( 901): _wait();_mread(cpu->sp++);_goto(902); // RET NC (2)
+        _Z80_CASE( 902): cpu->wzl=_gd();_goto(903); // RET NC (3)
+        _Z80_CASE( 903): _goto(904); // RET NC (4)
+        _Z80_CASE( 904): _wait();_mread(cpu->sp++);_goto(905); // RET NC (5)
+        _Z80_CASE( 905): cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(906); // RET NC (6)
+        _Z80_CASE( 906): _fetch(); // RET NC (7)
+        _Z80_CASE( 907): _wait();_mread(cpu->sp++);_goto(908); // POP DE (1)
+        _Z80_CASE( 908): cpu->e=_gd();_goto(909); // POP DE (2)
+        _Z80_CASE( 909): _goto(910); // POP DE (3)
+        _Z80_CASE( 910): _wait();_mread(cpu->sp++);_goto(911); // POP DE (4)
+        _Z80_CASE( 911): cpu->d=_gd();_goto(912); // POP DE (5)
+        _Z80_CASE( 912): _fetch(); // POP DE (6)
+        _Z80_CASE( 913): _wait();_mread(cpu->pc++);_goto(914); // JP NC,nn (1)
+        _Z80_CASE( 914): cpu->wzl=_gd();_goto(915); // JP NC,nn (2)
+        _Z80_CASE( 915): _goto(916); // JP NC,nn (3)
+        _Z80_CASE( 916): _wait();_mread(cpu->pc++);_goto(917); // JP NC,nn (4)
+        _Z80_CASE( 917): cpu->wzh=_gd();if(_cc_nc){cpu->pc=cpu->wz;};_goto(918); // JP NC,nn (5)
+        _Z80_CASE( 918): _fetch(); // JP NC,nn (6)
+        _Z80_CASE( 919): _wait();_mread(cpu->pc++);_goto(920); // OUT (n),A (1)
+        _Z80_CASE( 920): cpu->wzl=_gd();cpu->wzh=cpu->a;_goto(921); // OUT (n),A (2)
+        _Z80_CASE( 921): _goto(922); // OUT (n),A (3)
+        _Z80_CASE( 922): _iowrite(cpu->wz,cpu->a);_goto(923); // OUT (n),A (4)
+        _Z80_CASE( 923): _wait();cpu->wzl++;_goto(924); // OUT (n),A (5)
+        _Z80_CASE( 924): _goto(925); // OUT (n),A (6)
+        _Z80_CASE( 925): _fetch(); // OUT (n),A (7)
+        _Z80_CASE( 926): _wait();_mread(cpu->pc++);_goto(927); // CALL NC,nn (1)
+        _Z80_CASE( 927): cpu->wzl=_gd();_goto(928); // CALL NC,nn (2)
+        _Z80_CASE( 928): _goto(929); // CALL NC,nn (3)
+        _Z80_CASE( 929): _wait();_mread(cpu->pc++);_goto(930); // CALL NC,nn (4)
+        _Z80_CASE( 930): cpu->wzh=_gd();if (!_cc_nc){_goto(931+7);};_goto(931); // CALL NC,nn (5)
+        _Z80_CASE( 931): _goto(932); // CALL NC,nn (6)
+        _Z80_CASE( 932): _goto(933); // CALL NC,nn (7)
+        _Z80_CASE( 933): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(934); // CALL NC,nn (8)
+        _Z80_CASE( 934): _goto(935); // CALL NC,nn (9)
+        _Z80_CASE( 935): _goto(936); // CALL NC,nn (10)
+        _Z80_CASE( 936): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(937); // CALL NC,nn (11)
+        _Z80_CASE( 937): _goto(938); // CALL NC,nn (12)
+        _Z80_CASE( 938): _fetch(); // CALL NC,nn (13)
+        _Z80_CASE( 939): _goto(940); // PUSH DE (1)
+        _Z80_CASE( 940): _wait();_mwrite(--cpu->sp,cpu->d);_goto(941); // PUSH DE (2)
+        _Z80_CASE( 941): _goto(942); // PUSH DE (3)
+        _Z80_CASE( 942): _goto(943); // PUSH DE (4)
+        _Z80_CASE( 943): _wait();_mwrite(--cpu->sp,cpu->e);_goto(944); // PUSH DE (5)
+        _Z80_CASE( 944): _goto(945); // PUSH DE (6)
+        _Z80_CASE( 945): _fetch(); // PUSH DE (7)
+        _Z80_CASE( 946): _wait();_mread(cpu->pc++);_goto(947); // SUB n (1)
+        _Z80_CASE( 947): cpu->dlatch=_gd();_goto(948); // SUB n (2)
+        _Z80_CASE( 948): _z80_sub8(cpu,cpu->dlatch);_fetch(); // SUB n (3)
+        _Z80_CASE( 949): _goto(950); // RST 10h (1)
+        _Z80_CASE( 950): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(951); // RST 10h (2)
+        _Z80_CASE( 951): _goto(952); // RST 10h (3)
+        _Z80_CASE( 952): _goto(953); // RST 10h (4)
+        _Z80_CASE( 953): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=0x10;cpu->pc=cpu->wz;_goto(954); // RST 10h (5)
+        _Z80_CASE( 954): _goto(955); // RST 10h (6)
+        _Z80_CASE( 955): _fetch(); // RST 10h (7)
+        _Z80_CASE( 956): _goto(957); // RET C (1)
+        _Z80_CASE( 957): _wait();_mread(cpu->sp++);_goto(958); // RET C (2)
+        _Z80_CASE( 958): cpu->wzl=_gd();_goto(959); // RET C (3)
+        _Z80_CASE( 959): _goto(960); // RET C (4)
+        _Z80_CASE( 960): _wait();_mread(cpu->sp++);_goto(961); // RET C (5)
+        _Z80_CASE( 961): cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(962); // RET C (6)
+        _Z80_CASE( 962): _fetch(); // RET C (7)
+        _Z80_CASE( 963): _wait();_mread(cpu->pc++);_goto(964); // JP C,nn (1)
+        _Z80_CASE( 964): cpu->wzl=_gd();_goto(965); // JP C,nn (2)
+        _Z80_CASE( 965): _goto(966); // JP C,nn (3)
+        _Z80_CASE( 966): _wait();_mread(cpu->pc++);_goto(967); // JP C,nn (4)
+        _Z80_CASE( 967): cpu->wzh=_gd();if(_cc_c){cpu->pc=cpu->wz;};_goto(968); // JP C,nn (5)
+        _Z80_CASE( 968): _fetch(); // JP C,nn (6)
+        _Z80_CASE( 969): _wait();_mread(cpu->pc++);_goto(970); // IN A,(n) (1)
+        _Z80_CASE( 970): cpu->wzl=_gd();cpu->wzh=cpu->a;_goto(971); // IN A,(n) (2)
+        _Z80_CASE( 971): _goto(972); // IN A,(n) (3)
+        _Z80_CASE( 972): _goto(973); // IN A,(n) (4)
+        _Z80_CASE( 973): _wait();_ioread(cpu->wz++);_goto(974); // IN A,(n) (5)
+        _Z80_CASE( 974): cpu->a=_gd();_goto(975); // IN A,(n) (6)
+        _Z80_CASE( 975): _fetch(); // IN A,(n) (7)
+        _Z80_CASE( 976): _wait();_mread(cpu->pc++);_goto(977); // CALL C,nn (1)
+        _Z80_CASE( 977): cpu->wzl=_gd();_goto(978); // CALL C,nn (2)
+        _Z80_CASE( 978): _goto(979); // CALL C,nn (3)
+        _Z80_CASE( 979): _wait();_mread(cpu->pc++);_goto(980); // CALL C,nn (4)
+        _Z80_CASE( 980): cpu->wzh=_gd();if (!_cc_c){_goto(981+7);};_goto(981); // CALL C,nn (5)
+        _Z80_CASE( 981): _goto(982); // CALL C,nn (6)
+        _Z80_CASE( 982): _goto(983); // CALL C,nn (7)
+        _Z80_CASE( 983): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(984); // CALL C,nn (8)
+        _Z80_CASE( 984): _goto(985); // CALL C,nn (9)
+        _Z80_CASE( 985): _goto(986); // CALL C,nn (10)
+        _Z80_CASE( 986): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(987); // CALL C,nn (11)
+        _Z80_CASE( 987): _goto(988); // CALL C,nn (12)
+        _Z80_CASE( 988): _fetch(); // CALL C,nn (13)
+        _Z80_CASE( 989): _wait();_mread(cpu->pc++);_goto(990); // SBC n (1)
+        _Z80_CASE( 990): cpu->dlatch=_gd();_goto(991); // SBC n (2)
+        _Z80_CASE( 991): _z80_sbc8(cpu,cpu->dlatch);_fetch(); // SBC n (3)
+        _Z80_CASE( 992): _goto(993); // RST 18h (1)
+        _Z80_CASE( 993): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(994); // RST 18h (2)
+        _Z80_CASE( 994): _goto(995); // RST 18h (3)
+        _Z80_CASE( 995): _goto(996); // RST 18h (4)
+        _Z80_CASE( 996): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=0x18;cpu->pc=cpu->wz;_goto(997); // RST 18h (5)
+        _Z80_CASE( 997): _goto(998); // RST 18h (6)
+        _Z80_CASE( 998): _fetch(); // RST 18h (7)
+        _Z80_CASE( 999): _goto(1000); // RET PO (1)
+        _Z80_CASE(1000): _wait();_mread(cpu->sp++);_goto(1001); // RET PO (2)
+        _Z80_CASE(1001): cpu->wzl=_gd();_goto(1002); // RET PO (3)
+        _Z80_CASE(1002): _goto(1003); // RET PO (4)
+        _Z80_CASE(1003): _wait();_mread(cpu->sp++);_goto(1004); // RET PO (5)
+        _Z80_CASE(1004): cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(1005); // RET PO (6)
+        _Z80_CASE(1005): _fetch(); // RET PO (7)
+        _Z80_CASE(1006): _wait();_mread(cpu->sp++);_goto(1007); // POP HL (1)
+        _Z80_CASE(1007): cpu->hlx[cpu->hlx_idx].l=_gd();_goto(1008); // POP HL (2)
+        _Z80_CASE(1008): _goto(1009); // POP HL (3)
+        _Z80_CASE(1009): _wait();_mread(cpu->sp++);_goto(1010); // POP HL (4)
+        _Z80_CASE(1010): cpu->hlx[cpu->hlx_idx].h=_gd();_goto(1011); // POP HL (5)
+        _Z80_CASE(1011): _fetch(); // POP HL (6)
+        _Z80_CASE(1012): _wait();_mread(cpu->pc++);_goto(1013); // JP PO,nn (1)
+        _Z80_CASE(1013): cpu->wzl=_gd();_goto(1014); // JP PO,nn (2)
+        _Z80_CASE(1014): _goto(1015); // JP PO,nn (3)
+        _Z80_CASE(1015): _wait();_mread(cpu->pc++);_goto(1016); // JP PO,nn (4)
+        _Z80_CASE(1016): cpu->wzh=_gd();if(_cc_po){cpu->pc=cpu->wz;};_goto(1017); // JP PO,nn (5)
+        _Z80_CASE(1017): _fetch(); // JP PO,nn (6)
+        _Z80_CASE(1018): _wait();_mread(cpu->sp);_goto(1019); // EX (SP),HL (1)
+        _Z80_CASE(1019): cpu->wzl=_gd();_goto(1020); // EX (SP),HL (2)
+        _Z80_CASE(1020): _goto(1021); // EX (SP),HL (3)
+        _Z80_CASE(1021): _wait();_mread(cpu->sp+1);_goto(1022); // EX (SP),HL (4)
+        _Z80_CASE(1022): cpu->wzh=_gd();_goto(1023); // EX (SP),HL (5)
+        _Z80_CASE(1023): _goto(1024); // EX (SP),HL (6)
+        _Z80_CASE(1024): _goto(1025); // EX (SP),HL (7)
+        _Z80_CASE(1025): _wait();_mwrite(cpu->sp+1,cpu->hlx[cpu->hlx_idx].h);_goto(1026); // EX (SP),HL (8)
+        _Z80_CASE(1026): _goto(1027); // EX (SP),HL (9)
+        _Z80_CASE(1027): _goto(1028); // EX (SP),HL (10)
+        _Z80_CASE(1028): _wait();_mwrite(cpu->sp,cpu->hlx[cpu->hlx_idx].l);cpu->hlx[cpu->hlx_idx].hl=cpu->wz;_goto(1029); // EX (SP),HL (11)
+        _Z80_CASE(1029): _goto(1030); // EX (SP),HL (12)
+        _Z80_CASE(1030): _goto(1031); // EX (SP),HL (13)
+        _Z80_CASE(1031): _goto(1032); // EX (SP),HL (14)
+        _Z80_CASE(1032): _fetch(); // EX (SP),HL (15)
+        _Z80_CASE(1033): _wait();_mread(cpu->pc++);_goto(1034); // CALL PO,nn (1)
+        _Z80_CASE(1034): cpu->wzl=_gd();_goto(1035); // CALL PO,nn (2)
+        _Z80_CASE(1035): _goto(1036); // CALL PO,nn (3)
+        _Z80_CASE(1036): _wait();_mread(cpu->pc++);_goto(1037); // CALL PO,nn (4)
+        _Z80_CASE(1037): cpu->wzh=_gd();if (!_cc_po){_goto(1038+7);};_goto(1038); // CALL PO,nn (5)
+        _Z80_CASE(1038): _goto(1039); // CALL PO,nn (6)
+        _Z80_CASE(1039): _goto(1040); // CALL PO,nn (7)
+        _Z80_CASE(1040): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1041); // CALL PO,nn (8)
+        _Z80_CASE(1041): _goto(1042); // CALL PO,nn (9)
+        _Z80_CASE(1042): _goto(1043); // CALL PO,nn (10)
+        _Z80_CASE(1043): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(1044); // CALL PO,nn (11)
+        _Z80_CASE(1044): _goto(1045); // CALL PO,nn (12)
+        _Z80_CASE(1045): _fetch(); // CALL PO,nn (13)
+        _Z80_CASE(1046): _goto(1047); // PUSH HL (1)
+        _Z80_CASE(1047): _wait();_mwrite(--cpu->sp,cpu->hlx[cpu->hlx_idx].h);_goto(1048); // PUSH HL (2)
+        _Z80_CASE(1048): _goto(1049); // PUSH HL (3)
+        _Z80_CASE(1049): _goto(1050); // PUSH HL (4)
+        _Z80_CASE(1050): _wait();_mwrite(--cpu->sp,cpu->hlx[cpu->hlx_idx].l);_goto(1051); // PUSH HL (5)
+        _Z80_CASE(1051): _goto(1052); // PUSH HL (6)
+        _Z80_CASE(1052): _fetch(); // PUSH HL (7)
+        _Z80_CASE(1053): _wait();_mread(cpu->pc++);_goto(1054); // AND n (1)
+        _Z80_CASE(1054): cpu->dlatch=_gd();_goto(1055); // AND n (2)
+        _Z80_CASE(1055): _z80_and8(cpu,cpu->dlatch);_fetch(); // AND n (3)
+        _Z80_CASE(1056): _goto(1057); // RST 20h (1)
+        _Z80_CASE(1057): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1058); // RST 20h (2)
+        _Z80_CASE(1058): _goto(1059); // RST 20h (3)
+        _Z80_CASE(1059): _goto(1060); // RST 20h (4)
+        _Z80_CASE(1060): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=0x20;cpu->pc=cpu->wz;_goto(1061); // RST 20h (5)
+        _Z80_CASE(1061): _goto(1062); // RST 20h (6)
+        _Z80_CASE(1062): _fetch(); // RST 20h (7)
+        _Z80_CASE(1063): _goto(1064); // RET PE (1)
+        _Z80_CASE(1064): _wait();_mread(cpu->sp++);_goto(1065); // RET PE (2)
+        _Z80_CASE(1065): cpu->wzl=_gd();_goto(1066); // RET PE (3)
+        _Z80_CASE(1066): _goto(1067); // RET PE (4)
+        _Z80_CASE(1067): _wait();_mread(cpu->sp++);_goto(1068); // RET PE (5)
+        _Z80_CASE(1068): cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(1069); // RET PE (6)
+        _Z80_CASE(1069): _fetch(); // RET PE (7)
+        _Z80_CASE(1070): _wait();_mread(cpu->pc++);_goto(1071); // JP PE,nn (1)
+        _Z80_CASE(1071): cpu->wzl=_gd();_goto(1072); // JP PE,nn (2)
+        _Z80_CASE(1072): _goto(1073); // JP PE,nn (3)
+        _Z80_CASE(1073): _wait();_mread(cpu->pc++);_goto(1074); // JP PE,nn (4)
+        _Z80_CASE(1074): cpu->wzh=_gd();if(_cc_pe){cpu->pc=cpu->wz;};_goto(1075); // JP PE,nn (5)
+        _Z80_CASE(1075): _fetch(); // JP PE,nn (6)
+        _Z80_CASE(1076): _wait();_mread(cpu->pc++);_goto(1077); // CALL PE,nn (1)
+        _Z80_CASE(1077): cpu->wzl=_gd();_goto(1078); // CALL PE,nn (2)
+        _Z80_CASE(1078): _goto(1079); // CALL PE,nn (3)
+        _Z80_CASE(1079): _wait();_mread(cpu->pc++);_goto(1080); // CALL PE,nn (4)
+        _Z80_CASE(1080): cpu->wzh=_gd();if (!_cc_pe){_goto(1081+7);};_goto(1081); // CALL PE,nn (5)
+        _Z80_CASE(1081): _goto(1082); // CALL PE,nn (6)
+        _Z80_CASE(1082): _goto(1083); // CALL PE,nn (7)
+        _Z80_CASE(1083): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1084); // CALL PE,nn (8)
+        _Z80_CASE(1084): _goto(1085); // CALL PE,nn (9)
+        _Z80_CASE(1085): _goto(1086); // CALL PE,nn (10)
+        _Z80_CASE(1086): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(1087); // CALL PE,nn (11)
+        _Z80_CASE(1087): _goto(1088); // CALL PE,nn (12)
+        _Z80_CASE(1088): _fetch(); // CALL PE,nn (13)
+        _Z80_CASE(1089): _wait();_mread(cpu->pc++);_goto(1090); // XOR n (1)
+        _Z80_CASE(1090): cpu->dlatch=_gd();_goto(1091); // XOR n (2)
+        _Z80_CASE(1091): _z80_xor8(cpu,cpu->dlatch);_fetch(); // XOR n (3)
+        _Z80_CASE(1092): _goto(1093); // RST 28h (1)
+        _Z80_CASE(1093): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1094); // RST 28h (2)
+        _Z80_CASE(1094): _goto(1095); // RST 28h (3)
+        _Z80_CASE(1095): _goto(1096); // RST 28h (4)
+        _Z80_CASE(1096): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=0x28;cpu->pc=cpu->wz;_goto(1097); // RST 28h (5)
+        _Z80_CASE(1097): _goto(1098); // RST 28h (6)
+        _Z80_CASE(1098): _fetch(); // RST 28h (7)
+        _Z80_CASE(1099): _goto(1100); // RET P (1)
+        _Z80_CASE(1100): _wait();_mread(cpu->sp++);_goto(1101); // RET P (2)
+        _Z80_CASE(1101): cpu->wzl=_gd();_goto(1102); // RET P (3)
+        _Z80_CASE(1102): _goto(1103); // RET P (4)
+        _Z80_CASE(1103): _wait();_mread(cpu->sp++);_goto(1104); // RET P (5)
+        _Z80_CASE(1104): cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(1105); // RET P (6)
+        _Z80_CASE(1105): _fetch(); // RET P (7)
+        _Z80_CASE(1106): _wait();_mread(cpu->sp++);_goto(1107); // POP AF (1)
+        _Z80_CASE(1107): cpu->f=_gd();_goto(1108); // POP AF (2)
+        _Z80_CASE(1108): _goto(1109); // POP AF (3)
+        _Z80_CASE(1109): _wait();_mread(cpu->sp++);_goto(1110); // POP AF (4)
+        _Z80_CASE(1110): cpu->a=_gd();_goto(1111); // POP AF (5)
+        _Z80_CASE(1111): _fetch(); // POP AF (6)
+        _Z80_CASE(1112): _wait();_mread(cpu->pc++);_goto(1113); // JP P,nn (1)
+        _Z80_CASE(1113): cpu->wzl=_gd();_goto(1114); // JP P,nn (2)
+        _Z80_CASE(1114): _goto(1115); // JP P,nn (3)
+        _Z80_CASE(1115): _wait();_mread(cpu->pc++);_goto(1116); // JP P,nn (4)
+        _Z80_CASE(1116): cpu->wzh=_gd();if(_cc_p){cpu->pc=cpu->wz;};_goto(1117); // JP P,nn (5)
+        _Z80_CASE(1117): _fetch(); // JP P,nn (6)
+        _Z80_CASE(1118): _wait();_mread(cpu->pc++);_goto(1119); // CALL P,nn (1)
+        _Z80_CASE(1119): cpu->wzl=_gd();_goto(1120); // CALL P,nn (2)
+        _Z80_CASE(1120): _goto(1121); // CALL P,nn (3)
+        _Z80_CASE(1121): _wait();_mread(cpu->pc++);_goto(1122); // CALL P,nn (4)
+        _Z80_CASE(1122): cpu->wzh=_gd();if (!_cc_p){_goto(1123+7);};_goto(1123); // CALL P,nn (5)
+        _Z80_CASE(1123): _goto(1124); // CALL P,nn (6)
+        _Z80_CASE(1124): _goto(1125); // CALL P,nn (7)
+        _Z80_CASE(1125): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1126); // CALL P,nn (8)
+        _Z80_CASE(1126): _goto(1127); // CALL P,nn (9)
+        _Z80_CASE(1127): _goto(1128); // CALL P,nn (10)
+        _Z80_CASE(1128): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(1129); // CALL P,nn (11)
+        _Z80_CASE(1129): _goto(1130); // CALL P,nn (12)
+        _Z80_CASE(1130): _fetch(); // CALL P,nn (13)
+        _Z80_CASE(1131): _goto(1132); // PUSH AF (1)
+        _Z80_CASE(1132): _wait();_mwrite(--cpu->sp,cpu->a);_goto(1133); // PUSH AF (2)
+        _Z80_CASE(1133): _goto(1134); // PUSH AF (3)
+        _Z80_CASE(1134): _goto(1135); // PUSH AF (4)
+        _Z80_CASE(1135): _wait();_mwrite(--cpu->sp,cpu->f);_goto(1136); // PUSH AF (5)
+        _Z80_CASE(1136): _goto(1137); // PUSH AF (6)
+        _Z80_CASE(1137): _fetch(); // PUSH AF (7)
+        _Z80_CASE(1138): _wait();_mread(cpu->pc++);_goto(1139); // OR n (1)
+        _Z80_CASE(1139): cpu->dlatch=_gd();_goto(1140); // OR n (2)
+        _Z80_CASE(1140): _z80_or8(cpu,cpu->dlatch);_fetch(); // OR n (3)
+        _Z80_CASE(1141): _goto(1142); // RST 30h (1)
+        _Z80_CASE(1142): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1143); // RST 30h (2)
+        _Z80_CASE(1143): _goto(1144); // RST 30h (3)
+        _Z80_CASE(1144): _goto(1145); // RST 30h (4)
+        _Z80_CASE(1145): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=0x30;cpu->pc=cpu->wz;_goto(1146); // RST 30h (5)
+        _Z80_CASE(1146): _goto(1147); // RST 30h (6)
+        _Z80_CASE(1147): _fetch(); // RST 30h (7)
+        _Z80_CASE(1148): _goto(1149); // RET M (1)
+        _Z80_CASE(1149): _wait();_mread(cpu->sp++);_goto(1150); // RET M (2)
+        _Z80_CASE(1150): cpu->wzl=_gd();_goto(1151); // RET M (3)
+        _Z80_CASE(1151): _goto(1152); // RET M (4)
+        _Z80_CASE(1152): _wait();_mread(cpu->sp++);_goto(1153); // RET M (5)
+        _Z80_CASE(1153): cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(1154); // RET M (6)
+        _Z80_CASE(1154): _fetch(); // RET M (7)
+        _Z80_CASE(1155): _goto(1156); // LD SP,HL (1)
+        _Z80_CASE(1156): _fetch(); // LD SP,HL (2)
+        _Z80_CASE(1157): _wait();_mread(cpu->pc++);_goto(1158); // JP M,nn (1)
+        _Z80_CASE(1158): cpu->wzl=_gd();_goto(1159); // JP M,nn (2)
+        _Z80_CASE(1159): _goto(1160); // JP M,nn (3)
+        _Z80_CASE(1160): _wait();_mread(cpu->pc++);_goto(1161); // JP M,nn (4)
+        _Z80_CASE(1161): cpu->wzh=_gd();if(_cc_m){cpu->pc=cpu->wz;};_goto(1162); // JP M,nn (5)
+        _Z80_CASE(1162): _fetch(); // JP M,nn (6)
+        _Z80_CASE(1163): _wait();_mread(cpu->pc++);_goto(1164); // CALL M,nn (1)
+        _Z80_CASE(1164): cpu->wzl=_gd();_goto(1165); // CALL M,nn (2)
+        _Z80_CASE(1165): _goto(1166); // CALL M,nn (3)
+        _Z80_CASE(1166): _wait();_mread(cpu->pc++);_goto(1167); // CALL M,nn (4)
+        _Z80_CASE(1167): cpu->wzh=_gd();if (!_cc_m){_goto(1168+7);};_goto(1168); // CALL M,nn (5)
+        _Z80_CASE(1168): _goto(1169); // CALL M,nn (6)
+        _Z80_CASE(1169): _goto(1170); // CALL M,nn (7)
+        _Z80_CASE(1170): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1171); // CALL M,nn (8)
+        _Z80_CASE(1171): _goto(1172); // CALL M,nn (9)
+        _Z80_CASE(1172): _goto(1173); // CALL M,nn (10)
+        _Z80_CASE(1173): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->pc=cpu->wz;_goto(1174); // CALL M,nn (11)
+        _Z80_CASE(1174): _goto(1175); // CALL M,nn (12)
+        _Z80_CASE(1175): _fetch(); // CALL M,nn (13)
+        _Z80_CASE(1176): _wait();_mread(cpu->pc++);_goto(1177); // CP n (1)
+        _Z80_CASE(1177): cpu->dlatch=_gd();_goto(1178); // CP n (2)
+        _Z80_CASE(1178): _z80_cp8(cpu,cpu->dlatch);_fetch(); // CP n (3)
+        _Z80_CASE(1179): _goto(1180); // RST 38h (1)
+        _Z80_CASE(1180): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1181); // RST 38h (2)
+        _Z80_CASE(1181): _goto(1182); // RST 38h (3)
+        _Z80_CASE(1182): _goto(1183); // RST 38h (4)
+        _Z80_CASE(1183): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=0x38;cpu->pc=cpu->wz;_goto(1184); // RST 38h (5)
+        _Z80_CASE(1184): _goto(1185); // RST 38h (6)
+        _Z80_CASE(1185): _fetch(); // RST 38h (7)
+        _Z80_CASE(1186): _goto(1187); // IN B,(C) (1)
+        _Z80_CASE(1187): _wait();_ioread(cpu->bc);_goto(1188); // IN B,(C) (2)
+        _Z80_CASE(1188): cpu->dlatch=_gd();cpu->wz=cpu->bc+1;_goto(1189); // IN B,(C) (3)
+        _Z80_CASE(1189): cpu->b=_z80_in(cpu,cpu->dlatch);_fetch(); // IN B,(C) (4)
+        _Z80_CASE(1190): _iowrite(cpu->bc,cpu->b);_goto(1191); // OUT (C),B (1)
+        _Z80_CASE(1191): _wait();cpu->wz=cpu->bc+1;_goto(1192); // OUT (C),B (2)
+        _Z80_CASE(1192): _goto(1193); // OUT (C),B (3)
+        _Z80_CASE(1193): _fetch(); // OUT (C),B (4)
+        _Z80_CASE(1194): _goto(1195); // SBC HL,BC (1)
+        _Z80_CASE(1195): _goto(1196); // SBC HL,BC (2)
+        _Z80_CASE(1196): _goto(1197); // SBC HL,BC (3)
+        _Z80_CASE(1197): _goto(1198); // SBC HL,BC (4)
+        _Z80_CASE(1198): _goto(1199); // SBC HL,BC (5)
+        _Z80_CASE(1199): _goto(1200); // SBC HL,BC (6)
+        _Z80_CASE(1200): _fetch(); // SBC HL,BC (7)
+        _Z80_CASE(1201): _wait();_mread(cpu->pc++);_goto(1202); // LD (nn),BC (1)
+        _Z80_CASE(1202): cpu->wzl=_gd();_goto(1203); // LD (nn),BC (2)
+        _Z80_CASE(1203): _goto(1204); // LD (nn),BC (3)
+        _Z80_CASE(1204): _wait();_mread(cpu->pc++);_goto(1205); // LD (nn),BC (4)
+        _Z80_CASE(1205): cpu->wzh=_gd();_goto(1206); // LD (nn),BC (5)
+        _Z80_CASE(1206): _goto(1207); // LD (nn),BC (6)
+        _Z80_CASE(1207): _wait();_mwrite(cpu->wz++,cpu->c);_goto(1208); // LD (nn),BC (7)
+        _Z80_CASE(1208): _goto(1209); // LD (nn),BC (8)
+        _Z80_CASE(1209): _goto(1210); // LD (nn),BC (9)
+        _Z80_CASE(1210): _wait();_mwrite(cpu->wz,cpu->b);_goto(1211); // LD (nn),BC (10)
+        _Z80_CASE(1211): _goto(1212); // LD (nn),BC (11)
+        _Z80_CASE(1212): _fetch(); // LD (nn),BC (12)
+        _Z80_CASE(1213): _wait();_mread(cpu->sp++);_goto(1214); // RETN (1)
+        _Z80_CASE(1214): cpu->wzl=_gd();_goto(1215); // RETN (2)
+        _Z80_CASE(1215): _goto(1216); // RETN (3)
+        _Z80_CASE(1216): _wait();_mread(cpu->sp++);_goto(1217); // RETN (4)
+        _Z80_CASE(1217): cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(1218); // RETN (5)
+        _Z80_CASE(1218): pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2;goto step_to; // RETN (6)
+        _Z80_CASE(1219): cpu->i=cpu->a;_fetch(); // LD I,A (1)
+        _Z80_CASE(1220): _goto(1221); // IN C,(C) (1)
+        _Z80_CASE(1221): _wait();_ioread(cpu->bc);_goto(1222); // IN C,(C) (2)
+        _Z80_CASE(1222): cpu->dlatch=_gd();cpu->wz=cpu->bc+1;_goto(1223); // IN C,(C) (3)
+        _Z80_CASE(1223): cpu->c=_z80_in(cpu,cpu->dlatch);_fetch(); // IN C,(C) (4)
+        _Z80_CASE(1224): _iowrite(cpu->bc,cpu->c);_goto(1225); // OUT (C),C (1)
+        _Z80_CASE(1225): _wait();cpu->wz=cpu->bc+1;_goto(1226); // OUT (C),C (2)
+        _Z80_CASE(1226): _goto(1227); // OUT (C),C (3)
+        _Z80_CASE(1227): _fetch(); // OUT (C),C (4)
+        _Z80_CASE(1228): _goto(1229); // ADC HL,BC (1)
+        _Z80_CASE(1229): _goto(1230); // ADC HL,BC (2)
+        _Z80_CASE(1230): _goto(1231); // ADC HL,BC (3)
+        _Z80_CASE(1231): _goto(1232); // ADC HL,BC (4)
+        _Z80_CASE(1232): _goto(1233); // ADC HL,BC (5)
+        _Z80_CASE(1233): _goto(1234); // ADC HL,BC (6)
+        _Z80_CASE(1234): _fetch(); // ADC HL,BC (7)
+        _Z80_CASE(1235): _wait();_mread(cpu->pc++);_goto(1236); // LD BC,(nn) (1)
+        _Z80_CASE(1236): cpu->wzl=_gd();_goto(1237); // LD BC,(nn) (2)
+        _Z80_CASE(1237): _goto(1238); // LD BC,(nn) (3)
+        _Z80_CASE(1238): _wait();_mread(cpu->pc++);_goto(1239); // LD BC,(nn) (4)
+        _Z80_CASE(1239): cpu->wzh=_gd();_goto(1240); // LD BC,(nn) (5)
+        _Z80_CASE(1240): _goto(1241); // LD BC,(nn) (6)
+        _Z80_CASE(1241): _wait();_mread(cpu->wz++);_goto(1242); // LD BC,(nn) (7)
+        _Z80_CASE(1242): cpu->c=_gd();_goto(1243); // LD BC,(nn) (8)
+        _Z80_CASE(1243): _goto(1244); // LD BC,(nn) (9)
+        _Z80_CASE(1244): _wait();_mread(cpu->wz);_goto(1245); // LD BC,(nn) (10)
+        _Z80_CASE(1245): cpu->b=_gd();_goto(1246); // LD BC,(nn) (11)
+        _Z80_CASE(1246): _fetch(); // LD BC,(nn) (12)
+        _Z80_CASE(1247): _wait();_mread(cpu->sp++);_goto(1248); // RETI (1)
+        _Z80_CASE(1248): cpu->wzl=_gd();pins|=Z80_RETI;_goto(1249); // RETI (2)
+        _Z80_CASE(1249): _goto(1250); // RETI (3)
+        _Z80_CASE(1250): _wait();_mread(cpu->sp++);_goto(1251); // RETI (4)
+        _Z80_CASE(1251): cpu->wzh=_gd();cpu->pc=cpu->wz;_goto(1252); // RETI (5)
+        _Z80_CASE(1252): pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2;goto step_to; // RETI (6)
+        _Z80_CASE(1253): cpu->r=cpu->a;_fetch(); // LD R,A (1)
+        _Z80_CASE(1254): _goto(1255); // IN D,(C) (1)
+        _Z80_CASE(1255): _wait();_ioread(cpu->bc);_goto(1256); // IN D,(C) (2)
+        _Z80_CASE(1256): cpu->dlatch=_gd();cpu->wz=cpu->bc+1;_goto(1257); // IN D,(C) (3)
+        _Z80_CASE(1257): cpu->d=_z80_in(cpu,cpu->dlatch);_fetch(); // IN D,(C) (4)
+        _Z80_CASE(1258): _iowrite(cpu->bc,cpu->d);_goto(1259); // OUT (C),D (1)
+        _Z80_CASE(1259): _wait();cpu->wz=cpu->bc+1;_goto(1260); // OUT (C),D (2)
+        _Z80_CASE(1260): _goto(1261); // OUT (C),D (3)
+        _Z80_CASE(1261): _fetch(); // OUT (C),D (4)
+        _Z80_CASE(1262): _goto(1263); // SBC HL,DE (1)
+        _Z80_CASE(1263): _goto(1264); // SBC HL,DE (2)
+        _Z80_CASE(1264): _goto(1265); // SBC HL,DE (3)
+        _Z80_CASE(1265): _goto(1266); // SBC HL,DE (4)
+        _Z80_CASE(1266): _goto(1267); // SBC HL,DE (5)
+        _Z80_CASE(1267): _goto(1268); // SBC HL,DE (6)
+        _Z80_CASE(1268): _fetch(); // SBC HL,DE (7)
+        _Z80_CASE(1269): _wait();_mread(cpu->pc++);_goto(1270); // LD (nn),DE (1)
+        _Z80_CASE(1270): cpu->wzl=_gd();_goto(1271); // LD (nn),DE (2)
+        _Z80_CASE(1271): _goto(1272); // LD (nn),DE (3)
+        _Z80_CASE(1272): _wait();_mread(cpu->pc++);_goto(1273); // LD (nn),DE (4)
+        _Z80_CASE(1273): cpu->wzh=_gd();_goto(1274); // LD (nn),DE (5)
+        _Z80_CASE(1274): _goto(1275); // LD (nn),DE (6)
+        _Z80_CASE(1275): _wait();_mwrite(cpu->wz++,cpu->e);_goto(1276); // LD (nn),DE (7)
+        _Z80_CASE(1276): _goto(1277); // LD (nn),DE (8)
+        _Z80_CASE(1277): _goto(1278); // LD (nn),DE (9)
+        _Z80_CASE(1278): _wait();_mwrite(cpu->wz,cpu->d);_goto(1279); // LD (nn),DE (10)
+        _Z80_CASE(1279): _goto(1280); // LD (nn),DE (11)
+        _Z80_CASE(1280): _fetch(); // LD (nn),DE (12)
+        _Z80_CASE(1281): pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2;goto step_to; // RETI (6)
+        _Z80_CASE(1282): cpu->a=cpu->i;cpu->f=_z80_sziff2_flags(cpu, cpu->i);_fetch(); // LD A,I (1)
+        _Z80_CASE(1283): _goto(1284); // IN E,(C) (1)
+        _Z80_CASE(1284): _wait();_ioread(cpu->bc);_goto(1285); // IN E,(C) (2)
+        _Z80_CASE(1285): cpu->dlatch=_gd();cpu->wz=cpu->bc+1;_goto(1286); // IN E,(C) (3)
+        _Z80_CASE(1286): cpu->e=_z80_in(cpu,cpu->dlatch);_fetch(); // IN E,(C) (4)
+        _Z80_CASE(1287): _iowrite(cpu->bc,cpu->e);_goto(1288); // OUT (C),E (1)
+        _Z80_CASE(1288): _wait();cpu->wz=cpu->bc+1;_goto(1289); // OUT (C),E (2)
+        _Z80_CASE(1289): _goto(1290); // OUT (C),E (3)
+        _Z80_CASE(1290): _fetch(); // OUT (C),E (4)
+        _Z80_CASE(1291): _goto(1292); // ADC HL,DE (1)
+        _Z80_CASE(1292): _goto(1293); // ADC HL,DE (2)
+        _Z80_CASE(1293): _goto(1294); // ADC HL,DE (3)
+        _Z80_CASE(1294): _goto(1295); // ADC HL,DE (4)
+        _Z80_CASE(1295): _goto(1296); // ADC HL,DE (5)
+        _Z80_CASE(1296): _goto(1297); // ADC HL,DE (6)
+        _Z80_CASE(1297): _fetch(); // ADC HL,DE (7)
+        _Z80_CASE(1298): _wait();_mread(cpu->pc++);_goto(1299); // LD DE,(nn) (1)
+        _Z80_CASE(1299): cpu->wzl=_gd();_goto(1300); // LD DE,(nn) (2)
+        _Z80_CASE(1300): _goto(1301); // LD DE,(nn) (3)
+        _Z80_CASE(1301): _wait();_mread(cpu->pc++);_goto(1302); // LD DE,(nn) (4)
+        _Z80_CASE(1302): cpu->wzh=_gd();_goto(1303); // LD DE,(nn) (5)
+        _Z80_CASE(1303): _goto(1304); // LD DE,(nn) (6)
+        _Z80_CASE(1304): _wait();_mread(cpu->wz++);_goto(1305); // LD DE,(nn) (7)
+        _Z80_CASE(1305): cpu->e=_gd();_goto(1306); // LD DE,(nn) (8)
+        _Z80_CASE(1306): _goto(1307); // LD DE,(nn) (9)
+        _Z80_CASE(1307): _wait();_mread(cpu->wz);_goto(1308); // LD DE,(nn) (10)
+        _Z80_CASE(1308): cpu->d=_gd();_goto(1309); // LD DE,(nn) (11)
+        _Z80_CASE(1309): _fetch(); // LD DE,(nn) (12)
+        _Z80_CASE(1310): pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2;goto step_to; // RETI (6)
+        _Z80_CASE(1311): cpu->a=cpu->r;cpu->f=_z80_sziff2_flags(cpu, cpu->r);_fetch(); // LD A,R (1)
+        _Z80_CASE(1312): _goto(1313); // IN H,(C) (1)
+        _Z80_CASE(1313): _wait();_ioread(cpu->bc);_goto(1314); // IN H,(C) (2)
+        _Z80_CASE(1314): cpu->dlatch=_gd();cpu->wz=cpu->bc+1;_goto(1315); // IN H,(C) (3)
+        _Z80_CASE(1315): cpu->h=_z80_in(cpu,cpu->dlatch);_fetch(); // IN H,(C) (4)
+        _Z80_CASE(1316): _iowrite(cpu->bc,cpu->h);_goto(1317); // OUT (C),H (1)
+        _Z80_CASE(1317): _wait();cpu->wz=cpu->bc+1;_goto(1318); // OUT (C),H (2)
+        _Z80_CASE(1318): _goto(1319); // OUT (C),H (3)
+        _Z80_CASE(1319): _fetch(); // OUT (C),H (4)
+        _Z80_CASE(1320): _goto(1321); // SBC HL,HL (1)
+        _Z80_CASE(1321): _goto(1322); // SBC HL,HL (2)
+        _Z80_CASE(1322): _goto(1323); // SBC HL,HL (3)
+        _Z80_CASE(1323): _goto(1324); // SBC HL,HL (4)
+        _Z80_CASE(1324): _goto(1325); // SBC HL,HL (5)
+        _Z80_CASE(1325): _goto(1326); // SBC HL,HL (6)
+        _Z80_CASE(1326): _fetch(); // SBC HL,HL (7)
+        _Z80_CASE(1327): _wait();_mread(cpu->pc++);_goto(1328); // LD (nn),HL (1)
+        _Z80_CASE(1328): cpu->wzl=_gd();_goto(1329); // LD (nn),HL (2)
+        _Z80_CASE(1329): _goto(1330); // LD (nn),HL (3)
+        _Z80_CASE(1330): _wait();_mread(cpu->pc++);_goto(1331); // LD (nn),HL (4)
+        _Z80_CASE(1331): cpu->wzh=_gd();_goto(1332); // LD (nn),HL (5)
+        _Z80_CASE(1332): _goto(1333); // LD (nn),HL (6)
+        _Z80_CASE(1333): _wait();_mwrite(cpu->wz++,cpu->l);_goto(1334); // LD (nn),HL (7)
+        _Z80_CASE(1334): _goto(1335); // LD (nn),HL (8)
+        _Z80_CASE(1335): _goto(1336); // LD (nn),HL (9)
+        _Z80_CASE(1336): _wait();_mwrite(cpu->wz,cpu->h);_goto(1337); // LD (nn),HL (10)
+        _Z80_CASE(1337): _goto(1338); // LD (nn),HL (11)
+        _Z80_CASE(1338): _fetch(); // LD (nn),HL (12)
+        _Z80_CASE(1339): pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2;goto step_to; // RETI (6)
+        _Z80_CASE(1340): _wait();_mread(cpu->hl);_goto(1341); // RRD (1)
+        _Z80_CASE(1341): cpu->dlatch=_gd();_goto(1342); // RRD (2)
+        _Z80_CASE(1342): cpu->dlatch=_z80_rrd(cpu,cpu->dlatch);_goto(1343); // RRD (3)
+        _Z80_CASE(1343): _goto(1344); // RRD (4)
+        _Z80_CASE(1344): _goto(1345); // RRD (5)
+        _Z80_CASE(1345): _goto(1346); // RRD (6)
+        _Z80_CASE(1346): _goto(1347); // RRD (7)
+        _Z80_CASE(1347): _wait();_mwrite(cpu->hl,cpu->dlatch);cpu->wz=cpu->hl+1;_goto(1348); // RRD (8)
+        _Z80_CASE(1348): _goto(1349); // RRD (9)
+        _Z80_CASE(1349): _fetch(); // RRD (10)
+        _Z80_CASE(1350): _goto(1351); // IN L,(C) (1)
+        _Z80_CASE(1351): _wait();_ioread(cpu->bc);_goto(1352); // IN L,(C) (2)
+        _Z80_CASE(1352): cpu->dlatch=_gd();cpu->wz=cpu->bc+1;_goto(1353); // IN L,(C) (3)
+        _Z80_CASE(1353): cpu->l=_z80_in(cpu,cpu->dlatch);_fetch(); // IN L,(C) (4)
+        _Z80_CASE(1354): _iowrite(cpu->bc,cpu->l);_goto(1355); // OUT (C),L (1)
+        _Z80_CASE(1355): _wait();cpu->wz=cpu->bc+1;_goto(1356); // OUT (C),L (2)
+        _Z80_CASE(1356): _goto(1357); // OUT (C),L (3)
+        _Z80_CASE(1357): _fetch(); // OUT (C),L (4)
+        _Z80_CASE(1358): _goto(1359); // ADC HL,HL (1)
+        _Z80_CASE(1359): _goto(1360); // ADC HL,HL (2)
+        _Z80_CASE(1360): _goto(1361); // ADC HL,HL (3)
+        _Z80_CASE(1361): _goto(1362); // ADC HL,HL (4)
+        _Z80_CASE(1362): _goto(1363); // ADC HL,HL (5)
+        _Z80_CASE(1363): _goto(1364); // ADC HL,HL (6)
+        _Z80_CASE(1364): _fetch(); // ADC HL,HL (7)
+        _Z80_CASE(1365): _wait();_mread(cpu->pc++);_goto(1366); // LD HL,(nn) (1)
+        _Z80_CASE(1366): cpu->wzl=_gd();_goto(1367); // LD HL,(nn) (2)
+        _Z80_CASE(1367): _goto(1368); // LD HL,(nn) (3)
+        _Z80_CASE(1368): _wait();_mread(cpu->pc++);_goto(1369); // LD HL,(nn) (4)
+        _Z80_CASE(1369): cpu->wzh=_gd();_goto(1370); // LD HL,(nn) (5)
+        _Z80_CASE(1370): _goto(1371); // LD HL,(nn) (6)
+        _Z80_CASE(1371): _wait();_mread(cpu->wz++);_goto(1372); // LD HL,(nn) (7)
+        _Z80_CASE(1372): cpu->l=_gd();_goto(1373); // LD HL,(nn) (8)
+        _Z80_CASE(1373): _goto(1374); // LD HL,(nn) (9)
+        _Z80_CASE(1374): _wait();_mread(cpu->wz);_goto(1375); // LD HL,(nn) (10)
+        _Z80_CASE(1375): cpu->h=_gd();_goto(1376); // LD HL,(nn) (11)
+        _Z80_CASE(1376): _fetch(); // LD HL,(nn) (12)
+        _Z80_CASE(1377): pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2;goto step_to; // RETI (6)
+        _Z80_CASE(1378): _wait();_mread(cpu->hl);_goto(1379); // RLD (1)
+        _Z80_CASE(1379): cpu->dlatch=_gd();_goto(1380); // RLD (2)
+        _Z80_CASE(1380): cpu->dlatch=_z80_rld(cpu,cpu->dlatch);_goto(1381); // RLD (3)
+        _Z80_CASE(1381): _goto(1382); // RLD (4)
+        _Z80_CASE(1382): _goto(1383); // RLD (5)
+        _Z80_CASE(1383): _goto(1384); // RLD (6)
+        _Z80_CASE(1384): _goto(1385); // RLD (7)
+        _Z80_CASE(1385): _wait();_mwrite(cpu->hl,cpu->dlatch);cpu->wz=cpu->hl+1;_goto(1386); // RLD (8)
+        _Z80_CASE(1386): _goto(1387); // RLD (9)
+        _Z80_CASE(1387): _fetch(); // RLD (10)
+        _Z80_CASE(1388): _goto(1389); // IN (C) (1)
+        _Z80_CASE(1389): _wait();_ioread(cpu->bc);_goto(1390); // IN (C) (2)
+        _Z80_CASE(1390): cpu->dlatch=_gd();cpu->wz=cpu->bc+1;_goto(1391); // IN (C) (3)
+        _Z80_CASE(1391): _z80_in(cpu,cpu->dlatch);_fetch(); // IN (C) (4)
+        _Z80_CASE(1392): _iowrite(cpu->bc,0);_goto(1393); // OUT (C),0 (1)
+        _Z80_CASE(1393): _wait();cpu->wz=cpu->bc+1;_goto(1394); // OUT (C),0 (2)
+        _Z80_CASE(1394): _goto(1395); // OUT (C),0 (3)
+        _Z80_CASE(1395): _fetch(); // OUT (C),0 (4)
+        _Z80_CASE(1396): _goto(1397); // SBC HL,SP (1)
+        _Z80_CASE(1397): _goto(1398); // SBC HL,SP (2)
+        _Z80_CASE(1398): _goto(1399); // SBC HL,SP (3)
+        _Z80_CASE(1399): _goto(1400); // SBC HL,SP (4)
+        _Z80_CASE(1400): _goto(1401); // SBC HL,SP (5)
+        _Z80_CASE(1401): _goto(1402); // SBC HL,SP (6)
+        _Z80_CASE(1402): _fetch(); // SBC HL,SP (7)
+        _Z80_CASE(1403): _wait();_mread(cpu->pc++);_goto(1404); // LD (nn),SP (1)
+        _Z80_CASE(1404): cpu->wzl=_gd();_goto(1405); // LD (nn),SP (2)
+        _Z80_CASE(1405): _goto(1406); // LD (nn),SP (3)
+        _Z80_CASE(1406): _wait();_mread(cpu->pc++);_goto(1407); // LD (nn),SP (4)
+        _Z80_CASE(1407): cpu->wzh=_gd();_goto(1408); // LD (nn),SP (5)
+        _Z80_CASE(1408): _goto(1409); // LD (nn),SP (6)
+        _Z80_CASE(1409): _wait();_mwrite(cpu->wz++,cpu->spl);_goto(1410); // LD (nn),SP (7)
+        _Z80_CASE(1410): _goto(1411); // LD (nn),SP (8)
+        _Z80_CASE(1411): _goto(1412); // LD (nn),SP (9)
+        _Z80_CASE(1412): _wait();_mwrite(cpu->wz,cpu->sph);_goto(1413); // LD (nn),SP (10)
+        _Z80_CASE(1413): _goto(1414); // LD (nn),SP (11)
+        _Z80_CASE(1414): _fetch(); // LD (nn),SP (12)
+        _Z80_CASE(1415): pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2;goto step_to; // RETI (6)
+        _Z80_CASE(1416): _goto(1417); // IN A,(C) (1)
+        _Z80_CASE(1417): _wait();_ioread(cpu->bc);_goto(1418); // IN A,(C) (2)
+        _Z80_CASE(1418): cpu->dlatch=_gd();cpu->wz=cpu->bc+1;_goto(1419); // IN A,(C) (3)
+        _Z80_CASE(1419): cpu->a=_z80_in(cpu,cpu->dlatch);_fetch(); // IN A,(C) (4)
+        _Z80_CASE(1420): _iowrite(cpu->bc,cpu->a);_goto(1421); // OUT (C),A (1)
+        _Z80_CASE(1421): _wait();cpu->wz=cpu->bc+1;_goto(1422); // OUT (C),A (2)
+        _Z80_CASE(1422): _goto(1423); // OUT (C),A (3)
+        _Z80_CASE(1423): _fetch(); // OUT (C),A (4)
+        _Z80_CASE(1424): _goto(1425); // ADC HL,SP (1)
+        _Z80_CASE(1425): _goto(1426); // ADC HL,SP (2)
+        _Z80_CASE(1426): _goto(1427); // ADC HL,SP (3)
+        _Z80_CASE(1427): _goto(1428); // ADC HL,SP (4)
+        _Z80_CASE(1428): _goto(1429); // ADC HL,SP (5)
+        _Z80_CASE(1429): _goto(1430); // ADC HL,SP (6)
+        _Z80_CASE(1430): _fetch(); // ADC HL,SP (7)
+        _Z80_CASE(1431): _wait();_mread(cpu->pc++);_goto(1432); // LD SP,(nn) (1)
+        _Z80_CASE(1432): cpu->wzl=_gd();_goto(1433); // LD SP,(nn) (2)
+        _Z80_CASE(1433): _goto(1434); // LD SP,(nn) (3)
+        _Z80_CASE(1434): _wait();_mread(cpu->pc++);_goto(1435); // LD SP,(nn) (4)
+        _Z80_CASE(1435): cpu->wzh=_gd();_goto(1436); // LD SP,(nn) (5)
+        _Z80_CASE(1436): _goto(1437); // LD SP,(nn) (6)
+        _Z80_CASE(1437): _wait();_mread(cpu->wz++);_goto(1438); // LD SP,(nn) (7)
+        _Z80_CASE(1438): cpu->spl=_gd();_goto(1439); // LD SP,(nn) (8)
+        _Z80_CASE(1439): _goto(1440); // LD SP,(nn) (9)
+        _Z80_CASE(1440): _wait();_mread(cpu->wz);_goto(1441); // LD SP,(nn) (10)
+        _Z80_CASE(1441): cpu->sph=_gd();_goto(1442); // LD SP,(nn) (11)
+        _Z80_CASE(1442): _fetch(); // LD SP,(nn) (12)
+        _Z80_CASE(1443): pins=_z80_fetch(cpu,pins);cpu->iff1=cpu->iff2;goto step_to; // RETI (6)
+        _Z80_CASE(1444): _wait();_mread(cpu->hl++);_goto(1445); // LDI (1)
+        _Z80_CASE(1445): cpu->dlatch=_gd();_goto(1446); // LDI (2)
+        _Z80_CASE(1446): _goto(1447); // LDI (3)
+        _Z80_CASE(1447): _wait();_mwrite(cpu->de++,cpu->dlatch);_goto(1448); // LDI (4)
+        _Z80_CASE(1448): _goto(1449); // LDI (5)
+        _Z80_CASE(1449): _z80_ldi_ldd(cpu,cpu->dlatch);_goto(1450); // LDI (6)
+        _Z80_CASE(1450): _goto(1451); // LDI (7)
+        _Z80_CASE(1451): _fetch(); // LDI (8)
+        _Z80_CASE(1452): _wait();_mread(cpu->hl++);_goto(1453); // CPI (1)
+        _Z80_CASE(1453): cpu->dlatch=_gd();_goto(1454); // CPI (2)
+        _Z80_CASE(1454): cpu->wz++;_z80_cpi_cpd(cpu,cpu->dlatch);_goto(1455); // CPI (3)
+        _Z80_CASE(1455): _goto(1456); // CPI (4)
+        _Z80_CASE(1456): _goto(1457); // CPI (5)
+        _Z80_CASE(1457): _goto(1458); // CPI (6)
+        _Z80_CASE(1458): _goto(1459); // CPI (7)
+        _Z80_CASE(1459): _fetch(); // CPI (8)
+        _Z80_CASE(1460): _goto(1461); // INI (1)
+        _Z80_CASE(1461): _goto(1462); // INI (2)
+        _Z80_CASE(1462): _wait();_ioread(cpu->bc);_goto(1463); // INI (3)
+        _Z80_CASE(1463): cpu->dlatch=_gd();cpu->wz=cpu->bc+1;cpu->b--;;_goto(1464); // INI (4)
+        _Z80_CASE(1464): _goto(1465); // INI (5)
+        _Z80_CASE(1465): _wait();_mwrite(cpu->hl++,cpu->dlatch);_z80_ini_ind(cpu,cpu->dlatch,cpu->c+1);_goto(1466); // INI (6)
+        _Z80_CASE(1466): _goto(1467); // INI (7)
+        _Z80_CASE(1467): _fetch(); // INI (8)
+        _Z80_CASE(1468): _goto(1469); // OUTI (1)
+        _Z80_CASE(1469): _wait();_mread(cpu->hl++);_goto(1470); // OUTI (2)
+        _Z80_CASE(1470): cpu->dlatch=_gd();cpu->b--;_goto(1471); // OUTI (3)
+        _Z80_CASE(1471): _goto(1472); // OUTI (4)
+        _Z80_CASE(1472): _iowrite(cpu->bc,cpu->dlatch);_goto(1473); // OUTI (5)
+        _Z80_CASE(1473): _wait();cpu->wz=cpu->bc+1;_z80_outi_outd(cpu,cpu->dlatch);_goto(1474); // OUTI (6)
+        _Z80_CASE(1474): _goto(1475); // OUTI (7)
+        _Z80_CASE(1475): _fetch(); // OUTI (8)
+        _Z80_CASE(1476): _wait();_mread(cpu->hl--);_goto(1477); // LDD (1)
+        _Z80_CASE(1477): cpu->dlatch=_gd();_goto(1478); // LDD (2)
+        _Z80_CASE(1478): _goto(1479); // LDD (3)
+        _Z80_CASE(1479): _wait();_mwrite(cpu->de--,cpu->dlatch);_goto(1480); // LDD (4)
+        _Z80_CASE(1480): _goto(1481); // LDD (5)
+        _Z80_CASE(1481): _z80_ldi_ldd(cpu,cpu->dlatch);_goto(1482); // LDD (6)
+        _Z80_CASE(1482): _goto(1483); // LDD (7)
+        _Z80_CASE(1483): _fetch(); // LDD (8)
+        _Z80_CASE(1484): _wait();_mread(cpu->hl--);_goto(1485); // CPD (1)
+        _Z80_CASE(1485): cpu->dlatch=_gd();_goto(1486); // CPD (2)
+        _Z80_CASE(1486): cpu->wz--;_z80_cpi_cpd(cpu,cpu->dlatch);_goto(1487); // CPD (3)
+        _Z80_CASE(1487): _goto(1488); // CPD (4)
+        _Z80_CASE(1488): _goto(1489); // CPD (5)
+        _Z80_CASE(1489): _goto(1490); // CPD (6)
+        _Z80_CASE(1490): _goto(1491); // CPD (7)
+        _Z80_CASE(1491): _fetch(); // CPD (8)
+        _Z80_CASE(1492): _goto(1493); // IND (1)
+        _Z80_CASE(1493): _goto(1494); // IND (2)
+        _Z80_CASE(1494): _wait();_ioread(cpu->bc);_goto(1495); // IND (3)
+        _Z80_CASE(1495): cpu->dlatch=_gd();cpu->wz=cpu->bc-1;cpu->b--;;_goto(1496); // IND (4)
+        _Z80_CASE(1496): _goto(1497); // IND (5)
+        _Z80_CASE(1497): _wait();_mwrite(cpu->hl--,cpu->dlatch);_z80_ini_ind(cpu,cpu->dlatch,cpu->c-1);_goto(1498); // IND (6)
+        _Z80_CASE(1498): _goto(1499); // IND (7)
+        _Z80_CASE(1499): _fetch(); // IND (8)
+        _Z80_CASE(1500): _goto(1501); // OUTD (1)
+        _Z80_CASE(1501): _wait();_mread(cpu->hl--);_goto(1502); // OUTD (2)
+        _Z80_CASE(1502): cpu->dlatch=_gd();cpu->b--;_goto(1503); // OUTD (3)
+        _Z80_CASE(1503): _goto(1504); // OUTD (4)
+        _Z80_CASE(1504): _iowrite(cpu->bc,cpu->dlatch);_goto(1505); // OUTD (5)
+        _Z80_CASE(1505): _wait();cpu->wz=cpu->bc-1;_z80_outi_outd(cpu,cpu->dlatch);_goto(1506); // OUTD (6)
+        _Z80_CASE(1506): _goto(1507); // OUTD (7)
+        _Z80_CASE(1507): _fetch(); // OUTD (8)
+        _Z80_CASE(1508): _wait();_mread(cpu->hl++);_goto(1509); // LDIR (1)
+        _Z80_CASE(1509): cpu->dlatch=_gd();_goto(1510); // LDIR (2)
+        _Z80_CASE(1510): _goto(1511); // LDIR (3)
+        _Z80_CASE(1511): _wait();_mwrite(cpu->de++,cpu->dlatch);_goto(1512); // LDIR (4)
+        _Z80_CASE(1512): _goto(1513); // LDIR (5)
+        _Z80_CASE(1513): if(!_z80_ldi_ldd(cpu,cpu->dlatch)){_goto(1514+5);};_goto(1514); // LDIR (6)
+        _Z80_CASE(1514): _goto(1515); // LDIR (7)
+        _Z80_CASE(1515): cpu->wz=--cpu->pc;--cpu->pc;;_goto(1516); // LDIR (8)
+        _Z80_CASE(1516): _goto(1517); // LDIR (9)
+        _Z80_CASE(1517): _goto(1518); // LDIR (10)
+        _Z80_CASE(1518): _goto(1519); // LDIR (11)
+        _Z80_CASE(1519): _goto(1520); // LDIR (12)
+        _Z80_CASE(1520): _fetch(); // LDIR (13)
+        _Z80_CASE(1521): _wait();_mread(cpu->hl++);_goto(1522); // CPIR (1)
+        _Z80_CASE(1522): cpu->dlatch=_gd();_goto(1523); // CPIR (2)
+        _Z80_CASE(1523): cpu->wz++;if(!_z80_cpi_cpd(cpu,cpu->dlatch)){_goto(1524+5);};_goto(1524); // CPIR (3)
+        _Z80_CASE(1524): _goto(1525); // CPIR (4)
+        _Z80_CASE(1525): _goto(1526); // CPIR (5)
+        _Z80_CASE(1526): _goto(1527); // CPIR (6)
+        _Z80_CASE(1527): _goto(1528); // CPIR (7)
+        _Z80_CASE(1528): cpu->wz=--cpu->pc;--cpu->pc;_goto(1529); // CPIR (8)
+        _Z80_CASE(1529): _goto(1530); // CPIR (9)
+        _Z80_CASE(1530): _goto(1531); // CPIR (10)
+        _Z80_CASE(1531): _goto(1532); // CPIR (11)
+        _Z80_CASE(1532): _goto(1533); // CPIR (12)
+        _Z80_CASE(1533): _fetch(); // CPIR (13)
+        _Z80_CASE(1534): _goto(1535); // INIR (1)
+        _Z80_CASE(1535): _goto(1536); // INIR (2)
+        _Z80_CASE(1536): _wait();_ioread(cpu->bc);_goto(1537); // INIR (3)
+        _Z80_CASE(1537): cpu->dlatch=_gd();cpu->wz=cpu->bc+1;cpu->b--;;_goto(1538); // INIR (4)
+        _Z80_CASE(1538): _goto(1539); // INIR (5)
+        _Z80_CASE(1539): _wait();_mwrite(cpu->hl++,cpu->dlatch);if (!_z80_ini_ind(cpu,cpu->dlatch,cpu->c+1)){_goto(1540+5);};_goto(1540); // INIR (6)
+        _Z80_CASE(1540): _goto(1541); // INIR (7)
+        _Z80_CASE(1541): cpu->wz=--cpu->pc;--cpu->pc;_goto(1542); // INIR (8)
+        _Z80_CASE(1542): _goto(1543); // INIR (9)
+        _Z80_CASE(1543): _goto(1544); // INIR (10)
+        _Z80_CASE(1544): _goto(1545); // INIR (11)
+        _Z80_CASE(1545): _goto(1546); // INIR (12)
+        _Z80_CASE(1546): _fetch(); // INIR (13)
+        _Z80_CASE(1547): _goto(1548); // OTIR (1)
+        _Z80_CASE(1548): _wait();_mread(cpu->hl++);_goto(1549); // OTIR (2)
+        _Z80_CASE(1549): cpu->dlatch=_gd();cpu->b--;_goto(1550); // OTIR (3)
+        _Z80_CASE(1550): _goto(1551); // OTIR (4)
+        _Z80_CASE(1551): _iowrite(cpu->bc,cpu->dlatch);_goto(1552); // OTIR (5)
+        _Z80_CASE(1552): _wait();cpu->wz=cpu->bc+1;if(!_z80_outi_outd(cpu,cpu->dlatch)){_goto(1553+5);};_goto(1553); // OTIR (6)
+        _Z80_CASE(1553): _goto(1554); // OTIR (7)
+        _Z80_CASE(1554): cpu->wz=--cpu->pc;--cpu->pc;_goto(1555); // OTIR (8)
+        _Z80_CASE(1555): _goto(1556); // OTIR (9)
+        _Z80_CASE(1556): _goto(1557); // OTIR (10)
+        _Z80_CASE(1557): _goto(1558); // OTIR (11)
+        _Z80_CASE(1558): _goto(1559); // OTIR (12)
+        _Z80_CASE(1559): _fetch(); // OTIR (13)
+        _Z80_CASE(1560): _wait();_mread(cpu->hl--);_goto(1561); // LDDR (1)
+        _Z80_CASE(1561): cpu->dlatch=_gd();_goto(1562); // LDDR (2)
+        _Z80_CASE(1562): _goto(1563); // LDDR (3)
+        _Z80_CASE(1563): _wait();_mwrite(cpu->de--,cpu->dlatch);_goto(1564); // LDDR (4)
+        _Z80_CASE(1564): _goto(1565); // LDDR (5)
+        _Z80_CASE(1565): if(!_z80_ldi_ldd(cpu,cpu->dlatch)){_goto(1566+5);};_goto(1566); // LDDR (6)
+        _Z80_CASE(1566): _goto(1567); // LDDR (7)
+        _Z80_CASE(1567): cpu->wz=--cpu->pc;--cpu->pc;;_goto(1568); // LDDR (8)
+        _Z80_CASE(1568): _goto(1569); // LDDR (9)
+        _Z80_CASE(1569): _goto(1570); // LDDR (10)
+        _Z80_CASE(1570): _goto(1571); // LDDR (11)
+        _Z80_CASE(1571): _goto(1572); // LDDR (12)
+        _Z80_CASE(1572): _fetch(); // LDDR (13)
+        _Z80_CASE(1573): _wait();_mread(cpu->hl--);_goto(1574); // CPDR (1)
+        _Z80_CASE(1574): cpu->dlatch=_gd();_goto(1575); // CPDR (2)
+        _Z80_CASE(1575): cpu->wz--;if(!_z80_cpi_cpd(cpu,cpu->dlatch)){_goto(1576+5);};_goto(1576); // CPDR (3)
+        _Z80_CASE(1576): _goto(1577); // CPDR (4)
+        _Z80_CASE(1577): _goto(1578); // CPDR (5)
+        _Z80_CASE(1578): _goto(1579); // CPDR (6)
+        _Z80_CASE(1579): _goto(1580); // CPDR (7)
+        _Z80_CASE(1580): cpu->wz=--cpu->pc;--cpu->pc;_goto(1581); // CPDR (8)
+        _Z80_CASE(1581): _goto(1582); // CPDR (9)
+        _Z80_CASE(1582): _goto(1583); // CPDR (10)
+        _Z80_CASE(1583): _goto(1584); // CPDR (11)
+        _Z80_CASE(1584): _goto(1585); // CPDR (12)
+        _Z80_CASE(1585): _fetch(); // CPDR (13)
+        _Z80_CASE(1586): _goto(1587); // INDR (1)
+        _Z80_CASE(1587): _goto(1588); // INDR (2)
+        _Z80_CASE(1588): _wait();_ioread(cpu->bc);_goto(1589); // INDR (3)
+        _Z80_CASE(1589): cpu->dlatch=_gd();cpu->wz=cpu->bc-1;cpu->b--;;_goto(1590); // INDR (4)
+        _Z80_CASE(1590): _goto(1591); // INDR (5)
+        _Z80_CASE(1591): _wait();_mwrite(cpu->hl--,cpu->dlatch);if (!_z80_ini_ind(cpu,cpu->dlatch,cpu->c-1)){_goto(1592+5);};_goto(1592); // INDR (6)
+        _Z80_CASE(1592): _goto(1593); // INDR (7)
+        _Z80_CASE(1593): cpu->wz=--cpu->pc;--cpu->pc;_goto(1594); // INDR (8)
+        _Z80_CASE(1594): _goto(1595); // INDR (9)
+        _Z80_CASE(1595): _goto(1596); // INDR (10)
+        _Z80_CASE(1596): _goto(1597); // INDR (11)
+        _Z80_CASE(1597): _goto(1598); // INDR (12)
+        _Z80_CASE(1598): _fetch(); // INDR (13)
+        _Z80_CASE(1599): _goto(1600); // OTDR (1)
+        _Z80_CASE(1600): _wait();_mread(cpu->hl--);_goto(1601); // OTDR (2)
+        _Z80_CASE(1601): cpu->dlatch=_gd();cpu->b--;_goto(1602); // OTDR (3)
+        _Z80_CASE(1602): _goto(1603); // OTDR (4)
+        _Z80_CASE(1603): _iowrite(cpu->bc,cpu->dlatch);_goto(1604); // OTDR (5)
+        _Z80_CASE(1604): _wait();cpu->wz=cpu->bc-1;if(!_z80_outi_outd(cpu,cpu->dlatch)){_goto(1605+5);};_goto(1605); // OTDR (6)
+        _Z80_CASE(1605): _goto(1606); // OTDR (7)
+        _Z80_CASE(1606): cpu->wz=--cpu->pc;--cpu->pc;_goto(1607); // OTDR (8)
+        _Z80_CASE(1607): _goto(1608); // OTDR (9)
+        _Z80_CASE(1608): _goto(1609); // OTDR (10)
+        _Z80_CASE(1609): _goto(1610); // OTDR (11)
+        _Z80_CASE(1610): _goto(1611); // OTDR (12)
+        _Z80_CASE(1611): _fetch(); // OTDR (13)
+        _Z80_CASE(1612): _sync_flags();{uint8_t z=cpu->opcode&7;_z80_cb_action(cpu,z,z);};_fetch(); // cb (0)
+        _Z80_CASE(1613): _sync_flags();_goto(1614); // cbhl (0)
+        _Z80_CASE(1614): _wait();_mread(cpu->hl);_goto(1615); // cbhl (1)
+        _Z80_CASE(1615): cpu->dlatch=_gd();if(!_z80_cb_action(cpu,6,6)){_goto(1616+3);};_goto(1616); // cbhl (2)
+        _Z80_CASE(1616): _goto(1617); // cbhl (3)
+        _Z80_CASE(1617): _goto(1618); // cbhl (4)
+        _Z80_CASE(1618): _wait();_mwrite(cpu->hl,cpu->dlatch);_goto(1619); // cbhl (5)
+        _Z80_CASE(1619): _goto(1620); // cbhl (6)
+        _Z80_CASE(1620): _fetch(); // cbhl (7)
+        _Z80_CASE(1621): _sync_flags();_wait();_mread(cpu->pc++);_goto(1622); // ddfdcb (0)
+        _Z80_CASE(1622): _z80_ddfdcb_addr(cpu,pins);_goto(1623); // ddfdcb (1)
+        _Z80_CASE(1623): _goto(1624); // ddfdcb (2)
+        _Z80_CASE(1624): _wait();_mread(cpu->pc++);_goto(1625); // ddfdcb (3)
+        _Z80_CASE(1625): cpu->opcode=_gd();_goto(1626); // ddfdcb (4)
+        _Z80_CASE(1626): _goto(1627); // ddfdcb (5)
+        _Z80_CASE(1627): _goto(1628); // ddfdcb (6)
+        _Z80_CASE(1628): _goto(1629); // ddfdcb (7)
+        _Z80_CASE(1629): _wait();_mread(cpu->addr);_goto(1630); // ddfdcb (8)
+        _Z80_CASE(1630): cpu->dlatch=_gd();if(!_z80_cb_action(cpu,6,cpu->opcode&7)){_goto(1631+3);};_goto(1631); // ddfdcb (9)
+        _Z80_CASE(1631): _goto(1632); // ddfdcb (10)
+        _Z80_CASE(1632): _goto(1633); // ddfdcb (11)
+        _Z80_CASE(1633): _wait();_mwrite(cpu->addr,cpu->dlatch);_goto(1634); // ddfdcb (12)
+        _Z80_CASE(1634): _goto(1635); // ddfdcb (13)
+        _Z80_CASE(1635): _fetch(); // ddfdcb (14)
+        _Z80_CASE(1636): cpu->iff1=cpu->iff2=false;_goto(1637); // int_im0 (0)
+        _Z80_CASE(1637): pins|=(Z80_M1|Z80_IORQ);_goto(1638); // int_im0 (1)
+        _Z80_CASE(1638): _wait();cpu->opcode=_z80_get_db(pins);_goto(1639); // int_im0 (2)
+        _Z80_CASE(1639): pins=_z80_refresh(cpu,pins);_goto(1640); // int_im0 (3)
+        _Z80_CASE(1640): cpu->addr=cpu->hl;_goto(cpu->opcode);_goto(1641); // int_im0 (4)
+        _Z80_CASE(1641): _fetch(); // int_im0 (5)
+        _Z80_CASE(1642): cpu->iff1=cpu->iff2=false;_goto(1643); // int_im1 (0)
+        _Z80_CASE(1643): pins|=(Z80_M1|Z80_IORQ);_goto(1644); // int_im1 (1)
+        _Z80_CASE(1644): _wait();_goto(1645); // int_im1 (2)
+        _Z80_CASE(1645): pins=_z80_refresh(cpu,pins);_goto(1646); // int_im1 (3)
+        _Z80_CASE(1646): _goto(1647); // int_im1 (4)
+        _Z80_CASE(1647): _goto(1648); // int_im1 (5)
+        _Z80_CASE(1648): _goto(1649); // int_im1 (6)
+        _Z80_CASE(1649): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1650); // int_im1 (7)
+        _Z80_CASE(1650): _goto(1651); // int_im1 (8)
+        _Z80_CASE(1651): _goto(1652); // int_im1 (9)
+        _Z80_CASE(1652): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=cpu->pc=0x0038;_goto(1653); // int_im1 (10)
+        _Z80_CASE(1653): _goto(1654); // int_im1 (11)
+        _Z80_CASE(1654): _fetch(); // int_im1 (12)
+        _Z80_CASE(1655): cpu->iff1=cpu->iff2=false;_goto(1656); // int_im2 (0)
+        _Z80_CASE(1656): pins|=(Z80_M1|Z80_IORQ);_goto(1657); // int_im2 (1)
+        _Z80_CASE(1657): _wait();cpu->dlatch=_z80_get_db(pins);_goto(1658); // int_im2 (2)
+        _Z80_CASE(1658): pins=_z80_refresh(cpu,pins);_goto(1659); // int_im2 (3)
+        _Z80_CASE(1659): _goto(1660); // int_im2 (4)
+        _Z80_CASE(1660): _goto(1661); // int_im2 (5)
+        _Z80_CASE(1661): _goto(1662); // int_im2 (6)
+        _Z80_CASE(1662): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1663); // int_im2 (7)
+        _Z80_CASE(1663): _goto(1664); // int_im2 (8)
+        _Z80_CASE(1664): _goto(1665); // int_im2 (9)
+        _Z80_CASE(1665): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wzl=cpu->dlatch;cpu->wzh=cpu->i;_goto(1666); // int_im2 (10)
+        _Z80_CASE(1666): _goto(1667); // int_im2 (11)
+        _Z80_CASE(1667): _goto(1668); // int_im2 (12)
+        _Z80_CASE(1668): _wait();_mread(cpu->wz++);_goto(1669); // int_im2 (13)
+        _Z80_CASE(1669): cpu->dlatch=_gd();_goto(1670); // int_im2 (14)
+        _Z80_CASE(1670): _goto(1671); // int_im2 (15)
+        _Z80_CASE(1671): _wait();_mread(cpu->wz);_goto(1672); // int_im2 (16)
+        _Z80_CASE(1672): cpu->wzh=_gd();cpu->wzl=cpu->dlatch;cpu->pc=cpu->wz;_goto(1673); // int_im2 (17)
+        _Z80_CASE(1673): _fetch(); // int_im2 (18)
+        _Z80_CASE(1674): _wait();cpu->iff1=false;_goto(1675); // nmi (0)
+        _Z80_CASE(1675): pins=_z80_refresh(cpu,pins);_goto(1676); // nmi (1)
+        _Z80_CASE(1676): _goto(1677); // nmi (2)
+        _Z80_CASE(1677): _goto(1678); // nmi (3)
+        _Z80_CASE(1678): _goto(1679); // nmi (4)
+        _Z80_CASE(1679): _wait();_mwrite(--cpu->sp,cpu->pch);_goto(1680); // nmi (5)
+        _Z80_CASE(1680): _goto(1681); // nmi (6)
+        _Z80_CASE(1681): _goto(1682); // nmi (7)
+        _Z80_CASE(1682): _wait();_mwrite(--cpu->sp,cpu->pcl);cpu->wz=cpu->pc=0x0066;_goto(1683); // nmi (8)
+        _Z80_CASE(1683): _goto(1684); // nmi (9)
+        _Z80_CASE(1684): _fetch(); // nmi (10)
         // %>
         //=== shared fetch machine cycle for DD/FD-prefixed ops
-        case Z80_DDFD_M1_T2: _wait(); cpu->opcode = _gd(); _goto(Z80_DDFD_M1_T3);
-        case Z80_DDFD_M1_T3: pins = _z80_refresh(cpu, pins); _goto(Z80_DDFD_M1_T4);
-        case Z80_DDFD_M1_T4:
+        _Z80_CASE(Z80_DDFD_M1_T2): _wait(); cpu->opcode = _gd(); _goto(Z80_DDFD_M1_T3);
+        _Z80_CASE(Z80_DDFD_M1_T3): pins = _z80_refresh(cpu, pins); _goto(Z80_DDFD_M1_T4);
+        _Z80_CASE(Z80_DDFD_M1_T4):
             cpu->addr = cpu->hlx[cpu->hlx_idx].hl;
             _goto(_z80_indirect_table[cpu->opcode] ? Z80_DDFD_D_T1 : cpu->opcode);
         //=== optional d-loading cycle for (IX+d), (IY+d)
-        case Z80_DDFD_D_T1: _goto(Z80_DDFD_D_T2);
-        case Z80_DDFD_D_T2: _wait(); _mread(cpu->pc++); _goto(Z80_DDFD_D_T3);
-        case Z80_DDFD_D_T3: cpu->addr += (int8_t)_gd(); cpu->wz = cpu->addr; _goto(Z80_DDFD_D_T4);
+        _Z80_CASE(Z80_DDFD_D_T1): _goto(Z80_DDFD_D_T2);
+        _Z80_CASE(Z80_DDFD_D_T2): _wait(); _mread(cpu->pc++); _goto(Z80_DDFD_D_T3);
+        _Z80_CASE(Z80_DDFD_D_T3): cpu->addr += (int8_t)_gd(); cpu->wz = cpu->addr; _goto(Z80_DDFD_D_T4);
         //--- special case LD (IX/IY+d),n or filler ticks
-        case Z80_DDFD_D_T4: _goto(Z80_DDFD_D_T5);
-        case Z80_DDFD_D_T5: if (cpu->opcode == 0x36) { _wait();_mread(cpu->pc++); }; _goto(Z80_DDFD_D_T6);
-        case Z80_DDFD_D_T6: if (cpu->opcode == 0x36) { cpu->dlatch = _gd(); }; _goto(Z80_DDFD_D_T7);
-        case Z80_DDFD_D_T7: _goto(Z80_DDFD_D_T8);
-        case Z80_DDFD_D_T8: _goto((cpu->opcode==0x36) ? Z80_DDFD_LDHLN_WR_T1 : cpu->opcode);
+        _Z80_CASE(Z80_DDFD_D_T4): _goto(Z80_DDFD_D_T5);
+        _Z80_CASE(Z80_DDFD_D_T5): if (cpu->opcode == 0x36) { _wait();_mread(cpu->pc++); }; _goto(Z80_DDFD_D_T6);
+        _Z80_CASE(Z80_DDFD_D_T6): if (cpu->opcode == 0x36) { cpu->dlatch = _gd(); }; _goto(Z80_DDFD_D_T7);
+        _Z80_CASE(Z80_DDFD_D_T7): _goto(Z80_DDFD_D_T8);
+        _Z80_CASE(Z80_DDFD_D_T8): _goto((cpu->opcode==0x36) ? Z80_DDFD_LDHLN_WR_T1 : cpu->opcode);
         //--- special case LD (IX/IY+d),n write mcycle
-        case Z80_DDFD_LDHLN_WR_T1: _goto(Z80_DDFD_LDHLN_WR_T2);
-        case Z80_DDFD_LDHLN_WR_T2: _wait(); _mwrite(cpu->addr,cpu->dlatch); _goto(Z80_DDFD_LDHLN_WR_T3);
-        case Z80_DDFD_LDHLN_WR_T3: _goto(Z80_DDFD_LDHLN_OVERLAPPED);
-        case Z80_DDFD_LDHLN_OVERLAPPED: _fetch();
+        _Z80_CASE(Z80_DDFD_LDHLN_WR_T1): _goto(Z80_DDFD_LDHLN_WR_T2);
+        _Z80_CASE(Z80_DDFD_LDHLN_WR_T2): _wait(); _mwrite(cpu->addr,cpu->dlatch); _goto(Z80_DDFD_LDHLN_WR_T3);
+        _Z80_CASE(Z80_DDFD_LDHLN_WR_T3): _goto(Z80_DDFD_LDHLN_OVERLAPPED);
+        _Z80_CASE(Z80_DDFD_LDHLN_OVERLAPPED): _fetch();
         //=== special opcode fetch machine cycle for CB-prefixed instructions
-        case Z80_CB_M1_T2: _wait(); cpu->opcode = _gd(); _goto(Z80_CB_M1_T3);
-        case Z80_CB_M1_T3: pins = _z80_refresh(cpu, pins); _goto(Z80_CB_M1_T4);
-        case Z80_CB_M1_T4:
+        _Z80_CASE(Z80_CB_M1_T2): _wait(); cpu->opcode = _gd(); _goto(Z80_CB_M1_T3);
+        _Z80_CASE(Z80_CB_M1_T3): pins = _z80_refresh(cpu, pins); _goto(Z80_CB_M1_T4);
+        _Z80_CASE(Z80_CB_M1_T4):
             if ((cpu->opcode & 7) == 6) {
                 // this is a (HL) instruction
                 cpu->addr = cpu->hl;
@@ -2789,13 +3307,13 @@ uint64_t z80_tick(z80_t* cpu, uint64_t pins) {
                 _goto(Z80_CB_STEP);
             }
         //=== special opcode fetch machine cycle for ED-prefixed instructions
-        case Z80_ED_M1_T2: _wait(); cpu->opcode = _gd(); _goto(Z80_ED_M1_T3);
-        case Z80_ED_M1_T3: pins = _z80_refresh(cpu, pins); _goto(Z80_ED_M1_T4);
-        case Z80_ED_M1_T4: _goto(cpu->opcode + 256);
+        _Z80_CASE(Z80_ED_M1_T2): _wait(); cpu->opcode = _gd(); _goto(Z80_ED_M1_T3);
+        _Z80_CASE(Z80_ED_M1_T3): pins = _z80_refresh(cpu, pins); _goto(Z80_ED_M1_T4);
+        _Z80_CASE(Z80_ED_M1_T4): _goto(cpu->opcode + 256);
         //=== shared fetch machine cycle for non-DD/FD-prefixed ops
-        case Z80_M1_T2: _wait(); cpu->opcode = _gd(); _goto(Z80_M1_T3);
-        case Z80_M1_T3: pins = _z80_refresh(cpu, pins); _goto(Z80_M1_T4);
-        case Z80_M1_T4: cpu->addr = cpu->hl; _goto(cpu->opcode);
+        _Z80_CASE(Z80_M1_T2): _wait(); cpu->opcode = _gd(); _goto(Z80_M1_T3);
+        _Z80_CASE(Z80_M1_T3): pins = _z80_refresh(cpu, pins); _goto(Z80_M1_T4);
+        _Z80_CASE(Z80_M1_T4): cpu->addr = cpu->hl; _goto(cpu->opcode);
         default: _Z80_UNREACHABLE;
     }
 fetch_next:
@@ -2811,6 +3329,74 @@ step_to: {
     return pins;
 }
 
+uint64_t z80_tick(z80_t* cpu, uint64_t pins) {
+    return _z80_tick(cpu, pins);
+}
+
+#if defined(MEM_NUM_LAYERS)
+uint64_t z80_exec(z80_t* cpu, mem_t* mem, uint64_t pins, uint32_t num_ticks, z80_tick_t tick_cb, void* user_data) {
+    CHIPS_ASSERT(cpu && mem && tick_cb && (num_ticks > 0));
+    uint32_t ticks = 0;
+    for (uint32_t i = 0; i < num_ticks; i++) {
+        pins = _z80_tick(cpu, pins);
+        ticks++;
+        // only plain memory accesses and idle ticks are handled inline,
+        // anything else, and the last tick, is forwarded to the system
+        const uint64_t side_effects = pins & (Z80_IORQ|Z80_WAIT|Z80_RETI);
+        if ((0 == side_effects) && ((i + 1) < num_ticks)) {
+            if ((pins & (Z80_MREQ|Z80_RD)) == (Z80_MREQ|Z80_RD)) {
+                const uint8_t data = mem_rd(mem, Z80_GET_ADDR(pins));
+                Z80_SET_DATA(pins, data);
+            }
+            else if ((pins & (Z80_MREQ|Z80_WR)) == (Z80_MREQ|Z80_WR)) {
+                mem_wr(mem, Z80_GET_ADDR(pins), Z80_GET_DATA(pins));
+            }
+        }
+        else {
+            pins = tick_cb(ticks, pins, user_data);
+            ticks = 0;
+        }
+    }
+    return pins;
+}
+#endif
+
+#if defined(CHIPS_FOURCC)
+void z80_serialize(z80_t* cpu, chips_stream_t* s) {
+    CHIPS_ASSERT(cpu && s);
+    // lazily evaluated flags are not part of the stream
+    z80_sync_flags(cpu);
+    if (!chips_stream_begin(s, CHIPS_FOURCC('Z','8','0',' '), 1)) {
+        return;
+    }
+    chips_stream_u16(s, &cpu->step);
+    chips_stream_u16(s, &cpu->addr);
+    chips_stream_u8(s, &cpu->dlatch);
+    chips_stream_u8(s, &cpu->opcode);
+    chips_stream_u8(s, &cpu->hlx_idx);
+    chips_stream_bool(s, &cpu->prefix_active);
+    chips_stream_u64(s, &cpu->pins);
+    chips_stream_u64(s, &cpu->int_bits);
+    chips_stream_u16(s, &cpu->pc);
+    chips_stream_u16(s, &cpu->af);
+    chips_stream_u16(s, &cpu->bc);
+    chips_stream_u16(s, &cpu->de);
+    chips_stream_u16(s, &cpu->hl);
+    chips_stream_u16(s, &cpu->ix);
+    chips_stream_u16(s, &cpu->iy);
+    chips_stream_u16(s, &cpu->wz);
+    chips_stream_u16(s, &cpu->sp);
+    chips_stream_u16(s, &cpu->ir);
+    chips_stream_u16(s, &cpu->af2);
+    chips_stream_u16(s, &cpu->bc2);
+    chips_stream_u16(s, &cpu->de2);
+    chips_stream_u16(s, &cpu->hl2);
+    chips_stream_u8(s, &cpu->im);
+    chips_stream_bool(s, &cpu->iff1);
+    chips_stream_bool(s, &cpu->iff2);
+}
+#endif
+
 #undef _sa
 #undef _sax
 #undef _sad
@@ -2826,6 +3412,7 @@ step_to: {
 #undef _ioread
 #undef _iowrite
 #undef _wait
+#undef _sync_flags
 #undef _cc_nz
 #undef _cc_z
 #undef _cc_nc
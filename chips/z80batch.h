@@ -0,0 +1,892 @@
+#pragma once
+/*#
+    # z80batch.h
+
+    Lockstep execution of many Z80 instances (lanes) with a
+    structure-of-arrays register file and direct memory access through
+    mem_t.
+
+    Do this:
+    ~~~~C
+    #define CHIPS_IMPL
+    ~~~~
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Optionally provide
+    ~~~C
+    #define CHIPS_ASSERT(x) your_own_asset_macro(x)
+    ~~~
+
+    You need to include the following headers before including z80batch.h,
+    (with CHIPS_IMPL defined, the z80.h implementation must be in the same
+    C or C++ file since z80batch.h uses the inlined Z80 tick function and
+    flag helpers):
+
+    - chips/mem.h
+    - chips/z80.h
+
+    ## Overview
+
+    z80batch_exec() runs num_lanes Z80 instances for the same number of
+    ticks, with the same results as calling z80_exec() on each lane. This is
+    meant for running many copies of the same machine which only differ in
+    their input (for instance for fuzzing or ROM regression tests).
+
+    Execution happens in rounds, and each lane executes one instruction
+    per round. Between instructions, the registers which are used by the
+    common unprefixed instructions (B, C, D, E, H, L, F, A, SP, PC, WZ and
+    R) of all lanes live in a structure-of-arrays register file
+    (z80batch_regs_t). The lanes are grouped by the opcode of their next
+    instruction, and each group is executed with one decoder dispatch for
+    all lanes of the group. As long as the lanes haven't diverged (all
+    lanes execute the same opcode), the register-only instructions (LD r,r',
+    8-bit ALU ops, INC/DEC, 16-bit INC/DEC and ADD, rotates, ...) are a plain
+    loop over the register arrays which the compiler can vectorize. Lanes
+    which have diverged are executed through an index list instead, and
+    memory accesses always go through the lane's mem_t.
+
+    Everything else falls back to the cycle-stepped decoder in z80.h for
+    this lane and instruction:
+
+    - prefixed instructions (CB, DD, ED, FD), IN/OUT, HALT, DI, EI, EXX,
+      EX AF,AF' and EX (SP),HL
+    - interrupt requests (an active NMI edge, or the INT pin with interrupts
+      enabled), and an active WAIT pin
+    - the last few ticks of a z80batch_exec() call, so that the last tick
+      of each lane goes to the tick callback like in z80_exec()
+
+    Just as with z80_exec(), plain memory accesses are handled inline, and
+    the tick callback is only called for IO requests, interrupt acknowledge,
+    wait states, RETI and the last tick of a batch. The callback gets the
+    lane index as first argument, and the number of ticks since the last
+    callback for this lane (instructions executed in lockstep are included
+    in this number).
+
+    The z80_t instances are the persistent CPU state, the register file
+    is only used during z80batch_exec(). The z80_t of a lane is always up to
+    date when the tick callback is called for this lane, and all z80_t
+    instances are up to date when z80batch_exec() returns. The internal
+    latches of a z80_t (opcode, addr, dlatch and the data bus bits of the
+    last pin state) may differ from running z80_exec() after an instruction
+    was executed in lockstep, they are overwritten before they are used
+    in the next instruction.
+
+    The lanes are executed one after another, so lanes must not share any
+    writable memory.
+
+    ## Functions
+
+    ~~~C
+    void z80batch_init(z80batch_t* batch, const z80batch_desc_t* desc)
+    ~~~
+        Initialize a z80batch_t instance:
+
+        ~~~C
+        typedef struct {
+            int num_lanes;              // number of lanes (max Z80BATCH_MAX_LANES)
+            z80_t** cpu;                // pointers to num_lanes initialized z80_t instances
+            mem_t** mem;                // pointers to num_lanes mem_t instances
+            const uint64_t* pins;       // initial pin masks (e.g. from z80_init()), may be null
+            z80batch_tick_t tick_cb;    // system tick callback
+            void** user_data;           // per-lane user data pointers for the tick callback, may be null
+        } z80batch_desc_t;
+        ~~~
+
+    ~~~C
+    void z80batch_exec(z80batch_t* batch, uint32_t num_ticks)
+    ~~~
+        Execute num_ticks on all lanes. The current pin masks are in
+        batch->pins[] and may be modified between calls (for instance to
+        set the Z80_INT pin).
+
+        The same rules as for z80_exec() apply (see z80.h).
+
+        The number of instructions executed in lockstep is counted in
+        batch->num_lockstep_ops, and the number of those which were executed
+        in a group of all lanes in batch->num_dense_ops.
+
+    ## zlib/libpng license
+
+    Copyright (c) 2021 Andre Weissflog
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define Z80BATCH_MAX_LANES (256)
+
+// register indices in z80batch_regs_t.r8[], same as the 3-bit register encoding in Z80 opcodes, F uses the (HL) slot
+#define Z80BATCH_B (0)
+#define Z80BATCH_C (1)
+#define Z80BATCH_D (2)
+#define Z80BATCH_E (3)
+#define Z80BATCH_H (4)
+#define Z80BATCH_L (5)
+#define Z80BATCH_F (6)
+#define Z80BATCH_A (7)
+
+// system tick callback, called with the lane index and the number of ticks since the last call for this lane
+typedef uint64_t (*z80batch_tick_t)(int lane, uint32_t num_ticks, uint64_t pins, void* user_data);
+
+typedef struct {
+    int num_lanes;              // number of lanes (max Z80BATCH_MAX_LANES)
+    z80_t** cpu;                // pointers to num_lanes initialized z80_t instances
+    mem_t** mem;                // pointers to num_lanes mem_t instances
+    const uint64_t* pins;       // initial pin masks (e.g. from z80_init()), may be null
+    z80batch_tick_t tick_cb;    // system tick callback
+    void** user_data;           // per-lane user data pointers for the tick callback, may be null
+} z80batch_desc_t;
+
+// structure-of-arrays register file of the lanes in lockstep mode
+typedef struct {
+    uint8_t r8[8][Z80BATCH_MAX_LANES];  // 8-bit registers, indexed by Z80BATCH_B..Z80BATCH_A
+    uint16_t sp[Z80BATCH_MAX_LANES];
+    uint16_t pc[Z80BATCH_MAX_LANES];    // address after the opcode of the next instruction
+    uint16_t wz[Z80BATCH_MAX_LANES];
+    uint8_t r[Z80BATCH_MAX_LANES];      // refresh register
+    uint8_t op[Z80BATCH_MAX_LANES];     // opcode of the next instruction (already fetched)
+} z80batch_regs_t;
+
+typedef struct {
+    int num_lanes;
+    z80batch_tick_t tick_cb;
+    uint64_t pins[Z80BATCH_MAX_LANES];
+    uint32_t ticks[Z80BATCH_MAX_LANES];     // ticks since the last callback per lane
+    uint32_t left[Z80BATCH_MAX_LANES];      // ticks left in the current z80batch_exec() call per lane
+    bool lockstep[Z80BATCH_MAX_LANES];      // true if the lane's registers are in regs
+    bool stepped[Z80BATCH_MAX_LANES];       // true if the lane has executed an instruction in lockstep
+    z80_t* cpu[Z80BATCH_MAX_LANES];
+    mem_t* mem[Z80BATCH_MAX_LANES];
+    void* user_data[Z80BATCH_MAX_LANES];
+    z80batch_regs_t regs;
+    uint64_t num_lockstep_ops;              // number of instructions executed in lockstep (over all lanes)
+    uint64_t num_dense_ops;                 // ...of those in a group of all lanes
+} z80batch_t;
+
+// initialize a new z80batch_t instance
+void z80batch_init(z80batch_t* batch, const z80batch_desc_t* desc);
+// execute a number of ticks on all lanes
+void z80batch_exec(z80batch_t* batch, uint32_t num_ticks);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_IMPL
+#include <string.h>
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+// the longest instruction executed in lockstep (CALL nn), lanes with fewer ticks left run on the z80_t
+#define _Z80BATCH_MAX_OP_TICKS (17)
+
+/* number of ticks of the unprefixed instructions which are executed in
+   lockstep (0: executed on the z80_t), for conditional instructions this
+   is the number of ticks when the condition isn't met
+*/
+static const uint8_t _z80batch_op_ticks[256] = {
+     4, 10,  7,  6,  4,  4,  7,  4,  0, 11,  7,  6,  4,  4,  7,  4,
+     8, 10,  7,  6,  4,  4,  7,  4, 12, 11,  7,  6,  4,  4,  7,  4,
+     7, 10, 16,  6,  4,  4,  7,  4,  7, 11, 16,  6,  4,  4,  7,  4,
+     7, 10, 13,  6, 11, 11, 10,  4,  7, 11, 13,  6,  4,  4,  7,  4,
+     4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+     4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+     4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+     7,  7,  7,  7,  7,  7,  0,  7,  4,  4,  4,  4,  4,  4,  7,  4,
+     4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+     4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+     4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+     4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+     5, 10, 10, 10, 10, 11,  7, 11,  5, 10, 10,  0, 10, 17,  7, 11,
+     5, 10, 10,  0, 10, 11,  7, 11,  5,  0, 10,  0, 10,  0,  7, 11,
+     5, 10, 10,  0, 10, 11,  7, 11,  5,  4, 10,  4, 10,  0,  7, 11,
+     5, 10, 10,  0, 10, 11,  7, 11,  5,  6, 10,  0, 10,  0,  7, 11,
+};
+
+// flag tested by the condition codes NZ, Z, NC, C, PO, PE, P, M
+static const uint8_t _z80batch_cc_flag[8] = {
+    Z80_ZF, Z80_ZF, Z80_CF, Z80_CF, Z80_PF, Z80_PF, Z80_SF, Z80_SF
+};
+
+void z80batch_init(z80batch_t* batch, const z80batch_desc_t* desc) {
+    CHIPS_ASSERT(batch && desc);
+    CHIPS_ASSERT((desc->num_lanes > 0) && (desc->num_lanes <= Z80BATCH_MAX_LANES));
+    CHIPS_ASSERT(desc->cpu && desc->mem && desc->tick_cb);
+    memset(batch, 0, sizeof(z80batch_t));
+    batch->num_lanes = desc->num_lanes;
+    batch->tick_cb = desc->tick_cb;
+    for (int i = 0; i < batch->num_lanes; i++) {
+        CHIPS_ASSERT(desc->cpu[i] && desc->mem[i]);
+        batch->cpu[i] = desc->cpu[i];
+        batch->mem[i] = desc->mem[i];
+        batch->pins[i] = desc->pins ? desc->pins[i] : 0;
+        batch->user_data[i] = desc->user_data ? desc->user_data[i] : 0;
+    }
+}
+
+// true if the condition code cc (0..7) is met
+static inline bool _z80batch_cc(uint8_t f, int cc) {
+    return ((f & _z80batch_cc_flag[cc]) != 0) == ((cc & 1) != 0);
+}
+
+static inline uint16_t _z80batch_get16(const z80batch_regs_t* r, int hi, int lo, int l) {
+    return (uint16_t)((r->r8[hi][l] << 8) | r->r8[lo][l]);
+}
+
+static inline void _z80batch_set16(z80batch_regs_t* r, int hi, int lo, int l, uint16_t val) {
+    r->r8[hi][l] = (uint8_t)(val >> 8);
+    r->r8[lo][l] = (uint8_t)val;
+}
+
+// register pair p (0: BC, 1: DE, 2: HL, 3: SP)
+static inline uint16_t _z80batch_get_rp(const z80batch_regs_t* r, int p, int l) {
+    return (p == 3) ? r->sp[l] : _z80batch_get16(r, 2*p, 2*p+1, l);
+}
+
+static inline void _z80batch_set_rp(z80batch_regs_t* r, int p, int l, uint16_t val) {
+    if (p == 3) {
+        r->sp[l] = val;
+    }
+    else {
+        _z80batch_set16(r, 2*p, 2*p+1, l, val);
+    }
+}
+
+static inline uint16_t _z80batch_rd16(z80batch_t* b, int l, uint16_t addr) {
+    const uint8_t lo = mem_rd(b->mem[l], addr);
+    const uint8_t hi = mem_rd(b->mem[l], (uint16_t)(addr + 1));
+    return (uint16_t)((hi << 8) | lo);
+}
+
+// read a 16-bit immediate value at PC
+static inline uint16_t _z80batch_imm16(z80batch_t* b, int l) {
+    const uint16_t val = _z80batch_rd16(b, l, b->regs.pc[l]);
+    b->regs.pc[l] += 2;
+    return val;
+}
+
+static inline void _z80batch_push(z80batch_t* b, int l, uint16_t val) {
+    mem_wr(b->mem[l], --b->regs.sp[l], (uint8_t)(val >> 8));
+    mem_wr(b->mem[l], --b->regs.sp[l], (uint8_t)val);
+}
+
+static inline uint16_t _z80batch_pop(z80batch_t* b, int l) {
+    const uint16_t val = _z80batch_rd16(b, l, b->regs.sp[l]);
+    b->regs.sp[l] += 2;
+    return val;
+}
+
+// move a lane's registers from its z80_t into the register file
+static void _z80batch_enter(z80batch_t* b, int l) {
+    z80_t* cpu = b->cpu[l];
+    z80batch_regs_t* r = &b->regs;
+    z80_sync_flags(cpu);
+    r->r8[Z80BATCH_B][l] = cpu->b;
+    r->r8[Z80BATCH_C][l] = cpu->c;
+    r->r8[Z80BATCH_D][l] = cpu->d;
+    r->r8[Z80BATCH_E][l] = cpu->e;
+    r->r8[Z80BATCH_H][l] = cpu->h;
+    r->r8[Z80BATCH_L][l] = cpu->l;
+    r->r8[Z80BATCH_F][l] = cpu->f;
+    r->r8[Z80BATCH_A][l] = cpu->a;
+    r->sp[l] = cpu->sp;
+    r->pc[l] = cpu->pc;
+    r->wz[l] = cpu->wz;
+    r->r[l] = cpu->r;
+    r->op[l] = Z80_GET_DATA(b->pins[l]);
+    b->lockstep[l] = true;
+    b->stepped[l] = false;
+}
+
+// move a lane's registers back into its z80_t
+static void _z80batch_leave(z80batch_t* b, int l) {
+    z80_t* cpu = b->cpu[l];
+    const z80batch_regs_t* r = &b->regs;
+    cpu->b = r->r8[Z80BATCH_B][l];
+    cpu->c = r->r8[Z80BATCH_C][l];
+    cpu->d = r->r8[Z80BATCH_D][l];
+    cpu->e = r->r8[Z80BATCH_E][l];
+    cpu->h = r->r8[Z80BATCH_H][l];
+    cpu->l = r->r8[Z80BATCH_L][l];
+    cpu->f = r->r8[Z80BATCH_F][l];
+    cpu->a = r->r8[Z80BATCH_A][l];
+    cpu->sp = r->sp[l];
+    cpu->pc = r->pc[l];
+    cpu->wz = r->wz[l];
+    cpu->r = r->r[l];
+    if (b->stepped[l]) {
+        // the state after the overlapped opcode fetch of the next instruction
+        uint64_t pins = b->pins[l] & ~(Z80_CTRL_PIN_MASK|Z80_RETI|0xFFFFFFULL);
+        pins |= Z80_M1|Z80_MREQ|Z80_RD|(uint16_t)(r->pc[l] - 1)|((uint64_t)r->op[l] << 16);
+        b->pins[l] = pins;
+        cpu->pins = pins;
+        cpu->int_bits = pins & Z80_INT;
+    }
+    b->lockstep[l] = false;
+}
+
+// true if a lane on its z80_t can continue in lockstep
+static bool _z80batch_can_enter(const z80batch_t* b, int l) {
+    const z80_t* cpu = b->cpu[l];
+    const uint64_t pins = b->pins[l];
+    return (cpu->step == Z80_M1_T2) &&
+           (0 != _z80batch_op_ticks[Z80_GET_DATA(pins)]) &&
+           (0 == (pins & (Z80_WAIT|Z80_HALT))) &&
+           (0 == (cpu->int_bits & Z80_NMI)) &&
+           (0 == (pins & ~cpu->pins & Z80_NMI));
+}
+
+// true if a lane in lockstep can execute its next instruction in lockstep
+static bool _z80batch_can_step(const z80batch_t* b, int l) {
+    return (b->left[l] > _Z80BATCH_MAX_OP_TICKS) &&
+           (0 != _z80batch_op_ticks[b->regs.op[l]]) &&
+           ((0 == (b->pins[l] & Z80_INT)) || !b->cpu[l]->iff1);
+}
+
+// execute one instruction on the lane's z80_t, or until the lane has no ticks left
+static void _z80batch_scalar_step(z80batch_t* b, int l) {
+    z80_t* cpu = b->cpu[l];
+    mem_t* mem = b->mem[l];
+    uint64_t pins = b->pins[l];
+    uint32_t left = b->left[l];
+    uint32_t ticks = b->ticks[l];
+    do {
+        pins = _z80_tick(cpu, pins);
+        ticks++;
+        left--;
+        // same as z80_exec(): only plain memory accesses are handled inline
+        const uint64_t side_effects = pins & (Z80_IORQ|Z80_WAIT|Z80_RETI);
+        if ((0 == side_effects) && (left > 0)) {
+            if ((pins & (Z80_MREQ|Z80_RD)) == (Z80_MREQ|Z80_RD)) {
+                const uint8_t data = mem_rd(mem, Z80_GET_ADDR(pins));
+                Z80_SET_DATA(pins, data);
+            }
+            else if ((pins & (Z80_MREQ|Z80_WR)) == (Z80_MREQ|Z80_WR)) {
+                mem_wr(mem, Z80_GET_ADDR(pins), Z80_GET_DATA(pins));
+            }
+        }
+        else {
+            pins = b->tick_cb(l, ticks, pins, b->user_data[l]);
+            ticks = 0;
+        }
+    } while ((left > 0) && (cpu->step != Z80_M1_T2));
+    b->pins[l] = pins;
+    b->left[l] = left;
+    b->ticks[l] = ticks;
+}
+
+/* run 'body' for each lane 'l' of a group, if the group contains all lanes
+   this is a plain loop over the register file arrays
+*/
+#define _Z80BATCH_LANES(body) \
+    if (dense) { for (int l = 0; l < num_lanes; l++) { body } } \
+    else { for (int i = 0; i < num; i++) { const int l = lanes[i]; body } }
+
+// execute the instruction 'op' on a group of lanes
+static void _z80batch_step(z80batch_t* b, uint8_t op, const uint8_t* lanes, int num) {
+    const int num_lanes = b->num_lanes;
+    const bool dense = (num == num_lanes);
+    z80batch_regs_t* regs = &b->regs;
+    uint8_t* const A = regs->r8[Z80BATCH_A];
+    uint8_t* const F = regs->r8[Z80BATCH_F];
+    uint16_t* const PC = regs->pc;
+    uint16_t* const WZ = regs->wz;
+    uint32_t* const ticks = b->ticks;
+    uint32_t* const left = b->left;
+    // operand of the ALU instructions, either a register or loaded into val_buf
+    uint8_t val_buf[Z80BATCH_MAX_LANES];
+    const uint8_t* val = 0;
+    // opcode fields
+    const int y = (op >> 3) & 7;
+    const int z = op & 7;
+    const int p = y >> 1;
+
+    if ((op >= 0x40) && (op < 0x80)) {
+        // LD r,r' / LD r,(HL) / LD (HL),r (HALT isn't executed in lockstep)
+        if (z == 6) {
+            uint8_t* dst = regs->r8[y];
+            _Z80BATCH_LANES(dst[l] = mem_rd(b->mem[l], _z80batch_get16(regs, Z80BATCH_H, Z80BATCH_L, l));)
+        }
+        else if (y == 6) {
+            const uint8_t* src = regs->r8[z];
+            _Z80BATCH_LANES(mem_wr(b->mem[l], _z80batch_get16(regs, Z80BATCH_H, Z80BATCH_L, l), src[l]);)
+        }
+        else {
+            uint8_t* dst = regs->r8[y];
+            const uint8_t* src = regs->r8[z];
+            _Z80BATCH_LANES(dst[l] = src[l];)
+        }
+    }
+    else if ((op >= 0x80) && (op < 0xC0)) {
+        // ALU A,r / ALU A,(HL)
+        if (z == 6) {
+            _Z80BATCH_LANES(val_buf[l] = mem_rd(b->mem[l], _z80batch_get16(regs, Z80BATCH_H, Z80BATCH_L, l));)
+            val = val_buf;
+        }
+        else {
+            val = regs->r8[z];
+        }
+    }
+    else if ((op & 0xC7) == 0xC6) {
+        // ALU A,n
+        _Z80BATCH_LANES(val_buf[l] = mem_rd(b->mem[l], PC[l]++);)
+        val = val_buf;
+    }
+    else switch (op) {
+        case 0x00: // NOP
+            break;
+        case 0x01: case 0x11: case 0x21: case 0x31: // LD rr,nn
+            _Z80BATCH_LANES(_z80batch_set_rp(regs, p, l, _z80batch_imm16(b, l));)
+            break;
+        case 0x02: case 0x12: // LD (BC),A / LD (DE),A
+            _Z80BATCH_LANES({
+                const uint16_t addr = _z80batch_get_rp(regs, p, l);
+                mem_wr(b->mem[l], addr, A[l]);
+                WZ[l] = (uint16_t)((A[l] << 8) | ((addr + 1) & 0xFF));
+            })
+            break;
+        case 0x0A: case 0x1A: // LD A,(BC) / LD A,(DE)
+            _Z80BATCH_LANES({
+                const uint16_t addr = _z80batch_get_rp(regs, p, l);
+                A[l] = mem_rd(b->mem[l], addr);
+                WZ[l] = addr + 1;
+            })
+            break;
+        case 0x03: case 0x13: case 0x23: // INC rr
+        case 0x0B: case 0x1B: case 0x2B: { // DEC rr
+            uint8_t* hi = regs->r8[2*p];
+            uint8_t* lo = regs->r8[2*p+1];
+            const uint16_t inc = (op & 8) ? 0xFFFF : 1;
+            _Z80BATCH_LANES({
+                const uint16_t res = (uint16_t)(((hi[l] << 8) | lo[l]) + inc);
+                hi[l] = (uint8_t)(res >> 8);
+                lo[l] = (uint8_t)res;
+            })
+            break;
+        }
+        case 0x33: // INC SP
+            _Z80BATCH_LANES(regs->sp[l]++;)
+            break;
+        case 0x3B: // DEC SP
+            _Z80BATCH_LANES(regs->sp[l]--;)
+            break;
+        case 0x04: case 0x0C: case 0x14: case 0x1C: case 0x24: case 0x2C: case 0x34: case 0x3C: // INC r / INC (HL)
+        case 0x05: case 0x0D: case 0x15: case 0x1D: case 0x25: case 0x2D: case 0x35: case 0x3D: { // DEC r / DEC (HL)
+            uint8_t* dst = (y == 6) ? val_buf : regs->r8[y];
+            if (y == 6) {
+                _Z80BATCH_LANES(val_buf[l] = mem_rd(b->mem[l], _z80batch_get16(regs, Z80BATCH_H, Z80BATCH_L, l));)
+            }
+            if (z == 4) {
+                _Z80BATCH_LANES({
+                    const uint8_t v = dst[l];
+                    const uint8_t res = (uint8_t)(v + 1);
+                    F[l] = _z80_sz_flags(res) | (res & (Z80_XF|Z80_YF)) | ((res ^ v) & Z80_HF) |
+                           ((res == 0x80) ? Z80_VF : 0) | (F[l] & Z80_CF);
+                    dst[l] = res;
+                })
+            }
+            else {
+                _Z80BATCH_LANES({
+                    const uint8_t v = dst[l];
+                    const uint8_t res = (uint8_t)(v - 1);
+                    F[l] = Z80_NF | _z80_sz_flags(res) | (res & (Z80_XF|Z80_YF)) | ((res ^ v) & Z80_HF) |
+                           ((res == 0x7F) ? Z80_VF : 0) | (F[l] & Z80_CF);
+                    dst[l] = res;
+                })
+            }
+            if (y == 6) {
+                _Z80BATCH_LANES(mem_wr(b->mem[l], _z80batch_get16(regs, Z80BATCH_H, Z80BATCH_L, l), val_buf[l]);)
+            }
+            break;
+        }
+        case 0x06: case 0x0E: case 0x16: case 0x1E: case 0x26: case 0x2E: case 0x3E: { // LD r,n
+            uint8_t* dst = regs->r8[y];
+            _Z80BATCH_LANES(dst[l] = mem_rd(b->mem[l], PC[l]++);)
+            break;
+        }
+        case 0x36: // LD (HL),n
+            _Z80BATCH_LANES({
+                const uint8_t n = mem_rd(b->mem[l], PC[l]++);
+                mem_wr(b->mem[l], _z80batch_get16(regs, Z80BATCH_H, Z80BATCH_L, l), n);
+            })
+            break;
+        case 0x07: // RLCA
+            _Z80BATCH_LANES({
+                const uint8_t a = A[l];
+                const uint8_t res = (uint8_t)((a << 1) | (a >> 7));
+                F[l] = ((a >> 7) & Z80_CF) | (F[l] & (Z80_SF|Z80_ZF|Z80_PF)) | (res & (Z80_YF|Z80_XF));
+                A[l] = res;
+            })
+            break;
+        case 0x0F: // RRCA
+            _Z80BATCH_LANES({
+                const uint8_t a = A[l];
+                const uint8_t res = (uint8_t)((a >> 1) | (a << 7));
+                F[l] = (a & Z80_CF) | (F[l] & (Z80_SF|Z80_ZF|Z80_PF)) | (res & (Z80_YF|Z80_XF));
+                A[l] = res;
+            })
+            break;
+        case 0x17: // RLA
+            _Z80BATCH_LANES({
+                const uint8_t a = A[l];
+                const uint8_t res = (uint8_t)((a << 1) | (F[l] & Z80_CF));
+                F[l] = ((a >> 7) & Z80_CF) | (F[l] & (Z80_SF|Z80_ZF|Z80_PF)) | (res & (Z80_YF|Z80_XF));
+                A[l] = res;
+            })
+            break;
+        case 0x1F: // RRA
+            _Z80BATCH_LANES({
+                const uint8_t a = A[l];
+                const uint8_t res = (uint8_t)((a >> 1) | ((F[l] & Z80_CF) << 7));
+                F[l] = (a & Z80_CF) | (F[l] & (Z80_SF|Z80_ZF|Z80_PF)) | (res & (Z80_YF|Z80_XF));
+                A[l] = res;
+            })
+            break;
+        case 0x27: // DAA
+            _Z80BATCH_LANES({
+                const uint8_t a = A[l];
+                const uint8_t f = F[l];
+                const uint8_t lo = (((a & 0xF) > 0x9) || (f & Z80_HF)) ? 0x06 : 0x00;
+                const uint8_t hi = ((a > 0x99) || (f & Z80_CF)) ? 0x60 : 0x00;
+                const uint8_t res = (f & Z80_NF) ? (uint8_t)(a - lo - hi) : (uint8_t)(a + lo + hi);
+                F[l] = (f & (Z80_CF|Z80_NF)) | ((a > 0x99) ? Z80_CF : 0) | ((a ^ res) & Z80_HF) | _z80_szp_flags[res];
+                A[l] = res;
+            })
+            break;
+        case 0x2F: // CPL
+            _Z80BATCH_LANES({
+                const uint8_t a = A[l] ^ 0xFF;
+                F[l] = (F[l] & (Z80_SF|Z80_ZF|Z80_PF|Z80_CF)) | Z80_HF | Z80_NF | (a & (Z80_YF|Z80_XF));
+                A[l] = a;
+            })
+            break;
+        case 0x37: // SCF
+            _Z80BATCH_LANES(F[l] = (F[l] & (Z80_SF|Z80_ZF|Z80_PF|Z80_CF)) | Z80_CF | (A[l] & (Z80_YF|Z80_XF));)
+            break;
+        case 0x3F: // CCF
+            _Z80BATCH_LANES(F[l] = ((F[l] & (Z80_SF|Z80_ZF|Z80_PF|Z80_CF)) | ((F[l] & Z80_CF) << 4) | (A[l] & (Z80_YF|Z80_XF))) ^ Z80_CF;)
+            break;
+        case 0x09: case 0x19: case 0x29: case 0x39: // ADD HL,rr
+            _Z80BATCH_LANES({
+                const uint16_t acc = _z80batch_get16(regs, Z80BATCH_H, Z80BATCH_L, l);
+                const uint16_t v = _z80batch_get_rp(regs, p, l);
+                const uint32_t res = (uint32_t)acc + v;
+                WZ[l] = acc + 1;
+                _z80batch_set16(regs, Z80BATCH_H, Z80BATCH_L, l, (uint16_t)res);
+                F[l] = (F[l] & (Z80_SF|Z80_ZF|Z80_VF)) | (((acc ^ res ^ v) >> 8) & Z80_HF) |
+                       ((res >> 16) & Z80_CF) | ((res >> 8) & (Z80_YF|Z80_XF));
+            })
+            break;
+        case 0x10: // DJNZ d
+            _Z80BATCH_LANES({
+                const int8_t d = (int8_t)mem_rd(b->mem[l], PC[l]++);
+                if (--regs->r8[Z80BATCH_B][l] != 0) {
+                    PC[l] += d;
+                    WZ[l] = PC[l];
+                    ticks[l] += 5;
+                    left[l] -= 5;
+                }
+            })
+            break;
+        case 0x18: // JR d
+            _Z80BATCH_LANES({
+                const int8_t d = (int8_t)mem_rd(b->mem[l], PC[l]++);
+                PC[l] += d;
+                WZ[l] = PC[l];
+            })
+            break;
+        case 0x20: case 0x28: case 0x30: case 0x38: // JR cc,d
+            _Z80BATCH_LANES({
+                const int8_t d = (int8_t)mem_rd(b->mem[l], PC[l]++);
+                if (_z80batch_cc(F[l], y - 4)) {
+                    PC[l] += d;
+                    WZ[l] = PC[l];
+                    ticks[l] += 5;
+                    left[l] -= 5;
+                }
+            })
+            break;
+        case 0x22: // LD (nn),HL
+            _Z80BATCH_LANES({
+                const uint16_t addr = _z80batch_imm16(b, l);
+                mem_wr(b->mem[l], addr, regs->r8[Z80BATCH_L][l]);
+                mem_wr(b->mem[l], (uint16_t)(addr + 1), regs->r8[Z80BATCH_H][l]);
+                WZ[l] = addr + 1;
+            })
+            break;
+        case 0x2A: // LD HL,(nn)
+            _Z80BATCH_LANES({
+                const uint16_t addr = _z80batch_imm16(b, l);
+                _z80batch_set16(regs, Z80BATCH_H, Z80BATCH_L, l, _z80batch_rd16(b, l, addr));
+                WZ[l] = addr + 1;
+            })
+            break;
+        case 0x32: // LD (nn),A
+            _Z80BATCH_LANES({
+                const uint16_t addr = _z80batch_imm16(b, l);
+                mem_wr(b->mem[l], addr, A[l]);
+                WZ[l] = (uint16_t)((A[l] << 8) | ((addr + 1) & 0xFF));
+            })
+            break;
+        case 0x3A: // LD A,(nn)
+            _Z80BATCH_LANES({
+                const uint16_t addr = _z80batch_imm16(b, l);
+                A[l] = mem_rd(b->mem[l], addr);
+                WZ[l] = addr + 1;
+            })
+            break;
+        case 0xC0: case 0xC8: case 0xD0: case 0xD8: case 0xE0: case 0xE8: case 0xF0: case 0xF8: // RET cc
+            _Z80BATCH_LANES({
+                if (_z80batch_cc(F[l], y)) {
+                    WZ[l] = _z80batch_pop(b, l);
+                    PC[l] = WZ[l];
+                    ticks[l] += 6;
+                    left[l] -= 6;
+                }
+            })
+            break;
+        case 0xC1: case 0xD1: case 0xE1: // POP rr
+            _Z80BATCH_LANES(_z80batch_set16(regs, 2*p, 2*p+1, l, _z80batch_pop(b, l));)
+            break;
+        case 0xF1: // POP AF
+            _Z80BATCH_LANES(_z80batch_set16(regs, Z80BATCH_A, Z80BATCH_F, l, _z80batch_pop(b, l));)
+            break;
+        case 0xC2: case 0xCA: case 0xD2: case 0xDA: case 0xE2: case 0xEA: case 0xF2: case 0xFA: // JP cc,nn
+            _Z80BATCH_LANES({
+                WZ[l] = _z80batch_imm16(b, l);
+                if (_z80batch_cc(F[l], y)) {
+                    PC[l] = WZ[l];
+                }
+            })
+            break;
+        case 0xC3: // JP nn
+            _Z80BATCH_LANES({
+                WZ[l] = _z80batch_imm16(b, l);
+                PC[l] = WZ[l];
+            })
+            break;
+        case 0xC4: case 0xCC: case 0xD4: case 0xDC: case 0xE4: case 0xEC: case 0xF4: case 0xFC: // CALL cc,nn
+            _Z80BATCH_LANES({
+                WZ[l] = _z80batch_imm16(b, l);
+                if (_z80batch_cc(F[l], y)) {
+                    _z80batch_push(b, l, PC[l]);
+                    PC[l] = WZ[l];
+                    ticks[l] += 7;
+                    left[l] -= 7;
+                }
+            })
+            break;
+        case 0xCD: // CALL nn
+            _Z80BATCH_LANES({
+                WZ[l] = _z80batch_imm16(b, l);
+                _z80batch_push(b, l, PC[l]);
+                PC[l] = WZ[l];
+            })
+            break;
+        case 0xC5: case 0xD5: case 0xE5: // PUSH rr
+            _Z80BATCH_LANES(_z80batch_push(b, l, _z80batch_get16(regs, 2*p, 2*p+1, l));)
+            break;
+        case 0xF5: // PUSH AF
+            _Z80BATCH_LANES(_z80batch_push(b, l, _z80batch_get16(regs, Z80BATCH_A, Z80BATCH_F, l));)
+            break;
+        case 0xC7: case 0xCF: case 0xD7: case 0xDF: case 0xE7: case 0xEF: case 0xF7: case 0xFF: // RST n
+            _Z80BATCH_LANES({
+                _z80batch_push(b, l, PC[l]);
+                WZ[l] = (uint16_t)(op & 0x38);
+                PC[l] = WZ[l];
+            })
+            break;
+        case 0xC9: // RET
+            _Z80BATCH_LANES({
+                WZ[l] = _z80batch_pop(b, l);
+                PC[l] = WZ[l];
+            })
+            break;
+        case 0xE9: // JP (HL)
+            _Z80BATCH_LANES(PC[l] = _z80batch_get16(regs, Z80BATCH_H, Z80BATCH_L, l);)
+            break;
+        case 0xEB: // EX DE,HL
+            _Z80BATCH_LANES({
+                const uint16_t de = _z80batch_get16(regs, Z80BATCH_D, Z80BATCH_E, l);
+                _z80batch_set16(regs, Z80BATCH_D, Z80BATCH_E, l, _z80batch_get16(regs, Z80BATCH_H, Z80BATCH_L, l));
+                _z80batch_set16(regs, Z80BATCH_H, Z80BATCH_L, l, de);
+            })
+            break;
+        case 0xF9: // LD SP,HL
+            _Z80BATCH_LANES(regs->sp[l] = _z80batch_get16(regs, Z80BATCH_H, Z80BATCH_L, l);)
+            break;
+        default:
+            CHIPS_ASSERT(false);
+            break;
+    }
+
+    // 8-bit ALU instructions, same as the non-lazy flag helpers in z80.h
+    if (val) {
+        switch (y) {
+            case 0: // ADD
+                _Z80BATCH_LANES({
+                    const uint32_t res = (uint32_t)A[l] + val[l];
+                    F[l] = _z80_add_flags(A[l], val[l], res);
+                    A[l] = (uint8_t)res;
+                })
+                break;
+            case 1: // ADC
+                _Z80BATCH_LANES({
+                    const uint32_t res = (uint32_t)A[l] + val[l] + (F[l] & Z80_CF);
+                    F[l] = _z80_add_flags(A[l], val[l], res);
+                    A[l] = (uint8_t)res;
+                })
+                break;
+            case 2: // SUB
+                _Z80BATCH_LANES({
+                    const uint32_t res = (uint32_t)((int)A[l] - (int)val[l]);
+                    F[l] = _z80_sub_flags(A[l], val[l], res);
+                    A[l] = (uint8_t)res;
+                })
+                break;
+            case 3: // SBC
+                _Z80BATCH_LANES({
+                    const uint32_t res = (uint32_t)((int)A[l] - (int)val[l] - (F[l] & Z80_CF));
+                    F[l] = _z80_sub_flags(A[l], val[l], res);
+                    A[l] = (uint8_t)res;
+                })
+                break;
+            case 4: // AND
+                _Z80BATCH_LANES({
+                    A[l] &= val[l];
+                    F[l] = _z80_szp_flags[A[l]] | Z80_HF;
+                })
+                break;
+            case 5: // XOR
+                _Z80BATCH_LANES({
+                    A[l] ^= val[l];
+                    F[l] = _z80_szp_flags[A[l]];
+                })
+                break;
+            case 6: // OR
+                _Z80BATCH_LANES({
+                    A[l] |= val[l];
+                    F[l] = _z80_szp_flags[A[l]];
+                })
+                break;
+            default: // CP
+                _Z80BATCH_LANES({
+                    const uint32_t res = (uint32_t)((int)A[l] - (int)val[l]);
+                    F[l] = _z80_cp_flags(A[l], val[l], res);
+                })
+                break;
+        }
+    }
+
+    // refresh cycle, tick counting and overlapped opcode fetch of the next instruction
+    const uint32_t op_ticks = _z80batch_op_ticks[op];
+    uint8_t* const R = regs->r;
+    _Z80BATCH_LANES({
+        R[l] = (R[l] & 0x80) | ((R[l] + 1) & 0x7F);
+        ticks[l] += op_ticks;
+        left[l] -= op_ticks;
+        b->stepped[l] = true;
+    })
+    uint8_t* const OP = regs->op;
+    _Z80BATCH_LANES(OP[l] = mem_rd(b->mem[l], PC[l]++);)
+    b->num_lockstep_ops += (uint64_t)num;
+    if (dense) {
+        b->num_dense_ops += (uint64_t)num;
+    }
+}
+
+#undef _Z80BATCH_LANES
+
+void z80batch_exec(z80batch_t* batch, uint32_t num_ticks) {
+    CHIPS_ASSERT(batch && (num_ticks > 0));
+    const int num_lanes = batch->num_lanes;
+    for (int l = 0; l < num_lanes; l++) {
+        batch->left[l] = num_ticks;
+    }
+    // lanes which execute their next instruction in lockstep, grouped by opcode
+    uint8_t lanes[Z80BATCH_MAX_LANES];
+    uint8_t cand[Z80BATCH_MAX_LANES];
+    uint16_t group_num[256];
+    uint16_t group_pos[256];
+    uint8_t groups[256];
+    bool running = true;
+    while (running) {
+        running = false;
+        int num_cand = 0;
+        for (int l = 0; l < num_lanes; l++) {
+            if (batch->left[l] == 0) {
+                continue;
+            }
+            running = true;
+            if (!batch->lockstep[l] && _z80batch_can_enter(batch, l)) {
+                _z80batch_enter(batch, l);
+            }
+            if (batch->lockstep[l]) {
+                if (_z80batch_can_step(batch, l)) {
+                    cand[num_cand++] = (uint8_t)l;
+                    group_num[batch->regs.op[l]] = 0;
+                }
+                else {
+                    _z80batch_leave(batch, l);
+                }
+            }
+        }
+        if (num_cand > 0) {
+            // sort the candidates by opcode, keeping the lane order within a group
+            int num_groups = 0;
+            for (int i = 0; i < num_cand; i++) {
+                const uint8_t op = batch->regs.op[cand[i]];
+                if (group_num[op]++ == 0) {
+                    groups[num_groups++] = op;
+                }
+            }
+            int pos = 0;
+            for (int g = 0; g < num_groups; g++) {
+                group_pos[groups[g]] = (uint16_t)pos;
+                pos += group_num[groups[g]];
+            }
+            for (int i = 0; i < num_cand; i++) {
+                lanes[group_pos[batch->regs.op[cand[i]]]++] = cand[i];
+            }
+            pos = 0;
+            for (int g = 0; g < num_groups; g++) {
+                const int num = group_num[groups[g]];
+                _z80batch_step(batch, groups[g], &lanes[pos], num);
+                pos += num;
+            }
+        }
+        // all other lanes execute their next instruction on the z80_t
+        for (int l = 0; l < num_lanes; l++) {
+            if (!batch->lockstep[l] && (batch->left[l] > 0)) {
+                _z80batch_scalar_step(batch, l);
+            }
+        }
+    }
+    for (int l = 0; l < num_lanes; l++) {
+        if (batch->lockstep[l]) {
+            _z80batch_leave(batch, l);
+        }
+    }
+}
+#endif // CHIPS_IMPL
@@ -94,6 +94,36 @@
         - **Z80CTC_INT**: if the CTC wants to request an interrupt
         - **Z80CTC_ZCTO0..ZCTO2**: when the channels 0..2 are in counter mode and the countdown reaches 0
         - **Z80CTC_IEIO**: enable or disable interrupts for daisychain downstream chips
+
+    ~~~C
+    uint64_t z80ctc_tick_sched(z80ctc_t* ctc, uint64_t pins)
+    ~~~
+        A drop-in replacement for z80ctc_tick() with identical results, which
+        only calls into the chip emulation when something happens (see
+        'Idle Ticks').
+
+    ~~~C
+    void z80ctc_sync(z80ctc_t* ctc)
+    ~~~
+        Applies the ticks skipped by z80ctc_tick_sched() to the channel
+        counters. Call this before reading the prescaler or down counter
+        values from the outside (for instance in debugging UIs).
+
+    ## Idle Ticks
+
+    Most of the time the CTC channels are counting down and the interrupt
+    daisy chain is in a steady state, the CTC state only changes on IO
+    requests, RETI, CLKTRG pin changes and when a timer channel reaches
+    zero.
+
+    After each full tick, z80ctc_tick_sched() computes the number of ticks
+    until the next timer channel reaches zero. As long as the CLKTRG and
+    IEIO input pins don't change and there are no IO requests and no RETI,
+    those ticks only return the precomputed IEIO and ZCTO output pins
+    without touching the channel state. The skipped ticks are applied to
+    the prescalers and down counters in one go on the next full tick, so
+    while the CTC is idle, the channel counters in z80ctc_t lag behind by
+    z80ctc_t.skipped_ticks until z80ctc_sync() is called.
 #*/
 /*
     zlib/libpng license
@@ -212,8 +242,16 @@ typedef struct {
 typedef struct {
     z80ctc_channel_t chn[Z80CTC_NUM_CHANNELS];
     uint64_t pins;
+    uint32_t idle_ticks;        // number of upcoming ticks which don't change the CTC state
+    uint32_t skipped_ticks;     // idle ticks not yet applied to the channel counters
+    uint64_t idle_pins;         // input pin state the idle ticks have been computed for
+    uint64_t idle_out_pins;     // output pin state during idle ticks
 } z80ctc_t;
 
+// input and output pins which are considered by idle ticks
+#define Z80CTC_IDLE_INPUT_PINS (Z80CTC_IORQ|Z80CTC_RETI|Z80CTC_IEIO|Z80CTC_CLKTRG0|Z80CTC_CLKTRG1|Z80CTC_CLKTRG2|Z80CTC_CLKTRG3)
+#define Z80CTC_IDLE_OUTPUT_PINS (Z80CTC_IEIO|Z80CTC_ZCTO0|Z80CTC_ZCTO1|Z80CTC_ZCTO2)
+
 // extract 8-bit data bus from 64-bit pins
 #define Z80CTC_GET_DATA(p) ((uint8_t)(((p)>>16)&0xFF))
 // merge 8-bit data bus value into 64-bit pins
@@ -225,6 +263,20 @@ void z80ctc_init(z80ctc_t* ctc);
 void z80ctc_reset(z80ctc_t* ctc);
 // tick the CTC instance
 uint64_t z80ctc_tick(z80ctc_t* ctc, uint64_t pins);
+// same as z80ctc_tick() but also computes the number of upcoming idle ticks
+uint64_t z80ctc_tick_full(z80ctc_t* ctc, uint64_t pins);
+// apply the ticks skipped by z80ctc_tick_sched() to the channel counters
+void z80ctc_sync(z80ctc_t* ctc);
+
+// tick the CTC instance, only calls into the chip emulation if the CTC isn't idle
+static inline uint64_t z80ctc_tick_sched(z80ctc_t* ctc, uint64_t pins) {
+    if ((ctc->idle_ticks > 0) && ((pins & Z80CTC_IDLE_INPUT_PINS) == ctc->idle_pins)) {
+        ctc->idle_ticks--;
+        ctc->skipped_ticks++;
+        return (pins & ~Z80CTC_IDLE_OUTPUT_PINS) | ctc->idle_out_pins;
+    }
+    return z80ctc_tick_full(ctc, pins);
+}
 
 #ifdef __cplusplus
 } // extern "C"
@@ -267,6 +319,8 @@ void z80ctc_reset(z80ctc_t* ctc) {
         chn->prescaler_mask = 0x0F;
         chn->int_state = 0;
     }
+    ctc->idle_ticks = 0;
+    ctc->skipped_ticks = 0;
 }
 
 /*
@@ -478,4 +532,86 @@ uint64_t z80ctc_tick(z80ctc_t* ctc, uint64_t pins) {
     return pins;
 }
 
+// true if a channel is counting down in timer mode
+static inline bool _z80ctc_timer_running(const z80ctc_channel_t* chn) {
+    return !chn->waiting_for_trigger && ((chn->control & (Z80CTC_CTRL_MODE|Z80CTC_CTRL_RESET|Z80CTC_CTRL_CONST_FOLLOWS)) == Z80CTC_CTRL_MODE_TIMER);
+}
+
+// number of ticks until the prescaler of a running timer channel ticks the down counter
+static inline uint32_t _z80ctc_first_prescaler_tick(const z80ctc_channel_t* chn) {
+    const uint32_t pre = chn->prescaler & chn->prescaler_mask;
+    return (0 != pre) ? pre : ((uint32_t)chn->prescaler_mask + 1);
+}
+
+// apply the skipped idle ticks to the timer channels
+static void _z80ctc_apply_skipped_ticks(z80ctc_t* ctc) {
+    const uint32_t num_ticks = ctc->skipped_ticks;
+    if (0 == num_ticks) {
+        return;
+    }
+    ctc->skipped_ticks = 0;
+    for (int chn_id = 0; chn_id < Z80CTC_NUM_CHANNELS; chn_id++) {
+        z80ctc_channel_t* chn = &ctc->chn[chn_id];
+        if (_z80ctc_timer_running(chn)) {
+            // the idle ticks never include the tick where the down counter reaches zero
+            const uint32_t first = _z80ctc_first_prescaler_tick(chn);
+            if (num_ticks >= first) {
+                chn->down_counter -= (uint8_t)(1 + (num_ticks - first) / ((uint32_t)chn->prescaler_mask + 1));
+            }
+            chn->prescaler -= (uint8_t)num_ticks;
+        }
+    }
+}
+
+/* Compute the number of upcoming idle ticks for the given input pins.
+
+   Without IO requests and RETI, and with unchanged CLKTRG and IEIO pins,
+   the only state change is the countdown of the timer channels, and the
+   daisy chain only passes through or blocks IEIO. This is the case
+   until a timer channel reaches zero, or while an interrupt request
+   is pending.
+*/
+static uint32_t _z80ctc_idle_ticks(const z80ctc_t* ctc, uint64_t pins) {
+    if (pins & (Z80CTC_IORQ|Z80CTC_RETI)) {
+        return 0;
+    }
+    uint32_t num_ticks = 0xFFFFFFFF;
+    for (int chn_id = 0; chn_id < Z80CTC_NUM_CHANNELS; chn_id++) {
+        const z80ctc_channel_t* chn = &ctc->chn[chn_id];
+        if (chn->int_state & Z80CTC_INT_NEEDED) {
+            return 0;
+        }
+        if (_z80ctc_timer_running(chn)) {
+            const uint32_t period = (uint32_t)chn->prescaler_mask + 1;
+            const uint32_t count = (0 != chn->down_counter) ? chn->down_counter : 256;
+            const uint32_t zero_tick = _z80ctc_first_prescaler_tick(chn) + (count - 1) * period;
+            if ((zero_tick - 1) < num_ticks) {
+                num_ticks = zero_tick - 1;
+            }
+        }
+    }
+    return num_ticks;
+}
+
+void z80ctc_sync(z80ctc_t* ctc) {
+    CHIPS_ASSERT(ctc);
+    _z80ctc_apply_skipped_ticks(ctc);
+}
+
+uint64_t z80ctc_tick_full(z80ctc_t* ctc, uint64_t pins) {
+    _z80ctc_apply_skipped_ticks(ctc);
+    const uint64_t in_pins = pins;
+    pins = z80ctc_tick(ctc, pins);
+    ctc->idle_ticks = _z80ctc_idle_ticks(ctc, in_pins);
+    ctc->idle_pins = in_pins & Z80CTC_IDLE_INPUT_PINS;
+    // during idle ticks, the ZCTO pins are inactive and IEIO is blocked by any active interrupt
+    ctc->idle_out_pins = in_pins & Z80CTC_IEIO;
+    for (int chn_id = 0; chn_id < Z80CTC_NUM_CHANNELS; chn_id++) {
+        if (0 != ctc->chn[chn_id].int_state) {
+            ctc->idle_out_pins = 0;
+        }
+    }
+    return pins;
+}
+
 #endif /* CHIPS_IMPL */
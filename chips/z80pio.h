@@ -88,6 +88,22 @@
         - **Z80PIO_PA0..PA7, Z80PIO_PB0..PB7**: may be modified depending on the
           current PIO configuration
         - **Z80PIO_IEIO**: enable or disable interrupts for daisychain downstream chips
+
+    ~~~C
+    uint64_t z80pio_tick_sched(z80pio_t* pio, uint64_t pins)
+    ~~~
+        A drop-in replacement for z80pio_tick() with identical results, which
+        only calls into the chip emulation when something happens (see
+        'Idle Ticks').
+
+    ## Idle Ticks
+
+    The PIO state only changes on IO requests, RETI, port input changes
+    and while an interrupt request is pending. After each full tick,
+    z80pio_tick_sched() checks whether the PIO is in such a steady state,
+    and if yes, the following ticks only return the precomputed port
+    output and IEIO pins, until one of the IORQ, RETI, IEIO or port
+    input pins changes.
 #*/
 /*
     ## zlib/libpng license
@@ -278,8 +294,15 @@ typedef struct {
     z80pio_port_t port[Z80PIO_NUM_PORTS];
     bool reset_active;  /* currently in reset state? (until a control word is received) */
     uint64_t pins;      /* last pin state (useful for debugging) */
+    bool idle;              /* upcoming ticks don't change the PIO state */
+    uint64_t idle_pins;     /* input pin state the idle state has been computed for */
+    uint64_t idle_out_pins; /* output pin state while idle */
 } z80pio_t;
 
+/* input and output pins which are considered by idle ticks */
+#define Z80PIO_IDLE_INPUT_PINS (Z80PIO_IORQ|Z80PIO_RETI|Z80PIO_IEIO|0xFFFF000000000000ULL)
+#define Z80PIO_IDLE_OUTPUT_PINS (Z80PIO_IEIO|0xFFFF000000000000ULL)
+
 /* extract 8-bit data bus from 64-bit pins */
 #define Z80PIO_GET_DATA(p) ((uint8_t)(((p)>>16)&0xFF))
 /* merge 8-bit data bus value into 64-bit pins */
@@ -303,6 +326,16 @@ void z80pio_init(z80pio_t* pio);
 void z80pio_reset(z80pio_t* pio);
 /* tick the Z80 PIO instance */
 uint64_t z80pio_tick(z80pio_t* pio, uint64_t pins);
+/* same as z80pio_tick() but also checks whether the PIO is idle */
+uint64_t z80pio_tick_full(z80pio_t* pio, uint64_t pins);
+
+/* tick the Z80 PIO instance, only calls into the chip emulation if the PIO isn't idle */
+static inline uint64_t z80pio_tick_sched(z80pio_t* pio, uint64_t pins) {
+    if (pio->idle && ((pins & Z80PIO_IDLE_INPUT_PINS) == pio->idle_pins)) {
+        return (pins & ~Z80PIO_IDLE_OUTPUT_PINS) | pio->idle_out_pins;
+    }
+    return z80pio_tick_full(pio, pins);
+}
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -345,6 +378,7 @@ void z80pio_reset(z80pio_t* pio) {
         pio->port[p].int_state = 0;
     }
     pio->reset_active = true;
+    pio->idle = false;
 }
 
 /* new control word received from CPU */
@@ -654,4 +688,29 @@ uint64_t z80pio_tick(z80pio_t* pio, uint64_t pins) {
     return pins;
 }
 
+/*
+    Without IO requests and RETI, and with unchanged port inputs, a tick
+    only changes state when an interrupt request is pending (the port
+    input conditions have already been evaluated for the current inputs),
+    the port outputs are constant and the daisy chain only passes through
+    or blocks IEIO.
+*/
+uint64_t z80pio_tick_full(z80pio_t* pio, uint64_t pins) {
+    const uint64_t in_pins = pins;
+    pins = z80pio_tick(pio, pins);
+    pio->idle = 0 == (in_pins & (Z80PIO_IORQ|Z80PIO_RETI));
+    uint64_t ieio = in_pins & Z80PIO_IEIO;
+    for (int i = 0; i < Z80PIO_NUM_PORTS; i++) {
+        if (pio->port[i].int_state & Z80PIO_INT_NEEDED) {
+            pio->idle = false;
+        }
+        if (0 != pio->port[i].int_state) {
+            ieio = 0;
+        }
+    }
+    pio->idle_pins = in_pins & Z80PIO_IDLE_INPUT_PINS;
+    pio->idle_out_pins = _z80pio_set_port_output_pins(pio, 0) | ieio;
+    return pins;
+}
+
 #endif /* CHIPS_IMPL */
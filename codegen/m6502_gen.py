@@ -138,9 +138,9 @@ def write_op(op):
     l('    /* {} */'.format(op.cmt if op.cmt else '???'))
     for t in range(0, 8):
         if t < op.i:
-            l('        case (0x{:02X}<<3)|{}: {}break;'.format(op.code, t, op.src[t]))
+            l('        _M6502_CASE(0x{:02X},{}): {}break;'.format(op.code, t, op.src[t]))
         else:
-            l('        case (0x{:02X}<<3)|{}: assert(false);break;'.format(op.code, t))
+            l('        _M6502_CASE(0x{:02X},{}): assert(false);break;'.format(op.code, t))
 
 #-------------------------------------------------------------------------------
 def cmt(o,cmd):
@@ -846,10 +846,23 @@ def enc_op(op):
         o.t('_FETCH();')
     return o
 
+#-------------------------------------------------------------------------------
+#   the label table for the computed-goto dispatch (see M6502_COMPUTED_GOTO)
+#
+def step_table():
+    res = ''
+    for op in range(0, 256):
+        res += '        '
+        for t in range(0, 8):
+            res += '&&_m6502_step_0x{:02X}_{},'.format(op, t)
+        res += '\n'
+    return res
+
 def write_result():
     with open(INOUT_PATH, 'r') as f:
         lines = f.read().splitlines()
         lines = templ.replace(lines, 'decoder', out_lines)
+        lines = templ.replace(lines, 'step_table', step_table())
     out_str = '\n'.join(lines) + '\n'
     with open(INOUT_PATH, 'w') as f:
         f.write(out_str)
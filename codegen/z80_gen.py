@@ -1,4 +1,4 @@
-import yaml, copy
+import yaml, copy, re
 import templ
 
 DESC_PATH  = 'z80_desc.yml'
@@ -261,6 +261,27 @@ def expand_optable():
     op_index += 1; stampout_op('', -1, op_index, find_opdesc('int_im2'))
     op_index += 1; stampout_op('', -1, op_index, find_opdesc('nmi'))
 
+# helper functions which are aware of lazy flag evaluation (see Z80_LAZY_FLAGS),
+# or which don't touch the flags at all, any other flag access in an op
+# requires the flags to be materialized when the op starts
+lazy_flags_helpers = [
+    '_z80_add8', '_z80_adc8', '_z80_sub8', '_z80_sbc8', '_z80_and8', '_z80_xor8', '_z80_or8', '_z80_cp8',
+    '_z80_neg8', '_z80_inc8', '_z80_dec8', '_z80_ex_de_hl', '_z80_exx', '_z80_halt', '_z80_ddfdcb_addr',
+    '_z80_fetch', '_z80_fetch_cb', '_z80_fetch_dd', '_z80_fetch_ed', '_z80_fetch_fd', '_z80_refresh', '_z80_get_db',
+]
+
+def needs_flag_sync(op):
+    for mcycle in op.mcycles:
+        for val in mcycle.items.values():
+            if type(val) != str:
+                continue
+            if ('cpu->f' in val) or ('cpu->af' in val):
+                return True
+            for helper in re.findall(r'_z80_[a-z0-9_]+', val):
+                if helper not in lazy_flags_helpers:
+                    return True
+    return False
+
 # generate code for one op
 def gen_decoder():
     indent = 2
@@ -280,8 +301,16 @@ def gen_decoder():
         nonlocal out_extra_lines
         out_extra_lines += tab() + s + '\n'
 
+    def sync_flags(action):
+        # materialize lazily evaluated flags in the first step of ops which access the flags
+        if op_step == 0 and op_sync_flags:
+            return '_sync_flags();' + action
+        else:
+            return action
+
     def add(action):
         nonlocal cur_step, cur_extra_step, op_step, op
+        action = sync_flags(action)
         # NOTE: special ops (interrupt handling etc) are entirely written into the 'extra' decoder block
         if op_step == 0 and not flag(op, 'special'):
             next_step = cur_extra_step
@@ -289,39 +318,43 @@ def gen_decoder():
             if flag(op, 'redundant'):
                 next_step = OPS[op.multiple_first_op_index].extra_step_index
             action = action.replace("$NEXTSTEP", f'{next_step}')
-            l(f'case {cur_step:4}: {action}_goto({next_step}); // {op.name} ({op_step})')
+            l(f'_Z80_CASE({cur_step:4}): {action}_goto({next_step}); // {op.name} ({op_step})')
             cur_step += 1
         else:
             # do not write a payload for redundant ops
             if not flag(op, 'redundant'):
                 next_step = cur_extra_step + 1
                 action = action.replace("$NEXTSTEP", f'{next_step}')
-                lx(f'case {cur_extra_step:4}: {action}_goto({next_step}); // {op.name} ({op_step})')
+                lx(f'_Z80_CASE({cur_extra_step:4}): {action}_goto({next_step}); // {op.name} ({op_step})')
                 cur_extra_step += 1
         op_step += 1
 
     def add_fetch(action):
         nonlocal cur_step, cur_extra_step, op_step, op
+        action = sync_flags(action)
         if op_step == 0 and not flag(op, 'special'):
-            l(f'case {cur_step:4}: {action}_fetch(); // {op.name} ({op_step})')
+            l(f'_Z80_CASE({cur_step:4}): {action}_fetch(); // {op.name} ({op_step})')
             cur_step += 1
         else:
-            lx(f'case {cur_extra_step:4}: {action}_fetch(); // {op.name} ({op_step})')
+            lx(f'_Z80_CASE({cur_extra_step:4}): {action}_fetch(); // {op.name} ({op_step})')
             cur_extra_step += 1
         op_step += 1
 
     def add_stepto(action):
         nonlocal cur_step, cur_extra_step, op_step, op
+        action = sync_flags(action)
         if op_step == 0:
-            l(f'case {cur_step:4}: {action}goto step_to; // {op.name} ({op_step})')
+            l(f'_Z80_CASE({cur_step:4}): {action}goto step_to; // {op.name} ({op_step})')
             cur_step += 1
         else:
-            lx(f'case {cur_extra_step:4}: {action}goto step_to; // {op.name} ({op_step})')
+            lx(f'_Z80_CASE({cur_extra_step:4}): {action}goto step_to; // {op.name} ({op_step})')
             cur_extra_step += 1
         op_step += 1
 
     for op in OPS:
         op_step = 0
+        # redundant ops continue in the payload of the first op
+        op_sync_flags = needs_flag_sync(op) or (flag(op, 'redundant') and needs_flag_sync(OPS[op.multiple_first_op_index]))
         op.step_index = cur_step
         op.extra_step_index = cur_extra_step
 
@@ -382,33 +415,35 @@ def gen_decoder():
                     add_fetch(f'{action}')
     return { 'out_lines': out_lines + out_extra_lines, 'max_step': cur_extra_step }
 
+# manually written decoder steps which follow the generated steps
+manual_steps = [
+    "DDFD_M1_T2",
+    "DDFD_M1_T3",
+    "DDFD_M1_T4",
+    "DDFD_D_T1",
+    "DDFD_D_T2",
+    "DDFD_D_T3",
+    "DDFD_D_T4",
+    "DDFD_D_T5",
+    "DDFD_D_T6",
+    "DDFD_D_T7",
+    "DDFD_D_T8",
+    "DDFD_LDHLN_WR_T1",
+    "DDFD_LDHLN_WR_T2",
+    "DDFD_LDHLN_WR_T3",
+    "DDFD_LDHLN_OVERLAPPED",
+    "CB_M1_T2",
+    "CB_M1_T3",
+    "CB_M1_T4",
+    "ED_M1_T2",
+    "ED_M1_T3",
+    "ED_M1_T4",
+    "M1_T2",
+    "M1_T3",
+    "M1_T4",
+]
+
 def extra_step_defines_string(max_step):
-    manual_steps = [
-        "DDFD_M1_T2",
-        "DDFD_M1_T3",
-        "DDFD_M1_T4",
-        "DDFD_D_T1",
-        "DDFD_D_T2",
-        "DDFD_D_T3",
-        "DDFD_D_T4",
-        "DDFD_D_T5",
-        "DDFD_D_T6",
-        "DDFD_D_T7",
-        "DDFD_D_T8",
-        "DDFD_LDHLN_WR_T1",
-        "DDFD_LDHLN_WR_T2",
-        "DDFD_LDHLN_WR_T3",
-        "DDFD_LDHLN_OVERLAPPED",
-        "CB_M1_T2",
-        "CB_M1_T3",
-        "CB_M1_T4",
-        "ED_M1_T2",
-        "ED_M1_T3",
-        "ED_M1_T4",
-        "M1_T2",
-        "M1_T3",
-        "M1_T4",
-    ]
     res = ''
     step_index = max_step
     for step_name in manual_steps:
@@ -442,6 +477,18 @@ def indirect_table_string():
             res += '\n'
     return res
 
+# the label table for the computed-goto dispatch (see Z80_COMPUTED_GOTO)
+def step_table_string(max_step):
+    res = ''
+    num_steps = max_step + len(manual_steps)
+    for i in range(0, num_steps):
+        if i % 8 == 0:
+            res += '        '
+        res += f'&&_z80_step_{i},'
+        if (i % 8 == 7) or (i == num_steps - 1):
+            res += '\n'
+    return res
+
 def write_result(decoder_output):
     out_lines = decoder_output['out_lines']
     max_step = decoder_output['max_step']
@@ -450,6 +497,7 @@ def write_result(decoder_output):
         lines = templ.replace(lines, 'decoder', out_lines)
         lines = templ.replace(lines, 'extra_step_defines', extra_step_defines_string(max_step))
         lines = templ.replace(lines, 'indirect_table', indirect_table_string())
+        lines = templ.replace(lines, 'step_table', step_table_string(max_step))
     out_str = '\n'.join(lines) + '\n'
     with open(INOUT_PATH, 'w') as f:
         f.write(out_str)
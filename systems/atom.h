@@ -18,22 +18,91 @@
     ~~~
         your own assert macro (default: assert(c))
 
+    ~~~C
+    ATOM_BORROWED_TAPE
+    ~~~
+        if defined, atom_insert_tape() doesn't copy the tape data into
+        atom_t but keeps a pointer to it, the tape data must then remain
+        valid and unchanged until the tape is removed (this allows sharing
+        one, possibly memory-mapped, tape image between many instances),
+        must be the same for all files which include atom.h
+
+    ~~~C
+    ATOM_NO_FRAMEBUFFER
+    ~~~
+        if defined, atom_t doesn't contain a framebuffer and video decoding
+        is skipped (the MC6847 only generates
+        the sync signals), this is useful for headless instances (e.g.
+        automated tests or servers) which only need the CPU and I/O side of
+        the emulation, the framebuffer pointer in atom_display_info() is
+        then null, must be the same for all files which include atom.h
+
     You need to include the following headers before including atom.h:
 
     - chips/chips_common.h
+    - chips/mem.h
     - chips/m6502.h
     - chips/mc6847.h
     - chips/i8255.h
     - chips/m6522.h
+    - chips/blip.h (only with CHIPS_BLIP)
     - chips/beeper.h
-    - chips/mem.h
     - chips/kbd.h
     - chips/clk.h
 
+    If chips/mem.h is included before chips/m6502.h, instructions which
+    don't touch the IO area run through m6502_exec_op_fast() (see
+    'Instruction-Stepped Execution' below), otherwise every CPU tick
+    goes through m6502_tick().
+
     ## The Acorn Atom
 
     FIXME!
 
+    ## Text Input
+
+    atom_input_text() feeds a text into the keyboard input of the Atom MOS
+    instead of simulating key presses (see 'Text Input' in chips_common.h).
+    While text is pending, the default OSRDCH handler (at 0xFE94) is trapped
+    and returns the next character immediately, so the text is entered as
+    fast as BASIC (or a program reading the keyboard through OSRDCH)
+    consumes it. Lower-case ASCII letters are converted to upper case. The
+    text is not copied and must remain valid until atom_input_text_pending()
+    returns false.
+
+    ## CPU Overclocking
+
+    For workloads which don't depend on real-hardware speed, the CPU can run
+    at a multiple of its nominal clock frequency while the VDG, PPI, VIA and
+    audio keep their nominal timing, so that the frame rate, timers and
+    sound pitch don't change. Set atom_desc_t.overclock to the number of CPU
+    ticks per device tick (default is 1, no overclocking), or change the
+    factor at runtime with atom_set_overclock().
+
+    In overclock mode, only every Nth CPU tick also ticks the other chips,
+    all other ticks only perform the CPU memory access and the OSLOAD and
+    OSRDCH traps. Ticks which access the memory-mapped IO area at 0xB000
+    or have the RDY pin set always tick the other chips, so that no IO
+    access or wait state can be missed, this means that IO-heavy code runs
+    a bit slower than the overclock factor suggests.
+
+    atom_exec() takes the overclocked CPU frequency into account (so it runs
+    N times as many CPU ticks for the same micro-seconds), atom_exec_frame()
+    still runs until the VDG activates the field sync.
+
+    ## Instruction-Stepped Execution
+
+    When M6502_HAS_EXEC is defined (see m6502.h), atom_exec() and
+    atom_exec_frame() run complete instructions with m6502_exec_op_fast()
+    and tick the other chips afterwards for the instruction's ticks. This
+    only happens without a debug callback, when the VIA is idle for the
+    whole instruction (so that the IRQ pin can't change), and when the VDG
+    doesn't decode a scanline or activate the field sync in the next
+    M6502_EXEC_OP_MAX_TICKS ticks. Instructions which touch the IO area at
+    0xB000 fall back to m6502_tick(). Since the PPI port outputs can't
+    change without an IO access, the PPI is only ticked on the last tick
+    of a fast-path instruction.
+
     ## TODO
 
     - handle shift key (some games use this as jump button)
@@ -67,7 +136,7 @@ extern "C" {
 #endif
 
 // bump snapshot version when memory layout of atom_t changes
-#define ATOM_SNAPSHOT_VERSION (1)
+#define ATOM_SNAPSHOT_VERSION (10)
 
 #define ATOM_FREQUENCY (1000000)
 #define ATOM_MAX_AUDIO_SAMPLES (1024)       // max number of audio samples in internal sample buffer
@@ -92,6 +161,7 @@ typedef struct {
     atom_joystick_type_t joystick_type;     // what joystick type to emulate, default is ATOM_JOYSTICK_NONE
     chips_debug_t debug;
     chips_audio_desc_t audio;
+    int overclock;                          // optional CPU overclock factor (CPU ticks per device tick, default: 1)
     struct {
         chips_range_t abasic;
         chips_range_t afloat;
@@ -117,27 +187,43 @@ typedef struct {
     uint8_t joy_joymask;        // joystick mask from calls to atom_joystick()
     uint8_t mmc_cmd;
     uint8_t mmc_latch;
+    uint32_t tick_frac;         // fractional tick carried over between atom_exec() calls (see clk_us_to_ticks_frac())
+    uint32_t overclock;         // number of CPU ticks per device tick (see 'CPU Overclocking')
+    uint32_t overclock_count;   // CPU ticks since the last device tick
     mem_t mem;
     kbd_t kbd;
-    struct {
-        chips_audio_callback_t callback;
-        int num_samples;
-        int sample_pos;
-        float sample_buffer[ATOM_MAX_AUDIO_SAMPLES];
-    } audio;
     uint8_t ram[0xA000];
     uint8_t rom_abasic[0x2000];
     uint8_t rom_afloat[0x1000];
     uint8_t rom_dosrom[0x1000];
-    alignas(64) uint8_t fb[MC6847_FRAMEBUFFER_SIZE_BYTES];
     // tape loading
     struct {
         int size;  // tape_size is > 0 if a tape is inserted
         int pos;
+        #if defined(ATOM_BORROWED_TAPE)
+        const uint8_t* buf;     // borrowed tape data, not part of snapshots
+        #else
         uint8_t buf[ATOM_MAX_TAPE_SIZE];
+        #endif
     } tape;
+
+    // output-only state starting at audio.sample_buffer is not part of snapshots
+    struct {
+        chips_audio_callback_t callback;
+        int num_samples;
+        int sample_pos;
+        float sample_buffer[ATOM_MAX_AUDIO_SAMPLES];
+        chips_audio_ring_t* ring;
+    } audio;
+    chips_text_input_t text_input;  // pending text for the OSRDCH trap (see "Text Input")
+    #if !defined(ATOM_NO_FRAMEBUFFER)
+    alignas(64) uint8_t fb[MC6847_FRAMEBUFFER_SIZE_BYTES];
+    #endif
 } atom_t;
 
+// size of the part of atom_t which is stored in snapshots (the audio sample buffer and framebuffer are excluded)
+#define ATOM_SNAPSHOT_SIZE (offsetof(atom_t, audio.sample_buffer))
+
 // initialize a new Atom instance
 void atom_init(atom_t* sys, const atom_desc_t* desc);
 // discard Atom instance
@@ -148,10 +234,20 @@ void atom_reset(atom_t* sys);
 chips_display_info_t atom_display_info(atom_t* sys);
 // run Atom instance for a number of microseconds
 uint32_t atom_exec(atom_t* sys, uint32_t micro_seconds);
+// run Atom instance for a number of ticks
+uint32_t atom_exec_ticks(atom_t* sys, uint32_t num_ticks);
+// run Atom instance until the VDG activates the field sync, return number of ticks
+uint32_t atom_exec_frame(atom_t* sys);
+// set the CPU overclock factor (CPU ticks per device tick, 1 means no overclocking)
+void atom_set_overclock(atom_t* sys, int factor);
 // send a key down event
 void atom_key_down(atom_t* sys, int key_code);
 // send a key up event
 void atom_key_up(atom_t* sys, int key_code);
+// feed text into the OSRDCH keyboard input, the text must remain valid until consumed (see "Text Input")
+void atom_input_text(atom_t* sys, const char* text);
+// return true while text from atom_input_text() hasn't been consumed yet
+bool atom_input_text_pending(atom_t* sys);
 // enable/disable joystick emulation
 void atom_set_joystick_type(atom_t* sys, atom_joystick_type_t type);
 // get current joystick emulation type
@@ -181,10 +277,11 @@ bool atom_load_snapshot(atom_t* sys, uint32_t version, atom_t* src);
 
 #define _ATOM_ROM_DOSROM_SIZE (0x1000)
 
-static uint64_t _atom_vdg_fetch(uint64_t pins, void* user_data);
+static void _atom_vdg_fetch_row(uint16_t addr, uint8_t* dst, size_t num_bytes, void* user_data);
 static void _atom_init_keymap(atom_t* sys);
 static void _atom_init_memorymap(atom_t* sys);
 static uint64_t _atom_osload(atom_t* sys, uint64_t pins);
+static uint64_t _atom_osrdch(atom_t* sys, uint64_t pins);
 
 #define _ATOM_DEFAULT(val,def) (((val) != 0) ? (val) : (def))
 
@@ -194,7 +291,9 @@ void atom_init(atom_t* sys, const atom_desc_t* desc) {
     memset(sys, 0, sizeof(atom_t));
     sys->valid = true;
     sys->joystick_type = desc->joystick_type;
+    sys->overclock = (uint32_t)_ATOM_DEFAULT(desc->overclock, 1);
     sys->audio.callback = desc->audio.callback;
+    sys->audio.ring = desc->audio.ring;
     sys->audio.num_samples = _ATOM_DEFAULT(desc->audio.num_samples, ATOM_DEFAULT_AUDIO_SAMPLES);
     CHIPS_ASSERT(sys->audio.num_samples <= ATOM_MAX_AUDIO_SAMPLES);
     sys->debug = desc->debug;
@@ -212,12 +311,23 @@ void atom_init(atom_t* sys, const atom_desc_t* desc) {
     sys->pins = m6502_init(&sys->cpu, &(m6502_desc_t){0});
     mc6847_init(&sys->vdg, &(mc6847_desc_t){
         .tick_hz = ATOM_FREQUENCY,
+        #if !defined(ATOM_NO_FRAMEBUFFER)
         .framebuffer = {
             .ptr = &sys->fb,
             .size = sizeof(sys->fb),
         },
-        .fetch_cb = _atom_vdg_fetch,
+        #endif
+        .fetch_row_cb = _atom_vdg_fetch_row,
         .user_data = sys,
+        /*  the upper 2 databus bits are directly wired to MC6847 pins:
+            bit 7 -> INV pin (in text mode, invert pixel pattern)
+            bit 6 -> A/S and INT/EXT pin, A/S actives semigraphics mode
+                     and INT/EXT selects the 2x3 semigraphics pattern
+                     (so 4x4 semigraphics isn't possible)
+        */
+        .inv_mask = (1<<7),
+        .as_mask = (1<<6),
+        .intext_mask = (1<<6),
     });
     i8255_init(&sys->ppi);
     m6522_init(&sys->via);
@@ -246,12 +356,36 @@ void atom_reset(atom_t* sys) {
     mc6847_reset(&sys->vdg);
     beeper_reset(&sys->beeper);
     sys->state_2_4khz = false;
+    chips_text_input_clear(&sys->text_input);
 }
 
-uint64_t _atom_tick(atom_t* sys, uint64_t cpu_pins) {
-    // tick the CPU
-    cpu_pins = m6502_tick(&sys->cpu, cpu_pins);
+static inline uint64_t _atom_traps(atom_t* sys, uint64_t cpu_pins) {
+    /* check if the trapped OSLoad function was hit to implement tape file loading
+        http://ladybug.xs4all.nl/arlet/fpga/6502/kernel.dis
+    */
+    if (sys->tape.size > 0) {
+        const uint64_t trap_mask = M6502_SYNC|0xFFFF;
+        const uint64_t trap_val  = M6502_SYNC|0xF96E;
+        if ((cpu_pins & trap_mask) == trap_val) {
+            cpu_pins = _atom_osload(sys, cpu_pins);
+        }
+    }
+    // check if the default OSRDCH handler was hit while text input is pending
+    if (chips_text_input_pending(&sys->text_input)) {
+        const uint64_t trap_mask = M6502_SYNC|0xFFFF;
+        const uint64_t trap_val  = M6502_SYNC|0xFE94;
+        if ((cpu_pins & trap_mask) == trap_val) {
+            cpu_pins = _atom_osrdch(sys, cpu_pins);
+        }
+    }
+    return cpu_pins;
+}
 
+/* tick the chips (everything except the CPU and regular memory accesses),
+   tick_ppi may only be false when the CPU doesn't access the IO area, the
+   PPI port outputs can't change then
+*/
+static uint64_t _atom_tick_devices(atom_t* sys, uint64_t cpu_pins, bool tick_ppi) {
     // tick the 2.4khz counter
     sys->counter_2_4khz++;
     if (sys->counter_2_4khz >= sys->period_2_4khz) {
@@ -262,12 +396,17 @@ uint64_t _atom_tick(atom_t* sys, uint64_t cpu_pins) {
     // update beeper
     if (beeper_tick(&sys->beeper)) {
         // new audio sample ready
-        sys->audio.sample_buffer[sys->audio.sample_pos++] = sys->beeper.sample;
-        if (sys->audio.sample_pos == sys->audio.num_samples) {
-            if (sys->audio.callback.func) {
-                sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
+        if (sys->audio.ring) {
+            chips_audio_ring_push(sys->audio.ring, sys->beeper.sample);
+        }
+        else {
+            sys->audio.sample_buffer[sys->audio.sample_pos++] = sys->beeper.sample;
+            if (sys->audio.sample_pos == sys->audio.num_samples) {
+                if (sys->audio.callback.func) {
+                    sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
+                }
+                sys->audio.sample_pos = 0;
             }
-            sys->audio.sample_pos = 0;
         }
     }
 
@@ -318,17 +457,6 @@ uint64_t _atom_tick(atom_t* sys, uint64_t cpu_pins) {
             }
         }
     }
-    else {
-        // regular memory access
-        if (cpu_pins & M6502_RW) {
-            // memory read
-            M6502_SET_DATA(cpu_pins, mem_rd(&sys->mem, addr));
-        }
-        else {
-            // memory access
-            mem_wr(&sys->mem, addr, M6502_GET_DATA(cpu_pins));
-        }
-    }
 
     /* tick the PPI
         http://www.acornatom.nl/sites/fpga/www.howell1964.freeserve.co.uk/acorn/atom/amb/amb_8255.htm
@@ -351,7 +479,7 @@ uint64_t _atom_tick(atom_t* sys, uint64_t cpu_pins) {
         The port C output lines (PC0 to PC3) may be used for user
         applications when the cassette interface is not being used.
     */
-    {
+    if (tick_ppi) {
         ppi_pins |= (cpu_pins & M6502_RW) ? I8255_RD : I8255_WR;
         const uint8_t kbd_lines = (uint8_t) kbd_scan_lines(&sys->kbd);
         I8255_SET_PB(ppi_pins, ~kbd_lines);
@@ -365,22 +493,25 @@ uint64_t _atom_tick(atom_t* sys, uint64_t cpu_pins) {
         ppi_pins = i8255_tick(&sys->ppi, ppi_pins);
         const uint16_t kbd_column = 1<<(I8255_GET_PA(ppi_pins) & 0x0F);
         kbd_set_active_columns(&sys->kbd, kbd_column);
-        if (ppi_pins & I8255_PA4) { vdg_pins |= MC6847_AG; }
-        if (ppi_pins & I8255_PA5) { vdg_pins |= MC6847_GM0; }
-        if (ppi_pins & I8255_PA6) { vdg_pins |= MC6847_GM1; }
-        if (ppi_pins & I8255_PA7) { vdg_pins |= MC6847_GM2; }
         beeper_set(&sys->beeper, 0 == (ppi_pins & I8255_PC2));
-        if (ppi_pins & I8255_PC3) {
-            vdg_pins |= MC6847_CSS;
-        }
         if((ppi_pins & (I8255_RD|I8255_CS)) == (I8255_RD|I8255_CS)) {
             cpu_pins = M6502_COPY_DATA(cpu_pins, ppi_pins);
         }
     }
+    {
+        const uint64_t ppi_out = sys->ppi.pins;
+        if (ppi_out & I8255_PA4) { vdg_pins |= MC6847_AG; }
+        if (ppi_out & I8255_PA5) { vdg_pins |= MC6847_GM0; }
+        if (ppi_out & I8255_PA6) { vdg_pins |= MC6847_GM1; }
+        if (ppi_out & I8255_PA7) { vdg_pins |= MC6847_GM2; }
+        if (ppi_out & I8255_PC3) {
+            vdg_pins |= MC6847_CSS;
+        }
+    }
 
     // tick the VIA
     {
-        via_pins = m6522_tick(&sys->via, via_pins);
+        via_pins = m6522_tick_sched(&sys->via, via_pins);
         if ((via_pins & (M6522_RW|M6522_CS1)) == (M6522_RW|M6522_CS1)) {
             cpu_pins = M6502_COPY_DATA(cpu_pins, via_pins);
         }
@@ -393,58 +524,182 @@ uint64_t _atom_tick(atom_t* sys, uint64_t cpu_pins) {
     */
     mc6847_tick(&sys->vdg, vdg_pins);
 
-    /* check if the trapped OSLoad function was hit to implement tape file loading
-        http://ladybug.xs4all.nl/arlet/fpga/6502/kernel.dis
-    */
-    if (sys->tape.size > 0) {
-        const uint64_t trap_mask = M6502_SYNC|0xFFFF;
-        const uint64_t trap_val  = M6502_SYNC|0xF96E;
-        if ((cpu_pins & trap_mask) == trap_val) {
-            cpu_pins = _atom_osload(sys, cpu_pins);
+    return cpu_pins;
+}
+
+uint64_t _atom_tick(atom_t* sys, uint64_t cpu_pins) {
+    // tick the CPU
+    cpu_pins = m6502_tick(&sys->cpu, cpu_pins);
+
+    // regular memory access
+    const uint16_t addr = M6502_GET_ADDR(cpu_pins);
+    const bool io = (addr & 0xF000) == 0xB000;
+    if (!io) {
+        if (cpu_pins & M6502_RW) {
+            M6502_SET_DATA(cpu_pins, mem_rd(&sys->mem, addr));
+        }
+        else {
+            mem_wr(&sys->mem, addr, M6502_GET_DATA(cpu_pins));
         }
     }
-    return cpu_pins;
+
+    // in overclock mode, only every Nth CPU tick also ticks the other chips,
+    // except for accesses to the IO area and wait states which must always be seen
+    if (sys->overclock > 1) {
+        if ((++sys->overclock_count < sys->overclock) && !io && !(cpu_pins & M6502_RDY)) {
+            return _atom_traps(sys, cpu_pins);
+        }
+        sys->overclock_count = 0;
+    }
+    return _atom_traps(sys, _atom_tick_devices(sys, cpu_pins, true));
 }
 
-uint32_t atom_exec(atom_t* sys, uint32_t micro_seconds) {
-    CHIPS_ASSERT(sys && sys->valid);
-    uint32_t num_ticks = clk_us_to_ticks(ATOM_FREQUENCY, micro_seconds);
+#if defined(M6502_HAS_EXEC)
+// the memory-mapped IO area at 0xB000..0xBFFF in MEM_PAGE_SIZE pages
+static uint64_t _atom_io_pages(void) {
+    uint64_t pages = 0;
+    for (uint32_t addr = 0xB000; addr < 0xC000; addr += 0x0400) {
+        pages |= 1ULL << (addr >> MEM_PAGE_SHIFT);
+    }
+    return pages;
+}
+
+/* run a complete instruction with m6502_exec_op_fast() and tick the other
+   chips afterwards (see 'Instruction-Stepped Execution'), returns 0 if the next
+   instruction must be executed with _atom_tick()
+*/
+static uint32_t _atom_exec_op(atom_t* sys, const m6502_exec_t* ex, uint64_t* pins_ptr) {
+    uint64_t pins = *pins_ptr;
+    if ((0 == (pins & M6502_SYNC)) || (pins & M6502_RDY)) {
+        return 0;
+    }
+    // the VIA must not change the IRQ pin during the instruction
+    if (sys->via.idle_ticks < M6502_EXEC_OP_MAX_TICKS) {
+        return 0;
+    }
+    const uint32_t num_ticks = m6502_exec_op_fast(&sys->cpu, ex, &pins);
+    for (uint32_t i = 0; i < num_ticks; i++) {
+        if (sys->overclock > 1) {
+            if (++sys->overclock_count < sys->overclock) {
+                continue;
+            }
+            sys->overclock_count = 0;
+        }
+        // the PPI only needs to see the last tick of the instruction
+        pins = _atom_tick_devices(sys, pins, i == (num_ticks - 1));
+    }
+    if (num_ticks > 0) {
+        *pins_ptr = _atom_traps(sys, pins);
+    }
+    return num_ticks;
+}
+
+/* true if the VDG won't decode a scanline or activate the field sync
+   during the next instruction, the CPU's memory writes of a fast-path
+   instruction happen before the VDG ticks of that instruction
+*/
+static inline bool _atom_vdg_quiet(const atom_t* sys) {
+    const mc6847_t* vdg = &sys->vdg;
+    return ((vdg->h_count + (M6502_EXEC_OP_MAX_TICKS * MC6847_FIXEDPOINT_SCALE)) < vdg->h_period) &&
+           (vdg->fs || (vdg->l_count != MC6847_FSYNC_START));
+}
+#endif
+
+/* run for at most num_ticks, in frame mode stop right after the tick which
+   has activated the field sync output of the VDG
+*/
+static uint32_t _atom_exec(atom_t* sys, uint32_t num_ticks, bool frame_mode) {
     uint64_t pins = sys->pins;
+    uint32_t ticks = 0;
     if (0 == sys->debug.callback.func) {
-        // run without debug hook
-        for (uint32_t ticks = 0; ticks < num_ticks; ticks++) {
-            pins = _atom_tick(sys, pins);
+        #if defined(M6502_HAS_EXEC)
+        const m6502_exec_t ex = { .mem = &sys->mem, .io_pages = _atom_io_pages() };
+        #endif
+        if (frame_mode) {
+            // run without debug hook until field sync
+            while (ticks < num_ticks) {
+                #if defined(M6502_HAS_EXEC)
+                if (((ticks + M6502_EXEC_OP_MAX_TICKS) <= num_ticks) && _atom_vdg_quiet(sys)) {
+                    const uint32_t n = _atom_exec_op(sys, &ex, &pins);
+                    if (n > 0) {
+                        ticks += n;
+                        continue;
+                    }
+                }
+                #endif
+                const bool fs = sys->vdg.fs;
+                pins = _atom_tick(sys, pins);
+                ticks++;
+                if (!fs && sys->vdg.fs) {
+                    break;
+                }
+            }
+        }
+        else {
+            // run without debug hook
+            while (ticks < num_ticks) {
+                #if defined(M6502_HAS_EXEC)
+                if (((ticks + M6502_EXEC_OP_MAX_TICKS) <= num_ticks) && _atom_vdg_quiet(sys)) {
+                    const uint32_t n = _atom_exec_op(sys, &ex, &pins);
+                    if (n > 0) {
+                        ticks += n;
+                        continue;
+                    }
+                }
+                #endif
+                pins = _atom_tick(sys, pins);
+                ticks++;
+            }
         }
     }
     else {
-        // run with debug hook]
-        for (uint32_t ticks = 0; (ticks < num_ticks) && !(*sys->debug.stopped); ticks++) {
+        // run with debug hook
+        chips_debug_filter_t* filter = sys->debug.filter;
+        while ((ticks < num_ticks) && !(*sys->debug.stopped)) {
+            const bool fs = sys->vdg.fs;
             pins = _atom_tick(sys, pins);
-            sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            ticks++;
+            if ((0 == filter) || chips_debug_filter_hit(filter, 0 != (pins & M6502_SYNC), M6502_GET_ADDR(pins),
+                    0 != (pins & M6502_RW), 0 == (pins & M6502_RW))) {
+                sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            }
+            if (frame_mode && !fs && sys->vdg.fs) {
+                break;
+            }
         }
     }
     sys->pins = pins;
-    kbd_update(&sys->kbd, micro_seconds);
-    return num_ticks;
+    kbd_update(&sys->kbd, clk_ticks_to_us(ATOM_FREQUENCY * sys->overclock, ticks));
+    return ticks;
+}
+
+uint32_t atom_exec(atom_t* sys, uint32_t micro_seconds) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return _atom_exec(sys, clk_us_to_ticks_frac(ATOM_FREQUENCY * sys->overclock, micro_seconds, &sys->tick_frac), false);
 }
 
-uint64_t _atom_vdg_fetch(uint64_t pins, void* user_data) {
+uint32_t atom_exec_ticks(atom_t* sys, uint32_t num_ticks) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return _atom_exec(sys, num_ticks, false);
+}
+
+uint32_t atom_exec_frame(atom_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    // the VDG frame timing is fixed, the 40 milliseconds limit is only a safety net
+    return _atom_exec(sys, clk_us_to_ticks(ATOM_FREQUENCY * sys->overclock, 40000), true);
+}
+
+void atom_set_overclock(atom_t* sys, int factor) {
+    CHIPS_ASSERT(sys && sys->valid && (factor >= 1));
+    sys->overclock = (uint32_t)factor;
+    sys->overclock_count = 0;
+}
+
+static void _atom_vdg_fetch_row(uint16_t addr, uint8_t* dst, size_t num_bytes, void* user_data) {
     atom_t* sys = (atom_t*) user_data;
-    const uint16_t addr = MC6847_GET_ADDR(pins);
-    uint8_t data = sys->ram[(addr + 0x8000) & 0xFFFF];
-    MC6847_SET_DATA(pins, data);
-
-    /*  the upper 2 databus bits are directly wired to MC6847 pins:
-        bit 7 -> INV pin (in text mode, invert pixel pattern)
-        bit 6 -> A/S and INT/EXT pin, A/S actives semigraphics mode
-                 and INT/EXT selects the 2x3 semigraphics pattern
-                 (so 4x4 semigraphics isn't possible)
-    */
-    if (data & (1<<7)) { pins |= MC6847_INV; }
-    else               { pins &= ~MC6847_INV; }
-    if (data & (1<<6)) { pins |= (MC6847_AS|MC6847_INTEXT); }
-    else               { pins &= ~(MC6847_AS|MC6847_INTEXT); }
-    return pins;
+    // video memory starts at 0x8000
+    CHIPS_ASSERT((addr + 0x8000 + num_bytes) <= sizeof(sys->ram));
+    memcpy(dst, &sys->ram[addr + 0x8000], num_bytes);
 }
 
 void atom_key_down(atom_t* sys, int key_code) {
@@ -591,7 +846,11 @@ bool atom_insert_tape(atom_t* sys, chips_range_t data) {
     if ((data.size < sizeof(_atom_tap_header)) || (data.size > ATOM_MAX_TAPE_SIZE)) {
         return false;
     }
-    memcpy(sys->tape.buf, data.ptr, data.size);
+    #if defined(ATOM_BORROWED_TAPE)
+        sys->tape.buf = (const uint8_t*) data.ptr;
+    #else
+        memcpy(sys->tape.buf, data.ptr, data.size);
+    #endif
     sys->tape.pos = 0;
     sys->tape.size = data.size;
     return true;
@@ -601,6 +860,9 @@ void atom_remove_tape(atom_t* sys) {
     CHIPS_ASSERT(sys && sys->valid);
     sys->tape.pos = 0;
     sys->tape.size = 0;
+    #if defined(ATOM_BORROWED_TAPE)
+        sys->tape.buf = 0;
+    #endif
 }
 
 /*
@@ -697,6 +959,36 @@ uint64_t _atom_osload(atom_t* sys, uint64_t pins) {
     return pins;
 }
 
+/*
+    trapped OSRDCH handler while text input is pending, return the next
+    character in A and continue with an RTS
+*/
+uint64_t _atom_osrdch(atom_t* sys, uint64_t pins) {
+    uint8_t c = chips_text_input_next(&sys->text_input);
+    if (0 == c) {
+        /* no more text, continue with the regular keyboard input */
+        return pins;
+    }
+    if ((c >= 'a') && (c <= 'z')) {
+        c = (uint8_t)(c - 'a' + 'A');
+    }
+    m6502_set_a(&sys->cpu, c);
+    M6502_SET_ADDR(pins, 0xF9A1);
+    M6502_SET_DATA(pins, mem_rd(&sys->mem, 0xF9A1));
+    m6502_set_pc(&sys->cpu, 0xF9A1);
+    return pins;
+}
+
+void atom_input_text(atom_t* sys, const char* text) {
+    CHIPS_ASSERT(sys && sys->valid);
+    chips_text_input_start(&sys->text_input, (const uint8_t*)text, text ? strlen(text) : 0);
+}
+
+bool atom_input_text_pending(atom_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return chips_text_input_pending(&sys->text_input);
+}
+
 chips_display_info_t atom_display_info(atom_t* sys) {
     const chips_display_info_t res = {
         .frame = {
@@ -706,8 +998,10 @@ chips_display_info_t atom_display_info(atom_t* sys) {
             },
             .bytes_per_pixel = 1,
             .buffer = {
+                #if !defined(ATOM_NO_FRAMEBUFFER)
                 .ptr = sys ? sys->fb : 0,
                 .size = MC6847_FRAMEBUFFER_SIZE_BYTES,
+                #endif
             }
         },
         .screen = {
@@ -721,19 +1015,24 @@ chips_display_info_t atom_display_info(atom_t* sys) {
             .size = MC6847_HWCOLOR_NUM * sizeof(uint32_t)
         }
     };
+    #if !defined(ATOM_NO_FRAMEBUFFER)
     CHIPS_ASSERT(((sys == 0) && (res.frame.buffer.ptr == 0)) || ((sys != 0) && (res.frame.buffer.ptr != 0)));
+    #endif
     CHIPS_ASSERT(((sys == 0) && (res.palette.ptr == 0)) || ((sys != 0) && (res.palette.ptr != 0)));
     return res;
 }
 
 uint32_t atom_save_snapshot(atom_t* sys, atom_t* dst) {
     CHIPS_ASSERT(sys && dst);
-    *dst = *sys;
+    memcpy(dst, sys, ATOM_SNAPSHOT_SIZE);
     chips_debug_snapshot_onsave(&dst->debug);
     chips_audio_callback_snapshot_onsave(&dst->audio.callback);
     m6502_snapshot_onsave(&dst->cpu);
     mc6847_snapshot_onsave(&dst->vdg);
     mem_snapshot_onsave(&dst->mem, sys);
+    #if defined(ATOM_BORROWED_TAPE)
+        dst->tape.buf = 0;
+    #endif
     return ATOM_SNAPSHOT_VERSION;
 }
 
@@ -743,13 +1042,30 @@ bool atom_load_snapshot(atom_t* sys, uint32_t version, atom_t* src) {
         return false;
     }
     static atom_t im;
-    im = *src;
+    memcpy(&im, src, ATOM_SNAPSHOT_SIZE);
     chips_debug_snapshot_onload(&im.debug, &sys->debug);
     chips_audio_callback_snapshot_onload(&im.audio.callback, &sys->audio.callback);
     m6502_snapshot_onload(&im.cpu, &sys->cpu);
     mc6847_snapshot_onload(&im.vdg, &sys->vdg);
     mem_snapshot_onload(&im.mem, sys);
-    *sys = im;
+    // the overclock factor is a setting of the target system
+    if (im.overclock != sys->overclock) {
+        im.overclock = sys->overclock;
+        im.overclock_count = 0;
+    }
+    #if defined(ATOM_BORROWED_TAPE)
+        // the borrowed tape data is taken from the target system, the same tape must be inserted
+        if ((im.tape.size > 0) && (im.tape.size == sys->tape.size)) {
+            im.tape.buf = sys->tape.buf;
+        }
+        else {
+            im.tape.buf = 0;
+            im.tape.size = 0;
+            im.tape.pos = 0;
+        }
+    #endif
+    memcpy(sys, &im, ATOM_SNAPSHOT_SIZE);
+    chips_text_input_clear(&sys->text_input);
     return true;
 }
 
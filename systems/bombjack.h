@@ -22,6 +22,7 @@
 
     - chips/chips_common.h
     - chips/z80.h
+    - chips/blip.h (only with CHIPS_BLIP)
     - chips/ay38910.h
     - chips/clk.h
     - chips/mem.h
@@ -33,6 +34,30 @@
         - https://floooh.github.io/2018/10/06/bombjack.html
         - https://github.com/floooh/emu-info/blob/master/misc/bombjack-schematics.pdf
 
+    ## Run-Ahead
+
+    Set bombjack_desc_t.runahead_frames to a value between 1 and
+    BOMBJACK_MAX_RUNAHEAD_FRAMES to hide the input latency of the game by
+    running ahead of the actual emulation:
+
+    - first, bombjack_exec() or bombjack_exec_frame() runs the requested
+      time slice as usual with audio output, but without decoding the video
+      output
+    - the emulator state in front of the ROM images is saved into an
+      internal buffer (this is much smaller than a full snapshot)
+    - the main board runs ahead for the given number of frames with the
+      current input state, only the last frame is decoded into the
+      framebuffer, the sound board doesn't need to run at all because
+      it can't influence the main board
+    - the saved emulator state is restored
+
+    The displayed frame is then 'runahead_frames' frames ahead of the
+    audio output and the actual emulator state, which removes the same
+    number of frames of input lag, as long as the game doesn't react to
+    input earlier than that. Run-ahead is skipped while a debug callback
+    is installed, or while video decoding is switched off with
+    bombjack_enable_video().
+
     ## zlib/libpng license
 
     Copyright (c) 2018 Andre Weissflog
@@ -61,7 +86,7 @@ extern "C" {
 #endif
 
 // increase when bombjack_t memory layout changes
-#define BOMBJACK_SNAPSHOT_VERSION (2)
+#define BOMBJACK_SNAPSHOT_VERSION (10)
 
 #define BOMBJACK_MAX_AUDIO_SAMPLES (1024)
 #define BOMBJACK_DEFAULT_AUDIO_SAMPLES (128)
@@ -138,10 +163,16 @@ typedef struct {
     chips_debug_t soundboard;
 } bombjack_debug_t;
 
+// max number of frames to run ahead (see "Run-Ahead")
+#define BOMBJACK_MAX_RUNAHEAD_FRAMES (4)
+// size of the run-ahead state buffer (must be big enough for the bombjack_t state in front of the ROM images)
+#define BOMBJACK_RUNAHEAD_STATE_SIZE (24 * 1024)
+
 // configuration parameters for bombjack_init()
 typedef struct {
     bombjack_debug_t debug;
     chips_audio_desc_t audio;
+    int runahead_frames;                 // number of frames to run ahead to reduce input latency (default: 0, see "Run-Ahead")
     struct {
         chips_range_t main_0000_1FFF;    // main-board ROM 0x0000..0x1FFF
         chips_range_t main_2000_3FFF;    // main-board ROM 0x2000..0x3FFF
@@ -182,12 +213,22 @@ typedef struct {
     struct {
         z80_t cpu;
         ay38910_t psg[3];
+        uint32_t psg_ticks;     // PSG ticks which haven't been executed yet (see _bombjack_psg_sync())
         uint32_t tick_count;
         int vsync_count;
         mem_t mem;
         uint64_t pins;
     } soundboard;
     uint8_t sound_latch;        // shared latch, written by main board, read by sound board
+    uint32_t tick_frac;         // fractional main board tick carried over between bombjack_exec() calls (see clk_us_to_ticks_frac())
+    uint32_t sb_tick_frac;      // fractional sound board tick carried over between calls, in 1/4000000 sound board ticks
+    // board scheduling state of the current bombjack_exec() call
+    struct {
+        uint32_t mb_num_ticks;  // main board ticks to run
+        uint32_t sb_num_ticks;  // sound board ticks to run
+        uint32_t mb_tick;       // main board ticks executed so far
+        uint32_t sb_tick;       // sound board ticks executed so far
+    } sched;
 
     bool valid;
 
@@ -200,25 +241,53 @@ typedef struct {
     uint8_t rom_sprites[3][0x2000];
     uint8_t rom_maps[1][0x1000];
 
+    struct {
+        bombjack_debug_t debug;
+        bool draw_background_layer;
+        bool draw_foreground_layer;
+        bool draw_sprite_layer;
+        bool clear_background_layer;
+    } dbg;
+
+    // output-only state starting at audio.sample_buffer is not part of snapshots
     struct {
         chips_audio_callback_t callback;
         int num_samples;
         int sample_pos;
         float volume;
         float sample_buffer[BOMBJACK_MAX_AUDIO_SAMPLES];
+        chips_audio_ring_t* ring;
     } audio;
-
+    alignas(64) uint32_t fb[BOMBJACK_FRAMEBUFFER_WIDTH * BOMBJACK_FRAMEBUFFER_HEIGHT];
+    // 3-bit pens pre-decoded from the gfx ROMs in bombjack_init()
     struct {
-        bombjack_debug_t debug;
+        uint8_t tiles[256][16*16];      // background tiles
+        uint8_t chars[512][8*8];        // foreground chars
+        uint8_t sprites[256][16*16];    // 16x16 sprites (a 32x32 sprite is made of 4 of those)
+    } pens;
+    // combined background and foreground layer as palette indices, only changed 8x8 cells are redrawn
+    struct {
+        bool valid;                     // false forces a redraw of all cells
+        uint8_t bg_image;               // state the layer was drawn with
         bool draw_background_layer;
         bool draw_foreground_layer;
-        bool draw_sprite_layer;
         bool clear_background_layer;
-    } dbg;
-
-    alignas(64) uint32_t fb[BOMBJACK_FRAMEBUFFER_WIDTH * BOMBJACK_FRAMEBUFFER_HEIGHT];
+        uint8_t chr[32*32];             // foreground char- and color-codes each cell was drawn with
+        uint8_t clr[32*32];
+        alignas(64) uint8_t pixels[BOMBJACK_DISPLAY_WIDTH * BOMBJACK_DISPLAY_HEIGHT];
+    } tile_layer;
+    // run-ahead state (see "Run-Ahead")
+    struct {
+        int num_frames;             // number of frames to run ahead, 0 if disabled
+        bool video_disabled;        // don't decode the video output at the end of bombjack_exec_ticks() (see bombjack_enable_video())
+        bool soundboard_disabled;   // don't run the sound board
+        uint8_t state[BOMBJACK_RUNAHEAD_STATE_SIZE];    // emulator state saved before running ahead
+    } runahead;
 } bombjack_t;
 
+// size of the part of bombjack_t which is stored in snapshots (the audio sample buffer and framebuffer are excluded)
+#define BOMBJACK_SNAPSHOT_SIZE (offsetof(bombjack_t, audio.sample_buffer))
+
 // initialize a new bombjack instance
 void bombjack_init(bombjack_t* sys, const bombjack_desc_t* desc);
 // discard a bombjack instance
@@ -229,6 +298,14 @@ void bombjack_reset(bombjack_t* sys);
 chips_display_info_t bombjack_display_info(bombjack_t* sys);
 // run bombjack instance for given amount of microseconds
 uint32_t bombjack_exec(bombjack_t* sys, uint32_t micro_seconds);
+// run bombjack instance for given number of main board ticks (the sound board runs for the same amount of time)
+uint32_t bombjack_exec_ticks(bombjack_t* sys, uint32_t num_ticks);
+// run bombjack instance until the next main board VSYNC
+uint32_t bombjack_exec_frame(bombjack_t* sys);
+// enable/disable video decoding (run-ahead is skipped while video decoding is disabled)
+void bombjack_enable_video(bombjack_t* sys, bool enabled);
+// get current video decoding enabled state
+bool bombjack_video_enabled(bombjack_t* sys);
 // take a snapshot, patches any pointers to zero, returns a snapshot version
 uint32_t bombjack_save_snapshot(bombjack_t* sys, bombjack_t* dst);
 // load a snapshot, returns false if snapshot version doesn't match
@@ -254,6 +331,9 @@ bool bombjack_load_snapshot(bombjack_t* sys, uint32_t version, bombjack_t* src);
 
 #define _bombjack_def(val, def) (val == 0 ? def : val)
 
+static void _bombjack_init_pens(bombjack_t* sys);
+static void _bombjack_soundboard_sync(bombjack_t* sys);
+
 void bombjack_init(bombjack_t* sys, const bombjack_desc_t* desc) {
     CHIPS_ASSERT(sys && desc);
     if (desc->debug.mainboard.callback.func) { CHIPS_ASSERT(desc->debug.mainboard.stopped); }
@@ -266,6 +346,9 @@ void bombjack_init(bombjack_t* sys, const bombjack_desc_t* desc) {
     sys->dbg.draw_foreground_layer = true;
     sys->dbg.draw_sprite_layer = true;
     sys->dbg.clear_background_layer = true;
+    CHIPS_ASSERT((desc->runahead_frames >= 0) && (desc->runahead_frames <= BOMBJACK_MAX_RUNAHEAD_FRAMES));
+    CHIPS_ASSERT(offsetof(bombjack_t, rom_main) <= BOMBJACK_RUNAHEAD_STATE_SIZE);
+    sys->runahead.num_frames = desc->runahead_frames;
 
     /* copy over ROM images */
     CHIPS_ASSERT(desc->roms.main_0000_1FFF.ptr && (desc->roms.main_0000_1FFF.size == sizeof(sys->rom_main[0])));
@@ -300,6 +383,7 @@ void bombjack_init(bombjack_t* sys, const bombjack_desc_t* desc) {
     memcpy(sys->rom_sprites[1], desc->roms.sprites_2000_3FFF.ptr, sizeof(sys->rom_sprites[1]));
     memcpy(sys->rom_sprites[2], desc->roms.sprites_4000_5FFF.ptr, sizeof(sys->rom_sprites[2]));
     memcpy(sys->rom_maps[0], desc->roms.maps_0000_0FFF.ptr, sizeof(sys->rom_maps[0]));
+    _bombjack_init_pens(sys);
 
     /* The VSYNC/VBLANK mainly controls the interrupts (Bombjack generally
         uses NMIs for simplicity. The mainboard's NMI is connected to the
@@ -375,6 +459,7 @@ void bombjack_init(bombjack_t* sys, const bombjack_desc_t* desc) {
     // move over audio-output config
     CHIPS_ASSERT(desc->audio.num_samples <= BOMBJACK_MAX_AUDIO_SAMPLES);
     sys->audio.callback = desc->audio.callback;
+    sys->audio.ring = desc->audio.ring;
     sys->audio.num_samples = _bombjack_def(desc->audio.num_samples, BOMBJACK_DEFAULT_AUDIO_SAMPLES);
     sys->audio.volume = _bombjack_def(desc->audio.volume, 1.0f);
 }
@@ -391,6 +476,7 @@ void bombjack_reset(bombjack_t* sys) {
     for (size_t i = 0; i < 3; i++) {
         ay38910_reset(&sys->soundboard.psg[i]);
     }
+    sys->soundboard.psg_ticks = 0;
 }
 
 /* Maintain a color palette cache with 32-bit colors, this is called for
@@ -533,7 +619,8 @@ static uint64_t _bombjack_tick_mainboard(bombjack_t* sys, uint64_t pins) {
             }
             // FIXME: 0xB004: flip screen
             else if (addr == 0xB800) {
-                // shared sound latch
+                // shared sound latch, the sound board needs to catch up first (see bombjack_exec())
+                _bombjack_soundboard_sync(sys);
                 sys->sound_latch = data;
             }
         }
@@ -559,6 +646,67 @@ static uint64_t _bombjack_tick_mainboard(bombjack_t* sys, uint64_t pins) {
     return pins;
 }
 
+/* catch up with the PSG ticks which have been accumulated since the last
+   call, this must happen before each PSG register access and at the end
+   of bombjack_exec()
+
+   All 3 PSGs have the same clock and sample rate, so they generate their
+   samples on the same ticks, the first PSG writes directly into the
+   audio sample buffer, and the other two PSGs are mixed into it
+*/
+static void _bombjack_psg_sync(bombjack_t* sys) {
+    float psg1_samples[BOMBJACK_MAX_AUDIO_SAMPLES];
+    float psg2_samples[BOMBJACK_MAX_AUDIO_SAMPLES];
+    while (sys->soundboard.psg_ticks > 0) {
+        // write directly into the host's ring buffer if provided, otherwise into the sample buffer
+        float* dst;
+        int max_samples;
+        uint32_t num_free = 0;
+        if (sys->audio.ring) {
+            dst = chips_audio_ring_begin_write(sys->audio.ring, &num_free);
+            if (0 == num_free) {
+                // ring buffer is full, generate the samples into the sample buffer and drop them
+                dst = sys->audio.sample_buffer;
+                max_samples = BOMBJACK_MAX_AUDIO_SAMPLES;
+            }
+            else {
+                max_samples = (num_free < BOMBJACK_MAX_AUDIO_SAMPLES) ? (int)num_free : BOMBJACK_MAX_AUDIO_SAMPLES;
+            }
+        }
+        else {
+            dst = &sys->audio.sample_buffer[sys->audio.sample_pos];
+            max_samples = sys->audio.num_samples - sys->audio.sample_pos;
+        }
+        const uint32_t num_ticks = sys->soundboard.psg_ticks;
+        int num_samples[3] = { 0 };
+        uint32_t ticks = ay38910_run(&sys->soundboard.psg[0], num_ticks, dst, max_samples, &num_samples[0]);
+        ay38910_run(&sys->soundboard.psg[1], ticks, psg1_samples, max_samples, &num_samples[1]);
+        ay38910_run(&sys->soundboard.psg[2], ticks, psg2_samples, max_samples, &num_samples[2]);
+        CHIPS_ASSERT((num_samples[0] == num_samples[1]) && (num_samples[0] == num_samples[2]));
+        for (int i = 0; i < num_samples[0]; i++) {
+            dst[i] = (dst[i] + psg1_samples[i] + psg2_samples[i]) * sys->audio.volume;
+        }
+        sys->soundboard.psg_ticks -= ticks;
+        if (sys->audio.ring) {
+            if (num_free > 0) {
+                chips_audio_ring_end_write(sys->audio.ring, (uint32_t)num_samples[0]);
+            }
+            else {
+                sys->audio.ring->dropped += (uint32_t)num_samples[0];
+            }
+        }
+        else {
+            sys->audio.sample_pos += num_samples[0];
+            if (sys->audio.sample_pos == sys->audio.num_samples) {
+                if (sys->audio.callback.func) {
+                    sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
+                }
+                sys->audio.sample_pos = 0;
+            }
+        }
+    }
+}
+
 /* sound board tick function
 
     The sound board receives commands from the main board via the shared
@@ -645,28 +793,74 @@ static uint64_t _bombjack_tick_soundboard(bombjack_t* sys, uint64_t pins) {
         if (psg_index < 3) {
             if (pins & Z80_WR) { pins |= AY38910_BDIR; }
             if (0 == (pins & Z80_A0)) { pins |= AY38910_BC1; }
+            _bombjack_psg_sync(sys);
             pins = ay38910_iorq(&sys->soundboard.psg[psg_index], pins) & Z80_PIN_MASK;
         }
     }
 
-    // tick the AY chips at half CPU frequency
+    // tick the AY chips at half CPU frequency, the AY chips are only ticked lazily (see _bombjack_psg_sync())
     if (sys->soundboard.tick_count++ & 1) {
-        ay38910_tick(&sys->soundboard.psg[2]);
-        ay38910_tick(&sys->soundboard.psg[1]);
-        if (ay38910_tick(&sys->soundboard.psg[0])) {
-            float s = sys->soundboard.psg[0].sample +
-                      sys->soundboard.psg[1].sample +
-                      sys->soundboard.psg[2].sample;
-            sys->audio.sample_buffer[sys->audio.sample_pos++] = s * sys->audio.volume;
-            if (sys->audio.sample_pos == sys->audio.num_samples) {
-                if (sys->audio.callback.func) {
-                    sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
-                }
-                sys->audio.sample_pos = 0;
+        sys->soundboard.psg_ticks++;
+    }
+    return pins;
+}
+
+// run the sound board up to the given tick of the current bombjack_exec() call
+static void _bombjack_run_soundboard(bombjack_t* sys, uint32_t until_tick) {
+    uint64_t pins = sys->soundboard.pins;
+    if (0 == sys->dbg.debug.soundboard.callback.func) {
+        // run without debug callback
+        while (sys->sched.sb_tick < until_tick) {
+            pins = _bombjack_tick_soundboard(sys, pins);
+            sys->sched.sb_tick++;
+        }
+    }
+    else {
+        // run with debug callback
+        chips_debug_filter_t* filter = sys->dbg.debug.soundboard.filter;
+        while ((sys->sched.sb_tick < until_tick) && !(*sys->dbg.debug.soundboard.stopped)) {
+            pins = _bombjack_tick_soundboard(sys, pins);
+            sys->sched.sb_tick++;
+            if ((0 == filter) || chips_debug_filter_hit(filter, z80_opdone(&sys->soundboard.cpu), Z80_GET_ADDR(pins),
+                    (pins & (Z80_MREQ|Z80_RD)) == (Z80_MREQ|Z80_RD), (pins & (Z80_MREQ|Z80_WR)) == (Z80_MREQ|Z80_WR))) {
+                sys->dbg.debug.soundboard.callback.func(sys->dbg.debug.soundboard.callback.user_data, pins);
             }
         }
     }
-    return pins;
+    sys->soundboard.pins = pins;
+}
+
+// bring the sound board up to the main board's current time
+static void _bombjack_soundboard_sync(bombjack_t* sys) {
+    if (sys->sched.mb_num_ticks > 0) {
+        const uint64_t sb_tick = ((uint64_t)sys->sched.mb_tick * sys->sched.sb_num_ticks) / sys->sched.mb_num_ticks;
+        _bombjack_run_soundboard(sys, (uint32_t)sb_tick);
+    }
+}
+
+// run the main board for the current bombjack_exec() call
+static void _bombjack_run_mainboard(bombjack_t* sys) {
+    uint64_t pins = sys->mainboard.pins;
+    if (0 == sys->dbg.debug.mainboard.callback.func) {
+        // run without debug callback
+        while (sys->sched.mb_tick < sys->sched.mb_num_ticks) {
+            pins = _bombjack_tick_mainboard(sys, pins);
+            sys->sched.mb_tick++;
+        }
+    }
+    else {
+        // run with debug callback
+        chips_debug_filter_t* filter = sys->dbg.debug.mainboard.filter;
+        while ((sys->sched.mb_tick < sys->sched.mb_num_ticks) && !(*sys->dbg.debug.mainboard.stopped)) {
+            pins = _bombjack_tick_mainboard(sys, pins);
+            sys->sched.mb_tick++;
+            if ((0 == filter) || chips_debug_filter_hit(filter, z80_opdone(&sys->mainboard.cpu), Z80_GET_ADDR(pins),
+                    (pins & (Z80_MREQ|Z80_RD)) == (Z80_MREQ|Z80_RD), (pins & (Z80_MREQ|Z80_WR)) == (Z80_MREQ|Z80_WR))) {
+                sys->dbg.debug.mainboard.callback.func(sys->dbg.debug.mainboard.callback.user_data, pins);
+            }
+        }
+    }
+    sys->mainboard.pins = pins;
 }
 
 /* render background tiles
@@ -729,47 +923,53 @@ static uint64_t _bombjack_tick_soundboard(bombjack_t* sys, uint64_t pins) {
 #define BOMBJACK_GATHER16(rom,off) \
     ((uint16_t)rom[0+off]<<8)|((uint16_t)rom[8+off])
 
-static void _bombjack_decode_background(bombjack_t* sys) {
-    uint32_t* ptr = sys->fb;
-    uint16_t img_base_addr = (sys->mainboard.bg_image & 7) * 0x0200;
-    bool img_valid = (sys->mainboard.bg_image & 0x10) != 0;
-    for (size_t y = 0; y < 16; y++) {
-        for (size_t x = 0; x < 16; x++) {
-            size_t addr = img_base_addr + (y * 16 + x);
-            // 256 tiles
-            uint8_t tile_code = img_valid ? sys->rom_maps[0][addr] : 0;
-            uint8_t attr = sys->rom_maps[0][addr + 0x0100];
-            uint8_t color_block = (attr & 0x0F)<<3;
-            bool flip_y = (attr & 0x80) != 0;
-            if (flip_y) {
-                ptr += 15*BOMBJACK_FRAMEBUFFER_WIDTH;
-            }
-            // every tile is 32 bytes
-            size_t off = tile_code * 32;
-            for (size_t yy = 0; yy < 16; yy++) {
-                uint16_t bm0 = BOMBJACK_GATHER16(sys->rom_tiles[0], off);
-                uint16_t bm1 = BOMBJACK_GATHER16(sys->rom_tiles[1], off);
-                uint16_t bm2 = BOMBJACK_GATHER16(sys->rom_tiles[2], off);
-                off++;
-                if (yy == 7) {
-                    off += 8;
-                }
-                for (int xx = 15; xx >= 0; xx--) {
-                    uint8_t pen = ((bm2>>xx)&1) | (((bm1>>xx)&1)<<1) | (((bm0>>xx)&1)<<2);
-                    *ptr++ = sys->mainboard.palette[color_block | pen];
-                }
-                ptr += flip_y ? -272 : 240;
+static void _bombjack_init_tile_pens(bombjack_t* sys) {
+    for (size_t tile_code = 0; tile_code < 256; tile_code++) {
+        uint8_t* dst = sys->pens.tiles[tile_code];
+        // every tile is 32 bytes
+        size_t off = tile_code * 32;
+        for (size_t yy = 0; yy < 16; yy++) {
+            uint16_t bm0 = BOMBJACK_GATHER16(sys->rom_tiles[0], off);
+            uint16_t bm1 = BOMBJACK_GATHER16(sys->rom_tiles[1], off);
+            uint16_t bm2 = BOMBJACK_GATHER16(sys->rom_tiles[2], off);
+            off++;
+            if (yy == 7) {
+                off += 8;
             }
-            if (flip_y) {
-                ptr += BOMBJACK_FRAMEBUFFER_WIDTH + 16;
-            }
-            else {
-                ptr -= (16 * BOMBJACK_FRAMEBUFFER_WIDTH) - 16;
+            for (int xx = 15; xx >= 0; xx--) {
+                *dst++ = ((bm2>>xx)&1) | (((bm1>>xx)&1)<<1) | (((bm0>>xx)&1)<<2);
             }
         }
-        ptr += (15 * BOMBJACK_FRAMEBUFFER_WIDTH);
     }
-    CHIPS_ASSERT(ptr == &sys->fb[BOMBJACK_FRAMEBUFFER_WIDTH * BOMBJACK_DISPLAY_HEIGHT]);
+}
+
+// draw the background part of an 8x8 cell into the tile layer
+static void _bombjack_draw_background_cell(bombjack_t* sys, size_t cx, size_t cy) {
+    uint8_t* dst = &sys->tile_layer.pixels[(cy * 8) * BOMBJACK_DISPLAY_WIDTH + cx * 8];
+    if (!sys->dbg.draw_background_layer) {
+        // 0x80: black, 0xFF: keep the previous framebuffer content
+        const uint8_t val = sys->dbg.clear_background_layer ? 0x80 : 0xFF;
+        for (size_t yy = 0; yy < 8; yy++, dst += BOMBJACK_DISPLAY_WIDTH) {
+            memset(dst, val, 8);
+        }
+        return;
+    }
+    uint16_t img_base_addr = (sys->mainboard.bg_image & 7) * 0x0200;
+    bool img_valid = (sys->mainboard.bg_image & 0x10) != 0;
+    size_t addr = img_base_addr + ((cy>>1) * 16 + (cx>>1));
+    // 256 tiles
+    uint8_t tile_code = img_valid ? sys->rom_maps[0][addr] : 0;
+    uint8_t attr = sys->rom_maps[0][addr + 0x0100];
+    uint8_t color_block = (attr & 0x0F)<<3;
+    bool flip_y = (attr & 0x80) != 0;
+    const uint8_t* src = &sys->pens.tiles[tile_code][(cx & 1) * 8];
+    for (size_t yy = 0; yy < 8; yy++, dst += BOMBJACK_DISPLAY_WIDTH) {
+        size_t ty = (cy & 1) * 8 + yy;
+        const uint8_t* pens = &src[(flip_y ? (15 - ty) : ty) * 16];
+        for (size_t xx = 0; xx < 8; xx++) {
+            dst[xx] = color_block | pens[xx];
+        }
+    }
 }
 
 /* render foreground tiles
@@ -790,43 +990,105 @@ static void _bombjack_decode_background(bombjack_t* sys) {
     Only 7 foreground colors are possible, since 0 defines a transparent
     pixel.
 */
-static void _bombjack_decode_foreground(bombjack_t* sys) {
-    uint32_t* ptr = sys->fb;
-    // 32x32 tiles, each 8x8
-    for (size_t y = 0; y < 32; y++) {
-        for (size_t x = 0; x < 32; x++) {
-            size_t addr = y * 32 + x;
+static void _bombjack_init_char_pens(bombjack_t* sys) {
+    for (size_t tile_code = 0; tile_code < 512; tile_code++) {
+        uint8_t* dst = sys->pens.chars[tile_code];
+        // 8 bytes per char bitmap
+        size_t off = tile_code * 8;
+        for (size_t yy = 0; yy < 8; yy++) {
+            /* 3 bit planes per char (8 colors per pixel within
+               the palette color block of the char
+            */
+            uint8_t bm0 = sys->rom_chars[0][off];
+            uint8_t bm1 = sys->rom_chars[1][off];
+            uint8_t bm2 = sys->rom_chars[2][off];
+            off++;
+            for (int xx = 7; xx >= 0; xx--) {
+                *dst++ = ((bm2>>xx)&1) | (((bm1>>xx)&1)<<1) | (((bm0>>xx)&1)<<2);
+            }
+        }
+    }
+}
+
+// draw the foreground part of an 8x8 cell into the tile layer
+static void _bombjack_draw_foreground_cell(bombjack_t* sys, size_t cx, size_t cy, uint8_t chr, uint8_t clr) {
+    // 512 foreground tiles, take 9th bit from color code
+    size_t tile_code = chr | ((clr & 0x10)<<4);
+    // 16 color blocks a 8 colors
+    uint8_t color_block = (clr & 0x0F)<<3;
+    const uint8_t* src = sys->pens.chars[tile_code];
+    uint8_t* dst = &sys->tile_layer.pixels[(cy * 8) * BOMBJACK_DISPLAY_WIDTH + cx * 8];
+    for (size_t yy = 0; yy < 8; yy++, src += 8, dst += BOMBJACK_DISPLAY_WIDTH) {
+        for (size_t xx = 0; xx < 8; xx++) {
+            uint8_t pen = src[xx];
+            if (pen) {
+                dst[xx] = color_block | pen;
+            }
+        }
+    }
+}
+
+/*  Update the combined background/foreground layer.
+
+    The layer is made of 32x32 cells of 8x8 pixels, a cell is only redrawn
+    when its foreground char- or color-code differs from the codes it was
+    last drawn with (or when the background image or debug layer flags
+    have changed). Comparing against the video RAM once per frame instead
+    of catching CPU writes also picks up memory changes from the debugger
+    or snapshot loading.
+
+    The layer holds palette indices, so palette changes don't require a
+    redraw, the layer is converted into the RGBA framebuffer every frame
+    before the sprites are drawn on top.
+*/
+static void _bombjack_update_tile_layer(bombjack_t* sys) {
+    const bool redraw_all = !sys->tile_layer.valid ||
+        (sys->tile_layer.bg_image != sys->mainboard.bg_image) ||
+        (sys->tile_layer.draw_background_layer != sys->dbg.draw_background_layer) ||
+        (sys->tile_layer.draw_foreground_layer != sys->dbg.draw_foreground_layer) ||
+        (sys->tile_layer.clear_background_layer != sys->dbg.clear_background_layer);
+    sys->tile_layer.valid = true;
+    sys->tile_layer.bg_image = sys->mainboard.bg_image;
+    sys->tile_layer.draw_background_layer = sys->dbg.draw_background_layer;
+    sys->tile_layer.draw_foreground_layer = sys->dbg.draw_foreground_layer;
+    sys->tile_layer.clear_background_layer = sys->dbg.clear_background_layer;
+    for (size_t cy = 0; cy < 32; cy++) {
+        for (size_t cx = 0; cx < 32; cx++) {
+            size_t addr = cy * 32 + cx;
             // char codes are at 0x9000, color codes at 0x9400, RAM starts at 0x8000
             uint8_t chr = sys->main_ram[(0x9000-0x8000) + addr];
             uint8_t clr = sys->main_ram[(0x9400-0x8000) + addr];
-            // 512 foreground tiles, take 9th bit from color code
-            size_t tile_code = chr | ((clr & 0x10)<<4);
-            // 16 color blocks a 8 colors
-            size_t color_block = (clr & 0x0F)<<3;
-            // 8 bytes per char bitmap
-            size_t off = tile_code * 8;
-            for (size_t yy = 0; yy < 8; yy++) {
-                /* 3 bit planes per char (8 colors per pixel within
-                   the palette color block of the char
-                */
-                uint8_t bm0 = sys->rom_chars[0][off];
-                uint8_t bm1 = sys->rom_chars[1][off];
-                uint8_t bm2 = sys->rom_chars[2][off];
-                off++;
-                for (int xx = 7; xx >= 0; xx--) {
-                    uint8_t pen = ((bm2>>xx)&1) | (((bm1>>xx)&1)<<1) | (((bm0>>xx)&1)<<2);
-                    if (pen) {
-                        *ptr = sys->mainboard.palette[color_block | pen];
-                    }
-                    ptr++;
-                }
-                ptr += 248;
+            if (!redraw_all && (sys->tile_layer.chr[addr] == chr) && (sys->tile_layer.clr[addr] == clr)) {
+                continue;
+            }
+            sys->tile_layer.chr[addr] = chr;
+            sys->tile_layer.clr[addr] = clr;
+            _bombjack_draw_background_cell(sys, cx, cy);
+            if (sys->dbg.draw_foreground_layer) {
+                _bombjack_draw_foreground_cell(sys, cx, cy, chr, clr);
+            }
+        }
+    }
+    // convert palette indices to RGBA
+    const uint8_t* src = sys->tile_layer.pixels;
+    uint32_t* dst = sys->fb;
+    const uint32_t* palette = sys->mainboard.palette;
+    if (sys->dbg.draw_background_layer) {
+        for (size_t i = 0; i < BOMBJACK_DISPLAY_WIDTH * BOMBJACK_DISPLAY_HEIGHT; i++) {
+            dst[i] = palette[src[i]];
+        }
+    }
+    else {
+        for (size_t i = 0; i < BOMBJACK_DISPLAY_WIDTH * BOMBJACK_DISPLAY_HEIGHT; i++) {
+            uint8_t val = src[i];
+            if (val < 0x80) {
+                dst[i] = palette[val];
+            }
+            else if (val == 0x80) {
+                dst[i] = 0xFF000000;
             }
-            ptr -= (8 * BOMBJACK_FRAMEBUFFER_WIDTH) - 8;
         }
-        ptr += (7 * BOMBJACK_FRAMEBUFFER_WIDTH);
     }
-    CHIPS_ASSERT(ptr == &sys->fb[BOMBJACK_FRAMEBUFFER_WIDTH * BOMBJACK_DISPLAY_HEIGHT]);
 }
 
 /*  render sprites
@@ -846,14 +1108,36 @@ static void _bombjack_decode_foreground(bombjack_t* sys) {
     X:  x pos
     Y:  y pos
 */
-#define BOMBJACK_GATHER32(rom,off) \
-    ((uint32_t)rom[0+off]<<24)|\
-    ((uint32_t)rom[8+off]<<16)|\
-    ((uint32_t)rom[32+off]<<8)|\
-    ((uint32_t)rom[40+off])
+static void _bombjack_init_sprite_pens(bombjack_t* sys) {
+    // 16*16 sprites are decoded like 16x16 background tiles
+    for (size_t sprite_code = 0; sprite_code < 256; sprite_code++) {
+        uint8_t* dst = sys->pens.sprites[sprite_code];
+        size_t off = sprite_code * 32;
+        for (size_t y = 0; y < 16; y++) {
+            uint16_t bm0 = BOMBJACK_GATHER16(sys->rom_sprites[0], off);
+            uint16_t bm1 = BOMBJACK_GATHER16(sys->rom_sprites[1], off);
+            uint16_t bm2 = BOMBJACK_GATHER16(sys->rom_sprites[2], off);
+            off++;
+            if (y == 7) {
+                off += 8;
+            }
+            for (int x = 15; x >= 0; x--) {
+                *dst++ = ((bm2>>x)&1) | (((bm1>>x)&1)<<1) | (((bm0>>x)&1)<<2);
+            }
+        }
+    }
+}
+
+static void _bombjack_init_pens(bombjack_t* sys) {
+    _bombjack_init_tile_pens(sys);
+    _bombjack_init_char_pens(sys);
+    _bombjack_init_sprite_pens(sys);
+    sys->tile_layer.valid = false;
+}
 
 static void _bombjack_decode_sprites(bombjack_t* sys) {
     uint32_t* dst = sys->fb;
+    const uint32_t* palette = sys->mainboard.palette;
     // 24 hardware sprites, sprite 0 has highest priority
     for (int sprite_nr = 23; sprite_nr >= 0; sprite_nr--) {
         // sprite RAM starts at 0x9820, RAM starts at 0x8000
@@ -868,27 +1152,19 @@ static void _bombjack_decode_sprites(bombjack_t* sys) {
         uint8_t px = b3;
         uint8_t sprite_code = b0 & 0x7F;
         if (b0 & 0x80) {
-            // 32x32 'large' sprites (no flip-x/y needed)
+            /* 32x32 'large' sprites (no flip-x/y needed), made of the
+               4 16x16 sprites top-left, top-right, bottom-left, bottom-right
+            */
             uint8_t py = 225 - b2;
             uint32_t* ptr = dst + py*BOMBJACK_FRAMEBUFFER_WIDTH + px;
-            // offset into sprite ROM to gather sprite bitmap pixels
-            size_t off = sprite_code * 128;
             for (size_t y = 0; y < 32; y++) {
-                uint32_t bm0 = BOMBJACK_GATHER32(sys->rom_sprites[0], off);
-                uint32_t bm1 = BOMBJACK_GATHER32(sys->rom_sprites[1], off);
-                uint32_t bm2 = BOMBJACK_GATHER32(sys->rom_sprites[2], off);
-                off++;
-                if ((y & 7) == 7) {
-                    off += 8;
-                }
-                if ((y & 15) == 15) {
-                    off += 32;
-                }
-                for (int x = 31; x >= 0; x--) {
-                    uint8_t pen = ((bm2>>x)&1) | (((bm1>>x)&1)<<1) | (((bm0>>x)&1)<<2);
+                const uint8_t* pens_left = &sys->pens.sprites[(uint8_t)(sprite_code*4 + (y>>4)*2)][(y & 15) * 16];
+                const uint8_t* pens_right = &sys->pens.sprites[(uint8_t)(sprite_code*4 + (y>>4)*2 + 1)][(y & 15) * 16];
+                for (size_t x = 0; x < 32; x++) {
+                    uint8_t pen = (x < 16) ? pens_left[x] : pens_right[x - 16];
                     if (0 != pen) {
                         CHIPS_ASSERT((ptr >= &sys->fb[0]) && (ptr < &sys->fb[BOMBJACK_FRAMEBUFFER_WIDTH*BOMBJACK_FRAMEBUFFER_HEIGHT]));
-                        *ptr = sys->mainboard.palette[color_block | pen];
+                        *ptr = palette[color_block | pen];
                     }
                     ptr++;
                 }
@@ -896,7 +1172,6 @@ static void _bombjack_decode_sprites(bombjack_t* sys) {
             }
         }
         else {
-            // 16*16 sprites are decoded like 16x16 background tiles
             uint8_t py = 241 - b2;
             uint32_t* ptr = dst + py*BOMBJACK_FRAMEBUFFER_WIDTH + px;
             bool flip_x = (b1 & 0x80) != 0;
@@ -904,35 +1179,16 @@ static void _bombjack_decode_sprites(bombjack_t* sys) {
             if (flip_x) {
                 ptr += 16*BOMBJACK_FRAMEBUFFER_WIDTH;
             }
-            // offset into sprite ROM to gather sprite bitmap pixels
-            size_t off = sprite_code * 32;
-            for (size_t y = 0; y < 16; y++) {
-                uint16_t bm0 = BOMBJACK_GATHER16(sys->rom_sprites[0], off);
-                uint16_t bm1 = BOMBJACK_GATHER16(sys->rom_sprites[1], off);
-                uint16_t bm2 = BOMBJACK_GATHER16(sys->rom_sprites[2], off);
-                off++;
-                if (y == 7) {
-                    off += 8;
-                }
-                if (flip_y) {
-                    for (size_t x=0; x<=15; x++) {
-                        uint8_t pen = ((bm2>>x)&1) | (((bm1>>x)&1)<<1) | (((bm0>>x)&1)<<2);
-                        if (0 != pen) {
-                            CHIPS_ASSERT((ptr >= &sys->fb[0]) && (ptr < &sys->fb[BOMBJACK_FRAMEBUFFER_WIDTH*BOMBJACK_FRAMEBUFFER_HEIGHT]));
-                            *ptr = sys->mainboard.palette[color_block | pen];
-                        }
-                        ptr++;
-                    }
-                }
-                else {
-                    for (int x=15; x>=0; x--) {
-                        uint8_t pen = ((bm2>>x)&1) | (((bm1>>x)&1)<<1) | (((bm0>>x)&1)<<2);
-                        if (0 != pen) {
-                            CHIPS_ASSERT((ptr >= &sys->fb[0]) && (ptr < &sys->fb[BOMBJACK_FRAMEBUFFER_WIDTH*BOMBJACK_FRAMEBUFFER_HEIGHT]));
-                            *ptr = sys->mainboard.palette[color_block | pen];
-                        }
-                        ptr++;
+            const size_t xor_x = flip_y ? 15 : 0;
+            const uint8_t* pens = sys->pens.sprites[sprite_code];
+            for (size_t y = 0; y < 16; y++, pens += 16) {
+                for (size_t x = 0; x < 16; x++) {
+                    uint8_t pen = pens[x ^ xor_x];
+                    if (0 != pen) {
+                        CHIPS_ASSERT((ptr >= &sys->fb[0]) && (ptr < &sys->fb[BOMBJACK_FRAMEBUFFER_WIDTH*BOMBJACK_FRAMEBUFFER_HEIGHT]));
+                        *ptr = palette[color_block | pen];
                     }
+                    ptr++;
                 }
                 ptr += flip_x ? -272 : 240;
             }
@@ -941,86 +1197,83 @@ static void _bombjack_decode_sprites(bombjack_t* sys) {
 }
 
 static void _bombjack_decode_video(bombjack_t* sys) {
-    if (sys->dbg.draw_background_layer) {
-        _bombjack_decode_background(sys);
-    }
-    else {
-        if (sys->dbg.clear_background_layer) {
-            for (size_t i = 0; i < BOMBJACK_FRAMEBUFFER_WIDTH*BOMBJACK_DISPLAY_HEIGHT; i++) {
-                sys->fb[i] = 0xFF000000;
-            }
-        }
-    }
-    if (sys->dbg.draw_foreground_layer) {
-        _bombjack_decode_foreground(sys);
-    }
+    _bombjack_update_tile_layer(sys);
     if (sys->dbg.draw_sprite_layer) {
         _bombjack_decode_sprites(sys);
     }
 }
 
-uint32_t bombjack_exec(bombjack_t* sys, uint32_t micro_seconds) {
+uint32_t bombjack_exec_ticks(bombjack_t* sys, uint32_t num_ticks) {
     CHIPS_ASSERT(sys && sys->valid);
-    /* Run the main board and sound board interleaved for half a frame.
-       This simplifies the communication via the sound latch (the main CPU
-       writes a command byte to the sound latch, the sound board reads
-       the command latch in its interrupt service routine.
-
-       The main board issues at most one command per 60Hz frame, but since the
-       host machine is also running at roughly 60 Hz it may happen that the
-       main board writes 2 sound commands per host frame. For this reason
-       run the 2 boards interleaved for half a frame, so it is guaranteed
-       that at most one sound command can be written by the main board
-       before the sound board is ticked (that way we don't need to implement
-       a complicated command queue.
-
-       NOTE: with the new cycle-stepped Z80 we could just as well do
-       a much more finer grained interleaving (e.g. per tick), but this
-       turns out to be quite a bit slower.
+    /* The main board and sound board only communicate through the shared
+       sound latch (the main CPU writes a command byte to the sound latch,
+       the sound board reads the command latch in its interrupt service
+       routine), the NMI of each board is generated locally.
+
+       This means that the boards don't need to run interleaved tick by tick.
+       Instead the main board runs uninterrupted for the whole time slice,
+       and the sound board only needs to catch up with the main board
+       right before the main board writes a new command to the sound latch
+       (see _bombjack_soundboard_sync()), and at the end of the time slice.
+       The main board issues at most one command per 60Hz frame, so both
+       boards usually run in one or two long stretches per frame.
     */
-    const uint32_t slice_us = micro_seconds/2;
-    const uint32_t mb_num_ticks = clk_us_to_ticks(_BOMBJACK_MAINBOARD_FREQUENCY, slice_us);
-    const uint32_t sb_num_ticks = clk_us_to_ticks(_BOMBJACK_SOUNDBOARD_FREQUENCY, slice_us);
-    for (size_t i = 0; i < 2; i++) {
-        // tick the main board for one half frame
-        {
-            uint64_t pins = sys->mainboard.pins;
-            if (0 == sys->dbg.debug.mainboard.callback.func) {
-                // run without debug callback
-                for (uint32_t tick = 0; tick < mb_num_ticks; tick++) {
-                    pins = _bombjack_tick_mainboard(sys, pins);
-                }
-            }
-            else {
-                // run with debug callback
-                for (uint32_t tick = 0; (tick < mb_num_ticks) && !(*sys->dbg.debug.mainboard.stopped); tick++) {
-                    pins = _bombjack_tick_mainboard(sys, pins);
-                    sys->dbg.debug.mainboard.callback.func(sys->dbg.debug.mainboard.callback.user_data, pins);
-                }
-            }
-            sys->mainboard.pins = pins;
-        }
-        // tick the sound board for one half frame
-        {
-            uint64_t pins = sys->soundboard.pins;
-            if (0 == sys->dbg.debug.soundboard.callback.func) {
-                // run without debug callback
-                for (uint32_t tick = 0; tick < sb_num_ticks; tick++) {
-                    pins = _bombjack_tick_soundboard(sys, pins);
-                }
-            }
-            else {
-                // run with debug callback
-                for (uint32_t tick = 0; (tick < sb_num_ticks) && !(*sys->dbg.debug.soundboard.stopped); tick++) {
-                    pins = _bombjack_tick_soundboard(sys, pins);
-                    sys->dbg.debug.soundboard.callback.func(sys->dbg.debug.soundboard.callback.user_data, pins);
-                }
-            }
-            sys->soundboard.pins = pins;
-        }
+    // the sound board runs for the same amount of time, the fractional sound board tick is carried over
+    const uint64_t sb_ticks = ((uint64_t)num_ticks * _BOMBJACK_SOUNDBOARD_FREQUENCY) + sys->sb_tick_frac;
+    sys->sb_tick_frac = (uint32_t)(sb_ticks % _BOMBJACK_MAINBOARD_FREQUENCY);
+    sys->sched.mb_num_ticks = num_ticks;
+    sys->sched.sb_num_ticks = sys->runahead.soundboard_disabled ? 0 : (uint32_t)(sb_ticks / _BOMBJACK_MAINBOARD_FREQUENCY);
+    sys->sched.mb_tick = 0;
+    sys->sched.sb_tick = 0;
+    _bombjack_run_mainboard(sys);
+    _bombjack_run_soundboard(sys, sys->sched.sb_num_ticks);
+    _bombjack_psg_sync(sys);
+    if (!sys->runahead.video_disabled) {
+        _bombjack_decode_video(sys);
+    }
+    return sys->sched.mb_num_ticks + sys->sched.sb_num_ticks;
+}
+
+/* everything in front of the ROM images changes while running, pointers
+   remain valid because the state is restored into the same instance
+*/
+static void _bombjack_runahead_save(bombjack_t* sys) {
+    memcpy(sys->runahead.state, sys, offsetof(bombjack_t, rom_main));
+}
+
+static void _bombjack_runahead_restore(bombjack_t* sys) {
+    memcpy(sys, sys->runahead.state, offsetof(bombjack_t, rom_main));
+}
+
+// run the time slice, followed by the run-ahead frames which only produce video output
+static uint32_t _bombjack_exec(bombjack_t* sys, uint32_t num_ticks) {
+    if ((0 == sys->runahead.num_frames) || sys->dbg.debug.mainboard.callback.func || sys->dbg.debug.soundboard.callback.func || sys->runahead.video_disabled) {
+        return bombjack_exec_ticks(sys, num_ticks);
     }
-    _bombjack_decode_video(sys);
-    return 2 * (mb_num_ticks + sb_num_ticks);
+    sys->runahead.video_disabled = true;
+    const uint32_t res = bombjack_exec_ticks(sys, num_ticks);
+    _bombjack_runahead_save(sys);
+    sys->runahead.soundboard_disabled = true;
+    for (int i = 0; i < sys->runahead.num_frames; i++) {
+        // only the last run-ahead frame needs to be decoded
+        sys->runahead.video_disabled = (i < (sys->runahead.num_frames - 1));
+        bombjack_exec_ticks(sys, (uint32_t)(sys->mainboard.vsync_count + 1));
+    }
+    sys->runahead.soundboard_disabled = false;
+    sys->runahead.video_disabled = false;
+    _bombjack_runahead_restore(sys);
+    return res;
+}
+
+uint32_t bombjack_exec(bombjack_t* sys, uint32_t micro_seconds) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return _bombjack_exec(sys, clk_us_to_ticks_frac(_BOMBJACK_MAINBOARD_FREQUENCY, micro_seconds, &sys->tick_frac));
+}
+
+uint32_t bombjack_exec_frame(bombjack_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    // the VSYNC happens in the main board tick where the vsync counter goes negative
+    return _bombjack_exec(sys, (uint32_t)(sys->mainboard.vsync_count + 1));
 }
 
 chips_display_info_t bombjack_display_info(bombjack_t* sys) {
@@ -1048,9 +1301,19 @@ chips_display_info_t bombjack_display_info(bombjack_t* sys) {
     return res;
 }
 
+void bombjack_enable_video(bombjack_t* sys, bool enabled) {
+    CHIPS_ASSERT(sys && sys->valid);
+    sys->runahead.video_disabled = !enabled;
+}
+
+bool bombjack_video_enabled(bombjack_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return !sys->runahead.video_disabled;
+}
+
 uint32_t bombjack_save_snapshot(bombjack_t* sys, bombjack_t* dst) {
     CHIPS_ASSERT(sys && dst);
-    *dst = *sys;
+    memcpy(dst, sys, BOMBJACK_SNAPSHOT_SIZE);
     chips_debug_snapshot_onsave(&dst->dbg.debug.mainboard);
     chips_debug_snapshot_onsave(&dst->dbg.debug.soundboard);
     chips_audio_callback_snapshot_onsave(&dst->audio.callback);
@@ -1068,7 +1331,7 @@ bool bombjack_load_snapshot(bombjack_t* sys, uint32_t version, bombjack_t* src)
         return false;
     }
     static bombjack_t im;
-    im = *src;
+    memcpy(&im, src, BOMBJACK_SNAPSHOT_SIZE);
     chips_debug_snapshot_onload(&im.dbg.debug.mainboard, &sys->dbg.debug.mainboard);
     chips_debug_snapshot_onload(&im.dbg.debug.soundboard, &sys->dbg.debug.soundboard);
     chips_audio_callback_snapshot_onload(&im.audio.callback, &sys->audio.callback);
@@ -1077,7 +1340,8 @@ bool bombjack_load_snapshot(bombjack_t* sys, uint32_t version, bombjack_t* src)
     }
     mem_snapshot_onload(&im.mainboard.mem, sys);
     mem_snapshot_onload(&im.soundboard.mem, sys);
-    *sys = im;
+    memcpy(sys, &im, BOMBJACK_SNAPSHOT_SIZE);
+    _bombjack_init_pens(sys);
     return true;
 }
 
@@ -67,6 +67,23 @@
     The motor may also be switched on/off by the computer system through
     the cassette port's MOTOR pin.
 
+    ## Borrowed Tape Images
+
+    By default c1530_insert_tape() copies the tape data into a buffer
+    inside c1530_t (C1530_MAX_TAPE_SIZE bytes). To share one tape image
+    between many instances instead, define:
+
+    ~~~C
+    #define C1530_BORROWED_DATA
+    ~~~
+
+    ...before including c1530.h (this changes the layout of c1530_t and
+    must be the same in all files). c1530_insert_tape() then only keeps a
+    pointer into the caller-owned .TAP data (which may be memory-mapped), the
+    data must remain valid and unchanged until the tape is removed. Snapshots
+    don't contain the tape data, after loading a snapshot the same tape
+    must be inserted in the target c1530_t.
+
     ## zlib/libpng license
 
     Copyright (c) 2019 Andre Weissflog
@@ -115,7 +132,11 @@ typedef struct {
     uint32_t size;      /* tape_size > 0: a tape is inserted */
     uint32_t pos;
     uint32_t pulse_count;
+#if defined(C1530_BORROWED_DATA)
+    const uint8_t* buf; /* borrowed tape data (after the .TAP header) */
+#else
     uint8_t buf[C1530_MAX_TAPE_SIZE];
+#endif
 } c1530_t;
 
 /* initialize a c1530_t instance */
@@ -205,10 +226,14 @@ bool c1530_insert_tape(c1530_t* sys, chips_range_t data) {
     if (data.size < (hdr->size + sizeof(_c1530_tap_header))) {
         return false;
     }
-    if (data.size > sizeof(sys->buf)) {
+    if (data.size > C1530_MAX_TAPE_SIZE) {
         return false;
     }
-    memcpy(sys->buf, ptr, hdr->size);
+    #if defined(C1530_BORROWED_DATA)
+        sys->buf = ptr;
+    #else
+        memcpy(sys->buf, ptr, hdr->size);
+    #endif
     sys->size = hdr->size;
     sys->pos = 0;
     sys->pulse_count = 0;
@@ -238,6 +263,9 @@ void c1530_remove_tape(c1530_t* sys) {
     sys->size = 0;
     sys->pos = 0;
     sys->pulse_count = 0;
+    #if defined(C1530_BORROWED_DATA)
+        sys->buf = 0;
+    #endif
 }
 
 bool c1530_tape_inserted(c1530_t* sys) {
@@ -245,16 +273,22 @@ bool c1530_tape_inserted(c1530_t* sys) {
     return sys->size > 0;
 }
 
+/* read the next tape byte, zero past the end of the tape data */
+static inline uint8_t _c1530_next_byte(c1530_t* sys) {
+    const uint32_t pos = sys->pos++;
+    return (pos < sys->size) ? sys->buf[pos] : 0;
+}
+
 void c1530_tick(c1530_t* sys) {
     CHIPS_ASSERT(sys && sys->valid);
     *sys->cas_port &= ~C1530_CASPORT_READ;
     if (c1530_is_motor_on(sys) && (sys->size > 0) && (sys->pos <= sys->size)) {
         if (sys->pulse_count == 0) {
-            uint8_t val = sys->buf[sys->pos++];
+            uint8_t val = _c1530_next_byte(sys);
             if (val == 0) {
                 uint8_t s[3];
                 for (int i = 0; i < 3; i++) {
-                    s[i] = sys->buf[sys->pos++];
+                    s[i] = _c1530_next_byte(sys);
                 }
                 sys->pulse_count = (s[2]<<16) | (s[1]<<8) | s[0];
             }
@@ -272,11 +306,27 @@ void c1530_tick(c1530_t* sys) {
 void c1530_snapshot_onsave(c1530_t* snapshot) {
     CHIPS_ASSERT(snapshot);
     snapshot->cas_port = 0;
+    #if defined(C1530_BORROWED_DATA)
+        snapshot->buf = 0;
+    #endif
 }
 
 void c1530_snapshot_onload(c1530_t* snapshot, c1530_t* sys) {
     CHIPS_ASSERT(snapshot && sys);
     snapshot->cas_port = sys->cas_port;
+    #if defined(C1530_BORROWED_DATA)
+        // the borrowed tape data is taken from the target c1530_t
+        if ((snapshot->size > 0) && (snapshot->size == sys->size)) {
+            snapshot->buf = sys->buf;
+        }
+        else {
+            // the tape isn't available, remove it
+            snapshot->buf = 0;
+            snapshot->size = 0;
+            snapshot->pos = 0;
+            snapshot->pulse_count = 0;
+        }
+    #endif
 }
 
 #endif /* CHIPS_IMPL */
@@ -18,12 +18,145 @@
     ~~~
         your own assert macro (default: assert(c))
 
-    You need to include the following headers before including c64.h:
+    ~~~C
+    C1541_BORROWED_DATA
+    ~~~
+        if defined, c1541_insert_disc() doesn't copy the .D64 image into
+        c1541_t but keeps a pointer to it, the disc data must then remain
+        valid and unchanged until the disc is removed, snapshots don't
+        contain the disc data, must be the same for all files which
+        include c1541.h
+
+    ~~~C
+    C1541_BORROWED_ROMS
+    ~~~
+        if defined, c1541_init() doesn't copy the ROM images into c1541_t
+        but keeps pointers to the ROM data in c1541_desc_t.roms, the ROM
+        data must remain valid and unchanged until c1541_discard() is called,
+        snapshots don't contain the ROMs, must be the same for all files
+        which include c1541.h
+
+    You need to include the following headers before including c1541.h:
 
     - chips/chips_common.h
+    - chips/mem.h
     - chips/m6502.h
     - chips/m6522.h
-    - chips/mem.h
+
+    If chips/mem.h is included before chips/m6502.h, c1541_link_exec()
+    runs most instructions through m6502_exec_op_fast() (see
+    'Instruction-Stepped Execution' below).
+
+    ## Emulated Hardware
+
+    The drive CPU runs the original 1541 DOS ROM at 1 MHz, VIA-1 at
+    0x1800 is connected to the IEC serial bus, VIA-2 at 0x1C00 is connected
+    to the disc drive mechanics:
+
+    VIA-1 port B:
+        - PB0: in: DATA line (1: line is pulled low)
+        - PB1: out: pull the DATA line low
+        - PB2: in: CLK line (1: line is pulled low)
+        - PB3: out: pull the CLK line low
+        - PB4: out: ATN acknowledge (the DATA line is pulled low while ATN
+          and ATNA don't match)
+        - PB5..6: in: device address jumpers (device 8)
+        - PB7: in: ATN line (1: line is pulled low)
+        - CA1: in: ATN line (1: line is pulled low)
+
+    VIA-2:
+        - PA0..7: in: GCR byte under the read head
+        - PB0..1: out: stepper motor phase (moves the head by half tracks)
+        - PB2: out: spindle motor on
+        - PB3: out: drive LED
+        - PB4: in: write protect sensor (0: write protected)
+        - PB5..6: out: bit rate (speed zone)
+        - PB7: in: SYNC detected (0: sync)
+        - CA1: in: BYTE READY (also sets the CPU overflow flag while CA2 is high)
+        - CA2: out: SOE (enable BYTE READY on the CPU overflow flag)
+        - CB2: out: read/write mode (1: read)
+
+    The IEC bus is an open-collector bus, the computer writes the lines it
+    pulls low into the byte pointed to by c1541_desc_t.iec_port
+    (C1541_IECPORT_*), and finds the lines pulled low by the drive in
+    c1541_t.iec_out.
+
+    ## Disc Images
+
+    .D64 disc images with 35, 40 or 42 tracks (with or without error info
+    bytes) can be inserted with c1541_insert_disc(). The disc image is
+    converted into a GCR-encoded bit stream one track at a time when the
+    read head moves onto a track, so the DOS ROM reads the disc through
+    the same sync-mark and GCR-decoding code as on a real drive.
+
+    Inserted discs are read-only: the write protect sensor always reports
+    a write protected disc, the error info bytes of a .D64 file are ignored.
+
+    ## Idle Sleep
+
+    Most of the time the drive CPU spins in a polling loop in the DOS ROM,
+    waiting for the next ATN interrupt from the IEC bus or the next
+    job-loop timer interrupt. When the CPU returns to the start of a loop
+    without any change in its registers and memory, and without accessing
+    any VIA register which may change on its own (the timer and interrupt
+    flag registers), the loop will repeat unchanged until the next
+    interrupt. In this case the CPU is put to sleep until one of the
+    VIAs asserts the IRQ line or the computer changes the IEC bus lines,
+    only the VIAs are ticked in the meantime (the spindle motor must be
+    off for the drive to go to sleep).
+
+    This means an interrupt is always taken at the start of the idle loop,
+    which shifts the interrupt by at most the duration of one loop
+    iteration. Set c1541_desc_t.idle_sleep_disabled to true to always run
+    the drive CPU (for instance when running timing-sensitive fast loaders).
+
+    ## Drive Thread
+
+    The drive can be ticked on a separate thread, in parallel to the
+    computer, by connecting both sides through a c1541_link_t instead of
+    a shared iec_port byte. The link exchanges the IEC lines in quanta of
+    'num_ticks' ticks (C1541_LINK_DEFAULT_TICKS by default, at most
+    C1541_LINK_MAX_TICKS): while one quantum is running on both sides, each
+    side sees the lines the other side has pulled low in the same tick of
+    the previous quantum, and a side only waits for the other at the start
+    of a quantum. This adds a fixed latency of 'num_ticks' ticks to all
+    IEC bus line changes, but the result doesn't depend on the timing of
+    the two threads, so the emulation remains deterministic.
+
+    - the computer calls c1541_link_tick() once per tick with the lines it
+      pulls low, and gets the lines pulled low by the drive
+    - the drive thread calls c1541_link_exec(), which ticks the drive for
+      all quanta it is allowed to run ahead and returns the number of
+      executed ticks (0 if the drive has to wait for the computer)
+
+    The KERNAL serial bus routines and the DOS ROM tolerate this latency,
+    but fast loaders which count cycles between bus transfers usually don't,
+    use a small number of ticks or no drive thread for those.
+
+    c1541_link_init() connects the link to a drive and resynchronizes both
+    sides, this must also be called after resetting the drive or loading a
+    snapshot. All functions which access the c1541_t (including
+    c1541_link_init(), snapshots and inserting or removing discs) must only
+    be called while the drive thread is not inside c1541_link_exec().
+
+    ## Instruction-Stepped Execution
+
+    When M6502_HAS_EXEC is defined (see m6502.h), c1541_link_exec() runs
+    complete instructions with m6502_exec_op_fast() and then advances the
+    drive mechanics and VIAs over all ticks of the instruction at once
+    (see m6522_tick_idle()). This only happens while the result is the
+    same as with c1541_tick():
+
+    - the instruction doesn't access the VIAs
+    - both VIAs are idle and the computer doesn't change the IEC lines
+      during the instruction (so that the VIA outputs and the IRQ pin
+      can't change)
+    - no byte arrives under the read head during the instruction (so that
+      BYTE READY can't set the CPU overflow flag)
+    - the instruction doesn't write to memory while idle loop detection
+      must see the memory writes (see 'Idle Sleep')
+
+    c1541_tick() always runs the CPU tick by tick.
 
     ## zlib/libpng license
 
@@ -46,6 +179,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdalign.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -60,10 +194,20 @@ extern "C" {
 
 #define C1541_FREQUENCY (1000000)
 
+#define C1541_MAX_TRACKS (42)                   // max number of tracks on a disc
+#define C1541_MAX_HALF_TRACKS (C1541_MAX_TRACKS * 2)
+#define C1541_MAX_GCR_TRACK_SIZE (7692)         // size in bytes of a GCR-encoded track in speed zone 3
+#define C1541_MAX_DISC_SIZE (802 * 256 + 802)   // 42 tracks .D64 with error info
+#define C1541_IDLE_MAX_LOOP_TICKS (256)         // max length of an idle loop which puts the drive CPU to sleep
+#define C1541_LINK_DEFAULT_TICKS (16)           // default IEC bus latency in ticks with a drive thread (see "Drive Thread")
+#define C1541_LINK_MAX_TICKS (256)              // max IEC bus latency in ticks with a drive thread
+
 // config params for c1541_init()
 typedef struct {
-    // pointer to a shared byte with IEC serial bus line state
+    // pointer to a shared byte with the IEC serial bus lines pulled low by the computer (C1541_IECPORT_*)
     uint8_t* iec_port;
+    // true to keep running the drive CPU in its idle loop (see "Idle Sleep")
+    bool idle_sleep_disabled;
     // rom images
     struct {
         chips_range_t c000_dfff;
@@ -75,15 +219,70 @@ typedef struct {
 typedef struct {
     uint64_t pins;
     uint8_t* iec;
+    uint8_t iec_out;        // IEC bus lines pulled low by the drive (C1541_IECPORT_*)
+    uint8_t iec_in;         // IEC bus lines pulled low by the computer in the last tick
     m6502_t cpu;
     m6522_t via_1;
     m6522_t via_2;
     bool valid;
     mem_t mem;
+    // disc drive mechanics
+    struct {
+        bool motor_on;
+        bool led_on;
+        bool sync;              // read head is over a sync mark
+        bool byte_ready;        // a new byte has arrived under the read head in this tick
+        uint8_t stepper;        // current stepper motor phase
+        uint8_t data;           // last byte read completely (VIA-2 port A input)
+        uint8_t shift;          // byte currently passing under the read head
+        int half_track;         // read head position (0 is track 1)
+        int byte_ticks;         // ticks until the next byte arrives under the read head
+        int pos;                // read position in track data
+        int track_size;         // size of the GCR track data under the read head, 0 if no data
+        uint8_t track[C1541_MAX_GCR_TRACK_SIZE];
+    } drive;
+    // inserted .D64 disc image
+    struct {
+        int size;               // > 0 if a disc is inserted
+        int num_tracks;
+        #if defined(C1541_BORROWED_DATA)
+        const uint8_t* data;    // borrowed disc data, not part of snapshots
+        #else
+        uint8_t data[C1541_MAX_DISC_SIZE];
+        #endif
+    } disc;
+    // idle loop detection (see "Idle Sleep")
+    struct {
+        bool disabled;
+        bool sleeping;
+        bool dirty;             // loop has changed state since loop_pc
+        uint16_t loop_pc;       // start address of the current loop candidate
+        uint16_t last_pc;       // address of the last instruction fetch
+        uint8_t regs[5];        // A, X, Y, S, P at loop_pc
+        uint32_t loop_ticks;    // ticks since loop_pc
+    } idle;
     uint8_t ram[0x0800];
+    #if defined(C1541_BORROWED_ROMS)
+    const uint8_t* rom[2];      // borrowed ROM images at 0xC000 and 0xE000, not part of snapshots
+    #else
     uint8_t rom[0x4000];
+    #endif
 } c1541_t;
 
+// IEC bus exchange between the computer and a drive thread (see "Drive Thread")
+typedef struct {
+    uint32_t num_ticks;     // ticks per quantum, this is also the bus latency
+    // only written by the computer's thread
+    alignas(64) uint32_t host_quantum;      // number of quanta completed by the computer
+    uint32_t host_tick;                     // tick in the computer's current quantum
+    uint32_t stalls;                        // number of times the computer waited for the drive thread
+    uint8_t host_lines[2][C1541_LINK_MAX_TICKS];    // IEC lines pulled low by the computer in the last two quanta
+    // only written by the drive thread
+    alignas(64) uint32_t drive_quantum;     // number of quanta completed by the drive
+    uint8_t drive_in;                       // IEC lines pulled low by the computer in the drive's current tick
+    uint8_t drive_lines[2][C1541_LINK_MAX_TICKS];   // IEC lines pulled low by the drive in the last two quanta
+} c1541_link_t;
+
 // initialize a new c1541_t instance
 void c1541_init(c1541_t* sys, const c1541_desc_t* desc);
 // discard a c1541_t instance
@@ -93,9 +292,19 @@ void c1541_reset(c1541_t* sys);
 // tick a c1541_t instance forward
 void c1541_tick(c1541_t* sys);
 // insert a disc image file (.d64)
-void c1541_insert_disc(c1541_t* sys, chips_range_t data);
+bool c1541_insert_disc(c1541_t* sys, chips_range_t data);
 // remove current disc
 void c1541_remove_disc(c1541_t* sys);
+// return true if a disc is inserted
+bool c1541_disc_inserted(c1541_t* sys);
+// return true if the drive CPU is currently sleeping in its idle loop
+bool c1541_is_sleeping(c1541_t* sys);
+// connect a drive to a link and resync both sides, iec_lines are the lines currently pulled low by the computer
+void c1541_link_init(c1541_link_t* link, c1541_t* sys, uint32_t num_ticks, uint8_t iec_lines);
+// computer's thread: exchange the IEC lines once per tick, returns the lines pulled low by the drive
+uint8_t c1541_link_tick(c1541_link_t* link, uint8_t iec_lines);
+// drive thread: run the drive as far as allowed by the computer, returns number of ticks executed
+uint32_t c1541_link_exec(c1541_link_t* link, c1541_t* sys);
 // prepare a c1541_t snapshot for saving
 void c1541_snapshot_onsave(c1541_t* snapshot, void* base);
 // prepare a c1541_t snapshot for loading
@@ -113,17 +322,39 @@ void c1541_snapshot_onload(c1541_t* snapshot, c1541_t* sys, void* base);
     #define CHIPS_ASSERT(c) assert(c)
 #endif
 
+static void _c1541_load_track(c1541_t* sys);
+
+// map RAM and ROMs into a memory map, pointers are taken from sys
+static void _c1541_map_memory(mem_t* mem, c1541_t* sys) {
+    mem_map_ram(mem, 0, 0x0000, 0x0800, sys->ram);
+    #if defined(C1541_BORROWED_ROMS)
+        mem_map_rom(mem, 0, 0xC000, 0x2000, sys->rom[0]);
+        mem_map_rom(mem, 0, 0xE000, 0x2000, sys->rom[1]);
+    #else
+        mem_map_rom(mem, 0, 0xC000, 0x4000, sys->rom);
+    #endif
+}
+
 void c1541_init(c1541_t* sys, const c1541_desc_t* desc) {
     CHIPS_ASSERT(sys && desc);
+    CHIPS_ASSERT(desc->iec_port);
 
     memset(sys, 0, sizeof(c1541_t));
     sys->valid = true;
+    sys->iec = desc->iec_port;
+    sys->idle.disabled = desc->idle_sleep_disabled;
+    sys->drive.half_track = 34;    // track 18
 
     // copy ROM images
     CHIPS_ASSERT(desc->roms.c000_dfff.ptr && (0x2000 == desc->roms.c000_dfff.size));
     CHIPS_ASSERT(desc->roms.e000_ffff.ptr && (0x2000 == desc->roms.e000_ffff.size));
-    memcpy(&sys->rom[0x0000], desc->roms.c000_dfff.ptr, 0x2000);
-    memcpy(&sys->rom[0x2000], desc->roms.e000_ffff.ptr, 0x2000);
+    #if defined(C1541_BORROWED_ROMS)
+        sys->rom[0] = (const uint8_t*) desc->roms.c000_dfff.ptr;
+        sys->rom[1] = (const uint8_t*) desc->roms.e000_ffff.ptr;
+    #else
+        memcpy(&sys->rom[0x0000], desc->roms.c000_dfff.ptr, 0x2000);
+        memcpy(&sys->rom[0x2000], desc->roms.e000_ffff.ptr, 0x2000);
+    #endif
 
     // initialize the hardware
     m6502_desc_t cpu_desc;
@@ -134,8 +365,7 @@ void c1541_init(c1541_t* sys, const c1541_desc_t* desc) {
 
     // setup memory map
     mem_init(&sys->mem);
-    mem_map_ram(&sys->mem, 0, 0x0000, 0x0800, sys->ram);
-    mem_map_rom(&sys->mem, 0, 0xC000, 0x4000, sys->rom);
+    _c1541_map_memory(&sys->mem, sys);
 }
 
 void c1541_discard(c1541_t* sys) {
@@ -148,40 +378,582 @@ void c1541_reset(c1541_t* sys) {
     sys->pins |= M6502_RES;
     m6522_reset(&sys->via_1);
     m6522_reset(&sys->via_2);
+    sys->idle.sleeping = false;
+    sys->idle.dirty = true;
+}
+
+// check if the CPU has completed a loop without any state changes
+static void _c1541_idle_check(c1541_t* sys, uint16_t pc) {
+    const m6502_t* cpu = &sys->cpu;
+    const uint8_t regs[5] = { cpu->A, cpu->X, cpu->Y, cpu->S, cpu->P };
+    if (pc == sys->idle.loop_pc) {
+        if (!sys->idle.dirty &&
+            (sys->idle.loop_ticks <= C1541_IDLE_MAX_LOOP_TICKS) &&
+            (0 == memcmp(regs, sys->idle.regs, sizeof(regs))) &&
+            !sys->drive.motor_on &&
+            !(sys->pins & (M6502_IRQ|M6502_RES)))
+        {
+            sys->idle.sleeping = true;
+            return;
+        }
+    }
+    else if (pc >= sys->idle.last_pc) {
+        // not a backward jump, not a new loop candidate
+        sys->idle.last_pc = pc;
+        return;
+    }
+    // start a new loop iteration
+    sys->idle.last_pc = pc;
+    sys->idle.loop_pc = pc;
+    sys->idle.loop_ticks = 0;
+    sys->idle.dirty = false;
+    memcpy(sys->idle.regs, regs, sizeof(regs));
+}
+
+// VIA registers which can be read in an idle loop because they don't change on their own
+static inline bool _c1541_idle_via_reg(uint16_t addr) {
+    switch (addr & 0x0F) {
+        case M6522_REG_RB: case M6522_REG_RA: case M6522_REG_DDRB: case M6522_REG_DDRA:
+        case M6522_REG_ACR: case M6522_REG_PCR: case M6522_REG_IER: case M6522_REG_RA_NOH:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// move the disc under the read head
+static void _c1541_tick_drive(c1541_t* sys) {
+    sys->drive.byte_ready = false;
+    if (!sys->drive.motor_on || (0 == sys->drive.track_size)) {
+        return;
+    }
+    if (--sys->drive.byte_ticks <= 0) {
+        // the bit rate is selected by VIA-2 PB5..6 (26, 28, 30 or 32 cycles per byte)
+        const uint8_t zone = (sys->via_2.pb.pins >> 5) & 3;
+        sys->drive.byte_ticks = 32 - 2 * zone;
+        const uint8_t last = sys->drive.data;
+        sys->drive.data = sys->drive.shift;
+        sys->drive.shift = sys->drive.track[sys->drive.pos];
+        if (++sys->drive.pos >= sys->drive.track_size) {
+            sys->drive.pos = 0;
+        }
+        /* a sync mark is a run of at least 10 one-bits, which never appear in
+           GCR data, the first byte after a sync mark is complete one byte
+           time after the SYNC signal goes off, bytes inside a sync mark
+           don't signal BYTE READY
+        */
+        const bool read_mode = 0 != (sys->via_2.pins & M6522_CB2);
+        sys->drive.sync = read_mode && (0xFF == sys->drive.data) && (0xFF == sys->drive.shift);
+        sys->drive.byte_ready = !(read_mode && (0xFF == last) && (0xFF == sys->drive.data));
+    }
+}
+
+// VIA-1 input pins from the IEC bus
+static inline uint64_t _c1541_via1_inputs(uint8_t iec_bus) {
+    uint64_t pins = 0;
+    uint8_t pb = 0;
+    if (iec_bus & C1541_IECPORT_DATA) {
+        pb |= (1<<0);
+    }
+    if (iec_bus & C1541_IECPORT_CLK) {
+        pb |= (1<<2);
+    }
+    if (iec_bus & C1541_IECPORT_ATN) {
+        pb |= (1<<7);
+        pins |= M6522_CA1;
+    }
+    M6522_SET_PAB(pins, 0xFF, pb);
+    return pins;
+}
+
+// VIA-2 input pins from the disc drive (BYTE READY is handled by the caller)
+static inline uint64_t _c1541_via2_inputs(const c1541_t* sys) {
+    uint64_t pins = 0;
+    uint8_t pb = 0;
+    if (0 == sys->disc.size) {
+        // no disc, the write protect sensor isn't covered
+        pb |= (1<<4);
+    }
+    if (!sys->drive.sync) {
+        pb |= (1<<7);
+    }
+    M6522_SET_PAB(pins, sys->drive.data, pb);
+    return pins;
+}
+
+// tick the drive mechanics and VIAs, the CPU side of the tick is already done
+static void _c1541_tick_io(c1541_t* sys, uint64_t pins, uint64_t via1_pins, uint64_t via2_pins) {
+    // the IEC bus lines pulled low by the computer
+    const uint8_t iec_in = *sys->iec;
+    if (iec_in != sys->iec_in) {
+        sys->iec_in = iec_in;
+        sys->idle.dirty = true;
+        sys->idle.sleeping = false;
+    }
+    const uint8_t iec_bus = iec_in | sys->iec_out;
+
+    // tick the disc mechanics
+    _c1541_tick_drive(sys);
+
+    // tick VIA-1 (IEC bus)
+    {
+        via1_pins |= _c1541_via1_inputs(iec_bus);
+        via1_pins = m6522_tick_sched(&sys->via_1, via1_pins);
+        const uint8_t pb_out = M6522_GET_PB(via1_pins);
+        uint8_t iec_out = 0;
+        if (pb_out & (1<<1)) {
+            iec_out |= C1541_IECPORT_DATA;
+        }
+        if (pb_out & (1<<3)) {
+            iec_out |= C1541_IECPORT_CLK;
+        }
+        // ATN acknowledge logic
+        if ((0 != (iec_bus & C1541_IECPORT_ATN)) != (0 != (pb_out & (1<<4)))) {
+            iec_out |= C1541_IECPORT_DATA;
+        }
+        sys->iec_out = iec_out;
+        if ((via1_pins & (M6522_CS1|M6522_RW)) == (M6522_CS1|M6522_RW)) {
+            pins = M6502_COPY_DATA(pins, via1_pins);
+        }
+    }
+
+    // tick VIA-2 (disc drive)
+    {
+        via2_pins |= _c1541_via2_inputs(sys);
+        if (!sys->drive.byte_ready) {
+            via2_pins |= M6522_CA1;
+        }
+        else if (sys->via_2.pins & M6522_CA2) {
+            // BYTE READY is connected to the CPU SO pin
+            sys->cpu.P |= M6502_VF;
+        }
+        via2_pins = m6522_tick_sched(&sys->via_2, via2_pins);
+        const uint8_t pb_out = M6522_GET_PB(via2_pins);
+        sys->drive.motor_on = 0 != (pb_out & (1<<2));
+        sys->drive.led_on = 0 != (pb_out & (1<<3));
+        // stepper motor, each phase change moves the head by a half track
+        const uint8_t stepper = pb_out & 3;
+        if (stepper != sys->drive.stepper) {
+            int half_track = sys->drive.half_track;
+            if (stepper == ((sys->drive.stepper + 1) & 3)) {
+                half_track++;
+            }
+            else if (stepper == ((sys->drive.stepper - 1) & 3)) {
+                half_track--;
+            }
+            sys->drive.stepper = stepper;
+            if (half_track < 0) {
+                half_track = 0;
+            }
+            else if (half_track >= C1541_MAX_HALF_TRACKS) {
+                half_track = C1541_MAX_HALF_TRACKS - 1;
+            }
+            if (half_track != sys->drive.half_track) {
+                sys->drive.half_track = half_track;
+                _c1541_load_track(sys);
+            }
+        }
+        if ((via2_pins & (M6522_CS1|M6522_RW)) == (M6522_CS1|M6522_RW)) {
+            pins = M6502_COPY_DATA(pins, via2_pins);
+        }
+    }
+
+    // both VIA IRQ pins are connected to the CPU IRQ pin
+    pins &= ~M6502_IRQ;
+    if ((via1_pins | via2_pins) & M6522_IRQ) {
+        pins |= M6502_IRQ;
+        sys->idle.sleeping = false;
+    }
+    sys->pins = pins;
 }
 
 void c1541_tick(c1541_t* sys) {
     uint64_t pins = sys->pins;
+    uint64_t via1_pins = 0;
+    uint64_t via2_pins = 0;
+
+    // tick the CPU, unless it is sleeping in an idle loop
+    if (!sys->idle.sleeping) {
+        pins = m6502_tick(&sys->cpu, pins);
+        const uint16_t addr = M6502_GET_ADDR(pins);
+        if (pins & M6502_SYNC) {
+            if (!sys->idle.disabled) {
+                _c1541_idle_check(sys, addr);
+            }
+        }
+        sys->idle.loop_ticks++;
+        via1_pins = via2_pins = pins & M6502_PIN_MASK;
+        /* address decoding:
+            0000..07FF: RAM (mirrored up to 17FF)
+            1800..1BFF: VIA-1 (mirrored)
+            1C00..1FFF: VIA-2 (mirrored)
+            C000..FFFF: ROM
+        */
+        if ((addr & 0x9800) == 0x1800) {
+            if (addr & 0x0400) {
+                via2_pins |= M6522_CS1;
+            }
+            else {
+                via1_pins |= M6522_CS1;
+            }
+            if (!((pins & M6502_RW) && _c1541_idle_via_reg(addr))) {
+                sys->idle.dirty = true;
+            }
+        }
+        else if (pins & M6502_RW) {
+            M6502_SET_DATA(pins, mem_rd(&sys->mem, addr));
+        }
+        else {
+            const uint8_t data = M6502_GET_DATA(pins);
+            if (mem_rd(&sys->mem, addr) != data) {
+                sys->idle.dirty = true;
+            }
+            mem_wr(&sys->mem, addr, data);
+        }
+    }
+    _c1541_tick_io(sys, pins, via1_pins, via2_pins);
+}
 
-    pins = m6502_tick(&sys->cpu, pins);
-    const uint16_t addr = M6502_GET_ADDR(pins);
+#if defined(M6502_HAS_EXEC)
+// the VIA address ranges (including mirrors) in MEM_PAGE_SIZE pages
+static uint64_t _c1541_io_pages(void) {
+    uint64_t pages = 0;
+    for (uint32_t addr = 0x1800; addr < 0x8000; addr += 0x2000) {
+        pages |= 1ULL << (addr >> MEM_PAGE_SHIFT);
+        pages |= 1ULL << ((addr + 0x0400) >> MEM_PAGE_SHIFT);
+    }
+    return pages;
+}
+
+// true if an instruction may write to memory (including stack pushes)
+static inline bool _c1541_op_writes_mem(uint8_t op) {
+    switch (op & 3) {
+        case 1: return (op & 0xE0) == 0x80;
+        case 2: return (op & 4) && ((op & 0xE0) != 0xA0);
+        default:
+            return (op == 0x08) || (op == 0x20) || (op == 0x48) || (op == 0x84) || (op == 0x8C) || (op == 0x94);
+    }
+}
 
-    if (pins & M6502_RW) {
-        M6502_SET_DATA(pins, mem_rd(&sys->mem, addr));
+/* run a complete instruction with m6502_exec_op_fast() while the drive
+   mechanics and both VIAs are idle, and skip the other chips over the
+   instruction's ticks at once (see 'Instruction-Stepped Execution'), 'in'
+   are the IEC lines pulled low by the computer in the next 'num_ticks'
+   ticks, returns 0 if the next instruction must be run with c1541_tick()
+*/
+static uint32_t _c1541_link_exec_op(c1541_link_t* link, c1541_t* sys, const m6502_exec_t* ex, const uint8_t* in, uint8_t* out, uint32_t num_ticks) {
+    uint64_t pins = sys->pins;
+    if (sys->idle.sleeping || (0 == (pins & M6502_SYNC)) || (num_ticks < M6502_EXEC_OP_MAX_TICKS)) {
+        return 0;
+    }
+    // no byte may arrive under the read head (BYTE READY would set the CPU overflow flag)
+    if (sys->drive.byte_ready ||
+        (sys->drive.motor_on && (sys->drive.track_size > 0) && (sys->drive.byte_ticks <= M6502_EXEC_OP_MAX_TICKS)))
+    {
+        return 0;
+    }
+    // the IEC lines and the VIA input pins must not change, so that the VIA outputs (and IRQ) don't change
+    for (uint32_t i = 0; i < M6502_EXEC_OP_MAX_TICKS; i++) {
+        if (in[i] != sys->iec_in) {
+            return 0;
+        }
+    }
+    const uint64_t via1_pins = _c1541_via1_inputs(sys->iec_in | sys->iec_out);
+    const uint64_t via2_pins = _c1541_via2_inputs(sys) | M6522_CA1;
+    if (!m6522_is_idle(&sys->via_1, via1_pins, M6502_EXEC_OP_MAX_TICKS) ||
+        !m6522_is_idle(&sys->via_2, via2_pins, M6502_EXEC_OP_MAX_TICKS))
+    {
+        return 0;
+    }
+    // memory writes must go through c1541_tick() while they may end an idle loop candidate
+    if (!sys->idle.disabled && !sys->idle.dirty && _c1541_op_writes_mem(M6502_GET_DATA(pins))) {
+        return 0;
+    }
+    const uint32_t op_ticks = m6502_exec_op_fast(&sys->cpu, ex, &pins);
+    if (op_ticks > 0) {
+        // same as op_ticks calls of c1541_tick() under the above conditions
+        sys->idle.loop_ticks += op_ticks - 1;
+        if (!sys->idle.disabled) {
+            _c1541_idle_check(sys, sys->cpu.PC);
+        }
+        sys->idle.loop_ticks++;
+        if (sys->drive.motor_on && (sys->drive.track_size > 0)) {
+            sys->drive.byte_ticks -= (int)op_ticks;
+        }
+        m6522_tick_idle(&sys->via_1, op_ticks);
+        m6522_tick_idle(&sys->via_2, op_ticks);
+        memset(out, sys->iec_out, op_ticks);
+        link->drive_in = in[op_ticks - 1];
+        sys->pins = (pins & ~M6502_IRQ) | (sys->pins & M6502_IRQ);
+        if (sys->pins & M6502_IRQ) {
+            sys->idle.sleeping = false;
+        }
+    }
+    return op_ticks;
+}
+#endif
+
+/*=== DISC IMAGE AND GCR ENCODING ============================================*/
+#define _C1541_D64_SECTORS_35 (683)
+#define _C1541_D64_SECTORS_40 (768)
+#define _C1541_D64_SECTORS_42 (802)
+
+// number of sectors on a track (1-based track number)
+static int _c1541_num_sectors(int track) {
+    if (track <= 17) {
+        return 21;
+    }
+    else if (track <= 24) {
+        return 19;
+    }
+    else if (track <= 30) {
+        return 18;
     }
     else {
-        mem_wr(&sys->mem, addr, M6502_GET_DATA(pins));
+        return 17;
     }
+}
 
-    sys->pins = pins;
+// size of a GCR-encoded track in bytes, depends on the speed zone of a track
+static int _c1541_gcr_track_size(int track) {
+    if (track <= 17) {
+        return 7692;
+    }
+    else if (track <= 24) {
+        return 7142;
+    }
+    else if (track <= 30) {
+        return 6666;
+    }
+    else {
+        return 6250;
+    }
 }
 
-void c1541_insert_disc(c1541_t* sys, chips_range_t data) {
-    // FIXME
-    (void)sys;
-    (void)data;
+// byte offset of a sector in a .D64 image
+static int _c1541_d64_offset(int track, int sector) {
+    int num_sectors = 0;
+    for (int t = 1; t < track; t++) {
+        num_sectors += _c1541_num_sectors(t);
+    }
+    return (num_sectors + sector) * 256;
+}
+
+// GCR-encode 4 bytes into 5 bytes
+static void _c1541_gcr_encode(const uint8_t* src, uint8_t* dst) {
+    static const uint8_t gcr[16] = {
+        0x0A, 0x0B, 0x12, 0x13, 0x0E, 0x0F, 0x16, 0x17,
+        0x09, 0x19, 0x1A, 0x1B, 0x0D, 0x1D, 0x1E, 0x15
+    };
+    uint64_t bits = 0;
+    for (int i = 0; i < 4; i++) {
+        bits = (bits << 10) | (gcr[src[i] >> 4] << 5) | gcr[src[i] & 0x0F];
+    }
+    for (int i = 4; i >= 0; i--) {
+        dst[i] = (uint8_t) bits;
+        bits >>= 8;
+    }
+}
+
+// GCR-encode a run of bytes (num_bytes must be a multiple of 4), returns new dst pointer
+static uint8_t* _c1541_gcr_encode_bytes(const uint8_t* src, int num_bytes, uint8_t* dst) {
+    for (int i = 0; i < num_bytes; i += 4) {
+        _c1541_gcr_encode(&src[i], dst);
+        dst += 5;
+    }
+    return dst;
+}
+
+static uint8_t* _c1541_gcr_fill(uint8_t* dst, uint8_t val, int num_bytes) {
+    memset(dst, val, (size_t)num_bytes);
+    return dst + num_bytes;
+}
+
+// convert the track under the read head into a GCR bit stream
+static void _c1541_load_track(c1541_t* sys) {
+    const int half_track = sys->drive.half_track;
+    const int track = (half_track / 2) + 1;
+    if ((0 == sys->disc.size) || (half_track & 1) || (track > sys->disc.num_tracks)) {
+        // no data under the read head
+        sys->drive.track_size = 0;
+        sys->drive.pos = 0;
+        sys->drive.sync = false;
+        return;
+    }
+    const uint8_t* bam = &sys->disc.data[_c1541_d64_offset(18, 0)];
+    const uint8_t id1 = bam[0xA2];
+    const uint8_t id2 = bam[0xA3];
+    const int num_sectors = _c1541_num_sectors(track);
+    const int track_size = _c1541_gcr_track_size(track);
+    CHIPS_ASSERT(track_size <= C1541_MAX_GCR_TRACK_SIZE);
+    // sync (5) + header (10) + header gap (9) + sync (5) + data (325)
+    const int sector_size = 5 + 10 + 9 + 5 + 325;
+    const int gap_size = (track_size - num_sectors * sector_size) / num_sectors;
+    CHIPS_ASSERT(gap_size > 0);
+    uint8_t* dst = sys->drive.track;
+    for (int sector = 0; sector < num_sectors; sector++) {
+        // header block
+        const uint8_t hdr[8] = {
+            0x08, (uint8_t)(sector ^ track ^ id2 ^ id1), (uint8_t)sector, (uint8_t)track, id2, id1, 0x0F, 0x0F
+        };
+        dst = _c1541_gcr_fill(dst, 0xFF, 5);
+        dst = _c1541_gcr_encode_bytes(hdr, sizeof(hdr), dst);
+        dst = _c1541_gcr_fill(dst, 0x55, 9);
+        // data block
+        uint8_t blk[260];
+        blk[0] = 0x07;
+        memcpy(&blk[1], &sys->disc.data[_c1541_d64_offset(track, sector)], 256);
+        uint8_t chk = 0;
+        for (int i = 1; i < 257; i++) {
+            chk ^= blk[i];
+        }
+        blk[257] = chk;
+        blk[258] = blk[259] = 0x00;
+        dst = _c1541_gcr_fill(dst, 0xFF, 5);
+        dst = _c1541_gcr_encode_bytes(blk, sizeof(blk), dst);
+        dst = _c1541_gcr_fill(dst, 0x55, gap_size);
+    }
+    // fill the remaining track bytes with gap bytes
+    const int size = (int)(dst - sys->drive.track);
+    _c1541_gcr_fill(dst, 0x55, track_size - size);
+    sys->drive.track_size = track_size;
+    sys->drive.pos %= track_size;
+}
+
+bool c1541_insert_disc(c1541_t* sys, chips_range_t data) {
+    CHIPS_ASSERT(sys && sys->valid);
+    CHIPS_ASSERT(data.ptr);
+    c1541_remove_disc(sys);
+    int num_tracks = 0;
+    switch (data.size) {
+        case _C1541_D64_SECTORS_35 * 256:
+        case _C1541_D64_SECTORS_35 * 257:
+            num_tracks = 35;
+            break;
+        case _C1541_D64_SECTORS_40 * 256:
+        case _C1541_D64_SECTORS_40 * 257:
+            num_tracks = 40;
+            break;
+        case _C1541_D64_SECTORS_42 * 256:
+        case _C1541_D64_SECTORS_42 * 257:
+            num_tracks = 42;
+            break;
+        default:
+            return false;
+    }
+    CHIPS_ASSERT(data.size <= C1541_MAX_DISC_SIZE);
+    #if defined(C1541_BORROWED_DATA)
+        sys->disc.data = (const uint8_t*) data.ptr;
+    #else
+        memcpy(sys->disc.data, data.ptr, data.size);
+    #endif
+    sys->disc.size = (int) data.size;
+    sys->disc.num_tracks = num_tracks;
+    _c1541_load_track(sys);
+    return true;
 }
 
 void c1541_remove_disc(c1541_t* sys) {
-    // FIXME
-    (void)sys;
+    CHIPS_ASSERT(sys && sys->valid);
+    sys->disc.size = 0;
+    sys->disc.num_tracks = 0;
+    #if defined(C1541_BORROWED_DATA)
+        sys->disc.data = 0;
+    #endif
+    _c1541_load_track(sys);
+}
+
+bool c1541_disc_inserted(c1541_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return sys->disc.size > 0;
+}
+
+bool c1541_is_sleeping(c1541_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return sys->idle.sleeping;
+}
+
+void c1541_link_init(c1541_link_t* link, c1541_t* sys, uint32_t num_ticks, uint8_t iec_lines) {
+    CHIPS_ASSERT(link && sys && sys->valid);
+    CHIPS_ASSERT((num_ticks > 0) && (num_ticks <= C1541_LINK_MAX_TICKS));
+    memset(link, 0, sizeof(c1541_link_t));
+    link->num_ticks = num_ticks;
+    link->drive_in = iec_lines;
+    // the first quantum on both sides sees the current lines of the other side
+    memset(link->host_lines[1], iec_lines, sizeof(link->host_lines[1]));
+    memset(link->drive_lines[1], sys->iec_out, sizeof(link->drive_lines[1]));
+    sys->iec = &link->drive_in;
+}
+
+uint8_t c1541_link_tick(c1541_link_t* link, uint8_t iec_lines) {
+    CHIPS_ASSERT(link);
+    const uint32_t quantum = link->host_quantum;
+    uint32_t tick = link->host_tick;
+    if (0 == tick) {
+        // the drive must have completed the previous quantum
+        if ((int32_t)(_CHIPS_LOAD_ACQUIRE(&link->drive_quantum) - quantum) < 0) {
+            link->stalls++;
+            while ((int32_t)(_CHIPS_LOAD_ACQUIRE(&link->drive_quantum) - quantum) < 0) {
+                // wait for the drive thread
+            }
+        }
+    }
+    link->host_lines[quantum & 1][tick] = iec_lines;
+    const uint8_t drive_lines = link->drive_lines[(quantum - 1) & 1][tick];
+    if (++tick == link->num_ticks) {
+        tick = 0;
+        _CHIPS_STORE_RELEASE(&link->host_quantum, quantum + 1);
+    }
+    link->host_tick = tick;
+    return drive_lines;
+}
+
+uint32_t c1541_link_exec(c1541_link_t* link, c1541_t* sys) {
+    CHIPS_ASSERT(link && sys && sys->valid && (sys->iec == &link->drive_in));
+    uint32_t num_ticks = 0;
+    uint32_t quantum = link->drive_quantum;
+    #if defined(M6502_HAS_EXEC)
+    const m6502_exec_t ex = { .mem = &sys->mem, .io_pages = _c1541_io_pages() };
+    #endif
+    // a quantum can run once the computer has completed the previous quantum
+    while ((int32_t)(_CHIPS_LOAD_ACQUIRE(&link->host_quantum) - quantum) >= 0) {
+        const uint8_t* in = link->host_lines[(quantum - 1) & 1];
+        uint8_t* out = link->drive_lines[quantum & 1];
+        uint32_t tick = 0;
+        while (tick < link->num_ticks) {
+            #if defined(M6502_HAS_EXEC)
+            const uint32_t n = _c1541_link_exec_op(link, sys, &ex, &in[tick], &out[tick], link->num_ticks - tick);
+            if (n > 0) {
+                tick += n;
+                continue;
+            }
+            #endif
+            link->drive_in = in[tick];
+            c1541_tick(sys);
+            out[tick] = sys->iec_out;
+            tick++;
+        }
+        quantum++;
+        _CHIPS_STORE_RELEASE(&link->drive_quantum, quantum);
+        num_ticks += link->num_ticks;
+    }
+    return num_ticks;
 }
 
 void c1541_snapshot_onsave(c1541_t* snapshot, void* base) {
     CHIPS_ASSERT(snapshot && base);
     snapshot->iec = 0;
     m6502_snapshot_onsave(&snapshot->cpu);
+    #if defined(C1541_BORROWED_ROMS)
+        // ROM pages point outside of the snapshot base, the mapping is rebuilt on load
+        mem_unmap_all(&snapshot->mem);
+        snapshot->rom[0] = 0;
+        snapshot->rom[1] = 0;
+    #endif
     mem_snapshot_onsave(&snapshot->mem, base);
+    #if defined(C1541_BORROWED_DATA)
+        snapshot->disc.data = 0;
+    #endif
 }
 
 void c1541_snapshot_onload(c1541_t* snapshot, c1541_t* sys, void* base) {
@@ -189,6 +961,23 @@ void c1541_snapshot_onload(c1541_t* snapshot, c1541_t* sys, void* base) {
     snapshot->iec = sys->iec;
     m6502_snapshot_onload(&snapshot->cpu, &sys->cpu);
     mem_snapshot_onload(&snapshot->mem, base);
+    #if defined(C1541_BORROWED_ROMS)
+        snapshot->rom[0] = sys->rom[0];
+        snapshot->rom[1] = sys->rom[1];
+        _c1541_map_memory(&snapshot->mem, sys);
+    #endif
+    #if defined(C1541_BORROWED_DATA)
+        // the borrowed disc data is taken from the target system, the same disc must be inserted
+        if ((snapshot->disc.size > 0) && (snapshot->disc.size == sys->disc.size)) {
+            snapshot->disc.data = sys->disc.data;
+        }
+        else {
+            snapshot->disc.data = 0;
+            snapshot->disc.size = 0;
+            snapshot->disc.num_tracks = 0;
+            _c1541_load_track(snapshot);
+        }
+    #endif
 }
 
 #endif // CHIPS_IMPL
@@ -18,15 +18,37 @@
     ~~~
         your own assert macro (default: assert(c))
 
+    ~~~C
+    C64_BORROWED_ROMS
+    ~~~
+        if defined, c64_init() doesn't copy the ROM images into c64_t but
+        keeps pointers to the ROM data in c64_desc_t.roms, the ROM data
+        must then remain valid and unchanged until c64_discard() is called
+        (this allows many instances to share one copy of the ROMs), ROMs are
+        also not part of snapshots, snapshots must be loaded into an instance
+        which was initialized with the same ROM images, must be the same for
+        all files which include c64.h (see C1541_BORROWED_ROMS in c1541.h
+        for the C1541 ROM images)
+
+    ~~~C
+    C64_NO_FRAMEBUFFER
+    ~~~
+        if defined, c64_t doesn't contain a framebuffer and video decoding
+        is permanently disabled (c64_enable_video() has no effect), this is
+        useful for headless instances (e.g. automated tests or servers)
+        which only need the CPU and I/O side of the emulation, the
+        framebuffer pointer in c64_display_info() is then null, must be
+        the same for all files which include c64.h
+
     You need to include the following headers before including c64.h:
 
     - chips/chips_common.h
+    - chips/mem.h
     - chips/m6502.h
     - chips/m6526.h
     - chips/m6569.h
     - chips/m6581.h
     - chips/kbd.h
-    - chips/mem.h
     - chips/clk.h
     - systems/c1530.h
     - chips/m6522.h
@@ -36,9 +58,215 @@
 
     TODO!
 
+    ## Tape Fast Loading
+
+    With c64_desc_t.c1530_fastload enabled, the KERNAL tape LOAD routine
+    (at 0xF4A5) is trapped and the next standard KERNAL header and data block
+    which match the requested file name are decoded directly from the
+    inserted .TAP image. The file is then written into memory and the LOAD
+    routine returns immediately as if it had finished loading from tape.
+    If the tape doesn't contain a matching standard KERNAL file (for instance
+    because it uses a custom turbo loader), the regular KERNAL routine
+    continues and loads the tape in real time.
+
+    ## Text Input
+
+    c64_input_text() feeds a text into the KERNAL keyboard buffer (at 0x0277,
+    with the number of buffered characters at 0xC6) instead of simulating
+    key presses (see 'Text Input' in chips_common.h). Whenever the CPU reads
+    the buffer count at 0xC6 while text is pending, the buffer is topped up
+    to its maximum size (at 0x0289, at most 10 characters), so the text is
+    entered as fast as the screen editor (or a program reading the keyboard
+    through the KERNAL) consumes it:
+
+    ~~~C
+    c64_input_text(&sys, "10 PRINT \"HELLO\"\n20 GOTO 10\nRUN\n");
+    while (c64_input_text_pending(&sys)) {
+        c64_exec(&sys, 16667);
+    }
+    ~~~
+
+    Lower-case ASCII letters are converted to upper case (which is what the
+    C64 shows in its default character set), all other bytes are written
+    into the keyboard buffer as PETSCII codes. The text is not copied and
+    must remain valid until c64_input_text_pending() returns false.
+
+    ## Boot Snapshots
+
+    A cold-started C64 needs a few emulated seconds to run through the KERNAL
+    memory test before the BASIC prompt appears. To skip this for new
+    instances, boot one instance with c64_boot(), save a snapshot of it with
+    c64_save_snapshot() and provide the snapshot in c64_desc_t.boot_snapshot
+    when initializing further instances. Those then start directly at the
+    BASIC prompt, with the same result as running c64_boot() on them. The
+    boot snapshot must have been created with the same ROM images and the
+    same C1530/C1541 configuration.
+
+    ## Instance Cloning
+
+    To create many instances with the same configuration (for instance
+    from a boot snapshot), initialize one template instance with c64_init()
+    (and optionally c64_boot()), and then create further instances with
+    c64_clone() instead of c64_init(). This copies the template with a
+    single memcpy() and fixes up all pointers into the template's c64_t:
+
+    ~~~C
+    static c64_t proto;
+    c64_init(&proto, &desc);
+    c64_boot(&proto);
+
+    c64_t* sys = malloc(sizeof(c64_t));
+    c64_clone(sys, &proto);
+    ~~~
+
+    The clone shares the template's audio and debug callbacks and any
+    borrowed ROM, tape and disc images, but not the optional audio ring
+    buffer, drive thread link (see 'Drive Thread'), event ring (see
+    'Hardware Event Timeline') or pending text input. The template must
+    not have a pending asynchronous snapshot, and the clone must not be an
+    initialized instance (call c64_discard() first).
+
+    ## Asynchronous Snapshots
+
+    c64_save_snapshot_async() takes a snapshot without copying the 64 KByte
+    RAM on the emulator thread (see 'Asynchronous Snapshots' in
+    chips_common.h). All other state is copied immediately, the RAM pages
+    are copied by calling chips_async_snapshot_run() on a background thread,
+    or by the emulation right before it writes to a page which hasn't been
+    copied yet:
+
+    ~~~C
+    // on the emulator thread
+    static c64_t snapshot;
+    static chips_async_snapshot_t job;
+    const uint32_t version = c64_save_snapshot_async(&sys, &snapshot, &job);
+    start_background_thread(&job);
+
+    // on the background thread
+    chips_async_snapshot_run(&job);
+    // ...snapshot is now complete and can be compressed and written to disk
+
+    // on the emulator thread, after the background thread has finished
+    c64_finish_snapshot_async(&sys);
+    ~~~
+
+    c64_finish_snapshot_async() copies the remaining pages itself if
+    the background thread hasn't finished yet, after it returns the
+    snapshot is complete. The job must remain alive until both
+    c64_finish_snapshot_async() and chips_async_snapshot_run() have
+    returned. Functions which replace the whole RAM content (like
+    c64_load_snapshot()) finish a pending asynchronous snapshot first.
+
+    Only the RAM is copied asynchronously, so the time spent on the
+    emulator thread depends on the size of the remaining snapshot (see
+    'Memory Footprint' below how to keep the tape, disc and ROM images
+    out of the snapshot).
+
+    ## Delta Snapshots
+
+    c64_save_snapshot_delta() encodes the difference between the current
+    state and the most recent snapshot saved from the same instance with
+    c64_save_snapshot() or c64_save_snapshot_async() (see 'Delta Snapshots'
+    in chips_common.h), which is useful for saving a snapshot every frame
+    for rewinding:
+
+    ~~~C
+    static c64_t base, scratch;
+    static uint8_t delta[CHIPS_DELTA_MAX_SIZE(C64_SNAPSHOT_SIZE)];
+    c64_save_snapshot(&sys, &base);
+    ...
+    const size_t delta_size = c64_save_snapshot_delta(&sys, &base, &scratch, (chips_range_t){ delta, sizeof(delta) });
+    ...
+    static c64_t snapshot;
+    memcpy(&snapshot, &base, C64_SNAPSHOT_SIZE);
+    c64_apply_snapshot_delta(&snapshot, (chips_range_t){ delta, delta_size });
+    c64_load_snapshot(&sys, version, &snapshot);
+    ~~~
+
+    The caller-provided scratch snapshot receives all state except the RAM,
+    the RAM is only compared against the base snapshot in pages which have
+    been written since the base snapshot was saved. When compiled with
+    MEM_TRACK_ACCESS (see 'Access Tracking' in mem.h) the written pages
+    are taken from the CPU mem_t (which means the written bits of the CPU
+    mem_t are consumed by the C64 emulation), otherwise all RAM pages are
+    compared.
+
+    ## Drive Thread
+
+    With the C1541 enabled, most of the CPU time of a disc-heavy workload
+    is spent in the drive's own 6502 and VIAs. To tick the drive on a
+    separate thread, provide a c1541_link_t in c64_desc_t.c1541_link and
+    keep calling c64_drive_thread_exec() on the drive thread while the
+    emulation runs (see 'Drive Thread' in c1541.h):
+
+    ~~~C
+    static c1541_link_t link;
+    c64_init(&sys, &(c64_desc_t){ ..., .c1541_enabled = true, .c1541_link = &link });
+
+    // on the drive thread
+    while (running) {
+        if (0 == c64_drive_thread_exec(&sys)) {
+            // waiting for the C64, sleep or yield...
+        }
+    }
+    ~~~
+
+    The C64 and the drive then see the IEC bus lines of the other side
+    with a fixed delay of c64_desc_t.c1541_link_ticks ticks (default:
+    C1541_LINK_DEFAULT_TICKS), which the KERNAL and DOS serial bus code
+    tolerate, but cycle-counting fast loaders usually don't (use a small
+    number of ticks or no drive thread for those). The C64 waits for the
+    drive thread every c1541_link_ticks ticks, so the drive thread must be
+    running whenever the emulation runs (including c64_boot()). If
+    chips/mem.h is included before chips/m6502.h, the drive thread runs
+    most drive CPU instructions in one go (see 'Instruction-Stepped
+    Execution' in c1541.h).
+
+    c64_reset(), snapshots and the disc functions access the drive state,
+    so these must only be called while the drive thread is not inside
+    c64_drive_thread_exec(). A snapshot doesn't include the IEC bus line
+    changes which are in flight in the link, c64_reset() and
+    c64_load_snapshot() resync the link to the current bus lines.
+
+    ## Hardware Event Timeline
+
+    With CHIPS_EVENTS defined and a chips_event_ring_t provided in
+    c64_desc_t.events, the C64 records the following hardware events
+    (see 'Hardware Event Timeline' in chips_common.h):
+
+    - CHIPS_EVENT_IRQ and CHIPS_EVENT_NMI: the CPU IRQ and NMI line levels
+    - CHIPS_EVENT_VSYNC: the VIC-II starts the vertical retrace (same
+      position as c64_exec_frame())
+    - CHIPS_EVENT_RASTER_IRQ: the VIC-II raster compare interrupt latch is
+      set, 'addr' is the raster line and 'data' the interrupt latch register
+    - CHIPS_EVENT_TIMER: a CIA timer underflow, 'addr' is 0 and 1 for
+      CIA-1 timer A and B, and 2 and 3 for CIA-2 timer A and B
+    - CHIPS_EVENT_SOUND_REG: a SID register write
+    - CHIPS_EVENT_MEMORY_MAP: the CPU memory map is updated, 'data'
+      is the CPU port value (C64_CPUPORT_*)
+
+    c64_boot() doesn't record any events.
+
+    ## Memory Footprint
+
+    By default c64_t embeds the tape buffer of the C1530, the disc image
+    of the C1541 and all ROM images, so that a single instance is
+    self-contained (about 1 MByte, most of which is part of snapshots).
+    When running many instances (or when the drives aren't used at all),
+    define the following macros to keep the large buffers in caller-owned
+    memory (which can be shared between instances) instead:
+
+    - C1530_BORROWED_DATA: tape images (saves 512 KBytes)
+    - C1541_BORROWED_DATA: disc images (saves 200 KBytes)
+    - C1541_BORROWED_ROMS and C64_BORROWED_ROMS: ROM images (saves 36 KBytes)
+
+    With all of these defined, a c64_t is about 250 KBytes, and snapshots
+    shrink to below 100 KBytes, most of the remaining size is the 64 KByte
+    RAM and the framebuffer (which isn't part of snapshots).
+
     ## TODO:
 
-    - floppy disc support
+    - writing to floppy discs
 
     ## Tests Status
 
@@ -252,7 +480,9 @@ extern "C" {
 #endif
 
 // bump snapshot version when c64_t memory layout changes
-#define C64_SNAPSHOT_VERSION (1)
+#define C64_SNAPSHOT_VERSION (14)
+
+#define C64_BOOT_MICRO_SECONDS (3000000)    // time run by c64_boot() until the BASIC prompt is ready
 
 #define C64_FREQUENCY (985248)              // clock frequency in Hz
 #define C64_MAX_AUDIO_SAMPLES (1024)        // max number of audio samples in internal sample buffer
@@ -280,6 +510,9 @@ typedef enum {
 #define C64_CPUPORT_HIRAM (1<<1)
 #define C64_CPUPORT_CHAREN (1<<2)
 
+// number of precomputed CPU memory configurations (LORAM, HIRAM, CHAREN)
+#define C64_NUM_MEM_BANKS (8)
+
 // casette port bits, same as C1530_CASPORT_*
 #define C64_CASPORT_MOTOR   (1<<0)  // 1: motor off, 0: motor on
 #define C64_CASPORT_READ    (1<<1)  // 1: read signal from datasette, connected to CIA-1 FLAG
@@ -319,13 +552,22 @@ typedef enum {
 #define C64_KEY_F7       (0xF7)     // F7
 #define C64_KEY_F8       (0xF8)     // F8
 
+struct c64_t;
+
 // config parameters for c64_init()
 typedef struct {
     bool c1530_enabled;     // true to enable the C1530 datassette emulation
+    bool c1530_fastload;    // true to load standard KERNAL tape files instantly via a ROM trap
     bool c1541_enabled;     // true to enable the C1541 floppy drive emulation
+    bool c1541_idle_sleep_disabled; // true to keep running the C1541 CPU in its idle loop
+    c1541_link_t* c1541_link;   // optional, tick the C1541 on a separate thread (see "Drive Thread")
+    int c1541_link_ticks;       // IEC bus latency in ticks with a drive thread (default: C1541_LINK_DEFAULT_TICKS)
     c64_joystick_type_t joystick_type;  // default is C64_JOYSTICK_NONE
     chips_debug_t debug;    // optional debugging hook
     chips_audio_desc_t audio;   // audio output options
+    chips_warp_desc_t warp;     // optional automatic warp mode while the tape motor is on
+    chips_event_ring_t* events; // optional hardware event timeline, needs CHIPS_EVENTS (see "Hardware Event Timeline")
+    const struct c64_t* boot_snapshot;  // optional snapshot taken after c64_boot() to start in booted state
     // ROM images
     struct {
         chips_range_t chars;     // 4 KByte character ROM dump
@@ -339,8 +581,18 @@ typedef struct {
     } roms;
 } c64_desc_t;
 
-// C64 emulator state
+// per-frame statistics counters (only updated when CHIPS_STATS is defined)
 typedef struct {
+    uint32_t ticks;                 // number of ticks executed in the last c64_exec() call
+    uint32_t rdy_ticks;             // CPU ticks stalled by the VIC-II (RDY active on a read access)
+    uint32_t mem_accesses;          // plain RAM/ROM accesses
+    uint32_t io_accesses;           // accesses to the VIC-II, SID, CIAs and color RAM
+    uint32_t cpu_port_accesses;     // accesses to the M6510 IO port at address 0 and 1
+    m6569_stats_t vic;              // VIC-II badline and sprite DMA counters
+} c64_stats_t;
+
+// C64 emulator state
+typedef struct c64_t {
     m6502_t cpu;
     m6526_t cia_1;
     m6526_t cia_2;
@@ -351,48 +603,93 @@ typedef struct {
     c64_joystick_type_t joystick_type;
     bool io_mapped;             // true when D000..DFFF has IO area mapped in
     uint8_t cas_port;           // cassette port, shared with c1530_t if datasette is connected
-    uint8_t iec_port;           // IEC serial port, shared with c1541_t if connected
+    bool tape_fastload;         // trap the KERNAL tape LOAD routine (see "Tape Fast Loading")
+    uint8_t iec_port;           // IEC serial bus lines pulled low by the C64 (C64_IECPORT_*), shared with c1541_t
     uint8_t cpu_port;           // last state of CPU port (for memory mapping)
     uint8_t kbd_joy1_mask;      // current joystick-1 state from keyboard-joystick emulation
     uint8_t kbd_joy2_mask;      // current joystick-2 state from keyboard-joystick emulation
     uint8_t joy_joy1_mask;      // current joystick-1 state from c64_joystick()
     uint8_t joy_joy2_mask;      // current joystick-2 state from c64_joystick()
     uint16_t vic_bank_select;   // upper 4 address bits from CIA-2 port A
+    uint32_t tick_frac;         // fractional tick carried over between c64_exec() calls (see clk_us_to_ticks_frac())
 
-    kbd_t kbd;                  // keyboard matrix state
-    mem_t mem_cpu;              // CPU-visible memory mapping
-    mem_t mem_vic;              // VIC-visible memory mapping
     bool valid;
     chips_debug_t debug;
-
-    struct {
-        chips_audio_callback_t callback;
-        int num_samples;
-        int sample_pos;
-        float sample_buffer[C64_MAX_AUDIO_SAMPLES];
-    } audio;
-
+    c64_stats_t stats;
     uint8_t color_ram[1024];        // special static color ram
+    // keyboard and memory mapping last, their bulk tables follow the per-tick state (see C64_HOT_SIZE)
+    kbd_t kbd;                  // keyboard matrix state
+    mem_t mem_vic;              // VIC-visible memory mapping
+    mem_t mem_cpu;              // CPU-visible memory mapping
+
     uint8_t ram[1<<16];             // general ram
+    #if defined(C64_BORROWED_ROMS)
+    const uint8_t* rom_char;        // borrowed ROM images, not part of snapshots
+    const uint8_t* rom_basic;
+    const uint8_t* rom_kernal;
+    #else
     uint8_t rom_char[0x1000];       // 4 KB character ROM image
     uint8_t rom_basic[0x2000];      // 8 KB BASIC ROM image
     uint8_t rom_kernal[0x2000];     // 8 KB KERNAL V3 ROM image
-    alignas(64) uint8_t fb[M6569_FRAMEBUFFER_SIZE_BYTES];
+    #endif
 
     c1530_t c1530;      // optional datassette
     c1541_t c1541;      // optional floppy drive
+
+    // output-only state starting at audio.sample_buffer is not part of snapshots
+    struct {
+        chips_audio_callback_t callback;
+        int num_samples;
+        int sample_pos;
+        float sample_buffer[C64_MAX_AUDIO_SAMPLES];
+        chips_audio_ring_t* ring;
+    } audio;
+    // automatic warp mode (see "Automatic Warp Mode" in chips_common.h)
+    struct {
+        bool enabled;
+        bool active;        // true while running the warp time slices inside c64_exec()
+        bool warped;        // true if the last c64_exec() call ran warp time slices
+        int max_slices;
+    } warp;
+    // pending asynchronous snapshot (see "Asynchronous Snapshots")
+    struct {
+        chips_async_snapshot_t* job;
+        uint64_t pending_pages;     // RAM pages which must be copied into the snapshot before they are written
+    } async_snapshot;
+    // RAM pages written since the last saved snapshot (see "Delta Snapshots")
+    uint64_t snapshot_written_pages[((0x10000 >> MEM_PAGE_SHIFT) + 63) / 64];
+    c1541_link_t* c1541_link;       // optional link to a drive thread (see "Drive Thread")
+    chips_event_ring_t* events;     // optional hardware event timeline (see "Hardware Event Timeline")
+    chips_text_input_t text_input;  // pending text for the keyboard buffer (see "Text Input")
+    #if !defined(C64_NO_FRAMEBUFFER)
+    alignas(64) uint8_t fb[M6569_FRAMEBUFFER_SIZE_BYTES];
+    #endif
+    // precomputed CPU memory configurations (indexed by the CPU port bits 0..2),
+    // these only point into the c64_t itself or the ROM images and are not part of snapshots
+    mem_bank_t mem_banks[C64_NUM_MEM_BANKS];
 } c64_t;
 
+// size of the part of c64_t which is stored in snapshots (the audio sample buffer and framebuffer are excluded)
+#define C64_SNAPSHOT_SIZE (offsetof(c64_t, audio.sample_buffer))
+// size of the state at the start of c64_t which is accessed on every tick, not counting the RAM
+#define C64_HOT_SIZE (offsetof(c64_t, mem_cpu.layers))
+
 // initialize a new C64 instance
 void c64_init(c64_t* sys, const c64_desc_t* desc);
 // discard C64 instance
 void c64_discard(c64_t* sys);
+// initialize a new C64 instance as a copy of an initialized template instance
+void c64_clone(c64_t* sys, const c64_t* template_sys);
 // reset a C64 instance
 void c64_reset(c64_t* sys);
 // get framebuffer and display attributes
 chips_display_info_t c64_display_info(c64_t* sys);
 // tick C64 instance for a given number of microseconds, return number of ticks executed
 uint32_t c64_exec(c64_t* sys, uint32_t micro_seconds);
+// tick C64 instance for a given number of ticks, return number of ticks executed
+uint32_t c64_exec_ticks(c64_t* sys, uint32_t num_ticks);
+// tick C64 instance until the VIC-II starts the next vertical retrace, return number of ticks executed
+uint32_t c64_exec_frame(c64_t* sys);
 // send a key-down event to the C64
 void c64_key_down(c64_t* sys, int key_code);
 // send a key-up event to the C64
@@ -417,10 +714,42 @@ void c64_tape_play(c64_t* sys);
 void c64_tape_stop(c64_t* sys);
 // return true if tape motor is on
 bool c64_is_tape_motor_on(c64_t* sys);
+// insert a disc image file (.d64, c1541 must be enabled)
+bool c64_insert_disc(c64_t* sys, chips_range_t data);
+// remove current disc
+void c64_remove_disc(c64_t* sys);
+// return true if a disc is currently inserted
+bool c64_disc_inserted(c64_t* sys);
+// enable/disable video decoding (e.g. for fast-forwarding or headless operation)
+void c64_enable_video(c64_t* sys, bool enabled);
+// return true if video decoding is enabled
+bool c64_video_enabled(c64_t* sys);
+// get statistics counters of the last c64_exec() call (needs CHIPS_STATS)
+c64_stats_t c64_stats(c64_t* sys);
+// enable/disable automatic warp mode while the tape motor is on
+void c64_enable_auto_warp(c64_t* sys, bool enabled);
+// return true if the last c64_exec() call ran in warp mode
+bool c64_is_warping(c64_t* sys);
 // save a snapshot, patches pointers to zero and offsets, returns snapshot version
 uint32_t c64_save_snapshot(c64_t* sys, c64_t* dst);
 // load a snapshot, returns false if snapshot versions don't match
-bool c64_load_snapshot(c64_t* sys, uint32_t version, c64_t* src);
+bool c64_load_snapshot(c64_t* sys, uint32_t version, const c64_t* src);
+// start an asynchronous snapshot, copies everything except the RAM into dst, returns snapshot version
+uint32_t c64_save_snapshot_async(c64_t* sys, c64_t* dst, chips_async_snapshot_t* job);
+// finish a pending asynchronous snapshot, copies the remaining RAM pages into the snapshot
+void c64_finish_snapshot_async(c64_t* sys);
+// save a delta snapshot relative to the last snapshot saved from sys, scratch is caller-provided temp storage, returns number of bytes written to dst, or 0 if dst is too small
+size_t c64_save_snapshot_delta(c64_t* sys, const c64_t* base, c64_t* scratch, chips_range_t dst);
+// apply a delta snapshot to a copy of its base snapshot, the result can be loaded with c64_load_snapshot()
+bool c64_apply_snapshot_delta(c64_t* inout_snapshot, chips_range_t delta);
+// run a freshly initialized instance until the BASIC prompt is ready (for creating boot snapshots)
+void c64_boot(c64_t* sys);
+// drive thread: tick the C1541 as far as the C64 allows, returns number of ticks executed (see "Drive Thread")
+uint32_t c64_drive_thread_exec(c64_t* sys);
+// feed text into the KERNAL keyboard buffer, the text must remain valid until consumed (see "Text Input")
+void c64_input_text(c64_t* sys, const char* text);
+// return true while text from c64_input_text() hasn't been consumed yet
+bool c64_input_text_pending(c64_t* sys);
 // perform a RUN BASIC call
 void c64_basic_run(c64_t* sys);
 // perform a LOAD BASIC call
@@ -451,8 +780,12 @@ static uint8_t _c64_cpu_port_in(void* user_data);
 static void _c64_cpu_port_out(uint8_t data, void* user_data);
 static uint16_t _c64_vic_fetch(uint16_t addr, void* user_data);
 static void _c64_update_memory_map(c64_t* sys);
+static void _c64_init_mem_banks(c64_t* sys);
 static void _c64_init_key_map(c64_t* sys);
 static void _c64_init_memory_map(c64_t* sys);
+static void _c64_map_memory(c64_t* sys);
+static uint64_t _c64_tape_fastload(c64_t* sys, uint64_t pins);
+static void _c64_text_input_fill(c64_t* sys);
 
 #define _C64_DEFAULT(val,def) (((val) != 0) ? (val) : (def))
 
@@ -465,14 +798,24 @@ void c64_init(c64_t* sys, const c64_desc_t* desc) {
     sys->joystick_type = desc->joystick_type;
     sys->debug = desc->debug;
     sys->audio.callback = desc->audio.callback;
+    sys->audio.ring = desc->audio.ring;
+    sys->events = desc->events;
     sys->audio.num_samples = _C64_DEFAULT(desc->audio.num_samples, C64_DEFAULT_AUDIO_SAMPLES);
     CHIPS_ASSERT(sys->audio.num_samples <= C64_MAX_AUDIO_SAMPLES);
-    CHIPS_ASSERT(desc->roms.chars.ptr && (desc->roms.chars.size == sizeof(sys->rom_char)));
-    CHIPS_ASSERT(desc->roms.basic.ptr && (desc->roms.basic.size == sizeof(sys->rom_basic)));
-    CHIPS_ASSERT(desc->roms.kernal.ptr && (desc->roms.kernal.size == sizeof(sys->rom_kernal)));
-    memcpy(sys->rom_char, desc->roms.chars.ptr, sizeof(sys->rom_char));
-    memcpy(sys->rom_basic, desc->roms.basic.ptr, sizeof(sys->rom_basic));
-    memcpy(sys->rom_kernal, desc->roms.kernal.ptr, sizeof(sys->rom_kernal));
+    sys->warp.enabled = desc->warp.enabled;
+    sys->warp.max_slices = _C64_DEFAULT(desc->warp.max_slices, CHIPS_DEFAULT_WARP_SLICES);
+    CHIPS_ASSERT(desc->roms.chars.ptr && (desc->roms.chars.size == 0x1000));
+    CHIPS_ASSERT(desc->roms.basic.ptr && (desc->roms.basic.size == 0x2000));
+    CHIPS_ASSERT(desc->roms.kernal.ptr && (desc->roms.kernal.size == 0x2000));
+    #if defined(C64_BORROWED_ROMS)
+        sys->rom_char = (const uint8_t*) desc->roms.chars.ptr;
+        sys->rom_basic = (const uint8_t*) desc->roms.basic.ptr;
+        sys->rom_kernal = (const uint8_t*) desc->roms.kernal.ptr;
+    #else
+        memcpy(sys->rom_char, desc->roms.chars.ptr, 0x1000);
+        memcpy(sys->rom_basic, desc->roms.basic.ptr, 0x2000);
+        memcpy(sys->rom_kernal, desc->roms.kernal.ptr, 0x2000);
+    #endif
 
     // initialize the hardware
     sys->cpu_port = 0xF7;       // for initial memory mapping
@@ -490,10 +833,12 @@ void c64_init(c64_t* sys, const c64_desc_t* desc) {
     m6526_init(&sys->cia_2);
     m6569_init(&sys->vic, &(m6569_desc_t){
         .fetch_cb = _c64_vic_fetch,
+        #if !defined(C64_NO_FRAMEBUFFER)
         .framebuffer = {
             .ptr = sys->fb,
             .size = sizeof(sys->fb),
         },
+        #endif
         .screen = {
             .x = _C64_SCREEN_X,
             .y = _C64_SCREEN_Y,
@@ -513,20 +858,38 @@ void c64_init(c64_t* sys, const c64_desc_t* desc) {
         c1530_init(&sys->c1530, &(c1530_desc_t){
             .cas_port = &sys->cas_port,
         });
+        sys->tape_fastload = desc->c1530_fastload;
     }
     if (desc->c1541_enabled) {
         c1541_init(&sys->c1541, &(c1541_desc_t){
             .iec_port = &sys->iec_port,
+            .idle_sleep_disabled = desc->c1541_idle_sleep_disabled,
             .roms = {
                 .c000_dfff = desc->roms.c1541.c000_dfff,
                 .e000_ffff = desc->roms.c1541.e000_ffff
             },
         });
+        if (desc->c1541_link) {
+            sys->c1541_link = desc->c1541_link;
+            c1541_link_init(sys->c1541_link, &sys->c1541, (uint32_t)_C64_DEFAULT(desc->c1541_link_ticks, C1541_LINK_DEFAULT_TICKS), sys->iec_port);
+        }
+    }
+    // there's no base snapshot yet
+    memset(sys->snapshot_written_pages, 0xFF, sizeof(sys->snapshot_written_pages));
+    if (desc->boot_snapshot) {
+        // skip the KERNAL boot sequence
+        CHIPS_ASSERT(desc->boot_snapshot->c1530.valid == desc->c1530_enabled);
+        CHIPS_ASSERT(desc->boot_snapshot->c1541.valid == desc->c1541_enabled);
+        const int num_samples = sys->audio.num_samples;
+        c64_load_snapshot(sys, C64_SNAPSHOT_VERSION, desc->boot_snapshot);
+        sys->audio.num_samples = num_samples;
+        sys->audio.sample_pos = 0;
     }
 }
 
 void c64_discard(c64_t* sys) {
     CHIPS_ASSERT(sys && sys->valid);
+    c64_finish_snapshot_async(sys);
     sys->valid = false;
     if (sys->c1530.valid) {
         c1530_discard(&sys->c1530);
@@ -536,6 +899,34 @@ void c64_discard(c64_t* sys) {
     }
 }
 
+void c64_clone(c64_t* sys, const c64_t* template_sys) {
+    CHIPS_ASSERT(sys && template_sys && template_sys->valid && (sys != template_sys));
+    CHIPS_ASSERT(0 == template_sys->async_snapshot.job);
+    memcpy(sys, template_sys, sizeof(c64_t));
+    // fix up the pointers into the template
+    const size_t size = sizeof(c64_t);
+    sys->cpu.user_data = chips_relocate_ptr(sys->cpu.user_data, template_sys, size, sys);
+    sys->vic.mem.user_data = chips_relocate_ptr(sys->vic.mem.user_data, template_sys, size, sys);
+    sys->vic.crt.fb = (uint8_t*) chips_relocate_ptr(sys->vic.crt.fb, template_sys, size, sys);
+    mem_relocate(&sys->mem_cpu, template_sys, size, sys);
+    mem_relocate(&sys->mem_vic, template_sys, size, sys);
+    _c64_init_mem_banks(sys);
+    if (sys->c1530.valid) {
+        sys->c1530.cas_port = &sys->cas_port;
+    }
+    if (sys->c1541.valid) {
+        // with a drive thread link in the template, the drive is connected to the link
+        sys->c1541.iec = &sys->iec_port;
+        sys->c1541.cpu.user_data = chips_relocate_ptr(sys->c1541.cpu.user_data, template_sys, size, sys);
+        mem_relocate(&sys->c1541.mem, template_sys, size, sys);
+    }
+    // per-instance host attachments are not cloned
+    sys->audio.ring = 0;
+    sys->c1541_link = 0;
+    sys->events = 0;
+    chips_text_input_clear(&sys->text_input);
+}
+
 void c64_reset(c64_t* sys) {
     CHIPS_ASSERT(sys && sys->valid);
     sys->cpu_port = 0xF7;
@@ -549,14 +940,79 @@ void c64_reset(c64_t* sys) {
     m6526_reset(&sys->cia_2);
     m6569_reset(&sys->vic);
     m6581_reset(&sys->sid);
+    chips_text_input_clear(&sys->text_input);
+    if (sys->c1541.valid) {
+        // the drive is reset through the IEC bus RESET line
+        c1541_reset(&sys->c1541);
+        if (sys->c1541_link) {
+            c1541_link_init(sys->c1541_link, &sys->c1541, sys->c1541_link->num_ticks, sys->iec_port);
+        }
+    }
+}
+
+// copy a RAM page into a pending asynchronous snapshot before it is written
+static void _c64_async_snapshot_copy_page(c64_t* sys, uint32_t page_index) {
+    chips_async_snapshot_copy_page(sys->async_snapshot.job, page_index);
+    sys->async_snapshot.pending_pages &= ~(1ULL << page_index);
+}
+
+// write to CPU-visible memory
+static inline void _c64_mem_wr(c64_t* sys, uint16_t addr, uint8_t data) {
+    // RAM writes always go to the same offset in c64_t.ram
+    const uint32_t page_index = addr / CHIPS_ASYNC_SNAPSHOT_PAGE_SIZE;
+    if (sys->async_snapshot.pending_pages & (1ULL << page_index)) {
+        _c64_async_snapshot_copy_page(sys, page_index);
+    }
+    mem_wr(&sys->mem_cpu, addr, data);
+}
+
+static inline void _c64_mem_wr16(c64_t* sys, uint16_t addr, uint16_t data) {
+    _c64_mem_wr(sys, addr, (uint8_t)data);
+    _c64_mem_wr(sys, (uint16_t)(addr + 1), (uint8_t)(data>>8));
+}
+
+#if defined(CHIPS_EVENTS)
+// level bits in chips_event_ring_t.levels
+#define _C64_EVENT_LEVEL_IRQ    (1<<0)
+#define _C64_EVENT_LEVEL_NMI    (1<<1)
+#define _C64_EVENT_LEVEL_IRST   (1<<2)
+#define _C64_EVENT_LEVEL_TIMER  (1<<3)  // bits 3..6 track the CIA timer underflow toggles
+
+// record the hardware events of the current tick (see "Hardware Event Timeline")
+static void _c64_tick_events(c64_t* sys, uint64_t pins, uint64_t sid_pins) {
+    chips_event_ring_t* ring = sys->events;
+    ring->tick++;
+    if (chips_event_changed(ring, _C64_EVENT_LEVEL_IRQ, 0 != (pins & M6502_IRQ))) {
+        chips_event_push(ring, CHIPS_EVENT_IRQ, 0, (pins & M6502_IRQ) ? 1 : 0);
+    }
+    if (chips_event_changed(ring, _C64_EVENT_LEVEL_NMI, 0 != (pins & M6502_NMI))) {
+        chips_event_push(ring, CHIPS_EVENT_NMI, 0, (pins & M6502_NMI) ? 1 : 0);
+    }
+    const uint8_t int_latch = sys->vic.reg.int_latch;
+    if (chips_event_changed(ring, _C64_EVENT_LEVEL_IRST, 0 != (int_latch & M6569_INT_IRST)) && (int_latch & M6569_INT_IRST)) {
+        chips_event_push(ring, CHIPS_EVENT_RASTER_IRQ, sys->vic.rs.v_count, int_latch);
+    }
+    if (m6569_ticks_to_vsync(&sys->vic) == (M6569_HTOTAL * M6569_VTOTAL)) {
+        chips_event_push(ring, CHIPS_EVENT_VSYNC, 0, 0);
+    }
+    const bool t_bits[4] = { sys->cia_1.ta.t_bit, sys->cia_1.tb.t_bit, sys->cia_2.ta.t_bit, sys->cia_2.tb.t_bit };
+    for (uint16_t i = 0; i < 4; i++) {
+        if (chips_event_changed(ring, _C64_EVENT_LEVEL_TIMER << i, t_bits[i])) {
+            chips_event_push(ring, CHIPS_EVENT_TIMER, i, 0);
+        }
+    }
+    if ((sid_pins & (M6581_CS|M6581_RW)) == M6581_CS) {
+        chips_event_push(ring, CHIPS_EVENT_SOUND_REG, (uint16_t)(sid_pins & M6581_ADDR_MASK), M6581_GET_DATA(sid_pins));
+    }
 }
+#endif
 
 static uint64_t _c64_tick(c64_t* sys, uint64_t pins) {
     // FIXME: move datasette and floppy tick to end
     if (sys->c1530.valid) {
         c1530_tick(&sys->c1530);
     }
-    if (sys->c1541.valid) {
+    if (sys->c1541.valid && !sys->c1541_link) {
         c1541_tick(&sys->c1541);
     }
 
@@ -581,10 +1037,12 @@ static uint64_t _c64_tick(c64_t* sys, uint64_t pins) {
     uint64_t sid_pins = pins & M6502_PIN_MASK;
     if ((pins & (M6502_RDY|M6502_RW)) != (M6502_RDY|M6502_RW)) {
         if (M6510_CHECK_IO(pins)) {
+            CHIPS_STATS_INC(sys->stats.cpu_port_accesses);
             cpu_io_access = true;
         }
         else {
             if (sys->io_mapped && ((addr & 0xF000) == 0xD000)) {
+                CHIPS_STATS_INC(sys->stats.io_accesses);
                 if (addr < 0xD400) {
                     // VIC-II (D000..D3FF)
                     vic_pins |= M6569_CS;
@@ -607,22 +1065,31 @@ static uint64_t _c64_tick(c64_t* sys, uint64_t pins) {
                 }
             }
             else {
+                CHIPS_STATS_INC(sys->stats.mem_accesses);
                 mem_access = true;
             }
         }
     }
+    else {
+        CHIPS_STATS_INC(sys->stats.rdy_ticks);
+    }
 
     // tick the SID
     {
         sid_pins = m6581_tick(&sys->sid, sid_pins);
-        if (sid_pins & M6581_SAMPLE) {
-            // new audio sample ready
-            sys->audio.sample_buffer[sys->audio.sample_pos++] = sys->sid.sample;
-            if (sys->audio.sample_pos == sys->audio.num_samples) {
-                if (sys->audio.callback.func) {
-                    sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
+        if ((sid_pins & M6581_SAMPLE) && !sys->warp.active) {
+            // new audio sample ready (dropped in warp mode)
+            if (sys->audio.ring) {
+                chips_audio_ring_push(sys->audio.ring, sys->sid.sample);
+            }
+            else {
+                sys->audio.sample_buffer[sys->audio.sample_pos++] = sys->sid.sample;
+                if (sys->audio.sample_pos == sys->audio.num_samples) {
+                    if (sys->audio.callback.func) {
+                        sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
+                    }
+                    sys->audio.sample_pos = 0;
                 }
-                sys->audio.sample_pos = 0;
             }
         }
         if ((sid_pins & (M6581_CS|M6581_RW)) == (M6581_CS|M6581_RW)) {
@@ -651,7 +1118,7 @@ static uint64_t _c64_tick(c64_t* sys, uint64_t pins) {
         if (sys->cas_port & C64_CASPORT_READ) {
             cia1_pins |= M6526_FLAG;
         }
-        cia1_pins = m6526_tick(&sys->cia_1, cia1_pins);
+        cia1_pins = m6526_tick_sched(&sys->cia_1, cia1_pins);
         const uint8_t kbd_lines = ~M6526_GET_PA(cia1_pins);
         kbd_set_active_lines(&sys->kbd, kbd_lines);
         if (cia1_pins & M6502_IRQ) {
@@ -665,7 +1132,8 @@ static uint64_t _c64_tick(c64_t* sys, uint64_t pins) {
     /* tick CIA-2
         In Port A:
             bits 0..5: output (see cia2_out)
-            bits 6..7: serial bus input, not implemented
+            bit 6: serial bus CLK input (0: line is pulled low)
+            bit 7: serial bus DATA input (0: line is pulled low)
         In Port B:
             RS232 / user functionality (not implemented)
 
@@ -676,7 +1144,9 @@ static uint64_t _c64_tick(c64_t* sys, uint64_t pins) {
                 10: bank 1 4000..7FFF
                 11: bank 0 0000..3FFF
             bit 2: RS-232 TXD Outout (not implemented)
-            bit 3..5: serial bus output (not implemented)
+            bit 3: serial bus ATN output (1: pull line low)
+            bit 4: serial bus CLK output (1: pull line low)
+            bit 5: serial bus DATA output (1: pull line low)
             bit 6..7: input (see cia2_in)
         Out Port B:
             RS232 / user functionality (not implemented)
@@ -684,9 +1154,38 @@ static uint64_t _c64_tick(c64_t* sys, uint64_t pins) {
         CIA-2 IRQ pin connected to CPU NMI pin
     */
     {
-        M6526_SET_PAB(cia2_pins, 0xFF, 0xFF);
-        cia2_pins = m6526_tick(&sys->cia_2, cia2_pins);
-        sys->vic_bank_select = ((~M6526_GET_PA(cia2_pins))&3)<<14;
+        // the IEC bus lines are pulled low by the C64 or the floppy drive
+        uint8_t drive_lines;
+        if (sys->c1541_link) {
+            // the drive runs on the drive thread (see "Drive Thread")
+            drive_lines = c1541_link_tick(sys->c1541_link, sys->iec_port);
+        }
+        else {
+            drive_lines = sys->c1541.iec_out;
+        }
+        const uint8_t iec_bus = sys->iec_port | drive_lines;
+        uint8_t pa = 0x3F;
+        if (!(iec_bus & C64_IECPORT_CLK)) {
+            pa |= (1<<6);
+        }
+        if (!(iec_bus & C64_IECPORT_DATA)) {
+            pa |= (1<<7);
+        }
+        M6526_SET_PAB(cia2_pins, pa, 0xFF);
+        cia2_pins = m6526_tick_sched(&sys->cia_2, cia2_pins);
+        const uint8_t pa_out = M6526_GET_PA(cia2_pins);
+        sys->vic_bank_select = ((~pa_out)&3)<<14;
+        uint8_t iec_port = 0;
+        if (pa_out & (1<<3)) {
+            iec_port |= C64_IECPORT_ATN;
+        }
+        if (pa_out & (1<<4)) {
+            iec_port |= C64_IECPORT_CLK;
+        }
+        if (pa_out & (1<<5)) {
+            iec_port |= C64_IECPORT_DATA;
+        }
+        sys->iec_port = iec_port;
         if (cia2_pins & M6502_IRQ) {
             pins |= M6502_NMI;
         }
@@ -733,14 +1232,31 @@ static uint64_t _c64_tick(c64_t* sys, uint64_t pins) {
     }
     else if (mem_access) {
         if (pins & M6502_RW) {
-            // memory read
+            // memory read, reading the keyboard buffer count tops up the buffer with pending text input
+            if ((addr == 0xC6) && chips_text_input_pending(&sys->text_input)) {
+                _c64_text_input_fill(sys);
+            }
             M6502_SET_DATA(pins, mem_rd(&sys->mem_cpu, addr));
         }
         else {
             // memory write
-            mem_wr(&sys->mem_cpu, addr, M6502_GET_DATA(pins));
+            _c64_mem_wr(sys, addr, M6502_GET_DATA(pins));
+        }
+    }
+
+    // check if the KERNAL tape LOAD routine was hit for tape fast loading
+    if (sys->tape_fastload) {
+        const uint64_t trap_mask = M6502_SYNC|0xFFFF;
+        const uint64_t trap_val  = M6502_SYNC|0xF4A5;
+        if ((pins & trap_mask) == trap_val) {
+            pins = _c64_tape_fastload(sys, pins);
         }
     }
+    #if defined(CHIPS_EVENTS)
+    if (sys->events) {
+        _c64_tick_events(sys, pins, sid_pins);
+    }
+    #endif
     return pins;
 }
 
@@ -805,42 +1321,53 @@ static uint16_t _c64_vic_fetch(uint16_t addr, void* user_data) {
     return data;
 }
 
-static void _c64_update_memory_map(c64_t* sys) {
-    sys->io_mapped = false;
-    uint8_t* read_ptr;
-    // shortcut if HIRAM and LORAM is 0, everything is RAM
-    if ((sys->cpu_port & (C64_CPUPORT_HIRAM|C64_CPUPORT_LORAM)) == 0) {
-        mem_map_ram(&sys->mem_cpu, 0, 0xA000, 0x6000, sys->ram+0xA000);
-    }
-    else {
+// precompute the CPU memory map for each LORAM/HIRAM/CHAREN configuration
+static void _c64_init_mem_banks(c64_t* sys) {
+    for (int config = 0; config < C64_NUM_MEM_BANKS; config++) {
+        mem_bank_t* bank = &sys->mem_banks[config];
+        mem_bank_init(bank);
+        // 0000..9FFF and C000..CFFF is always RAM
+        mem_bank_map_ram(bank, 0x0000, 0xA000, sys->ram);
+        mem_bank_map_ram(bank, 0xC000, 0x1000, sys->ram+0xC000);
+        // shortcut if HIRAM and LORAM is 0, everything is RAM
+        if ((config & (C64_CPUPORT_HIRAM|C64_CPUPORT_LORAM)) == 0) {
+            mem_bank_map_ram(bank, 0xA000, 0x2000, sys->ram+0xA000);
+            mem_bank_map_ram(bank, 0xD000, 0x3000, sys->ram+0xD000);
+            continue;
+        }
         // A000..BFFF is either RAM-behind-BASIC-ROM or RAM
-        if ((sys->cpu_port & (C64_CPUPORT_HIRAM|C64_CPUPORT_LORAM)) == (C64_CPUPORT_HIRAM|C64_CPUPORT_LORAM)) {
-            read_ptr = sys->rom_basic;
+        if ((config & (C64_CPUPORT_HIRAM|C64_CPUPORT_LORAM)) == (C64_CPUPORT_HIRAM|C64_CPUPORT_LORAM)) {
+            mem_bank_map_rw(bank, 0xA000, 0x2000, sys->rom_basic, sys->ram+0xA000);
         }
         else {
-            read_ptr = sys->ram + 0xA000;
+            mem_bank_map_ram(bank, 0xA000, 0x2000, sys->ram+0xA000);
         }
-        mem_map_rw(&sys->mem_cpu, 0, 0xA000, 0x2000, read_ptr, sys->ram+0xA000);
-
         // E000..FFFF is either RAM-behind-KERNAL-ROM or RAM
-        if (sys->cpu_port & C64_CPUPORT_HIRAM) {
-            read_ptr = sys->rom_kernal;
+        if (config & C64_CPUPORT_HIRAM) {
+            mem_bank_map_rw(bank, 0xE000, 0x2000, sys->rom_kernal, sys->ram+0xE000);
         }
         else {
-            read_ptr = sys->ram + 0xE000;
+            mem_bank_map_ram(bank, 0xE000, 0x2000, sys->ram+0xE000);
         }
-        mem_map_rw(&sys->mem_cpu, 0, 0xE000, 0x2000, read_ptr, sys->ram+0xE000);
-
-        // D000..DFFF can be Char-ROM or I/O
-        if  (sys->cpu_port & C64_CPUPORT_CHAREN) {
-            sys->io_mapped = true;
+        // D000..DFFF can be Char-ROM or I/O (the IO area is handled in _c64_tick(),
+        // map RAM underneath so that the configuration covers all pages)
+        if (config & C64_CPUPORT_CHAREN) {
+            mem_bank_map_ram(bank, 0xD000, 0x1000, sys->ram+0xD000);
         }
         else {
-            mem_map_rw(&sys->mem_cpu, 0, 0xD000, 0x1000, sys->rom_char, sys->ram+0xD000);
+            mem_bank_map_rw(bank, 0xD000, 0x1000, sys->rom_char, sys->ram+0xD000);
         }
     }
 }
 
+static void _c64_update_memory_map(c64_t* sys) {
+    CHIPS_EVENT(sys->events, CHIPS_EVENT_MEMORY_MAP, 0, sys->cpu_port);
+    const int config = sys->cpu_port & (C64_CPUPORT_CHAREN|C64_CPUPORT_HIRAM|C64_CPUPORT_LORAM);
+    // D000..DFFF is IO if CHAREN is set and not everything is RAM
+    sys->io_mapped = (config & C64_CPUPORT_CHAREN) && (config & (C64_CPUPORT_HIRAM|C64_CPUPORT_LORAM));
+    mem_map_bank(&sys->mem_cpu, 0, &sys->mem_banks[config]);
+}
+
 static void _c64_init_memory_map(c64_t* sys) {
     // seperate memory mapping for CPU and VIC-II
     mem_init(&sys->mem_cpu);
@@ -863,13 +1390,13 @@ static void _c64_init_memory_map(c64_t* sys) {
         }
     }
     CHIPS_ASSERT(i == 0x10000);
+    _c64_map_memory(sys);
+}
 
-    /* setup the initial CPU memory map
-       0000..9FFF and C000.CFFF is always RAM
-    */
-    mem_map_ram(&sys->mem_cpu, 0, 0x0000, 0xA000, sys->ram);
-    mem_map_ram(&sys->mem_cpu, 0, 0xC000, 0x1000, sys->ram+0xC000);
-    // A000..BFFF, D000..DFFF and E000..FFFF are configurable
+// map RAM and ROMs into the CPU and VIC-II memory maps
+static void _c64_map_memory(c64_t* sys) {
+    // setup the CPU memory map for the current CPU port configuration
+    _c64_init_mem_banks(sys);
     _c64_update_memory_map(sys);
 
     /* setup the separate VIC-II memory map (64 KByte RAM) overlayed with
@@ -950,9 +1477,7 @@ static void _c64_init_key_map(c64_t* sys) {
     kbd_register_key(&sys->kbd, C64_KEY_F8      , 3, 0, 1);    // F8
 }
 
-uint32_t c64_exec(c64_t* sys, uint32_t micro_seconds) {
-    CHIPS_ASSERT(sys && sys->valid);
-    uint32_t num_ticks = clk_us_to_ticks(C64_FREQUENCY, micro_seconds);
+static uint32_t _c64_exec_slice(c64_t* sys, uint32_t num_ticks) {
     uint64_t pins = sys->pins;
     if (0 == sys->debug.callback.func) {
         // run without debug callback
@@ -962,16 +1487,78 @@ uint32_t c64_exec(c64_t* sys, uint32_t micro_seconds) {
     }
     else {
         // run with debug callback
+        chips_debug_filter_t* filter = sys->debug.filter;
         for (uint32_t ticks = 0; (ticks < num_ticks) && !(*sys->debug.stopped); ticks++) {
             pins = _c64_tick(sys, pins);
-            sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            if ((0 == filter) || chips_debug_filter_hit(filter, 0 != (pins & M6502_SYNC), M6502_GET_ADDR(pins),
+                    0 != (pins & M6502_RW), 0 == (pins & M6502_RW))) {
+                sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            }
         }
     }
     sys->pins = pins;
-    kbd_update(&sys->kbd, micro_seconds);
+    kbd_update(&sys->kbd, clk_ticks_to_us(C64_FREQUENCY, num_ticks));
     return num_ticks;
 }
 
+// warp mode condition: the tape motor is on and a tape is inserted
+static bool _c64_warp_needed(c64_t* sys) {
+    if (sys->debug.callback.func && *sys->debug.stopped) {
+        return false;
+    }
+    return sys->c1530.valid && c1530_is_motor_on(&sys->c1530) && c1530_tape_inserted(&sys->c1530);
+}
+
+/* run the first time slice with video and audio output, followed by the
+   warp time slices, in frame mode each time slice runs up to the next
+   vertical retrace
+*/
+static uint32_t _c64_exec(c64_t* sys, uint32_t slice_ticks, bool frame_mode) {
+    #if defined(CHIPS_STATS)
+    memset(&sys->stats, 0, sizeof(sys->stats));
+    memset(&sys->vic.stats, 0, sizeof(sys->vic.stats));
+    #endif
+    chips_dirty_lines_clear(&sys->vic.dirty_lines);
+    // first time slice always runs with video and audio output
+    uint32_t num_ticks = _c64_exec_slice(sys, frame_mode ? m6569_ticks_to_vsync(&sys->vic) : slice_ticks);
+    // decode a partially collected rasterline before the framebuffer is displayed
+    m6569_flush_video(&sys->vic);
+    if (sys->warp.enabled && _c64_warp_needed(sys)) {
+        // run additional time slices without video and audio output
+        const bool video_disabled = sys->vic.video_disabled;
+        sys->vic.video_disabled = true;
+        sys->warp.active = true;
+        for (int slice = 1; (slice < sys->warp.max_slices) && _c64_warp_needed(sys); slice++) {
+            num_ticks += _c64_exec_slice(sys, frame_mode ? m6569_ticks_to_vsync(&sys->vic) : slice_ticks);
+        }
+        sys->warp.active = false;
+        sys->vic.video_disabled = video_disabled;
+        sys->warp.warped = true;
+    }
+    else {
+        sys->warp.warped = false;
+    }
+    #if defined(CHIPS_STATS)
+    sys->stats.ticks = num_ticks;
+    #endif
+    return num_ticks;
+}
+
+uint32_t c64_exec(c64_t* sys, uint32_t micro_seconds) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return _c64_exec(sys, clk_us_to_ticks_frac(C64_FREQUENCY, micro_seconds, &sys->tick_frac), false);
+}
+
+uint32_t c64_exec_ticks(c64_t* sys, uint32_t num_ticks) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return _c64_exec(sys, num_ticks, false);
+}
+
+uint32_t c64_exec_frame(c64_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return _c64_exec(sys, 0, true);
+}
+
 void c64_key_down(c64_t* sys, int key_code) {
     CHIPS_ASSERT(sys && sys->valid);
     if (sys->joystick_type == C64_JOYSTICKTYPE_NONE) {
@@ -1065,19 +1652,270 @@ bool c64_quickload(c64_t* sys, chips_range_t data) {
     const uint16_t end_addr = start_addr + (data.size - 2);
     uint16_t addr = start_addr;
     while (addr < end_addr) {
-        mem_wr(&sys->mem_cpu, addr++, *ptr++);
+        _c64_mem_wr(sys, addr++, *ptr++);
     }
 
     // update the BASIC pointers
-    mem_wr16(&sys->mem_cpu, 0x2d, end_addr);
-    mem_wr16(&sys->mem_cpu, 0x2f, end_addr);
-    mem_wr16(&sys->mem_cpu, 0x31, end_addr);
-    mem_wr16(&sys->mem_cpu, 0x33, end_addr);
-    mem_wr16(&sys->mem_cpu, 0xae, end_addr);
+    _c64_mem_wr16(sys, 0x2d, end_addr);
+    _c64_mem_wr16(sys, 0x2f, end_addr);
+    _c64_mem_wr16(sys, 0x31, end_addr);
+    _c64_mem_wr16(sys, 0x33, end_addr);
+    _c64_mem_wr16(sys, 0xae, end_addr);
+
+    return true;
+}
+
+/*=== TAPE FAST LOADER =======================================================*/
+
+/*  decode standard KERNAL tape blocks directly from the .TAP pulse stream:
+
+    - short (S), medium (M) and long (L) pulses
+    - each byte starts with a (L,M) marker, followed by 8 data bits and an odd
+      parity bit, LSB first, 0-bits are (S,M) and 1-bits are (M,S)
+    - a (L,S) marker ends the block
+    - each block starts with a countdown sequence of 9 bytes (0x89..0x81 in the
+      first copy and 0x09..0x01 in the repeated copy) and ends with an XOR
+      checksum byte
+
+    see: https://www.c64-wiki.com/wiki/Datassette_Encoding
+*/
+#define _C64_TAP_SHORT  (0)
+#define _C64_TAP_MEDIUM (1)
+#define _C64_TAP_LONG   (2)
+#define _C64_TAP_END    (-1)
+#define _C64_TAP_HEADER_SIZE (192)
+
+// a decoded KERNAL tape block
+typedef struct {
+    int num_bytes;      // number of data bytes (without countdown and checksum)
+    bool repeated;      // true if this is the repeated copy of a block
+    bool valid;         // checksum is valid
+} _c64_tap_block_t;
+
+static int _c64_tap_pulse(const c1530_t* tape, uint32_t* pos) {
+    if (*pos >= tape->size) {
+        return _C64_TAP_END;
+    }
+    const uint8_t val = tape->buf[(*pos)++];
+    if (val == 0) {
+        // long pause, followed by 3 length bytes
+        *pos += 3;
+        return _C64_TAP_END;
+    }
+    else if (val < 0x37) {
+        return _C64_TAP_SHORT;
+    }
+    else if (val < 0x4A) {
+        return _C64_TAP_MEDIUM;
+    }
+    else if (val < 0x65) {
+        return _C64_TAP_LONG;
+    }
+    return _C64_TAP_END;
+}
+
+// skip the leader until the first byte marker, return false at end of tape
+static bool _c64_tap_sync(const c1530_t* tape, uint32_t* pos) {
+    while (*pos < tape->size) {
+        const uint32_t marker_pos = *pos;
+        if (_C64_TAP_LONG == _c64_tap_pulse(tape, pos)) {
+            if (_C64_TAP_MEDIUM == _c64_tap_pulse(tape, pos)) {
+                *pos = marker_pos;
+                return true;
+            }
+            // re-check the second pulse as start of a marker
+            *pos = marker_pos + 1;
+        }
+    }
+    return false;
+}
+
+// decode the next byte (including its marker), return -1 at end of block or error
+static int _c64_tap_byte(const c1530_t* tape, uint32_t* pos) {
+    if (_C64_TAP_LONG != _c64_tap_pulse(tape, pos)) {
+        return -1;
+    }
+    if (_C64_TAP_MEDIUM != _c64_tap_pulse(tape, pos)) {
+        // (L,S) is the end-of-data marker
+        return -1;
+    }
+    int val = 0;
+    int parity = 1;
+    for (int i = 0; i < 9; i++) {
+        const int p0 = _c64_tap_pulse(tape, pos);
+        const int p1 = _c64_tap_pulse(tape, pos);
+        int bit;
+        if ((p0 == _C64_TAP_SHORT) && (p1 == _C64_TAP_MEDIUM)) {
+            bit = 0;
+        }
+        else if ((p0 == _C64_TAP_MEDIUM) && (p1 == _C64_TAP_SHORT)) {
+            bit = 1;
+        }
+        else {
+            return -1;
+        }
+        if (i < 8) {
+            val |= bit << i;
+        }
+        parity ^= bit;
+    }
+    return (0 == parity) ? val : -1;
+}
 
+/*  decode the next block, data bytes are either stored in dst (if not null),
+    or written to memory starting at addr, at most max_bytes are stored,
+    returns false at end of tape
+*/
+static bool _c64_tap_block(c64_t* sys, uint32_t* pos, uint8_t* dst, uint16_t addr, int max_bytes, _c64_tap_block_t* out_block) {
+    const c1530_t* tape = &sys->c1530;
+    memset(out_block, 0, sizeof(_c64_tap_block_t));
+    if (!_c64_tap_sync(tape, pos)) {
+        return false;
+    }
+    // countdown sequence
+    const int first = _c64_tap_byte(tape, pos);
+    if ((first != 0x89) && (first != 0x09)) {
+        return true;
+    }
+    out_block->repeated = (first == 0x09);
+    for (int i = 1; i < 9; i++) {
+        if (_c64_tap_byte(tape, pos) != (first - i)) {
+            return true;
+        }
+    }
+    // data bytes, the last byte before the end marker is the checksum
+    int prev = -1;
+    uint8_t checksum = 0;
+    int val;
+    while ((val = _c64_tap_byte(tape, pos)) >= 0) {
+        if (prev >= 0) {
+            if (out_block->num_bytes < max_bytes) {
+                if (dst) {
+                    dst[out_block->num_bytes] = (uint8_t)prev;
+                }
+                else {
+                    _c64_mem_wr(sys, (uint16_t)(addr + out_block->num_bytes), (uint8_t)prev);
+                }
+            }
+            out_block->num_bytes++;
+            checksum ^= (uint8_t)prev;
+        }
+        prev = val;
+    }
+    out_block->valid = (prev >= 0) && (checksum == (uint8_t)prev);
     return true;
 }
 
+/*  trapped KERNAL LOAD routine (at F4A5, after the ILOAD vector):
+
+    - A: 0 for LOAD, 1 for VERIFY
+    - C3/C4: load address from X/Y (used for secondary address 0)
+    - B7: filename length, BB/BC: filename address
+    - B9: secondary address, BA: device number (1 for tape)
+
+    If the next matching file on tape can be decoded, it is written to memory
+    and the LOAD routine returns immediately with the carry flag cleared
+    and the end address in X/Y and AE/AF. Otherwise the regular KERNAL
+    code continues and loads the tape in real time.
+*/
+static uint64_t _c64_tape_fastload(c64_t* sys, uint64_t pins) {
+    c1530_t* tape = &sys->c1530;
+    if ((0 == tape->size) || (0 != sys->cpu.A) || (1 != mem_rd(&sys->mem_cpu, 0xBA))) {
+        return pins;
+    }
+    // KERNAL ROM must be mapped
+    if (mem_readptr(&sys->mem_cpu, 0xF4A5) != &sys->rom_kernal[0x14A5]) {
+        return pins;
+    }
+    const uint8_t name_len = mem_rd(&sys->mem_cpu, 0xB7);
+    const uint16_t name_addr = mem_rd16(&sys->mem_cpu, 0xBB);
+    const uint8_t sec_addr = mem_rd(&sys->mem_cpu, 0xB9);
+    uint32_t pos = tape->pos;
+    uint8_t hdr[_C64_TAP_HEADER_SIZE];
+    _c64_tap_block_t blk;
+
+    // find the header of the next matching program file
+    uint16_t start_addr = 0;
+    uint16_t end_addr = 0;
+    bool found = false;
+    while (!found && _c64_tap_block(sys, &pos, hdr, 0, sizeof(hdr), &blk)) {
+        if (blk.repeated || !blk.valid || (blk.num_bytes != _C64_TAP_HEADER_SIZE)) {
+            continue;
+        }
+        const uint8_t type = hdr[0];
+        if (type == 5) {
+            // end-of-tape marker
+            return pins;
+        }
+        if ((type != 1) && (type != 3)) {
+            continue;
+        }
+        bool match = true;
+        for (int i = 0; (i < name_len) && (i < 16); i++) {
+            if (mem_rd(&sys->mem_cpu, (uint16_t)(name_addr + i)) != hdr[5 + i]) {
+                match = false;
+                break;
+            }
+        }
+        if (match) {
+            start_addr = (uint16_t)(hdr[2]<<8 | hdr[1]);
+            end_addr = (uint16_t)(hdr[4]<<8 | hdr[3]);
+            // relocatable programs are loaded to X/Y for secondary address 0
+            if ((type == 1) && (0 == (sec_addr & 1))) {
+                const uint16_t load_addr = mem_rd16(&sys->mem_cpu, 0xC3);
+                end_addr = (uint16_t)(load_addr + (end_addr - start_addr));
+                start_addr = load_addr;
+            }
+            found = true;
+        }
+    }
+    if (!found || (end_addr <= start_addr)) {
+        return pins;
+    }
+
+    // load the data block, use the repeated copy if the first copy is broken
+    const int num_bytes = end_addr - start_addr;
+    bool loaded = false;
+    while (!loaded && _c64_tap_block(sys, &pos, 0, start_addr, num_bytes, &blk)) {
+        if (blk.num_bytes == _C64_TAP_HEADER_SIZE) {
+            // the repeated header copy
+            if (blk.repeated) {
+                continue;
+            }
+            break;
+        }
+        loaded = blk.valid && (blk.num_bytes == num_bytes);
+        if (blk.repeated) {
+            break;
+        }
+    }
+    if (!loaded) {
+        return pins;
+    }
+    // skip the repeated copy of the data block
+    uint32_t next_pos = pos;
+    uint8_t dummy;
+    if (_c64_tap_block(sys, &next_pos, &dummy, 0, 0, &blk) && blk.repeated && (blk.num_bytes == num_bytes)) {
+        pos = next_pos;
+    }
+    tape->pos = pos;
+    tape->pulse_count = 0;
+
+    // return from the LOAD routine with success
+    _c64_mem_wr16(sys, 0xAE, end_addr);
+    _c64_mem_wr(sys, 0x90, 0);
+    sys->cpu.X = (uint8_t)end_addr;
+    sys->cpu.Y = (uint8_t)(end_addr >> 8);
+    sys->cpu.P &= ~M6502_CF;
+    const uint16_t sp = 0x0100 | sys->cpu.S;
+    const uint16_t ret_addr = (uint16_t)((mem_rd(&sys->mem_cpu, (uint16_t)(sp + 2))<<8 | mem_rd(&sys->mem_cpu, (uint16_t)(sp + 1))) + 1);
+    sys->cpu.S += 2;
+    M6502_SET_ADDR(pins, ret_addr);
+    M6502_SET_DATA(pins, mem_rd(&sys->mem_cpu, ret_addr));
+    m6502_set_pc(&sys->cpu, ret_addr);
+    return pins;
+}
+
 bool c64_insert_tape(c64_t* sys, chips_range_t data) {
     CHIPS_ASSERT(sys && sys->valid && sys->c1530.valid);
     return c1530_insert_tape(&sys->c1530, data);
@@ -1093,6 +1931,21 @@ bool c64_tape_inserted(c64_t* sys) {
     return c1530_tape_inserted(&sys->c1530);
 }
 
+bool c64_insert_disc(c64_t* sys, chips_range_t data) {
+    CHIPS_ASSERT(sys && sys->valid && sys->c1541.valid);
+    return c1541_insert_disc(&sys->c1541, data);
+}
+
+void c64_remove_disc(c64_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid && sys->c1541.valid);
+    c1541_remove_disc(&sys->c1541);
+}
+
+bool c64_disc_inserted(c64_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid && sys->c1541.valid);
+    return c1541_disc_inserted(&sys->c1541);
+}
+
 void c64_tape_play(c64_t* sys) {
     CHIPS_ASSERT(sys && sys->valid && sys->c1530.valid);
     c1530_play(&sys->c1530);
@@ -1108,6 +1961,37 @@ bool c64_is_tape_motor_on(c64_t* sys) {
     return c1530_is_motor_on(&sys->c1530);
 }
 
+void c64_enable_video(c64_t* sys, bool enabled) {
+    CHIPS_ASSERT(sys && sys->valid);
+    #if defined(C64_NO_FRAMEBUFFER)
+    (void)enabled;
+    #else
+    sys->vic.video_disabled = !enabled;
+    #endif
+}
+
+bool c64_video_enabled(c64_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return !sys->vic.video_disabled;
+}
+
+c64_stats_t c64_stats(c64_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    c64_stats_t res = sys->stats;
+    res.vic = sys->vic.stats;
+    return res;
+}
+
+void c64_enable_auto_warp(c64_t* sys, bool enabled) {
+    CHIPS_ASSERT(sys && sys->valid);
+    sys->warp.enabled = enabled;
+}
+
+bool c64_is_warping(c64_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return sys->warp.warped;
+}
+
 chips_display_info_t c64_display_info(c64_t* sys) {
     chips_display_info_t res = {
         .frame = {
@@ -1117,11 +2001,14 @@ chips_display_info_t c64_display_info(c64_t* sys) {
             },
             .bytes_per_pixel = 1,
             .buffer = {
+                #if !defined(C64_NO_FRAMEBUFFER)
                 .ptr = sys ? sys->fb : 0,
                 .size = M6569_FRAMEBUFFER_SIZE_BYTES,
+                #endif
             }
         },
         .palette = m6569_dbg_palette(),
+        .dirty_lines = sys ? &sys->vic.dirty_lines : 0,
     };
     if (sys) {
         res.screen = m6569_screen(&sys->vic);
@@ -1134,31 +2021,96 @@ chips_display_info_t c64_display_info(c64_t* sys) {
             .height = _C64_SCREEN_HEIGHT
         };
     };
+    #if !defined(C64_NO_FRAMEBUFFER)
     CHIPS_ASSERT(((sys == 0) && (res.frame.buffer.ptr == 0)) || ((sys != 0) && (res.frame.buffer.ptr != 0)));
+    #endif
     return res;
 }
 
-uint32_t c64_save_snapshot(c64_t* sys, c64_t* dst) {
-    CHIPS_ASSERT(sys && dst);
-    *dst = *sys;
+// patch the pointers in a snapshot copy of sys
+static void _c64_snapshot_onsave(c64_t* sys, c64_t* dst) {
     chips_debug_snapshot_onsave(&dst->debug);
     chips_audio_callback_snapshot_onsave(&dst->audio.callback);
     m6502_snapshot_onsave(&dst->cpu);
     m6569_snapshot_onsave(&dst->vic);
+    #if defined(C64_BORROWED_ROMS)
+        // ROM pages point outside of c64_t, the mapping is rebuilt in c64_load_snapshot()
+        mem_unmap_all(&dst->mem_cpu);
+        mem_unmap_all(&dst->mem_vic);
+        dst->rom_char = 0;
+        dst->rom_basic = 0;
+        dst->rom_kernal = 0;
+    #endif
     mem_snapshot_onsave(&dst->mem_cpu, sys);
     mem_snapshot_onsave(&dst->mem_vic, sys);
     c1530_snapshot_onsave(&dst->c1530);
     c1541_snapshot_onsave(&dst->c1541, sys);
+}
+
+// take over the RAM pages written since the last call from the CPU mem_t
+static void _c64_snapshot_collect_writes(c64_t* sys) {
+    #if defined(MEM_TRACK_ACCESS)
+        // CPU writes to a page always go to the same page in c64_t.ram (also under ROM and IO)
+        mem_track_collect_writes(&sys->mem_cpu, sys->ram, sizeof(sys->ram), sys->snapshot_written_pages);
+    #else
+        memset(sys->snapshot_written_pages, 0xFF, sizeof(sys->snapshot_written_pages));
+    #endif
+}
+
+// start tracking written RAM pages relative to a new base snapshot
+static void _c64_snapshot_reset_writes(c64_t* sys) {
+    _c64_snapshot_collect_writes(sys);
+    memset(sys->snapshot_written_pages, 0, sizeof(sys->snapshot_written_pages));
+}
+
+// copy everything except the RAM into a snapshot and patch the pointers
+static void _c64_snapshot_copy_state(c64_t* sys, c64_t* dst) {
+    const size_t ram_start = offsetof(c64_t, ram);
+    const size_t ram_end = ram_start + sizeof(sys->ram);
+    memcpy(dst, sys, ram_start);
+    memcpy((uint8_t*)dst + ram_end, (uint8_t*)sys + ram_end, C64_SNAPSHOT_SIZE - ram_end);
+    _c64_snapshot_onsave(sys, dst);
+}
+
+uint32_t c64_save_snapshot(c64_t* sys, c64_t* dst) {
+    CHIPS_ASSERT(sys && dst);
+    memcpy(dst, sys, C64_SNAPSHOT_SIZE);
+    _c64_snapshot_onsave(sys, dst);
+    _c64_snapshot_reset_writes(sys);
     return C64_SNAPSHOT_VERSION;
 }
 
-bool c64_load_snapshot(c64_t* sys, uint32_t version, c64_t* src) {
+uint32_t c64_save_snapshot_async(c64_t* sys, c64_t* dst, chips_async_snapshot_t* job) {
+    CHIPS_ASSERT(sys && sys->valid && dst && job);
+    c64_finish_snapshot_async(sys);
+    // copy everything in front of and behind the RAM
+    _c64_snapshot_copy_state(sys, dst);
+    _c64_snapshot_reset_writes(sys);
+    // ...and freeze the RAM pages
+    chips_async_snapshot_init(job, (chips_range_t){ .ptr = sys->ram, .size = sizeof(sys->ram) }, dst->ram);
+    CHIPS_ASSERT(job->num_pages == 64);
+    sys->async_snapshot.job = job;
+    sys->async_snapshot.pending_pages = ~0ULL;
+    return C64_SNAPSHOT_VERSION;
+}
+
+void c64_finish_snapshot_async(c64_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    if (sys->async_snapshot.job) {
+        chips_async_snapshot_run(sys->async_snapshot.job);
+        sys->async_snapshot.job = 0;
+        sys->async_snapshot.pending_pages = 0;
+    }
+}
+
+bool c64_load_snapshot(c64_t* sys, uint32_t version, const c64_t* src) {
     CHIPS_ASSERT(sys && src);
     if (version != C64_SNAPSHOT_VERSION) {
         return false;
     }
+    c64_finish_snapshot_async(sys);
     static c64_t im;
-    im = *src;
+    memcpy(&im, src, C64_SNAPSHOT_SIZE);
     chips_debug_snapshot_onload(&im.debug, &sys->debug);
     chips_audio_callback_snapshot_onload(&im.audio.callback, &sys->audio.callback);
     m6502_snapshot_onload(&im.cpu, &sys->cpu);
@@ -1167,50 +2119,146 @@ bool c64_load_snapshot(c64_t* sys, uint32_t version, c64_t* src) {
     mem_snapshot_onload(&im.mem_vic, sys);
     c1530_snapshot_onload(&im.c1530, &sys->c1530);
     c1541_snapshot_onload(&im.c1541, &sys->c1541, sys);
-    *sys = im;
+    #if defined(C64_BORROWED_ROMS)
+        // the borrowed ROM images are taken from the target system
+        im.rom_char = sys->rom_char;
+        im.rom_basic = sys->rom_basic;
+        im.rom_kernal = sys->rom_kernal;
+    #endif
+    memcpy(sys, &im, C64_SNAPSHOT_SIZE);
+    #if defined(C64_BORROWED_ROMS)
+        _c64_map_memory(sys);
+    #endif
+    chips_text_input_clear(&sys->text_input);
+    if (sys->c1541_link) {
+        c1541_link_init(sys->c1541_link, &sys->c1541, sys->c1541_link->num_ticks, sys->iec_port);
+    }
+    // the whole RAM has changed
+    memset(sys->snapshot_written_pages, 0xFF, sizeof(sys->snapshot_written_pages));
     return true;
 }
 
+size_t c64_save_snapshot_delta(c64_t* sys, const c64_t* base, c64_t* scratch, chips_range_t dst) {
+    CHIPS_ASSERT(sys && base && scratch && dst.ptr);
+    _c64_snapshot_collect_writes(sys);
+    // the RAM isn't copied into the scratch snapshot, but taken directly from the written pages
+    _c64_snapshot_copy_state(sys, scratch);
+    return chips_delta_encode_ram(
+        (chips_range_t){ .ptr = (void*)base, .size = C64_SNAPSHOT_SIZE },
+        (chips_range_t){ .ptr = scratch, .size = C64_SNAPSHOT_SIZE },
+        offsetof(c64_t, ram),
+        (chips_range_t){ .ptr = sys->ram, .size = sizeof(sys->ram) },
+        MEM_PAGE_SIZE,
+        sys->snapshot_written_pages,
+        dst);
+}
+
+bool c64_apply_snapshot_delta(c64_t* inout_snapshot, chips_range_t delta) {
+    CHIPS_ASSERT(inout_snapshot && delta.ptr);
+    return chips_delta_apply(delta, (chips_range_t){ .ptr = inout_snapshot, .size = C64_SNAPSHOT_SIZE });
+}
+
+void c64_boot(c64_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    // run silently and without video decoding or debugger
+    const chips_debug_t debug = sys->debug;
+    const chips_audio_callback_t audio_callback = sys->audio.callback;
+    chips_audio_ring_t* audio_ring = sys->audio.ring;
+    chips_event_ring_t* events = sys->events;
+    const bool video_enabled = c64_video_enabled(sys);
+    const bool warp_enabled = sys->warp.enabled;
+    sys->debug = (chips_debug_t){0};
+    sys->audio.callback = (chips_audio_callback_t){0};
+    sys->audio.ring = 0;
+    sys->events = 0;
+    sys->warp.enabled = false;
+    c64_enable_video(sys, false);
+    for (uint32_t us = 0; us < C64_BOOT_MICRO_SECONDS; us += 20000) {
+        c64_exec(sys, 20000);
+    }
+    sys->debug = debug;
+    sys->audio.callback = audio_callback;
+    sys->audio.ring = audio_ring;
+    sys->events = events;
+    sys->warp.enabled = warp_enabled;
+    c64_enable_video(sys, video_enabled);
+}
+
+uint32_t c64_drive_thread_exec(c64_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid && sys->c1541_link);
+    return c1541_link_exec(sys->c1541_link, &sys->c1541);
+}
+
+void c64_input_text(c64_t* sys, const char* text) {
+    CHIPS_ASSERT(sys && sys->valid);
+    chips_text_input_start(&sys->text_input, (const uint8_t*)text, text ? strlen(text) : 0);
+}
+
+bool c64_input_text_pending(c64_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return chips_text_input_pending(&sys->text_input);
+}
+
+// top up the KERNAL keyboard buffer with pending text input
+static void _c64_text_input_fill(c64_t* sys) {
+    uint8_t num = mem_rd(&sys->mem_cpu, 0xC6);
+    uint8_t max = mem_rd(&sys->mem_cpu, 0x289);
+    if (max > 10) {
+        max = 10;
+    }
+    while ((num < max) && chips_text_input_pending(&sys->text_input)) {
+        uint8_t c = chips_text_input_next(&sys->text_input);
+        if (0 == c) {
+            break;
+        }
+        if ((c >= 'a') && (c <= 'z')) {
+            c = (uint8_t)(c - 'a' + 'A');
+        }
+        _c64_mem_wr(sys, (uint16_t)(0x277 + num++), c);
+    }
+    _c64_mem_wr(sys, 0xC6, num);
+}
+
 void c64_basic_run(c64_t* sys) {
     CHIPS_ASSERT(sys);
     // write RUN into the keyboard buffer
     uint16_t keybuf = 0x277;
-    mem_wr(&sys->mem_cpu, keybuf++, 'R');
-    mem_wr(&sys->mem_cpu, keybuf++, 'U');
-    mem_wr(&sys->mem_cpu, keybuf++, 'N');
-    mem_wr(&sys->mem_cpu, keybuf++, 0x0D);
+    _c64_mem_wr(sys, keybuf++, 'R');
+    _c64_mem_wr(sys, keybuf++, 'U');
+    _c64_mem_wr(sys, keybuf++, 'N');
+    _c64_mem_wr(sys, keybuf++, 0x0D);
     // write number of characters, this kicks off evaluation
-    mem_wr(&sys->mem_cpu, 0xC6, 4);
+    _c64_mem_wr(sys, 0xC6, 4);
 }
 
 void c64_basic_load(c64_t* sys) {
     CHIPS_ASSERT(sys);
     // write LOAD
     uint16_t keybuf = 0x277;
-    mem_wr(&sys->mem_cpu, keybuf++, 'L');
-    mem_wr(&sys->mem_cpu, keybuf++, 'O');
-    mem_wr(&sys->mem_cpu, keybuf++, 'A');
-    mem_wr(&sys->mem_cpu, keybuf++, 'D');
-    mem_wr(&sys->mem_cpu, keybuf++, 0x0D);
+    _c64_mem_wr(sys, keybuf++, 'L');
+    _c64_mem_wr(sys, keybuf++, 'O');
+    _c64_mem_wr(sys, keybuf++, 'A');
+    _c64_mem_wr(sys, keybuf++, 'D');
+    _c64_mem_wr(sys, keybuf++, 0x0D);
     // write number of characters, this kicks off evaluation
-    mem_wr(&sys->mem_cpu, 0xC6, 5);
+    _c64_mem_wr(sys, 0xC6, 5);
 }
 
 void c64_basic_syscall(c64_t* sys, uint16_t addr) {
     CHIPS_ASSERT(sys);
     // write SYS xxxx[Return] into the keyboard buffer (up to 10 chars)
     uint16_t keybuf = 0x277;
-    mem_wr(&sys->mem_cpu, keybuf++, 'S');
-    mem_wr(&sys->mem_cpu, keybuf++, 'Y');
-    mem_wr(&sys->mem_cpu, keybuf++, 'S');
-    mem_wr(&sys->mem_cpu, keybuf++, ((addr / 10000) % 10) + '0');
-    mem_wr(&sys->mem_cpu, keybuf++, ((addr / 1000) % 10) + '0');
-    mem_wr(&sys->mem_cpu, keybuf++, ((addr / 100) % 10) + '0');
-    mem_wr(&sys->mem_cpu, keybuf++, ((addr / 10) % 10) + '0');
-    mem_wr(&sys->mem_cpu, keybuf++, ((addr / 1) % 10) + '0');
-    mem_wr(&sys->mem_cpu, keybuf++, 0x0D);
+    _c64_mem_wr(sys, keybuf++, 'S');
+    _c64_mem_wr(sys, keybuf++, 'Y');
+    _c64_mem_wr(sys, keybuf++, 'S');
+    _c64_mem_wr(sys, keybuf++, ((addr / 10000) % 10) + '0');
+    _c64_mem_wr(sys, keybuf++, ((addr / 1000) % 10) + '0');
+    _c64_mem_wr(sys, keybuf++, ((addr / 100) % 10) + '0');
+    _c64_mem_wr(sys, keybuf++, ((addr / 10) % 10) + '0');
+    _c64_mem_wr(sys, keybuf++, ((addr / 1) % 10) + '0');
+    _c64_mem_wr(sys, keybuf++, 0x0D);
     // write number of characters, this kicks off evaluation
-    mem_wr(&sys->mem_cpu, 0xC6, 9);
+    _c64_mem_wr(sys, 0xC6, 9);
 }
 
 uint16_t c64_syscall_return_addr(void) {
@@ -18,10 +18,52 @@
     ~~~
         your own assert macro (default: assert(c))
 
+    ~~~C
+    CPC_BORROWED_TAPE
+    ~~~
+        if defined, cpc_insert_tape() doesn't copy the tape data into
+        cpc_t but keeps a pointer to it, the tape data must then remain
+        valid and unchanged until the tape is removed, must be the same
+        for all files which include cpc.h
+
+    ~~~C
+    CPC_BORROWED_ROMS
+    ~~~
+        if defined, cpc_init() doesn't copy the ROM images into cpc_t but
+        keeps pointers to the ROM data in cpc_desc_t.roms, the ROM data
+        must then remain valid and unchanged until cpc_discard() is called
+        (this allows many instances to share one copy of the ROMs), ROMs are
+        also not part of snapshots, snapshots must be loaded into an instance
+        which was initialized with the same ROM images, must be the same for
+        all files which include cpc.h
+
+    ~~~C
+    CHIPS_CPC_TYPE_6128
+    CHIPS_CPC_TYPE_464
+    CHIPS_CPC_TYPE_KCCOMPACT
+    ~~~
+        optionally define one of those to build an emulator for a single
+        machine model, model checks are then resolved at compile time and
+        cpc_desc_t.type is ignored (by default the model is selected at
+        runtime with cpc_desc_t.type), must be the same for all files which
+        include cpc.h
+
+    ~~~C
+    CPC_NO_FRAMEBUFFER
+    ~~~
+        if defined, cpc_t doesn't contain a framebuffer and video decoding
+        is permanently disabled (cpc_enable_video() and
+        cpc_enable_video_debugging() have no effect), this is useful for
+        headless instances (e.g. automated tests or servers) which only
+        need the CPU and I/O side of the emulation, the framebuffer pointer
+        in cpc_display_info() is then null, must be the same for all files
+        which include cpc.h
+
     You need to include the following headers before including cpc.h:
 
     - chips/chips_common.h
     - chips/z80.h
+    - chips/blip.h (only with CHIPS_BLIP)
     - chips/ay38910.h
     - chips/i8255.h
     - chips/mc6845.h
@@ -45,6 +87,87 @@
 
     FIXME!
 
+    ## Tape Loading
+
+    Tape images in the .CDT format (which is the same as the ZX Spectrum
+    .TZX format) can be inserted with cpc_insert_tape(). There's no
+    emulation of the cassette signal, instead the firmware CAS READ
+    routine is trapped and the requested block is copied directly from
+    the tape image into memory. The address of the trapped routine is taken
+    from the CAS READ jumpblock entry at 0xBCA1, so this works with all
+    supported CPC models as long as the jumpblock isn't patched.
+
+    Only standard speed data blocks (0x10) and turbo speed data
+    blocks (0x11) are recognized, all other blocks are skipped. If no
+    block with the requested sync byte is found, CAS READ isn't trapped and
+    the firmware is left waiting for tape input (press ESC to cancel).
+
+    ## Video Thread
+
+    The pixel decoding can be moved to a separate thread by providing an
+    am40010_video_queue_t in cpc_desc_t.video_queue (see 'Video Thread'
+    in am40010.h). The gate array then only collects the video memory
+    bytes and video state per scanline, and the host's video thread
+    decodes them into the framebuffer while the emulation continues:
+
+    ~~~C
+    static am40010_video_job_t jobs[256];
+    static am40010_video_queue_t queue;
+    am40010_video_queue_init(&queue, jobs, 256);
+    cpc_init(&sys, &(cpc_desc_t){
+        .video_queue = &queue,
+        ...
+    });
+    // start a thread which calls am40010_video_queue_decode(&queue) in a loop
+    ~~~
+
+    The video thread must run whenever the emulation runs. cpc_exec()
+    waits for the video thread to finish the queued scanlines before it
+    returns, so the framebuffer is complete after each call, exactly
+    like without a video thread.
+
+    ## Boot Snapshots
+
+    After a cold start the CPC needs a moment to initialize the firmware
+    and (on the 6128) AMSDOS before the BASIC prompt is ready. To skip
+    this for new instances, boot one instance with cpc_boot(), save a
+    snapshot of it with cpc_save_snapshot() and provide the snapshot in
+    cpc_desc_t.boot_snapshot when initializing further instances. Those
+    then start directly at the BASIC prompt. The boot snapshot must have
+    been created for the same CPC type and with the same ROM images.
+
+    ## Memory Footprint
+
+    By default cpc_t embeds the floppy disc image, the tape buffer and the
+    ROM images, so that a single instance is self-contained (about 1.7
+    MBytes, most of which is part of snapshots). When running many
+    instances (for instance a CPC 464 without disc drive), define the
+    following macros to keep the large buffers in caller-owned memory
+    (which can be shared between instances) instead:
+
+    - FDD_BORROWED_DATA: disc images (saves almost 1 MByte, the remaining
+      sector overlay for writes can be shrunk with FDD_MAX_OVERLAY_SECTORS)
+    - CPC_BORROWED_TAPE: tape images (saves 128 KBytes)
+    - CPC_BORROWED_ROMS: ROM images (saves 48 KBytes)
+
+    With all of these defined, a cpc_t is below 600 KBytes, and snapshots
+    shrink to about 200 KBytes, most of the remaining size is the 128 KByte
+    RAM and the framebuffer (which isn't part of snapshots).
+
+    ## Delta Snapshots
+
+    cpc_save_snapshot_delta() encodes the difference between the current
+    state and the most recent snapshot saved from the same instance with
+    cpc_save_snapshot() (see 'Delta Snapshots' in chips_common.h). The
+    caller-provided scratch snapshot receives all state except the RAM,
+    the RAM is only compared against the base snapshot in pages which have
+    been written since the base snapshot was saved. When compiled with
+    MEM_TRACK_ACCESS (see 'Access Tracking' in mem.h) the written pages
+    are taken from the CPU mem_t (which means the written bits are consumed
+    by the CPC emulation), otherwise all RAM pages are compared. To keep
+    the part which is copied into the scratch snapshot small, define the
+    macros described in 'Memory Footprint'.
+
     ## TODO
 
     - improve CRTC emulation, some graphics demos don't work yet
@@ -78,7 +201,9 @@ extern "C" {
 #endif
 
 // bump when cpc_t memory layout changes
-#define CPC_SNAPSHOT_VERSION (0x0001)
+#define CPC_SNAPSHOT_VERSION (0x000F)
+
+#define CPC_BOOT_MICRO_SECONDS (2000000)    // time run by cpc_boot() until the BASIC prompt is ready
 
 #define CPC_MAX_AUDIO_SAMPLES (1024)        // max number of audio samples in internal sample buffer
 #define CPC_DEFAULT_AUDIO_SAMPLES (128)     // default number of samples in internal sample buffer
@@ -106,12 +231,17 @@ typedef enum {
 #define CPC_JOYSTICK_BTN0  (1<<4)
 #define CPC_JOYSTICK_BTN1  (1<<4)
 
+struct cpc_t;
+
 // configuration parameters for cpc_init()
 typedef struct {
     cpc_type_t type;                // default is the CPC 6128
     cpc_joystick_type_t joystick_type;
     chips_debug_t debug;
     chips_audio_desc_t audio;
+    chips_warp_desc_t warp;         // optional automatic warp mode while the disc drive motor is on
+    const struct cpc_t* boot_snapshot;  // optional snapshot taken after cpc_boot() to start in booted state
+    am40010_video_queue_t* video_queue; // optional, decode video on a separate thread (see 'Video Thread')
 
     // ROM images
     struct {
@@ -134,10 +264,20 @@ typedef struct {
     } roms;
 } cpc_desc_t;
 
-// CPC emulator state
+// per-frame statistics counters (only updated when CHIPS_STATS is defined)
 typedef struct {
+    uint32_t ticks;             // number of ticks executed in the last cpc_exec() call
+    uint32_t wait_ticks;        // CPU ticks stalled by the gate array WAIT signal
+    uint32_t mem_accesses;      // memory read and write accesses
+    uint32_t io_requests;       // IO requests (without interrupt acknowledge)
+    am40010_stats_t ga;         // gate array interrupt and video decode counters
+} cpc_stats_t;
+
+// CPC emulator state
+typedef struct cpc_t {
     z80_t cpu;
     ay38910_t psg;
+    uint32_t psg_ticks;         // PSG ticks which haven't been executed yet (see _cpc_psg_sync())
     mc6845_t crtc;
     i8255_t ppi;
     upd765_t fdc;
@@ -148,27 +288,66 @@ typedef struct {
     uint8_t kbd_joymask;
     uint8_t joy_joymask;
 
-    kbd_t kbd;
-    mem_t mem;
-
     uint64_t pins;
+    uint32_t tick_frac;         // fractional tick carried over between cpc_exec() calls (see clk_us_to_ticks_frac())
     bool valid;
     chips_debug_t debug;
+    cpc_stats_t stats;
+    // keyboard and memory mapping last, their bulk tables follow the per-tick state (see CPC_HOT_SIZE)
+    kbd_t kbd;
+    mem_t mem;
 
+    uint8_t ram[8][0x4000];
+    #if defined(CPC_BORROWED_ROMS)
+    const uint8_t* rom_os;          // borrowed ROM images, not part of snapshots
+    const uint8_t* rom_basic;
+    const uint8_t* rom_amsdos;
+    #else
+    uint8_t rom_os[0x4000];
+    uint8_t rom_basic[0x4000];
+    uint8_t rom_amsdos[0x4000];
+    #endif
+    fdd_t fdd;
+    // tape loading (CDT files via the trapped CAS READ firmware routine)
+    struct {
+        int size;   // size is > 0 if a tape is inserted
+        int pos;    // current read position in tape data
+        #if defined(CPC_BORROWED_TAPE)
+        const uint8_t* buf;     // borrowed tape data, not part of snapshots
+        #else
+        uint8_t buf[CPC_MAX_TAPE_SIZE];
+        #endif
+    } tape;
+
+    // output-only state starting at audio.sample_buffer is not part of snapshots
     struct {
         chips_audio_callback_t callback;
         int num_samples;
         int sample_pos;
         float sample_buffer[CPC_MAX_AUDIO_SAMPLES];
+        chips_audio_ring_t* ring;
     } audio;
-    uint8_t ram[8][0x4000];
-    uint8_t rom_os[0x4000];
-    uint8_t rom_basic[0x4000];
-    uint8_t rom_amsdos[0x4000];
+    // automatic warp mode (see "Automatic Warp Mode" in chips_common.h)
+    struct {
+        bool enabled;
+        bool active;        // true while running the warp time slices inside cpc_exec()
+        bool warped;        // true if the last cpc_exec() call ran warp time slices
+        int max_slices;
+    } warp;
+    // RAM pages written since the last saved snapshot (see "Delta Snapshots")
+    uint64_t snapshot_written_pages[((0x20000 >> MEM_PAGE_SHIFT) + 63) / 64];
+    #if !defined(CPC_NO_FRAMEBUFFER)
     alignas(64) uint8_t fb[AM40010_FRAMEBUFFER_SIZE_BYTES];
-    fdd_t fdd;
+    #endif
+    // currently mapped gate array memory configuration, -1 if the memory mapping must be rebuilt
+    int mem_config;
 } cpc_t;
 
+// size of the part of cpc_t which is stored in snapshots (the audio sample buffer and framebuffer are excluded)
+#define CPC_SNAPSHOT_SIZE (offsetof(cpc_t, audio.sample_buffer))
+// size of the state at the start of cpc_t which is accessed on every tick, not counting the RAM
+#define CPC_HOT_SIZE (offsetof(cpc_t, mem.layers))
+
 // initialize a new CPC instance
 void cpc_init(cpc_t* cpc, const cpc_desc_t* desc);
 // discard a CPC instance
@@ -179,6 +358,10 @@ void cpc_reset(cpc_t* cpc);
 chips_display_info_t cpc_display_info(cpc_t* cpc);
 // run CPC instance for given amount of micro_seconds, returns number of ticks executed
 uint32_t cpc_exec(cpc_t* cpc, uint32_t micro_seconds);
+// run CPC instance for given number of ticks, returns number of ticks executed
+uint32_t cpc_exec_ticks(cpc_t* cpc, uint32_t num_ticks);
+// run CPC instance until the gate array's CRT beam returns to the top, returns number of ticks executed
+uint32_t cpc_exec_frame(cpc_t* cpc);
 // send a key down event
 void cpc_key_down(cpc_t* cpc, int key_code);
 // send a key up event
@@ -197,20 +380,42 @@ bool cpc_quickload(cpc_t* cpc, chips_range_t data, bool start);
 uint16_t cpc_quickload_exec_addr(chips_range_t data);
 // return the return-address for a quickloaded file
 uint16_t cpc_quickload_return_addr(cpc_t* cpc);
-// insert a disk image file (.dsk)
+// insert a disk image file (.dsk), with FDD_BORROWED_DATA the data must remain valid until the disc is removed
 bool cpc_insert_disc(cpc_t* cpc, chips_range_t data);
 // remove current disc
 void cpc_remove_disc(cpc_t* cpc);
 // return true if a floppy disc is currently inserted
 bool cpc_disc_inserted(cpc_t* cpc);
+// insert a tape file (.cdt), with CPC_BORROWED_TAPE the data must remain valid until the tape is removed
+bool cpc_insert_tape(cpc_t* cpc, chips_range_t data);
+// remove current tape
+void cpc_remove_tape(cpc_t* cpc);
+// return true if a tape is currently inserted
+bool cpc_tape_inserted(cpc_t* cpc);
 // if enabled, start calling the video-debugging-callback
 void cpc_enable_video_debugging(cpc_t* cpc, bool enabled);
 // get current display debug visualization enabled/disabled state
 bool cpc_video_debugging_enabled(cpc_t* cpc);
+// enable/disable video decoding (e.g. for fast-forwarding or headless operation)
+void cpc_enable_video(cpc_t* cpc, bool enabled);
+// return true if video decoding is enabled
+bool cpc_video_enabled(cpc_t* cpc);
+// get statistics counters of the last cpc_exec() call (needs CHIPS_STATS)
+cpc_stats_t cpc_stats(cpc_t* sys);
+// enable/disable automatic warp mode while the disc drive motor is on
+void cpc_enable_auto_warp(cpc_t* sys, bool enabled);
+// return true if the last cpc_exec() call ran in warp mode
+bool cpc_is_warping(cpc_t* sys);
+// run a freshly initialized instance until the BASIC prompt is ready (for creating boot snapshots)
+void cpc_boot(cpc_t* sys);
 // take a snapshot, patches any pointers to zero, returns snapshot version
 uint32_t cpc_save_snapshot(cpc_t* sys, cpc_t* dst);
 // load a snapshot, returns false if snapshot version doesn't match
-bool cpc_load_snapshot(cpc_t* sys, uint32_t version, cpc_t* src);
+bool cpc_load_snapshot(cpc_t* sys, uint32_t version, const cpc_t* src);
+// save a delta snapshot relative to the last snapshot saved from sys, scratch is caller-provided temp storage, returns number of bytes written to dst, or 0 if dst is too small
+size_t cpc_save_snapshot_delta(cpc_t* sys, const cpc_t* base, cpc_t* scratch, chips_range_t dst);
+// apply a delta snapshot to a copy of its base snapshot, the result can be loaded with cpc_load_snapshot()
+bool cpc_apply_snapshot_delta(cpc_t* inout_snapshot, chips_range_t delta);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -227,19 +432,36 @@ bool cpc_load_snapshot(cpc_t* sys, uint32_t version, cpc_t* src);
 #define _CPC_FREQUENCY (4000000)
 
 static uint64_t _cpc_cclk(void* user_data);
+static void _cpc_psg_sync(cpc_t* sys);
 static void _cpc_psg_out(int port_id, uint8_t data, void* user_data);
 static uint8_t _cpc_psg_in(int port_id, void* user_data);
 static void _cpc_init_keymap(cpc_t* sys);
 static void _cpc_bankswitch(uint8_t ram_config, uint8_t rom_enable, uint8_t rom_select, void* user_data);
+static void _cpc_snapshot_collect_writes(cpc_t* sys);
 static int _cpc_fdc_seektrack(int drive, int track, void* user_data);
 static int _cpc_fdc_seeksector(int drive, int side, upd765_sectorinfo_t* inout_info, void* user_data);
 static int _cpc_fdc_read(int drive, int side, void* user_data, uint8_t* out_data);
 static int _cpc_fdc_write(int drive, int side, void* user_data, uint8_t data);
+static int _cpc_fdc_sectordata(int drive, int side, void* user_data, const uint8_t** out_ptr, int* out_size);
 static int _cpc_fdc_trackinfo(int drive, int side, void* user_data, upd765_sectorinfo_t* out_info);
 static void _cpc_fdc_driveinfo(int drive, void* user_data, upd765_driveinfo_t* out_info);
+static bool _cpc_tape_trap(cpc_t* sys, uint16_t addr);
 
 #define _CPC_DEFAULT(val,def) (((val) != 0) ? (val) : (def))
 
+// the compile-time model if one of the CHIPS_CPC_TYPE_* macros is defined, otherwise the runtime model
+#if (defined(CHIPS_CPC_TYPE_6128) + defined(CHIPS_CPC_TYPE_464) + defined(CHIPS_CPC_TYPE_KCCOMPACT)) > 1
+#error "Please define only one of CHIPS_CPC_TYPE_6128, CHIPS_CPC_TYPE_464 or CHIPS_CPC_TYPE_KCCOMPACT!"
+#elif defined(CHIPS_CPC_TYPE_6128)
+#define _CPC_TYPE(obj) ((void)(obj), CPC_TYPE_6128)
+#elif defined(CHIPS_CPC_TYPE_464)
+#define _CPC_TYPE(obj) ((void)(obj), CPC_TYPE_464)
+#elif defined(CHIPS_CPC_TYPE_KCCOMPACT)
+#define _CPC_TYPE(obj) ((void)(obj), CPC_TYPE_KCCOMPACT)
+#else
+#define _CPC_TYPE(obj) ((obj)->type)
+#endif
+
 void cpc_init(cpc_t* sys, const cpc_desc_t* desc) {
     CHIPS_ASSERT(sys && desc);
     if (desc->debug.callback.func) { CHIPS_ASSERT(desc->debug.stopped); }
@@ -247,29 +469,49 @@ void cpc_init(cpc_t* sys, const cpc_desc_t* desc) {
     memset(sys, 0, sizeof(cpc_t));
     sys->valid = true;
     sys->debug = desc->debug;
-    sys->type = desc->type;
+    sys->type = _CPC_TYPE(desc);
     sys->joystick_type = desc->joystick_type;
     sys->audio.callback = desc->audio.callback;
+    sys->audio.ring = desc->audio.ring;
     sys->audio.num_samples = _CPC_DEFAULT(desc->audio.num_samples, CPC_DEFAULT_AUDIO_SAMPLES);
+    sys->warp.enabled = desc->warp.enabled;
+    sys->warp.max_slices = _CPC_DEFAULT(desc->warp.max_slices, CHIPS_DEFAULT_WARP_SLICES);
     CHIPS_ASSERT(sys->audio.num_samples <= CPC_MAX_AUDIO_SAMPLES);
-    if (CPC_TYPE_464 == desc->type) {
+    if (CPC_TYPE_464 == _CPC_TYPE(sys)) {
         CHIPS_ASSERT(desc->roms.cpc464.os.ptr && (desc->roms.cpc464.os.size == 0x4000));
         CHIPS_ASSERT(desc->roms.cpc464.basic.ptr && (desc->roms.cpc464.basic.size == 0x4000));
-        memcpy(sys->rom_os, desc->roms.cpc464.os.ptr, 0x4000);
-        memcpy(sys->rom_basic, desc->roms.cpc464.basic.ptr, 0x4000);
-    } else if (CPC_TYPE_6128 == desc->type) {
+        #if defined(CPC_BORROWED_ROMS)
+            sys->rom_os = (const uint8_t*) desc->roms.cpc464.os.ptr;
+            sys->rom_basic = (const uint8_t*) desc->roms.cpc464.basic.ptr;
+        #else
+            memcpy(sys->rom_os, desc->roms.cpc464.os.ptr, 0x4000);
+            memcpy(sys->rom_basic, desc->roms.cpc464.basic.ptr, 0x4000);
+        #endif
+    } else if (CPC_TYPE_6128 == _CPC_TYPE(sys)) {
         CHIPS_ASSERT(desc->roms.cpc6128.os.ptr && (desc->roms.cpc6128.os.size == 0x4000));
         CHIPS_ASSERT(desc->roms.cpc6128.basic.ptr && (desc->roms.cpc6128.basic.size == 0x4000));
         CHIPS_ASSERT(desc->roms.cpc6128.amsdos.ptr && (desc->roms.cpc6128.amsdos.size == 0x4000));
-        memcpy(sys->rom_os, desc->roms.cpc6128.os.ptr, 0x4000);
-        memcpy(sys->rom_basic, desc->roms.cpc6128.basic.ptr, 0x4000);
-        memcpy(sys->rom_amsdos, desc->roms.cpc6128.amsdos.ptr, 0x4000);
+        #if defined(CPC_BORROWED_ROMS)
+            sys->rom_os = (const uint8_t*) desc->roms.cpc6128.os.ptr;
+            sys->rom_basic = (const uint8_t*) desc->roms.cpc6128.basic.ptr;
+            sys->rom_amsdos = (const uint8_t*) desc->roms.cpc6128.amsdos.ptr;
+        #else
+            memcpy(sys->rom_os, desc->roms.cpc6128.os.ptr, 0x4000);
+            memcpy(sys->rom_basic, desc->roms.cpc6128.basic.ptr, 0x4000);
+            memcpy(sys->rom_amsdos, desc->roms.cpc6128.amsdos.ptr, 0x4000);
+        #endif
     } else { // KC Compact
         CHIPS_ASSERT(desc->roms.kcc.os.ptr && (desc->roms.kcc.os.size == 0x4000));
         CHIPS_ASSERT(desc->roms.kcc.basic.ptr && (desc->roms.kcc.basic.size == 0x4000));
-        memcpy(sys->rom_os, desc->roms.kcc.os.ptr, 0x4000);
-        memcpy(sys->rom_basic, desc->roms.kcc.basic.ptr, 0x4000);
+        #if defined(CPC_BORROWED_ROMS)
+            sys->rom_os = (const uint8_t*) desc->roms.kcc.os.ptr;
+            sys->rom_basic = (const uint8_t*) desc->roms.kcc.basic.ptr;
+        #else
+            memcpy(sys->rom_os, desc->roms.kcc.os.ptr, 0x4000);
+            memcpy(sys->rom_basic, desc->roms.kcc.basic.ptr, 0x4000);
+        #endif
     }
+    sys->mem_config = -1;
 
     // initialize the hardware
     sys->pins = z80_init(&sys->cpu);
@@ -293,10 +535,13 @@ void cpc_init(cpc_t* sys, const cpc_desc_t* desc) {
             .ptr = &sys->ram[0][0],
             .size = sizeof(sys->ram)
         },
+        #if !defined(CPC_NO_FRAMEBUFFER)
         .framebuffer = {
             .ptr = &sys->fb[0],
             .size = sizeof(sys->fb),
         },
+        .video_queue = desc->video_queue,
+        #endif
         .user_data = sys,
     });
     upd765_init(&sys->fdc, &(upd765_desc_t){
@@ -304,6 +549,7 @@ void cpc_init(cpc_t* sys, const cpc_desc_t* desc) {
         .seeksector_cb = _cpc_fdc_seeksector,
         .read_cb = _cpc_fdc_read,
         .write_cb = _cpc_fdc_write,
+        .sectordata_cb = _cpc_fdc_sectordata,
         .trackinfo_cb = _cpc_fdc_trackinfo,
         .driveinfo_cb = _cpc_fdc_driveinfo,
         .user_data = sys,
@@ -311,6 +557,16 @@ void cpc_init(cpc_t* sys, const cpc_desc_t* desc) {
     fdd_init(&sys->fdd);
 
     _cpc_init_keymap(sys);
+    // there's no base snapshot yet
+    memset(sys->snapshot_written_pages, 0xFF, sizeof(sys->snapshot_written_pages));
+    if (desc->boot_snapshot) {
+        // skip the firmware boot sequence
+        CHIPS_ASSERT(desc->boot_snapshot->type == sys->type);
+        const int num_samples = sys->audio.num_samples;
+        cpc_load_snapshot(sys, CPC_SNAPSHOT_VERSION, desc->boot_snapshot);
+        sys->audio.num_samples = num_samples;
+        sys->audio.sample_pos = 0;
+    }
 }
 
 void cpc_discard(cpc_t* sys) {
@@ -321,8 +577,10 @@ void cpc_discard(cpc_t* sys) {
 void cpc_reset(cpc_t* sys) {
     CHIPS_ASSERT(sys && sys->valid);
     mem_unmap_all(&sys->mem);
+    sys->mem_config = -1;
     mc6845_reset(&sys->crtc);
     ay38910_reset(&sys->psg);
+    sys->psg_ticks = 0;
     i8255_reset(&sys->ppi);
     am40010_reset(&sys->ga);
     sys->pins = z80_reset(&sys->cpu);
@@ -331,17 +589,32 @@ void cpc_reset(cpc_t* sys) {
 }
 
 static uint64_t _cpc_tick(cpc_t* sys, uint64_t cpu_pins) {
+    #if defined(CHIPS_STATS)
+    // the Z80 decoder step doesn't advance while the CPU is in a wait state
+    const uint16_t step = sys->cpu.step;
     cpu_pins = z80_tick(&sys->cpu, cpu_pins);
+    if (step == sys->cpu.step) {
+        sys->stats.wait_ticks++;
+    }
+    #else
+    cpu_pins = z80_tick(&sys->cpu, cpu_pins);
+    #endif
 
     // memory and IO requests
     if (cpu_pins & Z80_MREQ) {
+        CHIPS_STATS_INC(sys->stats.mem_accesses);
         const uint16_t addr = Z80_GET_ADDR(cpu_pins);
         if (cpu_pins & Z80_RD) {
             Z80_SET_DATA(cpu_pins, mem_rd(&sys->mem, addr));
+            // check for the firmware CAS READ routine when a tape is inserted
+            if ((cpu_pins & Z80_M1) && (sys->tape.size > 0) && (addr < 0x4000)) {
+                _cpc_tape_trap(sys, addr);
+            }
         } else if (cpu_pins & Z80_WR) {
             mem_wr(&sys->mem, addr, Z80_GET_DATA(cpu_pins));
         }
     } else if ((cpu_pins & (Z80_M1|Z80_IORQ)) == Z80_IORQ) {
+        CHIPS_STATS_INC(sys->stats.io_requests);
         /* CPU IO address decoding
 
             For address decoding, see the main board schematics!
@@ -392,6 +665,7 @@ static uint64_t _cpc_tick(cpc_t* sys, uint64_t cpu_pins) {
                 if (sys->ppi.pins & I8255_PC6) { ay_pins |= AY38910_BC1; }
                 const uint8_t ay_data = I8255_GET_PA(sys->ppi.pins);
                 AY38910_SET_DATA(ay_pins, ay_data);
+                _cpc_psg_sync(sys);
                 ay_pins = ay38910_iorq(&sys->psg, ay_pins);
                 I8255_SET_PA(ppi_pins, AY38910_GET_DATA(ay_pins));
             }
@@ -412,6 +686,7 @@ static uint64_t _cpc_tick(cpc_t* sys, uint64_t cpu_pins) {
                 if (ppi_pins & I8255_PC6) { ay_pins |= AY38910_BC1; }
                 const uint8_t ay_data = I8255_GET_PA(ppi_pins);
                 AY38910_SET_DATA(ay_pins, ay_data);
+                _cpc_psg_sync(sys);
                 ay38910_iorq(&sys->psg, ay_pins);
             }
             // PC0..PC3: select keyboard matrix line
@@ -453,6 +728,7 @@ static uint64_t _cpc_tick(cpc_t* sys, uint64_t cpu_pins) {
         if ((cpu_pins & (Z80_A10|Z80_A8|Z80_A7)) == 0) {
             if (cpu_pins & Z80_WR) {
                 fdd_motor(&sys->fdd, 0 != (Z80_GET_DATA(cpu_pins) & 1));
+                upd765_invalidate_sector(&sys->fdc);
             }
         } else if ((cpu_pins & (Z80_A10|Z80_A8|Z80_A7)) == Z80_A8) {
             // floppy controller status/data register
@@ -475,24 +751,71 @@ static uint64_t _cpc_tick(cpc_t* sys, uint64_t cpu_pins) {
 */
 static uint64_t _cpc_cclk(void* user_data) {
     cpc_t* sys = (cpc_t*) user_data;
-    // tick the sound chip...
-    if (ay38910_tick(&sys->psg)) {
-        // new sound sample ready
-        sys->audio.sample_buffer[sys->audio.sample_pos++] = sys->psg.sample;
-        if (sys->audio.sample_pos == sys->audio.num_samples) {
-            if (sys->audio.callback.func) {
-                // new sample packet is ready
-                sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
-            }
-            sys->audio.sample_pos = 0;
-        }
-    }
+    // the sound chip is only ticked lazily (see _cpc_psg_sync())
+    sys->psg_ticks++;
     // tick the CRTC and return its pin mask
     uint64_t crtc_pins = mc6845_tick(&sys->crtc);
     return crtc_pins;
 }
 
 // PSG OUT callback (nothing to do here)
+/* catch up with the PSG ticks which have been accumulated since the last
+   call, this must happen before each PSG register access and at the end
+   of cpc_exec(), generated audio samples are identical to ticking the
+   PSG on each CCLK tick
+*/
+static void _cpc_psg_sync(cpc_t* sys) {
+    while (sys->psg_ticks > 0) {
+        // write directly into the host's ring buffer if provided, otherwise into the sample buffer
+        float* dst;
+        int max_samples;
+        uint32_t num_free = 0;
+        if (sys->warp.active) {
+            // warp mode: generate the samples behind the current sample buffer position and drop them
+            dst = &sys->audio.sample_buffer[sys->audio.sample_pos];
+            max_samples = CPC_MAX_AUDIO_SAMPLES - sys->audio.sample_pos;
+        }
+        else if (sys->audio.ring) {
+            dst = chips_audio_ring_begin_write(sys->audio.ring, &num_free);
+            if (0 == num_free) {
+                // ring buffer is full, generate the samples into the sample buffer and drop them
+                dst = sys->audio.sample_buffer;
+                max_samples = CPC_MAX_AUDIO_SAMPLES;
+            }
+            else {
+                max_samples = (num_free < CPC_MAX_AUDIO_SAMPLES) ? (int)num_free : CPC_MAX_AUDIO_SAMPLES;
+            }
+        }
+        else {
+            dst = &sys->audio.sample_buffer[sys->audio.sample_pos];
+            max_samples = sys->audio.num_samples - sys->audio.sample_pos;
+        }
+        int num_samples = 0;
+        sys->psg_ticks -= ay38910_run(&sys->psg, sys->psg_ticks, dst, max_samples, &num_samples);
+        if (sys->warp.active) {
+            continue;
+        }
+        if (sys->audio.ring) {
+            if (num_free > 0) {
+                chips_audio_ring_end_write(sys->audio.ring, (uint32_t)num_samples);
+            }
+            else {
+                sys->audio.ring->dropped += (uint32_t)num_samples;
+            }
+        }
+        else {
+            sys->audio.sample_pos += num_samples;
+            if (sys->audio.sample_pos == sys->audio.num_samples) {
+                if (sys->audio.callback.func) {
+                    // new sample packet is ready
+                    sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
+                }
+                sys->audio.sample_pos = 0;
+            }
+        }
+    }
+}
+
 static void _cpc_psg_out(int port_id, uint8_t data, void* user_data) {
     // this shouldn't be called
     (void)port_id;
@@ -539,69 +862,172 @@ static const int _cpc_ram_config[8][4] = {
     { 0, 7, 2, 3 }
 };
 
-// memory bankswitch callback, invoked by gate array (am40010)
-static void _cpc_bankswitch(uint8_t ram_config, uint8_t rom_enable, uint8_t rom_select, void* user_data) {
-    cpc_t* sys = (cpc_t*) user_data;
-    int ram_config_index;
-    const uint8_t* rom0_ptr;
-    const uint8_t* rom1_ptr;
-    if (CPC_TYPE_6128 == sys->type) {
-        ram_config_index = ram_config & 7;
-        rom0_ptr = sys->rom_os;
-        rom1_ptr = (rom_select == 7) ? sys->rom_amsdos : sys->rom_basic;
-    } else {
-        ram_config_index = 0;
-        rom0_ptr = sys->rom_os;
-        rom1_ptr = sys->rom_basic;
-    }
+// unique index of a memory configuration, lower_rom: 0 = RAM, 1 = OS ROM, upper_rom: 0 = RAM, 1 = BASIC, 2 = AMSDOS
+static inline int _cpc_mem_config_index(int ram_config_index, int lower_rom, int upper_rom) {
+    return (ram_config_index * 2 + lower_rom) * 3 + upper_rom;
+}
+
+// build a complete memory configuration and map it in one go
+static void _cpc_map_mem_config(cpc_t* sys, int ram_config_index, int lower_rom, int upper_rom) {
     const int i0 = _cpc_ram_config[ram_config_index][0];
     const int i1 = _cpc_ram_config[ram_config_index][1];
     const int i2 = _cpc_ram_config[ram_config_index][2];
     const int i3 = _cpc_ram_config[ram_config_index][3];
-
+    mem_bank_t bank;
+    mem_bank_init(&bank);
     // 0x0000 .. 0x3FFF
-    if (rom_enable & AM40010_CONFIG_LROMEN) {
-        // read/write RAM
-        mem_map_ram(&sys->mem, 0, 0x0000, 0x4000, sys->ram[i0]);
-    } else {
+    if (lower_rom) {
         // RAM-behind-ROM
-        mem_map_rw(&sys->mem, 0, 0x0000, 0x4000, rom0_ptr, sys->ram[i0]);
+        mem_bank_map_rw(&bank, 0x0000, 0x4000, sys->rom_os, sys->ram[i0]);
+    } else {
+        // read/write RAM
+        mem_bank_map_ram(&bank, 0x0000, 0x4000, sys->ram[i0]);
     }
     // 0x4000 .. 0x7FFF
-    mem_map_ram(&sys->mem, 0, 0x4000, 0x4000, sys->ram[i1]);
+    mem_bank_map_ram(&bank, 0x4000, 0x4000, sys->ram[i1]);
     // 0x8000 .. 0xBFFF
-    mem_map_ram(&sys->mem, 0, 0x8000, 0x4000, sys->ram[i2]);
+    mem_bank_map_ram(&bank, 0x8000, 0x4000, sys->ram[i2]);
     // 0xC000 .. 0xFFFF
-    if (rom_enable & AM40010_CONFIG_HROMEN) {
+    if (upper_rom) {
+        // RAM-behind-ROM
+        mem_bank_map_rw(&bank, 0xC000, 0x4000, (upper_rom == 2) ? sys->rom_amsdos : sys->rom_basic, sys->ram[i3]);
+    } else {
         // read/write RAM
-        mem_map_ram(&sys->mem, 0, 0xC000, 0x4000, sys->ram[i3]);
+        mem_bank_map_ram(&bank, 0xC000, 0x4000, sys->ram[i3]);
+    }
+    mem_map_bank(&sys->mem, 0, &bank);
+}
+
+// memory bankswitch callback, invoked by gate array (am40010)
+static void _cpc_bankswitch(uint8_t ram_config, uint8_t rom_enable, uint8_t rom_select, void* user_data) {
+    cpc_t* sys = (cpc_t*) user_data;
+    int ram_config_index;
+    int upper_rom;
+    if (CPC_TYPE_6128 == _CPC_TYPE(sys)) {
+        ram_config_index = ram_config & 7;
+        upper_rom = (rom_select == 7) ? 2 : 1;
     } else {
-        // RAM-behind-ROM
-        mem_map_rw(&sys->mem, 0, 0xC000, 0x4000, rom1_ptr, sys->ram[i3]);
+        ram_config_index = 0;
+        upper_rom = 1;
+    }
+    const int lower_rom = (rom_enable & AM40010_CONFIG_LROMEN) ? 0 : 1;
+    if (rom_enable & AM40010_CONFIG_HROMEN) {
+        upper_rom = 0;
+    }
+    // the gate array also calls this when only the video mode changes
+    const int mem_config = _cpc_mem_config_index(ram_config_index, lower_rom, upper_rom);
+    if (mem_config != sys->mem_config) {
+        // the written pages must be collected before their mapping changes
+        _cpc_snapshot_collect_writes(sys);
+        _cpc_map_mem_config(sys, ram_config_index, lower_rom, upper_rom);
+        sys->mem_config = mem_config;
     }
 }
 
-uint32_t cpc_exec(cpc_t* sys, uint32_t micro_seconds) {
-    CHIPS_ASSERT(sys && sys->valid);
-    const uint32_t num_ticks = clk_us_to_ticks(_CPC_FREQUENCY, micro_seconds);
+/* run a time slice of at most num_ticks, in frame mode the time slice ends
+   right after the tick which has wrapped the CRT beam of the gate array
+   back to the top, this happens at the end of the vertical retrace after
+   the CRTC's VSYNC (or after 312 lines if the CRTC doesn't generate a VSYNC)
+*/
+static uint32_t _cpc_exec_slice(cpc_t* sys, uint32_t num_ticks, bool frame_mode) {
     uint64_t pins = sys->pins;
+    uint32_t tick = 0;
     if (0 == sys->debug.callback.func) {
-        // run without debug hook
-        for (uint32_t tick = 0; tick < num_ticks; tick++) {
-            pins = _cpc_tick(sys, pins);
+        if (frame_mode) {
+            // run without debug hook until the next frame
+            while (tick < num_ticks) {
+                const int v_pos = sys->ga.crt.v_pos;
+                pins = _cpc_tick(sys, pins);
+                tick++;
+                if (sys->ga.crt.v_pos < v_pos) {
+                    break;
+                }
+            }
+        } else {
+            // run without debug hook
+            for (; tick < num_ticks; tick++) {
+                pins = _cpc_tick(sys, pins);
+            }
         }
     } else {
         // run with debug hook
-        for (uint32_t tick = 0; (tick < num_ticks) && !(*sys->debug.stopped); tick++) {
+        chips_debug_filter_t* filter = sys->debug.filter;
+        while ((tick < num_ticks) && !(*sys->debug.stopped)) {
+            const int v_pos = sys->ga.crt.v_pos;
             pins = _cpc_tick(sys, pins);
-            sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            tick++;
+            if ((0 == filter) || chips_debug_filter_hit(filter, z80_opdone(&sys->cpu), Z80_GET_ADDR(pins),
+                    (pins & (Z80_MREQ|Z80_RD)) == (Z80_MREQ|Z80_RD), (pins & (Z80_MREQ|Z80_WR)) == (Z80_MREQ|Z80_WR))) {
+                sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            }
+            if (frame_mode && (sys->ga.crt.v_pos < v_pos)) {
+                break;
+            }
         }
     }
+    _cpc_psg_sync(sys);
     sys->pins = pins;
-    kbd_update(&sys->kbd, micro_seconds);
+    kbd_update(&sys->kbd, clk_ticks_to_us(_CPC_FREQUENCY, tick));
+    return tick;
+}
+
+// warp mode condition: the disc drive motor is on and a disc is inserted
+static bool _cpc_warp_needed(cpc_t* sys) {
+    if (sys->debug.callback.func && *sys->debug.stopped) {
+        return false;
+    }
+    return sys->fdd.motor_on && sys->fdd.has_disc;
+}
+
+// run the first time slice with video and audio output, followed by the warp time slices
+static uint32_t _cpc_exec(cpc_t* sys, uint32_t slice_ticks, bool frame_mode) {
+    #if defined(CHIPS_STATS)
+    memset(&sys->stats, 0, sizeof(sys->stats));
+    memset(&sys->ga.stats, 0, sizeof(sys->ga.stats));
+    #endif
+    chips_dirty_lines_clear(&sys->ga.dirty_lines);
+    // first time slice always runs with video and audio output
+    uint32_t num_ticks = _cpc_exec_slice(sys, slice_ticks, frame_mode);
+    // decode a partially collected scanline before the framebuffer is displayed,
+    // and wait for the video thread if the pixels are decoded on a separate thread
+    am40010_sync_video(&sys->ga);
+    if (sys->warp.enabled && _cpc_warp_needed(sys)) {
+        // run additional time slices without video and audio output
+        const bool video_disabled = sys->ga.video_disabled;
+        sys->ga.video_disabled = true;
+        sys->warp.active = true;
+        for (int slice = 1; (slice < sys->warp.max_slices) && _cpc_warp_needed(sys); slice++) {
+            num_ticks += _cpc_exec_slice(sys, slice_ticks, frame_mode);
+        }
+        sys->warp.active = false;
+        sys->ga.video_disabled = video_disabled;
+        sys->warp.warped = true;
+    }
+    else {
+        sys->warp.warped = false;
+    }
+    #if defined(CHIPS_STATS)
+    sys->stats.ticks = num_ticks;
+    #endif
     return num_ticks;
 }
 
+uint32_t cpc_exec(cpc_t* sys, uint32_t micro_seconds) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return _cpc_exec(sys, clk_us_to_ticks_frac(_CPC_FREQUENCY, micro_seconds, &sys->tick_frac), false);
+}
+
+uint32_t cpc_exec_ticks(cpc_t* sys, uint32_t num_ticks) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return _cpc_exec(sys, num_ticks, false);
+}
+
+uint32_t cpc_exec_frame(cpc_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    // the CRT beam wraps after at most 312 lines, the 40 milliseconds limit is only a safety net
+    return _cpc_exec(sys, clk_us_to_ticks(_CPC_FREQUENCY, 40000), true);
+}
+
 void cpc_key_down(cpc_t* sys, int key_code) {
     CHIPS_ASSERT(sys && sys->valid);
     if (sys->joystick_type == CPC_JOYSTICK_DIGITAL) {
@@ -656,7 +1082,11 @@ uint8_t cpc_joystick_mask(cpc_t* sys) {
 
 void cpc_enable_video_debugging(cpc_t* sys, bool enabled) {
     CHIPS_ASSERT(sys && sys->valid);
+    #if defined(CPC_NO_FRAMEBUFFER)
+    (void)enabled;
+    #else
     sys->ga.dbg_vis = enabled;
+    #endif
 }
 
 bool cpc_video_debugging_enabled(cpc_t* sys) {
@@ -664,6 +1094,60 @@ bool cpc_video_debugging_enabled(cpc_t* sys) {
     return sys->ga.dbg_vis;
 }
 
+void cpc_enable_video(cpc_t* sys, bool enabled) {
+    CHIPS_ASSERT(sys && sys->valid);
+    #if defined(CPC_NO_FRAMEBUFFER)
+    (void)enabled;
+    #else
+    sys->ga.video_disabled = !enabled;
+    #endif
+}
+
+bool cpc_video_enabled(cpc_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return !sys->ga.video_disabled;
+}
+
+cpc_stats_t cpc_stats(cpc_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    cpc_stats_t res = sys->stats;
+    res.ga = sys->ga.stats;
+    return res;
+}
+
+void cpc_enable_auto_warp(cpc_t* sys, bool enabled) {
+    CHIPS_ASSERT(sys && sys->valid);
+    sys->warp.enabled = enabled;
+}
+
+bool cpc_is_warping(cpc_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return sys->warp.warped;
+}
+
+void cpc_boot(cpc_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    // run silently and without video decoding or debugger
+    const chips_debug_t debug = sys->debug;
+    const chips_audio_callback_t audio_callback = sys->audio.callback;
+    chips_audio_ring_t* audio_ring = sys->audio.ring;
+    const bool video_enabled = cpc_video_enabled(sys);
+    const bool warp_enabled = sys->warp.enabled;
+    sys->debug = (chips_debug_t){0};
+    sys->audio.callback = (chips_audio_callback_t){0};
+    sys->audio.ring = 0;
+    sys->warp.enabled = false;
+    cpc_enable_video(sys, false);
+    for (uint32_t us = 0; us < CPC_BOOT_MICRO_SECONDS; us += 20000) {
+        cpc_exec(sys, 20000);
+    }
+    sys->debug = debug;
+    sys->audio.callback = audio_callback;
+    sys->audio.ring = audio_ring;
+    sys->warp.enabled = warp_enabled;
+    cpc_enable_video(sys, video_enabled);
+}
+
 // keyboard matrix initialization
 static void _cpc_init_keymap(cpc_t* sys) {
     /*
@@ -796,6 +1280,7 @@ static bool _cpc_load_sna(cpc_t* sys, chips_range_t data) {
         return false;
     }
     memcpy(sys->ram, ptr, dump_num_bytes);
+    memset(sys->snapshot_written_pages, 0xFF, sizeof(sys->snapshot_written_pages));
 
     z80_reset(&sys->cpu);
     sys->cpu.f = hdr->F; sys->cpu.a = hdr->A;
@@ -882,7 +1367,7 @@ static bool _cpc_load_bin(cpc_t* sys, chips_range_t data, bool start) {
         // write CALL &xxxx into BASIC line buffer
         const char* to_hex = "0123456789ABCDEF";
         uint16_t line_buf;
-        switch (sys->type) {
+        switch (_CPC_TYPE(sys)) {
             case CPC_TYPE_6128:
             case CPC_TYPE_KCCOMPACT:
                 line_buf = 0xAC8A;
@@ -922,7 +1407,7 @@ bool cpc_quickload(cpc_t* sys, chips_range_t data, bool start) {
 }
 
 uint16_t cpc_quickload_return_addr(cpc_t* sys) {
-    switch (sys->type) {
+    switch (_CPC_TYPE(sys)) {
         case CPC_TYPE_6128:
         case CPC_TYPE_KCCOMPACT:
             return 0xB9A2;
@@ -995,6 +1480,15 @@ static int _cpc_fdc_write(int drive, int side, void* user_data, uint8_t data) {
     }
 }
 
+static int _cpc_fdc_sectordata(int drive, int side, void* user_data, const uint8_t** out_ptr, int* out_size) {
+    if (0 == drive) {
+        cpc_t* sys = (cpc_t*) user_data;
+        return fdd_sector_data(&sys->fdd, side, out_ptr, out_size);
+    } else {
+        return UPD765_RESULT_NOT_READY;
+    }
+}
+
 static int _cpc_fdc_trackinfo(int drive, int side, void* user_data, upd765_sectorinfo_t* out_info) {
     CHIPS_ASSERT((side >= 0) && (side < 2));
     if (0 == drive) {
@@ -1036,11 +1530,13 @@ static void _cpc_fdc_driveinfo(int drive, void* user_data, upd765_driveinfo_t* o
 
 bool cpc_insert_disc(cpc_t* sys, chips_range_t data) {
     CHIPS_ASSERT(sys && sys->valid);
+    upd765_invalidate_sector(&sys->fdc);
     return fdd_cpc_insert_dsk(&sys->fdd, data);
 }
 
 void cpc_remove_disc(cpc_t* sys) {
     CHIPS_ASSERT(sys && sys->valid);
+    upd765_invalidate_sector(&sys->fdc);
     fdd_eject_disc(&sys->fdd);
 }
 
@@ -1049,6 +1545,202 @@ bool cpc_disc_inserted(cpc_t* sys) {
     return fdd_disc_inserted(&sys->fdd);
 }
 
+/*=== TAPE LOADING ===========================================================*/
+static const uint8_t _cpc_cdt_header[8] = { 'Z', 'X', 'T', 'a', 'p', 'e', '!', 0x1A };
+
+static uint32_t _cpc_tape_u16(cpc_t* sys, int pos) {
+    return sys->tape.buf[pos] | (sys->tape.buf[pos+1]<<8);
+}
+
+static uint32_t _cpc_tape_u24(cpc_t* sys, int pos) {
+    return _cpc_tape_u16(sys, pos) | (sys->tape.buf[pos+2]<<16);
+}
+
+/*
+    Find the next data block in a CDT file starting at sys->tape.pos, returns
+    false if the end of the tape is reached. On success, out_data is the
+    offset of the block data (starting with the sync byte) and out_next
+    is the offset of the following block.
+
+    See: https://www.cpcwiki.eu/index.php/Format:CDT_tape_image_file_format
+*/
+static bool _cpc_tape_next_block(cpc_t* sys, int* out_data, int* out_size, int* out_next) {
+    int pos = sys->tape.pos;
+    const int end = sys->tape.size;
+    while (pos < end) {
+        const uint8_t id = sys->tape.buf[pos];
+        int hdr = 0;        // size of block header including id byte
+        uint32_t len = 0;   // size of data following the block header
+        bool is_data = false;
+        switch (id) {
+            case 0x10: hdr = 5; is_data = true; if ((pos + hdr) <= end) { len = _cpc_tape_u16(sys, pos+3); } break;
+            case 0x11: hdr = 19; is_data = true; if ((pos + hdr) <= end) { len = _cpc_tape_u24(sys, pos+16); } break;
+            case 0x12: hdr = 5; break;
+            case 0x13: hdr = 2; if ((pos + hdr) <= end) { len = 2 * sys->tape.buf[pos+1]; } break;
+            case 0x14: hdr = 11; if ((pos + hdr) <= end) { len = _cpc_tape_u24(sys, pos+8); } break;
+            case 0x15: hdr = 9; if ((pos + hdr) <= end) { len = _cpc_tape_u24(sys, pos+6); } break;
+            case 0x20: case 0x23: case 0x24: hdr = 3; break;
+            case 0x21: case 0x30: hdr = 2; if ((pos + hdr) <= end) { len = sys->tape.buf[pos+1]; } break;
+            case 0x22: case 0x25: case 0x27: hdr = 1; break;
+            case 0x26: hdr = 3; if ((pos + hdr) <= end) { len = 2 * _cpc_tape_u16(sys, pos+1); } break;
+            case 0x28: case 0x32: hdr = 3; if ((pos + hdr) <= end) { len = _cpc_tape_u16(sys, pos+1); } break;
+            case 0x2A: hdr = 5; break;
+            case 0x2B: hdr = 6; break;
+            case 0x31: hdr = 3; if ((pos + hdr) <= end) { len = sys->tape.buf[pos+2]; } break;
+            case 0x33: hdr = 2; if ((pos + hdr) <= end) { len = 3 * sys->tape.buf[pos+1]; } break;
+            case 0x35: hdr = 21; if ((pos + hdr) <= end) { len = _cpc_tape_u16(sys, pos+17) | (_cpc_tape_u16(sys, pos+19)<<16); } break;
+            case 0x5A: hdr = 10; break;
+            // all other blocks start with a 32-bit length
+            default: hdr = 5; if ((pos + hdr) <= end) { len = _cpc_tape_u16(sys, pos+1) | (_cpc_tape_u16(sys, pos+3)<<16); } break;
+        }
+        if ((pos + hdr) > end) {
+            return false;
+        }
+        const int next = pos + hdr + (int)len;
+        if ((len > (uint32_t)end) || (next > end)) {
+            return false;
+        }
+        if (is_data && (len > 0)) {
+            *out_data = pos + hdr;
+            *out_size = (int)len;
+            *out_next = next;
+            return true;
+        }
+        pos = next;
+    }
+    return false;
+}
+
+// CRC16-CCITT of a 256 byte tape data segment (stored inverted after the segment)
+static uint16_t _cpc_tape_crc(const uint8_t* ptr) {
+    uint16_t crc = 0xFFFF;
+    for (int i = 0; i < 256; i++) {
+        crc ^= ptr[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+    return ~crc;
+}
+
+/*
+    Trapped firmware CAS READ routine:
+
+    Entry:
+        A: sync byte of the block to read
+        HL: destination address
+        DE: number of bytes to read
+    Exit:
+        if OK: carry true, zero false
+        on error: carry false, zero false, A = error code (1 = overrun, 2 = CRC error)
+
+    Returns true if the routine was trapped, this checks the jumpblock
+    entry at 0xBCA1 (RST 1 followed by the ROM routine address) to find the
+    routine's address in the lower ROM.
+*/
+static bool _cpc_tape_trap(cpc_t* sys, uint16_t addr) {
+    if (sys->ga.regs.config & AM40010_CONFIG_LROMEN) {
+        // lower ROM not enabled
+        return false;
+    }
+    if (mem_rd(&sys->mem, 0xBCA1) != 0xCF) {
+        return false;
+    }
+    const uint16_t jump = mem_rd16(&sys->mem, 0xBCA2);
+    if ((jump & 0x4000) || ((jump & 0x3FFF) != addr)) {
+        return false;
+    }
+    // find the next data block with a matching sync byte
+    z80_t* cpu = &sys->cpu;
+    int data_pos = 0, data_size = 0, next_pos = 0;
+    bool found = false;
+    const int start_pos = sys->tape.pos;
+    while (_cpc_tape_next_block(sys, &data_pos, &data_size, &next_pos)) {
+        sys->tape.pos = next_pos;
+        if (sys->tape.buf[data_pos] == cpu->a) {
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        // let the firmware wait for more tape data
+        sys->tape.pos = start_pos;
+        return false;
+    }
+    // copy in 256 byte segments, each followed by a 2 byte CRC
+    uint8_t err = 0;
+    const uint8_t* src = &sys->tape.buf[data_pos + 1];
+    int src_size = data_size - 1;
+    uint16_t dst = cpu->hl;
+    int num_bytes = cpu->de;
+    while ((num_bytes > 0) && (0 == err)) {
+        if (src_size < 258) {
+            err = 1;
+            break;
+        }
+        const uint16_t crc = (src[256]<<8) | src[257];
+        if (crc != _cpc_tape_crc(src)) {
+            err = 2;
+        }
+        const int n = (num_bytes > 256) ? 256 : num_bytes;
+        for (int i = 0; i < n; i++) {
+            mem_wr(&sys->mem, dst++, src[i]);
+        }
+        num_bytes -= n;
+        src += 258;
+        src_size -= 258;
+    }
+    cpu->hl = dst;
+    cpu->de = num_bytes;
+    z80_sync_flags(cpu);
+    if (0 == err) {
+        cpu->f = (cpu->f & ~Z80_ZF) | Z80_CF;
+    } else {
+        cpu->a = err;
+        cpu->f &= ~(Z80_ZF|Z80_CF);
+    }
+    // emulate a RET instruction back to the caller
+    const uint16_t ret_addr = mem_rd16(&sys->mem, cpu->sp);
+    cpu->sp += 2;
+    z80_prefetch(cpu, ret_addr);
+    return true;
+}
+
+bool cpc_insert_tape(cpc_t* sys, chips_range_t data) {
+    CHIPS_ASSERT(sys && sys->valid);
+    CHIPS_ASSERT(data.ptr);
+    cpc_remove_tape(sys);
+    if ((data.size < 10) || (data.size > CPC_MAX_TAPE_SIZE)) {
+        return false;
+    }
+    if (0 != memcmp(data.ptr, _cpc_cdt_header, sizeof(_cpc_cdt_header))) {
+        return false;
+    }
+    #if defined(CPC_BORROWED_TAPE)
+        sys->tape.buf = (const uint8_t*) data.ptr;
+    #else
+        memcpy(sys->tape.buf, data.ptr, data.size);
+    #endif
+    // skip the header and version number
+    sys->tape.pos = 10;
+    sys->tape.size = (int) data.size;
+    return true;
+}
+
+void cpc_remove_tape(cpc_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    sys->tape.pos = 0;
+    sys->tape.size = 0;
+    #if defined(CPC_BORROWED_TAPE)
+        sys->tape.buf = 0;
+    #endif
+}
+
+bool cpc_tape_inserted(cpc_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return sys->tape.size > 0;
+}
+
 chips_display_info_t cpc_display_info(cpc_t* sys) {
     const chips_display_info_t res = {
         .frame = {
@@ -1058,8 +1750,10 @@ chips_display_info_t cpc_display_info(cpc_t* sys) {
             },
             .bytes_per_pixel = 1,
             .buffer = {
+                #if !defined(CPC_NO_FRAMEBUFFER)
                 .ptr = sys ? sys->fb : 0,
                 .size = AM40010_FRAMEBUFFER_SIZE_BYTES,
+                #endif
             }
         },
         .screen = {
@@ -1071,40 +1765,123 @@ chips_display_info_t cpc_display_info(cpc_t* sys) {
         .palette = {
             .ptr = sys ? sys->ga.hw_colors : 0,
             .size = AM40010_NUM_HWCOLORS * sizeof(uint32_t)
-        }
+        },
+        .dirty_lines = sys ? &sys->ga.dirty_lines : 0,
     };
+    #if !defined(CPC_NO_FRAMEBUFFER)
     CHIPS_ASSERT(((sys == 0) && (res.frame.buffer.ptr == 0)) || ((sys != 0) && (res.frame.buffer.ptr != 0)));
+    #endif
     CHIPS_ASSERT(((sys == 0) && (res.palette.ptr == 0)) || ((sys != 0) && (res.palette.ptr != 0)));
     return res;
 }
 
-uint32_t cpc_save_snapshot(cpc_t* sys, cpc_t* dst) {
-    CHIPS_ASSERT(sys && dst);
-    *dst = *sys;
+// take over the RAM pages written since the last call from the CPU mem_t
+static void _cpc_snapshot_collect_writes(cpc_t* sys) {
+    #if defined(MEM_TRACK_ACCESS)
+        mem_track_collect_writes(&sys->mem, &sys->ram[0][0], sizeof(sys->ram), sys->snapshot_written_pages);
+    #else
+        memset(sys->snapshot_written_pages, 0xFF, sizeof(sys->snapshot_written_pages));
+    #endif
+}
+
+// patch the pointers in a snapshot copy of sys
+static void _cpc_snapshot_onsave(cpc_t* sys, cpc_t* dst) {
     chips_debug_snapshot_onsave(&dst->debug);
     chips_audio_callback_snapshot_onsave(&dst->audio.callback);
     ay38910_snapshot_onsave(&dst->psg);
     upd765_snapshot_onsave(&dst->fdc);
+    fdd_snapshot_onsave(&dst->fdd);
     am40010_snapshot_onsave(&dst->ga);
+    #if defined(CPC_BORROWED_ROMS)
+        // ROM pages point outside of cpc_t, the mapping is rebuilt in cpc_load_snapshot()
+        mem_unmap_all(&dst->mem);
+        dst->rom_os = 0;
+        dst->rom_basic = 0;
+        dst->rom_amsdos = 0;
+    #endif
     mem_snapshot_onsave(&dst->mem, sys);
+    #if defined(CPC_BORROWED_TAPE)
+        dst->tape.buf = 0;
+    #endif
+}
+
+uint32_t cpc_save_snapshot(cpc_t* sys, cpc_t* dst) {
+    CHIPS_ASSERT(sys && dst);
+    memcpy(dst, sys, CPC_SNAPSHOT_SIZE);
+    _cpc_snapshot_onsave(sys, dst);
+    // start tracking written RAM pages relative to the new base snapshot
+    _cpc_snapshot_collect_writes(sys);
+    memset(sys->snapshot_written_pages, 0, sizeof(sys->snapshot_written_pages));
     return CPC_SNAPSHOT_VERSION;
 }
 
-bool cpc_load_snapshot(cpc_t* sys, uint32_t version, cpc_t* src) {
+bool cpc_load_snapshot(cpc_t* sys, uint32_t version, const cpc_t* src) {
     CHIPS_ASSERT(sys && src);
     if (version != CPC_SNAPSHOT_VERSION) {
         return false;
     }
+    if (src->type != _CPC_TYPE(src)) {
+        // a snapshot of a different model than the compile-time model
+        return false;
+    }
     static cpc_t im;
-    im = *src;
+    memcpy(&im, src, CPC_SNAPSHOT_SIZE);
     chips_debug_snapshot_onload(&im.debug, &sys->debug);
     chips_audio_callback_snapshot_onload(&im.audio.callback, &sys->audio.callback);
     ay38910_snapshot_onload(&im.psg, &sys->psg);
     upd765_snapshot_onload(&im.fdc, &sys->fdc);
+    fdd_snapshot_onload(&im.fdd, &sys->fdd);
     am40010_snapshot_onload(&im.ga, &sys->ga);
     mem_snapshot_onload(&im.mem, sys);
-    *sys = im;
+    #if defined(CPC_BORROWED_TAPE)
+        // the borrowed tape data is taken from the target system, the same tape must be inserted
+        if ((im.tape.size > 0) && (im.tape.size == sys->tape.size)) {
+            im.tape.buf = sys->tape.buf;
+        } else {
+            im.tape.buf = 0;
+            im.tape.size = 0;
+            im.tape.pos = 0;
+        }
+    #endif
+    #if defined(CPC_BORROWED_ROMS)
+        // the borrowed ROM images are taken from the target system
+        im.rom_os = sys->rom_os;
+        im.rom_basic = sys->rom_basic;
+        im.rom_amsdos = sys->rom_amsdos;
+    #endif
+    memcpy(sys, &im, CPC_SNAPSHOT_SIZE);
+    // the memory mapping has been replaced by the snapshot
+    sys->mem_config = -1;
+    #if defined(CPC_BORROWED_ROMS)
+        _cpc_bankswitch(sys->ga.ram_config, sys->ga.regs.config, sys->ga.rom_select, sys);
+    #endif
+    // the whole RAM has changed
+    memset(sys->snapshot_written_pages, 0xFF, sizeof(sys->snapshot_written_pages));
     return true;
 }
 
+size_t cpc_save_snapshot_delta(cpc_t* sys, const cpc_t* base, cpc_t* scratch, chips_range_t dst) {
+    CHIPS_ASSERT(sys && base && scratch && dst.ptr);
+    _cpc_snapshot_collect_writes(sys);
+    // the RAM isn't copied into the scratch snapshot, but taken directly from the written pages
+    const size_t ram_start = offsetof(cpc_t, ram);
+    const size_t ram_end = ram_start + sizeof(sys->ram);
+    memcpy(scratch, sys, ram_start);
+    memcpy((uint8_t*)scratch + ram_end, (uint8_t*)sys + ram_end, CPC_SNAPSHOT_SIZE - ram_end);
+    _cpc_snapshot_onsave(sys, scratch);
+    return chips_delta_encode_ram(
+        (chips_range_t){ .ptr = (void*)base, .size = CPC_SNAPSHOT_SIZE },
+        (chips_range_t){ .ptr = scratch, .size = CPC_SNAPSHOT_SIZE },
+        ram_start,
+        (chips_range_t){ .ptr = &sys->ram[0][0], .size = sizeof(sys->ram) },
+        MEM_PAGE_SIZE,
+        sys->snapshot_written_pages,
+        dst);
+}
+
+bool cpc_apply_snapshot_delta(cpc_t* inout_snapshot, chips_range_t delta) {
+    CHIPS_ASSERT(inout_snapshot && delta.ptr);
+    return chips_delta_apply(delta, (chips_range_t){ .ptr = inout_snapshot, .size = CPC_SNAPSHOT_SIZE });
+}
+
 #endif /* CHIPS_IMPL */
@@ -21,12 +21,22 @@
     CHIPS_ASSERT(c)
         your own assert macro (default: assert(c))
 
+    KC85_BORROWED_ROMS
+        if defined, kc85_init() doesn't copy the ROM images into kc85_t but
+        keeps pointers to the ROM data in kc85_desc_t.roms, the ROM data
+        must then remain valid and unchanged until kc85_discard() is called
+        (this allows many instances to share one copy of the ROMs), ROMs are
+        also not part of snapshots, snapshots must be loaded into an instance
+        which was initialized with the same ROM images, must be the same for
+        all files which include kc85.h
+
     You need to include the following headers before including kc85.h:
 
     - chips/chips_common.h
     - chips/z80.h
     - chips/z80ctc.h
     - chips/z80pio.h
+    - chips/blip.h (only with CHIPS_BLIP)
     - chips/beeper.h
     - chips/kbd.h
     - chips/mem.h
@@ -229,6 +239,74 @@
         - bits 2..6:    unused
         - bit 7:        enable the 4 KByte CAOS ROM bank at C000
 
+    ## Boot Snapshots
+
+    After a cold start, CAOS needs about a second of emulated time to
+    initialize the system and clear the video memory before the menu is
+    ready. To skip this for new instances, boot one instance with
+    kc85_boot(), save a snapshot of it with kc85_save_snapshot() and
+    provide the snapshot in kc85_desc_t.boot_snapshot when initializing
+    further instances. Those then start directly in the CAOS menu. The
+    boot snapshot must have been created with the same ROM images.
+
+    ## Text Input
+
+    kc85_input_text() feeds a text into the CAOS keyboard input instead of
+    simulating key presses (see 'Text Input' in chips_common.h). CAOS keeps
+    the keyboard state in a memory area addressed through the IX register,
+    with the key code at IX+0xD and the 'key ready' flag in bit 0 of IX+0x8.
+    While text is pending, a CPU read of IX+0x8 with the 'key ready' flag
+    cleared (which means that the previous key code has been consumed)
+    writes the next character to IX+0xD and sets the 'key ready' flag, so
+    the text is entered as fast as CAOS (or BASIC) consumes it. The regular
+    keyboard handling is suspended until the text has been consumed.
+    Characters are passed through as CAOS key codes (which are ASCII for
+    printable characters). The text is not copied and must remain valid
+    until kc85_input_text_pending() returns false.
+
+    ## CPU Overclocking
+
+    For workloads which don't depend on real-hardware speed, the CPU can run
+    at a multiple of its nominal clock frequency while the video system, CTC,
+    PIO and audio keep their nominal timing, so that the frame rate, timers
+    and sound pitch don't change. Set kc85_desc_t.overclock to the number of
+    CPU ticks per device tick (default is 1, no overclocking), or change the
+    factor at runtime with kc85_set_overclock().
+
+    In overclock mode, only every Nth CPU tick also ticks the other chips,
+    all other ticks only perform the CPU memory accesses. Ticks with an IO
+    request (this includes interrupt acknowledge cycles), a RETI or an active
+    WAIT pin always tick the other chips so that no IO access, interrupt
+    handshake or wait state can be missed, this means that IO-heavy code
+    runs a bit slower than the overclock factor suggests.
+
+    kc85_exec() and kc85_exec_ticks() take the overclocked CPU frequency into
+    account (so kc85_exec() runs N times as many CPU ticks for the same
+    micro-seconds), kc85_exec_frame() converts the remaining device ticks
+    of the current video frame into CPU ticks, since forced device ticks
+    advance the video system faster, this may run a few ticks past the
+    end of the frame.
+
+    ## Hardware Event Timeline
+
+    With CHIPS_EVENTS defined and a chips_event_ring_t provided in
+    kc85_desc_t.events, the KC85 records the following hardware events
+    (see 'Hardware Event Timeline' in chips_common.h), the event ticks are
+    CPU ticks:
+
+    - CHIPS_EVENT_IRQ: the CPU INT line level
+    - CHIPS_EVENT_NMI: the CPU NMI line level (KC85/2 and KC85/3 only,
+      connected to PIO port A bit 4)
+    - CHIPS_EVENT_VSYNC: the scanline counter wraps around to the first
+      scanline (same position as kc85_exec_frame())
+    - CHIPS_EVENT_TIMER: a CTC zero count/timeout, 'addr' is the CTC
+      channel (0..2)
+    - CHIPS_EVENT_MEMORY_MAP: the memory map is updated, 'data' is the
+      PIO port A value, on the KC85/4 with the port 0x84 value in bits
+      8..15 and the port 0x86 value in bits 16..23
+
+    kc85_boot() doesn't record any events.
+
     ## TODO:
 
     - optionally proper keyboard emulation (the current implementation
@@ -285,7 +363,9 @@ extern "C" {
 #define KC85_IRM0_PAGE (4)
 
 // bump this whenever the kc85_t struct layout changes
-#define KC85_SNAPSHOT_VERSION (KC85_TYPE_ID | 0x0002)
+#define KC85_SNAPSHOT_VERSION (KC85_TYPE_ID | 0x000B)
+
+#define KC85_BOOT_MICRO_SECONDS (1000000)   // time run by kc85_boot() until the CAOS menu is ready
 
 #define KC85_MAX_AUDIO_SAMPLES (1024U)      // max number of audio samples in internal sample buffer
 #define KC85_DEFAULT_AUDIO_SAMPLES (128)    // default number of samples in internal sample buffer
@@ -338,14 +418,23 @@ typedef struct {
     void* user_data;
 } kc85_patch_callback_t;
 
+struct kc85_t;
+
 // config parameters for kc85_init()
 typedef struct {
     chips_debug_t debug;
     chips_audio_desc_t audio;
+    const struct kc85_t* boot_snapshot;     // optional snapshot taken after kc85_boot() to start in booted state
 
     // an optional callback to be invoked after a snapshot file is loaded to apply patches
     kc85_patch_callback_t patch_callback;
 
+    // optional CPU overclock factor (CPU ticks per device tick, default: 1)
+    int overclock;
+
+    // optional hardware event timeline, needs CHIPS_EVENTS (see "Hardware Event Timeline")
+    chips_event_ring_t* events;
+
     // ROM images
     struct {
         #if defined(CHIPS_KC85_TYPE_2)
@@ -402,12 +491,13 @@ typedef struct {
 } kc85_exp_t;
 
 // KC85 emulator state
-typedef struct {
+typedef struct kc85_t {
     z80_t cpu;
     mem_t mem;
     struct {
         uint16_t h_tick;
         uint16_t v_count;
+        uint16_t decode_x;      // next 8-pixel column to decode in the current scanline
     } video;
     uint64_t pio_pins;
     #if defined(CHIPS_KC85_TYPE_4)
@@ -423,31 +513,54 @@ typedef struct {
 
     uint64_t pins;
     uint64_t freq_hz;
+    uint32_t tick_frac;         // fractional tick carried over between kc85_exec() calls (see clk_us_to_ticks_frac())
+    uint32_t overclock;         // number of CPU ticks per device tick (see 'CPU Overclocking')
+    uint32_t overclock_count;   // CPU ticks since the last device tick
     kbd_t kbd;
 
     bool valid;
     chips_debug_t debug;
 
+    kc85_patch_callback_t patch_callback;
+
+    uint8_t ram[8][0x4000];             // up to 8 16-KByte RAM banks
+    #if defined(KC85_BORROWED_ROMS)
+        // borrowed ROM images, not part of snapshots
+        #if defined(CHIPS_KC85_TYPE_3) || defined(CHIPS_KC85_TYPE_4)
+            const uint8_t* rom_basic;
+        #endif
+        #if defined(CHIPS_KC85_TYPE_4)
+            const uint8_t* rom_caos_c;
+        #endif
+        const uint8_t* rom_caos_e;
+    #else
+        #if defined(CHIPS_KC85_TYPE_3) || defined(CHIPS_KC85_TYPE_4)
+            uint8_t rom_basic[0x2000];          // 8 KByte BASIC ROM (KC85/3 and /4 only)
+        #endif
+        #if defined(CHIPS_KC85_TYPE_4)
+            uint8_t rom_caos_c[0x1000];         // 4 KByte CAOS ROM at 0xC000 (KC85/4 only)
+        #endif
+        uint8_t rom_caos_e[0x2000];         // 8 KByte CAOS ROM at 0xE000
+    #endif
+    uint8_t exp_buf[KC85_EXP_BUFSIZE];  // expansion system RAM/ROM
+
+    // output-only state starting at audio.sample_buffer is not part of snapshots
     struct {
         chips_audio_callback_t callback;
         int num_samples;
         int sample_pos;
         float sample_buffer[KC85_MAX_AUDIO_SAMPLES];
+        chips_audio_ring_t* ring;
     } audio;
-    kc85_patch_callback_t patch_callback;
-
-    uint8_t ram[8][0x4000];             // up to 8 16-KByte RAM banks
-    #if defined(CHIPS_KC85_TYPE_3) || defined(CHIPS_KC85_TYPE_4)
-        uint8_t rom_basic[0x2000];          // 8 KByte BASIC ROM (KC85/3 and /4 only)
-    #endif
-    #if defined(CHIPS_KC85_TYPE_4)
-        uint8_t rom_caos_c[0x1000];         // 4 KByte CAOS ROM at 0xC000 (KC85/4 only)
-    #endif
-    uint8_t rom_caos_e[0x2000];         // 8 KByte CAOS ROM at 0xE000
-    uint8_t exp_buf[KC85_EXP_BUFSIZE];  // expansion system RAM/ROM
     alignas(64) uint8_t fb[KC85_FRAMEBUFFER_SIZE_BYTES];
+    chips_dirty_lines_t dirty_lines;    // framebuffer lines changed in the last kc85_exec() call
+    chips_text_input_t text_input;      // pending text for the CAOS keyboard input (see "Text Input")
+    chips_event_ring_t* events;         // optional hardware event timeline (see "Hardware Event Timeline")
 } kc85_t;
 
+// size of the part of kc85_t which is stored in snapshots (the audio sample buffer and framebuffer are excluded)
+#define KC85_SNAPSHOT_SIZE (offsetof(kc85_t, audio.sample_buffer))
+
 // initialize a new KC85 instance
 void kc85_init(kc85_t* sys, const kc85_desc_t* desc);
 // discard a KC85 instance
@@ -458,10 +571,20 @@ void kc85_reset(kc85_t* sys);
 chips_display_info_t kc85_display_info(kc85_t* sys);
 // run KC85 emulation for a given number of microseconds, returns number of ticks executed
 uint32_t kc85_exec(kc85_t* sys, uint32_t micro_seconds);
+// run KC85 emulation for a given number of ticks, returns number of ticks executed
+uint32_t kc85_exec_ticks(kc85_t* sys, uint32_t num_ticks);
+// run KC85 emulation until the video beam returns to the top of the screen, returns number of ticks executed
+uint32_t kc85_exec_frame(kc85_t* sys);
+// set the CPU overclock factor (CPU ticks per device tick, 1 means no overclocking)
+void kc85_set_overclock(kc85_t* sys, int factor);
 // send a key-down event
 void kc85_key_down(kc85_t* sys, int key_code);
-// send a key-up event
+// send a key up event
 void kc85_key_up(kc85_t* sys, int key_code);
+// feed text into the CAOS keyboard input, the text must remain valid until consumed (see "Text Input")
+void kc85_input_text(kc85_t* sys, const char* text);
+// return true while text from kc85_input_text() hasn't been consumed yet
+bool kc85_input_text_pending(kc85_t* sys);
 // insert a RAM module (slot must be 0x08 or 0x0C)
 bool kc85_insert_ram_module(kc85_t* sys, uint8_t slot, kc85_module_type_t type);
 // insert a ROM module (slot must be 0x08 or 0x0C)
@@ -502,6 +625,8 @@ bool kc85_quickload(kc85_t* sys, chips_range_t data, bool start);
 uint32_t kc85_save_snapshot(kc85_t* sys, kc85_t* dst);
 // load a snapshot, returns false if snapshot version doesn't match
 bool kc85_load_snapshot(kc85_t* sys, uint32_t version, const kc85_t* src);
+// run a freshly initialized instance until the CAOS menu is ready (for creating boot snapshots)
+void kc85_boot(kc85_t* sys);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -509,7 +634,7 @@ bool kc85_load_snapshot(kc85_t* sys, uint32_t version, const kc85_t* src);
 
 /*-- IMPLEMENTATION ----------------------------------------------------------*/
 #ifdef CHIPS_IMPL
-#include <string.h> // memcpy, memset
+#include <string.h> // memcpy, memset, memcmp
 #ifndef CHIPS_ASSERT
     #include <assert.h>
     #define CHIPS_ASSERT(c) assert(c)
@@ -563,6 +688,7 @@ bool kc85_load_snapshot(kc85_t* sys, uint32_t version, const kc85_t* src);
 static void _kc85_update_memory_map(kc85_t* sys);
 static void _kc85_init_memory_map(kc85_t* sys);
 static void _kc85_handle_keyboard(kc85_t* sys);
+static void _kc85_text_input_fill(kc85_t* sys);
 
 // expansion module private functions
 static void _kc85_exp_init(kc85_t* sys);
@@ -588,29 +714,30 @@ void kc85_init(kc85_t* sys, const kc85_desc_t* desc) {
     memset(sys, 0, sizeof(kc85_t));
     sys->valid = true;
     sys->freq_hz = KC85_FREQUENCY;
+    sys->overclock = (uint32_t)_KC85_DEFAULT(desc->overclock, 1);
     sys->patch_callback = desc->patch_callback;
     sys->debug = desc->debug;
 
-    // copy ROM images
+    // copy (or borrow) ROM images
+    #if defined(KC85_BORROWED_ROMS)
+        #define _KC85_ROM(dst, src, num_bytes) { CHIPS_ASSERT(src.ptr && (src.size == num_bytes)); dst = (const uint8_t*)src.ptr; }
+    #else
+        #define _KC85_ROM(dst, src, num_bytes) { CHIPS_ASSERT(src.ptr && (src.size == num_bytes)); memcpy(dst, src.ptr, num_bytes); }
+    #endif
     #if defined(CHIPS_KC85_TYPE_2)
         // KC85/2 only has an 8 KByte OS ROM
-        CHIPS_ASSERT(desc->roms.caos22.ptr && (desc->roms.caos22.size == sizeof(sys->rom_caos_e)));
-        memcpy(sys->rom_caos_e, desc->roms.caos22.ptr, sizeof(sys->rom_caos_e));
+        _KC85_ROM(sys->rom_caos_e, desc->roms.caos22, 0x2000);
     #elif defined(CHIPS_KC85_TYPE_3)
         // KC85/3 has 8 KByte BASIC ROM and 8 KByte OS ROM
-        CHIPS_ASSERT(desc->roms.kcbasic.ptr && (desc->roms.kcbasic.size == sizeof(sys->rom_basic)));
-        memcpy(sys->rom_basic, desc->roms.kcbasic.ptr, sizeof(sys->rom_basic));
-        CHIPS_ASSERT(desc->roms.caos31.ptr && (desc->roms.caos31.size == sizeof(sys->rom_caos_e)));
-        memcpy(sys->rom_caos_e, desc->roms.caos31.ptr, sizeof(sys->rom_caos_e));
+        _KC85_ROM(sys->rom_basic, desc->roms.kcbasic, 0x2000);
+        _KC85_ROM(sys->rom_caos_e, desc->roms.caos31, 0x2000);
     #else
         // KC85/4 has 8 KByte BASIC ROM, and 2 OS ROMs (4 KB and 8 KB)
-        CHIPS_ASSERT(desc->roms.kcbasic.ptr && (desc->roms.kcbasic.size == sizeof(sys->rom_basic)));
-        memcpy(sys->rom_basic, desc->roms.kcbasic.ptr, sizeof(sys->rom_basic));
-        CHIPS_ASSERT(desc->roms.caos42c.ptr && (desc->roms.caos42c.size == sizeof(sys->rom_caos_c)));
-        memcpy(sys->rom_caos_c, desc->roms.caos42c.ptr, sizeof(sys->rom_caos_c));
-        CHIPS_ASSERT(desc->roms.caos42e.ptr && (desc->roms.caos42e.size == sizeof(sys->rom_caos_e)));
-        memcpy(sys->rom_caos_e, desc->roms.caos42e.ptr, sizeof(sys->rom_caos_e));
+        _KC85_ROM(sys->rom_basic, desc->roms.kcbasic, 0x2000);
+        _KC85_ROM(sys->rom_caos_c, desc->roms.caos42c, 0x1000);
+        _KC85_ROM(sys->rom_caos_e, desc->roms.caos42e, 0x2000);
     #endif
+    #undef _KC85_ROM
 
     // fill RAM with noise (only KC85/2 and /3)
     #if !defined(CHIPS_KC85_TYPE_4)
@@ -631,6 +758,8 @@ void kc85_init(kc85_t* sys, const kc85_desc_t* desc) {
     z80pio_init(&sys->pio);
 
     sys->audio.callback = desc->audio.callback;
+    sys->audio.ring = desc->audio.ring;
+    sys->events = desc->events;
     sys->audio.num_samples = _KC85_DEFAULT(desc->audio.num_samples, KC85_DEFAULT_AUDIO_SAMPLES);
     const beeper_desc_t beeper_desc = {
         .tick_hz = (int)sys->freq_hz,
@@ -657,6 +786,13 @@ void kc85_init(kc85_t* sys, const kc85_desc_t* desc) {
 
     // execution on power-up starts at 0xF000
     sys->pins = z80_prefetch(&sys->cpu, 0xF000);
+    if (desc->boot_snapshot) {
+        // skip the CAOS boot sequence
+        const int num_samples = sys->audio.num_samples;
+        kc85_load_snapshot(sys, KC85_SNAPSHOT_VERSION, desc->boot_snapshot);
+        sys->audio.num_samples = num_samples;
+        sys->audio.sample_pos = 0;
+    }
 }
 
 void kc85_discard(kc85_t* sys) {
@@ -676,6 +812,7 @@ void kc85_reset(kc85_t* sys) {
         sys->io86 = 0;
     #endif
     _kc85_exp_reset(sys);
+    chips_text_input_clear(&sys->text_input);
     sys->pio_pins = KC85_PIO_RAM | KC85_PIO_RAM_RO | KC85_PIO_IRM | KC85_PIO_CAOS_ROM;
     _kc85_update_memory_map(sys);
 
@@ -750,48 +887,61 @@ static inline uint64_t _kc85_update_raster_counters(kc85_t* sys, uint64_t pins)
         sys->video.v_count++;
         if (sys->video.v_count == KC85_NUM_SCANLINES) {
             sys->video.v_count = 0;
+            CHIPS_EVENT(sys->events, CHIPS_EVENT_VSYNC, 0, 0);
         }
     }
     return pins;
 }
 
+/*
+    The video decoding doesn't happen in lockstep with the CPU, instead the
+    pixels of a scanline are decoded in batches. A batch is decoded at the
+    end of the scanline, or earlier when something happens which affects the
+    video output: a CPU write to video memory (or the display needling on
+    the KC85/2 and /3), the blink flip-flop or PIO-B bit 7 changing and
+    (on the KC85/4) a write to the IO port 0x84.
+
+    Before such a change, _kc85_video_sync() decodes all 8-pixel columns
+    which the video beam has already passed with the old state. The
+    column at h_tick is due in the tick where h_tick>>1 == x and h_tick
+    is odd, so the columns up to (not including) h_tick>>1 are done
+    before the video tick, and the columns up to h_tick>>1 after the video
+    tick (which has already incremented h_tick).
+*/
 #if defined(CHIPS_KC85_TYPE_2) || defined(CHIPS_KC85_TYPE_3)
-static uint64_t _kc85_tick_video(kc85_t* sys, uint64_t pins) {
-    // every 2 CPU ticks, 8 pixels are decoded
-    if (sys->video.h_tick & 1) {
-        uint16_t x = sys->video.h_tick>>1;
-        uint16_t y = sys->video.v_count;
-        if ((y < 256) && (x < 40)) {
-            uint32_t pixel_offset, color_offset;
-            if (x & 0x20) {
-                // right 64x256 area
-                pixel_offset = 0x2000 + ((x&0x7) | (((y>>4)&0x3)<<3) | (((y>>2)&0x3)<<5) | ((y&0x3)<<7) | (((y>>6)&0x3)<<9));
-                color_offset = 0x3000 + ((x&0x7) | (((y>>4)&0x3)<<3) | (((y>>2)&0x3)<<5) | (((y>>6)&0x3)<<7));
-            }
-            else {
-                // left 256x256 area
-                pixel_offset = x | (((y>>2)&0x3)<<5) | ((y&0x3)<<7) | (((y>>4)&0xF)<<9);
-                color_offset = 0x2800 + (x | (((y>>2)&0x3f)<<5));
-            }
-            // cpu_access: emulate display needling on KC85/2 and /3, this happens when the
-            // CPU accesses video memory, which will force the background color
-            // a short duration
-            //
-            uint8_t color_bits = sys->ram[KC85_IRM0_PAGE][color_offset];
-            bool fg_blank = 0 != (color_bits & (sys->flip_flops>>(Z80CTC_BIT_ZCTO2-7)) & (sys->pio_pins>>(Z80PIO_PIN_PB7-7)) & (1<<7));
-            // same as (pins & Z80_WR) && (addr >= 0x8000) && (addr < 0xC000)
-            bool cpu_access = (pins & (Z80_WR | 0xC000)) == (Z80_WR | 0x8000);
-            uint8_t pixel_bits = (fg_blank || cpu_access) ? 0 : sys->ram[KC85_IRM0_PAGE][pixel_offset];
-            uint8_t* dst = &(sys->fb[y*KC85_FRAMEBUFFER_WIDTH + x*8]);
-            _kc85_decode_8pixels(dst, pixel_bits, color_bits);
+static void _kc85_decode_columns(kc85_t* sys, uint16_t x0, uint16_t x1, bool needling) {
+    const uint16_t y = sys->video.v_count;
+    const uint8_t* irm = sys->ram[KC85_IRM0_PAGE];
+    const uint8_t blink_mask = (uint8_t)((sys->flip_flops>>(Z80CTC_BIT_ZCTO2-7)) & (sys->pio_pins>>(Z80PIO_PIN_PB7-7)) & (1<<7));
+    uint8_t* dst = &(sys->fb[y*KC85_FRAMEBUFFER_WIDTH + x0*8]);
+    bool changed = false;
+    for (uint16_t x = x0; x < x1; x++, dst += 8) {
+        uint32_t pixel_offset, color_offset;
+        if (x & 0x20) {
+            // right 64x256 area
+            pixel_offset = 0x2000 + ((x&0x7) | (((y>>4)&0x3)<<3) | (((y>>2)&0x3)<<5) | ((y&0x3)<<7) | (((y>>6)&0x3)<<9));
+            color_offset = 0x3000 + ((x&0x7) | (((y>>4)&0x3)<<3) | (((y>>2)&0x3)<<5) | (((y>>6)&0x3)<<7));
         }
+        else {
+            // left 256x256 area
+            pixel_offset = x | (((y>>2)&0x3)<<5) | ((y&0x3)<<7) | (((y>>4)&0xF)<<9);
+            color_offset = 0x2800 + (x | (((y>>2)&0x3f)<<5));
+        }
+        const uint8_t color_bits = irm[color_offset];
+        const bool fg_blank = 0 != (color_bits & blink_mask);
+        const uint8_t pixel_bits = (fg_blank || needling) ? 0 : irm[pixel_offset];
+        uint64_t old_pixels;
+        memcpy(&old_pixels, dst, sizeof(old_pixels));
+        _kc85_decode_8pixels(dst, pixel_bits, color_bits);
+        changed |= 0 != memcmp(&old_pixels, dst, sizeof(old_pixels));
+    }
+    if (changed) {
+        chips_dirty_lines_set(&sys->dirty_lines, y);
     }
-    return _kc85_update_raster_counters(sys, pins);
 }
 #endif // KC85/2,/3
 
 #if defined(CHIPS_KC85_TYPE_4)
-
 static inline void _kc85_decode_hicolor_8pixels(uint8_t* dst, uint8_t p0, uint8_t p1) {
     /*
         KC85/4 "hicolor" mode
@@ -813,71 +963,117 @@ static inline void _kc85_decode_hicolor_8pixels(uint8_t* dst, uint8_t p0, uint8_
     dst[7] = 0x20 | ((p0>>0)&1)|((p1<<1)&2);
 }
 
-static uint64_t _kc85_tick_video(kc85_t* sys, uint64_t pins) {
-    // decode 8 pixels every second tick
-    if (sys->video.h_tick & 1) {
-        uint16_t x = sys->video.h_tick>>1;
-        uint16_t y = sys->video.v_count;
-        if ((y < 256) && (x < 40)) {
-            size_t irm_index = (sys->io84 & 1) * 2;
-            size_t offset = (x<<8) | y;
-            uint8_t color_bits = sys->ram[KC85_IRM0_PAGE + irm_index + 1][offset];
-            uint8_t* dst = &sys->fb[y * KC85_FRAMEBUFFER_WIDTH + x * 8];
-            if (sys->io84 & KC85_IO84_HICOLOR) {
-                // regular KC85/4 video mode
-                bool fg_blank = 0 != (color_bits & (sys->flip_flops>>(Z80CTC_BIT_ZCTO2-7)) & (sys->pio_pins>>(Z80PIO_PIN_PB7-7)) & (1<<7));
-                uint8_t pixel_bits = fg_blank ? 0 : sys->ram[KC85_IRM0_PAGE + irm_index][offset];
-                _kc85_decode_8pixels(dst, pixel_bits, color_bits);
-            }
-            else {
-                // hicolor mode
-                uint8_t p0 = sys->ram[KC85_IRM0_PAGE + irm_index][offset];
-                uint8_t p1 = color_bits;
-                _kc85_decode_hicolor_8pixels(dst, p0, p1);
-            }
+static void _kc85_decode_columns(kc85_t* sys, uint16_t x0, uint16_t x1, bool needling) {
+    (void)needling;
+    const uint16_t y = sys->video.v_count;
+    const size_t irm_index = (sys->io84 & 1) * 2;
+    const uint8_t* pixel_ram = sys->ram[KC85_IRM0_PAGE + irm_index];
+    const uint8_t* color_ram = sys->ram[KC85_IRM0_PAGE + irm_index + 1];
+    const uint8_t blink_mask = (uint8_t)((sys->flip_flops>>(Z80CTC_BIT_ZCTO2-7)) & (sys->pio_pins>>(Z80PIO_PIN_PB7-7)) & (1<<7));
+    const bool hicolor = 0 == (sys->io84 & KC85_IO84_HICOLOR);
+    uint8_t* dst = &sys->fb[y * KC85_FRAMEBUFFER_WIDTH + x0 * 8];
+    bool changed = false;
+    for (uint16_t x = x0; x < x1; x++, dst += 8) {
+        const size_t offset = (x<<8) | y;
+        const uint8_t color_bits = color_ram[offset];
+        uint64_t old_pixels;
+        memcpy(&old_pixels, dst, sizeof(old_pixels));
+        if (!hicolor) {
+            // regular KC85/4 video mode
+            const bool fg_blank = 0 != (color_bits & blink_mask);
+            const uint8_t pixel_bits = fg_blank ? 0 : pixel_ram[offset];
+            _kc85_decode_8pixels(dst, pixel_bits, color_bits);
+        }
+        else {
+            // hicolor mode
+            _kc85_decode_hicolor_8pixels(dst, pixel_ram[offset], color_bits);
+        }
+        changed |= 0 != memcmp(&old_pixels, dst, sizeof(old_pixels));
+    }
+    if (changed) {
+        chips_dirty_lines_set(&sys->dirty_lines, y);
+    }
+}
+#endif // KC85/4
+
+// decode the pending 8-pixel columns of the current scanline up to (not including) end_x
+static inline void _kc85_video_sync(kc85_t* sys, uint16_t end_x) {
+    if (end_x > KC85_DISPLAY_WIDTH/8) {
+        end_x = KC85_DISPLAY_WIDTH/8;
+    }
+    if ((sys->video.v_count < 256) && (sys->video.decode_x < end_x)) {
+        _kc85_decode_columns(sys, sys->video.decode_x, end_x, false);
+        sys->video.decode_x = end_x;
+    }
+}
+
+static inline uint64_t _kc85_tick_video(kc85_t* sys, uint64_t pins) {
+    #if defined(CHIPS_KC85_TYPE_2) || defined(CHIPS_KC85_TYPE_3)
+    /* emulate display needling on KC85/2 and /3, a CPU write to video memory
+        forces the background color for the 8 pixels decoded in this tick
+        (the columns before have already been decoded before the memory write)
+        same as (pins & Z80_WR) && (addr >= 0x8000) && (addr < 0xC000)
+    */
+    if ((sys->video.h_tick & 1) && ((pins & (Z80_WR | 0xC000)) == (Z80_WR | 0x8000))) {
+        const uint16_t x = sys->video.h_tick>>1;
+        if ((sys->video.v_count < 256) && (x < KC85_DISPLAY_WIDTH/8)) {
+            _kc85_decode_columns(sys, x, x + 1, true);
+            sys->video.decode_x = x + 1;
         }
     }
+    #endif
+    // decode the rest of the scanline in the last tick of the scanline
+    if (sys->video.h_tick == (KC85_SCANLINE_TICKS - 1)) {
+        _kc85_video_sync(sys, KC85_DISPLAY_WIDTH/8);
+        sys->video.decode_x = 0;
+    }
     return _kc85_update_raster_counters(sys, pins);
 }
-#endif
 
 static void _kc85_update_memory_map(kc85_t* sys) {
-    mem_unmap_layer(&sys->mem, 0);
+    #if defined(CHIPS_KC85_TYPE_4)
+        CHIPS_EVENT(sys->events, CHIPS_EVENT_MEMORY_MAP, 0, Z80PIO_GET_PA(sys->pio_pins) | ((uint32_t)sys->io84<<8) | ((uint32_t)sys->io86<<16));
+    #else
+        CHIPS_EVENT(sys->events, CHIPS_EVENT_MEMORY_MAP, 0, Z80PIO_GET_PA(sys->pio_pins));
+    #endif
+    // build the new layer 0 mapping first, so that only changed pages are updated
+    mem_bank_t bank;
+    mem_bank_init(&bank);
     const uint64_t pio_pins = sys->pio_pins;
 
     // all models have 16 KB builtin RAM at 0x0000 and 8 KB ROM at 0xE000
     if (pio_pins & KC85_PIO_RAM) {
         if (pio_pins & KC85_PIO_RAM_RO) {
-            mem_map_ram(&sys->mem, 0, 0x0000, 0x4000, sys->ram[0]);
+            mem_bank_map_ram(&bank, 0x0000, 0x4000, sys->ram[0]);
         }
         else {
-            mem_map_rom(&sys->mem, 0, 0x0000, 0x4000, sys->ram[0]);
+            mem_bank_map_rom(&bank, 0x0000, 0x4000, sys->ram[0]);
         }
     }
     if (pio_pins & KC85_PIO_CAOS_ROM) {
-        mem_map_rom(&sys->mem, 0, 0xE000, 0x2000, sys->rom_caos_e);
+        mem_bank_map_rom(&bank, 0xE000, 0x2000, sys->rom_caos_e);
     }
 
     // KC85/3 and KC85/4: builtin 8 KB BASIC ROM at 0xC000
     #if !defined(CHIPS_KC85_TYPE_2)
         if (pio_pins & KC85_PIO_BASIC_ROM) {
-            mem_map_rom(&sys->mem, 0, 0xC000, 0x2000, sys->rom_basic);
+            mem_bank_map_rom(&bank, 0xC000, 0x2000, sys->rom_basic);
         }
     #endif
 
     #if !defined(CHIPS_KC85_TYPE_4) // KC85/2 and /3
         // 16 KB Video RAM at 0x8000
         if (pio_pins & KC85_PIO_IRM) {
-            mem_map_ram(&sys->mem, 0, 0x8000, 0x4000, sys->ram[KC85_IRM0_PAGE]);
+            mem_bank_map_ram(&bank, 0x8000, 0x4000, sys->ram[KC85_IRM0_PAGE]);
         }
     #else // KC84/4
         // 16 KB RAM at 0x4000
         if (sys->io86 & KC85_IO86_RAM4) {
             if (sys->io86 & KC85_IO86_RAM4_RO) {
-                mem_map_ram(&sys->mem, 0, 0x4000, 0x4000, sys->ram[1]);
+                mem_bank_map_ram(&bank, 0x4000, 0x4000, sys->ram[1]);
             }
             else {
-                mem_map_rom(&sys->mem, 0, 0x4000, 0x4000, sys->ram[1]);
+                mem_bank_map_rom(&bank, 0x4000, 0x4000, sys->ram[1]);
             }
         }
         // 16 KB RAM at 0x8000 (2 banks)
@@ -885,10 +1081,10 @@ static void _kc85_update_memory_map(kc85_t* sys) {
             // select one of two RAM banks
             uint8_t* ram8_ptr = (sys->io84 & KC85_IO84_SEL_RAM8) ? sys->ram[3] : sys->ram[2];
             if (pio_pins & KC85_PIO_RAM8_RO) {
-                mem_map_ram(&sys->mem, 0, 0x8000, 0x4000, ram8_ptr);
+                mem_bank_map_ram(&bank, 0x8000, 0x4000, ram8_ptr);
             }
             else {
-                mem_map_rom(&sys->mem, 0, 0x8000, 0x4000, ram8_ptr);
+                mem_bank_map_rom(&bank, 0x8000, 0x4000, ram8_ptr);
             }
         }
         /* video memory is 4 banks, 2 for pixels, 2 for colors,
@@ -903,29 +1099,69 @@ static void _kc85_update_memory_map(kc85_t* sys) {
               (A800 to BFFF) is always forced to the first IRM bank
               by the address decoder hardware (see KC85/4 service manual)
             */
-            mem_map_ram(&sys->mem, 0, 0x8000, 0x2800, irm_ptr);
+            mem_bank_map_ram(&bank, 0x8000, 0x2800, irm_ptr);
 
             // always force access to 0xA800 and above to the first IRM bank
-            mem_map_ram(&sys->mem, 0, 0xA800, 0x1800, sys->ram[KC85_IRM0_PAGE] + 0x2800);
+            mem_bank_map_ram(&bank, 0xA800, 0x1800, sys->ram[KC85_IRM0_PAGE] + 0x2800);
        }
        // 4 KB CAOS-C ROM at 0xC000 (on top of BASIC)
        if (sys->io86 & KC85_IO86_CAOS_ROM_C) {
-           mem_map_rom(&sys->mem, 0, 0xC000, 0x1000, sys->rom_caos_c);
+           mem_bank_map_rom(&bank, 0xC000, 0x1000, sys->rom_caos_c);
        }
     #endif // KC85/4
 
+    mem_map_bank(&sys->mem, 0, &bank);
+
     // let the module system update it's memory mapping
     _kc85_exp_update_memory_mapping(sys);
 }
 
+#if defined(CHIPS_EVENTS)
+// level bits in chips_event_ring_t.levels
+#define _KC85_EVENT_LEVEL_INT   (1<<0)
+#define _KC85_EVENT_LEVEL_NMI   (1<<1)
+
+// record the interrupt line and CTC events of a device tick (see "Hardware Event Timeline")
+static void _kc85_tick_events(kc85_t* sys, uint64_t pins, uint64_t ctc_pins) {
+    chips_event_ring_t* ring = sys->events;
+    if (chips_event_changed(ring, _KC85_EVENT_LEVEL_INT, 0 != (pins & Z80_INT))) {
+        chips_event_push(ring, CHIPS_EVENT_IRQ, 0, (pins & Z80_INT) ? 1 : 0);
+    }
+    #if !defined(CHIPS_KC85_TYPE_4)
+    if (chips_event_changed(ring, _KC85_EVENT_LEVEL_NMI, 0 != (pins & Z80_NMI))) {
+        chips_event_push(ring, CHIPS_EVENT_NMI, 0, (pins & Z80_NMI) ? 1 : 0);
+    }
+    #endif
+    for (uint16_t chn = 0; chn < 3; chn++) {
+        if (ctc_pins & (Z80CTC_ZCTO0 << chn)) {
+            chips_event_push(ring, CHIPS_EVENT_TIMER, chn, 0);
+        }
+    }
+}
+#endif
+
 static uint64_t _kc85_tick(kc85_t* sys, uint64_t pins) {
     // tick the CPU
     pins = z80_tick(&sys->cpu, pins) & Z80_PIN_MASK;
+    #if defined(CHIPS_EVENTS)
+    if (sys->events) {
+        sys->events->tick++;
+    }
+    #endif
+
+    // decode pending pixels before video memory is written (or display needling happens)
+    if ((pins & (Z80_WR | 0xC000)) == (Z80_WR | 0x8000)) {
+        _kc85_video_sync(sys, sys->video.h_tick>>1);
+    }
 
     // handle memory requests
     if (pins & Z80_MREQ) {
         const uint16_t addr = Z80_GET_ADDR(pins);
         if (pins & Z80_RD) {
+            // reading the CAOS keyboard flags passes in the next character of pending text input
+            if (chips_text_input_pending(&sys->text_input) && (addr == (uint16_t)(sys->cpu.ix + 0x8))) {
+                _kc85_text_input_fill(sys);
+            }
             Z80_SET_DATA(pins, mem_rd(&sys->mem, addr));
         }
         else if (pins & Z80_WR) {
@@ -933,10 +1169,22 @@ static uint64_t _kc85_tick(kc85_t* sys, uint64_t pins) {
         }
     }
 
+    // in overclock mode, only every Nth CPU tick also ticks the other chips,
+    // except for IO requests, RETI and wait states which must always be seen
+    if (sys->overclock > 1) {
+        if ((++sys->overclock_count < sys->overclock) && !(pins & (Z80_IORQ|Z80_RETI|Z80_WAIT))) {
+            return pins;
+        }
+        sys->overclock_count = 0;
+    }
+
     // tick the video system, may set CLKTRG0..3
     pins = _kc85_tick_video(sys, pins);
 
     // tick the CTC
+    #if defined(CHIPS_EVENTS)
+    uint64_t ctc_pins = 0;
+    #endif
     {
         // set virtual IEIO pin because CTC is highest priority interrupt device
         pins |= Z80_IEIO;
@@ -945,9 +1193,15 @@ static uint64_t _kc85_tick(kc85_t* sys, uint64_t pins) {
         }
         if (pins & Z80_A0) { pins |= Z80CTC_CS0; }
         if (pins & Z80_A1) { pins |= Z80CTC_CS1; }
-        pins = z80ctc_tick(&sys->ctc, pins);
+        pins = z80ctc_tick_sched(&sys->ctc, pins);
         // toggle audio and blink flip flops
+        if (pins & KC85_FLIPFLOP_BLINK) {
+            _kc85_video_sync(sys, sys->video.h_tick>>1);
+        }
         sys->flip_flops ^= pins;
+        #if defined(CHIPS_EVENTS)
+        ctc_pins = pins;
+        #endif
         pins &= Z80_PIN_MASK;
     }
 
@@ -960,7 +1214,7 @@ static uint64_t _kc85_tick(kc85_t* sys, uint64_t pins) {
         if (pins & Z80_A0) { pins |= Z80PIO_BASEL; }
         if (pins & Z80_A1) { pins |= Z80PIO_CDSEL; }
         Z80PIO_SET_PAB(pins, 0xFF, 0xFF);
-        pins = z80pio_tick(&sys->pio, pins);
+        pins = z80pio_tick_sched(&sys->pio, pins);
         #if defined(CHIPS_KC85_TYPE_4)
             // volume and symmetry-flip-flop control on KC85/4
             if (((pins ^ sys->pio_pins)>>Z80PIO_PIN_PB1) & 0x0F) {
@@ -979,6 +1233,10 @@ static uint64_t _kc85_tick(kc85_t* sys, uint64_t pins) {
             else                     { pins |= Z80_NMI; }
         #endif
         memory_mapping_dirty |= ((pins^sys->pio_pins) & KC85_PIO_MEMORY_BITS);
+        // PIO-B bit 7 enables blinking
+        if ((pins^sys->pio_pins) & Z80PIO_PB7) {
+            _kc85_video_sync(sys, sys->video.h_tick>>1);
+        }
         sys->pio_pins = pins;
         pins &= Z80_PIN_MASK;
     }
@@ -989,12 +1247,17 @@ static uint64_t _kc85_tick(kc85_t* sys, uint64_t pins) {
     beeper_tick(&sys->beeper_1);
     if (beeper_tick(&sys->beeper_2)) {
         // new audio sample ready
-        sys->audio.sample_buffer[sys->audio.sample_pos++] = sys->beeper_1.sample + sys->beeper_2.sample;
-        if (sys->audio.sample_pos == sys->audio.num_samples) {
-            if (sys->audio.callback.func) {
-                sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
+        if (sys->audio.ring) {
+            chips_audio_ring_push(sys->audio.ring, sys->beeper_1.sample + sys->beeper_2.sample);
+        }
+        else {
+            sys->audio.sample_buffer[sys->audio.sample_pos++] = sys->beeper_1.sample + sys->beeper_2.sample;
+            if (sys->audio.sample_pos == sys->audio.num_samples) {
+                if (sys->audio.callback.func) {
+                    sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
+                }
+                sys->audio.sample_pos = 0;
             }
-            sys->audio.sample_pos = 0;
         }
     }
 
@@ -1019,6 +1282,9 @@ static uint64_t _kc85_tick(kc85_t* sys, uint64_t pins) {
         if (pins & Z80_WR) {
             const uint8_t data = Z80_GET_DATA(pins);
             memory_mapping_dirty |= (data ^ sys->io84) & KC85_IO84_MEMORY_BITS;
+            if (data != sys->io84) {
+                _kc85_video_sync(sys, sys->video.h_tick>>1);
+            }
             sys->io84 = data;
         }
     }
@@ -1034,13 +1300,18 @@ static uint64_t _kc85_tick(kc85_t* sys, uint64_t pins) {
     if (memory_mapping_dirty) {
         _kc85_update_memory_map(sys);
     }
+    #if defined(CHIPS_EVENTS)
+    if (sys->events) {
+        _kc85_tick_events(sys, pins, ctc_pins);
+    }
+    #endif
     return pins;
 }
 
-uint32_t kc85_exec(kc85_t* sys, uint32_t micro_seconds) {
+uint32_t kc85_exec_ticks(kc85_t* sys, uint32_t num_ticks) {
     CHIPS_ASSERT(sys && sys->valid);
-    const uint32_t num_ticks = clk_us_to_ticks(sys->freq_hz, micro_seconds);
     uint64_t pins = sys->pins;
+    chips_dirty_lines_clear(&sys->dirty_lines);
     if (0 == sys->debug.callback.func) {
         // run without debug hook
         for (uint32_t tick = 0; tick < num_ticks; tick++) {
@@ -1049,17 +1320,47 @@ uint32_t kc85_exec(kc85_t* sys, uint32_t micro_seconds) {
     }
     else {
         // run with debug hook
+        chips_debug_filter_t* filter = sys->debug.filter;
         for (uint32_t tick = 0; (tick < num_ticks) && !(*sys->debug.stopped); tick++) {
             pins = _kc85_tick(sys, pins);
-            sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            if ((0 == filter) || chips_debug_filter_hit(filter, z80_opdone(&sys->cpu), Z80_GET_ADDR(pins),
+                    (pins & (Z80_MREQ|Z80_RD)) == (Z80_MREQ|Z80_RD), (pins & (Z80_MREQ|Z80_WR)) == (Z80_MREQ|Z80_WR))) {
+                sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            }
         }
     }
     sys->pins = pins;
-    kbd_update(&sys->kbd, micro_seconds);
-    _kc85_handle_keyboard(sys);
+    // decode the pixels the video beam has already passed
+    _kc85_video_sync(sys, sys->video.h_tick>>1);
+    kbd_update(&sys->kbd, clk_ticks_to_us(sys->freq_hz * sys->overclock, num_ticks));
+    if (!chips_text_input_pending(&sys->text_input)) {
+        _kc85_handle_keyboard(sys);
+    }
     return num_ticks;
 }
 
+uint32_t kc85_exec(kc85_t* sys, uint32_t micro_seconds) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return kc85_exec_ticks(sys, clk_us_to_ticks_frac(sys->freq_hz * sys->overclock, micro_seconds, &sys->tick_frac));
+}
+
+uint32_t kc85_exec_frame(kc85_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    // a new frame starts in the tick which wraps the scanline counter to 0
+    const uint32_t line_ticks = KC85_SCANLINE_TICKS - sys->video.h_tick;
+    const uint32_t num_lines = KC85_NUM_SCANLINES - 1 - sys->video.v_count;
+    // in overclock mode, the remaining device ticks are converted to CPU ticks
+    // (IO requests force extra device ticks, so this may run slightly past the frame end)
+    const uint32_t device_ticks = line_ticks + num_lines * KC85_SCANLINE_TICKS;
+    return kc85_exec_ticks(sys, device_ticks * sys->overclock - sys->overclock_count);
+}
+
+void kc85_set_overclock(kc85_t* sys, int factor) {
+    CHIPS_ASSERT(sys && sys->valid && (factor >= 1));
+    sys->overclock = (uint32_t)factor;
+    sys->overclock_count = 0;
+}
+
 static void _kc85_init_memory_map(kc85_t* sys) {
     mem_init(&sys->mem);
     sys->pio_pins = KC85_PIO_RAM | KC85_PIO_RAM_RO | KC85_PIO_IRM | KC85_PIO_CAOS_ROM;
@@ -1084,6 +1385,19 @@ static void _kc85_init_memory_map(kc85_t* sys) {
 #define _KC85_KBD_SHORT_REPEAT_COUNT (8)
 #define _KC85_KBD_LONG_REPEAT_COUNT (60)
 
+// pass the next character of pending text input to CAOS if the previous key code has been consumed
+static void _kc85_text_input_fill(kc85_t* sys) {
+    const uint16_t ix = sys->cpu.ix;
+    const uint8_t flags = mem_rd(&sys->mem, ix+0x8);
+    if (0 == (flags & _KC85_KBD_KEYREADY)) {
+        const uint8_t c = chips_text_input_next(&sys->text_input);
+        if (c != 0) {
+            mem_wr(&sys->mem, ix+0xD, c);
+            mem_wr(&sys->mem, ix+0x8, (flags & ~_KC85_KBD_TIMEOUT) | _KC85_KBD_KEYREADY);
+        }
+    }
+}
+
 static void _kc85_handle_keyboard(kc85_t* sys) {
     // don't do anything if interrupts disabled, IX might point to the wrong base address!
     if (!sys->cpu.iff1) {
@@ -1456,7 +1770,8 @@ static void _kc85_exp_update_memory_mapping(kc85_t* sys) {
            layer 0 is used by computer base unit
         */
         const size_t layer = i + 1;
-        mem_unmap_layer(&sys->mem, layer);
+        mem_bank_t bank;
+        mem_bank_init(&bank);
 
         // module is only active if bit 0 in control byte is set
         if (slot->ctrl & 0x01) {
@@ -1467,12 +1782,13 @@ static void _kc85_exp_update_memory_mapping(kc85_t* sys) {
             // RAM modules are only writable if bit 1 in control-byte is set
             const bool writable = (slot->ctrl & 0x02) && slot->mod.writable;
             if (writable) {
-                mem_map_ram(&sys->mem, layer, addr, slot->mod.size, host_addr);
+                mem_bank_map_ram(&bank, addr, slot->mod.size, host_addr);
             }
             else {
-                mem_map_rom(&sys->mem, layer, addr, slot->mod.size, host_addr);
+                mem_bank_map_rom(&bank, addr, slot->mod.size, host_addr);
             }
         }
+        mem_map_bank(&sys->mem, layer, &bank);
     }
 }
 
@@ -1493,6 +1809,7 @@ uint16_t kc85_quickload_return_addr(void) {
 
 // common start function for all snapshot file formats
 static void _kc85_load_start(kc85_t* sys, uint16_t exec_addr) {
+    z80_sync_flags(&sys->cpu);
     sys->cpu.a = 0x00;
     sys->cpu.f = 0x10;
     sys->cpu.bc = 0x0000; sys->cpu.bc2 = 0x0000;
@@ -1662,6 +1979,16 @@ bool kc85_quickload(kc85_t* sys, chips_range_t data, bool start) {
     }
 }
 
+void kc85_input_text(kc85_t* sys, const char* text) {
+    CHIPS_ASSERT(sys && sys->valid);
+    chips_text_input_start(&sys->text_input, (const uint8_t*)text, text ? strlen(text) : 0);
+}
+
+bool kc85_input_text_pending(kc85_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return chips_text_input_pending(&sys->text_input);
+}
+
 void kc85_key_down(kc85_t* sys, int key_code) {
     CHIPS_ASSERT(sys && sys->valid);
     kbd_key_down(&sys->kbd, key_code);
@@ -1739,7 +2066,8 @@ chips_display_info_t kc85_display_info(kc85_t* sys) {
         .palette = {
             .ptr = (void*)palette,
             .size = sizeof(palette)
-        }
+        },
+        .dirty_lines = sys ? &sys->dirty_lines : 0,
     };
     CHIPS_ASSERT(((sys == 0) && (res.frame.buffer.ptr == 0)) || ((sys != 0) && (res.frame.buffer.ptr != 0)));
     return res;
@@ -1747,11 +2075,22 @@ chips_display_info_t kc85_display_info(kc85_t* sys) {
 
 uint32_t kc85_save_snapshot(kc85_t* sys, kc85_t* dst) {
     CHIPS_ASSERT(sys && dst);
-    *dst = *sys;
+    memcpy(dst, sys, KC85_SNAPSHOT_SIZE);
     chips_debug_snapshot_onsave(&dst->debug);
     chips_audio_callback_snapshot_onsave(&dst->audio.callback);
     dst->patch_callback.func = 0;
     dst->patch_callback.user_data = 0;
+    #if defined(KC85_BORROWED_ROMS)
+        // ROM pages point outside of kc85_t, the mapping is rebuilt in kc85_load_snapshot()
+        mem_unmap_all(&dst->mem);
+        #if defined(CHIPS_KC85_TYPE_3) || defined(CHIPS_KC85_TYPE_4)
+            dst->rom_basic = 0;
+        #endif
+        #if defined(CHIPS_KC85_TYPE_4)
+            dst->rom_caos_c = 0;
+        #endif
+        dst->rom_caos_e = 0;
+    #endif
     mem_snapshot_onsave(&dst->mem, sys);
     return KC85_SNAPSHOT_VERSION;
 }
@@ -1764,13 +2103,51 @@ bool kc85_load_snapshot(kc85_t* sys, uint32_t version, const kc85_t* src) {
     }
     // intermediate copy
     static kc85_t im;
-    im = *src;
+    memcpy(&im, src, KC85_SNAPSHOT_SIZE);
     chips_debug_snapshot_onload(&im.debug, &sys->debug);
     chips_audio_callback_snapshot_onload(&im.audio.callback, &sys->audio.callback);
     im.patch_callback = sys->patch_callback;
+    // the overclock factor is a setting of the target system
+    if (im.overclock != sys->overclock) {
+        im.overclock = sys->overclock;
+        im.overclock_count = 0;
+    }
     mem_snapshot_onload(&im.mem, sys);
-    *sys = im;
+    #if defined(KC85_BORROWED_ROMS)
+        // the borrowed ROM images are taken from the target system
+        #if defined(CHIPS_KC85_TYPE_3) || defined(CHIPS_KC85_TYPE_4)
+            im.rom_basic = sys->rom_basic;
+        #endif
+        #if defined(CHIPS_KC85_TYPE_4)
+            im.rom_caos_c = sys->rom_caos_c;
+        #endif
+        im.rom_caos_e = sys->rom_caos_e;
+    #endif
+    memcpy(sys, &im, KC85_SNAPSHOT_SIZE);
+    #if defined(KC85_BORROWED_ROMS)
+        _kc85_update_memory_map(sys);
+    #endif
     return true;
 }
 
+void kc85_boot(kc85_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    // run silently and without debugger
+    const chips_debug_t debug = sys->debug;
+    const chips_audio_callback_t audio_callback = sys->audio.callback;
+    chips_audio_ring_t* audio_ring = sys->audio.ring;
+    chips_event_ring_t* events = sys->events;
+    sys->debug = (chips_debug_t){0};
+    sys->audio.callback = (chips_audio_callback_t){0};
+    sys->audio.ring = 0;
+    sys->events = 0;
+    for (uint32_t us = 0; us < KC85_BOOT_MICRO_SECONDS; us += 20000) {
+        kc85_exec(sys, 20000);
+    }
+    sys->debug = debug;
+    sys->audio.callback = audio_callback;
+    sys->audio.ring = audio_ring;
+    sys->events = events;
+}
+
 #endif /* CHIPS_IMPL */
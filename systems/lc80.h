@@ -24,6 +24,7 @@
     - chips/z80.h
     - chips/z80ctc.h
     - chips/z80pio.h
+    - chips/blip.h (only with CHIPS_BLIP)
     - chips/beeper.h
     - chips/kbd.h
     - chips/clk.h
@@ -77,7 +78,7 @@ extern "C" {
 #endif
 
 // bump this whenever the lc80_t struct layout changes
-#define LC80_SNAPSHOT_VERSION (0x0001)
+#define LC80_SNAPSHOT_VERSION (0x0007)
 
 // key codes (for lc80_key(), lc80_key_down(), lc80_key_up()
 #define LC80_KEY_0      ('0')
@@ -216,22 +217,29 @@ typedef struct {
 
     kbd_t kbd;
     uint32_t freq_hz;
+    uint32_t tick_frac;         // fractional tick carried over between lc80_exec() calls (see clk_us_to_ticks_frac())
 
+    uint8_t ram[0x0400];
+    uint8_t rom[0x0800];
+
+    // output-only state starting at audio.sample_buffer is not part of snapshots
     struct {
         chips_audio_callback_t callback;
         int num_samples;
         int sample_pos;
         float sample_buffer[LC80_MAX_AUDIO_SAMPLES];
+        chips_audio_ring_t* ring;
     } audio;
-
-    uint8_t ram[0x0400];
-    uint8_t rom[0x0800];
 } lc80_t;
 
+// size of the part of lc80_t which is stored in snapshots (the audio sample buffer are excluded)
+#define LC80_SNAPSHOT_SIZE (offsetof(lc80_t, audio.sample_buffer))
+
 void lc80_init(lc80_t* sys, const lc80_desc_t* desc);
 void lc80_discard(lc80_t* sys);
 void lc80_reset(lc80_t* sys);
 uint32_t lc80_exec(lc80_t* sys, uint32_t micro_seconds);
+uint32_t lc80_exec_ticks(lc80_t* sys, uint32_t num_ticks);
 void lc80_key_down(lc80_t* sys, int key_code);
 void lc80_key_up(lc80_t* sys, int key_code);
 void lc80_key(lc80_t* sys, int key_code);       // down + up
@@ -272,6 +280,7 @@ void lc80_init(lc80_t* sys, const lc80_desc_t* desc) {
         sys->vqe23[i] = 0x0000FFFF;
     }
     sys->audio.callback = desc->audio.callback;
+    sys->audio.ring = desc->audio.ring;
     sys->audio.num_samples = _LC80_DEFAULT(desc->audio.num_samples, LC80_DEFAULT_AUDIO_SAMPLES);
     beeper_init(&sys->beeper, &(beeper_desc_t){
         .tick_hz = sys->freq_hz,
@@ -550,12 +559,17 @@ uint64_t _lc80_tick(lc80_t* sys, uint64_t pins) {
     // tick beeper
     if (beeper_tick(&sys->beeper)) {
         /* new audio sample ready */
-        sys->audio.sample_buffer[sys->audio.sample_pos++] = sys->beeper.sample;
-        if (sys->audio.sample_pos == sys->audio.num_samples) {
-            if (sys->audio.callback.func) {
-                sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
+        if (sys->audio.ring) {
+            chips_audio_ring_push(sys->audio.ring, sys->beeper.sample);
+        }
+        else {
+            sys->audio.sample_buffer[sys->audio.sample_pos++] = sys->beeper.sample;
+            if (sys->audio.sample_pos == sys->audio.num_samples) {
+                if (sys->audio.callback.func) {
+                    sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
+                }
+                sys->audio.sample_pos = 0;
             }
-            sys->audio.sample_pos = 0;
         }
     }
     if (sys->nmi) {
@@ -567,9 +581,8 @@ uint64_t _lc80_tick(lc80_t* sys, uint64_t pins) {
     return pins;
 }
 
-uint32_t lc80_exec(lc80_t* sys, uint32_t micro_seconds) {
+uint32_t lc80_exec_ticks(lc80_t* sys, uint32_t num_ticks) {
     CHIPS_ASSERT(sys && sys->valid);
-    const uint32_t num_ticks = clk_us_to_ticks(sys->freq_hz, micro_seconds);
     uint64_t pins = sys->pins;
     if (0 == sys->debug.callback.func) {
         // run without debugger hook
@@ -579,9 +592,13 @@ uint32_t lc80_exec(lc80_t* sys, uint32_t micro_seconds) {
     }
     else {
         // run with debugger hook
+        chips_debug_filter_t* filter = sys->debug.filter;
         for (uint32_t tick = 0; (tick < num_ticks) && !(*sys->debug.stopped); tick++) {
             pins = _lc80_tick(sys, pins);
-            sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            if ((0 == filter) || chips_debug_filter_hit(filter, z80_opdone(&sys->cpu), Z80_GET_ADDR(pins),
+                    (pins & (Z80_MREQ|Z80_RD)) == (Z80_MREQ|Z80_RD), (pins & (Z80_MREQ|Z80_WR)) == (Z80_MREQ|Z80_WR))) {
+                sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            }
         }
     }
     sys->pins = pins;
@@ -591,10 +608,15 @@ uint32_t lc80_exec(lc80_t* sys, uint32_t micro_seconds) {
     if (sys->reset) {
         lc80_reset(sys);
     }
-    kbd_update(&sys->kbd, micro_seconds);
+    kbd_update(&sys->kbd, clk_ticks_to_us(sys->freq_hz, num_ticks));
     return num_ticks;
 }
 
+uint32_t lc80_exec(lc80_t* sys, uint32_t micro_seconds) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return lc80_exec_ticks(sys, clk_us_to_ticks_frac(sys->freq_hz, micro_seconds, &sys->tick_frac));
+}
+
 void lc80_key_down(lc80_t* sys, int key_code) {
     CHIPS_ASSERT(sys && sys->valid);
     switch (key_code) {
@@ -625,7 +647,7 @@ void lc80_key(lc80_t* sys, int key_code) {
 
 uint32_t lc80_save_snapshot(lc80_t* sys, lc80_t* dst) {
     CHIPS_ASSERT(sys && dst);
-    *dst = *sys;
+    memcpy(dst, sys, LC80_SNAPSHOT_SIZE);
     chips_debug_snapshot_onsave(&dst->debug);
     chips_audio_callback_snapshot_onsave(&dst->audio.callback);
     return LC80_SNAPSHOT_VERSION;
@@ -637,10 +659,10 @@ bool lc80_load_snapshot(lc80_t* sys, uint32_t version, lc80_t* src) {
         return false;
     }
     static lc80_t im;
-    im = *src;
+    memcpy(&im, src, LC80_SNAPSHOT_SIZE);
     chips_debug_snapshot_onload(&im.debug, &sys->debug);
     chips_audio_callback_snapshot_onload(&im.audio.callback, &sys->audio.callback);
-    *sys = im;
+    memcpy(sys, &im, LC80_SNAPSHOT_SIZE);
     return true;
 }
 
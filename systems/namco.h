@@ -40,6 +40,70 @@
     https://github.com/floooh/chips-test/blob/master/examples/sokol/pacman.c
     https://github.com/floooh/chips-test/blob/master/examples/sokol/pengo.c
 
+    ## Run-Ahead
+
+    Set namco_desc_t.runahead_frames to a value between 1 and
+    NAMCO_MAX_RUNAHEAD_FRAMES to hide the input latency of the emulated
+    game by running ahead of the actual emulation:
+
+    - first, namco_exec() or namco_exec_frame() runs the requested time
+      slice as usual with audio output, but without decoding the video output
+    - the emulator state is saved into an internal buffer (this doesn't
+      include the ROMs, framebuffer or other derived state, so it is much
+      smaller and faster than a full snapshot)
+    - the emulation runs ahead for the given number of frames with the
+      current input state and with the sound chip switched off, only the
+      last frame is decoded into the framebuffer
+    - the saved emulator state is restored
+
+    The displayed frame is then 'runahead_frames' frames ahead of the
+    audio output and the actual emulator state, which removes the same
+    number of frames of input lag, as long as the game doesn't react to
+    input earlier than that. The cost is that each call runs the emulation
+    for 1 + runahead_frames frames. Run-ahead is skipped while a debug
+    callback is installed, or while video decoding is switched off with
+    namco_enable_video().
+
+    ## Audio Thread
+
+    The Namco WSG sound chip only depends on the register values written
+    by the CPU, so it can be emulated on a separate audio thread. Provide
+    a chips_audio_log_t in namco_desc_t.audio_log (see 'Audio Register
+    Logs' in chips_common.h), the emulator then doesn't tick the sound
+    chip, but only pushes the sound register writes into the log, and
+    publishes the current tick at the end of each namco_exec_ticks()
+    call. The audio thread runs a copy of the sound chip state which is
+    initialized from the namco_t instance with namco_audio_thread_init(),
+    and generates all samples up to the published tick with
+    namco_audio_thread_exec(). The samples are written into the audio
+    ring buffer or passed to the audio callback from namco_desc_t.audio
+    like without an audio thread, but the audio callback is now called
+    on the audio thread:
+
+    ~~~C
+    static chips_audio_event_t events[1024];
+    static chips_audio_log_t log;
+    chips_audio_log_init(&log, events, 1024);
+    namco_init(&sys, &(namco_desc_t){ ..., .audio_log = &log });
+    static namco_audio_thread_t audio;
+    namco_audio_thread_init(&audio, &sys);
+
+    // on the audio thread:
+    while (running) {
+        if (0 == namco_audio_thread_exec(&audio)) {
+            // nothing to do, sleep or yield...
+        }
+    }
+    ~~~
+
+    The generated samples are identical to ticking the sound chip in the
+    emulator thread. When the log is full, the emulator thread waits for
+    the audio thread, so the audio thread must be running while the
+    emulation runs. Loading a snapshot pushes the register values from
+    the snapshot into the log, but not the phases of the waveform
+    counters, for an exact restore stop the audio thread and call
+    namco_audio_thread_init() again after namco_load_snapshot().
+
     ## zlib/libpng license
 
     Copyright (c) 2019 Andre Weissflog
@@ -68,7 +132,7 @@ extern "C" {
 #endif
 
 // increase when namco_t memory layout changes
-#define NAMCO_SNAPSHOT_VERSION (1)
+#define NAMCO_SNAPSHOT_VERSION (7)
 
 #define NAMCO_MAX_AUDIO_SAMPLES (1024)
 #define NAMCO_DEFAULT_AUDIO_SAMPLES (128)
@@ -94,10 +158,17 @@ extern "C" {
 #define NAMCO_INPUT_P2_COIN     (1<<12)
 #define NAMCO_INPUT_P2_START    (1<<13)
 
+// max number of frames to run ahead (see "Run-Ahead")
+#define NAMCO_MAX_RUNAHEAD_FRAMES (4)
+// size of the run-ahead state buffer (must be big enough for the namco_t state without ROMs)
+#define NAMCO_RUNAHEAD_STATE_SIZE (12 * 1024)
+
 // configuration parameters for namco_init()
 typedef struct {
     chips_debug_t debug;
     chips_audio_desc_t audio;
+    chips_audio_log_t* audio_log;   // optional, run the sound chip on a separate thread (see "Audio Thread")
+    int runahead_frames;    // number of frames to run ahead to reduce input latency (default: 0, see "Run-Ahead")
     struct {
         // common ROM areas for Pacman and Pengo
         struct {
@@ -133,20 +204,25 @@ typedef struct {
     int tick_counter;
     int sample_period;
     int sample_counter;
+    uint32_t pending_ticks;     // CPU ticks which haven't been run on the sound chip yet
+    int num_steps;              // number of 96 kHz steps accumulated in voice[].sample
     float volume;
     struct {
         uint32_t frequency; // 20-bit frequency
         uint32_t counter;   // 20-bit counter (top 5 bits are index into 32-byte wave table)
         uint8_t waveform;   // 3-bit waveform
         uint8_t volume;     // 4-bit volume
-        float sample;       // accumulated sample value
-        float sample_div  ; // oversampling divider
+        int sample;         // accumulated sample value
     } voice[3];
     uint8_t rom[2][0x0100]; // wave table ROM
     int num_samples;
     int sample_pos;
     chips_audio_callback_t callback;
     float sample_buffer[NAMCO_MAX_AUDIO_SAMPLES];
+    chips_audio_ring_t* ring;
+    chips_audio_log_t* log;     // optional register write log to the audio thread (see "Audio Thread")
+    uint32_t log_tick;          // free-running tick counter for the register write log
+    int8_t wave_table[8][16][32];   // signed samples decoded from the wave table ROM, [waveform][volume][pos]
 } namco_sound_t;
 
 // the Namco arcade machine state
@@ -159,6 +235,7 @@ typedef struct {
     uint8_t dsw2;   // Pengo only
     uint64_t pins;
     int vsync_count;
+    uint32_t tick_frac;     // fractional tick carried over between namco_exec() calls (see clk_us_to_ticks_frac())
     uint8_t int_vector;     // IM2 interrupt vector set with OUT on port 0
     uint8_t int_enable;
     uint8_t sound_enable;
@@ -171,18 +248,47 @@ typedef struct {
     bool valid;
     chips_debug_t debug;
 
-    namco_sound_t sound;
     uint8_t video_ram[0x0400];
     uint8_t color_ram[0x0400];
     uint8_t main_ram[0x0800];       // Pacman: 1 KB, Pengo: 2 KB
     uint8_t rom_cpu[0x8000];        // program ROM: Pacman: 16 KB, Pengo: 32 KB
     uint8_t rom_gfx[0x4000];        // tile ROM: Pacman: 8 KB, Pengo: 16 KB
     uint8_t rom_prom[0x0420];       // palette and color lookup ROM
+
+    // output-only and derived state starting at sound.sample_buffer is not part of snapshots
+    namco_sound_t sound;
     uint32_t hw_colors[32];         // decoded color palette from palette ROM
     uint8_t palette_cache[512];     // palette indirection table, Pacman: 256 entries , Pengo: 512 entries
     alignas(64) uint8_t fb[NAMCO_FRAMEBUFFER_SIZE_BYTES];   // indices into palette
+    uint8_t char_pixels[2][256][8*8];       // 2-bit char pixels pre-decoded from tile ROM, [tile_select][char_code][y*8+x]
+    uint8_t sprite_pixels[2][64][16*16];    // 2-bit sprite pixels pre-decoded from tile ROM, [tile_select][sprite_code][y*16+x]
+    struct {
+        bool valid;                 // false forces a redraw of all tiles
+        uint16_t pal_offset;        // palette cache offset the layer was drawn with
+        uint8_t tile_select;        // tile bank the layer was drawn with
+        uint8_t char_code[36*28];   // char and color code of each tile in the layer
+        uint8_t color_code[36*28];
+        alignas(64) uint8_t pixels[NAMCO_DISPLAY_WIDTH * NAMCO_DISPLAY_HEIGHT];
+    } bg_layer;
+    // run-ahead state (see "Run-Ahead")
+    struct {
+        int num_frames;             // number of frames to run ahead, 0 if disabled
+        bool video_disabled;        // don't decode the video output at the end of namco_exec_ticks() (see namco_enable_video())
+        bool audio_disabled;        // don't tick the sound chip
+        uint8_t state[NAMCO_RUNAHEAD_STATE_SIZE];   // emulator state saved before running ahead
+    } runahead;
 } namco_t;
 
+// size of the part of namco_t which is stored in snapshots (the audio sample buffer, decoded palettes and framebuffer are excluded)
+#define NAMCO_SNAPSHOT_SIZE (offsetof(namco_t, sound.sample_buffer))
+
+// sound chip state running on a separate audio thread (see "Audio Thread")
+typedef struct {
+    namco_sound_t sound;
+    uint8_t sound_enable;
+    uint32_t tick;              // tick of the next sound chip tick relative to the register write log
+} namco_audio_thread_t;
+
 // initialize a new namco_t instance
 void namco_init(namco_t* sys, const namco_desc_t* desc);
 // discard a namco_t instance
@@ -193,14 +299,26 @@ void namco_reset(namco_t* sys);
 chips_display_info_t namco_display_info(namco_t* sys);
 // run namco_t instance for given amount of microseconds, return number of ticks executed
 uint32_t namco_exec(namco_t* sys, uint32_t micro_seconds);
+// run namco_t instance for given number of ticks, return number of ticks executed
+uint32_t namco_exec_ticks(namco_t* sys, uint32_t num_ticks);
+// run namco_t instance until the next VSYNC, return number of ticks executed
+uint32_t namco_exec_frame(namco_t* sys);
 // set input bits
 void namco_input_set(namco_t* sys, uint32_t mask);
 // clear input bits
 void namco_input_clear(namco_t* sys, uint32_t mask);
+// enable/disable video decoding (run-ahead is skipped while video decoding is disabled)
+void namco_enable_video(namco_t* sys, bool enabled);
+// get current video decoding enabled state
+bool namco_video_enabled(namco_t* sys);
 // take a snapshot, patches any pointers to zero, returns a snapshot version
 uint32_t namco_save_snapshot(namco_t* sys, namco_t* dst);
 // load a snapshot, returns false if snapshot version doesn't match
 bool namco_load_snapshot(namco_t* sys, uint32_t version, namco_t* src);
+// initialize the audio thread's sound chip state from a namco_t instance with an audio log (call on the emulator thread)
+void namco_audio_thread_init(namco_audio_thread_t* audio, const namco_t* sys);
+// run the sound chip up to the last published tick (call on the audio thread), returns number of ticks executed
+uint32_t namco_audio_thread_exec(namco_audio_thread_t* audio);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -382,11 +500,53 @@ bool namco_load_snapshot(namco_t* sys, uint32_t version, namco_t* src);
 #define NAMCO_VSYNC_PERIOD      (NAMCO_CPU_CLOCK / 60)
 
 static void _namco_sound_init(namco_t* sys, const namco_desc_t* desc);
-static void _namco_sound_wr(namco_t* sys, uint16_t addr, uint8_t data);
-static void _namco_sound_tick(namco_t* sys);
+static void _namco_sound_wr(namco_sound_t* snd, uint16_t addr, uint8_t data);
+static void _namco_sound_run(namco_sound_t* snd, uint8_t sound_enable, uint32_t num_ticks);
+static void _namco_sound_sync(namco_t* sys);
+static void _namco_sound_init_wave_table(namco_sound_t* snd);
+static void _namco_sound_log(namco_t* sys, uint16_t addr, uint8_t data);
 
 #define _namco_def(val, def) (val == 0 ? def : val)
 
+/*
+    Pre-decode the 8x4 pixel stripes in tile ROM into one byte per pixel.
+
+    Each tile ROM byte holds 4 pixels with the pixel's high bit in the upper
+    and the low bit in the lower nibble. A char consists of 2 stripes of 8x4
+    pixels (16 bytes, right half first), a sprite of 8 stripes (64 bytes).
+*/
+static uint8_t _namco_tile_pixel(const uint8_t* tile, uint32_t xx) {
+    return (uint8_t)((((*tile>>(7-xx)) & 1)<<1) | ((*tile>>(3-xx)) & 1));
+}
+
+static void _namco_init_tile_cache(namco_t* sys) {
+    // tile ROM offsets of sprite stripes, left-to-right, top-to-bottom
+    static const uint8_t sprite_offsets[2][4] = { { 8, 16, 24, 0 }, { 40, 48, 56, 32 } };
+    for (uint32_t bank = 0; bank < 2; bank++) {
+        const uint8_t* char_base = &sys->rom_gfx[0x0000] + (bank * 0x2000);
+        for (uint32_t code = 0; code < 256; code++) {
+            uint8_t* dst = sys->char_pixels[bank][code];
+            for (uint32_t y = 0; y < 8; y++) {
+                for (uint32_t x = 0; x < 8; x++) {
+                    const uint8_t* tile = &char_base[code * 16 + ((x < 4) ? 8 : 0) + y];
+                    dst[y * 8 + x] = _namco_tile_pixel(tile, x & 3);
+                }
+            }
+        }
+        const uint8_t* sprite_base = &sys->rom_gfx[0x1000] + (bank * 0x2000);
+        for (uint32_t code = 0; code < 64; code++) {
+            uint8_t* dst = sys->sprite_pixels[bank][code];
+            for (uint32_t y = 0; y < 16; y++) {
+                for (uint32_t x = 0; x < 16; x++) {
+                    const uint8_t* tile = &sprite_base[code * 64 + sprite_offsets[y>>3][x>>2] + (y & 7)];
+                    dst[y * 16 + x] = _namco_tile_pixel(tile, x & 3);
+                }
+            }
+        }
+    }
+    sys->bg_layer.valid = false;
+}
+
 void namco_init(namco_t* sys, const namco_desc_t* desc) {
     CHIPS_ASSERT(sys && desc);
     if (desc->debug.callback.func) { CHIPS_ASSERT(desc->debug.stopped); }
@@ -395,6 +555,9 @@ void namco_init(namco_t* sys, const namco_desc_t* desc) {
     sys->valid = true;
     sys->debug = desc->debug;
     sys->vsync_count = NAMCO_VSYNC_PERIOD;
+    CHIPS_ASSERT((desc->runahead_frames >= 0) && (desc->runahead_frames <= NAMCO_MAX_RUNAHEAD_FRAMES));
+    CHIPS_ASSERT((offsetof(namco_t, rom_cpu) + offsetof(namco_sound_t, rom)) <= NAMCO_RUNAHEAD_STATE_SIZE);
+    sys->runahead.num_frames = desc->runahead_frames;
     _namco_sound_init(sys, desc);
     sys->pins = z80_init(&sys->cpu);
 
@@ -413,6 +576,7 @@ void namco_init(namco_t* sys, const namco_desc_t* desc) {
     memcpy(&sys->rom_prom[0], desc->roms.common.prom_0000_001F.ptr, 0x0020);
     memcpy(sys->sound.rom[0], desc->roms.common.sound_0000_00FF.ptr, 0x0100);
     memcpy(sys->sound.rom[1], desc->roms.common.sound_0100_01FF.ptr, 0x0100);
+    _namco_sound_init_wave_table(&sys->sound);
     #if defined(NAMCO_PENGO)
     CHIPS_ASSERT(desc->roms.pengo.cpu_4000_4FFF.ptr && (desc->roms.pengo.cpu_4000_4FFF.size == 0x1000));
     CHIPS_ASSERT(desc->roms.pengo.cpu_5000_5FFF.ptr && (desc->roms.pengo.cpu_5000_5FFF.size == 0x1000));
@@ -521,6 +685,7 @@ void namco_init(namco_t* sys, const namco_desc_t* desc) {
         sys->palette_cache[i] = pal_index;
         sys->palette_cache[256 + i] = 0x10 | pal_index;
     }
+    _namco_init_tile_cache(sys);
 }
 
 void namco_discard(namco_t* sys) {
@@ -543,8 +708,16 @@ static uint64_t _namco_tick(namco_t* sys, uint64_t pins) {
         }
     }
 
-    // tick the sound chip
-    _namco_sound_tick(sys);
+    // the sound chip is only run on sound register writes and at the end of namco_exec_ticks(),
+    // or on the audio thread with a register write log (see "Audio Thread")
+    if (!sys->runahead.audio_disabled) {
+        if (sys->sound.log) {
+            sys->sound.log_tick++;
+        }
+        else {
+            sys->sound.pending_ticks++;
+        }
+    }
 
     // tick the cpu
     pins = z80_tick(&sys->cpu, pins);
@@ -564,7 +737,9 @@ static uint64_t _namco_tick(namco_t* sys, uint64_t pins) {
                     sys->int_enable = data & 1;
                 }
                 else if (addr == NAMCO_ADDR_SOUND_ENABLE) {
+                    _namco_sound_sync(sys);
                     sys->sound_enable = data & 1;
+                    _namco_sound_log(sys, addr, data);
                 }
                 else if (addr == NAMCO_ADDR_FLIP_SCREEN) {
                     sys->flip_screen = data & 1;
@@ -581,7 +756,9 @@ static uint64_t _namco_tick(namco_t* sys, uint64_t pins) {
                 }
                 #endif
                 else if ((addr >= NAMCO_ADDR_SOUND_BASE) && (addr < (NAMCO_ADDR_SOUND_BASE+0x20))) {
-                    _namco_sound_wr(sys, addr, data);
+                    _namco_sound_sync(sys);
+                    _namco_sound_wr(&sys->sound, addr, data);
+                    _namco_sound_log(sys, addr, data);
                 }
                 else if ((addr >= NAMCO_ADDR_SPRITES_COORD) && (addr < (NAMCO_ADDR_SPRITES_COORD+0x10))) {
                     sys->sprite_coords[addr & 0xF] = data;
@@ -653,64 +830,53 @@ static uint16_t _namco_video_offset(uint32_t x, uint32_t y) {
     return offset;
 }
 
-// 8x4 video tile decoder (used both for background tiles and sprites)
-static inline void _namco_8x4(
-    uint8_t* fb,
-    uint8_t* tile_base,
-    uint8_t* pal_base,
-    uint8_t* pal_rom,
-    uint32_t tile_stride,
-    uint32_t tile_offset,
-    uint32_t px,
-    uint32_t py,
-    uint8_t char_code,
-    uint8_t color_code,
-    bool opaque,
-    bool flip_x,
-    bool flip_y)
-{
-    uint32_t xor_x = flip_x ? 3 : 0;
-    uint32_t xor_y = flip_y ? 7 : 0;
-    for (uint32_t yy = 0; yy < 8; yy++) {
-        uint32_t y = py + (yy ^ xor_y);
-        if (y >= NAMCO_DISPLAY_HEIGHT) {
-            continue;
-        }
-        int tile_index = char_code * tile_stride + tile_offset + yy;
-        for (uint32_t xx = 0; xx < 4; xx++) {
-            uint32_t x = px + (xx ^ xor_x);
-            if (x >= NAMCO_DISPLAY_WIDTH) {
+/*
+    Update the background tile layer, only tiles which changed since the
+    last frame are redrawn from the pre-decoded char pixels. Changes are
+    detected by comparing video- and color-RAM against the codes the layer
+    was drawn with, so this also catches writes which don't go through
+    the CPU (debugger, snapshots, quickload).
+*/
+static void _namco_decode_chars(namco_t* sys) {
+    const uint16_t pal_offset = (sys->pal_select<<8)|(sys->clut_select<<7);
+    const uint8_t* pal_base = &sys->palette_cache[pal_offset];
+    const bool redraw_all = !sys->bg_layer.valid ||
+                            (sys->bg_layer.pal_offset != pal_offset) ||
+                            (sys->bg_layer.tile_select != sys->tile_select);
+    sys->bg_layer.valid = true;
+    sys->bg_layer.pal_offset = pal_offset;
+    sys->bg_layer.tile_select = sys->tile_select;
+    for (uint32_t y = 0; y < 28; y++) {
+        for (uint32_t x = 0; x < 36; x++) {
+            const uint16_t offset = _namco_video_offset(x, y);
+            const uint8_t char_code = sys->video_ram[offset];
+            const uint8_t color_code = sys->color_ram[offset] & 0x1F;
+            const uint32_t tile_index = y * 36 + x;
+            if (!redraw_all &&
+                (sys->bg_layer.char_code[tile_index] == char_code) &&
+                (sys->bg_layer.color_code[tile_index] == color_code))
+            {
                 continue;
             }
-            uint8_t p2_hi = (tile_base[tile_index]>>(7-xx)) & 1;
-            uint8_t p2_lo = (tile_base[tile_index]>>(3-xx)) & 1;
-            uint8_t p2 = (p2_hi<<1)|p2_lo;
-            uint8_t hw_color = pal_base[(color_code<<2)|p2];
-            if (opaque || (pal_rom[hw_color] != 0)) {
-                fb[y * NAMCO_FRAMEBUFFER_WIDTH + x] = hw_color;
+            sys->bg_layer.char_code[tile_index] = char_code;
+            sys->bg_layer.color_code[tile_index] = color_code;
+            const uint8_t* src = sys->char_pixels[sys->tile_select][char_code];
+            const uint8_t* pal = &pal_base[color_code<<2];
+            uint8_t* dst = &sys->bg_layer.pixels[(y * 8) * NAMCO_DISPLAY_WIDTH + x * 8];
+            for (uint32_t yy = 0; yy < 8; yy++, src += 8, dst += NAMCO_DISPLAY_WIDTH) {
+                for (uint32_t xx = 0; xx < 8; xx++) {
+                    dst[xx] = pal[src[xx]];
+                }
             }
         }
     }
-}
-
-// decode background tiles
-static void _namco_decode_chars(namco_t* sys) {
-    uint8_t* pal_base = &sys->palette_cache[(sys->pal_select<<8)|(sys->clut_select<<7)];
-    uint8_t* tile_base = &sys->rom_gfx[0x0000] + (sys->tile_select * 0x2000);
-    for (uint32_t y = 0; y < 28; y++) {
-        for (uint32_t x = 0; x < 36; x++) {
-            uint16_t offset = _namco_video_offset(x, y);
-            uint8_t char_code = sys->video_ram[offset];
-            uint8_t color_code = sys->color_ram[offset] & 0x1F;
-            _namco_8x4(sys->fb, tile_base, pal_base, sys->rom_prom, 16, 8, x*8, y*8, char_code, color_code, true, false, false);
-            _namco_8x4(sys->fb, tile_base, pal_base, sys->rom_prom, 16, 0, x*8+4, y*8, char_code, color_code, true, false, false);
-        }
+    for (uint32_t y = 0; y < NAMCO_DISPLAY_HEIGHT; y++) {
+        memcpy(&sys->fb[y * NAMCO_FRAMEBUFFER_WIDTH], &sys->bg_layer.pixels[y * NAMCO_DISPLAY_WIDTH], NAMCO_DISPLAY_WIDTH);
     }
 }
 
 static void _namco_decode_sprites(namco_t* sys) {
-    uint8_t* pal_base = &sys->palette_cache[(sys->pal_select<<8)|(sys->clut_select<<7)];
-    uint8_t* tile_base = &sys->rom_gfx[0x1000] + (sys->tile_select * 0x2000);
+    const uint8_t* pal_base = &sys->palette_cache[(sys->pal_select<<8)|(sys->clut_select<<7)];
     #if defined(NAMCO_PACMAN)
     const int max_sprite = 6;
     const int min_sprite = 1;
@@ -724,22 +890,25 @@ static void _namco_decode_sprites(namco_t* sys) {
         uint8_t shape = sys->main_ram[NAMCO_ADDR_SPRITES_ATTR + sprite_index*2 + 0];
         uint8_t char_code = shape>>2;
         uint8_t color_code = sys->main_ram[NAMCO_ADDR_SPRITES_ATTR + sprite_index*2 + 1];
-        bool flip_x = shape & 1;
-        bool flip_y = shape & 2;
-        uint32_t fy0 = flip_y ? 8 : 0;
-        uint32_t fy1 = flip_y ? 0 : 8;
-        uint32_t fx0 = flip_x ? 12: 0;
-        uint32_t fx1 = flip_x ? 8 : 4;
-        uint32_t fx2 = flip_x ? 4 : 8;
-        uint32_t fx3 = flip_x ? 0 :12;
-        _namco_8x4(sys->fb, tile_base, pal_base, sys->rom_prom, 64, 8,  px+fx0, py+fy0, char_code, color_code, false, flip_x, flip_y);
-        _namco_8x4(sys->fb, tile_base, pal_base, sys->rom_prom, 64, 16, px+fx1, py+fy0, char_code, color_code, false, flip_x, flip_y);
-        _namco_8x4(sys->fb, tile_base, pal_base, sys->rom_prom, 64, 24, px+fx2, py+fy0, char_code, color_code, false, flip_x, flip_y);
-        _namco_8x4(sys->fb, tile_base, pal_base, sys->rom_prom, 64, 0,  px+fx3, py+fy0, char_code, color_code, false, flip_x, flip_y);
-        _namco_8x4(sys->fb, tile_base, pal_base, sys->rom_prom, 64, 40, px+fx0, py+fy1, char_code, color_code, false, flip_x, flip_y);
-        _namco_8x4(sys->fb, tile_base, pal_base, sys->rom_prom, 64, 48, px+fx1, py+fy1, char_code, color_code, false, flip_x, flip_y);
-        _namco_8x4(sys->fb, tile_base, pal_base, sys->rom_prom, 64, 56, px+fx2, py+fy1, char_code, color_code, false, flip_x, flip_y);
-        _namco_8x4(sys->fb, tile_base, pal_base, sys->rom_prom, 64, 32, px+fx3, py+fy1, char_code, color_code, false, flip_x, flip_y);
+        const uint32_t xor_x = (shape & 1) ? 15 : 0;
+        const uint32_t xor_y = (shape & 2) ? 15 : 0;
+        const uint8_t* src = sys->sprite_pixels[sys->tile_select][char_code];
+        for (uint32_t yy = 0; yy < 16; yy++) {
+            uint32_t y = py + (yy ^ xor_y);
+            if (y >= NAMCO_DISPLAY_HEIGHT) {
+                continue;
+            }
+            for (uint32_t xx = 0; xx < 16; xx++) {
+                uint32_t x = px + (xx ^ xor_x);
+                if (x >= NAMCO_DISPLAY_WIDTH) {
+                    continue;
+                }
+                uint8_t hw_color = pal_base[(color_code<<2)|src[yy * 16 + xx]];
+                if (sys->rom_prom[hw_color] != 0) {
+                    sys->fb[y * NAMCO_FRAMEBUFFER_WIDTH + x] = hw_color;
+                }
+            }
+        }
     }
 }
 
@@ -749,9 +918,8 @@ void _namco_decode_video(namco_t* sys) {
     _namco_decode_sprites(sys);
 }
 
-uint32_t namco_exec(namco_t* sys, uint32_t micro_seconds) {
+uint32_t namco_exec_ticks(namco_t* sys, uint32_t num_ticks) {
     CHIPS_ASSERT(sys && sys->valid);
-    const uint32_t num_ticks = clk_us_to_ticks(NAMCO_CPU_CLOCK, micro_seconds);
     uint64_t pins = sys->pins;
     if (0 == sys->debug.callback.func) {
         // run without debug hook
@@ -761,16 +929,75 @@ uint32_t namco_exec(namco_t* sys, uint32_t micro_seconds) {
     }
     else {
         // run with debug hook
+        chips_debug_filter_t* filter = sys->debug.filter;
         for (uint32_t tick = 0; (tick < num_ticks) && !(*sys->debug.stopped); tick++) {
             pins = _namco_tick(sys, pins);
-            sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            if ((0 == filter) || chips_debug_filter_hit(filter, z80_opdone(&sys->cpu), Z80_GET_ADDR(pins),
+                    (pins & (Z80_MREQ|Z80_RD)) == (Z80_MREQ|Z80_RD), (pins & (Z80_MREQ|Z80_WR)) == (Z80_MREQ|Z80_WR))) {
+                sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            }
         }
     }
     sys->pins = pins;
-    _namco_decode_video(sys);
+    if (sys->sound.log && !sys->runahead.audio_disabled) {
+        chips_audio_log_advance(sys->sound.log, sys->sound.log_tick);
+    }
+    _namco_sound_sync(sys);
+    if (!sys->runahead.video_disabled) {
+        _namco_decode_video(sys);
+    }
     return num_ticks;
 }
 
+/* the emulator state which changes while running is everything in front
+   of the ROM images, and the sound chip state in front of the wave table
+   ROM, pointers remain valid because the state is restored into the
+   same namco_t instance
+*/
+static void _namco_runahead_save(namco_t* sys) {
+    const size_t head_size = offsetof(namco_t, rom_cpu);
+    memcpy(sys->runahead.state, sys, head_size);
+    memcpy(sys->runahead.state + head_size, &sys->sound, offsetof(namco_sound_t, rom));
+}
+
+static void _namco_runahead_restore(namco_t* sys) {
+    const size_t head_size = offsetof(namco_t, rom_cpu);
+    memcpy(sys, sys->runahead.state, head_size);
+    memcpy(&sys->sound, sys->runahead.state + head_size, offsetof(namco_sound_t, rom));
+}
+
+// run the time slice, followed by the run-ahead frames which only produce video output
+static uint32_t _namco_exec(namco_t* sys, uint32_t num_ticks) {
+    if ((0 == sys->runahead.num_frames) || sys->debug.callback.func || sys->runahead.video_disabled) {
+        return namco_exec_ticks(sys, num_ticks);
+    }
+    sys->runahead.video_disabled = true;
+    namco_exec_ticks(sys, num_ticks);
+    sys->runahead.video_disabled = false;
+    _namco_runahead_save(sys);
+    sys->runahead.audio_disabled = true;
+    for (int i = 0; i < sys->runahead.num_frames; i++) {
+        // only the last run-ahead frame needs to be decoded
+        sys->runahead.video_disabled = (i < (sys->runahead.num_frames - 1));
+        namco_exec_ticks(sys, (uint32_t)(sys->vsync_count + 1));
+    }
+    sys->runahead.audio_disabled = false;
+    sys->runahead.video_disabled = false;
+    _namco_runahead_restore(sys);
+    return num_ticks;
+}
+
+uint32_t namco_exec(namco_t* sys, uint32_t micro_seconds) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return _namco_exec(sys, clk_us_to_ticks_frac(NAMCO_CPU_CLOCK, micro_seconds, &sys->tick_frac));
+}
+
+uint32_t namco_exec_frame(namco_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    // the VSYNC interrupt is triggered in the tick where the vsync counter goes negative
+    return _namco_exec(sys, (uint32_t)(sys->vsync_count + 1));
+}
+
 void namco_input_set(namco_t* sys, uint32_t mask) {
     CHIPS_ASSERT(sys && sys->valid);
     if (mask & NAMCO_INPUT_P1_UP) {
@@ -881,6 +1108,19 @@ static void _namco_sound_init(namco_t* sys, const namco_desc_t* desc) {
     snd->volume = _namco_def(desc->audio.volume, 1.0f);
     snd->num_samples = _namco_def(desc->audio.num_samples, NAMCO_DEFAULT_AUDIO_SAMPLES);
     snd->callback = desc->audio.callback;
+    snd->ring = desc->audio.ring;
+    snd->log = desc->audio_log;
+}
+
+// decode the 4-bit wave table ROM samples into signed samples multiplied with each 4-bit volume
+static void _namco_sound_init_wave_table(namco_sound_t* snd) {
+    for (int wave = 0; wave < 8; wave++) {
+        for (int vol = 0; vol < 16; vol++) {
+            for (int pos = 0; pos < 32; pos++) {
+                snd->wave_table[wave][vol][pos] = (int8_t)((((int)(snd->rom[0][(wave<<5) | pos] & 0xF)) - 8) * vol);
+            }
+        }
+    }
 }
 
 #define _NAMCO_SET_NIBBLE_0(val, data) (val=(val&~0x0000F)|((data&0xF)<<0))
@@ -889,8 +1129,7 @@ static void _namco_sound_init(namco_t* sys, const namco_desc_t* desc) {
 #define _NAMCO_SET_NIBBLE_3(val, data) (val=(val&~0x0F000)|((data&0xF)<<12))
 #define _NAMCO_SET_NIBBLE_4(val, data) (val=(val&~0xF0000)|((data&0xF)<<16))
 
-static void _namco_sound_wr(namco_t* sys, uint16_t addr, uint8_t data) {
-    namco_sound_t* snd = &sys->sound;
+static void _namco_sound_wr(namco_sound_t* snd, uint16_t addr, uint8_t data) {
     switch (addr) {
         case NAMCO_ADDR_SOUND_V1_FC0:       _NAMCO_SET_NIBBLE_0(snd->voice[0].counter, data); break;
         case NAMCO_ADDR_SOUND_V1_FC1:       _NAMCO_SET_NIBBLE_1(snd->voice[0].counter, data); break;
@@ -927,49 +1166,139 @@ static void _namco_sound_wr(namco_t* sys, uint16_t addr, uint8_t data) {
     }
 }
 
-static void _namco_sound_tick(namco_t* sys) {
-    namco_sound_t* snd = &sys->sound;
-    // tick the sound chip?
-    snd->tick_counter--;
-    if (snd->tick_counter < 0) {
-        // handle 96KHz tick
-        snd->tick_counter += NAMCO_SOUND_PERIOD / NAMCO_SOUND_OVERSAMPLE;
-        for (int i = 0; i < 3; i++) {
-            if ((snd->voice[i].frequency > 0) && (sys->sound_enable & 1)) {
-                snd->voice[i].counter += (snd->voice[i].frequency / NAMCO_SOUND_OVERSAMPLE);
-                /* lookup current 4-bit sample from waveform number and the topmost 5
-                   bits of the 20-bit sample counter, multiple with 4-bit volume
-                */
-                uint32_t smp_index = ((snd->voice[i].waveform<<5) | ((snd->voice[i].counter>>15) & 0x1F)) & 0xFF;
-                // integer sample value now 7-bits plus sign bit
-                int val = (((int)(snd->rom[0][smp_index] & 0xF)) - 8) * snd->voice[i].volume;
-                snd->voice[i].sample += (float)val;
+/* run the sound chip for a number of CPU ticks, instead of counting down
+   the 96 kHz step and output sample counters in each tick, skip directly
+   to the next tick where one of them expires
+*/
+static void _namco_sound_run(namco_sound_t* snd, uint8_t sound_enable, uint32_t num_ticks) {
+    while (num_ticks > 0) {
+        // number of ticks until the next 96 kHz step or output sample
+        uint32_t n = (uint32_t)snd->tick_counter + 1;
+        const uint32_t sample_ticks = (uint32_t)(snd->sample_counter / NAMCO_SAMPLE_SCALE) + 1;
+        if (n > sample_ticks) {
+            n = sample_ticks;
+        }
+        if (n > num_ticks) {
+            n = num_ticks;
+        }
+        num_ticks -= n;
+        snd->tick_counter -= (int)n;
+        snd->sample_counter -= (int)n * NAMCO_SAMPLE_SCALE;
+
+        // handle 96 kHz step
+        if (snd->tick_counter < 0) {
+            snd->tick_counter += NAMCO_SOUND_PERIOD / NAMCO_SOUND_OVERSAMPLE;
+            if (sound_enable & 1) {
+                for (int i = 0; i < 3; i++) {
+                    if (snd->voice[i].frequency > 0) {
+                        snd->voice[i].counter += (snd->voice[i].frequency / NAMCO_SOUND_OVERSAMPLE);
+                        // the topmost 5 bits of the 20-bit counter are the position in the waveform
+                        snd->voice[i].sample += snd->wave_table[snd->voice[i].waveform][snd->voice[i].volume][(snd->voice[i].counter>>15) & 0x1F];
+                    }
+                }
             }
-            snd->voice[i].sample_div += 128.0f;
+            snd->num_steps++;
         }
-    }
 
-    // generate a new sample?
-    snd->sample_counter -= NAMCO_SAMPLE_SCALE;
-    if (snd->sample_counter < 0) {
-        snd->sample_counter += snd->sample_period;
-        float sm = 0.0f;
-        for (int i = 0; i < 3; i++) {
-            if (snd->voice[i].sample_div > 0.0f) {
-                sm += snd->voice[i].sample / snd->voice[i].sample_div;
-                snd->voice[i].sample = 0.0f;
-                snd->voice[i].sample_div = 0.0f;
+        // generate a new sample?
+        if (snd->sample_counter < 0) {
+            snd->sample_counter += snd->sample_period;
+            float sm = 0.0f;
+            if (snd->num_steps > 0) {
+                // each accumulated sample value is in the range -128..127
+                sm = (float)(snd->voice[0].sample + snd->voice[1].sample + snd->voice[2].sample) / (float)(snd->num_steps * 128);
+                snd->voice[0].sample = snd->voice[1].sample = snd->voice[2].sample = 0;
+                snd->num_steps = 0;
+            }
+            sm *= snd->volume * 0.33333f;
+            if (snd->ring) {
+                chips_audio_ring_push(snd->ring, sm);
+            }
+            else {
+                snd->sample_buffer[snd->sample_pos++] = sm;
+                if (snd->sample_pos == snd->num_samples) {
+                    if (snd->callback.func) {
+                        snd->callback.func(snd->sample_buffer, snd->num_samples, snd->callback.user_data);
+                    }
+                    snd->sample_pos = 0;
+                }
             }
         }
-        sm *= snd->volume * 0.33333f;
-        snd->sample_buffer[snd->sample_pos++] = sm;
-        if (snd->sample_pos == snd->num_samples) {
-            if (snd->callback.func) {
-                snd->callback.func(snd->sample_buffer, snd->num_samples, snd->callback.user_data);
+    }
+}
+
+// run the sound chip up to the current tick (before a sound register write, and at the end of namco_exec_ticks())
+static void _namco_sound_sync(namco_t* sys) {
+    if (sys->sound.pending_ticks > 0) {
+        _namco_sound_run(&sys->sound, sys->sound_enable, sys->sound.pending_ticks);
+        sys->sound.pending_ticks = 0;
+    }
+}
+
+// push a sound register write into the audio thread's register log (not while running ahead)
+static void _namco_sound_log(namco_t* sys, uint16_t addr, uint8_t data) {
+    if (sys->sound.log && !sys->runahead.audio_disabled) {
+        chips_audio_log_push(sys->sound.log, sys->sound.log_tick, addr, data);
+    }
+}
+
+// push all sound register values into the register log, for instance after loading a snapshot
+static void _namco_sound_log_regs(namco_t* sys) {
+    const namco_sound_t* snd = &sys->sound;
+    for (int i = 0; i < 5; i++) {
+        _namco_sound_log(sys, NAMCO_ADDR_SOUND_V1_FQ0 + i, (snd->voice[0].frequency >> (i * 4)) & 0xF);
+    }
+    for (int i = 1; i < 5; i++) {
+        _namco_sound_log(sys, NAMCO_ADDR_SOUND_V2_FQ1 + i - 1, (snd->voice[1].frequency >> (i * 4)) & 0xF);
+        _namco_sound_log(sys, NAMCO_ADDR_SOUND_V3_FQ1 + i - 1, (snd->voice[2].frequency >> (i * 4)) & 0xF);
+    }
+    _namco_sound_log(sys, NAMCO_ADDR_SOUND_V1_WAVE, snd->voice[0].waveform);
+    _namco_sound_log(sys, NAMCO_ADDR_SOUND_V2_WAVE, snd->voice[1].waveform);
+    _namco_sound_log(sys, NAMCO_ADDR_SOUND_V3_WAVE, snd->voice[2].waveform);
+    _namco_sound_log(sys, NAMCO_ADDR_SOUND_V1_VOLUME, snd->voice[0].volume);
+    _namco_sound_log(sys, NAMCO_ADDR_SOUND_V2_VOLUME, snd->voice[1].volume);
+    _namco_sound_log(sys, NAMCO_ADDR_SOUND_V3_VOLUME, snd->voice[2].volume);
+    _namco_sound_log(sys, NAMCO_ADDR_SOUND_ENABLE, sys->sound_enable);
+}
+
+void namco_audio_thread_init(namco_audio_thread_t* audio, const namco_t* sys) {
+    CHIPS_ASSERT(audio && sys && sys->valid && sys->sound.log);
+    memcpy(&audio->sound, &sys->sound, sizeof(namco_sound_t));
+    audio->sound_enable = sys->sound_enable;
+    audio->tick = sys->sound.log_tick;
+}
+
+uint32_t namco_audio_thread_exec(namco_audio_thread_t* audio) {
+    CHIPS_ASSERT(audio && audio->sound.log);
+    namco_sound_t* snd = &audio->sound;
+    chips_audio_log_t* log = snd->log;
+    const uint32_t horizon = chips_audio_log_horizon(log);
+    uint32_t num_ticks = 0;
+    for (;;) {
+        // apply the register writes which happened after the previous sound chip tick
+        const chips_audio_event_t* ev;
+        while ((ev = chips_audio_log_peek(log)) && ((int32_t)(ev->tick - audio->tick) <= 0)) {
+            if (ev->reg == NAMCO_ADDR_SOUND_ENABLE) {
+                audio->sound_enable = ev->value & 1;
             }
-            snd->sample_pos = 0;
+            else {
+                _namco_sound_wr(snd, ev->reg, ev->value);
+            }
+            chips_audio_log_pop(log);
+        }
+        if (audio->tick == horizon) {
+            break;
+        }
+        // run the sound chip up to the next register write or the horizon
+        uint32_t n = horizon - audio->tick;
+        if (ev && ((ev->tick - audio->tick) < n)) {
+            n = ev->tick - audio->tick;
         }
+        _namco_sound_run(snd, audio->sound_enable, n);
+        audio->tick += n;
+        num_ticks += n;
     }
+    return num_ticks;
 }
 
 chips_display_info_t namco_display_info(namco_t* sys) {
@@ -1002,9 +1331,19 @@ chips_display_info_t namco_display_info(namco_t* sys) {
     return res;
 }
 
+void namco_enable_video(namco_t* sys, bool enabled) {
+    CHIPS_ASSERT(sys && sys->valid);
+    sys->runahead.video_disabled = !enabled;
+}
+
+bool namco_video_enabled(namco_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return !sys->runahead.video_disabled;
+}
+
 uint32_t namco_save_snapshot(namco_t* sys, namco_t* dst) {
     CHIPS_ASSERT(sys && dst);
-    *dst = *sys;
+    memcpy(dst, sys, NAMCO_SNAPSHOT_SIZE);
     chips_debug_snapshot_onsave(&dst->debug);
     chips_audio_callback_snapshot_onsave(&dst->sound.callback);
     mem_snapshot_onsave(&dst->mem, sys);
@@ -1017,11 +1356,14 @@ bool namco_load_snapshot(namco_t* sys, uint32_t version, namco_t* src) {
         return false;
     }
     static namco_t im;
-    im = *src;
+    memcpy(&im, src, NAMCO_SNAPSHOT_SIZE);
     chips_debug_snapshot_onload(&im.debug, &sys->debug);
     chips_audio_callback_snapshot_onload(&im.sound.callback, &sys->sound.callback);
     mem_snapshot_onload(&im.mem, sys);
-    *sys = im;
+    memcpy(sys, &im, NAMCO_SNAPSHOT_SIZE);
+    _namco_init_tile_cache(sys);
+    _namco_sound_init_wave_table(&sys->sound);
+    _namco_sound_log_regs(sys);
     return true;
 }
 
@@ -18,6 +18,15 @@
     ~~~
         your own assert macro (default: assert(c))
 
+    ~~~C
+    VIC20_NO_FRAMEBUFFER
+    ~~~
+        if defined, vic20_t doesn't contain a framebuffer and video decoding
+        is skipped, this is useful for headless instances (e.g.
+        automated tests or servers) which only need the CPU and I/O side of
+        the emulation, the framebuffer pointer in vic20_display_info() is
+        then null, must be the same for all files which include vic20.h
+
     You need to include the following headers before including vic20.h:
 
     - chips/chips_common.h
@@ -65,7 +74,7 @@ extern "C" {
 #endif
 
 // bump snapshot version when vic20_t memory layout changes
-#define VIC20_SNAPSHOT_VERSION (1)
+#define VIC20_SNAPSHOT_VERSION (7)
 
 #define VIC20_FREQUENCY (1108404)
 #define VIC20_MAX_AUDIO_SAMPLES (1024)        // max number of audio samples in internal sample buffer
@@ -137,6 +146,7 @@ typedef struct {
     uint8_t joy_joy_mask;       // current joystick state from vic20_joystick()
     uint64_t via1_joy_mask;     // merged keyboard/joystick mask ready for or-ing with VIA1 input pins
     uint64_t via2_joy_mask;     // merged keyboard/joystick mask ready for or-ing with VIA2 input pins
+    uint32_t tick_frac;         // fractional tick carried over between vic20_exec() calls (see clk_us_to_ticks_frac())
 
     kbd_t kbd;                  // keyboard matrix state
     mem_t mem_cpu;              // CPU-visible memory mapping
@@ -144,13 +154,6 @@ typedef struct {
     bool valid;
     chips_debug_t debug;
 
-    struct {
-        chips_audio_callback_t callback;
-        int num_samples;
-        int sample_pos;
-        float sample_buffer[VIC20_MAX_AUDIO_SAMPLES];
-    } audio;
-
     uint8_t color_ram[0x0400];      // special color RAM
     uint8_t ram0[0x0400];           // 1 KB zero page, stack, system work area
     uint8_t ram_3k[0x0C00];         // optional 3K exp RAM
@@ -159,13 +162,27 @@ typedef struct {
     uint8_t rom_basic[0x2000];      // 8 KB BASIC ROM image
     uint8_t rom_kernal[0x2000];     // 8 KB KERNAL V3 ROM image
     uint8_t ram_exp[4][0x2000];     // optional expansion 8K RAM blocks
-    uint8_t fb[M6561_FRAMEBUFFER_SIZE_BYTES];
 
     c1530_t c1530;                  // c1530.valid = true if enabled
 
     mem_t mem_cart;                 // special ROM cartridge memory mapping helper
+
+    // output-only state starting at audio.sample_buffer is not part of snapshots
+    struct {
+        chips_audio_callback_t callback;
+        int num_samples;
+        int sample_pos;
+        float sample_buffer[VIC20_MAX_AUDIO_SAMPLES];
+        chips_audio_ring_t* ring;
+    } audio;
+    #if !defined(VIC20_NO_FRAMEBUFFER)
+    uint8_t fb[M6561_FRAMEBUFFER_SIZE_BYTES];
+    #endif
 } vic20_t;
 
+// size of the part of vic20_t which is stored in snapshots (the audio sample buffer and framebuffer are excluded)
+#define VIC20_SNAPSHOT_SIZE (offsetof(vic20_t, audio.sample_buffer))
+
 // initialize a new VIC-20 instance
 void vic20_init(vic20_t* sys, const vic20_desc_t* desc);
 // discard VIC-20 instance
@@ -176,6 +193,10 @@ void vic20_reset(vic20_t* sys);
 chips_display_info_t vic20_display_info(vic20_t* sys);
 // tick VIC-20 instance for a given number of microseconds, return number of executed ticks
 uint32_t vic20_exec(vic20_t* sys, uint32_t micro_seconds);
+// tick VIC-20 instance for a given number of ticks, return number of executed ticks
+uint32_t vic20_exec_ticks(vic20_t* sys, uint32_t num_ticks);
+// tick VIC-20 instance until the VIC starts the next vertical retrace, return number of executed ticks
+uint32_t vic20_exec_frame(vic20_t* sys);
 // send a key-down event to the VIC-20
 void vic20_key_down(vic20_t* sys, int key_code);
 // send a key-up event to the VIC-20
@@ -243,6 +264,7 @@ void vic20_init(vic20_t* sys, const vic20_desc_t* desc) {
     sys->via2_joy_mask = M6522_PB7;
     sys->debug = desc->debug;
     sys->audio.callback = desc->audio.callback;
+    sys->audio.ring = desc->audio.ring;
     sys->audio.num_samples = _VIC20_DEFAULT(desc->audio.num_samples, VIC20_DEFAULT_AUDIO_SAMPLES);
     CHIPS_ASSERT(sys->audio.num_samples <= VIC20_MAX_AUDIO_SAMPLES);
     CHIPS_ASSERT(desc->roms.chars.ptr && (desc->roms.chars.size == sizeof(sys->rom_char)));
@@ -260,10 +282,12 @@ void vic20_init(vic20_t* sys, const vic20_desc_t* desc) {
     m6522_init(&sys->via_2);
     m6561_init(&sys->vic, &(m6561_desc_t){
         .fetch_cb = _vic20_vic_fetch,
+        #if !defined(VIC20_NO_FRAMEBUFFER)
         .framebuffer = {
             .ptr = sys->fb,
             .size = sizeof(sys->fb)
         },
+        #endif
         .screen = {
             .x = _VIC20_SCREEN_X,
             .y = _VIC20_SCREEN_Y,
@@ -464,7 +488,7 @@ static uint64_t _vic20_tick(vic20_t* sys, uint64_t pins) {
         if (sys->cas_port & VIC20_CASPORT_SENSE) {
             via1_pins |= M6522_PA6;
         }
-        via1_pins = m6522_tick(&sys->via_1, via1_pins);
+        via1_pins = m6522_tick_sched(&sys->via_1, via1_pins);
         if (via1_pins & M6522_CA2) {
             sys->cas_port |= VIC20_CASPORT_MOTOR;
         }
@@ -505,7 +529,7 @@ static uint64_t _vic20_tick(vic20_t* sys, uint64_t pins) {
         if (sys->cas_port & VIC20_CASPORT_READ) {
             via2_pins |= M6522_CA1;
         }
-        via2_pins = m6522_tick(&sys->via_2, via2_pins);
+        via2_pins = m6522_tick_sched(&sys->via_2, via2_pins);
         uint8_t kbd_cols = ~M6522_GET_PB(via2_pins);
         kbd_set_active_columns(&sys->kbd, kbd_cols);
         if (via2_pins & M6522_IRQ) {
@@ -523,12 +547,17 @@ static uint64_t _vic20_tick(vic20_t* sys, uint64_t pins) {
             pins = M6502_COPY_DATA(pins, vic_pins);
         }
         if (vic_pins & M6561_SAMPLE) {
-            sys->audio.sample_buffer[sys->audio.sample_pos++] = sys->vic.sound.sample;
-            if (sys->audio.sample_pos == sys->audio.num_samples) {
-                if (sys->audio.callback.func) {
-                    sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
+            if (sys->audio.ring) {
+                chips_audio_ring_push(sys->audio.ring, sys->vic.sound.sample);
+            }
+            else {
+                sys->audio.sample_buffer[sys->audio.sample_pos++] = sys->vic.sound.sample;
+                if (sys->audio.sample_pos == sys->audio.num_samples) {
+                    if (sys->audio.callback.func) {
+                        sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
+                    }
+                    sys->audio.sample_pos = 0;
                 }
-                sys->audio.sample_pos = 0;
             }
         }
     }
@@ -540,9 +569,8 @@ static uint64_t _vic20_tick(vic20_t* sys, uint64_t pins) {
     return pins;
 }
 
-uint32_t vic20_exec(vic20_t* sys, uint32_t micro_seconds) {
+uint32_t vic20_exec_ticks(vic20_t* sys, uint32_t num_ticks) {
     CHIPS_ASSERT(sys && sys->valid);
-    uint32_t num_ticks = clk_us_to_ticks(VIC20_FREQUENCY, micro_seconds);
     uint64_t pins = sys->pins;
     if (0 == sys->debug.callback.func) {
         // run without debug callback
@@ -552,16 +580,30 @@ uint32_t vic20_exec(vic20_t* sys, uint32_t micro_seconds) {
     }
     else {
         // run with debug callback
+        chips_debug_filter_t* filter = sys->debug.filter;
         for (uint32_t ticks = 0; (ticks < num_ticks) && !(*sys->debug.stopped); ticks++) {
             pins = _vic20_tick(sys, pins);
-            sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            if ((0 == filter) || chips_debug_filter_hit(filter, 0 != (pins & M6502_SYNC), M6502_GET_ADDR(pins),
+                    0 != (pins & M6502_RW), 0 == (pins & M6502_RW))) {
+                sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            }
         }
     }
     sys->pins = pins;
-    kbd_update(&sys->kbd, micro_seconds);
+    kbd_update(&sys->kbd, clk_ticks_to_us(VIC20_FREQUENCY, num_ticks));
     return num_ticks;
 }
 
+uint32_t vic20_exec(vic20_t* sys, uint32_t micro_seconds) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return vic20_exec_ticks(sys, clk_us_to_ticks_frac(VIC20_FREQUENCY, micro_seconds, &sys->tick_frac));
+}
+
+uint32_t vic20_exec_frame(vic20_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return vic20_exec_ticks(sys, m6561_ticks_to_vsync(&sys->vic));
+}
+
 static uint16_t _vic20_vic_fetch(uint16_t addr, void* user_data) {
     vic20_t* sys = (vic20_t*) user_data;
     uint16_t data = (sys->color_ram[addr & 0x03FF]<<8) | mem_rd(&sys->mem_vic, addr);
@@ -808,8 +850,10 @@ chips_display_info_t vic20_display_info(vic20_t* sys) {
             },
             .bytes_per_pixel = 1,
             .buffer = {
+                #if !defined(VIC20_NO_FRAMEBUFFER)
                 .ptr = sys ? sys->fb : 0,
                 .size = M6561_FRAMEBUFFER_SIZE_BYTES,
+                #endif
             }
         },
         .palette = m6561_palette(),
@@ -825,13 +869,15 @@ chips_display_info_t vic20_display_info(vic20_t* sys) {
             .height = _VIC20_SCREEN_HEIGHT,
         };
     }
+    #if !defined(VIC20_NO_FRAMEBUFFER)
     CHIPS_ASSERT(((sys == 0) && (res.frame.buffer.ptr == 0)) || ((sys != 0) && (res.frame.buffer.ptr != 0)));
+    #endif
     return res;
 }
 
 uint32_t vic20_save_snapshot(vic20_t* sys, vic20_t* dst) {
     CHIPS_ASSERT(sys && dst);
-    *dst = *sys;
+    memcpy(dst, sys, VIC20_SNAPSHOT_SIZE);
     chips_debug_snapshot_onsave(&dst->debug);
     chips_audio_callback_snapshot_onsave(&dst->audio.callback);
     m6502_snapshot_onsave(&dst->cpu);
@@ -849,7 +895,7 @@ bool vic20_load_snapshot(vic20_t* sys, uint32_t version, vic20_t* src) {
         return false;
     }
     static vic20_t im;
-    im = *src;
+    memcpy(&im, src, VIC20_SNAPSHOT_SIZE);
     chips_debug_snapshot_onload(&im.debug, &sys->debug);
     chips_audio_callback_snapshot_onload(&im.audio.callback, &sys->audio.callback);
     m6502_snapshot_onload(&im.cpu, &sys->cpu);
@@ -858,7 +904,7 @@ bool vic20_load_snapshot(vic20_t* sys, uint32_t version, vic20_t* src) {
     mem_snapshot_onload(&im.mem_cpu, sys);
     mem_snapshot_onload(&im.mem_vic, sys);
     mem_snapshot_onload(&im.mem_cart, sys);
-    *sys = im;
+    memcpy(sys, &im, VIC20_SNAPSHOT_SIZE);
     return true;
 }
 
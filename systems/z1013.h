@@ -27,6 +27,9 @@
     - chips/kbd.h
     - chips/clk.h
 
+    If chips/mem.h is included before chips/z80.h, the CPU runs with the
+    faster z80_exec() (see z80.h), otherwise with z80_tick().
+
     ## The Robotron Z1013
 
     The Z1013 was a very simple East German home computer, basically
@@ -40,6 +43,17 @@
 
     No cassette-tape / beeper sound emulated!
 
+    ## CPU Overclocking
+
+    For workloads which don't depend on real-hardware speed, the CPU can run
+    at a multiple of its nominal clock frequency. Set z1013_desc_t.overclock
+    to the overclock factor (default is 1, no overclocking), or change it at
+    runtime with z1013_set_overclock(). Since the Z1013 has no timed devices
+    (the PIO is only ticked on IO requests, and the video memory is decoded
+    once per z1013_exec() call), this only affects the conversion from
+    micro-seconds to CPU ticks in z1013_exec(), so that the frame timing of
+    the host stays unchanged.
+
     ## TODO: add hardware/software reference links
 
     ## TODO: Describe Usage
@@ -73,7 +87,7 @@ extern "C" {
 #endif
 
 // bump this whenever the z1013_t struct layout changes
-#define Z1013_SNAPSHOT_VERSION (0x0001)
+#define Z1013_SNAPSHOT_VERSION (0x0008)
 
 #define Z1013_FRAMEBUFFER_WIDTH (256)
 #define Z1013_FRAMEBUFFER_HEIGHT (256)
@@ -92,6 +106,7 @@ typedef enum {
 typedef struct {
     z1013_type_t type;          // default is Z1013_TYPE_64
     chips_debug_t debug;        // optional debug callback and userdata ptr
+    int overclock;              // optional CPU overclock factor (default: 1)
 
     // ROM images
     struct {
@@ -114,10 +129,20 @@ typedef struct {
     int kbd_request_line_hilo_shift;
     kbd_t kbd;
     uint64_t freq_hz;
+    uint32_t tick_frac;         // fractional tick carried over between z1013_exec() calls (see clk_us_to_ticks_frac())
+    uint32_t overclock;         // CPU overclock factor (see 'CPU Overclocking')
     uint8_t ram[1<<16];
     uint8_t rom_os[2048];
     uint8_t rom_font[2048];
+    // output-only state starting at fb is not part of snapshots
     alignas(64) uint8_t fb[Z1013_FRAMEBUFFER_SIZE_BYTES];
+    chips_dirty_lines_t dirty_lines;    // framebuffer lines changed in the last z1013_exec() call
+    // the video memory content at the last decode, only changed characters are decoded again
+    struct {
+        bool valid;
+        uint8_t chars[1024];
+        uint64_t glyphs[256 * 8];       // font pixel rows pre-expanded to 8 framebuffer bytes
+    } vidmem_cache;
 } z1013_t;
 
 // initialize a new Z1013 instance
@@ -130,6 +155,10 @@ void z1013_reset(z1013_t* sys);
 chips_display_info_t z1013_display_info(z1013_t* sys);
 // run the Z1013 instance for a given number of microseconds, returns number of executed ticks
 uint32_t z1013_exec(z1013_t* sys, uint32_t micro_seconds);
+// run the Z1013 instance for a given number of ticks, returns number of executed ticks
+uint32_t z1013_exec_ticks(z1013_t* sys, uint32_t num_ticks);
+// set the CPU overclock factor (1 means no overclocking)
+void z1013_set_overclock(z1013_t* sys, int factor);
 // send a key-down event
 void z1013_key_down(z1013_t* sys, int key_code);
 // send a key-up event
@@ -188,6 +217,18 @@ bool z1013_load_snapshot(z1013_t* sys, uint32_t version, const z1013_t* src);
 #define _Z1013_PORT8_SEL_MASK (Z80_IORQ|Z80_WR|Z80_A4|Z80_A3|Z80_A2)
 #define _Z1013_PORT8_SEL_PINS (Z80_IORQ|Z80_WR|Z80_A3)
 
+// expand the font ROM into framebuffer bytes (0 or 1 per pixel)
+static void _z1013_init_glyphs(z1013_t* sys) {
+    for (size_t i = 0; i < 256 * 8; i++) {
+        const uint8_t pixels = sys->rom_font[i];
+        uint8_t row[8];
+        for (size_t x = 0; x < 8; x++) {
+            row[x] = (pixels >> (7 - x)) & 1;
+        }
+        memcpy(&sys->vidmem_cache.glyphs[i], row, sizeof(row));
+    }
+}
+
 void z1013_init(z1013_t* sys, const z1013_desc_t* desc) {
     CHIPS_ASSERT(sys && desc);
     if (desc->debug.callback.func) { CHIPS_ASSERT(desc->debug.stopped); }
@@ -196,6 +237,7 @@ void z1013_init(z1013_t* sys, const z1013_desc_t* desc) {
     sys->type = desc->type;
     sys->valid = true;
     sys->freq_hz = (Z1013_TYPE_01 == desc->type) ? 1000000 : 2000000;
+    sys->overclock = (desc->overclock > 1) ? (uint32_t)desc->overclock : 1;
     sys->debug = desc->debug;
 
     // copy ROM dumps
@@ -210,6 +252,8 @@ void z1013_init(z1013_t* sys, const z1013_desc_t* desc) {
         memcpy(sys->rom_os, desc->roms.mon_a2.ptr, sizeof(sys->rom_os));
     }
 
+    _z1013_init_glyphs(sys);
+
     // initialize the hardware
     z80_init(&sys->cpu);
     z80pio_init(&sys->pio);
@@ -320,8 +364,9 @@ void z1013_reset(z1013_t* sys) {
     sys->pins = z80_prefetch(&sys->cpu, 0xF000);
 }
 
-static uint64_t _z1013_tick(z1013_t* sys, uint64_t pins) {
-    pins = z80_tick(&sys->cpu, pins) & Z80_PIN_MASK;
+// everything except the CPU, shared between _z1013_tick() and _z1013_exec_tick()
+static uint64_t _z1013_tick_devices(z1013_t* sys, uint64_t pins) {
+    pins &= Z80_PIN_MASK;
 
     // handle memory requests
     if (pins & Z80_MREQ) {
@@ -343,7 +388,7 @@ static uint64_t _z1013_tick(z1013_t* sys, uint64_t pins) {
         if (pins & Z80_A1) { pins |= Z80PIO_BASEL; }
         uint8_t pb = sys->kbd_request_line_mask >> sys->kbd_request_line_hilo_shift;
         Z80PIO_SET_PAB(pins, 0xFF, pb);
-        pins = z80pio_tick(&sys->pio, pins);
+        pins = z80pio_tick_sched(&sys->pio, pins);
         // bit 4 for 8x8 keyboard selects upper or lower 4 kbd matrix line bits
         if (Z1013_TYPE_01 != sys->type) {
             // kbd_request_line_hilo_shift will be 0 or 4
@@ -363,54 +408,101 @@ static uint64_t _z1013_tick(z1013_t* sys, uint64_t pins) {
     return pins & Z80_PIN_MASK;
 }
 
+static uint64_t _z1013_tick(z1013_t* sys, uint64_t pins) {
+    return _z1013_tick_devices(sys, z80_tick(&sys->cpu, pins));
+}
+
+#if defined(Z80_HAS_EXEC)
+/* z80_exec() callback, the Z1013 has no interrupts, no wait states and
+    the PIO port inputs only change on IO requests, so apart from plain
+    memory accesses nothing happens between IO requests
+*/
+static uint64_t _z1013_exec_tick(uint32_t num_ticks, uint64_t pins, void* user_data) {
+    (void)num_ticks;
+    return _z1013_tick_devices((z1013_t*)user_data, pins);
+}
+#endif
+
 /* since the Z1013 didn't have any sort of programmable video output,
-    we're cheating a bit and decode the entire frame in one go
+    we're cheating a bit and decode the entire frame in one go, but only
+    the characters which have changed since the last decode (comparing
+    against a copy, because memory writes in z80_exec() bypass the tick
+    callback)
 */
 static void _z1013_decode_vidmem(z1013_t* sys) {
-    static const uint32_t lut32[16] = {
-        0x00000000, 0x01000000, 0x00010000, 0x01010000,
-        0x00000100, 0x01000100, 0x00010100, 0x01010100,
-        0x00000001, 0x01000001, 0x00010001, 0x01010001,
-        0x00000101, 0x01000101, 0x00010101, 0x01010101,
-    };
-    uint32_t* dst32 = (uint32_t*) sys->fb;
     const uint8_t* src = &sys->ram[0xEC00];   // the 32x32 framebuffer starts at EC00
-    const uint8_t* font = sys->rom_font;
-    for (size_t y = 0; y < 32; y++) {
-        for (size_t py = 0; py < 8; py++) {
-            for (size_t x = 0; x < 32; x++) {
-                uint8_t chr = src[(y<<5) + x];
-                uint8_t pixels = font[(chr<<3)|py];
-                *dst32++ = lut32[pixels >> 4];
-                *dst32++ = lut32[pixels & 0xF];
+    uint8_t* chars = sys->vidmem_cache.chars;
+    const uint64_t* glyphs = sys->vidmem_cache.glyphs;
+    const bool valid = sys->vidmem_cache.valid;
+    for (size_t y = 0; y < 32; y++, src += 32, chars += 32) {
+        if (valid && (0 == memcmp(src, chars, 32))) {
+            continue;
+        }
+        for (size_t x = 0; x < 32; x++) {
+            const uint8_t chr = src[x];
+            if (valid && (chr == chars[x])) {
+                continue;
+            }
+            chars[x] = chr;
+            uint8_t* dst = &sys->fb[(y * 8) * Z1013_FRAMEBUFFER_WIDTH + x * 8];
+            for (size_t py = 0; py < 8; py++, dst += Z1013_FRAMEBUFFER_WIDTH) {
+                const uint64_t pixels = glyphs[(chr<<3)|py];
+                uint64_t old_pixels;
+                memcpy(&old_pixels, dst, sizeof(old_pixels));
+                if (pixels != old_pixels) {
+                    memcpy(dst, &pixels, sizeof(pixels));
+                    chips_dirty_lines_set(&sys->dirty_lines, y * 8 + py);
+                }
             }
         }
     }
+    sys->vidmem_cache.valid = true;
 }
 
-uint32_t z1013_exec(z1013_t* sys, uint32_t micro_seconds) {
+uint32_t z1013_exec_ticks(z1013_t* sys, uint32_t num_ticks) {
     CHIPS_ASSERT(sys && sys->valid);
-    const uint32_t num_ticks = clk_us_to_ticks(sys->freq_hz, micro_seconds);
+    chips_dirty_lines_clear(&sys->dirty_lines);
     uint64_t pins = sys->pins;
     if (0 == sys->debug.callback.func) {
+        #if defined(Z80_HAS_EXEC)
+        // run without debug hook, plain memory accesses are handled inside z80_exec()
+        if (num_ticks > 0) {
+            pins = z80_exec(&sys->cpu, &sys->mem, pins, num_ticks, _z1013_exec_tick, sys);
+        }
+        #else
         // run without debug hook
         for (uint32_t ticks = 0; ticks < num_ticks; ticks++) {
             pins = _z1013_tick(sys, pins);
         }
+        #endif
     }
     else {
         // run with debug hook
+        chips_debug_filter_t* filter = sys->debug.filter;
         for (uint32_t ticks = 0; (ticks < num_ticks) && !(*sys->debug.stopped); ticks++) {
             pins = _z1013_tick(sys, pins);
-            sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            if ((0 == filter) || chips_debug_filter_hit(filter, z80_opdone(&sys->cpu), Z80_GET_ADDR(pins),
+                    (pins & (Z80_MREQ|Z80_RD)) == (Z80_MREQ|Z80_RD), (pins & (Z80_MREQ|Z80_WR)) == (Z80_MREQ|Z80_WR))) {
+                sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            }
         }
     }
     sys->pins = pins;
-    kbd_update(&sys->kbd, micro_seconds);
+    kbd_update(&sys->kbd, clk_ticks_to_us(sys->freq_hz * sys->overclock, num_ticks));
     _z1013_decode_vidmem(sys);
     return num_ticks;
 }
 
+uint32_t z1013_exec(z1013_t* sys, uint32_t micro_seconds) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return z1013_exec_ticks(sys, clk_us_to_ticks_frac(sys->freq_hz * sys->overclock, micro_seconds, &sys->tick_frac));
+}
+
+void z1013_set_overclock(z1013_t* sys, int factor) {
+    CHIPS_ASSERT(sys && sys->valid && (factor >= 1));
+    sys->overclock = (uint32_t)factor;
+}
+
 void z1013_key_down(z1013_t* sys, int key_code) {
     CHIPS_ASSERT(sys && sys->valid);
     kbd_key_down(&sys->kbd, key_code);
@@ -491,7 +583,8 @@ chips_display_info_t z1013_display_info(z1013_t* sys) {
         .palette = {
             .ptr = (void*)palette,
             .size = sizeof(palette)
-        }
+        },
+        .dirty_lines = sys ? &sys->dirty_lines : 0,
     };
     CHIPS_ASSERT(((sys == 0) && (res.frame.buffer.ptr == 0)) || ((sys != 0) && (res.frame.buffer.ptr != 0)));
     return res;
@@ -515,6 +608,8 @@ bool z1013_load_snapshot(z1013_t* sys, uint32_t version, const z1013_t* src) {
     im = *src;
     chips_debug_snapshot_onload(&im.debug, &sys->debug);
     mem_snapshot_onload(&im.mem, sys);
+    // the overclock factor is a setting of the target system
+    im.overclock = sys->overclock;
     *sys = im;
     return true;
 }
@@ -24,6 +24,7 @@
     - chips/z80.h
     - chips/z80pio.h
     - chips/z80ctc.h
+    - chips/blip.h (only with CHIPS_BLIP)
     - chips/beeper.h
     - chips/mem.h
     - chips/kbd.h
@@ -88,7 +89,7 @@ extern "C" {
 #endif
 
 // bump this whenever the z9001_t struct layout changes
-#define Z9001_SNAPSHOT_VERSION (0x0001)
+#define Z9001_SNAPSHOT_VERSION (0x0008)
 
 #define Z9001_MAX_AUDIO_SAMPLES (1024)      // max number of audio samples in internal sample buffer
 #define Z9001_DEFAULT_AUDIO_SAMPLES (128)   // default number of samples in internal sample buffer
@@ -139,6 +140,7 @@ typedef struct {
     uint64_t pins;
     uint64_t ctc_zcto2;         // pin mask to store state of CTC ZCTO2
     uint32_t blink_counter;
+    uint32_t tick_frac;         // fractional tick carried over between z9001_exec() calls (see clk_us_to_ticks_frac())
     // FIXME: uint8_t border_color;
     mem_t mem;
     kbd_t kbd;
@@ -147,18 +149,32 @@ typedef struct {
     bool z9001_has_basic_rom;
     chips_debug_t debug;
 
+    uint8_t ram[1<<16];
+    uint8_t rom[0x4000];
+    uint8_t rom_font[0x0800];   // 2 KB font ROM (not mapped into CPU address space)
+
+    // output-only state starting at audio.sample_buffer is not part of snapshots
     struct {
         chips_audio_callback_t callback;
         int num_samples;
         int sample_pos;
         float sample_buffer[Z9001_MAX_AUDIO_SAMPLES];
+        chips_audio_ring_t* ring;
     } audio;
-    uint8_t ram[1<<16];
-    uint8_t rom[0x4000];
-    uint8_t rom_font[0x0800];   // 2 KB font ROM (not mapped into CPU address space)
     alignas(64) uint8_t fb[Z9001_FRAMEBUFFER_SIZE_BYTES];
+    chips_dirty_lines_t dirty_lines;    // framebuffer lines changed in the last z9001_exec() call
+    // the video memory content at the last decode, only changed characters are decoded again
+    struct {
+        bool valid;
+        uint8_t chars[24 * 40];
+        uint8_t colors[24 * 40];        // colors after applying the blink flip flop
+        uint64_t glyphs[256 * 8];       // font pixel rows pre-expanded to 8 bytes (0x00 or 0xFF per pixel)
+    } vidmem_cache;
 } z9001_t;
 
+// size of the part of z9001_t which is stored in snapshots (the audio sample buffer and framebuffer are excluded)
+#define Z9001_SNAPSHOT_SIZE (offsetof(z9001_t, audio.sample_buffer))
+
 // initialize a new Z9001 instance
 void z9001_init(z9001_t* sys, const z9001_desc_t* desc);
 // discard a Z9001 instance
@@ -169,6 +185,8 @@ void z9001_reset(z9001_t* sys);
 chips_display_info_t z9001_display_info(z9001_t* sys);
 // run Z9001 instance for a given number of microseconds, return number of executed ticks
 uint32_t z9001_exec(z9001_t* sys, uint32_t micro_seconds);
+// run Z9001 instance for a given number of ticks, return number of executed ticks
+uint32_t z9001_exec_ticks(z9001_t* sys, uint32_t num_ticks);
 // send a key-down event
 void z9001_key_down(z9001_t* sys, int key_code);
 // send a key-up event
@@ -216,6 +234,18 @@ static inline uint32_t _z9001_xorshift32(uint32_t x) {
 #define _Z9001_PIO2_SEL_MASK (_Z9001_IO_SEL_MASK|Z80_A5|Z80_A4|Z80_A3)
 #define _Z9001_PIO2_SEL_PINS (_Z9001_IO_SEL_PINS|Z80_A4)
 
+// expand the font ROM into 8-pixel masks
+static void _z9001_init_glyphs(z9001_t* sys) {
+    for (size_t i = 0; i < 256 * 8; i++) {
+        const uint8_t pixels = sys->rom_font[i];
+        uint8_t row[8];
+        for (size_t x = 0; x < 8; x++) {
+            row[x] = (pixels & (0x80 >> x)) ? 0xFF : 0x00;
+        }
+        memcpy(&sys->vidmem_cache.glyphs[i], row, sizeof(row));
+    }
+}
+
 void z9001_init(z9001_t* sys, const z9001_desc_t* desc) {
     CHIPS_ASSERT(sys && desc);
     if (desc->debug.callback.func) { CHIPS_ASSERT(desc->debug.stopped); }
@@ -246,6 +276,8 @@ void z9001_init(z9001_t* sys, const z9001_desc_t* desc) {
         memcpy(&sys->rom[0x2000], desc->roms.kc87.os.ptr, 0x2000);
     }
 
+    _z9001_init_glyphs(sys);
+
     // initialize the hardware
     z80_init(&sys->cpu);
     z80ctc_init(&sys->ctc);
@@ -253,6 +285,7 @@ void z9001_init(z9001_t* sys, const z9001_desc_t* desc) {
     z80pio_init(&sys->pio2);
 
     sys->audio.callback = desc->audio.callback;
+    sys->audio.ring = desc->audio.ring;
     sys->audio.num_samples = _Z9001_DEFAULT(desc->audio.num_samples, Z9001_DEFAULT_AUDIO_SAMPLES);
     CHIPS_ASSERT(sys->audio.num_samples <= Z9001_MAX_AUDIO_SAMPLES);
     beeper_init(&sys->beeper, &(beeper_desc_t){
@@ -397,7 +430,7 @@ static uint64_t _z9001_tick(z9001_t* sys, uint64_t pins) {
         if (pins & Z80_A0) { pins |= Z80PIO_BASEL; }
         if (pins & Z80_A1) { pins |= Z80PIO_CDSEL; }
         // no port A/B inputs
-        pins = z80pio_tick(&sys->pio1, pins);
+        pins = z80pio_tick_sched(&sys->pio1, pins);
         /*
             FIXME:
             PIO1-A bits:
@@ -425,7 +458,7 @@ static uint64_t _z9001_tick(z9001_t* sys, uint64_t pins) {
         const uint8_t pa_in = ~kbd_scan_columns(&sys->kbd);
         const uint8_t pb_in = ~kbd_scan_lines(&sys->kbd);
         Z80PIO_SET_PAB(pins, pa_in, pb_in);
-        pins = z80pio_tick(&sys->pio2, pins);
+        pins = z80pio_tick_sched(&sys->pio2, pins);
         const uint8_t pa_out = ~Z80PIO_GET_PA(pins);
         const uint8_t pb_out = ~Z80PIO_GET_PB(pins);
         kbd_set_active_columns(&sys->kbd, pa_out);
@@ -448,7 +481,7 @@ static uint64_t _z9001_tick(z9001_t* sys, uint64_t pins) {
         if (pins & Z80_A0) { pins |= Z80CTC_CS0; };
         if (pins & Z80_A1) { pins |= Z80CTC_CS1; };
         if (pins & Z80CTC_ZCTO2) { pins |= Z80CTC_CLKTRG3; }
-        pins = z80ctc_tick(&sys->ctc, pins);
+        pins = z80ctc_tick_sched(&sys->ctc, pins);
         if (pins & Z80CTC_ZCTO0) {
             // CTC channel 0 controls the beeper frequency
             beeper_toggle(&sys->beeper);
@@ -460,12 +493,17 @@ static uint64_t _z9001_tick(z9001_t* sys, uint64_t pins) {
     // tick the beeper
     if (beeper_tick(&sys->beeper)) {
         // new audio sample ready
-        sys->audio.sample_buffer[sys->audio.sample_pos++] = sys->beeper.sample;
-        if (sys->audio.sample_pos == sys->audio.num_samples) {
-            if (sys->audio.callback.func) {
-                sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
+        if (sys->audio.ring) {
+            chips_audio_ring_push(sys->audio.ring, sys->beeper.sample);
+        }
+        else {
+            sys->audio.sample_buffer[sys->audio.sample_pos++] = sys->beeper.sample;
+            if (sys->audio.sample_pos == sys->audio.num_samples) {
+                if (sys->audio.callback.func) {
+                    sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
+                }
+                sys->audio.sample_pos = 0;
             }
-            sys->audio.sample_pos = 0;
         }
     }
 
@@ -481,68 +519,57 @@ static uint64_t _z9001_tick(z9001_t* sys, uint64_t pins) {
     return pins;
 }
 
-static inline void _z9001_decode_8pixels(uint8_t* dst, uint8_t pixels, uint8_t colors) {
-    // courtesy of ryg: https://mastodon.gamedev.place/@rygorous/109531596140414988
-    static const uint32_t lut32[16] = {
-        0x00000000, 0xff000000, 0x00ff0000, 0xffff0000,
-        0x0000ff00, 0xff00ff00, 0x00ffff00, 0xffffff00,
-        0x000000ff, 0xff0000ff, 0x00ff00ff, 0xffff00ff,
-        0x0000ffff, 0xff00ffff, 0x00ffffff, 0xffffffff,
-    };
-    const uint32_t colors32 = colors * 0x01010101u;
-    const uint32_t bg32 = colors32 & 0x07070707;
-    const uint32_t fg32 = (colors32 >> 4) & 0x07070707;
-    const uint32_t xor32 = bg32 ^ fg32;
-    uint32_t* dst32 = (uint32_t*)dst;
-    dst32[0] = bg32 ^ (xor32 & lut32[pixels >> 4]);
-    dst32[1] = bg32 ^ (xor32 & lut32[pixels & 0xf]);
-}
-
+/* decode the entire frame in one go, but only the characters which have
+    changed since the last decode (this includes the characters with the
+    blink attribute when the blink flip flop changes)
+*/
 static void _z9001_decode_vidmem(z9001_t* sys) {
     // FIXME: there's also a 40x20 video mode
     const uint8_t* vidmem = &sys->ram[0xEC00];     // 1 KB ASCII buffer at EC00
     const uint8_t* colmem = &sys->ram[0xE800];     // 1 KB color buffer at E800
+    const bool color = Z9001_TYPE_KC87 == sys->type;   // KC87 with color module
+    const uint64_t* glyphs = sys->vidmem_cache.glyphs;
+    const bool valid = sys->vidmem_cache.valid;
     size_t offset = 0;
-    if (Z9001_TYPE_KC87 == sys->type) {
-        // KC87 with color module
-        const uint8_t* font = sys->rom_font;
-        for (size_t y = 0; y < 24; y++) {
-            for (size_t py = 0; py < 8; py++) {
-                uint8_t* dst = &sys->fb[(y * 8 + py) * Z9001_FRAMEBUFFER_WIDTH];
-                for (size_t x = 0; x < 40; x++, dst += 8) {
-                    uint8_t chr = vidmem[offset+x];
-                    uint8_t pixels = font[(chr<<3)|py];
-                    uint8_t colors = colmem[offset+x];
-                    if (colors & sys->blink_flip_flop & 0x80) {
-                        // blinking: swap back- and foreground color
-                        colors = ((colors & 7) << 4) | ((colors >> 4) & 7);
-                    }
-                    _z9001_decode_8pixels(dst, pixels, colors);
+    for (size_t y = 0; y < 24; y++) {
+        for (size_t x = 0; x < 40; x++) {
+            const size_t i = offset + x;
+            const uint8_t chr = vidmem[i];
+            uint8_t colors = 0x70;      // Z9001 monochrome display
+            if (color) {
+                colors = colmem[i];
+                if (colors & sys->blink_flip_flop & 0x80) {
+                    // blinking: swap back- and foreground color
+                    colors = ((colors & 7) << 4) | ((colors >> 4) & 7);
                 }
             }
-            offset += 40;
-        }
-    }
-    else {
-        // Z9001 monochrome display
-        const uint8_t* font = sys->rom_font;
-        for (size_t y = 0; y < 24; y++) {
-            for (size_t py = 0; py < 8; py++) {
-                uint8_t* dst = &sys->fb[(y * 8 + py) * Z9001_FRAMEBUFFER_WIDTH];
-                for (size_t x = 0; x < 40; x++, dst += 8) {
-                    uint8_t chr = vidmem[offset + x];
-                    uint8_t pixels = font[(chr<<3)|py];
-                    _z9001_decode_8pixels(dst, pixels, 0x70);
+            if (valid && (chr == sys->vidmem_cache.chars[i]) && (colors == sys->vidmem_cache.colors[i])) {
+                continue;
+            }
+            sys->vidmem_cache.chars[i] = chr;
+            sys->vidmem_cache.colors[i] = colors;
+            // courtesy of ryg: https://mastodon.gamedev.place/@rygorous/109531596140414988
+            const uint64_t bg64 = (colors & 7) * 0x0101010101010101ULL;
+            const uint64_t fg64 = ((colors >> 4) & 7) * 0x0101010101010101ULL;
+            uint8_t* dst = &sys->fb[(y * 8) * Z9001_FRAMEBUFFER_WIDTH + x * 8];
+            for (size_t py = 0; py < 8; py++, dst += Z9001_FRAMEBUFFER_WIDTH) {
+                const uint64_t pixels = bg64 ^ ((bg64 ^ fg64) & glyphs[(chr<<3)|py]);
+                uint64_t old_pixels;
+                memcpy(&old_pixels, dst, sizeof(old_pixels));
+                if (pixels != old_pixels) {
+                    memcpy(dst, &pixels, sizeof(pixels));
+                    chips_dirty_lines_set(&sys->dirty_lines, y * 8 + py);
                 }
             }
-            offset += 40;
         }
+        offset += 40;
     }
+    sys->vidmem_cache.valid = true;
 }
 
-uint32_t z9001_exec(z9001_t* sys, uint32_t micro_seconds) {
+uint32_t z9001_exec_ticks(z9001_t* sys, uint32_t num_ticks) {
     CHIPS_ASSERT(sys && sys->valid);
-    const uint32_t num_ticks = clk_us_to_ticks(_Z9001_FREQUENCY, micro_seconds);
+    chips_dirty_lines_clear(&sys->dirty_lines);
     uint64_t pins = sys->pins;
     if (0 == sys->debug.callback.func) {
         // run without debug hook
@@ -552,17 +579,26 @@ uint32_t z9001_exec(z9001_t* sys, uint32_t micro_seconds) {
     }
     else {
         // run with debug hook
+        chips_debug_filter_t* filter = sys->debug.filter;
         for (uint32_t tick = 0; (tick < num_ticks) && !(*sys->debug.stopped); tick++) {
             pins = _z9001_tick(sys, pins);
-            sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            if ((0 == filter) || chips_debug_filter_hit(filter, z80_opdone(&sys->cpu), Z80_GET_ADDR(pins),
+                    (pins & (Z80_MREQ|Z80_RD)) == (Z80_MREQ|Z80_RD), (pins & (Z80_MREQ|Z80_WR)) == (Z80_MREQ|Z80_WR))) {
+                sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            }
         }
     }
     sys->pins = pins;
-    kbd_update(&sys->kbd, micro_seconds);
+    kbd_update(&sys->kbd, clk_ticks_to_us(_Z9001_FREQUENCY, num_ticks));
     _z9001_decode_vidmem(sys);
     return num_ticks;
 }
 
+uint32_t z9001_exec(z9001_t* sys, uint32_t micro_seconds) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return z9001_exec_ticks(sys, clk_us_to_ticks_frac(_Z9001_FREQUENCY, micro_seconds, &sys->tick_frac));
+}
+
 void z9001_key_down(z9001_t* sys, int key_code) {
     CHIPS_ASSERT(sys && sys->valid);
     kbd_key_down(&sys->kbd, key_code);
@@ -579,6 +615,7 @@ void z9001_key_up(z9001_t* sys, int key_code) {
 
 // common start function for file loading routines
 static void _z9001_load_start(z9001_t* sys, uint16_t exec_addr) {
+    z80_sync_flags(&sys->cpu);
     sys->cpu.a = 0x00; sys->cpu.f = 0x10;
     sys->cpu.bc = sys->cpu.bc2 = 0x0000;
     sys->cpu.de = sys->cpu.de2 = 0x0000;
@@ -753,7 +790,8 @@ chips_display_info_t z9001_display_info(z9001_t* sys) {
         .palette = {
             .ptr = (void*)palette,
             .size = sizeof(palette)
-        }
+        },
+        .dirty_lines = sys ? &sys->dirty_lines : 0,
     };
     CHIPS_ASSERT(((sys == 0) && (res.frame.buffer.ptr == 0)) || ((sys != 0) && (res.frame.buffer.ptr != 0)));
     return res;
@@ -761,7 +799,7 @@ chips_display_info_t z9001_display_info(z9001_t* sys) {
 
 uint32_t z9001_save_snapshot(z9001_t* sys, z9001_t* dst) {
     CHIPS_ASSERT(sys && dst);
-    *dst = *sys;
+    memcpy(dst, sys, Z9001_SNAPSHOT_SIZE);
     chips_debug_snapshot_onsave(&dst->debug);
     chips_audio_callback_snapshot_onsave(&dst->audio.callback);
     mem_snapshot_onsave(&dst->mem, sys);
@@ -774,11 +812,11 @@ bool z9001_load_snapshot(z9001_t* sys, uint32_t version, const z9001_t* src) {
         return false;
     }
     static z9001_t im;
-    im = *src;
+    memcpy(&im, src, Z9001_SNAPSHOT_SIZE);
     chips_debug_snapshot_onload(&im.debug, &sys->debug);
     chips_audio_callback_snapshot_onload(&im.audio.callback, &sys->audio.callback);
     mem_snapshot_onload(&im.mem, sys);
-    *sys = im;
+    memcpy(sys, &im, Z9001_SNAPSHOT_SIZE);
     return true;
 }
 
@@ -18,10 +18,32 @@
     ~~~
         your own assert macro (default: assert(c))
 
+    ~~~C
+    ZX_BORROWED_ROMS
+    ~~~
+        if defined, zx_init() doesn't copy the ROM images into zx_t but
+        keeps pointers to the ROM data in zx_desc_t.roms, the ROM data
+        must then remain valid and unchanged until zx_discard() is called
+        (this allows many instances to share one copy of the ROMs), ROMs are
+        also not part of snapshots, snapshots must be loaded into an instance
+        which was initialized with the same ROM images, must be the same for
+        all files which include zx.h
+
+    ~~~C
+    CHIPS_ZX_TYPE_48K
+    CHIPS_ZX_TYPE_128
+    ~~~
+        optionally define one of those to build an emulator for a single
+        machine model, model checks are then resolved at compile time and
+        zx_desc_t.type is ignored (by default the model is selected at
+        runtime with zx_desc_t.type), must be the same for all files which
+        include zx.h
+
     You need to include the following headers before including zx.h:
 
     - chips/chips_common.h
     - chips/z80.h
+    - chips/blip.h (only with CHIPS_BLIP)
     - chips/beeper.h
     - chips/ay38910.h
     - chips/mem.h
@@ -36,8 +58,39 @@
 
     TODO!
 
+    ## Contended Memory
+
+    During the 192 display lines the ULA has priority over the CPU when
+    accessing the lower 16 KBytes of RAM (0x4000..0x7FFF, and on the ZX128
+    also the odd RAM banks when mapped to 0xC000). A CPU memory access
+    to such an address is delayed by up to 6 ticks, depending on the
+    position of the ULA in its 8-tick fetch cycle:
+
+    6, 5, 4, 3, 2, 1, 0, 0
+
+    IO requests are delayed the same way when the port address is in a
+    contended range or the port is decoded by the ULA (A0 is low).
+
+    The delays are looked up in a per-model table which covers one video
+    frame (one entry per tick), and the CPU is stalled for the looked up
+    number of ticks before the memory or IO request is performed. Only
+    the machine cycles which put MREQ or IORQ on the bus are contended,
+    internal CPU cycles which only put an address on the bus (e.g. the
+    extra cycles of INC (HL)) are not.
+
+    ## Delta Snapshots
+
+    zx_save_snapshot_delta() encodes the difference between the current
+    state and the most recent snapshot saved from the same instance with
+    zx_save_snapshot() (see 'Delta Snapshots' in chips_common.h). The
+    caller-provided scratch snapshot receives all state except the RAM,
+    the RAM is only compared against the base snapshot in pages which have
+    been written since the base snapshot was saved. When compiled with
+    MEM_TRACK_ACCESS (see 'Access Tracking' in mem.h) the written pages
+    are taken from the CPU mem_t (which means the written bits are consumed
+    by the ZX emulation), otherwise all RAM pages are compared.
+
     ## TODO:
-    - 'contended memory' timing and IO port timing
     - reads from port 0xFF must return 'current VRAM bytes
     - video decoding only has scanline accuracy, not pixel accuracy
 
@@ -69,7 +122,7 @@ extern "C" {
 #endif
 
 // bump this whenever the zx_t struct layout changes
-#define ZX_SNAPSHOT_VERSION (0x0001)
+#define ZX_SNAPSHOT_VERSION (0x000B)
 
 #define ZX_MAX_AUDIO_SAMPLES (1024)      // max number of audio samples in internal sample buffer
 #define ZX_DEFAULT_AUDIO_SAMPLES (128)   // default number of samples in internal sample buffer
@@ -107,6 +160,7 @@ typedef struct {
     chips_debug_t debug;                // optional debugger hook
     struct {
         chips_audio_callback_t callback;
+        chips_audio_ring_t* ring;   // optional ring buffer, if set, the callback isn't called
         int num_samples;
         int sample_rate;
         float beeper_volume;
@@ -122,17 +176,29 @@ typedef struct {
     } roms;
 } zx_desc_t;
 
+// per-frame statistics counters (only updated when CHIPS_STATS is defined)
+typedef struct {
+    uint32_t ticks;             // number of ticks executed in the last zx_exec() call
+    uint32_t mem_accesses;      // memory read and write accesses
+    uint32_t io_requests;       // IO requests (including interrupt acknowledge)
+    uint32_t decoded_scanlines; // scanlines decoded into the framebuffer
+    uint32_t contended_ticks;   // CPU ticks stalled by memory and IO contention
+} zx_stats_t;
+
 // ZX emulator state
 typedef struct {
     z80_t cpu;
     beeper_t beeper;
     ay38910_t ay;
+    uint32_t ay_ticks;          // AY ticks which haven't been executed yet (see _zx_ay_sync())
     zx_type_t type;
     zx_joystick_type_t joystick_type;
     bool memory_paging_disabled;
+    bool video_disabled;        // skip decoding video memory into the framebuffer
     uint8_t kbd_joymask;        // joystick mask from keyboard joystick emulation
     uint8_t joy_joymask;        // joystick mask from zx_joystick()
     uint32_t tick_count;
+    uint32_t tick_frac;         // fractional tick carried over between zx_exec() calls (see clk_us_to_ticks_frac())
     uint8_t last_mem_config;    // last out to 0x7FFD
     uint8_t last_fe_out;        // last out value to 0xFE port
     uint8_t blink_counter;      // incremented on each vblank
@@ -143,25 +209,43 @@ typedef struct {
     int scanline_counter;
     int scanline_y;
     int int_counter;
+    uint32_t contention_ticks;  // remaining ticks the CPU is stalled by memory or IO contention
     uint32_t display_ram_bank;
-    kbd_t kbd;
-    mem_t mem;
     uint64_t pins;
     uint64_t freq_hz;
     bool valid;
     chips_debug_t debug;
+    zx_stats_t stats;
+    // keyboard and memory mapping last, their bulk tables follow the per-tick state (see ZX_HOT_SIZE)
+    kbd_t kbd;
+    mem_t mem;
+    uint8_t ram[8][0x4000];
+    #if defined(ZX_BORROWED_ROMS)
+    const uint8_t* rom[2];      // borrowed ROM images, not part of snapshots
+    #else
+    uint8_t rom[2][0x4000];
+    #endif
+    uint8_t junk[0x4000];
+
+    // output-only state starting at audio.sample_buffer is not part of snapshots
     struct {
         chips_audio_callback_t callback;
         int num_samples;
         int sample_pos;
         float sample_buffer[ZX_MAX_AUDIO_SAMPLES];
+        chips_audio_ring_t* ring;
     } audio;
-    uint8_t ram[8][0x4000];
-    uint8_t rom[2][0x4000];
-    uint8_t junk[0x4000];
     alignas(64) uint8_t fb[ZX_FRAMEBUFFER_SIZE_BYTES];
+    chips_dirty_lines_t dirty_lines;    // framebuffer lines changed in the last zx_exec() call
+    // RAM pages written since the last saved snapshot (see "Delta Snapshots")
+    uint64_t snapshot_written_pages[((0x20000 >> MEM_PAGE_SHIFT) + 63) / 64];
 } zx_t;
 
+// size of the part of zx_t which is stored in snapshots (the audio sample buffer and framebuffer are excluded)
+#define ZX_SNAPSHOT_SIZE (offsetof(zx_t, audio.sample_buffer))
+// size of the state at the start of zx_t which is accessed on every tick, not counting the RAM
+#define ZX_HOT_SIZE (offsetof(zx_t, mem.layers))
+
 // initialize a new ZX Spectrum instance
 void zx_init(zx_t* sys, const zx_desc_t* desc);
 // discard a ZX Spectrum instance
@@ -172,6 +256,10 @@ void zx_reset(zx_t* sys);
 chips_display_info_t zx_display_info(zx_t* sys);
 // run ZX Spectrum instance for a given number of microseconds, return number of ticks
 uint32_t zx_exec(zx_t* sys, uint32_t micro_seconds);
+// run ZX Spectrum instance for a given number of ticks, return number of ticks
+uint32_t zx_exec_ticks(zx_t* sys, uint32_t num_ticks);
+// run ZX Spectrum instance until the next vblank interrupt, return number of ticks
+uint32_t zx_exec_frame(zx_t* sys);
 // send a key-down event
 void zx_key_down(zx_t* sys, int key_code);
 // send a key-up event
@@ -184,10 +272,24 @@ zx_joystick_type_t zx_joystick_type(zx_t* sys);
 void zx_joystick(zx_t* sys, uint8_t mask);
 // load a ZX Z80 file into the emulator
 bool zx_quickload(zx_t* sys, chips_range_t data);
+// enable/disable video decoding (e.g. for fast-forwarding or headless operation)
+void zx_enable_video(zx_t* sys, bool enabled);
+// return true if video decoding is enabled
+bool zx_video_enabled(zx_t* sys);
+// get statistics counters of the last zx_exec() call (needs CHIPS_STATS)
+zx_stats_t zx_stats(zx_t* sys);
 // save a snapshot, patches any pointers to zero, returns a snapshot version
 uint32_t zx_save_snapshot(zx_t* sys, zx_t* dst);
 // load a snapshot, returns false if snapshot version doesn't match
 bool zx_load_snapshot(zx_t* sys, uint32_t version, zx_t* src);
+// save a delta snapshot relative to the last snapshot saved from sys, scratch is caller-provided temp storage, returns number of bytes written to dst, or 0 if dst is too small
+size_t zx_save_snapshot_delta(zx_t* sys, const zx_t* base, zx_t* scratch, chips_range_t dst);
+// apply a delta snapshot to a copy of its base snapshot, the result can be loaded with zx_load_snapshot()
+bool zx_apply_snapshot_delta(zx_t* inout_snapshot, chips_range_t delta);
+// save the system state into a pointer-free byte stream, returns number of bytes written to dst, or 0 if dst is too small
+size_t zx_save_stream(zx_t* sys, chips_range_t dst);
+// load the system state from a byte stream, returns false if the stream doesn't match the system type or version
+bool zx_load_stream(zx_t* sys, chips_range_t src);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -206,30 +308,78 @@ static void _zx_init_keyboard_matrix(zx_t* sys);
 
 #define _ZX_DEFAULT(val,def) (((val) != 0) ? (val) : (def))
 
+// the compile-time model if CHIPS_ZX_TYPE_48K or CHIPS_ZX_TYPE_128 is defined, otherwise the runtime model
+#if defined(CHIPS_ZX_TYPE_48K) && defined(CHIPS_ZX_TYPE_128)
+#error "Please define only one of CHIPS_ZX_TYPE_48K or CHIPS_ZX_TYPE_128!"
+#elif defined(CHIPS_ZX_TYPE_48K)
+#define _ZX_TYPE(obj) ((void)(obj), ZX_TYPE_48K)
+#elif defined(CHIPS_ZX_TYPE_128)
+#define _ZX_TYPE(obj) ((void)(obj), ZX_TYPE_128)
+#else
+#define _ZX_TYPE(obj) ((obj)->type)
+#endif
+
 #define _ZX_48K_FREQUENCY (3500000)
 #define _ZX_128_FREQUENCY (3546894)
 
+/* the contention tables cover one frame of the longer ZX128 scanlines, plus
+   some slack for the ticks looked up ahead by _zx_io_contention()
+*/
+#define _ZX_CONTENTION_TABLE_SIZE (312 * 228 + 16)
+
+// per-tick contention delays for the ZX48K and ZX128, shared by all instances
+static uint8_t _zx_contention_table[2][_ZX_CONTENTION_TABLE_SIZE];
+static bool _zx_contention_table_valid;
+
+static void _zx_init_contention_tables(void) {
+    if (_zx_contention_table_valid) {
+        return;
+    }
+    _zx_contention_table_valid = true;
+    static const uint8_t pattern[8] = { 6, 5, 4, 3, 2, 1, 0, 0 };
+    // frame tick of the first contended tick, and scanline period
+    static const int first_tick[2] = { 14335, 14361 };
+    static const int period[2] = { 224, 228 };
+    for (int type = 0; type < 2; type++) {
+        uint8_t* tab = _zx_contention_table[type];
+        memset(tab, 0, _ZX_CONTENTION_TABLE_SIZE);
+        for (int line = 0; line < 192; line++) {
+            uint8_t* dst = &tab[first_tick[type] + line * period[type]];
+            for (int x = 0; x < 128; x++) {
+                dst[x] = pattern[x & 7];
+            }
+        }
+    }
+}
+
 void zx_init(zx_t* sys, const zx_desc_t* desc) {
     CHIPS_ASSERT(sys && desc);
     if (desc->debug.callback.func) { CHIPS_ASSERT(desc->debug.stopped); }
 
     memset(sys, 0, sizeof(zx_t));
     sys->valid = true;
-    sys->type = desc->type;
+    sys->type = _ZX_TYPE(desc);
     sys->joystick_type = desc->joystick_type;
-    sys->freq_hz = (sys->type == ZX_TYPE_48K) ? _ZX_48K_FREQUENCY : _ZX_128_FREQUENCY;
+    sys->freq_hz = (_ZX_TYPE(sys) == ZX_TYPE_48K) ? _ZX_48K_FREQUENCY : _ZX_128_FREQUENCY;
     sys->audio.callback = desc->audio.callback;
+    sys->audio.ring = desc->audio.ring;
     sys->audio.num_samples = _ZX_DEFAULT(desc->audio.num_samples, ZX_DEFAULT_AUDIO_SAMPLES);
     CHIPS_ASSERT(sys->audio.num_samples <= ZX_MAX_AUDIO_SAMPLES);
     sys->debug = desc->debug;
+    _zx_init_contention_tables();
 
     // initalize the hardware
     sys->border_color = 0;
-    if (ZX_TYPE_128 == sys->type) {
+    if (ZX_TYPE_128 == _ZX_TYPE(sys)) {
         CHIPS_ASSERT(desc->roms.zx128_0.ptr && (desc->roms.zx128_0.size == 0x4000));
         CHIPS_ASSERT(desc->roms.zx128_1.ptr && (desc->roms.zx128_1.size == 0x4000));
-        memcpy(sys->rom[0], desc->roms.zx128_0.ptr, 0x4000);
-        memcpy(sys->rom[1], desc->roms.zx128_1.ptr, 0x4000);
+        #if defined(ZX_BORROWED_ROMS)
+            sys->rom[0] = (const uint8_t*) desc->roms.zx128_0.ptr;
+            sys->rom[1] = (const uint8_t*) desc->roms.zx128_1.ptr;
+        #else
+            memcpy(sys->rom[0], desc->roms.zx128_0.ptr, 0x4000);
+            memcpy(sys->rom[1], desc->roms.zx128_1.ptr, 0x4000);
+        #endif
         sys->display_ram_bank = 5;
         sys->frame_scan_lines = 311;
         sys->top_border_scanlines = 63;
@@ -237,7 +387,11 @@ void zx_init(zx_t* sys, const zx_desc_t* desc) {
     }
     else {
         CHIPS_ASSERT(desc->roms.zx48k.ptr && (desc->roms.zx48k.size == 0x4000));
-        memcpy(sys->rom[0], desc->roms.zx48k.ptr, 0x4000);
+        #if defined(ZX_BORROWED_ROMS)
+            sys->rom[0] = (const uint8_t*) desc->roms.zx48k.ptr;
+        #else
+            memcpy(sys->rom[0], desc->roms.zx48k.ptr, 0x4000);
+        #endif
         sys->display_ram_bank = 0;
         sys->frame_scan_lines = 312;
         sys->top_border_scanlines = 64;
@@ -253,7 +407,7 @@ void zx_init(zx_t* sys, const zx_desc_t* desc) {
         .sound_hz = audio_hz,
         .base_volume = _ZX_DEFAULT(desc->audio.beeper_volume, 0.25f),
     });
-    if (ZX_TYPE_128 == sys->type) {
+    if (ZX_TYPE_128 == _ZX_TYPE(sys)) {
         ay38910_init(&sys->ay, &(ay38910_desc_t){
             .type = AY38910_TYPE_8912,
             .tick_hz = (int)sys->freq_hz / 2,
@@ -263,6 +417,8 @@ void zx_init(zx_t* sys, const zx_desc_t* desc) {
     }
     _zx_init_memory_map(sys);
     _zx_init_keyboard_matrix(sys);
+    // there's no base snapshot yet
+    memset(sys->snapshot_written_pages, 0xFF, sizeof(sys->snapshot_written_pages));
 }
 
 void zx_discard(zx_t* sys) {
@@ -274,17 +430,19 @@ void zx_reset(zx_t* sys) {
     CHIPS_ASSERT(sys && sys->valid);
     sys->pins = z80_reset(&sys->cpu);
     beeper_reset(&sys->beeper);
-    if (sys->type == ZX_TYPE_128) {
+    if (_ZX_TYPE(sys) == ZX_TYPE_128) {
         ay38910_reset(&sys->ay);
     }
+    sys->ay_ticks = 0;
     sys->memory_paging_disabled = false;
     sys->kbd_joymask = 0;
     sys->joy_joymask = 0;
     sys->last_fe_out = 0;
     sys->scanline_counter = sys->scanline_period;
     sys->scanline_y = 0;
+    sys->contention_ticks = 0;
     sys->blink_counter = 0;
-    if (sys->type == ZX_TYPE_48K) {
+    if (_ZX_TYPE(sys) == ZX_TYPE_48K) {
         sys->display_ram_bank = 0;
     }
     else {
@@ -314,14 +472,18 @@ static bool _zx_decode_scanline(zx_t* sys) {
     */
     const int top_decode_line = sys->top_border_scanlines - 32;
     const int btm_decode_line = sys->top_border_scanlines + 192 + 32;
-    if ((sys->scanline_y >= top_decode_line) && (sys->scanline_y < btm_decode_line)) {
+    if (!sys->video_disabled && (sys->scanline_y >= top_decode_line) && (sys->scanline_y < btm_decode_line)) {
+        CHIPS_STATS_INC(sys->stats.decoded_scanlines);
         const uint16_t y = sys->scanline_y - top_decode_line;
         uint8_t* dst = &sys->fb[y * ZX_FRAMEBUFFER_WIDTH];
         const uint8_t* vidmem_bank = sys->ram[sys->display_ram_bank];
         const bool blink = 0 != (sys->blink_counter & 0x10);
+        // accumulates the difference between the new and old pixels for dirty line tracking
+        uint8_t diff = 0;
         if ((y < 32) || (y >= 224)) {
             // upper/lower border
             for (int x = 0; x < ZX_DISPLAY_WIDTH; x++) {
+                diff |= *dst ^ sys->border_color;
                 *dst++ = sys->border_color;
             }
         }
@@ -336,6 +498,7 @@ static bool _zx_decode_scanline(zx_t* sys) {
 
             // left border
             for (int x = 0; x < (4*8); x++) {
+                diff |= *dst ^ sys->border_color;
                 *dst++ = sys->border_color;
             }
 
@@ -363,15 +526,21 @@ static bool _zx_decode_scanline(zx_t* sys) {
                 bg |= (clr & (1<<6)) >> 3;
 
                 for (int px = 7; px >=0; px--) {
-                    *dst++ = pix & (1<<px) ? fg : bg;
+                    const uint8_t c = pix & (1<<px) ? fg : bg;
+                    diff |= *dst ^ c;
+                    *dst++ = c;
                 }
             }
 
             // right border
             for (int x = 0; x < (4*8); x++) {
+                diff |= *dst ^ sys->border_color;
                 *dst++ = sys->border_color;
             }
         }
+        if (diff) {
+            chips_dirty_lines_set(&sys->dirty_lines, y);
+        }
     }
 
     if (sys->scanline_y++ >= sys->frame_scan_lines) {
@@ -385,9 +554,20 @@ static bool _zx_decode_scanline(zx_t* sys) {
     }
 }
 
+// take over the RAM pages written since the last call from the CPU mem_t,
+// this must happen before the mapping of written pages changes
+static void _zx_snapshot_collect_writes(zx_t* sys) {
+    #if defined(MEM_TRACK_ACCESS)
+        mem_track_collect_writes(&sys->mem, &sys->ram[0][0], sizeof(sys->ram), sys->snapshot_written_pages);
+    #else
+        memset(sys->snapshot_written_pages, 0xFF, sizeof(sys->snapshot_written_pages));
+    #endif
+}
+
 // ZX128 memory mapping
 static void _zx_update_memory_map_zx128(zx_t* sys, uint8_t data) {
     if (!sys->memory_paging_disabled) {
+        _zx_snapshot_collect_writes(sys);
         sys->last_mem_config = data;
         // bit 3 defines the video scanout memory bank (5 or 7)
         sys->display_ram_bank = (data & (1<<3)) ? 7 : 5;
@@ -413,8 +593,91 @@ static void _zx_update_memory_map_zx128(zx_t* sys, uint8_t data) {
     }
 }
 
+/* catch up with the AY ticks which have been accumulated since the last
+   call, this must happen before each AY register access, before the AY
+   sample is mixed into the beeper output and at the end of zx_exec()
+*/
+static void _zx_ay_sync(zx_t* sys) {
+    while (sys->ay_ticks > 0) {
+        // only the last generated sample is needed, sys->ay.sample is mixed with the beeper sample
+        float samples[8];
+        int num_samples = 0;
+        sys->ay_ticks -= ay38910_run(&sys->ay, sys->ay_ticks, samples, 8, &num_samples);
+    }
+}
+
+// return true if a memory or IO address is in a contended memory range
+static inline bool _zx_contended(zx_t* sys, uint16_t addr) {
+    if ((addr & 0xC000) == 0x4000) {
+        return true;
+    }
+    else {
+        // on the ZX128, the odd RAM banks are contended when mapped to 0xC000
+        return (_ZX_TYPE(sys) == ZX_TYPE_128) && (addr >= 0xC000) && (sys->last_mem_config & 1);
+    }
+}
+
+// current position in the video frame, in ticks
+static inline uint32_t _zx_frame_tick(zx_t* sys) {
+    return (uint32_t)(sys->scanline_y * sys->scanline_period + (sys->scanline_period - sys->scanline_counter));
+}
+
+/* the IO contention pattern depends on whether the high byte of the port
+   address is in a contended range and whether the ULA decodes the port:
+
+   high byte contended, A0 low:     C:1, C:3
+   high byte contended, A0 high:    C:1, C:1, C:1, C:1
+   high byte uncontended, A0 low:   N:1, C:3
+   high byte uncontended, A0 high:  N:4
+
+   (C:n applies the contention delay of the current tick and then advances
+   by n ticks, N:n advances by n ticks without contention)
+*/
+static uint32_t _zx_io_contention(zx_t* sys, const uint8_t* tab, uint32_t tick, uint16_t port) {
+    const bool ula = 0 == (port & 1);
+    uint32_t delay = 0;
+    if (_zx_contended(sys, port)) {
+        const int num = ula ? 2 : 4;
+        for (int i = 0; i < num; i++) {
+            delay += tab[tick + delay];
+            tick++;
+        }
+    }
+    else if (ula) {
+        delay = tab[tick + 1];
+    }
+    return delay;
+}
+
+// return the number of ticks a memory or IO request is delayed by the ULA
+static inline uint32_t _zx_contention(zx_t* sys, uint64_t pins) {
+    const uint8_t* tab = _zx_contention_table[_ZX_TYPE(sys) == ZX_TYPE_128];
+    const uint16_t addr = Z80_GET_ADDR(pins);
+    if ((pins & (Z80_MREQ|Z80_RFSH)) == Z80_MREQ) {
+        // memory refresh cycles are not contended
+        return _zx_contended(sys, addr) ? tab[_zx_frame_tick(sys)] : 0;
+    }
+    else if ((pins & (Z80_IORQ|Z80_M1)) == Z80_IORQ) {
+        // interrupt acknowledge cycles are not contended
+        return _zx_io_contention(sys, tab, _zx_frame_tick(sys), addr);
+    }
+    else {
+        return 0;
+    }
+}
+
 static uint64_t _zx_tick(zx_t* sys, uint64_t pins) {
-    pins = z80_tick(&sys->cpu, pins);
+    if (0 == sys->contention_ticks) {
+        pins = z80_tick(&sys->cpu, pins);
+        if (pins & (Z80_MREQ|Z80_IORQ)) {
+            sys->contention_ticks = _zx_contention(sys, pins);
+        }
+    }
+    else {
+        // the CPU is stalled, the pending memory or IO request is performed in the last stalled tick
+        CHIPS_STATS_INC(sys->stats.contended_ticks);
+        sys->contention_ticks--;
+    }
 
     // video decoding and vblank interrupt
     if (--sys->scanline_counter <= 0) {
@@ -435,9 +698,10 @@ static uint64_t _zx_tick(zx_t* sys, uint64_t pins) {
         }
     }
 
-    if (pins & Z80_MREQ) {
+    // memory and IO requests are performed when the contention delay is over
+    if ((pins & Z80_MREQ) && (0 == sys->contention_ticks)) {
         // a memory request
-        // FIXME: 'contended memory'
+        CHIPS_STATS_INC(sys->stats.mem_accesses);
         const uint16_t addr = Z80_GET_ADDR(pins);
         if (pins & Z80_RD) {
             Z80_SET_DATA(pins, mem_rd(&sys->mem, addr));
@@ -446,7 +710,8 @@ static uint64_t _zx_tick(zx_t* sys, uint64_t pins) {
             mem_wr(&sys->mem, addr, Z80_GET_DATA(pins));
         }
     }
-    else if (pins & Z80_IORQ) {
+    else if ((pins & Z80_IORQ) && (0 == sys->contention_ticks)) {
+        CHIPS_STATS_INC(sys->stats.io_requests);
         if ((pins & Z80_A0) == 0) {
             /* Spectrum ULA (...............0)
                 Bits 5 and 7 as read by INning from Port 0xfe are always one
@@ -473,16 +738,17 @@ static uint64_t _zx_tick(zx_t* sys, uint64_t pins) {
                 beeper_set(&sys->beeper, 0 != (data & (1<<4)));
             }
         }
-        else if (((pins & (Z80_WR|Z80_A15|Z80_A1)) == Z80_WR) && (sys->type == ZX_TYPE_128)) {
+        else if (((pins & (Z80_WR|Z80_A15|Z80_A1)) == Z80_WR) && (_ZX_TYPE(sys) == ZX_TYPE_128)) {
             /* Spectrum 128 memory control (0.............0.)
                 http://8bit.yarek.pl/computer/zx.128/
             */
             _zx_update_memory_map_zx128(sys, Z80_GET_DATA(pins));
         }
-        else if (((pins & (Z80_A15|Z80_A1)) == Z80_A15) && (sys->type == ZX_TYPE_128)) {
+        else if (((pins & (Z80_A15|Z80_A1)) == Z80_A15) && (_ZX_TYPE(sys) == ZX_TYPE_128)) {
             // AY-3-8912 access (1*............0.)
             if (pins & Z80_A14) { pins |= AY38910_BC1; }
             if (pins & Z80_WR) { pins |= AY38910_BDIR; }
+            _zx_ay_sync(sys);
             pins = ay38910_iorq(&sys->ay, pins) & Z80_PIN_MASK;
         }
         else if ((pins & (Z80_RD|Z80_A7|Z80_A6|Z80_A5)) == Z80_RD) {
@@ -491,31 +757,40 @@ static uint64_t _zx_tick(zx_t* sys, uint64_t pins) {
         }
     }
 
-    // tick the AY at half frequency, use the buffered chip select
-    // pin mask so that the AY doesn't miss any IO requests
+    // tick the AY at half frequency, the AY is only ticked lazily (see _zx_ay_sync())
     if (++sys->tick_count & 1) {
-        ay38910_tick(&sys->ay);
+        sys->ay_ticks++;
     }
 
     // tick the beeper
     if (beeper_tick(&sys->beeper)) {
         // new sample ready (if this is not a ZX128, sys->ay.sample will be 0)
+        _zx_ay_sync(sys);
         const float sample = sys->beeper.sample + sys->ay.sample;
-        sys->audio.sample_buffer[sys->audio.sample_pos++] = sample;
-        if (sys->audio.sample_pos == sys->audio.num_samples) {
-            if (sys->audio.callback.func) {
-                sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
+        if (sys->audio.ring) {
+            chips_audio_ring_push(sys->audio.ring, sample);
+        }
+        else {
+            sys->audio.sample_buffer[sys->audio.sample_pos++] = sample;
+            if (sys->audio.sample_pos == sys->audio.num_samples) {
+                if (sys->audio.callback.func) {
+                    sys->audio.callback.func(sys->audio.sample_buffer, sys->audio.num_samples, sys->audio.callback.user_data);
+                }
+                sys->audio.sample_pos = 0;
             }
-            sys->audio.sample_pos = 0;
         }
     }
     return pins;
 }
 
-uint32_t zx_exec(zx_t* sys, uint32_t micro_seconds) {
+uint32_t zx_exec_ticks(zx_t* sys, uint32_t num_ticks) {
     CHIPS_ASSERT(sys && sys->valid);
-    const uint32_t num_ticks = clk_us_to_ticks(sys->freq_hz, micro_seconds);
     uint64_t pins = sys->pins;
+    #if defined(CHIPS_STATS)
+    memset(&sys->stats, 0, sizeof(sys->stats));
+    sys->stats.ticks = num_ticks;
+    #endif
+    chips_dirty_lines_clear(&sys->dirty_lines);
     if (0 == sys->debug.callback.func) {
         // run without debug hook
         for (uint32_t tick = 0; tick < num_ticks; tick++) {
@@ -524,16 +799,33 @@ uint32_t zx_exec(zx_t* sys, uint32_t micro_seconds) {
     }
     else {
         // run with debug hook
+        chips_debug_filter_t* filter = sys->debug.filter;
         for (uint32_t tick = 0; (tick < num_ticks) && !(*sys->debug.stopped); tick++) {
             pins = _zx_tick(sys, pins);
-            sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            if ((0 == filter) || chips_debug_filter_hit(filter, z80_opdone(&sys->cpu), Z80_GET_ADDR(pins),
+                    (pins & (Z80_MREQ|Z80_RD)) == (Z80_MREQ|Z80_RD), (pins & (Z80_MREQ|Z80_WR)) == (Z80_MREQ|Z80_WR))) {
+                sys->debug.callback.func(sys->debug.callback.user_data, pins);
+            }
         }
     }
+    _zx_ay_sync(sys);
     sys->pins = pins;
-    kbd_update(&sys->kbd, micro_seconds);
+    kbd_update(&sys->kbd, clk_ticks_to_us(sys->freq_hz, num_ticks));
     return num_ticks;
 }
 
+uint32_t zx_exec(zx_t* sys, uint32_t micro_seconds) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return zx_exec_ticks(sys, clk_us_to_ticks_frac(sys->freq_hz, micro_seconds, &sys->tick_frac));
+}
+
+uint32_t zx_exec_frame(zx_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    // the vblank interrupt is requested when the scanline counter of the last scanline runs out
+    const uint32_t num_ticks = (uint32_t)(sys->scanline_counter + (sys->frame_scan_lines - sys->scanline_y) * sys->scanline_period);
+    return zx_exec_ticks(sys, num_ticks);
+}
+
 void zx_key_down(zx_t* sys, int key_code) {
     CHIPS_ASSERT(sys && sys->valid);
     switch (sys->joystick_type) {
@@ -660,8 +952,9 @@ void zx_joystick(zx_t* sys, uint8_t mask) {
 }
 
 static void _zx_init_memory_map(zx_t* sys) {
+    _zx_snapshot_collect_writes(sys);
     mem_init(&sys->mem);
-    if (sys->type == ZX_TYPE_128) {
+    if (_ZX_TYPE(sys) == ZX_TYPE_128) {
         mem_map_ram(&sys->mem, 0, 0x4000, 0x4000, sys->ram[5]);
         mem_map_ram(&sys->mem, 0, 0x8000, 0x4000, sys->ram[2]);
         mem_map_ram(&sys->mem, 0, 0xC000, 0x4000, sys->ram[0]);
@@ -675,6 +968,17 @@ static void _zx_init_memory_map(zx_t* sys) {
     }
 }
 
+// rebuild the memory mapping from the last memory config
+static void _zx_restore_memory_map(zx_t* sys) {
+    _zx_init_memory_map(sys);
+    if (_ZX_TYPE(sys) == ZX_TYPE_128) {
+        const bool paging_disabled = sys->memory_paging_disabled;
+        sys->memory_paging_disabled = false;
+        _zx_update_memory_map_zx128(sys, sys->last_mem_config);
+        sys->memory_paging_disabled = paging_disabled;
+    }
+}
+
 static void _zx_init_keyboard_matrix(zx_t* sys) {
     // setup keyboard matrix
     kbd_init(&sys->kbd, 1);
@@ -794,8 +1098,25 @@ static bool _zx_overflow(const uint8_t* ptr, intptr_t num_bytes, const uint8_t*
     return (ptr + num_bytes) > end_ptr;
 }
 
+void zx_enable_video(zx_t* sys, bool enabled) {
+    CHIPS_ASSERT(sys && sys->valid);
+    sys->video_disabled = !enabled;
+}
+
+bool zx_video_enabled(zx_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return !sys->video_disabled;
+}
+
+zx_stats_t zx_stats(zx_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return sys->stats;
+}
+
 bool zx_quickload(zx_t* sys, chips_range_t data) {
     CHIPS_ASSERT(data.ptr && (data.size > 0));
+    // the RAM is written directly
+    memset(sys->snapshot_written_pages, 0xFF, sizeof(sys->snapshot_written_pages));
     uint8_t* ptr = data.ptr;
     const uint8_t* end_ptr = ptr + data.size;
     if (_zx_overflow(ptr, sizeof(_zx_z80_header), end_ptr)) {
@@ -814,18 +1135,18 @@ bool zx_quickload(zx_t* sys, chips_range_t data) {
         int ext_hdr_len = (ext_hdr->len_h<<8)|ext_hdr->len_l;
         ptr += 2 + ext_hdr_len;
         if (ext_hdr->hw_mode < 3) {
-            if (sys->type != ZX_TYPE_48K) {
+            if (_ZX_TYPE(sys) != ZX_TYPE_48K) {
                 return false;
             }
         }
         else {
-            if (sys->type != ZX_TYPE_128) {
+            if (_ZX_TYPE(sys) != ZX_TYPE_128) {
                 return false;
             }
         }
     }
     else {
-        if (sys->type != ZX_TYPE_48K) {
+        if (_ZX_TYPE(sys) != ZX_TYPE_48K) {
             return false;
         }
     }
@@ -844,7 +1165,7 @@ bool zx_quickload(zx_t* sys, chips_range_t data) {
             ptr += sizeof(_zx_z80_page_header);
             src_len = (phdr->len_h<<8 | phdr->len_l) & 0xFFFF;
             page_index = phdr->page_nr - 3;
-            if ((sys->type == ZX_TYPE_48K) && (page_index == 5)) {
+            if ((_ZX_TYPE(sys) == ZX_TYPE_48K) && (page_index == 5)) {
                 page_index = 0;
             }
             if ((page_index < 0) || (page_index > 7)) {
@@ -934,7 +1255,7 @@ bool zx_quickload(zx_t* sys, chips_range_t data) {
     }
     if (ext_hdr) {
         sys->pins = z80_prefetch(&sys->cpu, (ext_hdr->PC_h<<8)|ext_hdr->PC_l);
-        if (sys->type == ZX_TYPE_128) {
+        if (_ZX_TYPE(sys) == ZX_TYPE_128) {
             ay38910_reset(&sys->ay);
             for (uint8_t i = 0; i < AY38910_NUM_REGISTERS; i++) {
                 ay38910_set_register(&sys->ay, i, ext_hdr->audio[i]);
@@ -990,19 +1311,34 @@ chips_display_info_t zx_display_info(zx_t* sys) {
         .palette = {
             .ptr = (void*)palette,
             .size = sizeof(palette),
-        }
+        },
+        .dirty_lines = sys ? &sys->dirty_lines : 0,
     };
     CHIPS_ASSERT(((sys == 0) && (res.frame.buffer.ptr == 0)) || ((sys != 0) && (res.frame.buffer.ptr != 0)));
     return res;
 }
 
-uint32_t zx_save_snapshot(zx_t* sys, zx_t* dst) {
-    CHIPS_ASSERT(sys && dst);
-    *dst = *sys;
+// patch the pointers in a snapshot copy of sys
+static void _zx_snapshot_onsave(zx_t* sys, zx_t* dst) {
     chips_debug_snapshot_onsave(&dst->debug);
     chips_audio_callback_snapshot_onsave(&dst->audio.callback);
     ay38910_snapshot_onsave(&dst->ay);
+    #if defined(ZX_BORROWED_ROMS)
+        // ROM pages point outside of zx_t, the mapping is rebuilt in zx_load_snapshot()
+        mem_unmap_all(&dst->mem);
+        dst->rom[0] = 0;
+        dst->rom[1] = 0;
+    #endif
     mem_snapshot_onsave(&dst->mem, sys);
+}
+
+uint32_t zx_save_snapshot(zx_t* sys, zx_t* dst) {
+    CHIPS_ASSERT(sys && dst);
+    memcpy(dst, sys, ZX_SNAPSHOT_SIZE);
+    _zx_snapshot_onsave(sys, dst);
+    // start tracking written RAM pages relative to the new base snapshot
+    _zx_snapshot_collect_writes(sys);
+    memset(sys->snapshot_written_pages, 0, sizeof(sys->snapshot_written_pages));
     return ZX_SNAPSHOT_VERSION;
 }
 
@@ -1011,13 +1347,119 @@ bool zx_load_snapshot(zx_t* sys, uint32_t version, zx_t* src) {
     if (version != ZX_SNAPSHOT_VERSION) {
         return false;
     }
+    if (src->type != _ZX_TYPE(src)) {
+        // a snapshot of a different model than the compile-time model
+        return false;
+    }
     static zx_t im;
-    im = *src;
+    memcpy(&im, src, ZX_SNAPSHOT_SIZE);
     chips_debug_snapshot_onload(&im.debug, &sys->debug);
     chips_audio_callback_snapshot_onload(&im.audio.callback, &sys->audio.callback);
     ay38910_snapshot_onload(&im.ay, &sys->ay);
     mem_snapshot_onload(&im.mem, sys);
-    *sys = im;
+    #if defined(ZX_BORROWED_ROMS)
+        // the borrowed ROM images are taken from the target system
+        im.rom[0] = sys->rom[0];
+        im.rom[1] = sys->rom[1];
+    #endif
+    memcpy(sys, &im, ZX_SNAPSHOT_SIZE);
+    #if defined(ZX_BORROWED_ROMS)
+        _zx_restore_memory_map(sys);
+    #endif
+    // the whole RAM has changed
+    memset(sys->snapshot_written_pages, 0xFF, sizeof(sys->snapshot_written_pages));
+    return true;
+}
+
+size_t zx_save_snapshot_delta(zx_t* sys, const zx_t* base, zx_t* scratch, chips_range_t dst) {
+    CHIPS_ASSERT(sys && base && scratch && dst.ptr);
+    _zx_snapshot_collect_writes(sys);
+    // the RAM isn't copied into the scratch snapshot, but taken directly from the written pages
+    const size_t ram_start = offsetof(zx_t, ram);
+    const size_t ram_end = ram_start + sizeof(sys->ram);
+    memcpy(scratch, sys, ram_start);
+    memcpy((uint8_t*)scratch + ram_end, (uint8_t*)sys + ram_end, ZX_SNAPSHOT_SIZE - ram_end);
+    _zx_snapshot_onsave(sys, scratch);
+    return chips_delta_encode_ram(
+        (chips_range_t){ .ptr = (void*)base, .size = ZX_SNAPSHOT_SIZE },
+        (chips_range_t){ .ptr = scratch, .size = ZX_SNAPSHOT_SIZE },
+        ram_start,
+        (chips_range_t){ .ptr = &sys->ram[0][0], .size = sizeof(sys->ram) },
+        MEM_PAGE_SIZE,
+        sys->snapshot_written_pages,
+        dst);
+}
+
+bool zx_apply_snapshot_delta(zx_t* inout_snapshot, chips_range_t delta) {
+    CHIPS_ASSERT(inout_snapshot && delta.ptr);
+    return chips_delta_apply(delta, (chips_range_t){ .ptr = inout_snapshot, .size = ZX_SNAPSHOT_SIZE });
+}
+
+static void _zx_serialize(zx_t* sys, chips_stream_t* s) {
+    if (!chips_stream_begin(s, CHIPS_FOURCC('Z','X',' ',' '), ZX_SNAPSHOT_VERSION)) {
+        return;
+    }
+    int type = (int)sys->type;
+    int joystick_type = (int)sys->joystick_type;
+    chips_stream_int(s, &type);
+    chips_stream_int(s, &joystick_type);
+    if ((zx_type_t)type != sys->type) {
+        // can't load a ZX128 stream into a ZX48K and vice versa
+        s->failed = true;
+        return;
+    }
+    sys->joystick_type = (zx_joystick_type_t)joystick_type;
+    z80_serialize(&sys->cpu, s);
+    beeper_serialize(&sys->beeper, s);
+    if (_ZX_TYPE(sys) == ZX_TYPE_128) {
+        ay38910_serialize(&sys->ay, s);
+    }
+    kbd_serialize(&sys->kbd, s);
+    chips_stream_bool(s, &sys->memory_paging_disabled);
+    chips_stream_u8(s, &sys->kbd_joymask);
+    chips_stream_u8(s, &sys->joy_joymask);
+    chips_stream_u32(s, &sys->tick_count);
+    chips_stream_u32(s, &sys->tick_frac);
+    chips_stream_u8(s, &sys->last_mem_config);
+    chips_stream_u8(s, &sys->last_fe_out);
+    chips_stream_u8(s, &sys->blink_counter);
+    chips_stream_u8(s, &sys->border_color);
+    chips_stream_int(s, &sys->frame_scan_lines);
+    chips_stream_int(s, &sys->top_border_scanlines);
+    chips_stream_int(s, &sys->scanline_period);
+    chips_stream_int(s, &sys->scanline_counter);
+    chips_stream_int(s, &sys->scanline_y);
+    chips_stream_int(s, &sys->int_counter);
+    chips_stream_u32(s, &sys->contention_ticks);
+    chips_stream_u32(s, &sys->display_ram_bank);
+    chips_stream_u64(s, &sys->pins);
+    chips_stream_int(s, &sys->audio.sample_pos);
+    // the ZX48K only uses the first 3 RAM banks, ROMs are not part of the stream
+    const size_t num_ram_banks = (_ZX_TYPE(sys) == ZX_TYPE_128) ? 8 : 3;
+    chips_stream_bytes(s, sys->ram, num_ram_banks * 0x4000);
+}
+
+size_t zx_save_stream(zx_t* sys, chips_range_t dst) {
+    CHIPS_ASSERT(sys && sys->valid && dst.ptr);
+    chips_stream_t s = chips_stream_writer(dst);
+    _zx_serialize(sys, &s);
+    return s.failed ? 0 : s.pos;
+}
+
+bool zx_load_stream(zx_t* sys, chips_range_t src) {
+    CHIPS_ASSERT(sys && sys->valid && src.ptr);
+    // deserialize into a copy, so that sys remains unchanged if the stream is invalid
+    static zx_t im;
+    memcpy(&im, sys, ZX_SNAPSHOT_SIZE);
+    chips_stream_t s = chips_stream_reader(src);
+    _zx_serialize(&im, &s);
+    if (s.failed) {
+        return false;
+    }
+    memcpy(sys, &im, ZX_SNAPSHOT_SIZE);
+    // the memory mapping isn't part of the stream
+    _zx_restore_memory_map(sys);
+    memset(sys->snapshot_written_pages, 0xFF, sizeof(sys->snapshot_written_pages));
     return true;
 }
 
@@ -71,6 +71,7 @@ typedef struct {
     ui_atom_boot_cb boot_cb;
     ui_dbg_texture_callbacks_t dbg_texture;     // texture create/update/destroy callbacks
     ui_dbg_keys_desc_t dbg_keys;                // user-defined hotkeys for ui_dbg_t
+    ui_dbg_rewind_callbacks_t dbg_rewind;       // optional reverse stepping callbacks for ui_dbg_t
     ui_snapshot_desc_t snapshot;                // snapshot ui setup params
 } ui_atom_desc_t;
 
@@ -361,6 +362,7 @@ void ui_atom_init(ui_atom_t* ui, const ui_atom_desc_t* ui_desc) {
         desc.read_cb = _ui_atom_mem_read;
         desc.texture_cbs = ui_desc->dbg_texture;
         desc.keys = ui_desc->dbg_keys;
+        desc.rewind_cbs = ui_desc->dbg_rewind;
         desc.user_data = ui->atom;
         ui_dbg_init(&ui->dbg, &desc);
     }
@@ -526,6 +528,7 @@ chips_debug_t ui_atom_get_debug(ui_atom_t* ui) {
     res.callback.func = (chips_debug_func_t)ui_dbg_tick;
     res.callback.user_data = &ui->dbg;
     res.stopped = &ui->dbg.dbg.stopped;
+    res.filter = &ui->dbg.dbg.filter;
     return res;
 }
 
@@ -880,9 +880,11 @@ bombjack_debug_t ui_bombjack_get_debug(ui_bombjack_t* ui) {
     res.mainboard.callback.func = (chips_debug_func_t)ui_dbg_tick;
     res.mainboard.callback.user_data = &ui->main.dbg;
     res.mainboard.stopped = &ui->main.dbg.dbg.stopped;
+    res.mainboard.filter = &ui->main.dbg.dbg.filter;
     res.soundboard.callback.func = (chips_debug_func_t)ui_dbg_tick;
     res.soundboard.callback.user_data = &ui->sound.dbg;
     res.soundboard.stopped = &ui->sound.dbg.dbg.stopped;
+    res.soundboard.filter = &ui->sound.dbg.dbg.filter;
     return res;
 }
 
@@ -33,6 +33,7 @@
     - ui_m6569.h
     - ui_m6581.h
     - ui_audio.h
+    - ui_stats.h
     - ui_display.h
     - ui_dasm.h
     - ui_dbg.h
@@ -76,6 +77,7 @@ typedef struct {
     ui_dbg_texture_callbacks_t dbg_texture; // texture create/update/destroy callbacks
     ui_dbg_debug_callbacks_t dbg_debug;
     ui_dbg_keys_desc_t dbg_keys;        // user-defined hotkeys for ui_dbg_t
+    ui_dbg_rewind_callbacks_t dbg_rewind; // optional reverse stepping callbacks for ui_dbg_t
     ui_snapshot_desc_t snapshot;        // snapshot UI setup params
 } ui_c64_desc_t;
 
@@ -89,6 +91,7 @@ typedef struct {
     ui_m6581_t sid;
     ui_m6569_t vic;
     ui_audio_t audio;
+    ui_stats_t stats;
     ui_display_t display;
     ui_kbd_t kbd;
     ui_memmap_t memmap;
@@ -186,6 +189,7 @@ static void _ui_c64_draw_menu(ui_c64_t* ui) {
             ImGui::MenuItem("Stopwatch", 0, &ui->dbg.ui.stopwatch.open);
             ImGui::MenuItem("Execution History", 0, &ui->dbg.ui.history.open);
             ImGui::MenuItem("Memory Heatmap", 0, &ui->dbg.ui.heatmap.open);
+            ImGui::MenuItem("Statistics", 0, &ui->stats.open);
             if (ImGui::BeginMenu("Memory Editor")) {
                 ImGui::MenuItem("Window #1", 0, &ui->memedit[0].open);
                 ImGui::MenuItem("Window #2", 0, &ui->memedit[1].open);
@@ -296,9 +300,13 @@ static void _ui_c64_mem_write(int layer, uint16_t addr, uint8_t data, void* user
             mem_wr(&c64->mem_cpu, addr, data);
             break;
         case _UI_C64_MEMLAYER_RAM:
+            // direct RAM writes bypass the copy-on-write of asynchronous snapshots
+            c64_finish_snapshot_async(c64);
             c64->ram[addr] = data;
             break;
         case _UI_C64_MEMLAYER_ROM:
+            /* borrowed ROM images are read-only */
+            #if !defined(C64_BORROWED_ROMS)
             if ((addr >= 0xA000) && (addr < 0xC000)) {
                 /* BASIC ROM */
                 c64->rom_basic[addr - 0xA000] = data;
@@ -311,6 +319,7 @@ static void _ui_c64_mem_write(int layer, uint16_t addr, uint8_t data, void* user
                 /* Kernal ROM */
                 c64->rom_kernal[addr - 0xE000] = data;
             }
+            #endif
             break;
         case _UI_C64_MEMLAYER_1541:
             if (ui->c64->c1541.valid) {
@@ -329,6 +338,21 @@ static void _ui_c64_mem_write(int layer, uint16_t addr, uint8_t data, void* user
     }
 }
 
+static void _ui_c64_draw_stats(ui_c64_t* ui) {
+    CHIPS_ASSERT(ui && ui->c64);
+    const c64_stats_t stats = c64_stats(ui->c64);
+    const ui_stats_item_t items[] = {
+        { "Ticks", stats.ticks },
+        { "CPU RDY stalls", stats.rdy_ticks },
+        { "Memory accesses", stats.mem_accesses },
+        { "IO accesses", stats.io_accesses },
+        { "CPU port accesses", stats.cpu_port_accesses },
+        { "VIC badline ticks", stats.vic.badline_ticks },
+        { "VIC sprite DMA ticks", stats.vic.sprite_dma_ticks },
+    };
+    ui_stats_draw(&ui->stats, items, (int)(sizeof(items) / sizeof(items[0])));
+}
+
 static void _ui_c64_update_memmap(ui_c64_t* ui) {
     CHIPS_ASSERT(ui && ui->c64);
     const c64_t* c64 = ui->c64;
@@ -570,6 +594,7 @@ void ui_c64_init(ui_c64_t* ui, const ui_c64_desc_t* ui_desc) {
         desc.texture_cbs = ui_desc->dbg_texture;
         desc.debug_cbs = ui_desc->dbg_debug;
         desc.keys = ui_desc->dbg_keys;
+        desc.rewind_cbs = ui_desc->dbg_rewind;
         desc.user_data = ui;
         /* custom breakpoint types */
         desc.user_breaktypes[0].label = "Scanline at";
@@ -662,6 +687,14 @@ void ui_c64_init(ui_c64_t* ui, const ui_c64_desc_t* ui_desc) {
         ui_audio_init(&ui->audio, &desc);
     }
     x += dx; y += dy;
+    {
+        ui_stats_desc_t desc = {0};
+        desc.title = "Statistics";
+        desc.x = x;
+        desc.y = y;
+        ui_stats_init(&ui->stats, &desc);
+    }
+    x += dx; y += dy;
     {
         ui_display_desc_t desc = {0};
         desc.title = "Display";
@@ -736,6 +769,7 @@ void ui_c64_discard(ui_c64_t* ui) {
     ui_m6569_discard(&ui->vic);
     ui_kbd_discard(&ui->kbd);
     ui_audio_discard(&ui->audio);
+    ui_stats_discard(&ui->stats);
     ui_display_discard(&ui->display);
     ui_memmap_discard(&ui->memmap);
     for (int i = 0; i < 4; i++) {
@@ -756,6 +790,7 @@ void ui_c64_draw(ui_c64_t* ui, const ui_c64_frame_t* frame) {
         _ui_c64_update_memmap(ui);
     }
     ui_audio_draw(&ui->audio, ui->c64->audio.sample_pos);
+    _ui_c64_draw_stats(ui);
     ui_display_draw(&ui->display, &frame->display);
     ui_kbd_draw(&ui->kbd);
     ui_m6502_draw(&ui->cpu);
@@ -783,6 +818,7 @@ chips_debug_t ui_c64_get_debug(ui_c64_t* ui) {
     res.callback.func = (chips_debug_func_t)ui_dbg_tick;
     res.callback.user_data = &ui->dbg;
     res.stopped = &ui->dbg.dbg.stopped;
+    res.filter = &ui->dbg.dbg.filter;
     return res;
 }
 
@@ -799,6 +835,7 @@ void ui_c64_save_settings(ui_c64_t* ui, ui_settings_t* settings) {
     ui_m6581_save_settings(&ui->sid, settings);
     ui_m6569_save_settings(&ui->vic, settings);
     ui_audio_save_settings(&ui->audio, settings);
+    ui_stats_save_settings(&ui->stats, settings);
     ui_display_save_settings(&ui->display, settings);
     ui_kbd_save_settings(&ui->kbd, settings);
     ui_memmap_save_settings(&ui->memmap, settings);
@@ -824,6 +861,7 @@ void ui_c64_load_settings(ui_c64_t* ui, const ui_settings_t* settings) {
     ui_m6581_load_settings(&ui->sid, settings);
     ui_m6569_load_settings(&ui->vic, settings);
     ui_audio_load_settings(&ui->audio, settings);
+    ui_stats_load_settings(&ui->stats, settings);
     ui_display_load_settings(&ui->display, settings);
     ui_kbd_load_settings(&ui->kbd, settings);
     ui_memmap_load_settings(&ui->memmap, settings);
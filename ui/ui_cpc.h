@@ -35,6 +35,7 @@
     - ui_am40010.h
     - ui_fdd.h
     - ui_audio.h
+    - ui_stats.h
     - ui_display.h
     - ui_dasm.h
     - ui_dbg.h
@@ -76,6 +77,7 @@ typedef struct {
     ui_dbg_texture_callbacks_t dbg_texture;     // debug texture create/update/destroy callbacks
     ui_dbg_debug_callbacks_t dbg_debug;         // user-provided debugger callbacks
     ui_dbg_keys_desc_t dbg_keys;                // user-defined hotkeys for ui_dbg_t
+    ui_dbg_rewind_callbacks_t dbg_rewind;       // optional reverse stepping callbacks for ui_dbg_t
     ui_snapshot_desc_t snapshot;                // snapshot ui setup params
 } ui_cpc_desc_t;
 
@@ -95,6 +97,7 @@ typedef struct {
     ui_i8255_t ppi;
     ui_upd765_t upd;
     ui_audio_t audio;
+    ui_stats_t stats;
     ui_display_t display;
     ui_fdd_t fdd;
     ui_kbd_t kbd;
@@ -181,6 +184,7 @@ static void _ui_cpc_draw_menu(ui_cpc_t* ui) {
             ImGui::MenuItem("Stopwatch", 0, &ui->dbg.ui.stopwatch.open);
             ImGui::MenuItem("Execution History", 0, &ui->dbg.ui.history.open);
             ImGui::MenuItem("Memory Heatmap", 0, &ui->dbg.ui.heatmap.open);
+            ImGui::MenuItem("Statistics", 0, &ui->stats.open);
             if (ImGui::BeginMenu("Memory Editor")) {
                 ImGui::MenuItem("Window #1", 0, &ui->memedit[0].open);
                 ImGui::MenuItem("Window #2", 0, &ui->memedit[1].open);
@@ -238,6 +242,20 @@ static const char* _ui_cpc_memlayer_names[_UI_CPC_MEMLAYER_NUM] = {
     "CPU Mapped", "Gate Array", "OS ROMS", "AMSDOS ROM", "RAM 0", "RAM 1", "RAM 2", "RAM 3", "RAM 4", "RAM 5", "RAM 6", "RAM 7"
 };
 
+static void _ui_cpc_draw_stats(ui_cpc_t* ui) {
+    CHIPS_ASSERT(ui && ui->cpc);
+    const cpc_stats_t stats = cpc_stats(ui->cpc);
+    const ui_stats_item_t items[] = {
+        { "Ticks", stats.ticks },
+        { "CPU WAIT stalls", stats.wait_ticks },
+        { "Memory accesses", stats.mem_accesses },
+        { "IO requests", stats.io_requests },
+        { "GA interrupts", stats.ga.interrupts },
+        { "GA video decode ticks", stats.ga.video_decode_ticks },
+    };
+    ui_stats_draw(&ui->stats, items, (int)(sizeof(items) / sizeof(items[0])));
+}
+
 static void _ui_cpc_update_memmap(ui_cpc_t* ui) {
     CHIPS_ASSERT(ui && ui->cpc);
     const cpc_t* cpc = ui->cpc;
@@ -283,15 +301,15 @@ static uint8_t* _ui_cpc_memptr(cpc_t* cpc, int layer, uint16_t addr) {
         return ram + addr;
     } else if (layer == _UI_CPC_MEMLAYER_ROMS) {
         if (addr < 0x4000) {
-            return &cpc->rom_os[addr];
+            return (uint8_t*) &cpc->rom_os[addr];
         } else if (addr >= 0xC000) {
-            return &cpc->rom_basic[addr - 0xC000];
+            return (uint8_t*) &cpc->rom_basic[addr - 0xC000];
         } else {
             return 0;
         }
     } else if (layer == _UI_CPC_MEMLAYER_AMSDOS) {
         if ((CPC_TYPE_6128 == cpc->type) && (addr >= 0xC000)) {
-            return &cpc->rom_amsdos[addr - 0xC000];
+            return (uint8_t*) &cpc->rom_amsdos[addr - 0xC000];
         } else {
             return 0;
         }
@@ -349,6 +367,12 @@ static void _ui_cpc_mem_write(int layer, uint16_t addr, uint8_t data, void* user
     if (layer == _UI_CPC_MEMLAYER_CPU) {
         mem_wr(&cpc->mem, addr, data);
     } else {
+        #if defined(CPC_BORROWED_ROMS)
+        // borrowed ROM images are read-only
+        if ((layer == _UI_CPC_MEMLAYER_ROMS) || (layer == _UI_CPC_MEMLAYER_AMSDOS)) {
+            return;
+        }
+        #endif
         uint8_t* ptr = _ui_cpc_memptr(cpc, layer, addr);
         if (ptr) {
             *ptr = data;
@@ -602,6 +626,7 @@ void ui_cpc_init(ui_cpc_t* ui, const ui_cpc_desc_t* ui_desc) {
         desc.texture_cbs = ui_desc->dbg_texture;
         desc.debug_cbs = ui_desc->dbg_debug;
         desc.keys = ui_desc->dbg_keys;
+        desc.rewind_cbs = ui_desc->dbg_rewind;
         desc.user_data = ui;
         /* custom breakpoint types */
         desc.user_breaktypes[0].label = "Scanline at";
@@ -682,6 +707,14 @@ void ui_cpc_init(ui_cpc_t* ui, const ui_cpc_desc_t* ui_desc) {
         ui_audio_init(&ui->audio, &desc);
     }
     x += dx; y += dy;
+    {
+        ui_stats_desc_t desc = {0};
+        desc.title = "Statistics";
+        desc.x = x;
+        desc.y = y;
+        ui_stats_init(&ui->stats, &desc);
+    }
+    x += dx; y += dy;
     {
         ui_display_desc_t desc = {0};
         desc.title = "Display";
@@ -765,6 +798,7 @@ void ui_cpc_discard(ui_cpc_t* ui) {
     ui_kbd_discard(&ui->kbd);
     ui_display_discard(&ui->display);
     ui_audio_discard(&ui->audio);
+    ui_stats_discard(&ui->stats);
     ui_fdd_discard(&ui->fdd);
     ui_memmap_discard(&ui->memmap);
     for (int i = 0; i < 4; i++) {
@@ -781,6 +815,7 @@ void ui_cpc_draw(ui_cpc_t* ui, const ui_cpc_frame_t* frame) {
         _ui_cpc_update_memmap(ui);
     }
     ui_audio_draw(&ui->audio, ui->cpc->audio.sample_pos);
+    _ui_cpc_draw_stats(ui);
     ui_display_draw(&ui->display, &frame->display);
     ui_fdd_draw(&ui->fdd);
     ui_kbd_draw(&ui->kbd);
@@ -804,6 +839,7 @@ chips_debug_t ui_cpc_get_debug(ui_cpc_t* ui) {
     res.callback.func = (chips_debug_func_t)ui_dbg_tick;
     res.callback.user_data = &ui->dbg;
     res.stopped = &ui->dbg.dbg.stopped;
+    res.filter = &ui->dbg.dbg.filter;
     return res;
 }
 
@@ -816,6 +852,7 @@ void ui_cpc_save_settings(ui_cpc_t* ui, ui_settings_t* settings) {
     ui_i8255_save_settings(&ui->ppi, settings);
     ui_upd765_save_settings(&ui->upd, settings);
     ui_audio_save_settings(&ui->audio, settings);
+    ui_stats_save_settings(&ui->stats, settings);
     ui_display_save_settings(&ui->display, settings);
     ui_fdd_save_settings(&ui->fdd, settings);
     ui_kbd_save_settings(&ui->kbd, settings);
@@ -838,6 +875,7 @@ void ui_cpc_load_settings(ui_cpc_t* ui, const ui_settings_t* settings) {
     ui_i8255_load_settings(&ui->ppi, settings);
     ui_upd765_load_settings(&ui->upd, settings);
     ui_audio_load_settings(&ui->audio, settings);
+    ui_stats_load_settings(&ui->stats, settings);
     ui_display_load_settings(&ui->display, settings);
     ui_fdd_load_settings(&ui->fdd, settings);
     ui_kbd_load_settings(&ui->kbd, settings);
@@ -69,6 +69,7 @@ typedef uint8_t (*ui_dasm_read_t)(int layer, uint16_t addr, void* user_data);
 #define UI_DASM_MAX_BINLEN (16)
 #define UI_DASM_NUM_LINES (512)
 #define UI_DASM_MAX_STACK (128)
+#define UI_DASM_CACHE_SIZE (1024)   /* number of cached disassembled instructions */
 
 /* CPU types */
 typedef enum {
@@ -92,6 +93,15 @@ typedef struct {
     bool open;          /* initial open state */
 } ui_dasm_desc_t;
 
+/* a cached disassembled instruction */
+typedef struct {
+    uint16_t addr;
+    uint8_t layer;
+    uint8_t bin_pos;    /* 0 for empty cache slot */
+    uint8_t bin_buf[UI_DASM_MAX_BINLEN];
+    char str_buf[UI_DASM_MAX_STRLEN];
+} ui_dasm_cache_line_t;
+
 typedef struct {
     const char* title;
     ui_dasm_read_t read_cb;
@@ -116,6 +126,7 @@ typedef struct {
     uint16_t stack[UI_DASM_MAX_STACK];
     uint16_t highlight_addr;
     uint32_t highlight_color;
+    ui_dasm_cache_line_t cache[UI_DASM_CACHE_SIZE];
 } ui_dasm_t;
 
 void ui_dasm_init(ui_dasm_t* win, const ui_dasm_desc_t* desc);
@@ -136,7 +147,7 @@ void ui_dasm_load_settings(ui_dasm_t* ui, const ui_settings_t* settings);
 #if !defined(UI_DASM_USE_Z80) && !defined(UI_DASM_USE_M6502)
 #error "please define UI_DASM_USE_Z80 and/or UI_DASM_USE_M6502"
 #endif
-#include <string.h> /* memset */
+#include <string.h> /* memset, memcpy, strlen */
 #include <stdio.h>  /* sscanf, sprintf (ImGui memory editor) */
 #ifndef CHIPS_ASSERT
     #include <assert.h>
@@ -194,8 +205,32 @@ static void _ui_dasm_out_cb(char c, void* user_data) {
     }
 }
 
+/* check if a cached instruction is still valid (same address, layer and instruction bytes) */
+static bool _ui_dasm_cache_valid(ui_dasm_t* win, const ui_dasm_cache_line_t* line) {
+    if ((line->bin_pos == 0) || (line->addr != win->cur_addr) || (line->layer != win->cur_layer)) {
+        return false;
+    }
+    for (int i = 0; i < line->bin_pos; i++) {
+        if (line->bin_buf[i] != win->read_cb(win->cur_layer, (uint16_t)(win->cur_addr + i), win->user_data)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /* disassemble the next instruction */
 static void _ui_dasm_disasm(ui_dasm_t* win) {
+    /* unchanged instructions only need to be disassembled once */
+    ui_dasm_cache_line_t* cached = &win->cache[win->cur_addr & (UI_DASM_CACHE_SIZE-1)];
+    if (_ui_dasm_cache_valid(win, cached)) {
+        win->bin_pos = cached->bin_pos;
+        memcpy(win->bin_buf, cached->bin_buf, sizeof(win->bin_buf));
+        memcpy(win->str_buf, cached->str_buf, sizeof(win->str_buf));
+        win->str_pos = (int) strlen(win->str_buf);
+        win->cur_addr += cached->bin_pos;
+        return;
+    }
+    const uint16_t addr = win->cur_addr;
     win->str_pos = 0;
     win->bin_pos = 0;
     #if defined(UI_DASM_USE_Z80) && defined(UI_DASM_USE_M6502)
@@ -210,6 +245,11 @@ static void _ui_dasm_disasm(ui_dasm_t* win) {
     #else
     m6502dasm_op(win->cur_addr, _ui_dasm_in_cb, _ui_dasm_out_cb, win);
     #endif
+    cached->addr = addr;
+    cached->layer = (uint8_t) win->cur_layer;
+    cached->bin_pos = (uint8_t) win->bin_pos;
+    memcpy(cached->bin_buf, win->bin_buf, sizeof(cached->bin_buf));
+    memcpy(cached->str_buf, win->str_buf, sizeof(cached->str_buf));
 }
 
 /* check if the current Z80 or m6502 instruction contains a jump target */
@@ -24,6 +24,8 @@
     ~~~
         your own assert macro (default: assert(c))
 
+    Include chips_common.h before including the declaration.
+
     You need to include the following headers before including the
     *implementation*:
 
@@ -38,6 +40,89 @@
     All strings provided to ui_dbg_init() must remain alive until
     ui_dbg_discard() is called!
 
+    The debugger owns a chips_debug_filter_t (see 'Debug Callback Filter'
+    in chips_common.h) which must be provided to the system emulator in
+    chips_debug_t.filter together with ui_dbg_tick() as debug callback.
+    The filter is updated whenever breakpoints, the step mode or the
+    visible debugger windows change, so that ui_dbg_tick() is only called
+    on every tick when a per-tick breakpoint (IRQ, NMI, IN, OUT or user
+    breakpoints), tick-stepping or the memory heatmap window is active,
+    and only at instruction boundaries when stepping, when byte, word or
+    condition breakpoints are active or the debugger or history window is open.
+    Otherwise ui_dbg_tick() is only called when an execution, read
+    or write breakpoint address is hit.
+
+    ## Breakpoint Conditions
+
+    Each breakpoint can have an optional condition expression (entered in
+    the breakpoint window, or set with ui_dbg_set_breakpoint_condition()),
+    the breakpoint only triggers if the condition is true (non-zero) when
+    the breakpoint's event happens, and the 'Condition' breakpoint type
+    triggers at any instruction boundary where the condition is true.
+
+    The expression syntax is C-like, with the following operands:
+
+        - numbers: decimal (42), or hexadecimal ($2A or 0x2A)
+        - registers: a f b c d e h l i r af bc de hl ix iy sp pc (Z80),
+          or a x y s p pc (6502), pc is the address of the current instruction
+        - [expr]: the byte at address expr, w[expr]: the 16-bit word at expr
+        - addr, data: the current CPU address and data bus value
+        - pins: m1 mreq iorq rd wr (Z80), or sync rw (6502), 1 when active
+        - ticks: the debug filter tick counter
+
+    ...combined with the unary - ! ~ and binary * / % + - << >> < <= > >=
+    == != (or =) & ^ | && || operators and parentheses, for instance:
+
+        a == $10 && [hl] != 0 && ticks > 1000000
+
+    The expression is compiled once into a compact stack-machine bytecode
+    when it is changed, and only evaluated when the breakpoint's event
+    happens (at an instruction boundary, or on the tick of a read, write,
+    IN, OUT or interrupt), so complex conditions don't slow down the
+    emulation more than the breakpoint itself. An expression which fails
+    to compile is shown in red and never triggers.
+
+    ## Reverse Stepping
+
+    When the optional ui_dbg_desc_t.rewind_cbs callbacks are provided,
+    the debugger can step back one instruction and run backward to the
+    previous breakpoint hit. This works by restoring the system state
+    from a keyframe snapshot and replaying forward from there, which
+    is deterministic as long as no input events happen between the
+    keyframe and the replay target.
+
+    To make sure of this, the host application must call ui_dbg_save_keyframe()
+    right before each call to the system's xxx_exec() function, after all
+    input events have been applied. This invokes rewind_cbs.save_cb
+    which is expected to push a snapshot of the system state into a
+    history buffer (for instance with rewind.h):
+
+    ~~~C
+    static void save_keyframe(void) {
+        zx_save_snapshot(&zx, &scratch);
+        rewind_push(&rewind, &scratch);
+    }
+    ~~~
+
+    The rewind_cbs.load_cb callback must load the keyframe 'frames_back'
+    keyframes before the most recent one, and drop all newer keyframes:
+
+    ~~~C
+    static bool load_keyframe(int frames_back) {
+        return rewind_seek(&rewind, frames_back, &scratch) && zx_load_snapshot(&zx, ZX_SNAPSHOT_VERSION, &scratch);
+    }
+    ~~~
+
+    ...and rewind_cbs.exec_cb runs the system for a number of microseconds
+    (usually by calling xxx_exec()), the debugger stops the replay at
+    the target tick.
+
+    Reverse stepping uses the tick counter in the debug callback filter
+    as timeline, so it always needs the debug filter to be provided
+    to the system. While the debugger is stopped, only a single keyframe is
+    saved, input events which happen while the debugger is stopped will
+    not be replayed.
+
     ## zlib/libpng license
 
     Copyright (c) 2018 Andre Weissflog
@@ -75,6 +160,12 @@ extern "C" {
 #define UI_DBG_NUM_LINES (256)
 #define UI_DBG_NUM_BACKTRACE_LINES (UI_DBG_NUM_LINES/2)
 #define UI_DBG_NUM_HISTORY_ITEMS (256)
+#define UI_DBG_NUM_KEYFRAMES (1024)     /* max number of keyframe tick counts tracked for reverse stepping */
+#define UI_DBG_HEATMAP_BLOCK_SIZE (256) /* granularity of heatmap change tracking in bytes */
+#define UI_DBG_DASM_CACHE_SIZE (1024)   /* number of cached disassembled instructions */
+#define UI_DBG_MAX_EXPR_CHARS (64)      /* max length of a breakpoint condition expression */
+#define UI_DBG_MAX_EXPR_OPS (64)        /* max number of compiled breakpoint condition ops */
+#define UI_DBG_MAX_EXPR_STACK (16)      /* max evaluation stack depth of a breakpoint condition */
 
 /* breakpoint types */
 enum {
@@ -87,6 +178,9 @@ enum {
         UI_DBG_BREAKTYPE_OUT,   /* break on a Z80 out operation */
         UI_DBG_BREAKTYPE_IN,    /* break on a Z80 in operation */
     #endif
+    UI_DBG_BREAKTYPE_READ,      /* break on memory read from address */
+    UI_DBG_BREAKTYPE_WRITE,     /* break on memory write to address */
+    UI_DBG_BREAKTYPE_EXPR,      /* break on instruction boundary when the condition expression is true */
     UI_DBG_BREAKTYPE_USER,      /* user breakpoint types start here */
 };
 #define UI_DBG_MAX_BREAKTYPES (UI_DBG_BREAKTYPE_USER + UI_DBG_MAX_USER_BREAKTYPES)
@@ -116,6 +210,19 @@ enum {
     UI_DBG_STOP_REASON_STEP = 3,
 };
 
+/* a compiled breakpoint condition op */
+typedef struct ui_dbg_expr_op_t {
+    uint8_t op;
+    uint32_t val;
+} ui_dbg_expr_op_t;
+
+/* a compiled breakpoint condition expression (see 'Breakpoint Conditions') */
+typedef struct ui_dbg_expr_t {
+    int num_ops;        /* 0 if no condition */
+    bool error;         /* true if the expression failed to compile */
+    ui_dbg_expr_op_t ops[UI_DBG_MAX_EXPR_OPS];
+} ui_dbg_expr_t;
+
 /* a breakpoint description */
 typedef struct ui_dbg_breakpoint_t {
     int type;           /* UI_DBG_BREAKTYPE_* */
@@ -123,6 +230,8 @@ typedef struct ui_dbg_breakpoint_t {
     bool enabled;
     uint16_t addr;
     int val;
+    char cond_text[UI_DBG_MAX_EXPR_CHARS];  /* optional condition expression */
+    ui_dbg_expr_t cond_expr;                /* compiled condition expression */
 } ui_dbg_breakpoint_t;
 
 /* breakpoint type description */
@@ -145,6 +254,8 @@ typedef int (*ui_dbg_user_break_t)(struct ui_dbg_t* win, int trap_id, uint64_t p
 typedef ui_texture_t (*ui_dbg_create_texture_t)(int w, int h);
 /* callback to update a UI texture with new data */
 typedef void (*ui_dbg_update_texture_t)(ui_texture_t tex_handle, void* data, int data_byte_size);
+/* optional callback to update a range of full-width rows in a UI texture, data points to the first row */
+typedef void (*ui_dbg_update_texture_rows_t)(ui_texture_t tex_handle, int y, int num_rows, void* data, int data_byte_size);
 /* callback to destroy a UI texture */
 typedef void (*ui_dbg_destroy_texture_t)(ui_texture_t tex_handle);
 /* callback when emulator is being rebootet */
@@ -155,6 +266,12 @@ typedef void (*ui_dbg_reset_t)(void);
 typedef void (*ui_dbg_stopped_t)(int stop_reason, uint16_t addr);
 /* callback when emulator has continued after stopped state */
 typedef void (*ui_dbg_continued_t)(void);
+/* callback to save a keyframe snapshot of the emulator state */
+typedef void (*ui_dbg_save_keyframe_t)(void);
+/* callback to load the keyframe 'frames_back' before the most recent keyframe, must drop all newer keyframes */
+typedef bool (*ui_dbg_load_keyframe_t)(int frames_back);
+/* callback to run the emulator for a number of microseconds */
+typedef void (*ui_dbg_exec_t)(uint32_t micro_seconds);
 
 /* user-defined hotkeys (all strings must be static) */
 typedef struct ui_dbg_key_desc_t {
@@ -168,6 +285,8 @@ typedef struct ui_dbg_keys_desc_t {
     ui_dbg_key_desc_t step_over;
     ui_dbg_key_desc_t step_into;
     ui_dbg_key_desc_t step_tick;
+    ui_dbg_key_desc_t step_back;
+    ui_dbg_key_desc_t cont_back;
     ui_dbg_key_desc_t toggle_breakpoint;
 } ui_dbg_keys_desc_t;
 
@@ -175,6 +294,7 @@ typedef struct ui_dbg_texture_callbacks_t {
     ui_dbg_create_texture_t create_cb;      // callback to create UI texture
     ui_dbg_update_texture_t update_cb;      // callback to update UI texture
     ui_dbg_destroy_texture_t destroy_cb;    // callback to destroy UI texture
+    ui_dbg_update_texture_rows_t update_rows_cb;    // optional callback to only update a range of texture rows
 } ui_dbg_texture_callbacks_t;
 
 typedef struct ui_dbg_debug_callbacks_t {
@@ -184,6 +304,13 @@ typedef struct ui_dbg_debug_callbacks_t {
     ui_dbg_continued_t continued_cb;
 } ui_dbg_debug_callbacks_t;
 
+/* optional callbacks for reverse stepping (see 'Reverse Stepping') */
+typedef struct ui_dbg_rewind_callbacks_t {
+    ui_dbg_save_keyframe_t save_cb;     // push a keyframe snapshot
+    ui_dbg_load_keyframe_t load_cb;     // load a keyframe snapshot and drop newer keyframes
+    ui_dbg_exec_t exec_cb;              // run the emulator
+} ui_dbg_rewind_callbacks_t;
+
 typedef struct ui_dbg_desc_t {
     const char* title;          // window title
     #if defined(UI_DBG_USE_Z80)
@@ -199,6 +326,7 @@ typedef struct ui_dbg_desc_t {
     ui_dbg_user_break_t break_cb;   // optional user-breakpoint evaluation callback
     ui_dbg_texture_callbacks_t texture_cbs;
     ui_dbg_debug_callbacks_t debug_cbs;
+    ui_dbg_rewind_callbacks_t rewind_cbs;   // optional, needs freq_hz
     void* user_data;                // user data for callbacks
     int x, y;                       // initial window pos
     int w, h;                       // initial window size, or 0 for default size
@@ -226,6 +354,8 @@ typedef struct ui_dbg_state_t {
     int delete_breakpoint_index;
     int num_breakpoints;
     ui_dbg_breakpoint_t breakpoints[UI_DBG_MAX_BREAKPOINTS];
+    uint64_t filter_ticks;      // filter.ticks at the last ui_dbg_tick() call
+    chips_debug_filter_t filter;    // debug callback filter, provided to the system in chips_debug_t
 } ui_dbg_state_t;
 
 /* a displayed line */
@@ -291,8 +421,10 @@ typedef struct ui_dbg_heatmap_t {
     ui_texture_t texture;
     bool show_ops, show_reads, show_writes;
     int autoclear_interval; /* 0: no autoclear */
+    int autoclear_pos;      /* next address to clear with autoclear */
     int scale;
-    int cur_y;
+    uint16_t pc;            /* PC highlighted in the pixel data */
+    uint64_t dirty[(1<<16)/UI_DBG_HEATMAP_BLOCK_SIZE/64];  /* one bit per block of pixels which need to be updated */
     bool popup_addr_valid;
     uint16_t popup_addr;
     ui_dbg_heatmapitem_t items[1<<16];     /* execution counter map */
@@ -301,9 +433,34 @@ typedef struct ui_dbg_heatmap_t {
 
 typedef struct ui_dbg_history_t {
     uint16_t pc[UI_DBG_NUM_HISTORY_ITEMS];
+    uint64_t ticks[UI_DBG_NUM_HISTORY_ITEMS];   /* debug filter tick count of each instruction */
     uint16_t pos;
+    uint16_t num;
 } ui_dbg_history_t;
 
+/* replay modes for reverse stepping */
+enum {
+    UI_DBG_REPLAY_NONE = 0,
+    UI_DBG_REPLAY_TO_TICK,          /* replay until the end tick */
+    UI_DBG_REPLAY_SCAN_OPS,         /* find the last instruction before the end tick */
+    UI_DBG_REPLAY_SCAN_BREAKPOINTS, /* find the last breakpoint hit before the end tick */
+};
+
+typedef struct ui_dbg_rewind_t {
+    ui_dbg_rewind_callbacks_t cbs;
+    int num_keyframes;
+    int pos;
+    uint64_t keyframe_ticks[UI_DBG_NUM_KEYFRAMES];  /* debug filter tick count of each keyframe */
+    struct {
+        int mode;           /* UI_DBG_REPLAY_* */
+        uint32_t flags;     /* additional debug filter flags during replay */
+        uint64_t end_tick;
+        bool hit;
+        uint64_t hit_tick;
+        int hit_trap_id;
+    } replay;
+} ui_dbg_rewind_t;
+
 enum {
     UI_DBG_DASM_LINE_MAX_BYTES = 8,
     UI_DBG_DASM_LINE_MAX_CHARS = 32,
@@ -317,6 +474,11 @@ typedef struct ui_dbg_dasm_line_t {
     char chars[UI_DBG_DASM_LINE_MAX_CHARS];
 } ui_dbg_dasm_line_t;
 
+/* disassembly cache, direct-mapped by address */
+typedef struct ui_dbg_dasm_cache_t {
+    ui_dbg_dasm_line_t lines[UI_DBG_DASM_CACHE_SIZE];
+} ui_dbg_dasm_cache_t;
+
 typedef struct ui_dbg_dasm_request_t {
     uint16_t addr;                  // base address
     int offset_lines;               // offset in number of ops/lines, may be negative
@@ -344,11 +506,13 @@ typedef struct ui_dbg_t {
     ui_dbg_debug_callbacks_t debug_cbs;
     void* user_data;
     ui_dbg_dasm_line_t dasm_line;
+    ui_dbg_dasm_cache_t dasm_cache;
     ui_dbg_state_t dbg;
     ui_dbg_uistate_t ui;
     ui_dbg_heatmap_t heatmap;
     ui_dbg_history_t history;
     ui_dbg_stopwatch_t stopwatch;
+    ui_dbg_rewind_t rewind;
 } ui_dbg_t;
 
 // initialize a new ui_dbg_t instance
@@ -375,6 +539,8 @@ void ui_dbg_reboot(ui_dbg_t* win);
 void ui_dbg_add_breakpoint(ui_dbg_t* win, uint16_t addr);
 // clear an execution breakpoint at address
 void ui_dbg_remove_breakpoint(ui_dbg_t* win, uint16_t addr);
+// set (or clear with an empty string) the condition expression of a breakpoint, returns false on syntax error
+bool ui_dbg_set_breakpoint_condition(ui_dbg_t* win, int index, const char* expr);
 // pause/stop execution
 void ui_dbg_break(ui_dbg_t* win);
 // continue execution
@@ -385,6 +551,12 @@ bool ui_dbg_stopped(ui_dbg_t* win);
 void ui_dbg_step_next(ui_dbg_t* win);
 // peform a debugger step-into
 void ui_dbg_step_into(ui_dbg_t* win);
+// call right before xxx_exec() to save a keyframe for reverse stepping
+void ui_dbg_save_keyframe(ui_dbg_t* win);
+// step back one instruction while stopped, returns false if not possible
+bool ui_dbg_step_back(ui_dbg_t* win);
+// run back to the previous breakpoint hit (or the oldest keyframe) while stopped, returns false if not possible
+bool ui_dbg_continue_back(ui_dbg_t* win);
 // request a disassembly at start address
 void ui_dbg_disassemble(ui_dbg_t* win, const ui_dbg_dasm_request_t* request);
 
@@ -442,8 +614,27 @@ static void _ui_dbg_dasm_out_cb(char c, void* user_data) {
     }
 }
 
+/* check if a cached instruction is still valid (same address and same instruction bytes) */
+static inline bool _ui_dbg_dasm_cache_valid(ui_dbg_t* win, const ui_dbg_dasm_line_t* line, uint16_t addr) {
+    if ((line->num_bytes == 0) || (line->addr != addr)) {
+        return false;
+    }
+    for (int i = 0; i < line->num_bytes; i++) {
+        if (line->bytes[i] != _ui_dbg_read_byte(win, (uint16_t)(addr + i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // disassemble instruction at address
 static inline uint16_t _ui_dbg_disasm(ui_dbg_t* win, uint16_t addr) {
+    // unchanged instructions only need to be disassembled once
+    ui_dbg_dasm_line_t* cached = &win->dasm_cache.lines[addr & (UI_DBG_DASM_CACHE_SIZE-1)];
+    if (_ui_dbg_dasm_cache_valid(win, cached, addr)) {
+        win->dasm_line = *cached;
+        return (uint16_t)(addr + cached->num_bytes);
+    }
     memset(&win->dasm_line, 0, sizeof(win->dasm_line));
     win->dasm_line.addr = addr;
     #if defined(UI_DBG_USE_Z80)
@@ -453,6 +644,7 @@ static inline uint16_t _ui_dbg_disasm(ui_dbg_t* win, uint16_t addr) {
     #endif
     uint16_t next_addr = win->dasm_line.addr;
     win->dasm_line.addr = addr;
+    *cached = win->dasm_line;
     return next_addr;
 }
 
@@ -551,10 +743,67 @@ static bool _ui_dbg_is_controlflow_op(uint8_t opcode0, uint8_t opcode1) {
     #endif
 }
 
+/* update the debug callback filter from the current breakpoints, step mode and open windows */
+static void _ui_dbg_update_filter(ui_dbg_t* win) {
+    chips_debug_filter_t* filter = &win->dbg.filter;
+    memset(filter->exec, 0, sizeof(filter->exec));
+    memset(filter->read, 0, sizeof(filter->read));
+    memset(filter->write, 0, sizeof(filter->write));
+    uint32_t flags = 0;
+    switch (win->dbg.step_mode) {
+        case UI_DBG_STEPMODE_INTO:
+        case UI_DBG_STEPMODE_OVER:
+            flags |= CHIPS_DEBUG_FILTER_OP;
+            break;
+        case UI_DBG_STEPMODE_TICK:
+            flags |= CHIPS_DEBUG_FILTER_TICK;
+            break;
+    }
+    // the memory heatmap records all memory reads and writes
+    if (win->ui.heatmap.open) {
+        flags |= CHIPS_DEBUG_FILTER_TICK;
+    }
+    // the debugger and history windows need to see all instructions
+    if (win->ui.open || win->ui.history.open) {
+        flags |= CHIPS_DEBUG_FILTER_OP;
+    }
+    for (int i = 0; i < win->dbg.num_breakpoints; i++) {
+        const ui_dbg_breakpoint_t* bp = &win->dbg.breakpoints[i];
+        if (bp->enabled) {
+            const uint64_t bit = 1ULL << (bp->addr & 63);
+            switch (bp->type) {
+                case UI_DBG_BREAKTYPE_EXEC:
+                    filter->exec[bp->addr >> 6] |= bit;
+                    break;
+                case UI_DBG_BREAKTYPE_READ:
+                    filter->read[bp->addr >> 6] |= bit;
+                    break;
+                case UI_DBG_BREAKTYPE_WRITE:
+                    filter->write[bp->addr >> 6] |= bit;
+                    break;
+                case UI_DBG_BREAKTYPE_BYTE:
+                case UI_DBG_BREAKTYPE_WORD:
+                case UI_DBG_BREAKTYPE_EXPR:
+                    flags |= CHIPS_DEBUG_FILTER_OP;
+                    break;
+                default:
+                    flags |= CHIPS_DEBUG_FILTER_TICK;
+                    break;
+            }
+        }
+    }
+    // reverse stepping may need to see instructions during replay
+    if (win->rewind.replay.mode != UI_DBG_REPLAY_NONE) {
+        flags |= win->rewind.replay.flags;
+    }
+    filter->flags = flags;
+}
+
 static void _ui_dbg_break(ui_dbg_t* win) {
     win->dbg.stopped = true;
     win->dbg.step_mode = UI_DBG_STEPMODE_NONE;
     win->ui.request_scroll = true;
+    _ui_dbg_update_filter(win);
     if (win->debug_cbs.stopped_cb) {
         win->debug_cbs.stopped_cb(UI_DBG_STOP_REASON_BREAK, win->dbg.cur_op_pc);
     }
@@ -563,6 +812,7 @@ static void _ui_dbg_break(ui_dbg_t* win) {
 static void _ui_dbg_continue(ui_dbg_t* win, bool invoke_continue_cb) {
     win->dbg.stopped = false;
     win->dbg.step_mode = UI_DBG_STEPMODE_NONE;
+    _ui_dbg_update_filter(win);
     if (invoke_continue_cb && win->debug_cbs.continued_cb) {
         win->debug_cbs.continued_cb();
     }
@@ -572,6 +822,7 @@ static void _ui_dbg_step_into(ui_dbg_t* win) {
     win->dbg.stopped = false;
     win->dbg.step_mode = UI_DBG_STEPMODE_INTO;
     win->ui.request_scroll = true;
+    _ui_dbg_update_filter(win);
 }
 
 static void _ui_dbg_step_over(ui_dbg_t* win) {
@@ -584,12 +835,14 @@ static void _ui_dbg_step_over(ui_dbg_t* win) {
     } else {
         win->dbg.step_mode = UI_DBG_STEPMODE_INTO;
     }
+    _ui_dbg_update_filter(win);
 }
 
 static void _ui_dbg_step_tick(ui_dbg_t* win) {
     win->dbg.stopped = false;
     win->dbg.step_mode = UI_DBG_STEPMODE_TICK;
     win->ui.request_scroll = true;
+    _ui_dbg_update_filter(win);
 }
 
 /*== HISTORY =================================================================*/
@@ -603,7 +856,23 @@ static void _ui_dbg_history_reboot(ui_dbg_t* win) {
 
 static void _ui_dbg_history_push(ui_dbg_t* win, uint16_t pc) {
     win->history.pc[win->history.pos] = pc;
+    win->history.ticks[win->history.pos] = win->dbg.filter.ticks;
     win->history.pos = (win->history.pos + 1) & (UI_DBG_NUM_HISTORY_ITEMS-1);
+    if (win->history.num < UI_DBG_NUM_HISTORY_ITEMS) {
+        win->history.num++;
+    }
+}
+
+/* drop all history items after a tick count (when going back in time) */
+static void _ui_dbg_history_rewind(ui_dbg_t* win, uint64_t tick) {
+    while (win->history.num > 0) {
+        const uint16_t index = (win->history.pos - 1) & (UI_DBG_NUM_HISTORY_ITEMS-1);
+        if (win->history.ticks[index] <= tick) {
+            break;
+        }
+        win->history.pos = index;
+        win->history.num--;
+    }
 }
 
 static uint16_t _ui_dbg_history_get(ui_dbg_t* win, uint16_t rel_pos) {
@@ -708,8 +977,352 @@ static void _ui_dbg_dbgstate_reboot(ui_dbg_t* win) {
     _ui_dbg_dbgstate_reset(win);
 }
 
+/*== BREAKPOINT CONDITIONS ===================================================*/
+enum {
+    _UI_DBG_EXPR_CONST,     /* push val */
+    _UI_DBG_EXPR_REG,       /* push register val */
+    _UI_DBG_EXPR_PIN,       /* push 1 if pin mask val is active */
+    _UI_DBG_EXPR_ADDR,      /* push address bus */
+    _UI_DBG_EXPR_DATA,      /* push data bus */
+    _UI_DBG_EXPR_TICKS,     /* push debug filter tick counter */
+    _UI_DBG_EXPR_MEM8,      /* replace address on stack with byte at address */
+    _UI_DBG_EXPR_MEM16,     /* replace address on stack with word at address */
+    _UI_DBG_EXPR_NEG,
+    _UI_DBG_EXPR_NOT,
+    _UI_DBG_EXPR_BNOT,
+    /* binary operators, in the same order as _ui_dbg_expr_binops[] */
+    _UI_DBG_EXPR_LOR,
+    _UI_DBG_EXPR_LAND,
+    _UI_DBG_EXPR_OR,
+    _UI_DBG_EXPR_XOR,
+    _UI_DBG_EXPR_AND,
+    _UI_DBG_EXPR_EQ,
+    _UI_DBG_EXPR_NE,
+    _UI_DBG_EXPR_EQ1,
+    _UI_DBG_EXPR_LE,
+    _UI_DBG_EXPR_GE,
+    _UI_DBG_EXPR_SHL,
+    _UI_DBG_EXPR_SHR,
+    _UI_DBG_EXPR_LT,
+    _UI_DBG_EXPR_GT,
+    _UI_DBG_EXPR_ADD,
+    _UI_DBG_EXPR_SUB,
+    _UI_DBG_EXPR_MUL,
+    _UI_DBG_EXPR_DIV,
+    _UI_DBG_EXPR_MOD,
+};
+
+/* binary operators with precedence, longer operators first so that "<=" isn't parsed as "<" */
+static const struct { const char* str; int prec; } _ui_dbg_expr_binops[] = {
+    { "||", 1 }, { "&&", 2 }, { "|", 3 }, { "^", 4 }, { "&", 5 },
+    { "==", 6 }, { "!=", 6 }, { "=", 6 }, { "<=", 7 }, { ">=", 7 }, { "<<", 8 }, { ">>", 8 },
+    { "<", 7 }, { ">", 7 }, { "+", 9 }, { "-", 9 }, { "*", 10 }, { "/", 10 }, { "%", 10 },
+};
+
+enum {
+    #if defined(UI_DBG_USE_Z80)
+    _UI_DBG_EXPR_REG_A, _UI_DBG_EXPR_REG_F, _UI_DBG_EXPR_REG_B, _UI_DBG_EXPR_REG_C,
+    _UI_DBG_EXPR_REG_D, _UI_DBG_EXPR_REG_E, _UI_DBG_EXPR_REG_H, _UI_DBG_EXPR_REG_L,
+    _UI_DBG_EXPR_REG_I, _UI_DBG_EXPR_REG_R, _UI_DBG_EXPR_REG_AF, _UI_DBG_EXPR_REG_BC,
+    _UI_DBG_EXPR_REG_DE, _UI_DBG_EXPR_REG_HL, _UI_DBG_EXPR_REG_IX, _UI_DBG_EXPR_REG_IY,
+    _UI_DBG_EXPR_REG_SP,
+    #elif defined(UI_DBG_USE_M6502)
+    _UI_DBG_EXPR_REG_A, _UI_DBG_EXPR_REG_X, _UI_DBG_EXPR_REG_Y, _UI_DBG_EXPR_REG_S,
+    _UI_DBG_EXPR_REG_P,
+    #endif
+    _UI_DBG_EXPR_REG_PC,
+};
+
+/* names of registers, pins and other operands */
+static const struct { const char* name; uint8_t op; uint64_t val; } _ui_dbg_expr_names[] = {
+    #if defined(UI_DBG_USE_Z80)
+    { "a", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_A }, { "f", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_F },
+    { "b", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_B }, { "c", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_C },
+    { "d", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_D }, { "e", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_E },
+    { "h", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_H }, { "l", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_L },
+    { "i", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_I }, { "r", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_R },
+    { "af", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_AF }, { "bc", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_BC },
+    { "de", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_DE }, { "hl", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_HL },
+    { "ix", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_IX }, { "iy", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_IY },
+    { "sp", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_SP },
+    { "m1", _UI_DBG_EXPR_PIN, Z80_M1 }, { "mreq", _UI_DBG_EXPR_PIN, Z80_MREQ },
+    { "iorq", _UI_DBG_EXPR_PIN, Z80_IORQ }, { "rd", _UI_DBG_EXPR_PIN, Z80_RD },
+    { "wr", _UI_DBG_EXPR_PIN, Z80_WR },
+    #elif defined(UI_DBG_USE_M6502)
+    { "a", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_A }, { "x", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_X },
+    { "y", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_Y }, { "s", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_S },
+    { "p", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_P },
+    { "sync", _UI_DBG_EXPR_PIN, M6502_SYNC }, { "rw", _UI_DBG_EXPR_PIN, M6502_RW },
+    #endif
+    { "pc", _UI_DBG_EXPR_REG, _UI_DBG_EXPR_REG_PC },
+    { "addr", _UI_DBG_EXPR_ADDR, 0 }, { "data", _UI_DBG_EXPR_DATA, 0 },
+    { "ticks", _UI_DBG_EXPR_TICKS, 0 },
+};
+
+typedef struct {
+    const char* src;
+    ui_dbg_expr_t* expr;
+    int depth;
+    bool error;
+} _ui_dbg_expr_parser_t;
+
+static void _ui_dbg_expr_skip_space(_ui_dbg_expr_parser_t* p) {
+    while ((*p->src == ' ') || (*p->src == '\t')) {
+        p->src++;
+    }
+}
+
+static bool _ui_dbg_expr_accept(_ui_dbg_expr_parser_t* p, char c) {
+    _ui_dbg_expr_skip_space(p);
+    if (*p->src == c) {
+        p->src++;
+        return true;
+    }
+    return false;
+}
+
+/* emit an op, depth is the change of the evaluation stack depth */
+static void _ui_dbg_expr_emit(_ui_dbg_expr_parser_t* p, uint8_t op, uint32_t val, int depth) {
+    p->depth += depth;
+    if ((p->expr->num_ops == UI_DBG_MAX_EXPR_OPS) || (p->depth > UI_DBG_MAX_EXPR_STACK)) {
+        p->error = true;
+        return;
+    }
+    ui_dbg_expr_op_t* dst = &p->expr->ops[p->expr->num_ops++];
+    dst->op = op;
+    dst->val = val;
+}
+
+static void _ui_dbg_expr_parse(_ui_dbg_expr_parser_t* p, int min_prec);
+
+static void _ui_dbg_expr_parse_primary(_ui_dbg_expr_parser_t* p) {
+    _ui_dbg_expr_skip_space(p);
+    const char c = *p->src;
+    if (_ui_dbg_expr_accept(p, '-')) {
+        _ui_dbg_expr_parse_primary(p);
+        _ui_dbg_expr_emit(p, _UI_DBG_EXPR_NEG, 0, 0);
+    }
+    else if (_ui_dbg_expr_accept(p, '!')) {
+        _ui_dbg_expr_parse_primary(p);
+        _ui_dbg_expr_emit(p, _UI_DBG_EXPR_NOT, 0, 0);
+    }
+    else if (_ui_dbg_expr_accept(p, '~')) {
+        _ui_dbg_expr_parse_primary(p);
+        _ui_dbg_expr_emit(p, _UI_DBG_EXPR_BNOT, 0, 0);
+    }
+    else if (_ui_dbg_expr_accept(p, '(')) {
+        _ui_dbg_expr_parse(p, 1);
+        p->error |= !_ui_dbg_expr_accept(p, ')');
+    }
+    else if (_ui_dbg_expr_accept(p, '[')) {
+        _ui_dbg_expr_parse(p, 1);
+        p->error |= !_ui_dbg_expr_accept(p, ']');
+        _ui_dbg_expr_emit(p, _UI_DBG_EXPR_MEM8, 0, 0);
+    }
+    else if (((c == 'w') || (c == 'W')) && (p->src[1] == '[')) {
+        p->src += 2;
+        _ui_dbg_expr_parse(p, 1);
+        p->error |= !_ui_dbg_expr_accept(p, ']');
+        _ui_dbg_expr_emit(p, _UI_DBG_EXPR_MEM16, 0, 0);
+    }
+    else if ((c == '$') || ((c == '0') && ((p->src[1] == 'x') || (p->src[1] == 'X')))) {
+        p->src += (c == '$') ? 1 : 2;
+        uint32_t val = 0;
+        int num_digits = 0;
+        for (;; p->src++, num_digits++) {
+            const char d = *p->src;
+            if ((d >= '0') && (d <= '9'))      { val = (val << 4) | (uint32_t)(d - '0'); }
+            else if ((d >= 'a') && (d <= 'f')) { val = (val << 4) | (uint32_t)(d - 'a' + 10); }
+            else if ((d >= 'A') && (d <= 'F')) { val = (val << 4) | (uint32_t)(d - 'A' + 10); }
+            else break;
+        }
+        p->error |= (num_digits == 0);
+        _ui_dbg_expr_emit(p, _UI_DBG_EXPR_CONST, val, 1);
+    }
+    else if ((c >= '0') && (c <= '9')) {
+        uint32_t val = 0;
+        for (; (*p->src >= '0') && (*p->src <= '9'); p->src++) {
+            val = val * 10 + (uint32_t)(*p->src - '0');
+        }
+        _ui_dbg_expr_emit(p, _UI_DBG_EXPR_CONST, val, 1);
+    }
+    else {
+        char name[8];
+        size_t len = 0;
+        for (; ((*p->src >= 'a') && (*p->src <= 'z')) || ((*p->src >= 'A') && (*p->src <= 'Z')) || ((*p->src >= '0') && (*p->src <= '9')); p->src++) {
+            if (len < (sizeof(name) - 1)) {
+                name[len++] = (*p->src >= 'A' && *p->src <= 'Z') ? (char)(*p->src - 'A' + 'a') : *p->src;
+            }
+            else {
+                p->error = true;
+            }
+        }
+        name[len] = 0;
+        const int num_names = (int)(sizeof(_ui_dbg_expr_names) / sizeof(_ui_dbg_expr_names[0]));
+        int i = 0;
+        for (; i < num_names; i++) {
+            if (0 == strcmp(name, _ui_dbg_expr_names[i].name)) {
+                // pin masks are stored as bit index, since they don't fit into 32 bits
+                uint32_t val = (uint32_t)_ui_dbg_expr_names[i].val;
+                if (_ui_dbg_expr_names[i].op == _UI_DBG_EXPR_PIN) {
+                    for (val = 0; (_ui_dbg_expr_names[i].val >> val) != 1; val++);
+                }
+                _ui_dbg_expr_emit(p, _ui_dbg_expr_names[i].op, val, 1);
+                break;
+            }
+        }
+        p->error |= (i == num_names);
+    }
+}
+
+/* precedence climbing parser for binary operators */
+static void _ui_dbg_expr_parse(_ui_dbg_expr_parser_t* p, int min_prec) {
+    _ui_dbg_expr_parse_primary(p);
+    while (!p->error) {
+        _ui_dbg_expr_skip_space(p);
+        const int num_binops = (int)(sizeof(_ui_dbg_expr_binops) / sizeof(_ui_dbg_expr_binops[0]));
+        int i = 0;
+        for (; i < num_binops; i++) {
+            if (0 == strncmp(p->src, _ui_dbg_expr_binops[i].str, strlen(_ui_dbg_expr_binops[i].str))) {
+                break;
+            }
+        }
+        if ((i == num_binops) || (_ui_dbg_expr_binops[i].prec < min_prec)) {
+            return;
+        }
+        p->src += strlen(_ui_dbg_expr_binops[i].str);
+        _ui_dbg_expr_parse(p, _ui_dbg_expr_binops[i].prec + 1);
+        _ui_dbg_expr_emit(p, (uint8_t)(_UI_DBG_EXPR_LOR + i), 0, -1);
+    }
+}
+
+/* compile a condition expression, an empty string results in an empty expression */
+static bool _ui_dbg_expr_compile(ui_dbg_expr_t* expr, const char* src) {
+    _ui_dbg_expr_parser_t p;
+    memset(&p, 0, sizeof(p));
+    p.src = src;
+    p.expr = expr;
+    expr->num_ops = 0;
+    _ui_dbg_expr_skip_space(&p);
+    if (*p.src) {
+        _ui_dbg_expr_parse(&p, 1);
+        _ui_dbg_expr_skip_space(&p);
+        p.error |= (*p.src != 0);
+    }
+    if (p.error) {
+        expr->num_ops = 0;
+    }
+    expr->error = p.error;
+    return !p.error;
+}
+
+static int64_t _ui_dbg_expr_reg(ui_dbg_t* win, uint32_t reg) {
+    #if defined(UI_DBG_USE_Z80)
+        z80_t* c = win->dbg.z80;
+        switch (reg) {
+            case _UI_DBG_EXPR_REG_A:    return c->a;
+            case _UI_DBG_EXPR_REG_F:    z80_sync_flags(c); return c->f;
+            case _UI_DBG_EXPR_REG_B:    return c->b;
+            case _UI_DBG_EXPR_REG_C:    return c->c;
+            case _UI_DBG_EXPR_REG_D:    return c->d;
+            case _UI_DBG_EXPR_REG_E:    return c->e;
+            case _UI_DBG_EXPR_REG_H:    return c->h;
+            case _UI_DBG_EXPR_REG_L:    return c->l;
+            case _UI_DBG_EXPR_REG_I:    return c->i;
+            case _UI_DBG_EXPR_REG_R:    return c->r;
+            case _UI_DBG_EXPR_REG_AF:   z80_sync_flags(c); return c->af;
+            case _UI_DBG_EXPR_REG_BC:   return c->bc;
+            case _UI_DBG_EXPR_REG_DE:   return c->de;
+            case _UI_DBG_EXPR_REG_HL:   return c->hl;
+            case _UI_DBG_EXPR_REG_IX:   return c->ix;
+            case _UI_DBG_EXPR_REG_IY:   return c->iy;
+            case _UI_DBG_EXPR_REG_SP:   return c->sp;
+        }
+    #elif defined(UI_DBG_USE_M6502)
+        m6502_t* c = win->dbg.m6502;
+        switch (reg) {
+            case _UI_DBG_EXPR_REG_A:    return c->A;
+            case _UI_DBG_EXPR_REG_X:    return c->X;
+            case _UI_DBG_EXPR_REG_Y:    return c->Y;
+            case _UI_DBG_EXPR_REG_S:    return c->S;
+            case _UI_DBG_EXPR_REG_P:    return c->P;
+        }
+    #endif
+    return win->dbg.cur_op_pc;
+}
+
+/* evaluate a compiled condition expression */
+static int64_t _ui_dbg_expr_eval(ui_dbg_t* win, const ui_dbg_expr_t* expr, uint64_t pins) {
+    int64_t stack[UI_DBG_MAX_EXPR_STACK];
+    int sp = 0;
+    for (int i = 0; i < expr->num_ops; i++) {
+        const ui_dbg_expr_op_t* op = &expr->ops[i];
+        if (op->op >= _UI_DBG_EXPR_LOR) {
+            // binary operator, the compiler guarantees two operands on the stack
+            const int64_t r = stack[--sp];
+            const int64_t l = stack[sp - 1];
+            int64_t v = 0;
+            switch (op->op) {
+                case _UI_DBG_EXPR_LOR:  v = l || r; break;
+                case _UI_DBG_EXPR_LAND: v = l && r; break;
+                case _UI_DBG_EXPR_OR:   v = l | r; break;
+                case _UI_DBG_EXPR_XOR:  v = l ^ r; break;
+                case _UI_DBG_EXPR_AND:  v = l & r; break;
+                case _UI_DBG_EXPR_EQ:
+                case _UI_DBG_EXPR_EQ1:  v = l == r; break;
+                case _UI_DBG_EXPR_NE:   v = l != r; break;
+                case _UI_DBG_EXPR_LE:   v = l <= r; break;
+                case _UI_DBG_EXPR_GE:   v = l >= r; break;
+                case _UI_DBG_EXPR_SHL:  v = ((r >= 0) && (r < 64)) ? (int64_t)((uint64_t)l << r) : 0; break;
+                case _UI_DBG_EXPR_SHR:  v = ((r >= 0) && (r < 64)) ? (l >> r) : 0; break;
+                case _UI_DBG_EXPR_LT:   v = l < r; break;
+                case _UI_DBG_EXPR_GT:   v = l > r; break;
+                case _UI_DBG_EXPR_ADD:  v = (int64_t)((uint64_t)l + (uint64_t)r); break;
+                case _UI_DBG_EXPR_SUB:  v = (int64_t)((uint64_t)l - (uint64_t)r); break;
+                case _UI_DBG_EXPR_MUL:  v = (int64_t)((uint64_t)l * (uint64_t)r); break;
+                case _UI_DBG_EXPR_DIV:  v = (r != 0) ? (l / r) : 0; break;
+                case _UI_DBG_EXPR_MOD:  v = (r != 0) ? (l % r) : 0; break;
+            }
+            stack[sp - 1] = v;
+        }
+        else {
+            switch (op->op) {
+                case _UI_DBG_EXPR_CONST:    stack[sp++] = op->val; break;
+                case _UI_DBG_EXPR_REG:      stack[sp++] = _ui_dbg_expr_reg(win, op->val); break;
+                case _UI_DBG_EXPR_PIN:      stack[sp++] = (pins >> op->val) & 1; break;
+                #if defined(UI_DBG_USE_Z80)
+                case _UI_DBG_EXPR_ADDR:     stack[sp++] = Z80_GET_ADDR(pins); break;
+                case _UI_DBG_EXPR_DATA:     stack[sp++] = Z80_GET_DATA(pins); break;
+                #elif defined(UI_DBG_USE_M6502)
+                case _UI_DBG_EXPR_ADDR:     stack[sp++] = M6502_GET_ADDR(pins); break;
+                case _UI_DBG_EXPR_DATA:     stack[sp++] = M6502_GET_DATA(pins); break;
+                #endif
+                case _UI_DBG_EXPR_TICKS:    stack[sp++] = (int64_t)win->dbg.filter.ticks; break;
+                case _UI_DBG_EXPR_MEM8:     stack[sp - 1] = _ui_dbg_read_byte(win, (uint16_t)stack[sp - 1]); break;
+                case _UI_DBG_EXPR_MEM16:    stack[sp - 1] = _ui_dbg_read_word(win, (uint16_t)stack[sp - 1]); break;
+                case _UI_DBG_EXPR_NEG:      stack[sp - 1] = (int64_t)(0 - (uint64_t)stack[sp - 1]); break;
+                case _UI_DBG_EXPR_NOT:      stack[sp - 1] = !stack[sp - 1]; break;
+                case _UI_DBG_EXPR_BNOT:     stack[sp - 1] = ~stack[sp - 1]; break;
+            }
+        }
+    }
+    return (sp > 0) ? stack[sp - 1] : 0;
+}
+
+/* called when the event of breakpoint i has happened, checks the optional condition and returns a trap id or 0 */
+static int _ui_dbg_bp_hit(ui_dbg_t* win, int i, uint64_t pins) {
+    const ui_dbg_breakpoint_t* bp = &win->dbg.breakpoints[i];
+    if (bp->cond_expr.error) {
+        return 0;
+    }
+    if ((bp->cond_expr.num_ops > 0) && (0 == _ui_dbg_expr_eval(win, &bp->cond_expr, pins))) {
+        return 0;
+    }
+    return UI_DBG_BP_BASE_TRAPID + i;
+}
+
 // evaluate per-opcode breakpoints, called at the start of a new instrucion
-static int _ui_dbg_eval_op_breakpoints(ui_dbg_t* win, int trap_id, uint16_t pc) {
+static int _ui_dbg_eval_op_breakpoints(ui_dbg_t* win, int trap_id, uint16_t pc, uint64_t pins) {
     if (win->dbg.step_mode != UI_DBG_STEPMODE_NONE) {
         switch (win->dbg.step_mode) {
             case UI_DBG_STEPMODE_INTO:
@@ -734,7 +1347,7 @@ static int _ui_dbg_eval_op_breakpoints(ui_dbg_t* win, int trap_id, uint16_t pc)
                 switch (bp->type) {
                     case UI_DBG_BREAKTYPE_EXEC:
                         if (pc == bp->addr) {
-                            trap_id = UI_DBG_BP_BASE_TRAPID + i;
+                            trap_id = _ui_dbg_bp_hit(win, i, pins);
                         }
                         break;
 
@@ -751,11 +1364,17 @@ static int _ui_dbg_eval_op_breakpoints(ui_dbg_t* win, int trap_id, uint16_t pc)
                                 case UI_DBG_BREAKCOND_LESS_EQUAL:       b = val <= bp->val; break;
                             }
                             if (b) {
-                                trap_id = UI_DBG_BP_BASE_TRAPID + i;
+                                trap_id = _ui_dbg_bp_hit(win, i, pins);
                             }
                         }
                         break;
 
+                    case UI_DBG_BREAKTYPE_EXPR:
+                        if (bp->cond_expr.num_ops > 0) {
+                            trap_id = _ui_dbg_bp_hit(win, i, pins);
+                        }
+                        break;
+
                     case UI_DBG_BREAKTYPE_WORD:
                         {
                             uint16_t val = (int) _ui_dbg_read_word(win, bp->addr);
@@ -769,7 +1388,7 @@ static int _ui_dbg_eval_op_breakpoints(ui_dbg_t* win, int trap_id, uint16_t pc)
                                 case UI_DBG_BREAKCOND_LESS_EQUAL:       b = val <= bp->val; break;
                             }
                             if (b) {
-                                trap_id = UI_DBG_BP_BASE_TRAPID + i;
+                                trap_id = _ui_dbg_bp_hit(win, i, pins);
                             }
                         }
                         break;
@@ -790,11 +1409,11 @@ static int _ui_dbg_eval_tick_breakpoints(ui_dbg_t* win, int trap_id, uint64_t pi
                 case UI_DBG_BREAKTYPE_IRQ:
                     #if defined(UI_DBG_USE_Z80)
                         if (Z80_INT & rising_pins) {
-                            trap_id = UI_DBG_BP_BASE_TRAPID + i;
+                            trap_id = _ui_dbg_bp_hit(win, i, pins);
                         }
                     #elif defined(UI_DBG_USE_M6502)
                         if (M6502_IRQ & rising_pins) {
-                            trap_id = UI_DBG_BP_BASE_TRAPID + i;
+                            trap_id = _ui_dbg_bp_hit(win, i, pins);
                         }
                     #endif
                     break;
@@ -802,11 +1421,11 @@ static int _ui_dbg_eval_tick_breakpoints(ui_dbg_t* win, int trap_id, uint64_t pi
                 case UI_DBG_BREAKTYPE_NMI:
                     #if defined(UI_DBG_USE_Z80)
                         if (Z80_NMI & rising_pins) {
-                            trap_id = UI_DBG_BP_BASE_TRAPID + i;
+                            trap_id = _ui_dbg_bp_hit(win, i, pins);
                         }
                     #elif defined(UI_DBG_USE_M6502)
                         if (M6502_NMI & rising_pins) {
-                            trap_id = UI_DBG_BP_BASE_TRAPID + i;
+                            trap_id = _ui_dbg_bp_hit(win, i, pins);
                         }
                     #endif
                     break;
@@ -816,7 +1435,7 @@ static int _ui_dbg_eval_tick_breakpoints(ui_dbg_t* win, int trap_id, uint64_t pi
                     if ((pins & Z80_CTRL_PIN_MASK) == (Z80_IORQ|Z80_WR)) {
                         const uint16_t mask = bp->val;
                         if ((Z80_GET_ADDR(pins) & mask) == (bp->addr & mask)) {
-                            trap_id = UI_DBG_BP_BASE_TRAPID + i;
+                            trap_id = _ui_dbg_bp_hit(win, i, pins);
                         }
                     }
                     break;
@@ -825,11 +1444,35 @@ static int _ui_dbg_eval_tick_breakpoints(ui_dbg_t* win, int trap_id, uint64_t pi
                     if ((pins & Z80_CTRL_PIN_MASK) == (Z80_IORQ|Z80_RD)) {
                         const uint16_t mask = bp->val;
                         if ((Z80_GET_ADDR(pins) & mask) == (bp->addr & mask)) {
-                            trap_id = UI_DBG_BP_BASE_TRAPID + i;
+                            trap_id = _ui_dbg_bp_hit(win, i, pins);
                         }
                     }
                     break;
                 #endif
+
+                case UI_DBG_BREAKTYPE_READ:
+                    #if defined(UI_DBG_USE_Z80)
+                        if (((pins & Z80_CTRL_PIN_MASK) == (Z80_MREQ|Z80_RD)) && (Z80_GET_ADDR(pins) == bp->addr)) {
+                            trap_id = _ui_dbg_bp_hit(win, i, pins);
+                        }
+                    #elif defined(UI_DBG_USE_M6502)
+                        if ((pins & M6502_RW) && (M6502_GET_ADDR(pins) == bp->addr)) {
+                            trap_id = _ui_dbg_bp_hit(win, i, pins);
+                        }
+                    #endif
+                    break;
+
+                case UI_DBG_BREAKTYPE_WRITE:
+                    #if defined(UI_DBG_USE_Z80)
+                        if (((pins & Z80_CTRL_PIN_MASK) == (Z80_MREQ|Z80_WR)) && (Z80_GET_ADDR(pins) == bp->addr)) {
+                            trap_id = _ui_dbg_bp_hit(win, i, pins);
+                        }
+                    #elif defined(UI_DBG_USE_M6502)
+                        if (!(pins & M6502_RW) && (M6502_GET_ADDR(pins) == bp->addr)) {
+                            trap_id = _ui_dbg_bp_hit(win, i, pins);
+                        }
+                    #endif
+                    break;
             }
         }
     }
@@ -837,6 +1480,10 @@ static int _ui_dbg_eval_tick_breakpoints(ui_dbg_t* win, int trap_id, uint64_t pi
     // call optional user-breakpoint evaluation callback
     if ((0 == trap_id) && win->break_cb) {
         trap_id = win->break_cb(win, trap_id, pins, win->user_data);
+        // ...and check the condition of the user breakpoint
+        if ((trap_id >= UI_DBG_BP_BASE_TRAPID) && ((trap_id - UI_DBG_BP_BASE_TRAPID) < win->dbg.num_breakpoints)) {
+            trap_id = _ui_dbg_bp_hit(win, trap_id - UI_DBG_BP_BASE_TRAPID, pins);
+        }
     }
     return trap_id;
 }
@@ -850,6 +1497,9 @@ static bool _ui_dbg_bp_add_exec(ui_dbg_t* win, bool enabled, uint16_t addr) {
         bp->addr = addr;
         bp->val = 0;
         bp->enabled = enabled;
+        bp->cond_text[0] = 0;
+        bp->cond_expr.num_ops = 0;
+        bp->cond_expr.error = false;
         return true;
     } else {
         /* no more breakpoint slots */
@@ -866,6 +1516,9 @@ static bool _ui_dbg_bp_add_byte(ui_dbg_t* win, bool enabled, uint16_t addr) {
         bp->addr = addr;
         bp->val = _ui_dbg_read_byte(win, addr);
         bp->enabled = enabled;
+        bp->cond_text[0] = 0;
+        bp->cond_expr.num_ops = 0;
+        bp->cond_expr.error = false;
         return true;
     } else {
         /* no more breakpoint slots */
@@ -882,6 +1535,9 @@ static bool _ui_dbg_bp_add_word(ui_dbg_t* win, bool enabled, uint16_t addr) {
         bp->addr = addr;
         bp->val = _ui_dbg_read_word(win, addr);
         bp->enabled = enabled;
+        bp->cond_text[0] = 0;
+        bp->cond_expr.num_ops = 0;
+        bp->cond_expr.error = false;
         return true;
     } else {
         /* no more breakpoint slots */
@@ -1072,6 +1728,23 @@ static void _ui_dbg_bp_draw(ui_dbg_t* win) {
                 }
             }
             ImGui::SameLine();
+            ImGui::Text("if");
+            ImGui::SameLine();
+            if (bp->cond_expr.error) {
+                ImGui::PushStyleColor(ImGuiCol_Text, 0xFF0000FF);
+            }
+            ImGui::PushItemWidth(160);
+            if (ImGui::InputText("##cond_text", bp->cond_text, sizeof(bp->cond_text))) {
+                _ui_dbg_expr_compile(&bp->cond_expr, bp->cond_text);
+            }
+            ImGui::PopItemWidth();
+            if (bp->cond_expr.error) {
+                ImGui::PopStyleColor();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip(bp->cond_expr.error ? "Syntax error in condition" : "Optional condition (see 'Breakpoint Conditions' in ui_dbg.h)");
+            }
+            ImGui::SameLine();
             if (ImGui::Button("Del")) {
                 del_bp_index = i;
             }
@@ -1108,6 +1781,15 @@ static void _ui_dbg_bp_draw(ui_dbg_t* win) {
 }
 
 /*== HEATMAP =================================================================*/
+static void _ui_dbg_heatmap_mark_all_dirty(ui_dbg_t* win) {
+    memset(win->heatmap.dirty, 0xFF, sizeof(win->heatmap.dirty));
+}
+
+static inline void _ui_dbg_heatmap_mark_dirty(ui_dbg_t* win, uint16_t addr) {
+    const int block = addr / UI_DBG_HEATMAP_BLOCK_SIZE;
+    win->heatmap.dirty[block >> 6] |= 1ULL << (block & 63);
+}
+
 static void _ui_dbg_heatmap_init(ui_dbg_t* win) {
     win->heatmap.tex_width = 256;
     win->heatmap.tex_height = 256;
@@ -1117,6 +1799,7 @@ static void _ui_dbg_heatmap_init(ui_dbg_t* win) {
     win->heatmap.show_ops = win->heatmap.show_reads = win->heatmap.show_writes = true;
     win->heatmap.scale = 1;
     win->heatmap.autoclear_interval = 0;  /* 0 means: no autoclear */
+    _ui_dbg_heatmap_mark_all_dirty(win);
 }
 
 static void _ui_dbg_heatmap_discard(ui_dbg_t* win) {
@@ -1130,6 +1813,7 @@ static void _ui_dbg_heatmap_update_texture_size(ui_dbg_t* win, int new_width) {
         win->heatmap.tex_height = (1<<16) / new_width;
         win->texture_cbs.destroy_cb(win->heatmap.texture);
         win->heatmap.texture = win->texture_cbs.create_cb(win->heatmap.tex_width, win->heatmap.tex_height);
+        _ui_dbg_heatmap_mark_all_dirty(win);
     }
 }
 
@@ -1137,6 +1821,7 @@ static void _ui_dbg_heatmap_reset(ui_dbg_t* win) {
     win->heatmap.popup_addr_valid = false;
     win->heatmap.popup_addr = 0;
     memset(win->heatmap.items, 0, sizeof(win->heatmap.items));
+    _ui_dbg_heatmap_mark_all_dirty(win);
 }
 
 static void _ui_dbg_heatmap_reboot(ui_dbg_t* win) {
@@ -1145,36 +1830,60 @@ static void _ui_dbg_heatmap_reboot(ui_dbg_t* win) {
 
 static void _ui_dbg_heatmap_clear_all(ui_dbg_t* win) {
     memset(win->heatmap.items, 0, sizeof(win->heatmap.items));
+    _ui_dbg_heatmap_mark_all_dirty(win);
 }
 
 static void _ui_dbg_heatmap_clear_rw(ui_dbg_t* win) {
     for (int i = 0; i < (1<<16); i++) {
         win->heatmap.items[i].state &= ~(UI_DBG_HEATMAP_ITEM_READ|UI_DBG_HEATMAP_ITEM_WRITE);
     }
+    _ui_dbg_heatmap_mark_all_dirty(win);
+}
+
+/* spread the auto-clear over autoclear_interval frames, so that each frame only a slice of the map is cleared */
+static void _ui_dbg_heatmap_autoclear(ui_dbg_t* win) {
+    ui_dbg_heatmap_t* hm = &win->heatmap;
+    const int num_bytes = ((1<<16) + hm->autoclear_interval - 1) / hm->autoclear_interval;
+    for (int i = 0; i < num_bytes; i++) {
+        const uint16_t addr = (uint16_t)(hm->autoclear_pos + i);
+        if (0 != hm->items[addr].state) {
+            hm->items[addr].state = 0;
+            hm->items[addr].ticks = 0;
+            _ui_dbg_heatmap_mark_dirty(win, addr);
+        }
+    }
+    hm->autoclear_pos = (hm->autoclear_pos + num_bytes) & 0xFFFF;
 }
 
-static void _ui_dbg_heatmap_record_op(ui_dbg_t* win, uint16_t pc) {
+static inline void _ui_dbg_heatmap_set(ui_dbg_t* win, uint16_t addr, uint8_t state) {
+    if ((win->heatmap.items[addr].state & state) != state) {
+        win->heatmap.items[addr].state |= state;
+        _ui_dbg_heatmap_mark_dirty(win, addr);
+    }
+}
+
+static void _ui_dbg_heatmap_record_op(ui_dbg_t* win, uint16_t pc, bool record_ticks) {
     // record per-op heatmap events
-    win->heatmap.items[pc].state |= UI_DBG_HEATMAP_ITEM_OPCODE;
-    // update last instruction's ticks
-    win->heatmap.items[win->dbg.cur_op_pc].ticks = win->dbg.cur_op_ticks;
+    _ui_dbg_heatmap_set(win, pc, UI_DBG_HEATMAP_ITEM_OPCODE);
+    // update last instruction's ticks (only if the instruction start has been seen)
+    if (record_ticks) {
+        win->heatmap.items[win->dbg.cur_op_pc].ticks = win->dbg.cur_op_ticks;
+    }
 }
 
 static void _ui_dbg_heatmap_record_tick(ui_dbg_t* win, uint64_t pins) {
     #if defined(UI_DBG_USE_Z80)
         if ((pins & Z80_CTRL_PIN_MASK) == (Z80_MREQ|Z80_RD)) {
-            const uint16_t addr = Z80_GET_ADDR(pins);
-            win->heatmap.items[addr].state |= UI_DBG_HEATMAP_ITEM_READ;
+            _ui_dbg_heatmap_set(win, Z80_GET_ADDR(pins), UI_DBG_HEATMAP_ITEM_READ);
         } else if ((pins & Z80_CTRL_PIN_MASK) == (Z80_MREQ|Z80_WR)) {
-            const uint16_t addr = Z80_GET_ADDR(pins);
-            win->heatmap.items[addr].state |= UI_DBG_HEATMAP_ITEM_WRITE;
+            _ui_dbg_heatmap_set(win, Z80_GET_ADDR(pins), UI_DBG_HEATMAP_ITEM_WRITE);
         }
     #elif defined(UI_DBG_USE_M6502)
         const uint16_t addr = M6502_GET_ADDR(pins);
         if (0 != (pins & M6502_RW)) {
-            win->heatmap.items[addr].state |= UI_DBG_HEATMAP_ITEM_READ;
+            _ui_dbg_heatmap_set(win, addr, UI_DBG_HEATMAP_ITEM_READ);
         } else {
-            win->heatmap.items[addr].state |= UI_DBG_HEATMAP_ITEM_WRITE;
+            _ui_dbg_heatmap_set(win, addr, UI_DBG_HEATMAP_ITEM_WRITE);
         }
     #endif
 }
@@ -1191,31 +1900,58 @@ static inline bool _ui_dbg_heatmap_is_write(ui_dbg_t* win, uint16_t addr) {
     return 0 != (win->heatmap.items[addr].state & UI_DBG_HEATMAP_ITEM_WRITE);
 }
 
+/* convert the changed blocks into pixels, and update the changed texture rows */
 static void _ui_dbg_heatmap_update(ui_dbg_t* win) {
-    const int frame_chunk_height = 64;
-    const int y0 = win->heatmap.cur_y;
-    const int y1 = win->heatmap.cur_y + frame_chunk_height;
-    win->heatmap.cur_y = (y0 + frame_chunk_height) & 255;
-    for (int y = y0; y < y1; y++) {
-        for (int x = 0; x < 256; x++) {
-            const int i = y * 256 + x;
+    ui_dbg_heatmap_t* hm = &win->heatmap;
+    // the PC highlight moves
+    const uint16_t pc = _ui_dbg_get_pc(win);
+    if (pc != hm->pc) {
+        _ui_dbg_heatmap_mark_dirty(win, hm->pc);
+        _ui_dbg_heatmap_mark_dirty(win, pc);
+        hm->pc = pc;
+    }
+    int first_addr = 1<<16;
+    int end_addr = 0;
+    for (int block = 0; block < (1<<16) / UI_DBG_HEATMAP_BLOCK_SIZE; block++) {
+        if (0 == (hm->dirty[block >> 6] & (1ULL << (block & 63)))) {
+            continue;
+        }
+        const int addr0 = block * UI_DBG_HEATMAP_BLOCK_SIZE;
+        const int addr1 = addr0 + UI_DBG_HEATMAP_BLOCK_SIZE;
+        for (int i = addr0; i < addr1; i++) {
             uint32_t p = 0;
-            if (_ui_dbg_get_pc(win) == i) {
+            if (pc == i) {
                 p |= 0xFF00FFFF;
             }
-            if (win->heatmap.show_ops && _ui_dbg_heatmap_is_opcode(win, (uint16_t)i)) {
+            if (hm->show_ops && _ui_dbg_heatmap_is_opcode(win, (uint16_t)i)) {
                 p |= 0xFF0000FF;
             }
-            if (win->heatmap.show_writes && _ui_dbg_heatmap_is_write(win, (uint16_t)i)) {
+            if (hm->show_writes && _ui_dbg_heatmap_is_write(win, (uint16_t)i)) {
                 p |= 0xFF008800;
             }
-            if (win->heatmap.show_reads && _ui_dbg_heatmap_is_read(win, (uint16_t)i)) {
+            if (hm->show_reads && _ui_dbg_heatmap_is_read(win, (uint16_t)i)) {
                 p |= 0xFF880000;
             }
-            win->heatmap.pixels[i] = p;
+            hm->pixels[i] = p;
         }
+        if (addr0 < first_addr) {
+            first_addr = addr0;
+        }
+        end_addr = addr1;
+    }
+    memset(hm->dirty, 0, sizeof(hm->dirty));
+    if (end_addr == 0) {
+        return;
+    }
+    if (win->texture_cbs.update_rows_cb) {
+        // the pixel data is linear, so the changed address range maps to a range of full texture rows
+        const int y0 = first_addr / hm->tex_width;
+        const int y1 = (end_addr + hm->tex_width - 1) / hm->tex_width;
+        const int num_bytes = (y1 - y0) * hm->tex_width * 4;
+        win->texture_cbs.update_rows_cb(hm->texture, y0, y1 - y0, &hm->pixels[y0 * hm->tex_width], num_bytes);
+    } else {
+        win->texture_cbs.update_cb(hm->texture, hm->pixels, (1<<16) * 4);
     }
-    win->texture_cbs.update_cb(win->heatmap.texture, win->heatmap.pixels, 256*256*4);
 }
 
 static void _ui_dbg_heatmap_draw(ui_dbg_t* win) {
@@ -1229,9 +1965,7 @@ static void _ui_dbg_heatmap_draw(ui_dbg_t* win) {
         _ui_dbg_heatmap_update_texture_size(win, hm->next_tex_width);
     }
     if (hm->autoclear_interval > 0) {
-        if ((win->dbg.frame_id % hm->autoclear_interval) == 0) {
-            _ui_dbg_heatmap_clear_all(win);
-        }
+        _ui_dbg_heatmap_autoclear(win);
     }
     _ui_dbg_heatmap_update(win);
     ImGui::SetNextWindowPos(ImVec2(win->ui.init_x + win->ui.init_w, win->ui.init_y + 128), ImGuiCond_FirstUseEver);
@@ -1245,13 +1979,17 @@ static void _ui_dbg_heatmap_draw(ui_dbg_t* win) {
             _ui_dbg_heatmap_clear_rw(win);
         }
         ImGui::SameLine();
+        bool show_changed = false;
         ImGui::PushStyleColor(ImGuiCol_Text, 0xFF0000FF);
-        ImGui::Checkbox("OP", &hm->show_ops); ImGui::SameLine();
+        show_changed |= ImGui::Checkbox("OP", &hm->show_ops); ImGui::SameLine();
         ImGui::PushStyleColor(ImGuiCol_Text, 0xFFFF0000);
-        ImGui::Checkbox("R", &hm->show_reads); ImGui::SameLine();
+        show_changed |= ImGui::Checkbox("R", &hm->show_reads); ImGui::SameLine();
         ImGui::PushStyleColor(ImGuiCol_Text, 0xFF00FF00);
-        ImGui::Checkbox("W", &hm->show_writes);
+        show_changed |= ImGui::Checkbox("W", &hm->show_writes);
         ImGui::PopStyleColor(3);
+        if (show_changed) {
+            _ui_dbg_heatmap_mark_all_dirty(win);
+        }
         if (ImGui::Combo("Size", &hm->tex_width_uicombo_state,
             "16 x 4096 bytes\0"
             "32 x 2048 bytes\0"
@@ -1265,7 +2003,7 @@ static void _ui_dbg_heatmap_draw(ui_dbg_t* win) {
         ImGui::SliderInt("Scale", &hm->scale, 1, 8);
         ImGui::SliderInt("Auto Clear", &hm->autoclear_interval, 0, 32);
         if (ImGui::IsItemHovered() && (hm->autoclear_interval == 0)) {
-            ImGui::SetTooltip("Slide to >0 to automatically\nclear every Nth frames.");
+            ImGui::SetTooltip("Slide to >0 to automatically\nclear over N frames.");
         }
         ImGui::BeginChild("##tex", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
         ImVec2 screen_pos = ImGui::GetCursorScreenPos();
@@ -1376,6 +2114,155 @@ static void _ui_dbg_stopwatch_draw(ui_dbg_t* win) {
     ImGui::End();
 }
 
+/*== REVERSE STEPPING ========================================================*/
+static void _ui_dbg_rewind_init(ui_dbg_t* win, ui_dbg_desc_t* desc) {
+    if (desc->rewind_cbs.save_cb) {
+        CHIPS_ASSERT(desc->rewind_cbs.load_cb && desc->rewind_cbs.exec_cb);
+        CHIPS_ASSERT(desc->freq_hz > 0);
+    }
+    win->rewind.cbs = desc->rewind_cbs;
+}
+
+static bool _ui_dbg_rewind_enabled(ui_dbg_t* win) {
+    return 0 != win->rewind.cbs.save_cb;
+}
+
+/* get tick count of a keyframe, 0 is the most recent keyframe */
+static uint64_t _ui_dbg_rewind_keyframe_tick(ui_dbg_t* win, int frames_back) {
+    CHIPS_ASSERT((frames_back >= 0) && (frames_back < win->rewind.num_keyframes));
+    return win->rewind.keyframe_ticks[(win->rewind.pos - frames_back - 1) & (UI_DBG_NUM_KEYFRAMES-1)];
+}
+
+static void _ui_dbg_rewind_save_keyframe(ui_dbg_t* win) {
+    ui_dbg_rewind_t* rw = &win->rewind;
+    const uint64_t tick = win->dbg.filter.ticks;
+    // the tick count doesn't move while stopped, only keep one keyframe per tick
+    if ((rw->num_keyframes > 0) && (_ui_dbg_rewind_keyframe_tick(win, 0) == tick)) {
+        return;
+    }
+    rw->cbs.save_cb();
+    rw->keyframe_ticks[rw->pos] = tick;
+    rw->pos = (rw->pos + 1) & (UI_DBG_NUM_KEYFRAMES-1);
+    if (rw->num_keyframes < UI_DBG_NUM_KEYFRAMES) {
+        rw->num_keyframes++;
+    }
+}
+
+/* load a keyframe and replay until end_tick (or until the debugger stops), returns false if the keyframe couldn't be loaded */
+static bool _ui_dbg_rewind_replay(ui_dbg_t* win, int frames_back, int mode, uint32_t flags, uint64_t end_tick) {
+    ui_dbg_rewind_t* rw = &win->rewind;
+    if (!rw->cbs.load_cb(frames_back)) {
+        return false;
+    }
+    // the loaded keyframe is now the most recent keyframe
+    rw->pos = (rw->pos - frames_back) & (UI_DBG_NUM_KEYFRAMES-1);
+    rw->num_keyframes -= frames_back;
+    const uint64_t start_tick = _ui_dbg_rewind_keyframe_tick(win, 0);
+    win->stopwatch.cur_ticks -= win->dbg.filter.ticks - start_tick;
+    win->dbg.filter.ticks = start_tick;
+    win->dbg.filter_ticks = start_tick;
+    _ui_dbg_history_rewind(win, start_tick);
+    if (win->history.num > 0) {
+        win->dbg.cur_op_pc = _ui_dbg_history_get(win, 0);
+    }
+    rw->replay.mode = mode;
+    rw->replay.flags = flags;
+    rw->replay.end_tick = end_tick;
+    rw->replay.hit = false;
+    win->dbg.stopped = false;
+    win->dbg.step_mode = UI_DBG_STEPMODE_NONE;
+    _ui_dbg_update_filter(win);
+    // the replay ends in ui_dbg_tick() at the end tick, or when the exec budget runs out
+    for (int i = 0; (i < 4) && !win->dbg.stopped && (win->dbg.filter.ticks < end_tick); i++) {
+        const uint64_t us = (((end_tick - win->dbg.filter.ticks) * 1000000) / win->stopwatch.freq_hz) + 1;
+        rw->cbs.exec_cb((uint32_t)us);
+    }
+    rw->replay.mode = UI_DBG_REPLAY_NONE;
+    win->dbg.stopped = true;
+    win->ui.request_scroll = true;
+    _ui_dbg_update_filter(win);
+    return true;
+}
+
+/* find the last instruction or breakpoint hit before the current tick by replaying
+   from keyframes, newest keyframe first, and move there
+*/
+static bool _ui_dbg_rewind_back(ui_dbg_t* win, int scan_mode, uint32_t flags) {
+    ui_dbg_rewind_t* rw = &win->rewind;
+    if (!_ui_dbg_rewind_enabled(win) || !win->dbg.stopped) {
+        return false;
+    }
+    bool moved = false;
+    uint64_t end_tick = win->dbg.filter.ticks;
+    int frames_back = 0;
+    while (frames_back < rw->num_keyframes) {
+        if (_ui_dbg_rewind_keyframe_tick(win, frames_back) >= end_tick) {
+            frames_back++;
+            continue;
+        }
+        if (!_ui_dbg_rewind_replay(win, frames_back, scan_mode, flags, end_tick)) {
+            break;
+        }
+        moved = true;
+        if (rw->replay.hit) {
+            const uint64_t hit_tick = rw->replay.hit_tick;
+            const int hit_trap_id = rw->replay.hit_trap_id;
+            _ui_dbg_rewind_replay(win, 0, UI_DBG_REPLAY_TO_TICK, flags, hit_tick);
+            win->dbg.last_trap_id = hit_trap_id;
+            if (win->debug_cbs.stopped_cb) {
+                const int stop_reason = (scan_mode == UI_DBG_REPLAY_SCAN_OPS) ? UI_DBG_STOP_REASON_STEP : UI_DBG_STOP_REASON_BREAKPOINT;
+                win->debug_cbs.stopped_cb(stop_reason, win->dbg.cur_op_pc);
+            }
+            return true;
+        }
+        // continue with the previous keyframe, the loaded keyframe is now the most recent,
+        // and an instruction or breakpoint hit may happen right at the keyframe's tick
+        end_tick = _ui_dbg_rewind_keyframe_tick(win, 0) + 1;
+        frames_back = 1;
+    }
+    if (moved) {
+        // nothing found, stay at the oldest reachable keyframe
+        _ui_dbg_rewind_replay(win, 0, UI_DBG_REPLAY_TO_TICK, flags, _ui_dbg_rewind_keyframe_tick(win, 0));
+        if (win->debug_cbs.stopped_cb) {
+            win->debug_cbs.stopped_cb(UI_DBG_STOP_REASON_STEP, win->dbg.cur_op_pc);
+        }
+    }
+    return moved;
+}
+
+static bool _ui_dbg_step_back(ui_dbg_t* win) {
+    return _ui_dbg_rewind_back(win, UI_DBG_REPLAY_SCAN_OPS, CHIPS_DEBUG_FILTER_OP);
+}
+
+static bool _ui_dbg_continue_back(ui_dbg_t* win) {
+    // only breakpoints need to be seen, so the replay runs with the regular debug filter
+    return _ui_dbg_rewind_back(win, UI_DBG_REPLAY_SCAN_BREAKPOINTS, 0);
+}
+
+/* called from ui_dbg_tick() during a replay, returns the new trap id */
+static int _ui_dbg_rewind_tick(ui_dbg_t* win, int trap_id, bool new_op) {
+    ui_dbg_rewind_t* rw = &win->rewind;
+    const uint64_t tick = win->dbg.filter.ticks;
+    if (tick < rw->replay.end_tick) {
+        bool hit = false;
+        switch (rw->replay.mode) {
+            case UI_DBG_REPLAY_SCAN_OPS:
+                hit = new_op;
+                break;
+            case UI_DBG_REPLAY_SCAN_BREAKPOINTS:
+                hit = trap_id >= UI_DBG_BP_BASE_TRAPID;
+                break;
+        }
+        if (hit) {
+            rw->replay.hit = true;
+            rw->replay.hit_tick = tick;
+            rw->replay.hit_trap_id = trap_id;
+        }
+        return 0;
+    }
+    return UI_DBG_STEP_TRAPID;
+}
+
 /*== UI HELPERS ==============================================================*/
 static void _ui_dbg_uistate_init(ui_dbg_t* win, ui_dbg_desc_t* desc) {
     ui_dbg_uistate_t* ui = &win->ui;
@@ -1432,6 +2319,17 @@ static void _ui_dbg_uistate_init(ui_dbg_t* win, ui_dbg_desc_t* desc) {
                 bt->val_label = "portmask";
                 break;
             #endif
+            case UI_DBG_BREAKTYPE_READ:
+                bt->label = "Read at";
+                bt->show_addr = true;
+                break;
+            case UI_DBG_BREAKTYPE_WRITE:
+                bt->label = "Write at";
+                bt->show_addr = true;
+                break;
+            case UI_DBG_BREAKTYPE_EXPR:
+                bt->label = "Condition";
+                break;
         }
         ui->breaktype_combo_labels[i] = bt->label;
     }
@@ -1522,6 +2420,7 @@ void _ui_dbg_draw_regs(ui_dbg_t* win) {
     }
     #if defined(UI_DBG_USE_Z80)
         z80_t* c = win->dbg.z80;
+        z80_sync_flags(c);
         if (ImGui::BeginTable("##reg_columns", 5)) {
             for (int i = 0; i < 5; i++) {
                 ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthFixed, 64);
@@ -1627,6 +2526,16 @@ static void _ui_dbg_handle_input(ui_dbg_t* win) {
                 _ui_dbg_step_tick(win);
             }
         }
+        if (0 != win->ui.keys.step_back.keycode) {
+            if (ImGui::IsKeyPressed((ImGuiKey)win->ui.keys.step_back.keycode)) {
+                _ui_dbg_step_back(win);
+            }
+        }
+        if (0 != win->ui.keys.cont_back.keycode) {
+            if (ImGui::IsKeyPressed((ImGuiKey)win->ui.keys.cont_back.keycode)) {
+                _ui_dbg_continue_back(win);
+            }
+        }
     } else {
         if (ImGui::IsKeyPressed((ImGuiKey)win->ui.keys.stop.keycode)) {
             _ui_dbg_break(win);
@@ -1662,6 +2571,18 @@ static void _ui_dbg_draw_buttons(ui_dbg_t* win) {
         if (ImGui::Button(str)) {
             _ui_dbg_step_tick(win);
         }
+        if (_ui_dbg_rewind_enabled(win) && win->dbg.stopped) {
+            ImGui::SameLine();
+            snprintf(str, sizeof(str), "Back (%s)", _ui_dbg_str_or_def(win->ui.keys.step_back.name, "-"));
+            if (ImGui::Button(str)) {
+                _ui_dbg_step_back(win);
+            }
+            ImGui::SameLine();
+            snprintf(str, sizeof(str), "Run Back (%s)", _ui_dbg_str_or_def(win->ui.keys.cont_back.name, "-"));
+            if (ImGui::Button(str)) {
+                _ui_dbg_continue_back(win);
+            }
+        }
     } else {
         snprintf(str, sizeof(str), "Break (%s)", _ui_dbg_str_or_def(win->ui.keys.stop.name, "-"));
         if (ImGui::Button(str)) {
@@ -1985,6 +2906,8 @@ void ui_dbg_init(ui_dbg_t* win, ui_dbg_desc_t* desc) {
     _ui_dbg_uistate_init(win, desc);
     _ui_dbg_heatmap_init(win);
     _ui_dbg_stopwatch_init(win, desc);
+    _ui_dbg_rewind_init(win, desc);
+    _ui_dbg_update_filter(win);
 }
 
 void ui_dbg_discard(ui_dbg_t* win) {
@@ -2016,6 +2939,7 @@ void ui_dbg_reset(ui_dbg_t* win) {
     _ui_dbg_heatmap_reset(win);
     _ui_dbg_history_reset(win);
     _ui_dbg_stopwatch_reset(win);
+    _ui_dbg_update_filter(win);
     if (win->debug_cbs.reset_cb) {
         win->debug_cbs.reset_cb();
     }
@@ -2027,12 +2951,24 @@ void ui_dbg_reboot(ui_dbg_t* win) {
     _ui_dbg_uistate_reboot(win);
     _ui_dbg_heatmap_reboot(win);
     _ui_dbg_history_reboot(win);
+    _ui_dbg_update_filter(win);
     if (win->debug_cbs.reboot_cb) {
         win->debug_cbs.reboot_cb();
     }
 }
 
 void ui_dbg_tick(ui_dbg_t* win, uint64_t pins) {
+    // number of ticks since the last call (ticks skipped by the debug filter),
+    // always 1 if the system doesn't use the filter
+    uint32_t num_ticks = (uint32_t) (win->dbg.filter.ticks - win->dbg.filter_ticks);
+    win->dbg.filter_ticks = win->dbg.filter.ticks;
+    if (num_ticks == 0) {
+        num_ticks = 1;
+    }
+    // instruction tick counts are only known if the filter didn't skip instruction boundaries
+    const bool op_ticks_valid = (num_ticks == 1) || (win->dbg.filter.flags & (CHIPS_DEBUG_FILTER_TICK|CHIPS_DEBUG_FILTER_OP));
+    win->stopwatch.cur_ticks += num_ticks - 1;
+    win->dbg.cur_op_ticks += num_ticks - 1;
     int trap_id = 0;
     if (win->dbg.step_mode == UI_DBG_STEPMODE_TICK) {
         trap_id = UI_DBG_STEP_TRAPID;
@@ -2045,11 +2981,11 @@ void ui_dbg_tick(ui_dbg_t* win, uint64_t pins) {
     #endif
     if (new_op) {
         const uint16_t pc = pins & 0xFFFF;
-        trap_id = _ui_dbg_eval_op_breakpoints(win, trap_id, pc);
-        _ui_dbg_heatmap_record_op(win, pc);
+        win->dbg.cur_op_pc = pc;
+        trap_id = _ui_dbg_eval_op_breakpoints(win, trap_id, pc, pins);
+        _ui_dbg_heatmap_record_op(win, pc, op_ticks_valid);
         _ui_dbg_history_push(win, pc);
         win->dbg.cur_op_ticks = 0;
-        win->dbg.cur_op_pc = pc;
     }
     if (win->dbg.step_mode == UI_DBG_STEPMODE_NONE) {
         trap_id = _ui_dbg_eval_tick_breakpoints(win, trap_id, pins);
@@ -2058,6 +2994,11 @@ void ui_dbg_tick(ui_dbg_t* win, uint64_t pins) {
     win->stopwatch.cur_ticks++;
     win->dbg.cur_op_ticks++;
     win->dbg.last_tick_pins = pins;
+    if (win->rewind.replay.mode != UI_DBG_REPLAY_NONE) {
+        // replaying for reverse stepping, only stop at the end of the replay
+        win->dbg.stopped = UI_DBG_STEP_TRAPID == _ui_dbg_rewind_tick(win, trap_id, new_op);
+        return;
+    }
 
     if (trap_id >= UI_DBG_STEP_TRAPID) {
         win->dbg.stopped = true;
@@ -2066,6 +3007,7 @@ void ui_dbg_tick(ui_dbg_t* win, uint64_t pins) {
             win->debug_cbs.stopped_cb(stop_reason, win->dbg.cur_op_pc);
         }
         win->dbg.step_mode = UI_DBG_STEPMODE_NONE;
+        _ui_dbg_update_filter(win);
         if (!win->dbg.external_debugger_connected) {
             ImGui::SetWindowFocus(win->ui.title);
             win->ui.open = true;
@@ -2077,14 +3019,15 @@ void ui_dbg_tick(ui_dbg_t* win, uint64_t pins) {
 void ui_dbg_draw(ui_dbg_t* win) {
     CHIPS_ASSERT(win && win->valid && win->ui.title);
     win->dbg.frame_id++;
-    if (!(win->ui.open || win->ui.heatmap.open || win->ui.breakpoints.open || win->ui.history.open || win->ui.stopwatch.open)) {
-        return;
+    if (win->ui.open || win->ui.heatmap.open || win->ui.breakpoints.open || win->ui.history.open || win->ui.stopwatch.open) {
+        _ui_dbg_dbgwin_draw(win);
+        _ui_dbg_heatmap_draw(win);
+        _ui_dbg_history_draw(win);
+        _ui_dbg_bp_draw(win);
+        _ui_dbg_stopwatch_draw(win);
     }
-    _ui_dbg_dbgwin_draw(win);
-    _ui_dbg_heatmap_draw(win);
-    _ui_dbg_history_draw(win);
-    _ui_dbg_bp_draw(win);
-    _ui_dbg_stopwatch_draw(win);
+    // breakpoints and window visibility may have changed in the UI
+    _ui_dbg_update_filter(win);
 }
 
 void ui_dbg_external_debugger_connected(ui_dbg_t* win) {
@@ -2105,6 +3048,7 @@ void ui_dbg_add_breakpoint(ui_dbg_t* win, uint16_t addr) {
     int index = _ui_dbg_bp_find(win, UI_DBG_BREAKTYPE_EXEC, addr);
     if (index < 0) {
         _ui_dbg_bp_add_exec(win, true, addr);
+        _ui_dbg_update_filter(win);
     }
 }
 
@@ -2113,7 +3057,19 @@ void ui_dbg_remove_breakpoint(ui_dbg_t* win, uint16_t addr) {
     int index = _ui_dbg_bp_find(win, UI_DBG_BREAKTYPE_EXEC, addr);
     if (index >= 0) {
         _ui_dbg_bp_del(win, index);
+        _ui_dbg_update_filter(win);
+    }
+}
+
+bool ui_dbg_set_breakpoint_condition(ui_dbg_t* win, int index, const char* expr) {
+    CHIPS_ASSERT(win && win->valid && expr);
+    CHIPS_ASSERT((index >= 0) && (index < win->dbg.num_breakpoints));
+    ui_dbg_breakpoint_t* bp = &win->dbg.breakpoints[index];
+    if (strlen(expr) >= sizeof(bp->cond_text)) {
+        return false;
     }
+    strcpy(bp->cond_text, expr);
+    return _ui_dbg_expr_compile(&bp->cond_expr, bp->cond_text);
 }
 
 void ui_dbg_break(ui_dbg_t* win) {
@@ -2141,6 +3097,23 @@ void ui_dbg_step_into(ui_dbg_t* win) {
     _ui_dbg_step_into(win);
 }
 
+void ui_dbg_save_keyframe(ui_dbg_t* win) {
+    CHIPS_ASSERT(win && win->valid);
+    if (_ui_dbg_rewind_enabled(win)) {
+        _ui_dbg_rewind_save_keyframe(win);
+    }
+}
+
+bool ui_dbg_step_back(ui_dbg_t* win) {
+    CHIPS_ASSERT(win && win->valid);
+    return _ui_dbg_step_back(win);
+}
+
+bool ui_dbg_continue_back(ui_dbg_t* win) {
+    CHIPS_ASSERT(win && win->valid);
+    return _ui_dbg_continue_back(win);
+}
+
 void ui_dbg_disassemble(ui_dbg_t* win, const ui_dbg_dasm_request_t* request) {
     CHIPS_ASSERT(win && win->valid);
     CHIPS_ASSERT(request);
@@ -83,6 +83,7 @@ typedef struct {
     ui_dbg_texture_callbacks_t dbg_texture; // user-provided texture create/update/destroy callbacks
     ui_dbg_debug_callbacks_t dbg_debug;     // user-provided debugger callbacks
     ui_dbg_keys_desc_t dbg_keys;            // user-defined hotkeys for ui_dbg_t
+    ui_dbg_rewind_callbacks_t dbg_rewind;   // optional reverse stepping callbacks for ui_dbg_t
     ui_snapshot_desc_t snapshot;            // snapshot system creation params
 } ui_kc85_desc_t;
 
@@ -393,6 +394,7 @@ void ui_kc85_init(ui_kc85_t* ui, const ui_kc85_desc_t* ui_desc) {
         desc.texture_cbs = ui_desc->dbg_texture;
         desc.debug_cbs = ui_desc->dbg_debug;
         desc.keys = ui_desc->dbg_keys;
+        desc.rewind_cbs = ui_desc->dbg_rewind;
         desc.user_data = ui->kc85;
         ui_dbg_init(&ui->dbg, &desc);
     }
@@ -551,6 +553,7 @@ chips_debug_t ui_kc85_get_debug(ui_kc85_t* ui) {
     res.callback.func = (chips_debug_func_t)ui_dbg_tick;
     res.callback.user_data = &ui->dbg;
     res.stopped = &ui->dbg.dbg.stopped;
+    res.filter = &ui->dbg.dbg.filter;
     return res;
 }
 
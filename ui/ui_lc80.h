@@ -67,6 +67,7 @@ typedef struct {
     ui_lc80_boot_t boot_cb; // user-provided callback to reboot to different config
     ui_dbg_texture_callbacks_t dbg_texture;     // texture create/update/destroy callback
     ui_dbg_keys_desc_t dbg_keys;                // user-defined hotkeys for ui_dbg_t
+    ui_dbg_rewind_callbacks_t dbg_rewind;       // optional reverse stepping callbacks for ui_dbg_t
     ui_snapshot_desc_t snapshot;                // snapshot system creation params
 } ui_lc80_desc_t;
 
@@ -1061,6 +1062,7 @@ static void _ui_lc80_init_windows(ui_lc80_t* ui, const ui_lc80_desc_t* ui_desc)
         desc.read_cb = _ui_lc80_mem_read;
         desc.texture_cbs = ui_desc->dbg_texture;
         desc.keys = ui_desc->dbg_keys;
+        desc.rewind_cbs = ui_desc->dbg_rewind;
         desc.user_data = ui->sys;
         ui_dbg_init(&ui->win.dbg, &desc);
     }
@@ -1190,6 +1192,7 @@ chips_debug_t ui_lc80_get_debug(ui_lc80_t* ui) {
     res.callback.func = (chips_debug_func_t)ui_dbg_tick;
     res.callback.user_data = &ui->win.dbg;
     res.stopped = &ui->win.dbg.dbg.stopped;
+    res.filter = &ui->win.dbg.dbg.filter;
     return res;
 }
 
@@ -26,6 +26,24 @@
     All strings provided to ui_memedit_init() must remain alive until
     ui_memedit_discard() is called!
 
+    ## Search and Diff
+
+    The 'Search' button in the options line opens a popup to search memory
+    for a byte pattern (entered as hex bytes, e.g. "C3 00 F0"), and to find
+    all bytes which have changed since a memory snapshot was taken (useful
+    to locate game variables). Both work on the current layer, or on all
+    layers with the 'All Layers' checkbox. Clicking a result moves the
+    editor to the layer and address. The same functionality is available
+    programmatically through ui_memedit_search(), ui_memedit_take_snapshot()
+    and ui_memedit_diff().
+
+    Search and diff read each layer into a buffer first, either byte by byte
+    through the regular read callback, or (much faster) in one call through
+    the optional read_range_cb. The search then skips to candidate positions
+    with memchr(), and the diff compares 8 bytes at a time, so that even
+    a search over all layers only takes microseconds. At most
+    UI_MEMEDIT_MAX_MATCHES results are recorded.
+
     Includes a (slightly extended) version of imgui_memory_editor.h:
 
     https://github.com/ocornut/imgui_club/blob/master/imgui_memory_editor/imgui_memory_editor.h
@@ -63,9 +81,20 @@ typedef void MemoryEditor;
 
 #define UI_MEMEDIT_MAX_LAYERS (16)
 
+#define UI_MEMEDIT_MAX_PATTERN (32)
+#define UI_MEMEDIT_MAX_MATCHES (1024)
+
 /* callbacks for reading and writing bytes */
 typedef uint8_t (*ui_memedit_read_t)(int layer, uint16_t addr, void* user_data);
 typedef void (*ui_memedit_write_t)(int layer, uint16_t addr, uint8_t data, void* user_data);
+/* optional callback for reading a range of bytes (used by search and diff) */
+typedef void (*ui_memedit_read_range_t)(int layer, uint16_t addr, uint8_t* dst, size_t num_bytes, void* user_data);
+
+/* a search or diff result */
+typedef struct {
+    int layer;
+    uint16_t addr;
+} ui_memedit_match_t;
 
 /* setup parameters for ui_memedit_init()
 
@@ -76,6 +105,7 @@ typedef struct {
     const char* layers[UI_MEMEDIT_MAX_LAYERS];   /* memory system layer names */
     ui_memedit_read_t read_cb;
     ui_memedit_write_t write_cb;
+    ui_memedit_read_range_t read_range_cb;  /* optional bulk read callback for search and diff */
     size_t max_addr;
     int num_cols;       /* initial number of cols, default is 16 */
     bool hide_ascii;    /* initially hide the ASCII column */
@@ -91,6 +121,7 @@ typedef struct {
     const char* title;
     ui_memedit_read_t read_cb;
     ui_memedit_write_t write_cb;
+    ui_memedit_read_range_t read_range_cb;
     void* user_data;
     float init_x, init_y;
     float init_w, init_h;
@@ -99,6 +130,17 @@ typedef struct {
     bool open;
     bool last_open;
     bool valid;
+    struct {
+        char pattern_text[3 * UI_MEMEDIT_MAX_PATTERN + 1];  /* hex input of the search popup */
+        bool all_layers;
+        bool update_snapshot;       /* take a new snapshot after each diff */
+        uint8_t* scratch;           /* read buffer for one layer, allocated on demand */
+        uint8_t* snapshot;          /* snapshot of all layers, allocated on demand */
+        int match_len;
+        int num_matches;
+        bool overflow;              /* more than UI_MEMEDIT_MAX_MATCHES matches were found */
+        ui_memedit_match_t matches[UI_MEMEDIT_MAX_MATCHES];
+    } search;
 } ui_memedit_t;
 
 /* NOTE: win MUST be zero-initialized already, allocates memory via new() */
@@ -109,6 +151,12 @@ void ui_memedit_draw_content(ui_memedit_t* win);
 void ui_memedit_draw(ui_memedit_t* win);
 void ui_memedit_save_settings(ui_memedit_t* win, ui_settings_t* settings);
 void ui_memedit_load_settings(ui_memedit_t* ui, const ui_settings_t* settings);
+/* search the current layer (or all layers) for a byte pattern, returns number of matches in win->search.matches */
+int ui_memedit_search(ui_memedit_t* win, const uint8_t* pattern, int num_bytes, bool all_layers);
+/* take a snapshot of all layers for ui_memedit_diff() */
+void ui_memedit_take_snapshot(ui_memedit_t* win);
+/* find all bytes which have changed since the last snapshot, returns number of matches in win->search.matches */
+int ui_memedit_diff(ui_memedit_t* win, bool all_layers, bool update_snapshot);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -130,6 +178,8 @@ void ui_memedit_load_settings(ui_memedit_t* ui, const ui_settings_t* settings);
     #define CHIPS_ASSERT(c) assert(c)
 #endif
 
+static void _ui_memedit_draw_search(void* win_ptr);
+
 /*== imgui_memory_editor.h (with additional layer dropdown) ==================*/
 
 // Mini memory editor for Dear ImGui (to embed in your game/tools)
@@ -603,6 +653,14 @@ struct MemoryEditor
         }
 
         /*--- BEGIN ui_memedit.h changes ---*/
+        ImGui::SameLine();
+        if (ImGui::Button("Search"))
+            ImGui::OpenPopup("search");
+        if (ImGui::BeginPopup("search"))
+        {
+            _ui_memedit_draw_search(mem_data);
+            ImGui::EndPopup();
+        }
         if (OptShowAddrInput) {
         /*--- END ui_memedit.h changes ---*/
             ImGui::SameLine();
@@ -900,6 +958,219 @@ static void _ui_memedit_writefn(uint8_t* ptr, size_t off, uint8_t val) {
     }
 }
 
+static int _ui_memedit_num_layers(const ui_memedit_t* win) {
+    return (win->ed->NumLayers > 0) ? win->ed->NumLayers : 1;
+}
+
+/* read a complete layer, in one call if a bulk read callback is provided */
+static void _ui_memedit_read_layer(ui_memedit_t* win, int layer, uint8_t* dst) {
+    if (win->read_range_cb) {
+        win->read_range_cb(layer, 0, dst, win->max_addr, win->user_data);
+    }
+    else if (win->read_cb) {
+        for (size_t addr = 0; addr < win->max_addr; addr++) {
+            dst[addr] = win->read_cb(layer, (uint16_t)addr, win->user_data);
+        }
+    }
+    else {
+        memset(dst, 0, win->max_addr);
+    }
+}
+
+static uint8_t* _ui_memedit_scratch(ui_memedit_t* win) {
+    if (0 == win->search.scratch) {
+        win->search.scratch = new uint8_t[win->max_addr];
+    }
+    return win->search.scratch;
+}
+
+static void _ui_memedit_clear_matches(ui_memedit_t* win, int match_len) {
+    win->search.match_len = match_len;
+    win->search.num_matches = 0;
+    win->search.overflow = false;
+}
+
+static bool _ui_memedit_add_match(ui_memedit_t* win, int layer, size_t addr) {
+    if (win->search.num_matches < UI_MEMEDIT_MAX_MATCHES) {
+        ui_memedit_match_t* m = &win->search.matches[win->search.num_matches++];
+        m->layer = layer;
+        m->addr = (uint16_t)addr;
+        return true;
+    }
+    else {
+        win->search.overflow = true;
+        return false;
+    }
+}
+
+/* memchr() is usually vectorized, use it to skip to the candidates for the first pattern byte */
+static void _ui_memedit_find_pattern(ui_memedit_t* win, int layer, const uint8_t* buf, size_t size, const uint8_t* pattern, size_t len) {
+    if (len > size) {
+        return;
+    }
+    const uint8_t* end = buf + size - len + 1;
+    const uint8_t* ptr = buf;
+    while (ptr < end) {
+        ptr = (const uint8_t*) memchr(ptr, pattern[0], (size_t)(end - ptr));
+        if (0 == ptr) {
+            break;
+        }
+        if (0 == memcmp(ptr, pattern, len)) {
+            if (!_ui_memedit_add_match(win, layer, (size_t)(ptr - buf))) {
+                return;
+            }
+        }
+        ptr++;
+    }
+}
+
+/* compare 8 bytes at a time, only check the individual bytes of differing words */
+static void _ui_memedit_find_changes(ui_memedit_t* win, int layer, const uint8_t* cur, const uint8_t* old, size_t size) {
+    size_t i = 0;
+    for (; (i + 8) <= size; i += 8) {
+        uint64_t a, b;
+        memcpy(&a, cur + i, 8);
+        memcpy(&b, old + i, 8);
+        if (a != b) {
+            for (size_t j = i; j < (i + 8); j++) {
+                if ((cur[j] != old[j]) && !_ui_memedit_add_match(win, layer, j)) {
+                    return;
+                }
+            }
+        }
+    }
+    for (; i < size; i++) {
+        if ((cur[i] != old[i]) && !_ui_memedit_add_match(win, layer, i)) {
+            return;
+        }
+    }
+}
+
+int ui_memedit_search(ui_memedit_t* win, const uint8_t* pattern, int num_bytes, bool all_layers) {
+    CHIPS_ASSERT(win && win->valid && pattern && (num_bytes > 0) && (num_bytes <= UI_MEMEDIT_MAX_PATTERN));
+    _ui_memedit_clear_matches(win, num_bytes);
+    uint8_t* buf = _ui_memedit_scratch(win);
+    const int first_layer = all_layers ? 0 : win->ed->CurLayer;
+    const int last_layer = all_layers ? (_ui_memedit_num_layers(win) - 1) : win->ed->CurLayer;
+    for (int layer = first_layer; (layer <= last_layer) && !win->search.overflow; layer++) {
+        _ui_memedit_read_layer(win, layer, buf);
+        _ui_memedit_find_pattern(win, layer, buf, win->max_addr, pattern, (size_t)num_bytes);
+    }
+    return win->search.num_matches;
+}
+
+void ui_memedit_take_snapshot(ui_memedit_t* win) {
+    CHIPS_ASSERT(win && win->valid);
+    const int num_layers = _ui_memedit_num_layers(win);
+    if (0 == win->search.snapshot) {
+        win->search.snapshot = new uint8_t[win->max_addr * (size_t)num_layers];
+    }
+    for (int layer = 0; layer < num_layers; layer++) {
+        _ui_memedit_read_layer(win, layer, win->search.snapshot + (size_t)layer * win->max_addr);
+    }
+}
+
+int ui_memedit_diff(ui_memedit_t* win, bool all_layers, bool update_snapshot) {
+    CHIPS_ASSERT(win && win->valid);
+    _ui_memedit_clear_matches(win, 1);
+    if (0 == win->search.snapshot) {
+        ui_memedit_take_snapshot(win);
+        return 0;
+    }
+    uint8_t* buf = _ui_memedit_scratch(win);
+    const int first_layer = all_layers ? 0 : win->ed->CurLayer;
+    const int last_layer = all_layers ? (_ui_memedit_num_layers(win) - 1) : win->ed->CurLayer;
+    for (int layer = first_layer; layer <= last_layer; layer++) {
+        uint8_t* old = win->search.snapshot + (size_t)layer * win->max_addr;
+        _ui_memedit_read_layer(win, layer, buf);
+        if (!win->search.overflow) {
+            _ui_memedit_find_changes(win, layer, buf, old, win->max_addr);
+        }
+        if (update_snapshot) {
+            memcpy(old, buf, win->max_addr);
+        }
+    }
+    return win->search.num_matches;
+}
+
+/* parse hex bytes separated by optional spaces, returns number of bytes */
+static int _ui_memedit_parse_pattern(const char* str, uint8_t* dst) {
+    int num_bytes = 0;
+    int num_digits = 0;
+    for (const char* c = str; *c && (num_bytes < UI_MEMEDIT_MAX_PATTERN); c++) {
+        int nibble;
+        if ((*c >= '0') && (*c <= '9')) { nibble = *c - '0'; }
+        else if ((*c >= 'A') && (*c <= 'F')) { nibble = *c - 'A' + 10; }
+        else if ((*c >= 'a') && (*c <= 'f')) { nibble = *c - 'a' + 10; }
+        else {
+            // any other character terminates the current byte
+            if (num_digits > 0) { num_bytes++; num_digits = 0; }
+            continue;
+        }
+        dst[num_bytes] = (uint8_t)((num_digits == 0) ? nibble : ((dst[num_bytes] << 4) | nibble));
+        if (++num_digits == 2) { num_bytes++; num_digits = 0; }
+    }
+    if ((num_digits > 0) && (num_bytes < UI_MEMEDIT_MAX_PATTERN)) {
+        num_bytes++;
+    }
+    return num_bytes;
+}
+
+static void _ui_memedit_draw_search(void* win_ptr) {
+    /* the "data ptr" of the memory editor is the ui_memedit_t pointer */
+    ui_memedit_t* win = (ui_memedit_t*) win_ptr;
+    CHIPS_ASSERT(win && win->ed);
+    MemoryEditor* ed = win->ed;
+    ImGui::SetNextItemWidth(200.0f);
+    bool find = ImGui::InputText("Bytes", win->search.pattern_text, sizeof(win->search.pattern_text), ImGuiInputTextFlags_EnterReturnsTrue);
+    if (_ui_memedit_num_layers(win) > 1) {
+        ImGui::Checkbox("All Layers", &win->search.all_layers);
+    }
+    find |= ImGui::Button("Find");
+    if (find) {
+        uint8_t pattern[UI_MEMEDIT_MAX_PATTERN];
+        const int num_bytes = _ui_memedit_parse_pattern(win->search.pattern_text, pattern);
+        if (num_bytes > 0) {
+            ui_memedit_search(win, pattern, num_bytes, win->search.all_layers);
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Snapshot")) {
+        ui_memedit_take_snapshot(win);
+        _ui_memedit_clear_matches(win, 1);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Changed")) {
+        ui_memedit_diff(win, win->search.all_layers, win->search.update_snapshot);
+    }
+    ImGui::SameLine();
+    ImGui::Checkbox("Update Snapshot", &win->search.update_snapshot);
+    ImGui::Text("%d matches%s", win->search.num_matches, win->search.overflow ? " (list is full)" : "");
+    ImGui::BeginChild("##matches", ImVec2(0, 10 * ImGui::GetTextLineHeightWithSpacing()), true);
+    ImGuiListClipper clipper;
+    clipper.Begin(win->search.num_matches);
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+            const ui_memedit_match_t* m = &win->search.matches[i];
+            const uint8_t val = win->read_cb ? win->read_cb(m->layer, m->addr, win->user_data) : 0;
+            ImGui::PushID(i);
+            char str[64];
+            if (_ui_memedit_num_layers(win) > 1) {
+                snprintf(str, sizeof(str), "%s: %04X = %02X", ed->Layers[m->layer], m->addr, val);
+            }
+            else {
+                snprintf(str, sizeof(str), "%04X = %02X", m->addr, val);
+            }
+            if (ImGui::Selectable(str)) {
+                ed->CurLayer = m->layer;
+                ed->GotoAddrAndHighlight(m->addr, m->addr + (size_t)win->search.match_len);
+            }
+            ImGui::PopID();
+        }
+    }
+    ImGui::EndChild();
+}
+
 void ui_memedit_init(ui_memedit_t* win, const ui_memedit_desc_t* desc) {
     CHIPS_ASSERT(win && desc);
     CHIPS_ASSERT(desc->title);
@@ -908,12 +1179,15 @@ void ui_memedit_init(ui_memedit_t* win, const ui_memedit_desc_t* desc) {
     win->title = desc->title;
     win->read_cb = desc->read_cb;
     win->write_cb = desc->write_cb;
+    win->read_range_cb = desc->read_range_cb;
     win->user_data = desc->user_data;
     win->init_x = (float) desc->x;
     win->init_y = (float) desc->y;
     win->init_w = (float) ((desc->w == 0) ? 512 : desc->w);
     win->init_h = (float) ((desc->h == 0) ? 120 : desc->h);
     win->max_addr = (desc->max_addr == 0) ? (1<<16) : desc->max_addr;
+    CHIPS_ASSERT(win->max_addr <= (1<<16));
+    win->search.update_snapshot = true;
     win->open = win->last_open = desc->open;
     win->ed = new MemoryEditor;
     win->ed->Cols = (desc->num_cols == 0) ? win->ed->Cols : desc->num_cols;
@@ -939,6 +1213,8 @@ void ui_memedit_init(ui_memedit_t* win, const ui_memedit_desc_t* desc) {
 void ui_memedit_discard(ui_memedit_t* win) {
     CHIPS_ASSERT(win && win->ed && win->valid);
     delete win->ed; win->ed = nullptr;
+    delete[] win->search.scratch; win->search.scratch = nullptr;
+    delete[] win->search.snapshot; win->search.snapshot = nullptr;
     win->valid = false;
 }
 
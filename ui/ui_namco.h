@@ -381,6 +381,7 @@ chips_debug_t ui_namco_get_debug(ui_namco_t* ui) {
     res.callback.func = (chips_debug_func_t)ui_dbg_tick;
     res.callback.user_data = &ui->dbg;
     res.stopped = &ui->dbg.dbg.stopped;
+    res.filter = &ui->dbg.dbg.filter;
     return res;
 }
 
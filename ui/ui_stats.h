@@ -0,0 +1,158 @@
+#pragma once
+/*#
+    # ui_stats.h
+
+    Display the per-frame statistics counters of a system emulator
+    (see the 'Statistics' section in chips_common.h).
+
+    Do this:
+    ~~~C
+    #define CHIPS_UI_IMPL
+    ~~~
+    before you include this file in *one* C++ file to create the
+    implementation.
+
+    Optionally provide the following macros with your own implementation
+
+    ~~~C
+    CHIPS_ASSERT(c)
+    ~~~
+        your own assert macro (default: assert(c))
+
+    Include the following headers before including the *implementation*:
+        - imgui.h
+        - ui_settings.h
+
+    The counters are only updated by the emulators when CHIPS_STATS is
+    defined, otherwise the window shows a hint instead of the counters.
+
+    All string data provided to the ui_stats_init() must remain alive until
+    until ui_stats_discard() is called!
+
+    ## zlib/libpng license
+
+    Copyright (c) 2024 Andre Weissflog
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* setup parameters for ui_stats_init()
+    NOTE: all string data must remain alive until ui_stats_discard()!
+*/
+typedef struct {
+    const char* title;          /* window title */
+    int x, y;                   /* initial window position */
+    int w, h;                   /* initial window size or zero for default size */
+    bool open;                  /* initial open state */
+} ui_stats_desc_t;
+
+/* a single counter to display, the first item is expected to be the number of ticks */
+typedef struct {
+    const char* label;
+    uint32_t value;
+} ui_stats_item_t;
+
+typedef struct {
+    const char* title;
+    float init_x, init_y;
+    float init_w, init_h;
+    bool open;
+    bool last_open;
+    bool valid;
+} ui_stats_t;
+
+void ui_stats_init(ui_stats_t* win, const ui_stats_desc_t* desc);
+void ui_stats_discard(ui_stats_t* win);
+void ui_stats_draw(ui_stats_t* win, const ui_stats_item_t* items, int num_items);
+void ui_stats_save_settings(ui_stats_t* win, ui_settings_t* settings);
+void ui_stats_load_settings(ui_stats_t* win, const ui_settings_t* settings);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/*-- IMPLEMENTATION (include in C++ source) ----------------------------------*/
+#ifdef CHIPS_UI_IMPL
+#ifndef __cplusplus
+#error "implementation must be compiled as C++"
+#endif
+#include <string.h> /* memset */
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+void ui_stats_init(ui_stats_t* win, const ui_stats_desc_t* desc) {
+    CHIPS_ASSERT(win && desc);
+    CHIPS_ASSERT(desc->title);
+    memset(win, 0, sizeof(ui_stats_t));
+    win->title = desc->title;
+    win->init_x = (float) desc->x;
+    win->init_y = (float) desc->y;
+    win->init_w = (float) ((desc->w == 0) ? 320 : desc->w);
+    win->init_h = (float) ((desc->h == 0) ? 200 : desc->h);
+    win->open = win->last_open = desc->open;
+    win->valid = true;
+}
+
+void ui_stats_discard(ui_stats_t* win) {
+    CHIPS_ASSERT(win && win->valid);
+    win->valid = false;
+}
+
+void ui_stats_draw(ui_stats_t* win, const ui_stats_item_t* items, int num_items) {
+    CHIPS_ASSERT(win && win->valid && win->title);
+    CHIPS_ASSERT(items && (num_items > 0));
+    ui_util_handle_window_open_dirty(&win->open, &win->last_open);
+    if (!win->open) {
+        return;
+    }
+    ImGui::SetNextWindowPos(ImVec2(win->init_x, win->init_y), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(win->init_w, win->init_h), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin(win->title, &win->open)) {
+        #if defined(CHIPS_STATS)
+        // all counters are also shown relative to the number of ticks in the first item
+        const uint32_t ticks = items[0].value;
+        for (int i = 0; i < num_items; i++) {
+            if ((i > 0) && (ticks > 0)) {
+                ImGui::Text("%-24s %8u (%5.1f%%)", items[i].label, items[i].value, (100.0f * items[i].value) / ticks);
+            }
+            else {
+                ImGui::Text("%-24s %8u", items[i].label, items[i].value);
+            }
+        }
+        #else
+        ImGui::Text("Statistics are disabled, define CHIPS_STATS to enable.");
+        #endif
+    }
+    ImGui::End();
+}
+
+void ui_stats_save_settings(ui_stats_t* win, ui_settings_t* settings) {
+    CHIPS_ASSERT(win && settings);
+    ui_settings_add(settings, win->title, win->open);
+}
+
+void ui_stats_load_settings(ui_stats_t* win, const ui_settings_t* settings) {
+    CHIPS_ASSERT(win && settings);
+    win->open = ui_settings_isopen(settings, win->title);
+}
+#endif /* CHIPS_UI_IMPL */
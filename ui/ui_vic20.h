@@ -75,6 +75,7 @@ typedef struct {
     ui_vic20_boot_cb boot_cb;   // reboot callback function
     ui_dbg_texture_callbacks_t dbg_texture;     // user-provided texture create/update/destroy callbacks
     ui_dbg_keys_desc_t dbg_keys;    // user-defined hotkeys for ui_dbg_t
+    ui_dbg_rewind_callbacks_t dbg_rewind; // optional reverse stepping callbacks for ui_dbg_t
     ui_snapshot_desc_t snapshot;    // snapshot ui setup params
 } ui_vic20_desc_t;
 
@@ -419,6 +420,7 @@ void ui_vic20_init(ui_vic20_t* ui, const ui_vic20_desc_t* ui_desc) {
         desc.break_cb = _ui_vic20_eval_bp;
         desc.texture_cbs = ui_desc->dbg_texture;
         desc.keys = ui_desc->dbg_keys;
+        desc.rewind_cbs = ui_desc->dbg_rewind;
         desc.user_data = ui;
         /* custom breakpoint types */
         desc.user_breaktypes[0].label = "Scanline at";
@@ -634,6 +636,7 @@ chips_debug_t ui_vic20_get_debug(ui_vic20_t* ui) {
     res.callback.func = (chips_debug_func_t)ui_dbg_tick;
     res.callback.user_data = &ui->dbg;
     res.stopped = &ui->dbg.dbg.stopped;
+    res.filter = &ui->dbg.dbg.filter;
     return res;
 }
 
@@ -68,6 +68,7 @@ typedef struct {
     ui_z1013_boot_t boot_cb; // user-provided callback to reboot to different config
     ui_dbg_texture_callbacks_t dbg_texture; // user-provided texture create/update/destroy callbacks
     ui_dbg_keys_desc_t dbg_keys;            // user-defined hotkeys for ui_dbg_t
+    ui_dbg_rewind_callbacks_t dbg_rewind;   // optional reverse stepping callbacks for ui_dbg_t
     ui_snapshot_desc_t snapshot;    // snapshot system creation params
 } ui_z1013_desc_t;
 
@@ -296,6 +297,7 @@ void ui_z1013_init(ui_z1013_t* ui, const ui_z1013_desc_t* ui_desc) {
         desc.read_cb = _ui_z1013_mem_read;
         desc.texture_cbs = ui_desc->dbg_texture;
         desc.keys = ui_desc->dbg_keys;
+        desc.rewind_cbs = ui_desc->dbg_rewind;
         desc.user_data = ui->z1013;
         ui_dbg_init(&ui->dbg, &desc);
     }
@@ -400,6 +402,7 @@ chips_debug_t ui_z1013_get_debug(ui_z1013_t* ui) {
     res.callback.func = (chips_debug_func_t)ui_dbg_tick;
     res.callback.user_data = &ui->dbg;
     res.stopped = &ui->dbg.dbg.stopped;
+    res.filter = &ui->dbg.dbg.filter;
     return res;
 }
 
@@ -124,6 +124,7 @@ void ui_z80_discard(ui_z80_t* win) {
 
 static void _ui_z80_regs(ui_z80_t* win) {
     z80_t* cpu = win->cpu;
+    z80_sync_flags(cpu);
     ImGui::Text("AF: %04X  AF': %04X", cpu->af, cpu->af2);
     ImGui::Text("BC: %04X  BC': %04X", cpu->bc, cpu->bc2);
     ImGui::Text("DE: %04X  DE': %04X", cpu->de, cpu->de2);
@@ -198,6 +198,7 @@ void ui_z80ctc_draw(ui_z80ctc_t* win) {
         ImGui::EndChild();
         ImGui::SameLine();
         ImGui::BeginChild("##ctc_vals", ImVec2(0, 0), true);
+        z80ctc_sync(win->ctc);
         _ui_z80ctc_channels(win);
         ImGui::EndChild();
     }
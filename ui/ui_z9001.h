@@ -71,6 +71,7 @@ typedef struct {
     ui_z9001_boot_t boot_cb; // user-provided callback to reboot to different config
     ui_dbg_texture_callbacks_t dbg_texture; // user-provided texture create/update/destroy callbacks
     ui_dbg_keys_desc_t dbg_keys;        // user-defined hotkeys for ui_dbg_t
+    ui_dbg_rewind_callbacks_t dbg_rewind; // optional reverse stepping callbacks for ui_dbg_t
     ui_snapshot_desc_t snapshot;        // snapshot system creation params
 } ui_z9001_desc_t;
 
@@ -334,6 +335,7 @@ void ui_z9001_init(ui_z9001_t* ui, const ui_z9001_desc_t* ui_desc) {
         desc.read_cb = _ui_z9001_mem_read;
         desc.texture_cbs = ui_desc->dbg_texture;
         desc.keys = ui_desc->dbg_keys;
+        desc.rewind_cbs = ui_desc->dbg_rewind;
         desc.user_data = ui->z9001;
         ui_dbg_init(&ui->dbg, &desc);
     }
@@ -482,6 +484,7 @@ chips_debug_t ui_z9001_get_debug(ui_z9001_t* ui) {
     res.callback.func = (chips_debug_func_t)ui_dbg_tick;
     res.callback.user_data = &ui->dbg;
     res.stopped = &ui->dbg.dbg.stopped;
+    res.filter = &ui->dbg.dbg.filter;
     return res;
 }
 
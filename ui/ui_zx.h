@@ -69,6 +69,7 @@ typedef struct {
     ui_zx_boot_t boot_cb; // user-provided callback to reboot to different config
     ui_dbg_texture_callbacks_t dbg_texture; // user-provided texture create/update/destroy callbacks
     ui_dbg_keys_desc_t dbg_keys;            // user-defined hotkeys for ui_dbg_t
+    ui_dbg_rewind_callbacks_t dbg_rewind;   // optional reverse stepping callbacks for ui_dbg_t
     ui_snapshot_desc_t snapshot;            // snapshot system creation params
 } ui_zx_desc_t;
 
@@ -230,7 +231,7 @@ static uint8_t* _ui_zx_memptr(zx_t* zx, int layer, uint16_t addr) {
     if (0 == layer) {
         /* ZX128 ROM, RAM 5, RAM 2, RAM 0 */
         if (addr < 0x4000) {
-            return &zx->rom[0][addr];
+            return (uint8_t*) &zx->rom[0][addr];
         }
         else if (addr < 0x8000) {
             return &zx->ram[5][addr - 0x4000];
@@ -245,7 +246,7 @@ static uint8_t* _ui_zx_memptr(zx_t* zx, int layer, uint16_t addr) {
     else if (1 == layer) {
         /* 48K ROM, RAM 1 */
         if (addr < 0x4000) {
-            return &zx->rom[1][addr];
+            return (uint8_t*) &zx->rom[1][addr];
         }
         else if (addr >= 0xC000) {
             return &zx->ram[1][addr - 0xC000];
@@ -285,6 +286,12 @@ static void _ui_zx_mem_write(int layer, uint16_t addr, uint8_t data, void* user_
         mem_wr(&zx->mem, addr, data);
     }
     else {
+        #if defined(ZX_BORROWED_ROMS)
+        /* borrowed ROM images are read-only */
+        if (((layer-1) < 2) && (addr < 0x4000)) {
+            return;
+        }
+        #endif
         uint8_t* ptr = _ui_zx_memptr(zx, layer-1, addr);
         if (ptr) {
             *ptr = data;
@@ -367,6 +374,7 @@ void ui_zx_init(ui_zx_t* ui, const ui_zx_desc_t* ui_desc) {
         desc.read_cb = _ui_zx_mem_read;
         desc.texture_cbs = ui_desc->dbg_texture;
         desc.keys = ui_desc->dbg_keys;
+        desc.rewind_cbs = ui_desc->dbg_rewind;
         desc.user_data = ui->zx;
         ui_dbg_init(&ui->dbg, &desc);
     }
@@ -512,6 +520,7 @@ chips_debug_t ui_zx_get_debug(ui_zx_t* ui) {
     res.callback.func = (chips_debug_func_t)ui_dbg_tick;
     res.callback.user_data = &ui->dbg;
     res.stopped = &ui->dbg.dbg.stopped;
+    res.filter = &ui->dbg.dbg.filter;
     return res;
 }
 
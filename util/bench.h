@@ -0,0 +1,338 @@
+#pragma once
+/*#
+    # bench.h
+
+    Measure the emulation throughput of chip tick functions and system
+    emulators and write the results as JSON.
+
+    Do this:
+    ~~~C
+    #define CHIPS_UTIL_IMPL
+    ~~~
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Optionally provide the following macros with your own implementation
+
+    ~~~C
+    CHIPS_ASSERT(c)
+    ~~~
+        your own assert macro (default: assert(c))
+
+    ## Overview
+
+    A benchmark is a function which runs a piece of emulation code for a
+    while and returns the number of emulated clock ticks it executed. The
+    benchmark function is called repeatedly until a minimum amount of host
+    time has passed, and the result is reported as emulated MHz per host
+    core, and (if the emulated clock frequency is known) as a multiple of
+    the original hardware's speed.
+
+    Since the results are only meaningful when compared to other runs on
+    the same host, the JSON output is meant to be stored and compared
+    release over release (for instance by the chips-test project) rather
+    than read by humans.
+
+    ## Usage
+
+    For a chip, the benchmark function ticks the chip with a minimal
+    environment, for instance a Z80 running from 64 KBytes of RAM:
+
+    ~~~C
+    static struct { z80_t cpu; uint64_t pins; uint8_t mem[1<<16]; } z80_bench;
+
+    static uint64_t bench_z80_tick(void* user_data) {
+        (void)user_data;
+        uint64_t pins = z80_bench.pins;
+        for (int i = 0; i < 100000; i++) {
+            pins = z80_tick(&z80_bench.cpu, pins);
+            if (pins & Z80_MREQ) {
+                const uint16_t addr = Z80_GET_ADDR(pins);
+                if (pins & Z80_RD) {
+                    Z80_SET_DATA(pins, z80_bench.mem[addr]);
+                }
+                else if (pins & Z80_WR) {
+                    z80_bench.mem[addr] = Z80_GET_DATA(pins);
+                }
+            }
+        }
+        z80_bench.pins = pins;
+        return 100000;
+    }
+    ~~~
+
+    For a system emulator, the ROM images can be replaced with synthetic
+    ROMs (e.g. a small loop which writes to video memory) so that the
+    benchmark doesn't depend on copyrighted data, and xxx_exec() already
+    returns the number of executed ticks:
+
+    ~~~C
+    static uint64_t bench_zx_exec(void* user_data) {
+        return zx_exec((zx_t*)user_data, 20000);
+    }
+    ~~~
+
+    Run the benchmarks and write the results:
+
+    ~~~C
+    bench_t bench;
+    bench_init(&bench, &(bench_desc_t){ .min_seconds = 1.0 });
+    bench_run(&bench, "z80_tick", bench_z80_tick, 0, 4000000);
+    bench_run(&bench, "zx_exec", bench_zx_exec, &zx, ZX48K_FREQUENCY);
+    char json[4096];
+    bench_json(&bench, json, sizeof(json));
+    puts(json);
+    ~~~
+
+    The JSON output looks like this:
+
+    ~~~
+    {"results":[
+      {"name":"z80_tick","ticks":123400000,"seconds":1.0012,"mhz":123.25,"realtime":30.81},
+      {"name":"zx_exec","ticks":987650000,"seconds":1.0003,"mhz":987.35,"realtime":281.93}
+    ]}
+    ~~~
+
+    ## Struct Layouts
+
+    When running many emulator instances per host core, the cache misses
+    on the per-tick state of each instance limit the throughput more than
+    the emulation code itself. The system headers keep this state at the
+    start of their structs and define its size in a macro (for instance
+    C64_HOT_SIZE in c64.h), which can be recorded next to the benchmark
+    results to catch layout regressions:
+
+    ~~~C
+    bench_layout(&bench, "c64_t", sizeof(c64_t), C64_HOT_SIZE);
+    ~~~
+
+    The layouts are written after the results, with the number of 64-byte
+    cache lines covered by the hot state:
+
+    ~~~
+    {"results":[
+      ...
+    ],"layouts":[
+      {"name":"c64_t","size":1023680,"hot_size":10024,"hot_lines":157}
+    ]}
+    ~~~
+
+    ## Functions
+
+    ~~~C
+    void bench_init(bench_t* bench, const bench_desc_t* desc)
+    ~~~
+        Initialize a bench_t instance.
+
+        ~~~C
+        typedef struct {
+            double min_seconds;     // minimum host time per benchmark (default: 1.0)
+            int max_calls;          // maximum number of calls per benchmark (default: unlimited)
+        } bench_desc_t;
+        ~~~
+
+    ~~~C
+    bench_result_t bench_run(bench_t* bench, const char* name, bench_func_t func, void* user_data, uint64_t tick_hz)
+    ~~~
+        Call func() with user_data until the minimum host time has passed,
+        record and return the result. The tick_hz parameter is the emulated
+        clock frequency used to compute the realtime factor (or 0 if the
+        realtime factor is not meaningful). The name string must remain
+        alive until the bench_t instance is no longer used.
+
+    ~~~C
+    void bench_layout(bench_t* bench, const char* name, size_t size, size_t hot_size)
+    ~~~
+        Record the size of a struct and the size of the per-tick state at
+        its start. The name string must remain alive until the bench_t
+        instance is no longer used.
+
+    ~~~C
+    int bench_json(const bench_t* bench, char* buf, int buf_size)
+    ~~~
+        Write all recorded results and layouts as JSON into buf (as a zero-terminated
+        string). Returns the length of the JSON string, which may be bigger
+        than buf_size - 1 if the buffer was too small (the output is then
+        truncated, similar to snprintf()).
+
+    ## zlib/libpng license
+
+    Copyright (c) 2018 Andre Weissflog
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BENCH_MAX_RESULTS (64)
+#define BENCH_MAX_LAYOUTS (16)
+
+// a benchmark function, returns the number of emulated ticks executed
+typedef uint64_t (*bench_func_t)(void* user_data);
+
+typedef struct {
+    double min_seconds;     // minimum host time per benchmark (default: 1.0)
+    int max_calls;          // maximum number of calls per benchmark (default: unlimited)
+} bench_desc_t;
+
+typedef struct {
+    const char* name;
+    uint64_t ticks;         // number of emulated ticks
+    uint64_t tick_hz;       // emulated clock frequency, or 0
+    double seconds;         // host time in seconds
+    double mhz;             // emulated MHz per host core
+    double realtime;        // multiple of realtime speed, or 0 if tick_hz is 0
+} bench_result_t;
+
+typedef struct {
+    const char* name;
+    uint64_t size;          // size of the struct in bytes
+    uint64_t hot_size;      // size of the per-tick state at the start of the struct
+} bench_layout_t;
+
+typedef struct {
+    bool valid;
+    double min_seconds;
+    int max_calls;
+    int num_results;
+    bench_result_t results[BENCH_MAX_RESULTS];
+    int num_layouts;
+    bench_layout_t layouts[BENCH_MAX_LAYOUTS];
+} bench_t;
+
+void bench_init(bench_t* bench, const bench_desc_t* desc);
+bench_result_t bench_run(bench_t* bench, const char* name, bench_func_t func, void* user_data, uint64_t tick_hz);
+void bench_layout(bench_t* bench, const char* name, size_t size, size_t hot_size);
+int bench_json(const bench_t* bench, char* buf, int buf_size);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_UTIL_IMPL
+#include <string.h> // memset
+#include <stdio.h>  // snprintf
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+// host time in seconds from a monotonic clock
+static double _bench_now(void) {
+    #if defined(_WIN32)
+        LARGE_INTEGER freq, count;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&count);
+        return (double)count.QuadPart / (double)freq.QuadPart;
+    #else
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (double)ts.tv_sec + (double)ts.tv_nsec * 1.0e-9;
+    #endif
+}
+
+void bench_init(bench_t* bench, const bench_desc_t* desc) {
+    CHIPS_ASSERT(bench && desc);
+    CHIPS_ASSERT((desc->min_seconds >= 0.0) && (desc->max_calls >= 0));
+    memset(bench, 0, sizeof(bench_t));
+    bench->valid = true;
+    bench->min_seconds = (desc->min_seconds == 0.0) ? 1.0 : desc->min_seconds;
+    bench->max_calls = desc->max_calls;
+}
+
+bench_result_t bench_run(bench_t* bench, const char* name, bench_func_t func, void* user_data, uint64_t tick_hz) {
+    CHIPS_ASSERT(bench && bench->valid && name && func);
+    CHIPS_ASSERT(bench->num_results < BENCH_MAX_RESULTS);
+    uint64_t ticks = 0;
+    int num_calls = 0;
+    const double start = _bench_now();
+    double seconds = 0.0;
+    do {
+        ticks += func(user_data);
+        num_calls++;
+        seconds = _bench_now() - start;
+    } while ((seconds < bench->min_seconds) && ((bench->max_calls == 0) || (num_calls < bench->max_calls)));
+
+    bench_result_t res = {
+        .name = name,
+        .ticks = ticks,
+        .tick_hz = tick_hz,
+        .seconds = seconds,
+    };
+    if (seconds > 0.0) {
+        res.mhz = ((double)ticks / seconds) * 1.0e-6;
+        if (tick_hz > 0) {
+            res.realtime = (double)ticks / (seconds * (double)tick_hz);
+        }
+    }
+    bench->results[bench->num_results++] = res;
+    return res;
+}
+
+void bench_layout(bench_t* bench, const char* name, size_t size, size_t hot_size) {
+    CHIPS_ASSERT(bench && bench->valid && name && (hot_size <= size));
+    CHIPS_ASSERT(bench->num_layouts < BENCH_MAX_LAYOUTS);
+    bench_layout_t* layout = &bench->layouts[bench->num_layouts++];
+    layout->name = name;
+    layout->size = size;
+    layout->hot_size = hot_size;
+}
+
+int bench_json(const bench_t* bench, char* buf, int buf_size) {
+    CHIPS_ASSERT(bench && bench->valid && buf && (buf_size > 0));
+    int pos = 0;
+    #define _BENCH_PRINT(...) { int n = snprintf(buf + ((pos < buf_size) ? pos : buf_size - 1), (size_t)((pos < buf_size) ? (buf_size - pos) : 1), __VA_ARGS__); if (n > 0) { pos += n; } }
+    _BENCH_PRINT("{\"results\":[\n");
+    for (int i = 0; i < bench->num_results; i++) {
+        const bench_result_t* res = &bench->results[i];
+        _BENCH_PRINT("  {\"name\":\"%s\",\"ticks\":%llu,\"seconds\":%.4f,\"mhz\":%.2f,\"realtime\":%.2f}%s\n",
+            res->name,
+            (unsigned long long)res->ticks,
+            res->seconds,
+            res->mhz,
+            res->realtime,
+            (i < (bench->num_results - 1)) ? "," : "");
+    }
+    if (bench->num_layouts > 0) {
+        _BENCH_PRINT("],\"layouts\":[\n");
+        for (int i = 0; i < bench->num_layouts; i++) {
+            const bench_layout_t* layout = &bench->layouts[i];
+            _BENCH_PRINT("  {\"name\":\"%s\",\"size\":%llu,\"hot_size\":%llu,\"hot_lines\":%llu}%s\n",
+                layout->name,
+                (unsigned long long)layout->size,
+                (unsigned long long)layout->hot_size,
+                (unsigned long long)((layout->hot_size + 63) / 64),
+                (i < (bench->num_layouts - 1)) ? "," : "");
+        }
+    }
+    _BENCH_PRINT("]}\n");
+    #undef _BENCH_PRINT
+    return pos;
+}
+#endif /* CHIPS_UTIL_IMPL */
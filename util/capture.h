@@ -0,0 +1,679 @@
+#pragma once
+/*#
+    # capture.h
+
+    Capture the video and audio output of (headless) system emulator
+    instances into a compact chunked stream, the encoded chunks are passed
+    to a background writer thread through a bounded buffer.
+
+    Do this:
+    ~~~C
+    #define CHIPS_UTIL_IMPL
+    ~~~
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Optionally provide the following macros with your own implementation
+
+    ~~~C
+    CHIPS_ASSERT(c)
+    ~~~
+        your own assert macro (default: assert(c))
+
+    You need to include the following headers before including capture.h:
+
+    - chips/chips_common.h
+
+    On Windows the writer thread is a Win32 thread, everywhere else a
+    pthread (so you may need to link with -lpthread).
+
+    ## Overview
+
+    Copying and converting each full RGBA8 frame on the emulator thread is
+    expensive when many instances are recorded at the same time. Instead,
+    capture_frame() directly encodes the visible screen area of the
+    system's framebuffer (usually 8-bit palette indices) as a delta to the
+    previous frame: only lines which are flagged in the system's dirty line
+    bitmap (see 'Dirty Lines' in chips_common.h) are compared at all, and
+    only the changed bytes of changed lines are stored. capture_audio()
+    converts the audio samples to 16-bit PCM.
+
+    The encoded chunks are appended to a caller-provided ring buffer, and a
+    writer thread hands them to the write callback (which usually appends
+    them to a file). The emulator thread only waits for the writer thread
+    when the ring buffer is full (this is counted in capture_t.stalls),
+    the capture never allocates memory.
+
+    ## Usage
+
+    Provide the ring buffer, a buffer for the previous frame (at least
+    the size of the visible screen area in bytes), and the write callback
+    which is called on the writer thread:
+
+    ~~~C
+    static uint8_t ring_buffer[1024 * 1024];
+    static uint8_t prev_frame[512 * 512];
+
+    static void write_chunks(const void* data, size_t num_bytes, void* user_data) {
+        fwrite(data, 1, num_bytes, (FILE*)user_data);
+    }
+
+    capture_init(&cap, &(capture_desc_t){
+        .buffer = { .ptr = ring_buffer, .size = sizeof(ring_buffer) },
+        .prev_frame = { .ptr = prev_frame, .size = sizeof(prev_frame) },
+        .sample_rate = 44100,
+        .write_cb = write_chunks,
+        .user_data = fp,
+    });
+    ~~~
+
+    Use capture_audio_callback() as the system's audio callback:
+
+    ~~~C
+    zx_init(&sys, &(zx_desc_t){
+        .audio = {
+            .callback = { .func = capture_audio_callback, .user_data = &cap },
+            .sample_rate = 44100,
+        },
+        ...
+    });
+    ~~~
+
+    ...and call capture_frame() after each xxx_exec() call:
+
+    ~~~C
+    zx_exec(&sys, frame_time_us);
+    const chips_display_info_t info = zx_display_info(&sys);
+    capture_frame(&cap, &info);
+    ~~~
+
+    capture_discard() writes all pending chunks and stops the writer thread.
+    Use capture_flush() to wait until all pending chunks have been written
+    without stopping the capture.
+
+    ## Stream Format
+
+    The stream is a sequence of chunks, all values are little-endian. Each
+    chunk starts with a 32-bit FOURCC tag and a 32-bit payload size in bytes,
+    the chunks can be iterated with capture_next_chunk():
+
+    - CAPTURE_CHUNK_FORMAT ('CPFM'): the video format, written before the
+      first frame and whenever the format changes:
+        - u16 width and u16 height of the captured screen area in pixels
+        - u8 bytes per pixel (1: palette indices, 4: RGBA8)
+        - u8 flags (CAPTURE_FORMAT_PORTRAIT)
+        - u16 number of palette entries, followed by the palette entries as
+          32-bit RGBA8 values
+    - CAPTURE_CHUNK_FRAME ('CPFR'): a video frame:
+        - u32 frame number
+        - u8 flags (CAPTURE_FRAME_KEY if all lines are stored)
+        - a list of changed lines, each starting with a u16 line index,
+          the list ends with the line index 0xFFFF. If bit 15 of the line
+          index is set, the line follows as raw bytes, otherwise the line
+          follows as a list of (skip, count) pairs of variable-length
+          integers (7 bits per byte, bit 7 is set if more bytes follow)
+          up to the end of the line, 'skip' bytes are unchanged and
+          'count' changed bytes follow
+    - CAPTURE_CHUNK_AUDIO ('CPAU'): audio samples:
+        - u32 sample rate
+        - the mono samples as s16 values
+
+    capture_decode_frame() applies a frame chunk to the previous frame.
+
+    ## zlib/libpng license
+
+    Copyright (c) 2024 Andre Weissflog
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAPTURE_MAX_LINE_BYTES (4096)   // max bytes per captured line (width * bytes per pixel)
+#define CAPTURE_MAX_PALETTE (256)       // max number of palette entries
+#define CAPTURE_CHUNK_HEADER_SIZE (8)
+// max encoded size of a frame chunk
+#define CAPTURE_MAX_FRAME_SIZE(line_bytes, num_lines) (CAPTURE_CHUNK_HEADER_SIZE + 7 + (num_lines) * (2 + (line_bytes)))
+
+#define CAPTURE_CHUNK_FORMAT CHIPS_FOURCC('C','P','F','M')
+#define CAPTURE_CHUNK_FRAME CHIPS_FOURCC('C','P','F','R')
+#define CAPTURE_CHUNK_AUDIO CHIPS_FOURCC('C','P','A','U')
+
+#define CAPTURE_FORMAT_PORTRAIT (1<<0)  // format flags: the screen is displayed rotated
+#define CAPTURE_FRAME_KEY (1<<0)        // frame flags: all lines are stored as raw lines
+#define CAPTURE_LINE_RAW (0x8000)       // line index bit: raw line bytes follow
+#define CAPTURE_LINE_END (0xFFFF)       // line index which ends a frame
+
+// callback to write encoded chunks, called on the writer thread
+typedef void (*capture_write_t)(const void* data, size_t num_bytes, void* user_data);
+
+typedef struct {
+    chips_range_t buffer;       // ring buffer for encoded chunks
+    chips_range_t prev_frame;   // memory for the previous frame, at least width * height * bytes per pixel
+    int sample_rate;            // audio sample rate stored in audio chunks
+    int keyframe_interval;      // optional, store all lines every N frames (default: only the first frame)
+    capture_write_t write_cb;   // called on the writer thread with encoded chunks
+    void* user_data;            // user data for the write callback
+} capture_desc_t;
+
+// a chunk returned by capture_next_chunk()
+typedef struct {
+    uint32_t tag;               // CAPTURE_CHUNK_*
+    const uint8_t* payload;
+    uint32_t size;              // payload size in bytes
+} capture_chunk_t;
+
+typedef struct {
+    bool valid;
+    uint8_t* buffer;
+    size_t size;
+    uint8_t* prev_frame;
+    size_t prev_frame_size;
+    uint32_t sample_rate;
+    uint32_t keyframe_interval;
+    capture_write_t write_cb;
+    void* user_data;
+    // current video format
+    struct {
+        int width, height;
+        int bytes_per_pixel;
+        uint8_t flags;
+        const void* palette;
+        size_t palette_size;
+    } format;
+    uint32_t frame_count;
+    uint32_t stalls;            // number of times the emulator thread waited for the writer thread
+    uint64_t num_bytes;         // number of encoded bytes
+    // ring buffer state, protected by the lock
+    size_t read_pos;
+    size_t write_pos;
+    size_t used;
+    bool quit;
+    #if defined(_WIN32)
+    SRWLOCK lock;
+    CONDITION_VARIABLE data_cond;
+    CONDITION_VARIABLE space_cond;
+    HANDLE thread;
+    #else
+    pthread_mutex_t lock;
+    pthread_cond_t data_cond;
+    pthread_cond_t space_cond;
+    pthread_t thread;
+    #endif
+    uint8_t line_buf[CAPTURE_MAX_LINE_BYTES + 16];
+} capture_t;
+
+// initialize a capture and start the writer thread
+void capture_init(capture_t* cap, const capture_desc_t* desc);
+// write all pending chunks and stop the writer thread
+void capture_discard(capture_t* cap);
+// encode a video frame
+void capture_frame(capture_t* cap, const chips_display_info_t* info);
+// encode audio samples
+void capture_audio(capture_t* cap, const float* samples, int num_samples);
+// an audio callback for the system emulators, user_data is the capture_t pointer
+void capture_audio_callback(const float* samples, int num_samples, void* user_data);
+// wait until the writer thread has written all pending chunks
+void capture_flush(capture_t* cap);
+// get the next chunk of a stream at *inout_pos, returns false at the end of the stream
+bool capture_next_chunk(chips_range_t stream, size_t* inout_pos, capture_chunk_t* out_chunk);
+// apply a CAPTURE_CHUNK_FRAME chunk to a frame with the given line size and number of lines
+bool capture_decode_frame(const capture_chunk_t* chunk, uint8_t* frame, int line_bytes, int num_lines);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_UTIL_IMPL
+#include <string.h> // memset, memcpy, memcmp
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+#if defined(_WIN32)
+    #define _CAPTURE_LOCK(c) AcquireSRWLockExclusive(&(c)->lock)
+    #define _CAPTURE_UNLOCK(c) ReleaseSRWLockExclusive(&(c)->lock)
+    #define _CAPTURE_WAIT(c, cond) SleepConditionVariableSRW(&(c)->cond, &(c)->lock, INFINITE, 0)
+    #define _CAPTURE_BROADCAST(c, cond) WakeAllConditionVariable(&(c)->cond)
+#else
+    #define _CAPTURE_LOCK(c) pthread_mutex_lock(&(c)->lock)
+    #define _CAPTURE_UNLOCK(c) pthread_mutex_unlock(&(c)->lock)
+    #define _CAPTURE_WAIT(c, cond) pthread_cond_wait(&(c)->cond, &(c)->lock)
+    #define _CAPTURE_BROADCAST(c, cond) pthread_cond_broadcast(&(c)->cond)
+#endif
+
+static void _capture_writer_loop(capture_t* cap) {
+    while (true) {
+        _CAPTURE_LOCK(cap);
+        while ((0 == cap->used) && !cap->quit) {
+            _CAPTURE_WAIT(cap, data_cond);
+        }
+        const size_t pos = cap->read_pos;
+        const size_t num = cap->used;
+        _CAPTURE_UNLOCK(cap);
+        if (0 == num) {
+            // quit requested and all chunks written
+            break;
+        }
+        // the pending bytes may wrap around the end of the ring buffer
+        const size_t n0 = ((pos + num) <= cap->size) ? num : (cap->size - pos);
+        cap->write_cb(cap->buffer + pos, n0, cap->user_data);
+        if (n0 < num) {
+            cap->write_cb(cap->buffer, num - n0, cap->user_data);
+        }
+        _CAPTURE_LOCK(cap);
+        cap->read_pos = (pos + num) % cap->size;
+        cap->used -= num;
+        _CAPTURE_BROADCAST(cap, space_cond);
+        _CAPTURE_UNLOCK(cap);
+    }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI _capture_thread_func(LPVOID arg) {
+    _capture_writer_loop((capture_t*)arg);
+    return 0;
+}
+#else
+static void* _capture_thread_func(void* arg) {
+    _capture_writer_loop((capture_t*)arg);
+    return 0;
+}
+#endif
+
+void capture_init(capture_t* cap, const capture_desc_t* desc) {
+    CHIPS_ASSERT(cap && desc);
+    CHIPS_ASSERT(desc->buffer.ptr && (desc->buffer.size > 0));
+    CHIPS_ASSERT(desc->prev_frame.ptr && desc->write_cb);
+    memset(cap, 0, sizeof(capture_t));
+    cap->valid = true;
+    cap->buffer = (uint8_t*) desc->buffer.ptr;
+    cap->size = desc->buffer.size;
+    cap->prev_frame = (uint8_t*) desc->prev_frame.ptr;
+    cap->prev_frame_size = desc->prev_frame.size;
+    cap->sample_rate = (uint32_t) desc->sample_rate;
+    cap->keyframe_interval = (uint32_t) desc->keyframe_interval;
+    cap->write_cb = desc->write_cb;
+    cap->user_data = desc->user_data;
+    #if defined(_WIN32)
+    InitializeSRWLock(&cap->lock);
+    InitializeConditionVariable(&cap->data_cond);
+    InitializeConditionVariable(&cap->space_cond);
+    cap->thread = CreateThread(0, 0, _capture_thread_func, cap, 0, 0);
+    CHIPS_ASSERT(cap->thread);
+    #else
+    pthread_mutex_init(&cap->lock, 0);
+    pthread_cond_init(&cap->data_cond, 0);
+    pthread_cond_init(&cap->space_cond, 0);
+    int res = pthread_create(&cap->thread, 0, _capture_thread_func, cap);
+    CHIPS_ASSERT(0 == res); (void)res;
+    #endif
+}
+
+void capture_discard(capture_t* cap) {
+    CHIPS_ASSERT(cap && cap->valid);
+    _CAPTURE_LOCK(cap);
+    cap->quit = true;
+    _CAPTURE_BROADCAST(cap, data_cond);
+    _CAPTURE_UNLOCK(cap);
+    #if defined(_WIN32)
+    WaitForSingleObject(cap->thread, INFINITE);
+    CloseHandle(cap->thread);
+    #else
+    pthread_join(cap->thread, 0);
+    pthread_cond_destroy(&cap->space_cond);
+    pthread_cond_destroy(&cap->data_cond);
+    pthread_mutex_destroy(&cap->lock);
+    #endif
+    cap->valid = false;
+}
+
+void capture_flush(capture_t* cap) {
+    CHIPS_ASSERT(cap && cap->valid);
+    _CAPTURE_LOCK(cap);
+    while (cap->used > 0) {
+        _CAPTURE_WAIT(cap, space_cond);
+    }
+    _CAPTURE_UNLOCK(cap);
+}
+
+// wait until at least num_bytes are free in the ring buffer, returns the write position
+static size_t _capture_reserve(capture_t* cap, size_t num_bytes) {
+    CHIPS_ASSERT(num_bytes <= cap->size);
+    _CAPTURE_LOCK(cap);
+    if ((cap->size - cap->used) < num_bytes) {
+        cap->stalls++;
+        while ((cap->size - cap->used) < num_bytes) {
+            _CAPTURE_WAIT(cap, space_cond);
+        }
+    }
+    const size_t pos = cap->write_pos;
+    _CAPTURE_UNLOCK(cap);
+    return pos;
+}
+
+// hand the bytes written since _capture_reserve() to the writer thread
+static void _capture_commit(capture_t* cap, size_t num_bytes) {
+    _CAPTURE_LOCK(cap);
+    cap->write_pos = (cap->write_pos + num_bytes) % cap->size;
+    cap->used += num_bytes;
+    _CAPTURE_BROADCAST(cap, data_cond);
+    _CAPTURE_UNLOCK(cap);
+    cap->num_bytes += num_bytes;
+}
+
+// the chunk being encoded into the ring buffer
+typedef struct {
+    capture_t* cap;
+    size_t start;
+    size_t pos;
+    size_t num_bytes;
+} _capture_out_t;
+
+static void _capture_put(_capture_out_t* out, const void* data, size_t num_bytes) {
+    capture_t* cap = out->cap;
+    const uint8_t* src = (const uint8_t*) data;
+    const size_t n0 = ((out->pos + num_bytes) <= cap->size) ? num_bytes : (cap->size - out->pos);
+    memcpy(cap->buffer + out->pos, src, n0);
+    if (n0 < num_bytes) {
+        memcpy(cap->buffer, src + n0, num_bytes - n0);
+    }
+    out->pos = (out->pos + num_bytes) % cap->size;
+    out->num_bytes += num_bytes;
+}
+
+static void _capture_put_u8(_capture_out_t* out, uint8_t val) {
+    out->cap->buffer[out->pos] = val;
+    out->pos = (out->pos + 1) % out->cap->size;
+    out->num_bytes++;
+}
+
+static void _capture_put_u16(_capture_out_t* out, uint16_t val) {
+    _capture_put_u8(out, (uint8_t)val);
+    _capture_put_u8(out, (uint8_t)(val >> 8));
+}
+
+static void _capture_put_u32(_capture_out_t* out, uint32_t val) {
+    _capture_put_u16(out, (uint16_t)val);
+    _capture_put_u16(out, (uint16_t)(val >> 16));
+}
+
+// reserve space for a chunk and write the chunk header, the payload size is patched in _capture_end_chunk()
+static _capture_out_t _capture_begin_chunk(capture_t* cap, uint32_t tag, size_t max_num_bytes) {
+    _capture_out_t out;
+    out.cap = cap;
+    out.start = _capture_reserve(cap, max_num_bytes);
+    out.pos = out.start;
+    out.num_bytes = 0;
+    _capture_put_u32(&out, tag);
+    _capture_put_u32(&out, 0);
+    return out;
+}
+
+static void _capture_end_chunk(_capture_out_t* out) {
+    CHIPS_ASSERT(out->num_bytes >= CAPTURE_CHUNK_HEADER_SIZE);
+    const uint32_t payload_size = (uint32_t)(out->num_bytes - CAPTURE_CHUNK_HEADER_SIZE);
+    _capture_out_t patch = *out;
+    patch.pos = (out->start + 4) % out->cap->size;
+    _capture_put_u32(&patch, payload_size);
+    _capture_commit(out->cap, out->num_bytes);
+}
+
+static uint8_t* _capture_put_varint(uint8_t* ptr, uint32_t val) {
+    while (val >= 0x80) {
+        *ptr++ = (uint8_t)(val | 0x80);
+        val >>= 7;
+    }
+    *ptr++ = (uint8_t)val;
+    return ptr;
+}
+
+/* delta-encode a line into line_buf, returns the encoded size, or 0 if the
+   encoded line wouldn't be smaller than the raw line
+
+   A run of up to 3 unchanged bytes between changed bytes is stored as
+   changed bytes, since a new (skip, count) pair would take more space.
+*/
+static size_t _capture_encode_line(capture_t* cap, const uint8_t* cur, const uint8_t* prev, size_t line_bytes) {
+    uint8_t* ptr = cap->line_buf;
+    uint8_t* end = cap->line_buf + line_bytes;
+    size_t x = 0;
+    while (x < line_bytes) {
+        const size_t skip_start = x;
+        while ((x < line_bytes) && (cur[x] == prev[x])) {
+            x++;
+        }
+        const size_t run_start = x;
+        size_t run_end = x;
+        while (x < line_bytes) {
+            if (cur[x] != prev[x]) {
+                run_end = ++x;
+            }
+            else if ((x - run_end) < 3) {
+                x++;
+            }
+            else {
+                break;
+            }
+        }
+        const size_t count = run_end - run_start;
+        x = run_end;
+        if ((ptr + 8 + count) > end) {
+            return 0;
+        }
+        ptr = _capture_put_varint(ptr, (uint32_t)(run_start - skip_start));
+        ptr = _capture_put_varint(ptr, (uint32_t)count);
+        memcpy(ptr, &cur[run_start], count);
+        ptr += count;
+    }
+    return (size_t)(ptr - cap->line_buf);
+}
+
+static void _capture_write_format(capture_t* cap) {
+    const size_t num_colors = cap->format.palette_size / sizeof(uint32_t);
+    _capture_out_t out = _capture_begin_chunk(cap, CAPTURE_CHUNK_FORMAT, CAPTURE_CHUNK_HEADER_SIZE + 8 + cap->format.palette_size);
+    _capture_put_u16(&out, (uint16_t)cap->format.width);
+    _capture_put_u16(&out, (uint16_t)cap->format.height);
+    _capture_put_u8(&out, (uint8_t)cap->format.bytes_per_pixel);
+    _capture_put_u8(&out, cap->format.flags);
+    _capture_put_u16(&out, (uint16_t)num_colors);
+    if (num_colors > 0) {
+        _capture_put(&out, cap->format.palette, cap->format.palette_size);
+    }
+    _capture_end_chunk(&out);
+}
+
+void capture_frame(capture_t* cap, const chips_display_info_t* info) {
+    CHIPS_ASSERT(cap && cap->valid && info && info->frame.buffer.ptr);
+    const int bpp = (int)info->frame.bytes_per_pixel;
+    const int width = info->screen.width;
+    const int height = info->screen.height;
+    const size_t line_bytes = (size_t)(width * bpp);
+    const size_t pitch = (size_t)info->frame.dim.width * (size_t)bpp;
+    CHIPS_ASSERT(line_bytes <= CAPTURE_MAX_LINE_BYTES);
+    CHIPS_ASSERT((line_bytes * (size_t)height) <= cap->prev_frame_size);
+    CHIPS_ASSERT((info->palette.size / sizeof(uint32_t)) <= CAPTURE_MAX_PALETTE);
+    const uint8_t flags = info->portrait ? CAPTURE_FORMAT_PORTRAIT : 0;
+
+    // a changed video format starts with a key frame
+    bool key = (0 == cap->frame_count) || ((cap->keyframe_interval > 0) && ((cap->frame_count % cap->keyframe_interval) == 0));
+    if ((width != cap->format.width) || (height != cap->format.height) || (bpp != cap->format.bytes_per_pixel) ||
+        (flags != cap->format.flags) || (info->palette.ptr != cap->format.palette) || (info->palette.size != cap->format.palette_size))
+    {
+        cap->format.width = width;
+        cap->format.height = height;
+        cap->format.bytes_per_pixel = bpp;
+        cap->format.flags = flags;
+        cap->format.palette = info->palette.ptr;
+        cap->format.palette_size = info->palette.size;
+        _capture_write_format(cap);
+        key = true;
+    }
+
+    _capture_out_t out = _capture_begin_chunk(cap, CAPTURE_CHUNK_FRAME, CAPTURE_MAX_FRAME_SIZE(line_bytes, (size_t)height));
+    _capture_put_u32(&out, cap->frame_count++);
+    _capture_put_u8(&out, key ? CAPTURE_FRAME_KEY : 0);
+    const uint8_t* src = (const uint8_t*)info->frame.buffer.ptr + (size_t)info->screen.y * pitch + (size_t)(info->screen.x * bpp);
+    // only lines flagged in the dirty line bitmap can have changed (all lines in a key frame)
+    const chips_dirty_lines_t* dirty = key ? 0 : info->dirty_lines;
+    int fb_y = info->screen.y;
+    int num_lines;
+    while ((num_lines = chips_dirty_lines_run(dirty, &fb_y, info->screen.y + height)) > 0) {
+        for (int y = fb_y - info->screen.y; y < (fb_y - info->screen.y + num_lines); y++) {
+            const uint8_t* cur = src + (size_t)y * pitch;
+            uint8_t* prev = cap->prev_frame + (size_t)y * line_bytes;
+            if (key) {
+                _capture_put_u16(&out, (uint16_t)(y | CAPTURE_LINE_RAW));
+                _capture_put(&out, cur, line_bytes);
+            }
+            else if (0 != memcmp(cur, prev, line_bytes)) {
+                const size_t size = _capture_encode_line(cap, cur, prev, line_bytes);
+                if (size > 0) {
+                    _capture_put_u16(&out, (uint16_t)y);
+                    _capture_put(&out, cap->line_buf, size);
+                }
+                else {
+                    _capture_put_u16(&out, (uint16_t)(y | CAPTURE_LINE_RAW));
+                    _capture_put(&out, cur, line_bytes);
+                }
+            }
+            else {
+                continue;
+            }
+            memcpy(prev, cur, line_bytes);
+        }
+        fb_y += num_lines;
+    }
+    _capture_put_u16(&out, CAPTURE_LINE_END);
+    _capture_end_chunk(&out);
+}
+
+void capture_audio(capture_t* cap, const float* samples, int num_samples) {
+    CHIPS_ASSERT(cap && cap->valid && samples && (num_samples >= 0));
+    // split into chunks of at most 4096 samples, so that a chunk always fits into the ring buffer
+    while (num_samples > 0) {
+        const int n = (num_samples < 4096) ? num_samples : 4096;
+        _capture_out_t out = _capture_begin_chunk(cap, CAPTURE_CHUNK_AUDIO, CAPTURE_CHUNK_HEADER_SIZE + 4 + (size_t)n * 2);
+        _capture_put_u32(&out, cap->sample_rate);
+        for (int i = 0; i < n; i++) {
+            float s = samples[i];
+            s = (s < -1.0f) ? -1.0f : ((s > 1.0f) ? 1.0f : s);
+            _capture_put_u16(&out, (uint16_t)(int16_t)(s * 32767.0f));
+        }
+        _capture_end_chunk(&out);
+        samples += n;
+        num_samples -= n;
+    }
+}
+
+void capture_audio_callback(const float* samples, int num_samples, void* user_data) {
+    capture_audio((capture_t*)user_data, samples, num_samples);
+}
+
+bool capture_next_chunk(chips_range_t stream, size_t* inout_pos, capture_chunk_t* out_chunk) {
+    CHIPS_ASSERT(stream.ptr && inout_pos && out_chunk);
+    const uint8_t* ptr = (const uint8_t*)stream.ptr + *inout_pos;
+    if ((*inout_pos + CAPTURE_CHUNK_HEADER_SIZE) > stream.size) {
+        return false;
+    }
+    const uint32_t tag = (uint32_t)ptr[0] | ((uint32_t)ptr[1]<<8) | ((uint32_t)ptr[2]<<16) | ((uint32_t)ptr[3]<<24);
+    const uint32_t size = (uint32_t)ptr[4] | ((uint32_t)ptr[5]<<8) | ((uint32_t)ptr[6]<<16) | ((uint32_t)ptr[7]<<24);
+    if ((*inout_pos + CAPTURE_CHUNK_HEADER_SIZE + size) > stream.size) {
+        return false;
+    }
+    out_chunk->tag = tag;
+    out_chunk->payload = ptr + CAPTURE_CHUNK_HEADER_SIZE;
+    out_chunk->size = size;
+    *inout_pos += CAPTURE_CHUNK_HEADER_SIZE + size;
+    return true;
+}
+
+static bool _capture_get_varint(const uint8_t** ptr, const uint8_t* end, uint32_t* out_val) {
+    uint32_t val = 0;
+    for (int shift = 0; shift < 32; shift += 7) {
+        if (*ptr >= end) {
+            return false;
+        }
+        const uint8_t b = *(*ptr)++;
+        val |= (uint32_t)(b & 0x7F) << shift;
+        if (0 == (b & 0x80)) {
+            *out_val = val;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool capture_decode_frame(const capture_chunk_t* chunk, uint8_t* frame, int line_bytes, int num_lines) {
+    CHIPS_ASSERT(chunk && frame && (line_bytes > 0) && (num_lines > 0));
+    if ((chunk->tag != CAPTURE_CHUNK_FRAME) || (chunk->size < 7)) {
+        return false;
+    }
+    const uint8_t* ptr = chunk->payload + 5;
+    const uint8_t* end = chunk->payload + chunk->size;
+    while ((ptr + 2) <= end) {
+        const uint16_t line = (uint16_t)(ptr[0] | (ptr[1]<<8));
+        ptr += 2;
+        if (line == CAPTURE_LINE_END) {
+            return true;
+        }
+        const int y = line & ~CAPTURE_LINE_RAW;
+        if (y >= num_lines) {
+            return false;
+        }
+        uint8_t* dst = frame + (size_t)y * (size_t)line_bytes;
+        if (line & CAPTURE_LINE_RAW) {
+            if ((ptr + line_bytes) > end) {
+                return false;
+            }
+            memcpy(dst, ptr, (size_t)line_bytes);
+            ptr += line_bytes;
+        }
+        else {
+            uint32_t x = 0;
+            while (x < (uint32_t)line_bytes) {
+                uint32_t skip, count;
+                if (!_capture_get_varint(&ptr, end, &skip) || !_capture_get_varint(&ptr, end, &count)) {
+                    return false;
+                }
+                x += skip;
+                if (((x + count) > (uint32_t)line_bytes) || ((ptr + count) > end)) {
+                    return false;
+                }
+                memcpy(dst + x, ptr, count);
+                ptr += count;
+                x += count;
+            }
+        }
+    }
+    return false;
+}
+
+#endif /* CHIPS_UTIL_IMPL */
@@ -0,0 +1,726 @@
+#pragma once
+/*#
+    # dbgserver.h
+
+    A transport-agnostic remote debugging server with a compact binary
+    protocol, for driving (headless) system emulator instances from a
+    remote debugger without going through the ImGui debugger UI.
+
+    Do this:
+    ~~~C
+    #define CHIPS_UTIL_IMPL
+    ~~~
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Select the supported CPU with one of the following macros (define one
+    or the other, but not both):
+
+    DBGSERVER_USE_Z80
+    DBGSERVER_USE_M6502
+
+    Optionally provide the following macros with your own implementation
+
+    ~~~C
+    CHIPS_ASSERT(c)
+    ~~~
+        your own assert macro (default: assert(c))
+
+    You need to include the following headers before including dbgserver.h:
+
+    - chips/chips_common.h
+    - chips/z80.h       (only if DBGSERVER_USE_Z80 is defined)
+    - chips/m6502.h     (only if DBGSERVER_USE_M6502 is defined)
+
+    ## Overview
+
+    The debug server owns a chips_debug_filter_t (see 'Debug Callback Filter'
+    in chips_common.h) and is hooked into the system emulator through
+    chips_debug_t. Breakpoints are set directly as bits in the exec, read
+    and write bitmaps of the filter, so while no breakpoint is hit, the
+    system runs at almost full speed and the server isn't called at all.
+
+    The server doesn't do any networking itself. The host application
+    receives bytes from the remote debugger (through a TCP socket, a pipe,
+    a websocket...) and passes them to dbgserver_recv(), which handles all
+    complete request packets and sends the responses through the send
+    callback. Requests are handled between calls to the system's
+    xxx_exec() function, which means that memory and register accesses
+    happen on the emulator thread without any locking.
+
+    ## Usage
+
+    Initialize the server with the CPU, memory access callbacks and the
+    send callback:
+
+    ~~~C
+    static uint8_t read_mem(uint16_t addr, void* user_data) {
+        return mem_rd(&zx.mem, addr);
+    }
+    static void write_mem(uint16_t addr, uint8_t data, void* user_data) {
+        mem_wr(&zx.mem, addr, data);
+    }
+    static void send(const uint8_t* data, size_t num_bytes, void* user_data) {
+        // write data to the client connection
+    }
+
+    dbgserver_init(&srv, &(dbgserver_desc_t){
+        .z80 = &zx.cpu,
+        .read_cb = read_mem,
+        .write_cb = write_mem,
+        .send_cb = send,
+    });
+    ~~~
+
+    ...and provide dbgserver_debug() as chips_debug_t to the system:
+
+    ~~~C
+    zx_init(&zx, &(zx_desc_t){
+        .debug = dbgserver_debug(&srv),
+        ...
+    });
+    ~~~
+
+    Call dbgserver_connect() and dbgserver_disconnect() when a client
+    connects or disconnects (disconnecting clears all breakpoints and
+    continues execution). When the host also has a ui_dbg.h debugger
+    window, it should call ui_dbg_external_debugger_connected() and
+    ui_dbg_external_debugger_disconnected() at the same time.
+
+    In the host's frame loop, pass the received bytes to the server and
+    run the system as usual, the system's xxx_exec() function returns
+    early when a breakpoint is hit (and doesn't do anything while the
+    server is in the stopped state):
+
+    ~~~C
+    uint8_t buf[1024];
+    int num_bytes;
+    while ((num_bytes = recv_nonblocking(buf, sizeof(buf))) > 0) {
+        dbgserver_recv(&srv, buf, num_bytes);
+    }
+    zx_exec(&zx, frame_time_us);
+    ~~~
+
+    ## Protocol
+
+    All packets (requests, responses and events) start with a 4-byte
+    header, followed by the payload, all values are little-endian:
+
+        u8  kind        request: DBGSERVER_CMD_*, response or event: DBGSERVER_RESP_* or DBGSERVER_EVENT_*
+        u8  tag         set by the client, returned in the response (0 in events)
+        u16 size        payload size in bytes (at most DBGSERVER_MAX_PAYLOAD)
+
+    Each request gets exactly one response with the same tag, an
+    DBGSERVER_RESP_OK response with the payload described below, or a
+    DBGSERVER_RESP_ERROR response with a 1-byte DBGSERVER_ERROR_* code.
+    Requests are handled in order, so a client may send many requests
+    (for instance a batch of memory reads) without waiting for the
+    responses.
+
+    - DBGSERVER_CMD_HELLO: empty payload, the response payload is
+      u16 protocol version (DBGSERVER_PROTOCOL_VERSION), u8 CPU type
+      (DBGSERVER_CPU_*) and u8 stopped flag
+    - DBGSERVER_CMD_STATUS: empty payload, the response payload is
+      u8 stopped flag, u16 instruction address and u64 tick counter
+    - DBGSERVER_CMD_READ_MEM: a list of (u16 addr, u16 num_bytes) ranges,
+      the response payload is the content of all ranges in the same order
+    - DBGSERVER_CMD_WRITE_MEM: u16 addr followed by the bytes to write
+    - DBGSERVER_CMD_GET_REGS: empty payload, the response payload is a
+      list of u16 register values in the following order:
+        - Z80: AF BC DE HL IX IY SP PC AF' BC' DE' HL' WZ IR IM IFF
+          (IFF is IFF1 in bit 0 and IFF2 in bit 1)
+        - 6502: A X Y S P PC
+      PC is the CPU's program counter register (on the Z80, this has
+      already been incremented past the current opcode, the address of the
+      current instruction is reported in status responses and stop events)
+    - DBGSERVER_CMD_SET_REGS: a list of u16 register values in the same
+      order as GET_REGS, may be shorter than the complete list
+    - DBGSERVER_CMD_SET_BREAKPOINTS: a list of (u8 type, u8 enable,
+      u16 addr, u16 num_addrs) entries, type is DBGSERVER_BREAK_EXEC,
+      DBGSERVER_BREAK_READ or DBGSERVER_BREAK_WRITE, each entry sets or
+      clears the breakpoint bits for an address range
+    - DBGSERVER_CMD_CLEAR_BREAKPOINTS: empty payload, clears all breakpoints
+    - DBGSERVER_CMD_CONTINUE: an optional u64 number of ticks, continues
+      execution until a breakpoint is hit, or the given number of ticks has
+      passed (a tick limit requires a debug callback at every instruction
+      boundary, which slows down the emulation)
+    - DBGSERVER_CMD_STEP: empty payload, executes one instruction
+    - DBGSERVER_CMD_BREAK: empty payload, stops execution
+
+    When execution stops (on a breakpoint, after a step, when the tick
+    limit is reached, or on a BREAK request), the server sends a
+    DBGSERVER_EVENT_STOPPED packet with the payload:
+
+        u8  reason      DBGSERVER_STOP_*
+        u16 addr        the breakpoint or memory access address
+        u16 pc          the address of the current instruction (on memory
+                        breakpoints this is the CPU's PC register instead)
+        u64 ticks       the debug filter tick counter
+
+    ## zlib/libpng license
+
+    Copyright (c) 2018 Andre Weissflog
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#if !defined(DBGSERVER_USE_Z80) && !defined(DBGSERVER_USE_M6502)
+#error "please define DBGSERVER_USE_Z80 or DBGSERVER_USE_M6502"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DBGSERVER_PROTOCOL_VERSION (1)
+#define DBGSERVER_HEADER_SIZE (4)
+#define DBGSERVER_MAX_PAYLOAD (8192)
+
+// request commands
+enum {
+    DBGSERVER_CMD_HELLO = 0x01,
+    DBGSERVER_CMD_STATUS = 0x02,
+    DBGSERVER_CMD_READ_MEM = 0x03,
+    DBGSERVER_CMD_WRITE_MEM = 0x04,
+    DBGSERVER_CMD_GET_REGS = 0x05,
+    DBGSERVER_CMD_SET_REGS = 0x06,
+    DBGSERVER_CMD_SET_BREAKPOINTS = 0x07,
+    DBGSERVER_CMD_CLEAR_BREAKPOINTS = 0x08,
+    DBGSERVER_CMD_CONTINUE = 0x09,
+    DBGSERVER_CMD_STEP = 0x0A,
+    DBGSERVER_CMD_BREAK = 0x0B,
+};
+
+// response and event packet kinds
+enum {
+    DBGSERVER_RESP_OK = 0x80,
+    DBGSERVER_RESP_ERROR = 0x81,
+    DBGSERVER_EVENT_STOPPED = 0x90,
+};
+
+// error codes in DBGSERVER_RESP_ERROR responses
+enum {
+    DBGSERVER_ERROR_UNKNOWN_CMD = 1,
+    DBGSERVER_ERROR_INVALID_PAYLOAD = 2,
+    DBGSERVER_ERROR_TOO_BIG = 3,
+};
+
+// CPU types
+enum {
+    DBGSERVER_CPU_Z80 = 1,
+    DBGSERVER_CPU_M6502 = 2,
+};
+
+// breakpoint types
+enum {
+    DBGSERVER_BREAK_EXEC = 0,
+    DBGSERVER_BREAK_READ = 1,
+    DBGSERVER_BREAK_WRITE = 2,
+};
+
+// stop reasons
+enum {
+    DBGSERVER_STOP_EXEC = 1,    // execution breakpoint
+    DBGSERVER_STOP_READ = 2,    // memory read breakpoint
+    DBGSERVER_STOP_WRITE = 3,   // memory write breakpoint
+    DBGSERVER_STOP_STEP = 4,    // single step done
+    DBGSERVER_STOP_TICKS = 5,   // tick limit of a CONTINUE request reached
+    DBGSERVER_STOP_BREAK = 6,   // BREAK request
+};
+
+// callback to read a byte from memory
+typedef uint8_t (*dbgserver_read_t)(uint16_t addr, void* user_data);
+// callback to write a byte to memory
+typedef void (*dbgserver_write_t)(uint16_t addr, uint8_t data, void* user_data);
+// callback to send a packet to the client
+typedef void (*dbgserver_send_t)(const uint8_t* data, size_t num_bytes, void* user_data);
+
+typedef struct {
+    #if defined(DBGSERVER_USE_Z80)
+    z80_t* z80;                 // Z80 CPU to debug
+    #elif defined(DBGSERVER_USE_M6502)
+    m6502_t* m6502;             // 6502 CPU to debug
+    #endif
+    dbgserver_read_t read_cb;   // callback to read memory
+    dbgserver_write_t write_cb; // callback to write memory
+    dbgserver_send_t send_cb;   // callback to send packets to the client
+    void* user_data;            // user data for callbacks
+} dbgserver_desc_t;
+
+typedef struct {
+    bool valid;
+    #if defined(DBGSERVER_USE_Z80)
+    z80_t* z80;
+    #elif defined(DBGSERVER_USE_M6502)
+    m6502_t* m6502;
+    #endif
+    dbgserver_read_t read_cb;
+    dbgserver_write_t write_cb;
+    dbgserver_send_t send_cb;
+    void* user_data;
+    bool connected;
+    bool stopped;               // chips_debug_t.stopped points here
+    bool stepping;
+    uint64_t end_tick;          // tick limit of the current CONTINUE request, 0 if none
+    uint16_t op_pc;             // address of the current instruction
+    uint32_t rx_pos;            // number of bytes in rx_buf
+    uint32_t rx_skip;           // remaining payload bytes of an oversized request to skip
+    uint8_t rx_buf[DBGSERVER_HEADER_SIZE + DBGSERVER_MAX_PAYLOAD];
+    uint8_t tx_buf[DBGSERVER_HEADER_SIZE + DBGSERVER_MAX_PAYLOAD];
+    chips_debug_filter_t filter;    // chips_debug_t.filter points here
+} dbgserver_t;
+
+// initialize a debug server instance
+void dbgserver_init(dbgserver_t* srv, const dbgserver_desc_t* desc);
+// discard a debug server instance
+void dbgserver_discard(dbgserver_t* srv);
+// get the chips_debug_t to provide to the system emulator
+chips_debug_t dbgserver_debug(dbgserver_t* srv);
+// call when a client has connected
+void dbgserver_connect(dbgserver_t* srv);
+// call when the client has disconnected, clears all breakpoints and continues execution
+void dbgserver_disconnect(dbgserver_t* srv);
+// pass bytes received from the client, handles all complete requests
+void dbgserver_recv(dbgserver_t* srv, const uint8_t* data, size_t num_bytes);
+// return true if execution is currently stopped
+bool dbgserver_stopped(dbgserver_t* srv);
+// the debug callback function (provided to the system by dbgserver_debug())
+void dbgserver_debug_callback(void* user_data, uint64_t pins);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_UTIL_IMPL
+#include <string.h> // memset, memcpy, memmove
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+static inline uint16_t _dbgserver_get_u16(const uint8_t* ptr) {
+    return (uint16_t)(ptr[0] | (ptr[1] << 8));
+}
+
+static inline uint64_t _dbgserver_get_u64(const uint8_t* ptr) {
+    uint64_t val = 0;
+    for (int i = 7; i >= 0; i--) {
+        val = (val << 8) | ptr[i];
+    }
+    return val;
+}
+
+static inline uint8_t* _dbgserver_put_u16(uint8_t* ptr, uint16_t val) {
+    ptr[0] = (uint8_t)val;
+    ptr[1] = (uint8_t)(val >> 8);
+    return ptr + 2;
+}
+
+static inline uint8_t* _dbgserver_put_u64(uint8_t* ptr, uint64_t val) {
+    for (int i = 0; i < 8; i++) {
+        ptr[i] = (uint8_t)(val >> (i * 8));
+    }
+    return ptr + 8;
+}
+
+// payload area of the tx buffer
+static inline uint8_t* _dbgserver_tx_payload(dbgserver_t* srv) {
+    return &srv->tx_buf[DBGSERVER_HEADER_SIZE];
+}
+
+// send a packet, the payload must already be in the tx buffer
+static void _dbgserver_send(dbgserver_t* srv, uint8_t kind, uint8_t tag, size_t payload_size) {
+    CHIPS_ASSERT(payload_size <= DBGSERVER_MAX_PAYLOAD);
+    srv->tx_buf[0] = kind;
+    srv->tx_buf[1] = tag;
+    _dbgserver_put_u16(&srv->tx_buf[2], (uint16_t)payload_size);
+    if (srv->connected && srv->send_cb) {
+        srv->send_cb(srv->tx_buf, DBGSERVER_HEADER_SIZE + payload_size, srv->user_data);
+    }
+}
+
+static void _dbgserver_send_error(dbgserver_t* srv, uint8_t tag, uint8_t error) {
+    _dbgserver_tx_payload(srv)[0] = error;
+    _dbgserver_send(srv, DBGSERVER_RESP_ERROR, tag, 1);
+}
+
+static inline uint16_t _dbgserver_cpu_pc(dbgserver_t* srv) {
+    #if defined(DBGSERVER_USE_Z80)
+        return srv->z80->pc;
+    #elif defined(DBGSERVER_USE_M6502)
+        return srv->m6502->PC;
+    #endif
+}
+
+// only stepping and a tick limit need a debug callback at every instruction boundary
+static void _dbgserver_update_filter(dbgserver_t* srv) {
+    srv->filter.flags = (srv->stepping || (srv->end_tick != 0)) ? CHIPS_DEBUG_FILTER_OP : 0;
+}
+
+static void _dbgserver_stop(dbgserver_t* srv, uint8_t reason, uint16_t addr) {
+    srv->stopped = true;
+    srv->stepping = false;
+    srv->end_tick = 0;
+    _dbgserver_update_filter(srv);
+    uint8_t* ptr = _dbgserver_tx_payload(srv);
+    *ptr++ = reason;
+    ptr = _dbgserver_put_u16(ptr, addr);
+    ptr = _dbgserver_put_u16(ptr, srv->op_pc);
+    ptr = _dbgserver_put_u64(ptr, srv->filter.ticks);
+    _dbgserver_send(srv, DBGSERVER_EVENT_STOPPED, 0, (size_t)(ptr - _dbgserver_tx_payload(srv)));
+}
+
+static void _dbgserver_continue(dbgserver_t* srv) {
+    srv->stopped = false;
+    _dbgserver_update_filter(srv);
+}
+
+static void _dbgserver_set_breakpoints(dbgserver_t* srv, int type, bool enable, uint16_t addr, uint32_t num_addrs) {
+    uint64_t* bitmap = 0;
+    switch (type) {
+        case DBGSERVER_BREAK_EXEC:  bitmap = srv->filter.exec; break;
+        case DBGSERVER_BREAK_READ:  bitmap = srv->filter.read; break;
+        default:                    bitmap = srv->filter.write; break;
+    }
+    for (uint32_t i = 0; i < num_addrs; i++) {
+        const uint16_t a = (uint16_t)(addr + i);
+        const uint64_t bit = 1ULL << (a & 63);
+        if (enable) {
+            bitmap[a >> 6] |= bit;
+        }
+        else {
+            bitmap[a >> 6] &= ~bit;
+        }
+    }
+}
+
+static void _dbgserver_clear_breakpoints(dbgserver_t* srv) {
+    memset(srv->filter.exec, 0, sizeof(srv->filter.exec));
+    memset(srv->filter.read, 0, sizeof(srv->filter.read));
+    memset(srv->filter.write, 0, sizeof(srv->filter.write));
+}
+
+// write the register values to dst, returns number of registers
+static int _dbgserver_get_regs(dbgserver_t* srv, uint16_t* dst) {
+    int n = 0;
+    #if defined(DBGSERVER_USE_Z80)
+        z80_t* c = srv->z80;
+        z80_sync_flags(c);
+        dst[n++] = c->af; dst[n++] = c->bc; dst[n++] = c->de; dst[n++] = c->hl;
+        dst[n++] = c->ix; dst[n++] = c->iy; dst[n++] = c->sp; dst[n++] = c->pc;
+        dst[n++] = c->af2; dst[n++] = c->bc2; dst[n++] = c->de2; dst[n++] = c->hl2;
+        dst[n++] = c->wz; dst[n++] = c->ir; dst[n++] = c->im;
+        dst[n++] = (uint16_t)((c->iff1 ? 1 : 0) | (c->iff2 ? 2 : 0));
+    #elif defined(DBGSERVER_USE_M6502)
+        m6502_t* c = srv->m6502;
+        dst[n++] = c->A; dst[n++] = c->X; dst[n++] = c->Y; dst[n++] = c->S;
+        dst[n++] = c->P; dst[n++] = c->PC;
+    #endif
+    return n;
+}
+
+// set the first num_regs registers
+static void _dbgserver_set_regs(dbgserver_t* srv, const uint16_t* src, int num_regs) {
+    uint16_t regs[16];
+    const int max_regs = _dbgserver_get_regs(srv, regs);
+    if (num_regs > max_regs) {
+        num_regs = max_regs;
+    }
+    memcpy(regs, src, (size_t)num_regs * sizeof(uint16_t));
+    int n = 0;
+    #if defined(DBGSERVER_USE_Z80)
+        z80_t* c = srv->z80;
+        c->af = regs[n++]; c->bc = regs[n++]; c->de = regs[n++]; c->hl = regs[n++];
+        c->ix = regs[n++]; c->iy = regs[n++]; c->sp = regs[n++]; c->pc = regs[n++];
+        c->af2 = regs[n++]; c->bc2 = regs[n++]; c->de2 = regs[n++]; c->hl2 = regs[n++];
+        c->wz = regs[n++]; c->ir = regs[n++]; c->im = (uint8_t)regs[n++];
+        c->iff1 = 0 != (regs[n] & 1);
+        c->iff2 = 0 != (regs[n] & 2);
+    #elif defined(DBGSERVER_USE_M6502)
+        m6502_t* c = srv->m6502;
+        c->A = (uint8_t)regs[n++]; c->X = (uint8_t)regs[n++]; c->Y = (uint8_t)regs[n++];
+        c->S = (uint8_t)regs[n++]; c->P = (uint8_t)regs[n++]; c->PC = regs[n++];
+    #endif
+    (void)n;
+}
+
+// handle a complete request packet
+static void _dbgserver_request(dbgserver_t* srv, uint8_t cmd, uint8_t tag, const uint8_t* payload, uint32_t size) {
+    uint8_t* out = _dbgserver_tx_payload(srv);
+    uint8_t* ptr = out;
+    switch (cmd) {
+        case DBGSERVER_CMD_HELLO:
+            ptr = _dbgserver_put_u16(ptr, DBGSERVER_PROTOCOL_VERSION);
+            #if defined(DBGSERVER_USE_Z80)
+            *ptr++ = DBGSERVER_CPU_Z80;
+            #elif defined(DBGSERVER_USE_M6502)
+            *ptr++ = DBGSERVER_CPU_M6502;
+            #endif
+            *ptr++ = srv->stopped ? 1 : 0;
+            break;
+
+        case DBGSERVER_CMD_STATUS:
+            *ptr++ = srv->stopped ? 1 : 0;
+            ptr = _dbgserver_put_u16(ptr, srv->op_pc);
+            ptr = _dbgserver_put_u64(ptr, srv->filter.ticks);
+            break;
+
+        case DBGSERVER_CMD_READ_MEM:
+            {
+                if (size & 3) {
+                    _dbgserver_send_error(srv, tag, DBGSERVER_ERROR_INVALID_PAYLOAD);
+                    return;
+                }
+                // check the response size first, so that a response is either complete or an error
+                uint32_t total = 0;
+                for (uint32_t i = 0; i < size; i += 4) {
+                    total += _dbgserver_get_u16(&payload[i + 2]);
+                }
+                if (total > DBGSERVER_MAX_PAYLOAD) {
+                    _dbgserver_send_error(srv, tag, DBGSERVER_ERROR_TOO_BIG);
+                    return;
+                }
+                for (uint32_t i = 0; i < size; i += 4) {
+                    const uint16_t addr = _dbgserver_get_u16(&payload[i]);
+                    const uint16_t num_bytes = _dbgserver_get_u16(&payload[i + 2]);
+                    for (uint32_t j = 0; j < num_bytes; j++) {
+                        *ptr++ = srv->read_cb((uint16_t)(addr + j), srv->user_data);
+                    }
+                }
+            }
+            break;
+
+        case DBGSERVER_CMD_WRITE_MEM:
+            {
+                if (size < 2) {
+                    _dbgserver_send_error(srv, tag, DBGSERVER_ERROR_INVALID_PAYLOAD);
+                    return;
+                }
+                const uint16_t addr = _dbgserver_get_u16(payload);
+                if (srv->write_cb) {
+                    for (uint32_t i = 2; i < size; i++) {
+                        srv->write_cb((uint16_t)(addr + i - 2), payload[i], srv->user_data);
+                    }
+                }
+            }
+            break;
+
+        case DBGSERVER_CMD_GET_REGS:
+            {
+                uint16_t regs[16];
+                const int num_regs = _dbgserver_get_regs(srv, regs);
+                for (int i = 0; i < num_regs; i++) {
+                    ptr = _dbgserver_put_u16(ptr, regs[i]);
+                }
+            }
+            break;
+
+        case DBGSERVER_CMD_SET_REGS:
+            {
+                uint16_t regs[16];
+                const int num_regs = (int)((size / 2) < 16 ? (size / 2) : 16);
+                for (int i = 0; i < num_regs; i++) {
+                    regs[i] = _dbgserver_get_u16(&payload[i * 2]);
+                }
+                _dbgserver_set_regs(srv, regs, num_regs);
+            }
+            break;
+
+        case DBGSERVER_CMD_SET_BREAKPOINTS:
+            if ((size % 6) != 0) {
+                _dbgserver_send_error(srv, tag, DBGSERVER_ERROR_INVALID_PAYLOAD);
+                return;
+            }
+            for (uint32_t i = 0; i < size; i += 6) {
+                _dbgserver_set_breakpoints(srv, payload[i], 0 != payload[i + 1], _dbgserver_get_u16(&payload[i + 2]), _dbgserver_get_u16(&payload[i + 4]));
+            }
+            break;
+
+        case DBGSERVER_CMD_CLEAR_BREAKPOINTS:
+            _dbgserver_clear_breakpoints(srv);
+            break;
+
+        case DBGSERVER_CMD_CONTINUE:
+            {
+                const uint64_t num_ticks = (size >= 8) ? _dbgserver_get_u64(payload) : 0;
+                srv->stepping = false;
+                srv->end_tick = (num_ticks > 0) ? (srv->filter.ticks + num_ticks) : 0;
+                _dbgserver_continue(srv);
+            }
+            break;
+
+        case DBGSERVER_CMD_STEP:
+            srv->stepping = true;
+            srv->end_tick = 0;
+            _dbgserver_continue(srv);
+            break;
+
+        case DBGSERVER_CMD_BREAK:
+            // send the response before the stop event
+            _dbgserver_send(srv, DBGSERVER_RESP_OK, tag, 0);
+            if (!srv->stopped) {
+                _dbgserver_stop(srv, DBGSERVER_STOP_BREAK, srv->op_pc);
+            }
+            return;
+
+        default:
+            _dbgserver_send_error(srv, tag, DBGSERVER_ERROR_UNKNOWN_CMD);
+            return;
+    }
+    _dbgserver_send(srv, DBGSERVER_RESP_OK, tag, (size_t)(ptr - out));
+}
+
+void dbgserver_init(dbgserver_t* srv, const dbgserver_desc_t* desc) {
+    CHIPS_ASSERT(srv && desc);
+    #if defined(DBGSERVER_USE_Z80)
+    CHIPS_ASSERT(desc->z80);
+    #elif defined(DBGSERVER_USE_M6502)
+    CHIPS_ASSERT(desc->m6502);
+    #endif
+    CHIPS_ASSERT(desc->read_cb && desc->send_cb);
+    memset(srv, 0, sizeof(dbgserver_t));
+    srv->valid = true;
+    #if defined(DBGSERVER_USE_Z80)
+    srv->z80 = desc->z80;
+    #elif defined(DBGSERVER_USE_M6502)
+    srv->m6502 = desc->m6502;
+    #endif
+    srv->read_cb = desc->read_cb;
+    srv->write_cb = desc->write_cb;
+    srv->send_cb = desc->send_cb;
+    srv->user_data = desc->user_data;
+}
+
+void dbgserver_discard(dbgserver_t* srv) {
+    CHIPS_ASSERT(srv && srv->valid);
+    srv->valid = false;
+}
+
+chips_debug_t dbgserver_debug(dbgserver_t* srv) {
+    CHIPS_ASSERT(srv && srv->valid);
+    chips_debug_t debug;
+    memset(&debug, 0, sizeof(debug));
+    debug.callback.func = dbgserver_debug_callback;
+    debug.callback.user_data = srv;
+    debug.stopped = &srv->stopped;
+    debug.filter = &srv->filter;
+    return debug;
+}
+
+void dbgserver_connect(dbgserver_t* srv) {
+    CHIPS_ASSERT(srv && srv->valid);
+    srv->connected = true;
+    srv->rx_pos = 0;
+    srv->rx_skip = 0;
+}
+
+void dbgserver_disconnect(dbgserver_t* srv) {
+    CHIPS_ASSERT(srv && srv->valid);
+    srv->connected = false;
+    srv->stepping = false;
+    srv->end_tick = 0;
+    _dbgserver_clear_breakpoints(srv);
+    _dbgserver_continue(srv);
+}
+
+void dbgserver_recv(dbgserver_t* srv, const uint8_t* data, size_t num_bytes) {
+    CHIPS_ASSERT(srv && srv->valid && data);
+    while (num_bytes > 0) {
+        // skip the payload of an oversized request
+        if (srv->rx_skip > 0) {
+            const uint32_t n = (num_bytes < srv->rx_skip) ? (uint32_t)num_bytes : srv->rx_skip;
+            srv->rx_skip -= n;
+            data += n;
+            num_bytes -= n;
+            continue;
+        }
+        // gather the header, and then the payload
+        uint32_t needed = DBGSERVER_HEADER_SIZE;
+        if (srv->rx_pos >= DBGSERVER_HEADER_SIZE) {
+            needed += _dbgserver_get_u16(&srv->rx_buf[2]);
+        }
+        const uint32_t n = ((needed - srv->rx_pos) < num_bytes) ? (needed - srv->rx_pos) : (uint32_t)num_bytes;
+        memcpy(&srv->rx_buf[srv->rx_pos], data, n);
+        srv->rx_pos += n;
+        data += n;
+        num_bytes -= n;
+        if (srv->rx_pos == DBGSERVER_HEADER_SIZE) {
+            const uint32_t size = _dbgserver_get_u16(&srv->rx_buf[2]);
+            if (size > DBGSERVER_MAX_PAYLOAD) {
+                _dbgserver_send_error(srv, srv->rx_buf[1], DBGSERVER_ERROR_TOO_BIG);
+                srv->rx_skip = size;
+                srv->rx_pos = 0;
+                continue;
+            }
+        }
+        if ((srv->rx_pos >= DBGSERVER_HEADER_SIZE) && (srv->rx_pos == (DBGSERVER_HEADER_SIZE + (uint32_t)_dbgserver_get_u16(&srv->rx_buf[2])))) {
+            _dbgserver_request(srv, srv->rx_buf[0], srv->rx_buf[1], &srv->rx_buf[DBGSERVER_HEADER_SIZE], srv->rx_pos - DBGSERVER_HEADER_SIZE);
+            srv->rx_pos = 0;
+        }
+    }
+}
+
+bool dbgserver_stopped(dbgserver_t* srv) {
+    CHIPS_ASSERT(srv && srv->valid);
+    return srv->stopped;
+}
+
+void dbgserver_debug_callback(void* user_data, uint64_t pins) {
+    dbgserver_t* srv = (dbgserver_t*) user_data;
+    CHIPS_ASSERT(srv && srv->valid);
+    #if defined(DBGSERVER_USE_Z80)
+        const bool new_op = z80_opdone(srv->z80);
+        const uint16_t addr = Z80_GET_ADDR(pins);
+        const bool rd = (pins & (Z80_MREQ|Z80_RD)) == (Z80_MREQ|Z80_RD);
+        const bool wr = (pins & (Z80_MREQ|Z80_WR)) == (Z80_MREQ|Z80_WR);
+    #elif defined(DBGSERVER_USE_M6502)
+        const bool new_op = 0 != (pins & M6502_SYNC);
+        const uint16_t addr = M6502_GET_ADDR(pins);
+        const bool rd = 0 != (pins & M6502_RW);
+        const bool wr = !rd;
+    #endif
+    const uint64_t bit = 1ULL << (addr & 63);
+    if (new_op) {
+        srv->op_pc = addr;
+        if (srv->filter.exec[addr >> 6] & bit) {
+            _dbgserver_stop(srv, DBGSERVER_STOP_EXEC, addr);
+            return;
+        }
+        if (srv->stepping) {
+            _dbgserver_stop(srv, DBGSERVER_STOP_STEP, addr);
+            return;
+        }
+        if ((srv->end_tick != 0) && (srv->filter.ticks >= srv->end_tick)) {
+            _dbgserver_stop(srv, DBGSERVER_STOP_TICKS, addr);
+            return;
+        }
+    }
+    // without stepping, the debug callback isn't called at instruction
+    // boundaries, so the instruction address isn't known on memory breakpoints
+    if (rd && (srv->filter.read[addr >> 6] & bit)) {
+        srv->op_pc = _dbgserver_cpu_pc(srv);
+        _dbgserver_stop(srv, DBGSERVER_STOP_READ, addr);
+    }
+    else if (wr && (srv->filter.write[addr >> 6] & bit)) {
+        srv->op_pc = _dbgserver_cpu_pc(srv);
+        _dbgserver_stop(srv, DBGSERVER_STOP_WRITE, addr);
+    }
+}
+
+#endif /* CHIPS_UTIL_IMPL */
@@ -43,6 +43,56 @@
 
     Undocumented instructions are supported and are marked with a '*'.
 
+    ## Bulk Decoding
+
+    For offline tools which need to process entire memory images, there's
+    a buffer-based API which doesn't call any function pointers and decodes
+    instructions into structured records instead of text:
+
+    ~~~C
+    size_t m6502dasm_decode_range(uint16_t addr, const uint8_t* bytes, size_t num_bytes, m6502dasm_inst_t* insts, size_t max_insts)
+    ~~~
+
+    addr    - the address of the first byte in the buffer
+    bytes   - pointer to the instruction bytes
+    num_bytes - number of bytes in the buffer
+    insts   - pointer to an array of m6502dasm_inst_t items
+    max_insts - number of items in the insts array
+
+    The function decodes consecutive instructions until either the insts
+    array is full or the end of the byte buffer is reached (an instruction
+    which would read past the end of the buffer isn't decoded), and returns
+    the number of decoded instructions. The next address to continue
+    decoding at is `insts[n-1].addr + insts[n-1].len`.
+
+    A single instruction can be decoded with:
+
+    ~~~C
+    int m6502dasm_decode(uint16_t addr, const uint8_t* bytes, size_t num_bytes, m6502dasm_inst_t* out_inst)
+    ~~~
+
+    This returns the length of the instruction in bytes, or 0 if the
+    instruction doesn't fit into the buffer.
+
+    Each m6502dasm_inst_t record contains:
+
+    - the instruction address, length and raw instruction bytes
+    - a mnemonic id (M6502DASM_MN_xxx) and whether this is an
+      undocumented instruction
+    - the addressing mode (M6502DASM_AM_xxx) and the 8- or 16-bit operand value
+    - the control flow type (M6502DASM_FLOW_xxx), whether the flow change
+      is conditional, and the jump/call target address if known
+
+    To get the text representation of a decoded instruction (the same
+    string m6502dasm_op() would produce), call:
+
+    ~~~C
+    int m6502dasm_render(const m6502dasm_inst_t* inst, char* buf, int buf_size)
+    ~~~
+
+    This writes a zero-terminated string to buf and returns the string
+    length without the terminating zero.
+
     ## zlib/libpng license
 
     Copyright (c) 2018 Andre Weissflog
@@ -63,6 +113,7 @@
 #*/
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -73,8 +124,129 @@ typedef uint8_t (*m6502dasm_input_t)(void* user_data);
 /* the output callback type */
 typedef void (*m6502dasm_output_t)(char c, void* user_data);
 
+/* max length of the rendered text of an instruction including terminating zero */
+#define M6502DASM_MAX_STRLEN (32)
+/* max number of bytes in one instruction */
+#define M6502DASM_MAX_BYTES (3)
+
+/* mnemonic ids, the last group are undocumented-only instructions */
+typedef enum {
+    M6502DASM_MN_INVALID = 0,
+    M6502DASM_MN_ADC,
+    M6502DASM_MN_AND,
+    M6502DASM_MN_ASL,
+    M6502DASM_MN_BCC,
+    M6502DASM_MN_BCS,
+    M6502DASM_MN_BEQ,
+    M6502DASM_MN_BIT,
+    M6502DASM_MN_BMI,
+    M6502DASM_MN_BNE,
+    M6502DASM_MN_BPL,
+    M6502DASM_MN_BRK,
+    M6502DASM_MN_BVC,
+    M6502DASM_MN_BVS,
+    M6502DASM_MN_CLC,
+    M6502DASM_MN_CLD,
+    M6502DASM_MN_CLI,
+    M6502DASM_MN_CLV,
+    M6502DASM_MN_CMP,
+    M6502DASM_MN_CPX,
+    M6502DASM_MN_CPY,
+    M6502DASM_MN_DEC,
+    M6502DASM_MN_DEX,
+    M6502DASM_MN_DEY,
+    M6502DASM_MN_EOR,
+    M6502DASM_MN_INC,
+    M6502DASM_MN_INX,
+    M6502DASM_MN_INY,
+    M6502DASM_MN_JMP,
+    M6502DASM_MN_JSR,
+    M6502DASM_MN_LDA,
+    M6502DASM_MN_LDX,
+    M6502DASM_MN_LDY,
+    M6502DASM_MN_LSR,
+    M6502DASM_MN_NOP,
+    M6502DASM_MN_ORA,
+    M6502DASM_MN_PHA,
+    M6502DASM_MN_PHP,
+    M6502DASM_MN_PLA,
+    M6502DASM_MN_PLP,
+    M6502DASM_MN_ROL,
+    M6502DASM_MN_ROR,
+    M6502DASM_MN_RTI,
+    M6502DASM_MN_RTS,
+    M6502DASM_MN_SBC,
+    M6502DASM_MN_SEC,
+    M6502DASM_MN_SED,
+    M6502DASM_MN_SEI,
+    M6502DASM_MN_STA,
+    M6502DASM_MN_STX,
+    M6502DASM_MN_STY,
+    M6502DASM_MN_TAX,
+    M6502DASM_MN_TAY,
+    M6502DASM_MN_TSX,
+    M6502DASM_MN_TXA,
+    M6502DASM_MN_TXS,
+    M6502DASM_MN_TYA,
+    M6502DASM_MN_SLO,
+    M6502DASM_MN_RLA,
+    M6502DASM_MN_SRE,
+    M6502DASM_MN_RRA,
+    M6502DASM_MN_SAX,
+    M6502DASM_MN_LAX,
+    M6502DASM_MN_DCP,
+    M6502DASM_MN_ISB,
+    M6502DASM_MN_NUM,
+} m6502dasm_mnemonic_t;
+
+/* addressing modes */
+typedef enum {
+    M6502DASM_AM_NONE = 0,  /* implied or accumulator */
+    M6502DASM_AM_IMM,       /* #nn */
+    M6502DASM_AM_ZP,        /* nn */
+    M6502DASM_AM_ZPX,       /* nn,X */
+    M6502DASM_AM_ZPY,       /* nn,Y */
+    M6502DASM_AM_ABS,       /* nnnn */
+    M6502DASM_AM_ABX,       /* nnnn,X */
+    M6502DASM_AM_ABY,       /* nnnn,Y */
+    M6502DASM_AM_IDX,       /* (nn,X) */
+    M6502DASM_AM_IDY,       /* (nn),Y */
+    M6502DASM_AM_IND,       /* (nnnn) */
+    M6502DASM_AM_REL,       /* relative branch */
+} m6502dasm_addrmode_t;
+
+/* control flow types */
+typedef enum {
+    M6502DASM_FLOW_NONE = 0,        /* continues with the next instruction */
+    M6502DASM_FLOW_JUMP,            /* JMP nnnn, Bxx */
+    M6502DASM_FLOW_JUMP_INDIRECT,   /* JMP (nnnn) */
+    M6502DASM_FLOW_CALL,            /* JSR nnnn, BRK (no target) */
+    M6502DASM_FLOW_RET,             /* RTS, RTI */
+} m6502dasm_flow_t;
+
+/* a decoded instruction */
+typedef struct {
+    uint16_t addr;              /* address of the first instruction byte */
+    uint8_t len;                /* instruction length in bytes */
+    uint8_t bytes[M6502DASM_MAX_BYTES];
+    uint8_t mnemonic;           /* M6502DASM_MN_xxx */
+    bool illegal;               /* true for undocumented instructions */
+    uint8_t mode;               /* M6502DASM_AM_xxx */
+    uint8_t flow;               /* M6502DASM_FLOW_xxx */
+    bool cond;                  /* true if the flow change is conditional */
+    bool has_target;            /* true if target is valid */
+    uint16_t operand;           /* 8- or 16-bit operand value */
+    uint16_t target;            /* jump or call target address */
+} m6502dasm_inst_t;
+
 /* disassemble a single 6502 instruction into a stream of ASCII characters */
 uint16_t m6502dasm_op(uint16_t pc, m6502dasm_input_t in_cb, m6502dasm_output_t out_cb, void* user_data);
+/* decode a single instruction from a byte buffer, returns instruction length or 0 */
+int m6502dasm_decode(uint16_t addr, const uint8_t* bytes, size_t num_bytes, m6502dasm_inst_t* out_inst);
+/* decode consecutive instructions from a byte buffer, returns number of decoded instructions */
+size_t m6502dasm_decode_range(uint16_t addr, const uint8_t* bytes, size_t num_bytes, m6502dasm_inst_t* insts, size_t max_insts);
+/* render a decoded instruction as text, returns string length */
+int m6502dasm_render(const m6502dasm_inst_t* inst, char* buf, int buf_size);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -91,37 +263,42 @@ uint16_t m6502dasm_op(uint16_t pc, m6502dasm_input_t in_cb, m6502dasm_output_t o
 #ifdef _FETCH_U8
 #undef _FETCH_U8
 #endif
-#define _FETCH_U8(v) v=in_cb(user_data);pc++;
+#define _FETCH_U8(v) v=_m6502dasm_fetch(ctx);pc++;
 /* fetch signed 8-bit value and track pc */
 #ifdef _FETCH_I8
 #undef _FETCH_I8
 #endif
-#define _FETCH_I8(v) v=(int8_t)in_cb(user_data);pc++;
+#define _FETCH_I8(v) v=(int8_t)_m6502dasm_fetch(ctx);pc++;
 /* fetch unsigned 16-bit value and track pc */
 #ifdef _FETCH_U16
 #undef _FETCH_U16
 #endif
-#define _FETCH_U16(v) v=in_cb(user_data);v|=in_cb(user_data)<<8;pc+=2;
+#define _FETCH_U16(v) v=_m6502dasm_fetch(ctx);v|=_m6502dasm_fetch(ctx)<<8;pc+=2;
 /* output character */
 #ifdef _CHR
 #undef _CHR
 #endif
-#define _CHR(c) if (out_cb) { out_cb(c,user_data); }
+#define _CHR(c) _m6502dasm_chr(c,ctx);
 /* output string */
 #ifdef _STR
 #undef _STR
 #endif
-#define _STR(s) _m6502dasm_str(s,out_cb,user_data);
+#define _STR(s) _m6502dasm_str(s,ctx);
 /* output number as unsigned 8-bit string (hex) */
 #ifdef _STR_U8
 #undef _STR_U8
 #endif
-#define _STR_U8(u8) _m6502dasm_u8((uint8_t)(u8),out_cb,user_data);
+#define _STR_U8(u8) _m6502dasm_u8((uint8_t)(u8),ctx);
 /* output number number as unsigned 16-bit string (hex) */
 #ifdef _STR_U16
 #undef _STR_U16
 #endif
-#define _STR_U16(u16) _m6502dasm_u16((uint16_t)(u16),out_cb,user_data);
+#define _STR_U16(u16) _m6502dasm_u16((uint16_t)(u16),ctx);
+/* undocumented instruction flag in mnemonic id */
+#ifdef _ILL
+#undef _ILL
+#endif
+#define _ILL (0x80)
 
 /* addressing modes */
 #define A____    (0)     /* no addressing mode */
@@ -191,39 +368,95 @@ static uint8_t _m6502dasm_ops[4][8][8] = {
 
 static const char* _m6502dasm_hex = "0123456789ABCDEF";
 
+/* mnemonic names, indexed by M6502DASM_MN_xxx */
+static const char* _m6502dasm_names[M6502DASM_MN_NUM] = {
+    "???", "ADC", "AND", "ASL", "BCC", "BCS", "BEQ", "BIT", "BMI", "BNE", "BPL", "BRK", "BVC", "BVS", "CLC", "CLD", "CLI", "CLV", "CMP", "CPX", "CPY", "DEC", "DEX", "DEY", "EOR", "INC", "INX", "INY", "JMP", "JSR", "LDA", "LDX", "LDY", "LSR", "NOP", "ORA", "PHA", "PHP", "PLA", "PLP", "ROL", "ROR", "RTI", "RTS", "SBC", "SEC", "SED", "SEI", "STA", "STX", "STY", "TAX", "TAY", "TSX", "TXA", "TXS", "TYA", "SLO", "RLA", "SRE", "RRA", "SAX", "LAX", "DCP", "ISB"
+};
+
+/* maps internal addressing modes to M6502DASM_AM_xxx */
+static const uint8_t _m6502dasm_am[14] = {
+    M6502DASM_AM_NONE, M6502DASM_AM_IMM, M6502DASM_AM_ZP, M6502DASM_AM_ZPX,
+    M6502DASM_AM_ZPY, M6502DASM_AM_ABS, M6502DASM_AM_ABX, M6502DASM_AM_ABY,
+    M6502DASM_AM_IDX, M6502DASM_AM_IDY, M6502DASM_AM_ABS, M6502DASM_AM_ABS,
+    M6502DASM_AM_REL, M6502DASM_AM_NONE
+};
+
+/* a zero-initialized instruction record */
+static const m6502dasm_inst_t _m6502dasm_inst_zero = {0};
+
+/* decoder state, instruction bytes either come from a callback or a buffer */
+typedef struct {
+    m6502dasm_input_t in_cb;
+    void* user_data;
+    const uint8_t* bytes;
+    size_t num_bytes;
+    size_t base;    /* buffer offset of current instruction */
+    size_t pos;     /* byte offset in current instruction */
+    bool text;
+    int str_pos;
+    char str[M6502DASM_MAX_STRLEN];
+    m6502dasm_inst_t* inst;
+} _m6502dasm_ctx_t;
+
+/* helper function to fetch the next instruction byte */
+static inline uint8_t _m6502dasm_fetch(_m6502dasm_ctx_t* ctx) {
+    uint8_t val = 0;
+    if (ctx->in_cb) {
+        val = ctx->in_cb(ctx->user_data);
+    }
+    else if ((ctx->base + ctx->pos) < ctx->num_bytes) {
+        val = ctx->bytes[ctx->base + ctx->pos];
+    }
+    if (ctx->pos < M6502DASM_MAX_BYTES) {
+        ctx->inst->bytes[ctx->pos] = val;
+    }
+    ctx->pos++;
+    return val;
+}
+
+/* helper function to output a character */
+static inline void _m6502dasm_chr(char c, _m6502dasm_ctx_t* ctx) {
+    if (ctx->text && ((ctx->str_pos + 1) < M6502DASM_MAX_STRLEN)) {
+        ctx->str[ctx->str_pos++] = c;
+    }
+}
+
 /* helper function to output string */
-static void _m6502dasm_str(const char* str, m6502dasm_output_t out_cb, void* user_data) {
-    if (out_cb) {
+static void _m6502dasm_str(const char* str, _m6502dasm_ctx_t* ctx) {
+    if (ctx->text) {
         char c;
         while (0 != (c = *str++)) {
-            out_cb(c, user_data);
+            _m6502dasm_chr(c, ctx);
         }
     }
 }
 
 /* helper function to output an unsigned 8-bit value as hex string */
-static void _m6502dasm_u8(uint8_t val, m6502dasm_output_t out_cb, void* user_data) {
-    if (out_cb) {
-        out_cb('$', user_data);
+static void _m6502dasm_u8(uint8_t val, _m6502dasm_ctx_t* ctx) {
+    if (ctx->text) {
+        _m6502dasm_chr('$', ctx);
         for (int i = 1; i >= 0; i--) {
-            out_cb(_m6502dasm_hex[(val>>(i*4)) & 0xF], user_data);
+            _m6502dasm_chr(_m6502dasm_hex[(val>>(i*4)) & 0xF], ctx);
         }
     }
 }
 
 /* helper function to output an unsigned 16-bit value as hex string */
-static void _m6502dasm_u16(uint16_t val, m6502dasm_output_t out_cb, void* user_data) {
-    if (out_cb) {
-        out_cb('$', user_data);
+static void _m6502dasm_u16(uint16_t val, _m6502dasm_ctx_t* ctx) {
+    if (ctx->text) {
+        _m6502dasm_chr('$', ctx);
         for (int i = 3; i >= 0; i--) {
-            out_cb(_m6502dasm_hex[(val>>(i*4)) & 0xF], user_data);
+            _m6502dasm_chr(_m6502dasm_hex[(val>>(i*4)) & 0xF], ctx);
         }
     }
 }
 
-/* main disassembler function */
-uint16_t m6502dasm_op(uint16_t pc, m6502dasm_input_t in_cb, m6502dasm_output_t out_cb, void* user_data) {
-    CHIPS_ASSERT(in_cb);
+/* main decoder function */
+static uint16_t _m6502dasm_decode(uint16_t pc, _m6502dasm_ctx_t* ctx) {
+    m6502dasm_inst_t* inst = ctx->inst;
+    *inst = _m6502dasm_inst_zero;
+    inst->addr = pc;
+    ctx->pos = 0;
     uint8_t op;
     _FETCH_U8(op);
     uint8_t cc  = op & 0x03;
@@ -231,86 +464,86 @@ uint16_t m6502dasm_op(uint16_t pc, m6502dasm_input_t in_cb, m6502dasm_output_t o
     uint8_t aaa = (op >> 5) & 0x07;
 
     /* opcode name */
-    const char* n = "???";
+    uint8_t n = M6502DASM_MN_INVALID;
     bool indirect = false;
     switch (cc) {
         case 0:
             switch (aaa) {
                 case 0:
                     switch (bbb) {
-                        case 0:  n = "BRK"; break;
-                        case 2:  n = "PHP"; break;
-                        case 4:  n = "BPL"; break;
-                        case 6:  n = "CLC"; break;
-                        default: n = "*NOP"; break;
+                        case 0:  n = M6502DASM_MN_BRK; break;
+                        case 2:  n = M6502DASM_MN_PHP; break;
+                        case 4:  n = M6502DASM_MN_BPL; break;
+                        case 6:  n = M6502DASM_MN_CLC; break;
+                        default: n = M6502DASM_MN_NOP|_ILL; break;
                     }
                     break;
                 case 1:
                     switch (bbb) {
-                        case 0:  n = "JSR"; break;
-                        case 2:  n = "PLP"; break;
-                        case 4:  n = "BMI"; break;
-                        case 5:  n = "*NOP"; break;
-                        case 6:  n = "SEC"; break;
-                        case 7:  n = "*NOP"; break;
-                        default: n = "BIT"; break;
+                        case 0:  n = M6502DASM_MN_JSR; break;
+                        case 2:  n = M6502DASM_MN_PLP; break;
+                        case 4:  n = M6502DASM_MN_BMI; break;
+                        case 5:  n = M6502DASM_MN_NOP|_ILL; break;
+                        case 6:  n = M6502DASM_MN_SEC; break;
+                        case 7:  n = M6502DASM_MN_NOP|_ILL; break;
+                        default: n = M6502DASM_MN_BIT; break;
                     }
                     break;
                 case 2:
                     switch (bbb) {
-                        case 0:  n = "RTI"; break;
-                        case 2:  n = "PHA"; break;
-                        case 3:  n = "JMP"; break;
-                        case 4:  n = "BVC"; break;
-                        case 6:  n = "CLI"; break;
-                        default: n = "*NOP"; break;
+                        case 0:  n = M6502DASM_MN_RTI; break;
+                        case 2:  n = M6502DASM_MN_PHA; break;
+                        case 3:  n = M6502DASM_MN_JMP; break;
+                        case 4:  n = M6502DASM_MN_BVC; break;
+                        case 6:  n = M6502DASM_MN_CLI; break;
+                        default: n = M6502DASM_MN_NOP|_ILL; break;
                     }
                     break;
                 case 3:
                     switch (bbb) {
-                        case 0:  n = "RTS"; break;
-                        case 2:  n = "PLA"; break;
-                        case 3:  n = "JMP"; indirect = true; break;  /* jmp () */
-                        case 4:  n = "BVS"; break;
-                        case 6:  n = "SEI"; break;
-                        default: n = "*NOP"; break;
+                        case 0:  n = M6502DASM_MN_RTS; break;
+                        case 2:  n = M6502DASM_MN_PLA; break;
+                        case 3:  n = M6502DASM_MN_JMP; indirect = true; break;  /* jmp () */
+                        case 4:  n = M6502DASM_MN_BVS; break;
+                        case 6:  n = M6502DASM_MN_SEI; break;
+                        default: n = M6502DASM_MN_NOP|_ILL; break;
                     }
                     break;
                 case 4:
                     switch (bbb) {
-                        case 0:  n = "*NOP"; break;
-                        case 2:  n = "DEY"; break;
-                        case 4:  n = "BCC"; break;
-                        case 6:  n = "TYA"; break;
-                        default: n = "STY"; break;
+                        case 0:  n = M6502DASM_MN_NOP|_ILL; break;
+                        case 2:  n = M6502DASM_MN_DEY; break;
+                        case 4:  n = M6502DASM_MN_BCC; break;
+                        case 6:  n = M6502DASM_MN_TYA; break;
+                        default: n = M6502DASM_MN_STY; break;
                     }
                     break;
                 case 5:
                     switch (bbb) {
-                        case 2:  n = "TAY"; break;
-                        case 4:  n = "BCS"; break;
-                        case 6:  n = "CLV"; break;
-                        default: n = "LDY"; break;
+                        case 2:  n = M6502DASM_MN_TAY; break;
+                        case 4:  n = M6502DASM_MN_BCS; break;
+                        case 6:  n = M6502DASM_MN_CLV; break;
+                        default: n = M6502DASM_MN_LDY; break;
                     }
                     break;
                 case 6:
                     switch (bbb) {
-                        case 2:  n = "INY"; break;
-                        case 4:  n = "BNE"; break;
-                        case 5:  n = "*NOP"; break;
-                        case 6:  n = "CLD"; break;
-                        case 7:  n = "*NOP"; break;
-                        default: n = "CPY"; break;
+                        case 2:  n = M6502DASM_MN_INY; break;
+                        case 4:  n = M6502DASM_MN_BNE; break;
+                        case 5:  n = M6502DASM_MN_NOP|_ILL; break;
+                        case 6:  n = M6502DASM_MN_CLD; break;
+                        case 7:  n = M6502DASM_MN_NOP|_ILL; break;
+                        default: n = M6502DASM_MN_CPY; break;
                     }
                     break;
                 case 7:
                     switch (bbb) {
-                        case 2:  n = "INX"; break;
-                        case 4:  n = "BEQ"; break;
-                        case 5:  n = "*NOP"; break;
-                        case 6:  n = "SED"; break;
-                        case 7:  n = "*NOP"; break;
-                        default: n = "CPX"; break;
+                        case 2:  n = M6502DASM_MN_INX; break;
+                        case 4:  n = M6502DASM_MN_BEQ; break;
+                        case 5:  n = M6502DASM_MN_NOP|_ILL; break;
+                        case 6:  n = M6502DASM_MN_SED; break;
+                        case 7:  n = M6502DASM_MN_NOP|_ILL; break;
+                        default: n = M6502DASM_MN_CPX; break;
                     }
                     break;
             }
@@ -318,19 +551,19 @@ uint16_t m6502dasm_op(uint16_t pc, m6502dasm_input_t in_cb, m6502dasm_output_t o
 
         case 1:
             switch (aaa) {
-                case 0: n = "ORA"; break;
-                case 1: n = "AND"; break; /* AND A */
-                case 2: n = "EOR"; break;
-                case 3: n = "ADC"; break;
+                case 0: n = M6502DASM_MN_ORA; break;
+                case 1: n = M6502DASM_MN_AND; break; /* AND A */
+                case 2: n = M6502DASM_MN_EOR; break;
+                case 3: n = M6502DASM_MN_ADC; break;
                 case 4:
                     switch (bbb) {
-                        case 2:  n = "*NOP"; break;
-                        default: n = "STA"; break;
+                        case 2:  n = M6502DASM_MN_NOP|_ILL; break;
+                        default: n = M6502DASM_MN_STA; break;
                     }
                     break;
-                case 5: n = "LDA"; break;
-                case 6: n = "CMP"; break;
-                case 7: n = "SBC"; break;
+                case 5: n = M6502DASM_MN_LDA; break;
+                case 6: n = M6502DASM_MN_CMP; break;
+                case 7: n = M6502DASM_MN_SBC; break;
             }
             break;
 
@@ -338,57 +571,57 @@ uint16_t m6502dasm_op(uint16_t pc, m6502dasm_input_t in_cb, m6502dasm_output_t o
             switch (aaa) {
                 case 0:
                     switch (bbb) {
-                        case 6:  n = "*NOP"; break;
-                        default: n = "ASL"; break;
+                        case 6:  n = M6502DASM_MN_NOP|_ILL; break;
+                        default: n = M6502DASM_MN_ASL; break;
                     }
                     break;
                 case 1:
                     switch (bbb) {
-                        case 6:  n = "*NOP"; break;
-                        default: n = "ROL"; break;
+                        case 6:  n = M6502DASM_MN_NOP|_ILL; break;
+                        default: n = M6502DASM_MN_ROL; break;
                     }
                     break;
                 case 2:
                     switch (bbb) {
-                        case 6:  n = "*NOP"; break;
-                        default: n = "LSR"; break;
+                        case 6:  n = M6502DASM_MN_NOP|_ILL; break;
+                        default: n = M6502DASM_MN_LSR; break;
                     }
                     break;
                 case 3:
                     switch (bbb) {
-                        case 6:  n = "*NOP"; break;
-                        default: n = "ROR"; break;
+                        case 6:  n = M6502DASM_MN_NOP|_ILL; break;
+                        default: n = M6502DASM_MN_ROR; break;
                     }
                     break;
                 case 4:
                     switch (bbb) {
-                        case 0:  n = "*NOP"; break;
-                        case 2:  n = "TXA"; break;
-                        case 6:  n = "TXS"; break;
-                        default: n = "STX"; break;
+                        case 0:  n = M6502DASM_MN_NOP|_ILL; break;
+                        case 2:  n = M6502DASM_MN_TXA; break;
+                        case 6:  n = M6502DASM_MN_TXS; break;
+                        default: n = M6502DASM_MN_STX; break;
                     }
                     break;
                 case 5:
                     switch (bbb) {
-                        case 2:  n = "TAX"; break;
-                        case 6:  n = "TSX"; break;
-                        default: n = "LDX"; break;
+                        case 2:  n = M6502DASM_MN_TAX; break;
+                        case 6:  n = M6502DASM_MN_TSX; break;
+                        default: n = M6502DASM_MN_LDX; break;
                     }
                     break;
                 case 6:
                     switch (bbb) {
-                        case 0:  n = "*NOP"; break;
-                        case 2:  n = "DEX"; break;
-                        case 6:  n = "*NOP"; break;
-                        default: n = "DEC"; break;
+                        case 0:  n = M6502DASM_MN_NOP|_ILL; break;
+                        case 2:  n = M6502DASM_MN_DEX; break;
+                        case 6:  n = M6502DASM_MN_NOP|_ILL; break;
+                        default: n = M6502DASM_MN_DEC; break;
                     }
                     break;
                 case 7:
                     switch (bbb) {
-                        case 0:  n = "*NOP"; break;
-                        case 2:  n = "NOP"; break;
-                        case 6:  n = "*NOP"; break;
-                        default: n = "INC"; break;
+                        case 0:  n = M6502DASM_MN_NOP|_ILL; break;
+                        case 2:  n = M6502DASM_MN_NOP; break;
+                        case 6:  n = M6502DASM_MN_NOP|_ILL; break;
+                        default: n = M6502DASM_MN_INC; break;
                     }
                     break;
             }
@@ -396,25 +629,47 @@ uint16_t m6502dasm_op(uint16_t pc, m6502dasm_input_t in_cb, m6502dasm_output_t o
 
         case 3:
             switch (aaa) {
-                case 0: n = "*SLO"; break;
-                case 1: n = "*RLA"; break;
-                case 2: n = "*SRE"; break;
-                case 3: n = "*RRA"; break;
-                case 4: n = "*SAX"; break;
-                case 5: n = "*LAX"; break;
-                case 6: n = "*DCP"; break;
+                case 0: n = M6502DASM_MN_SLO|_ILL; break;
+                case 1: n = M6502DASM_MN_RLA|_ILL; break;
+                case 2: n = M6502DASM_MN_SRE|_ILL; break;
+                case 3: n = M6502DASM_MN_RRA|_ILL; break;
+                case 4: n = M6502DASM_MN_SAX|_ILL; break;
+                case 5: n = M6502DASM_MN_LAX|_ILL; break;
+                case 6: n = M6502DASM_MN_DCP|_ILL; break;
                 case 7:
                     switch (bbb) {
-                        case 2:  n = "*SBC"; break;
-                        default: n = "*ISB"; break;
+                        case 2:  n = M6502DASM_MN_SBC|_ILL; break;
+                        default: n = M6502DASM_MN_ISB|_ILL; break;
                     }
                     break;
             }
     }
-    _STR(n);
+    if (n & _ILL) {
+        _CHR('*');
+    }
+    _STR(_m6502dasm_names[n & ~_ILL]);
+    ctx->inst->mnemonic = n & ~_ILL;
+    ctx->inst->illegal = 0 != (n & _ILL);
+
+    /* control flow type */
+    switch (ctx->inst->mnemonic) {
+        case M6502DASM_MN_BRK:
+        case M6502DASM_MN_JSR:
+            ctx->inst->flow = M6502DASM_FLOW_CALL;
+            break;
+        case M6502DASM_MN_RTS:
+        case M6502DASM_MN_RTI:
+            ctx->inst->flow = M6502DASM_FLOW_RET;
+            break;
+        case M6502DASM_MN_JMP:
+            ctx->inst->flow = indirect ? M6502DASM_FLOW_JUMP_INDIRECT : M6502DASM_FLOW_JUMP;
+            break;
+    }
 
-    uint8_t u8; int8_t i8; uint16_t u16;
-    switch (_m6502dasm_ops[cc][bbb][aaa]) {
+    uint8_t u8 = 0; int8_t i8 = 0; uint16_t u16 = 0;
+    const uint8_t mode = _m6502dasm_ops[cc][bbb][aaa];
+    ctx->inst->mode = (indirect && (mode == A_JMP)) ? (uint8_t)M6502DASM_AM_IND : _m6502dasm_am[mode];
+    switch (mode) {
         case A_IMM:
             _CHR(' '); _FETCH_U8(u8); _CHR('#'); _STR_U8(u8);
             break;
@@ -431,6 +686,10 @@ uint16_t m6502dasm_op(uint16_t pc, m6502dasm_input_t in_cb, m6502dasm_output_t o
         case A_JSR:
         case A_JMP:
             _CHR(' '); _FETCH_U16(u16);
+            if ((mode != A_ABS) && !indirect) {
+                ctx->inst->target = u16;
+                ctx->inst->has_target = true;
+            }
             if (indirect) {
                 _CHR('('); _STR_U16(u16); _CHR(')');
             }
@@ -452,12 +711,75 @@ uint16_t m6502dasm_op(uint16_t pc, m6502dasm_input_t in_cb, m6502dasm_output_t o
             break;
         case A_BRA: /* relative branch, compute target address */
             _CHR(' '); _FETCH_I8(i8); _STR_U16(pc+i8);
+            ctx->inst->flow = M6502DASM_FLOW_JUMP;
+            ctx->inst->cond = true;
+            ctx->inst->target = (uint16_t)(pc+i8);
+            ctx->inst->has_target = true;
+            u8 = (uint8_t)i8;
             break;
 
     }
+    ctx->inst->operand = (ctx->pos == 3) ? u16 : u8;
+    ctx->inst->len = (uint8_t) ctx->pos;
     return pc;
 }
 
+uint16_t m6502dasm_op(uint16_t pc, m6502dasm_input_t in_cb, m6502dasm_output_t out_cb, void* user_data) {
+    CHIPS_ASSERT(in_cb);
+    m6502dasm_inst_t inst;
+    _m6502dasm_ctx_t ctx = {0};
+    ctx.in_cb = in_cb;
+    ctx.user_data = user_data;
+    ctx.text = (0 != out_cb);
+    ctx.inst = &inst;
+    pc = _m6502dasm_decode(pc, &ctx);
+    for (int i = 0; i < ctx.str_pos; i++) {
+        out_cb(ctx.str[i], user_data);
+    }
+    return pc;
+}
+
+int m6502dasm_decode(uint16_t addr, const uint8_t* bytes, size_t num_bytes, m6502dasm_inst_t* out_inst) {
+    CHIPS_ASSERT(bytes && out_inst);
+    return (1 == m6502dasm_decode_range(addr, bytes, num_bytes, out_inst, 1)) ? out_inst->len : 0;
+}
+
+size_t m6502dasm_decode_range(uint16_t addr, const uint8_t* bytes, size_t num_bytes, m6502dasm_inst_t* insts, size_t max_insts) {
+    CHIPS_ASSERT(bytes && insts);
+    _m6502dasm_ctx_t ctx = {0};
+    ctx.bytes = bytes;
+    ctx.num_bytes = num_bytes;
+    size_t num_insts = 0;
+    while ((num_insts < max_insts) && (ctx.base < num_bytes)) {
+        ctx.inst = &insts[num_insts];
+        addr = _m6502dasm_decode(addr, &ctx);
+        if ((ctx.base + ctx.pos) > num_bytes) {
+            /* instruction doesn't fit into the buffer */
+            break;
+        }
+        ctx.base += ctx.pos;
+        num_insts++;
+    }
+    return num_insts;
+}
+
+int m6502dasm_render(const m6502dasm_inst_t* inst, char* buf, int buf_size) {
+    CHIPS_ASSERT(inst && buf && (buf_size > 0));
+    m6502dasm_inst_t tmp;
+    _m6502dasm_ctx_t ctx = {0};
+    ctx.bytes = inst->bytes;
+    ctx.num_bytes = inst->len;
+    ctx.text = true;
+    ctx.inst = &tmp;
+    _m6502dasm_decode(inst->addr, &ctx);
+    int len = (ctx.str_pos < buf_size) ? ctx.str_pos : (buf_size - 1);
+    for (int i = 0; i < len; i++) {
+        buf[i] = ctx.str[i];
+    }
+    buf[len] = 0;
+    return len;
+}
+
 #undef _FETCH_I8
 #undef _FETCH_U8
 #undef _FETCH_U16
@@ -465,6 +787,7 @@ uint16_t m6502dasm_op(uint16_t pc, m6502dasm_input_t in_cb, m6502dasm_output_t o
 #undef _STR
 #undef _STR_U8
 #undef _STR_U16
+#undef _ILL
 #undef A____
 #undef A_IMM
 #undef A_ZER
@@ -477,6 +800,7 @@ uint16_t m6502dasm_op(uint16_t pc, m6502dasm_input_t in_cb, m6502dasm_output_t o
 #undef A_IDY
 #undef A_JMP
 #undef A_JSR
+#undef A_BRA
 #undef A_INV
 #undef M___
 #undef M_R_
@@ -0,0 +1,373 @@
+#pragma once
+/*#
+    # pagepool.h
+
+    A shared pool of deduplicated 1 KByte memory pages for storing the
+    snapshots of many system instances.
+
+    Do this:
+    ~~~C
+    #define CHIPS_UTIL_IMPL
+    ~~~
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Optionally provide the following macros with your own implementation
+
+    ~~~C
+    CHIPS_ASSERT(c)
+    ~~~
+        your own assert macro (default: assert(c))
+
+    You need to include the following headers before including pagepool.h:
+
+    - chips/chips_common.h
+
+    ## Overview
+
+    Instances of the same system running the same program are mostly
+    identical: the ROM images are the same, large parts of the RAM are
+    either unused (all zeros) or contain the same program code and data,
+    and the tape or disc buffers are often empty. When such instances are
+    parked as snapshots (for instance the idle instances of a big test run,
+    or the periodic snapshots of a fleet of machines), most of the snapshot
+    pages only need to be stored once.
+
+    The page pool splits a snapshot into pages of PAGEPOOL_PAGE_SIZE bytes
+    (the same size as a mem.h memory page), hashes each page and looks it
+    up in a hash table. A page which is already in the pool only increments
+    a reference count, new pages are copied into the pool. The stored
+    snapshot is then an array of page ids, which is everything the caller
+    needs to keep per parked instance.
+
+    Pages in the pool are never modified, a changed page in a new snapshot
+    is simply a different page. Storing the new snapshot of an instance
+    and releasing its old snapshot only allocates the pages which have
+    actually changed.
+
+    The pool doesn't allocate memory, all memory is provided by the caller
+    in pagepool_init(). Page lookups are single-threaded, use one pool per
+    thread or protect the pool with a lock.
+
+    ## Usage
+
+    Initialize a pool for up to 64k pages (64 MBytes):
+
+    ~~~C
+    static pagepool_t pool;
+    static uint8_t pool_memory[PAGEPOOL_MEMORY_SIZE(65536)];
+    pagepool_init(&pool, &(pagepool_desc_t){
+        .num_pages = 65536,
+        .memory = { .ptr = pool_memory, .size = sizeof(pool_memory) },
+    });
+    ~~~
+
+    Park an instance by saving a snapshot and storing it in the pool:
+
+    ~~~C
+    static c64_t snapshot;
+    static uint32_t page_ids[NUM_INSTANCES][PAGEPOOL_NUM_PAGES(C64_SNAPSHOT_SIZE)];
+
+    const uint32_t version = c64_save_snapshot(&sys, &snapshot);
+    if (!pagepool_store(&pool, (chips_range_t){ &snapshot, C64_SNAPSHOT_SIZE }, page_ids[i])) {
+        // pool is full
+    }
+    ~~~
+
+    ...and bring it back to life:
+
+    ~~~C
+    pagepool_restore(&pool, page_ids[i], (chips_range_t){ &snapshot, C64_SNAPSHOT_SIZE });
+    c64_load_snapshot(&sys, version, &snapshot);
+    ~~~
+
+    Release the pages of a stored snapshot when it is no longer needed:
+
+    ~~~C
+    pagepool_release(&pool, page_ids[i], PAGEPOOL_NUM_PAGES(C64_SNAPSHOT_SIZE));
+    ~~~
+
+    ## Functions
+
+    ~~~C
+    void pagepool_init(pagepool_t* pool, const pagepool_desc_t* desc)
+    ~~~
+        Initialize a page pool with caller-provided memory, which must be
+        at least PAGEPOOL_MEMORY_SIZE(num_pages) bytes and 8-byte aligned.
+
+        ~~~C
+        typedef struct {
+            uint32_t num_pages;     // max number of unique pages in the pool
+            chips_range_t memory;   // memory for the page data and lookup tables
+        } pagepool_desc_t;
+        ~~~
+
+    ~~~C
+    bool pagepool_store(pagepool_t* pool, chips_range_t data, uint32_t* out_page_ids)
+    ~~~
+        Store a memory range in the pool and write PAGEPOOL_NUM_PAGES(data.size)
+        page ids to out_page_ids (the last page is padded with zeros).
+        Returns false if the pool doesn't have enough free pages, nothing
+        is stored in this case.
+
+    ~~~C
+    void pagepool_restore(pagepool_t* pool, const uint32_t* page_ids, chips_range_t dst)
+    ~~~
+        Copy the pages of a stored memory range into dst, dst.size must be
+        the size of the stored range.
+
+    ~~~C
+    void pagepool_release(pagepool_t* pool, const uint32_t* page_ids, size_t num_pages)
+    ~~~
+        Release the pages of a stored memory range, pages which are no
+        longer referenced become free.
+
+    ~~~C
+    pagepool_stats_t pagepool_stats(const pagepool_t* pool)
+    ~~~
+        Get the current pool usage.
+
+        ~~~C
+        typedef struct {
+            uint32_t num_pages;     // max number of unique pages
+            uint32_t used_pages;    // number of unique pages in use
+            uint64_t num_refs;      // number of stored page references
+        } pagepool_stats_t;
+        ~~~
+
+        The memory saved by deduplication is (num_refs - used_pages) *
+        PAGEPOOL_PAGE_SIZE bytes.
+
+    ## zlib/libpng license
+
+    Copyright (c) 2018 Andre Weissflog
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// page size (same as the mem.h page size)
+#define PAGEPOOL_PAGE_SIZE (1024)
+// number of pages needed to store a memory range
+#define PAGEPOOL_NUM_PAGES(size) (((size) + PAGEPOOL_PAGE_SIZE - 1) / PAGEPOOL_PAGE_SIZE)
+// number of hash table buckets per page
+#define PAGEPOOL_BUCKETS_PER_PAGE (2)
+// memory needed for a pool of num_pages pages
+#define PAGEPOOL_MEMORY_SIZE(num_pages) ((size_t)(num_pages) * (PAGEPOOL_PAGE_SIZE + sizeof(pagepool_page_t) + PAGEPOOL_BUCKETS_PER_PAGE * sizeof(uint32_t)))
+
+typedef struct {
+    uint32_t num_pages;     // max number of unique pages in the pool
+    chips_range_t memory;   // memory for the page data and lookup tables
+} pagepool_desc_t;
+
+typedef struct {
+    uint32_t num_pages;     // max number of unique pages
+    uint32_t used_pages;    // number of unique pages in use
+    uint64_t num_refs;      // number of stored page references
+} pagepool_stats_t;
+
+// a page entry in the pool
+typedef struct {
+    uint64_t hash;
+    uint32_t refs;          // reference count, 0 if the page is free
+    uint32_t next;          // next page in the hash bucket chain, or in the free list
+} pagepool_page_t;
+
+typedef struct {
+    bool valid;
+    uint32_t num_pages;
+    uint32_t bucket_mask;
+    pagepool_page_t* pages;
+    uint32_t* buckets;      // first page of each hash bucket chain
+    uint8_t* data;          // page data
+    uint32_t free_list;     // first free page
+    uint32_t used_pages;
+    uint64_t num_refs;
+} pagepool_t;
+
+void pagepool_init(pagepool_t* pool, const pagepool_desc_t* desc);
+bool pagepool_store(pagepool_t* pool, chips_range_t data, uint32_t* out_page_ids);
+void pagepool_restore(pagepool_t* pool, const uint32_t* page_ids, chips_range_t dst);
+void pagepool_release(pagepool_t* pool, const uint32_t* page_ids, size_t num_pages);
+pagepool_stats_t pagepool_stats(const pagepool_t* pool);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_UTIL_IMPL
+#include <string.h> // memset, memcpy, memcmp
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+#define _PAGEPOOL_NONE (0xFFFFFFFF)
+
+void pagepool_init(pagepool_t* pool, const pagepool_desc_t* desc) {
+    CHIPS_ASSERT(pool && desc);
+    CHIPS_ASSERT((desc->num_pages > 0) && (desc->num_pages < _PAGEPOOL_NONE));
+    CHIPS_ASSERT(desc->memory.ptr && (0 == ((uintptr_t)desc->memory.ptr & 7)));
+    CHIPS_ASSERT(desc->memory.size >= PAGEPOOL_MEMORY_SIZE(desc->num_pages));
+    memset(pool, 0, sizeof(pagepool_t));
+    pool->valid = true;
+    pool->num_pages = desc->num_pages;
+    // the number of buckets is the biggest power of 2 which fits into the provided memory
+    uint32_t num_buckets = 1;
+    while ((num_buckets * 2) <= (desc->num_pages * PAGEPOOL_BUCKETS_PER_PAGE)) {
+        num_buckets *= 2;
+    }
+    pool->bucket_mask = num_buckets - 1;
+    uint8_t* ptr = (uint8_t*) desc->memory.ptr;
+    pool->pages = (pagepool_page_t*) ptr;
+    ptr += desc->num_pages * sizeof(pagepool_page_t);
+    pool->buckets = (uint32_t*) ptr;
+    ptr += desc->num_pages * PAGEPOOL_BUCKETS_PER_PAGE * sizeof(uint32_t);
+    pool->data = ptr;
+    for (uint32_t i = 0; i < num_buckets; i++) {
+        pool->buckets[i] = _PAGEPOOL_NONE;
+    }
+    for (uint32_t i = 0; i < desc->num_pages; i++) {
+        pool->pages[i].hash = 0;
+        pool->pages[i].refs = 0;
+        pool->pages[i].next = ((i + 1) < desc->num_pages) ? (i + 1) : _PAGEPOOL_NONE;
+    }
+    pool->free_list = 0;
+}
+
+// hash a page in 64-bit words
+static uint64_t _pagepool_hash(const uint8_t* ptr) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < PAGEPOOL_PAGE_SIZE; i += 8) {
+        uint64_t v;
+        memcpy(&v, ptr + i, sizeof(v));
+        hash = (hash ^ v) * 0x100000001B3ULL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+static inline uint8_t* _pagepool_data(pagepool_t* pool, uint32_t page_id) {
+    return pool->data + (size_t)page_id * PAGEPOOL_PAGE_SIZE;
+}
+
+// find or insert a page, returns the page id, or _PAGEPOOL_NONE if the pool is full
+static uint32_t _pagepool_insert(pagepool_t* pool, const uint8_t* page) {
+    const uint64_t hash = _pagepool_hash(page);
+    uint32_t* bucket = &pool->buckets[hash & pool->bucket_mask];
+    for (uint32_t id = *bucket; id != _PAGEPOOL_NONE; id = pool->pages[id].next) {
+        if ((pool->pages[id].hash == hash) && (0 == memcmp(_pagepool_data(pool, id), page, PAGEPOOL_PAGE_SIZE))) {
+            pool->pages[id].refs++;
+            pool->num_refs++;
+            return id;
+        }
+    }
+    const uint32_t id = pool->free_list;
+    if (id == _PAGEPOOL_NONE) {
+        return _PAGEPOOL_NONE;
+    }
+    pagepool_page_t* p = &pool->pages[id];
+    pool->free_list = p->next;
+    p->hash = hash;
+    p->refs = 1;
+    p->next = *bucket;
+    *bucket = id;
+    memcpy(_pagepool_data(pool, id), page, PAGEPOOL_PAGE_SIZE);
+    pool->used_pages++;
+    pool->num_refs++;
+    return id;
+}
+
+static void _pagepool_release_page(pagepool_t* pool, uint32_t id) {
+    CHIPS_ASSERT((id < pool->num_pages) && (pool->pages[id].refs > 0));
+    pagepool_page_t* p = &pool->pages[id];
+    pool->num_refs--;
+    if (--p->refs > 0) {
+        return;
+    }
+    // unlink from the hash bucket chain and put into the free list
+    uint32_t* link = &pool->buckets[p->hash & pool->bucket_mask];
+    while (*link != id) {
+        CHIPS_ASSERT(*link != _PAGEPOOL_NONE);
+        link = &pool->pages[*link].next;
+    }
+    *link = p->next;
+    p->next = pool->free_list;
+    pool->free_list = id;
+    pool->used_pages--;
+}
+
+bool pagepool_store(pagepool_t* pool, chips_range_t data, uint32_t* out_page_ids) {
+    CHIPS_ASSERT(pool && pool->valid && data.ptr && out_page_ids);
+    const uint8_t* src = (const uint8_t*) data.ptr;
+    const size_t num_pages = PAGEPOOL_NUM_PAGES(data.size);
+    for (size_t i = 0; i < num_pages; i++) {
+        const size_t offset = i * PAGEPOOL_PAGE_SIZE;
+        uint32_t id;
+        if ((offset + PAGEPOOL_PAGE_SIZE) <= data.size) {
+            id = _pagepool_insert(pool, src + offset);
+        }
+        else {
+            // the last page is padded with zeros
+            uint8_t page[PAGEPOOL_PAGE_SIZE] = { 0 };
+            memcpy(page, src + offset, data.size - offset);
+            id = _pagepool_insert(pool, page);
+        }
+        if (id == _PAGEPOOL_NONE) {
+            // pool is full, undo the pages stored so far
+            pagepool_release(pool, out_page_ids, i);
+            return false;
+        }
+        out_page_ids[i] = id;
+    }
+    return true;
+}
+
+void pagepool_restore(pagepool_t* pool, const uint32_t* page_ids, chips_range_t dst) {
+    CHIPS_ASSERT(pool && pool->valid && page_ids && dst.ptr);
+    uint8_t* ptr = (uint8_t*) dst.ptr;
+    const size_t num_pages = PAGEPOOL_NUM_PAGES(dst.size);
+    for (size_t i = 0; i < num_pages; i++) {
+        const uint32_t id = page_ids[i];
+        CHIPS_ASSERT((id < pool->num_pages) && (pool->pages[id].refs > 0));
+        const size_t offset = i * PAGEPOOL_PAGE_SIZE;
+        const size_t num_bytes = ((dst.size - offset) < PAGEPOOL_PAGE_SIZE) ? (dst.size - offset) : PAGEPOOL_PAGE_SIZE;
+        memcpy(ptr + offset, _pagepool_data(pool, id), num_bytes);
+    }
+}
+
+void pagepool_release(pagepool_t* pool, const uint32_t* page_ids, size_t num_pages) {
+    CHIPS_ASSERT(pool && pool->valid && (page_ids || (0 == num_pages)));
+    for (size_t i = 0; i < num_pages; i++) {
+        _pagepool_release_page(pool, page_ids[i]);
+    }
+}
+
+pagepool_stats_t pagepool_stats(const pagepool_t* pool) {
+    CHIPS_ASSERT(pool && pool->valid);
+    return (pagepool_stats_t){
+        .num_pages = pool->num_pages,
+        .used_pages = pool->used_pages,
+        .num_refs = pool->num_refs,
+    };
+}
+#endif /* CHIPS_UTIL_IMPL */
@@ -0,0 +1,451 @@
+#pragma once
+/*#
+    # pixconv.h
+
+    Convert the palette-indexed framebuffer of a system emulator into
+    RGBA8 or RGB565 pixels on the CPU (for instance for headless video
+    capture where no GPU is available).
+
+    Do this:
+    ~~~C
+    #define CHIPS_UTIL_IMPL
+    ~~~
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Optionally provide the following macros with your own implementation
+
+    ~~~C
+    CHIPS_ASSERT(c)
+    ~~~
+        your own assert macro (default: assert(c))
+
+    ~~~C
+    PIXCONV_USE_SIMD
+    ~~~
+        set to 0 to disable the SIMD code paths (default: 1)
+
+    You need to include the following headers before including pixconv.h:
+
+    - chips/chips_common.h
+
+    ## Overview
+
+    pixconv_convert() takes the framebuffer, visible screen rectangle and
+    color palette from a chips_display_info_t struct and writes the
+    visible area into a destination buffer, optionally with integer
+    scaling. By default only the framebuffer lines which are flagged in
+    chips_display_info_t.dirty_lines are converted (systems which don't
+    track dirty lines always convert the whole screen), so the destination
+    buffer must be preserved between calls.
+
+    The SIMD code path is selected at compile time:
+
+    - SSE4.1 (and up): palettes with up to 16 colors use byte-shuffles
+    - AVX2: larger palettes use 32-bit gathers
+    - AArch64 NEON: palettes with up to 64 colors use table lookups
+
+    Everything else (and pixels with out-of-range color indices) goes
+    through the scalar code path. Framebuffers with 4 bytes per pixel are
+    copied (RGBA8) or packed (RGB565) without a palette lookup.
+
+    The 'portrait' flag in chips_display_info_t is ignored, rotating the
+    output is left to the caller.
+
+    ## Usage
+
+    ~~~C
+    static uint32_t pixels[PIXCONV_MAX_WIDTH * 320];
+
+    zx_exec(&sys, frame_time_us);
+    const chips_display_info_t info = zx_display_info(&sys);
+    int num_lines = pixconv_convert(&info, &(pixconv_desc_t){
+        .format = PIXCONV_FORMAT_RGBA8,
+        .dst = { .ptr = pixels, .size = sizeof(pixels) },
+    });
+    ~~~
+
+    ## Functions
+
+    ~~~C
+    int pixconv_convert(const chips_display_info_t* info, const pixconv_desc_t* desc)
+    ~~~
+        Convert the visible screen area, returns the number of converted
+        source lines (0 if nothing has changed).
+
+        ~~~C
+        typedef struct {
+            pixconv_format_t format;    // PIXCONV_FORMAT_RGBA8 or PIXCONV_FORMAT_RGB565
+            int scale;                  // integer scale factor (1..PIXCONV_MAX_SCALE), 0 is the same as 1
+            bool all_lines;             // convert all lines instead of only the dirty lines
+            chips_range_t dst;          // destination pixel buffer
+            size_t dst_pitch;           // bytes per destination row, 0 for tightly packed rows
+        } pixconv_desc_t;
+        ~~~
+
+    ~~~C
+    size_t pixconv_dst_size(const chips_display_info_t* info, pixconv_format_t format, int scale)
+    ~~~
+        Returns the size in bytes of a tightly packed destination buffer.
+
+    ## zlib/libpng license
+
+    Copyright (c) 2018 Andre Weissflog
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdalign.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// max width of the visible screen area in pixels
+#define PIXCONV_MAX_WIDTH (1024)
+// max integer scale factor
+#define PIXCONV_MAX_SCALE (4)
+
+typedef enum {
+    PIXCONV_FORMAT_RGBA8,   // 4 bytes per pixel in R,G,B,A memory order
+    PIXCONV_FORMAT_RGB565,  // 16 bits per pixel, red in the upper 5 bits
+} pixconv_format_t;
+
+typedef struct {
+    pixconv_format_t format;    // PIXCONV_FORMAT_RGBA8 or PIXCONV_FORMAT_RGB565
+    int scale;                  // integer scale factor (1..PIXCONV_MAX_SCALE), 0 is the same as 1
+    bool all_lines;             // convert all lines instead of only the dirty lines
+    chips_range_t dst;          // destination pixel buffer
+    size_t dst_pitch;           // bytes per destination row, 0 for tightly packed rows
+} pixconv_desc_t;
+
+// convert the visible screen area, returns number of converted source lines
+int pixconv_convert(const chips_display_info_t* info, const pixconv_desc_t* desc);
+// get the size of a tightly packed destination buffer in bytes
+size_t pixconv_dst_size(const chips_display_info_t* info, pixconv_format_t format, int scale);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_UTIL_IMPL
+#include <string.h> // memcpy
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+#ifndef PIXCONV_USE_SIMD
+    #define PIXCONV_USE_SIMD (1)
+#endif
+#if PIXCONV_USE_SIMD && defined(__SSE4_1__)
+    #include <smmintrin.h>
+    #define _PIXCONV_SSE4 (1)
+    #if defined(__AVX2__)
+        #include <immintrin.h>
+        #define _PIXCONV_AVX2 (1)
+    #endif
+#elif PIXCONV_USE_SIMD && defined(__aarch64__) && defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define _PIXCONV_NEON (1)
+#endif
+
+// the palette expanded to 256 entries, plus the first 64 entries split into byte planes for the SIMD lookups
+typedef struct {
+    int num_colors;
+    uint32_t rgba8[256];
+    uint32_t rgb565[256];   // in 32-bit slots for the AVX2 gathers
+    alignas(16) uint8_t rgba8_planes[4][64];
+    alignas(16) uint8_t rgb565_planes[2][64];
+} _pixconv_palette_t;
+
+static inline uint32_t _pixconv_rgb565(uint32_t c) {
+    const uint32_t r = c & 0xFF;
+    const uint32_t g = (c >> 8) & 0xFF;
+    const uint32_t b = (c >> 16) & 0xFF;
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+}
+
+static void _pixconv_init_palette(_pixconv_palette_t* pal, chips_range_t palette) {
+    const uint32_t* colors = (const uint32_t*) palette.ptr;
+    int num_colors = (int)(palette.size / sizeof(uint32_t));
+    if ((0 == colors) || (num_colors < 0)) {
+        num_colors = 0;
+    }
+    else if (num_colors > 256) {
+        num_colors = 256;
+    }
+    pal->num_colors = num_colors;
+    for (int i = 0; i < 256; i++) {
+        // out-of-range color indices are rendered as opaque black
+        const uint32_t c = (i < num_colors) ? colors[i] : 0xFF000000;
+        pal->rgba8[i] = c;
+        pal->rgb565[i] = _pixconv_rgb565(c);
+        if (i < 64) {
+            pal->rgba8_planes[0][i] = (uint8_t)c;
+            pal->rgba8_planes[1][i] = (uint8_t)(c >> 8);
+            pal->rgba8_planes[2][i] = (uint8_t)(c >> 16);
+            pal->rgba8_planes[3][i] = (uint8_t)(c >> 24);
+            pal->rgb565_planes[0][i] = (uint8_t)pal->rgb565[i];
+            pal->rgb565_planes[1][i] = (uint8_t)(pal->rgb565[i] >> 8);
+        }
+    }
+}
+
+static void _pixconv_line_rgba8(const _pixconv_palette_t* pal, const uint8_t* src, uint32_t* dst, int width) {
+    int x = 0;
+    #if defined(_PIXCONV_SSE4)
+    if (pal->num_colors <= 16) {
+        const __m128i tr = _mm_load_si128((const __m128i*)pal->rgba8_planes[0]);
+        const __m128i tg = _mm_load_si128((const __m128i*)pal->rgba8_planes[1]);
+        const __m128i tb = _mm_load_si128((const __m128i*)pal->rgba8_planes[2]);
+        const __m128i ta = _mm_load_si128((const __m128i*)pal->rgba8_planes[3]);
+        const __m128i hi_bits = _mm_set1_epi8((char)0xF0);
+        for (; (x + 16) <= width; x += 16) {
+            const __m128i idx = _mm_loadu_si128((const __m128i*)(src + x));
+            if (!_mm_testz_si128(idx, hi_bits)) {
+                // an out-of-range index, do this block on the scalar path
+                for (int i = 0; i < 16; i++) {
+                    dst[x + i] = pal->rgba8[src[x + i]];
+                }
+                continue;
+            }
+            const __m128i r = _mm_shuffle_epi8(tr, idx);
+            const __m128i g = _mm_shuffle_epi8(tg, idx);
+            const __m128i b = _mm_shuffle_epi8(tb, idx);
+            const __m128i a = _mm_shuffle_epi8(ta, idx);
+            const __m128i rg_lo = _mm_unpacklo_epi8(r, g);
+            const __m128i rg_hi = _mm_unpackhi_epi8(r, g);
+            const __m128i ba_lo = _mm_unpacklo_epi8(b, a);
+            const __m128i ba_hi = _mm_unpackhi_epi8(b, a);
+            _mm_storeu_si128((__m128i*)(dst + x + 0), _mm_unpacklo_epi16(rg_lo, ba_lo));
+            _mm_storeu_si128((__m128i*)(dst + x + 4), _mm_unpackhi_epi16(rg_lo, ba_lo));
+            _mm_storeu_si128((__m128i*)(dst + x + 8), _mm_unpacklo_epi16(rg_hi, ba_hi));
+            _mm_storeu_si128((__m128i*)(dst + x + 12), _mm_unpackhi_epi16(rg_hi, ba_hi));
+        }
+    }
+    #if defined(_PIXCONV_AVX2)
+    else {
+        for (; (x + 8) <= width; x += 8) {
+            const __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + x)));
+            _mm256_storeu_si256((__m256i*)(dst + x), _mm256_i32gather_epi32((const int*)pal->rgba8, idx, 4));
+        }
+    }
+    #endif
+    #elif defined(_PIXCONV_NEON)
+    if (pal->num_colors <= 64) {
+        const uint8x16x4_t tr = vld1q_u8_x4(pal->rgba8_planes[0]);
+        const uint8x16x4_t tg = vld1q_u8_x4(pal->rgba8_planes[1]);
+        const uint8x16x4_t tb = vld1q_u8_x4(pal->rgba8_planes[2]);
+        const uint8x16x4_t ta = vld1q_u8_x4(pal->rgba8_planes[3]);
+        for (; (x + 16) <= width; x += 16) {
+            const uint8x16_t idx = vld1q_u8(src + x);
+            if (vmaxvq_u8(idx) >= 64) {
+                // an out-of-range index, do this block on the scalar path
+                for (int i = 0; i < 16; i++) {
+                    dst[x + i] = pal->rgba8[src[x + i]];
+                }
+                continue;
+            }
+            uint8x16x4_t rgba;
+            rgba.val[0] = vqtbl4q_u8(tr, idx);
+            rgba.val[1] = vqtbl4q_u8(tg, idx);
+            rgba.val[2] = vqtbl4q_u8(tb, idx);
+            rgba.val[3] = vqtbl4q_u8(ta, idx);
+            vst4q_u8((uint8_t*)(dst + x), rgba);
+        }
+    }
+    #endif
+    for (; x < width; x++) {
+        dst[x] = pal->rgba8[src[x]];
+    }
+}
+
+static void _pixconv_line_rgb565(const _pixconv_palette_t* pal, const uint8_t* src, uint16_t* dst, int width) {
+    int x = 0;
+    #if defined(_PIXCONV_SSE4)
+    if (pal->num_colors <= 16) {
+        const __m128i tlo = _mm_load_si128((const __m128i*)pal->rgb565_planes[0]);
+        const __m128i thi = _mm_load_si128((const __m128i*)pal->rgb565_planes[1]);
+        const __m128i hi_bits = _mm_set1_epi8((char)0xF0);
+        for (; (x + 16) <= width; x += 16) {
+            const __m128i idx = _mm_loadu_si128((const __m128i*)(src + x));
+            if (!_mm_testz_si128(idx, hi_bits)) {
+                for (int i = 0; i < 16; i++) {
+                    dst[x + i] = (uint16_t)pal->rgb565[src[x + i]];
+                }
+                continue;
+            }
+            const __m128i lo = _mm_shuffle_epi8(tlo, idx);
+            const __m128i hi = _mm_shuffle_epi8(thi, idx);
+            _mm_storeu_si128((__m128i*)(dst + x + 0), _mm_unpacklo_epi8(lo, hi));
+            _mm_storeu_si128((__m128i*)(dst + x + 8), _mm_unpackhi_epi8(lo, hi));
+        }
+    }
+    #if defined(_PIXCONV_AVX2)
+    else {
+        for (; (x + 8) <= width; x += 8) {
+            const __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + x)));
+            const __m256i c = _mm256_i32gather_epi32((const int*)pal->rgb565, idx, 4);
+            const __m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(c), _mm256_extracti128_si256(c, 1));
+            _mm_storeu_si128((__m128i*)(dst + x), packed);
+        }
+    }
+    #endif
+    #elif defined(_PIXCONV_NEON)
+    if (pal->num_colors <= 64) {
+        const uint8x16x4_t tlo = vld1q_u8_x4(pal->rgb565_planes[0]);
+        const uint8x16x4_t thi = vld1q_u8_x4(pal->rgb565_planes[1]);
+        for (; (x + 16) <= width; x += 16) {
+            const uint8x16_t idx = vld1q_u8(src + x);
+            if (vmaxvq_u8(idx) >= 64) {
+                for (int i = 0; i < 16; i++) {
+                    dst[x + i] = (uint16_t)pal->rgb565[src[x + i]];
+                }
+                continue;
+            }
+            uint8x16x2_t c;
+            c.val[0] = vqtbl4q_u8(tlo, idx);
+            c.val[1] = vqtbl4q_u8(thi, idx);
+            vst2q_u8((uint8_t*)(dst + x), c);
+        }
+    }
+    #endif
+    for (; x < width; x++) {
+        dst[x] = (uint16_t)pal->rgb565[src[x]];
+    }
+}
+
+// convert a single source line at 1x scale
+static void _pixconv_line(const _pixconv_palette_t* pal, pixconv_format_t format, size_t bytes_per_pixel, const uint8_t* src, void* dst, int width) {
+    if (bytes_per_pixel == 4) {
+        // already RGBA8
+        if (format == PIXCONV_FORMAT_RGBA8) {
+            memcpy(dst, src, (size_t)width * sizeof(uint32_t));
+        }
+        else {
+            uint16_t* dst16 = (uint16_t*) dst;
+            for (int x = 0; x < width; x++) {
+                uint32_t c;
+                memcpy(&c, src + x * 4, sizeof(c));
+                dst16[x] = (uint16_t)_pixconv_rgb565(c);
+            }
+        }
+    }
+    else if (format == PIXCONV_FORMAT_RGBA8) {
+        _pixconv_line_rgba8(pal, src, (uint32_t*)dst, width);
+    }
+    else {
+        _pixconv_line_rgb565(pal, src, (uint16_t*)dst, width);
+    }
+}
+
+// clip the screen rectangle against the framebuffer
+static chips_rect_t _pixconv_screen(const chips_display_info_t* info) {
+    chips_rect_t r = info->screen;
+    if (r.x < 0) { r.width += r.x; r.x = 0; }
+    if (r.y < 0) { r.height += r.y; r.y = 0; }
+    if ((r.x + r.width) > info->frame.dim.width) { r.width = info->frame.dim.width - r.x; }
+    if ((r.y + r.height) > info->frame.dim.height) { r.height = info->frame.dim.height - r.y; }
+    if (r.width > PIXCONV_MAX_WIDTH) { r.width = PIXCONV_MAX_WIDTH; }
+    if (r.width < 0) { r.width = 0; }
+    if (r.height < 0) { r.height = 0; }
+    return r;
+}
+
+static size_t _pixconv_bytes_per_pixel(pixconv_format_t format) {
+    return (format == PIXCONV_FORMAT_RGBA8) ? 4 : 2;
+}
+
+size_t pixconv_dst_size(const chips_display_info_t* info, pixconv_format_t format, int scale) {
+    CHIPS_ASSERT(info);
+    if (scale == 0) {
+        scale = 1;
+    }
+    CHIPS_ASSERT((scale >= 1) && (scale <= PIXCONV_MAX_SCALE));
+    const chips_rect_t r = _pixconv_screen(info);
+    return (size_t)(r.width * scale) * (size_t)(r.height * scale) * _pixconv_bytes_per_pixel(format);
+}
+
+int pixconv_convert(const chips_display_info_t* info, const pixconv_desc_t* desc) {
+    CHIPS_ASSERT(info && desc && desc->dst.ptr);
+    CHIPS_ASSERT(info->frame.buffer.ptr);
+    CHIPS_ASSERT((info->frame.bytes_per_pixel == 1) || (info->frame.bytes_per_pixel == 4));
+    CHIPS_ASSERT((desc->format == PIXCONV_FORMAT_RGBA8) || (desc->format == PIXCONV_FORMAT_RGB565));
+    const int scale = (desc->scale == 0) ? 1 : desc->scale;
+    CHIPS_ASSERT((scale >= 1) && (scale <= PIXCONV_MAX_SCALE));
+    const chips_rect_t r = _pixconv_screen(info);
+    const size_t dst_bpp = _pixconv_bytes_per_pixel(desc->format);
+    const size_t dst_row_size = (size_t)(r.width * scale) * dst_bpp;
+    const size_t dst_pitch = (desc->dst_pitch == 0) ? dst_row_size : desc->dst_pitch;
+    CHIPS_ASSERT(dst_pitch >= dst_row_size);
+    if ((r.width == 0) || (r.height == 0)) {
+        return 0;
+    }
+    CHIPS_ASSERT(desc->dst.size >= (dst_pitch * (size_t)(r.height * scale - 1) + dst_row_size));
+
+    _pixconv_palette_t pal;
+    if (info->frame.bytes_per_pixel == 1) {
+        _pixconv_init_palette(&pal, info->palette);
+    }
+    const chips_dirty_lines_t* dirty = desc->all_lines ? 0 : info->dirty_lines;
+    const size_t src_pitch = (size_t)info->frame.dim.width * info->frame.bytes_per_pixel;
+    const uint8_t* src_base = (const uint8_t*)info->frame.buffer.ptr + (size_t)r.x * info->frame.bytes_per_pixel;
+    uint8_t* dst_base = (uint8_t*) desc->dst.ptr;
+    uint32_t line_buf[PIXCONV_MAX_WIDTH];
+    int num_converted = 0;
+    int y = r.y;
+    int num_lines;
+    while ((num_lines = chips_dirty_lines_run(dirty, &y, r.y + r.height)) > 0) {
+        for (int src_y = y; src_y < (y + num_lines); src_y++) {
+            const uint8_t* src = src_base + (size_t)src_y * src_pitch;
+            uint8_t* dst = dst_base + (size_t)((src_y - r.y) * scale) * dst_pitch;
+            if (scale == 1) {
+                _pixconv_line(&pal, desc->format, info->frame.bytes_per_pixel, src, dst, r.width);
+            }
+            else {
+                // convert into a line buffer, stretch horizontally, then duplicate the row
+                _pixconv_line(&pal, desc->format, info->frame.bytes_per_pixel, src, line_buf, r.width);
+                if (dst_bpp == 4) {
+                    uint32_t* dst32 = (uint32_t*) dst;
+                    for (int x = 0; x < r.width; x++) {
+                        for (int i = 0; i < scale; i++) {
+                            *dst32++ = line_buf[x];
+                        }
+                    }
+                }
+                else {
+                    const uint16_t* src16 = (const uint16_t*) line_buf;
+                    uint16_t* dst16 = (uint16_t*) dst;
+                    for (int x = 0; x < r.width; x++) {
+                        for (int i = 0; i < scale; i++) {
+                            *dst16++ = src16[x];
+                        }
+                    }
+                }
+                for (int i = 1; i < scale; i++) {
+                    memcpy(dst + (size_t)i * dst_pitch, dst, dst_row_size);
+                }
+            }
+        }
+        num_converted += num_lines;
+        y += num_lines;
+    }
+    return num_converted;
+}
+#endif /* CHIPS_UTIL_IMPL */
@@ -0,0 +1,622 @@
+#pragma once
+/*#
+    # profiler.h
+
+    A cycle-accurate profiler for the guest code running on a Z80 or 6502
+    system emulator, with call stack reconstruction and flamegraph export.
+
+    Do this:
+    ~~~C
+    #define CHIPS_UTIL_IMPL
+    ~~~
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Select the profiled CPU with the following macros (define one
+    or the other, but not both):
+
+    PROFILER_USE_Z80
+    PROFILER_USE_M6502
+
+    Optionally provide the following macros with your own implementation
+
+    ~~~C
+    CHIPS_ASSERT(c)
+    ~~~
+        your own assert macro (default: assert(c))
+
+    You need to include the following headers before including profiler.h:
+
+    - chips/chips_common.h
+    - chips/z80.h       (only if PROFILER_USE_Z80 is defined)
+    - chips/m6502.h     (only if PROFILER_USE_M6502 is defined)
+
+    ## Overview
+
+    The execution heatmap in ui_dbg.h only counts how often each address
+    was executed, in 8-bit counters which are mainly useful for coloring.
+    The profiler instead measures how many clock cycles each instruction
+    and each function of the guest program have used, over any length of
+    time.
+
+    Like the trace recorder in trace.h, the profiler is attached to a
+    system emulator through the debug callback, with a debug callback
+    filter which only invokes the profiler at instruction boundaries (see
+    'Debug Callback Filter' in chips_common.h), so the system runs at
+    nearly full speed while being profiled:
+
+    ~~~C
+    static profiler_t prof;
+
+    profiler_init(&prof, &(profiler_desc_t){ .m6502 = &sys.cpu });
+    c64_init(&sys, &(c64_desc_t){
+        .debug = profiler_get_debug(&prof),
+        ...
+    });
+    ~~~
+
+    NOTE: since the profiler takes the place of the debug callback, it
+    can't be used together with the ui_dbg.h debugger window or the
+    trace.h recorder in the same system instance. The profiler_t struct
+    is fairly big (about 1.3 MBytes), so it should not live on the stack.
+
+    At each instruction boundary, the clock cycles since the previous
+    boundary are added to the previous instruction's address in
+    profiler_t.cycles[], and profiler_t.execs[] counts how often each
+    instruction has been executed. Cycles spent in interrupt entry
+    sequences are counted on the instruction which was interrupted.
+
+    ## Call Stacks
+
+    The profiler reconstructs the guest's call stack from the CPU's stack
+    pointer, without decoding instructions:
+
+    - on the 6502, an instruction which decrements S by 2 must be a JSR,
+      and a decrement by 3 is an interrupt or BRK
+    - on the Z80, a decrement of SP by 2 together with a jump of the
+      program counter is a CALL, RST or interrupt (a decrement by 2 and
+      a PC advance by 1 or 2 bytes is a PUSH)
+
+    The new program counter after a call is the called function's address,
+    the stack pointer after the call is recorded in the profiler's own
+    stack. Any instruction which moves the stack pointer above a recorded
+    stack pointer (RTS, RTI, RET, RETI, but also stack pointer reloads)
+    ends the function. This also works for guest code which manipulates the
+    stack (like the 6502 'push address and RTS' jump-table trick), but
+    code which switches between stacks (for instance a multitasking
+    kernel) will produce odd call stacks.
+
+    Each distinct call stack is a node in a call tree which accumulates
+    the cycles spent in the function itself (not including the functions
+    it calls) and how often the function has been called at that position
+    in the tree. The call tree holds up to PROFILER_MAX_NODES nodes and the
+    call stack up to PROFILER_MAX_DEPTH entries, deeper or additional call
+    paths are counted in their parent node (see profiler_t.num_dropped).
+
+    ## Flamegraph Export
+
+    profiler_folded() writes the call tree in the 'folded stacks' text
+    format which is understood by Brendan Gregg's flamegraph.pl, speedscope
+    and most other flamegraph viewers, one line per call stack with the
+    function names separated by ';' and followed by the number of cycles:
+
+    ~~~
+    root;$E000 120
+    root;$E000;init_screen 4580
+    root;$E000;main_loop;draw_sprites 98123
+    ~~~
+
+    The code which runs outside of any detected function (usually the
+    code after reset) is the 'root' function.
+
+    Functions are named by their address, unless a symbol has been
+    registered with profiler_add_symbol(), or loaded from a symbol file
+    with profiler_load_symbols(). The symbol file parser accepts the most
+    common assembler and linker label formats, one symbol per line:
+
+    ~~~
+    al C:0810 .start        (VICE monitor labels, ld65 -Ln)
+    start = $0810           (ca65, dasm -s)
+    start equ 0810h         (Z80 assemblers)
+    0810 start              (plain address/name lists)
+    ~~~
+
+    ## Functions
+
+    ~~~C
+    void profiler_init(profiler_t* prof, const profiler_desc_t* desc)
+    ~~~
+        Initialize a profiler with a pointer to the profiled CPU:
+
+        ~~~C
+        typedef struct {
+            z80_t* z80;         // if PROFILER_USE_Z80
+            m6502_t* m6502;     // if PROFILER_USE_M6502
+        } profiler_desc_t;
+        ~~~
+
+    ~~~C
+    chips_debug_t profiler_get_debug(profiler_t* prof)
+    ~~~
+        Get a chips_debug_t to provide to the system emulator's desc struct.
+
+    ~~~C
+    void profiler_tick(profiler_t* prof, uint64_t pins)
+    ~~~
+        The debug callback, only call this directly if your own debug
+        callback needs to forward to the profiler.
+
+    ~~~C
+    void profiler_reset(profiler_t* prof)
+    ~~~
+        Clear all counters and the call tree, the registered symbols are
+        kept. Call this to only profile a specific part of a program run.
+
+    ~~~C
+    bool profiler_add_symbol(profiler_t* prof, uint16_t addr, const char* name)
+    ~~~
+        Register a function name for an address, returns false if the
+        symbol name memory is exhausted.
+
+    ~~~C
+    int profiler_load_symbols(profiler_t* prof, chips_range_t text)
+    ~~~
+        Parse a symbol file in memory and register its symbols, returns the
+        number of symbols which have been registered.
+
+    ~~~C
+    int profiler_folded(const profiler_t* prof, char* buf, int buf_size)
+    ~~~
+        Write the call tree as folded stacks into a string buffer. Returns
+        the length of the complete text (not including the terminating
+        zero), if this is not smaller than buf_size, the text has been
+        truncated.
+
+    ## zlib/libpng license
+
+    Copyright (c) 2024 Andre Weissflog
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#if !defined(PROFILER_USE_Z80) && !defined(PROFILER_USE_M6502)
+#error "please define PROFILER_USE_Z80 or PROFILER_USE_M6502"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PROFILER_MAX_NODES (8192)           // max number of call tree nodes (including the root)
+#define PROFILER_MAX_DEPTH (64)             // max depth of the reconstructed call stack
+#define PROFILER_SYMBOL_MEMORY (64 * 1024)  // memory for symbol names in bytes
+#define PROFILER_HASH_SIZE (2 * PROFILER_MAX_NODES)
+
+typedef struct {
+    #if defined(PROFILER_USE_Z80)
+    z80_t* z80;                 // the profiled CPU
+    #else
+    m6502_t* m6502;             // the profiled CPU
+    #endif
+} profiler_desc_t;
+
+// a call tree node
+typedef struct {
+    uint16_t parent;            // index of parent node
+    uint16_t addr;              // function address
+    uint32_t calls;             // number of times the function was called at this node
+    uint64_t cycles;            // cycles spent in the function itself
+} profiler_node_t;
+
+// a reconstructed call stack entry
+typedef struct {
+    uint16_t node;              // call tree node of the function
+    uint16_t sp;                // stack pointer after the call
+} profiler_frame_t;
+
+typedef struct {
+    #if defined(PROFILER_USE_Z80)
+    z80_t* z80;
+    #else
+    m6502_t* m6502;
+    #endif
+    bool stopped;               // always false (required by chips_debug_t)
+    bool started;               // true after the first instruction boundary
+    uint16_t pc;                // address of the current instruction
+    uint16_t sp;                // stack pointer at the start of the current instruction
+    uint64_t tick;              // tick count at the start of the current instruction
+    uint64_t total_cycles;      // total number of profiled cycles
+    uint32_t num_dropped;       // number of calls which didn't fit into the call tree or stack
+    int depth;                  // current call stack depth
+    int num_nodes;              // number of used call tree nodes
+    profiler_frame_t stack[PROFILER_MAX_DEPTH];
+    profiler_node_t nodes[PROFILER_MAX_NODES];
+    uint16_t hash[PROFILER_HASH_SIZE];      // maps (parent, addr) to child nodes, 0 is empty
+    uint64_t cycles[1<<16];     // cycles per instruction address
+    uint32_t execs[1<<16];      // executions per instruction address
+    uint16_t symbols[1<<16];    // offset of symbol name per address, 0 if none
+    int symbol_pos;             // next free position in symbol_names
+    char symbol_names[PROFILER_SYMBOL_MEMORY];
+    chips_debug_filter_t filter;
+} profiler_t;
+
+// initialize a profiler
+void profiler_init(profiler_t* prof, const profiler_desc_t* desc);
+// get a chips_debug_t to provide to the system emulator's desc struct
+chips_debug_t profiler_get_debug(profiler_t* prof);
+// the debug callback, profiles the guest at instruction boundaries
+void profiler_tick(profiler_t* prof, uint64_t pins);
+// clear counters and call tree, but keep the symbols
+void profiler_reset(profiler_t* prof);
+// register a function name for an address
+bool profiler_add_symbol(profiler_t* prof, uint16_t addr, const char* name);
+// parse a symbol file and register its symbols, returns number of symbols
+int profiler_load_symbols(profiler_t* prof, chips_range_t text);
+// write the call tree as folded stacks, returns the full text length
+int profiler_folded(const profiler_t* prof, char* buf, int buf_size);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_UTIL_IMPL
+#include <string.h> // memset, memcpy
+#include <stdio.h>  // snprintf
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+void profiler_init(profiler_t* prof, const profiler_desc_t* desc) {
+    CHIPS_ASSERT(prof && desc);
+    memset(prof, 0, sizeof(profiler_t));
+    #if defined(PROFILER_USE_Z80)
+        CHIPS_ASSERT(desc->z80);
+        prof->z80 = desc->z80;
+    #else
+        CHIPS_ASSERT(desc->m6502);
+        prof->m6502 = desc->m6502;
+    #endif
+    // symbol name offset 0 means 'no symbol'
+    prof->symbol_pos = 1;
+    // only call the profiler at instruction boundaries
+    prof->filter.flags = CHIPS_DEBUG_FILTER_OP;
+    profiler_reset(prof);
+}
+
+chips_debug_t profiler_get_debug(profiler_t* prof) {
+    CHIPS_ASSERT(prof);
+    chips_debug_t res;
+    memset(&res, 0, sizeof(res));
+    res.callback.func = (chips_debug_func_t) profiler_tick;
+    res.callback.user_data = prof;
+    res.stopped = &prof->stopped;
+    res.filter = &prof->filter;
+    return res;
+}
+
+void profiler_reset(profiler_t* prof) {
+    CHIPS_ASSERT(prof);
+    prof->started = false;
+    prof->total_cycles = 0;
+    prof->num_dropped = 0;
+    prof->depth = 0;
+    memset(prof->nodes, 0, sizeof(prof->nodes));
+    memset(prof->hash, 0, sizeof(prof->hash));
+    memset(prof->cycles, 0, sizeof(prof->cycles));
+    memset(prof->execs, 0, sizeof(prof->execs));
+    // node 0 is the root
+    prof->num_nodes = 1;
+}
+
+static inline uint32_t _profiler_hash(uint16_t parent, uint16_t addr) {
+    return (((uint32_t)parent << 16) | addr) * 0x9E3779B1;
+}
+
+// stack pointer difference a - b, with wraparound at the end of the stack page (6502) or address space (Z80)
+static inline int _profiler_sp_diff(uint16_t a, uint16_t b) {
+    #if defined(PROFILER_USE_Z80)
+        return (int16_t)(a - b);
+    #else
+        return (int8_t)(a - b);
+    #endif
+}
+
+// find or create the child node of the current node, returns the parent if the call tree is full
+static uint16_t _profiler_child(profiler_t* prof, uint16_t parent, uint16_t addr) {
+    uint32_t i = _profiler_hash(parent, addr) & (PROFILER_HASH_SIZE - 1);
+    while (prof->hash[i] != 0) {
+        const profiler_node_t* node = &prof->nodes[prof->hash[i]];
+        if ((node->parent == parent) && (node->addr == addr)) {
+            return prof->hash[i];
+        }
+        i = (i + 1) & (PROFILER_HASH_SIZE - 1);
+    }
+    if (prof->num_nodes == PROFILER_MAX_NODES) {
+        prof->num_dropped++;
+        return parent;
+    }
+    const uint16_t index = (uint16_t)prof->num_nodes++;
+    prof->nodes[index].parent = parent;
+    prof->nodes[index].addr = addr;
+    prof->hash[i] = index;
+    return index;
+}
+
+static void _profiler_call(profiler_t* prof, uint16_t addr, uint16_t sp) {
+    if (prof->depth == PROFILER_MAX_DEPTH) {
+        // the stack entries above still track their returns correctly
+        prof->num_dropped++;
+        return;
+    }
+    const uint16_t parent = (prof->depth > 0) ? prof->stack[prof->depth - 1].node : 0;
+    const uint16_t node = _profiler_child(prof, parent, addr);
+    prof->nodes[node].calls++;
+    prof->stack[prof->depth].node = node;
+    prof->stack[prof->depth].sp = sp;
+    prof->depth++;
+}
+
+void profiler_tick(profiler_t* prof, uint64_t pins) {
+    #if defined(PROFILER_USE_Z80)
+        if (!z80_opdone(prof->z80)) {
+            return;
+        }
+        const uint16_t pc = Z80_GET_ADDR(pins);
+        const uint16_t sp = prof->z80->sp;
+    #else
+        if (0 == (pins & M6502_SYNC)) {
+            return;
+        }
+        const uint16_t pc = M6502_GET_ADDR(pins);
+        const uint16_t sp = 0x0100 | prof->m6502->S;
+    #endif
+    // the filter's tick counter includes the current tick
+    const uint64_t tick = prof->filter.ticks - 1;
+    if (prof->started) {
+        // attribute the cycles of the previous instruction
+        const uint64_t cycles = tick - prof->tick;
+        const uint16_t node = (prof->depth > 0) ? prof->stack[prof->depth - 1].node : 0;
+        prof->cycles[prof->pc] += cycles;
+        prof->execs[prof->pc]++;
+        prof->nodes[node].cycles += cycles;
+        prof->total_cycles += cycles;
+
+        // returns (and everything else which moves the stack pointer above a call)
+        while ((prof->depth > 0) && (_profiler_sp_diff(sp, prof->stack[prof->depth - 1].sp) > 0)) {
+            prof->depth--;
+        }
+        // calls and interrupts
+        const int sp_delta = _profiler_sp_diff(prof->sp, sp);
+        if (sp_delta > 0) {
+            #if defined(PROFILER_USE_Z80)
+                const uint16_t pc_delta = (uint16_t)(pc - prof->pc);
+                const bool is_call = (sp_delta == 2) && (pc_delta != 1) && (pc_delta != 2);
+            #else
+                const bool is_call = (sp_delta == 2) || (sp_delta == 3);
+            #endif
+            if (is_call) {
+                _profiler_call(prof, pc, sp);
+            }
+        }
+    }
+    prof->started = true;
+    prof->pc = pc;
+    prof->sp = sp;
+    prof->tick = tick;
+}
+
+bool profiler_add_symbol(profiler_t* prof, uint16_t addr, const char* name) {
+    CHIPS_ASSERT(prof && name);
+    const int len = (int)strlen(name);
+    if ((len == 0) || ((prof->symbol_pos + len + 1) > PROFILER_SYMBOL_MEMORY)) {
+        return false;
+    }
+    char* dst = &prof->symbol_names[prof->symbol_pos];
+    for (int i = 0; i < len; i++) {
+        // spaces and semicolons are separators in the folded stack format
+        const char c = name[i];
+        dst[i] = ((c == ' ') || (c == ';') || (c == '\t')) ? '_' : c;
+    }
+    dst[len] = 0;
+    prof->symbols[addr] = (uint16_t)prof->symbol_pos;
+    prof->symbol_pos += len + 1;
+    return true;
+}
+
+static bool _profiler_is_hex(char c) {
+    return ((c >= '0') && (c <= '9')) || ((c >= 'a') && (c <= 'f')) || ((c >= 'A') && (c <= 'F'));
+}
+
+static uint32_t _profiler_hex_value(const char* str, int len) {
+    uint32_t val = 0;
+    for (int i = 0; i < len; i++) {
+        const char c = str[i];
+        val = (val << 4) | (uint32_t)((c <= '9') ? (c - '0') : ((c | 0x20) - 'a' + 10));
+    }
+    return val;
+}
+
+// try to parse a symbol file token as address, marked is set to true
+// if the token is explicitly an address ($0810, 0x0810, 0810h, C:0810)
+static bool _profiler_parse_addr(const char* str, int len, uint16_t* out_addr, bool* out_marked) {
+    *out_marked = false;
+    if ((len > 2) && ((str[0] == 'C') || (str[0] == 'c')) && (str[1] == ':')) {
+        str += 2; len -= 2; *out_marked = true;
+    }
+    else if ((len > 1) && (str[0] == '$')) {
+        str += 1; len -= 1; *out_marked = true;
+    }
+    else if ((len > 2) && (str[0] == '0') && ((str[1] == 'x') || (str[1] == 'X'))) {
+        str += 2; len -= 2; *out_marked = true;
+    }
+    else if ((len > 1) && ((str[len - 1] == 'h') || (str[len - 1] == 'H'))) {
+        len -= 1; *out_marked = true;
+    }
+    if ((len < 1) || (len > 6)) {
+        return false;
+    }
+    for (int i = 0; i < len; i++) {
+        if (!_profiler_is_hex(str[i])) {
+            return false;
+        }
+    }
+    const uint32_t val = _profiler_hex_value(str, len);
+    if (val > 0xFFFF) {
+        return false;
+    }
+    *out_addr = (uint16_t)val;
+    return true;
+}
+
+static bool _profiler_is_keyword(const char* str, int len) {
+    static const char* keywords[] = { "al", "equ", ".equ", "EQU", ".EQU", "=" };
+    for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
+        if (((int)strlen(keywords[i]) == len) && (0 == memcmp(str, keywords[i], (size_t)len))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#define _PROFILER_MAX_TOKENS (8)
+#define _PROFILER_MAX_NAME (64)
+
+// parse a single symbol file line
+static bool _profiler_parse_line(profiler_t* prof, const char* line, int len) {
+    const char* tok[_PROFILER_MAX_TOKENS];
+    int tok_len[_PROFILER_MAX_TOKENS];
+    int num_tokens = 0;
+    int pos = 0;
+    while ((pos < len) && (num_tokens < _PROFILER_MAX_TOKENS)) {
+        while ((pos < len) && ((line[pos] == ' ') || (line[pos] == '\t') || (line[pos] == '='))) {
+            pos++;
+        }
+        if ((pos == len) || (line[pos] == ';') || (line[pos] == '#')) {
+            break;
+        }
+        const int start = pos;
+        while ((pos < len) && (line[pos] != ' ') && (line[pos] != '\t') && (line[pos] != '=')) {
+            pos++;
+        }
+        int n = pos - start;
+        // label definitions may end with a colon
+        if ((n > 1) && (line[start + n - 1] == ':')) {
+            n--;
+        }
+        if (!_profiler_is_keyword(&line[start], n)) {
+            tok[num_tokens] = &line[start];
+            tok_len[num_tokens] = n;
+            num_tokens++;
+        }
+    }
+    if (num_tokens < 2) {
+        return false;
+    }
+    // prefer an explicitly marked address, otherwise the first hex number
+    int addr_tok = -1;
+    uint16_t addr = 0;
+    for (int i = 0; i < num_tokens; i++) {
+        uint16_t a;
+        bool marked;
+        if (_profiler_parse_addr(tok[i], tok_len[i], &a, &marked)) {
+            if (marked) {
+                addr_tok = i;
+                addr = a;
+                break;
+            }
+            else if (addr_tok < 0) {
+                addr_tok = i;
+                addr = a;
+            }
+        }
+    }
+    if (addr_tok < 0) {
+        return false;
+    }
+    const int name_tok = (addr_tok == 0) ? 1 : 0;
+    const char* name = tok[name_tok];
+    int name_len = tok_len[name_tok];
+    if ((name_len > 1) && (name[0] == '.')) {
+        name++;
+        name_len--;
+    }
+    char buf[_PROFILER_MAX_NAME];
+    if (name_len >= _PROFILER_MAX_NAME) {
+        name_len = _PROFILER_MAX_NAME - 1;
+    }
+    memcpy(buf, name, (size_t)name_len);
+    buf[name_len] = 0;
+    return profiler_add_symbol(prof, addr, buf);
+}
+
+int profiler_load_symbols(profiler_t* prof, chips_range_t text) {
+    CHIPS_ASSERT(prof && text.ptr);
+    const char* str = (const char*) text.ptr;
+    const int size = (int)text.size;
+    int num_symbols = 0;
+    int pos = 0;
+    while (pos < size) {
+        const int start = pos;
+        while ((pos < size) && (str[pos] != '\n') && (str[pos] != '\r') && (str[pos] != 0)) {
+            pos++;
+        }
+        if (_profiler_parse_line(prof, &str[start], pos - start)) {
+            num_symbols++;
+        }
+        if ((pos < size) && (str[pos] == 0)) {
+            break;
+        }
+        pos++;
+    }
+    return num_symbols;
+}
+
+int profiler_folded(const profiler_t* prof, char* buf, int buf_size) {
+    CHIPS_ASSERT(prof && buf && (buf_size > 0));
+    int pos = 0;
+    buf[0] = 0;
+    #define _PROFILER_PRINT(...) { int n = snprintf(buf + ((pos < buf_size) ? pos : buf_size - 1), (size_t)((pos < buf_size) ? (buf_size - pos) : 1), __VA_ARGS__); if (n > 0) { pos += n; } }
+    for (int i = 0; i < prof->num_nodes; i++) {
+        const profiler_node_t* node = &prof->nodes[i];
+        if (node->cycles == 0) {
+            continue;
+        }
+        // collect the path from the root to the node
+        uint16_t path[PROFILER_MAX_DEPTH + 1];
+        int depth = 0;
+        for (uint16_t n = (uint16_t)i; n != 0; n = prof->nodes[n].parent) {
+            path[depth++] = n;
+        }
+        _PROFILER_PRINT("root");
+        while (depth > 0) {
+            const uint16_t addr = prof->nodes[path[--depth]].addr;
+            if (prof->symbols[addr]) {
+                _PROFILER_PRINT(";%s", &prof->symbol_names[prof->symbols[addr]]);
+            }
+            else {
+                _PROFILER_PRINT(";$%04X", addr);
+            }
+        }
+        _PROFILER_PRINT(" %llu\n", (unsigned long long)node->cycles);
+    }
+    #undef _PROFILER_PRINT
+    return pos;
+}
+#endif /* CHIPS_UTIL_IMPL */
@@ -0,0 +1,389 @@
+#pragma once
+/*#
+    # replay.h
+
+    Deterministic replay of recorded input with per-frame hashes of the
+    emulator output, for verifying that optimized code paths behave exactly
+    like the reference code path.
+
+    Do this:
+    ~~~C
+    #define CHIPS_UTIL_IMPL
+    ~~~
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Optionally provide the following macros with your own implementation
+
+    ~~~C
+    CHIPS_ASSERT(c)
+    ~~~
+        your own assert macro (default: assert(c))
+
+    You need to include the following headers before including replay.h:
+
+    - chips/chips_common.h
+
+    ## Overview
+
+    The system emulators are deterministic: the same start state and the
+    same input produce the same output. A replay runs a system instance
+    for a number of frames, feeds it a recorded stream of input events, and
+    computes three 64-bit hashes (FNV-1a) per frame:
+
+    - **frame**: the visible screen area of the framebuffer (0 for emulators
+      without a framebuffer)
+    - **audio**: the audio samples produced during the frame
+    - **state**: a caller-provided memory range, typically the CPU state
+      and RAM
+
+    To verify a fast path, run the same replay twice (once with the fast
+    path disabled, once with it enabled) and compare the hashes with
+    replay_compare(). Or store the hashes of the reference run as golden
+    data, and compare future runs against it.
+
+    Some fast paths intentionally don't produce all outputs (for instance
+    video_disabled skips the framebuffer), the hashes to compare can be
+    selected with a mask of REPLAY_HASH_FRAME, REPLAY_HASH_AUDIO and
+    REPLAY_HASH_STATE.
+
+    ## Usage
+
+    The replay needs a couple of wrapper functions around the system's
+    functions, for instance for the ZX Spectrum:
+
+    ~~~C
+    static uint32_t exec(void* sys, uint32_t micro_seconds) {
+        return zx_exec((zx_t*)sys, micro_seconds);
+    }
+    static void key_down(void* sys, int key) {
+        zx_key_down((zx_t*)sys, key);
+    }
+    static void key_up(void* sys, int key) {
+        zx_key_up((zx_t*)sys, key);
+    }
+    static chips_display_info_t display_info(void* sys) {
+        return zx_display_info((zx_t*)sys);
+    }
+    static chips_range_t state(void* sys) {
+        return (chips_range_t){ .ptr = ((zx_t*)sys)->ram, .size = sizeof(((zx_t*)sys)->ram) };
+    }
+    ~~~
+
+    The input events must be sorted by frame index:
+
+    ~~~C
+    static const replay_event_t events[] = {
+        { .frame = 10, .type = REPLAY_EVENT_KEY_DOWN, .key = 'L' },
+        { .frame = 12, .type = REPLAY_EVENT_KEY_UP, .key = 'L' },
+        ...
+    };
+    ~~~
+
+    Initialize the system (usually by loading a snapshot so the replay
+    doesn't depend on the boot process), and use replay_audio_callback() as
+    the system's audio callback:
+
+    ~~~C
+    static zx_t sys;
+    static replay_t replay;
+    static replay_hash_t hashes[500];
+
+    zx_init(&sys, &(zx_desc_t){
+        .audio = {
+            .callback = {
+                .func = replay_audio_callback,
+                .user_data = &replay,
+            },
+        },
+        ...
+    });
+    zx_load_snapshot(&sys, version, &start_snapshot);
+    replay_init(&replay, &(replay_desc_t){
+        .sys = &sys,
+        .exec = exec,
+        .key_down = key_down,
+        .key_up = key_up,
+        .display_info = display_info,
+        .state = state,
+        .events = events,
+        .num_events = sizeof(events) / sizeof(events[0]),
+    });
+    replay_run(&replay, 500, hashes);
+    ~~~
+
+    Then compare the hashes with the hashes of another run:
+
+    ~~~C
+    int frame = replay_compare(ref_hashes, hashes, 500, REPLAY_HASH_ALL);
+    if (frame >= 0) {
+        printf("replay diverged in frame %d\n", frame);
+    }
+    ~~~
+
+    ## Functions
+
+    ~~~C
+    void replay_init(replay_t* replay, const replay_desc_t* desc)
+    ~~~
+        Initialize a replay. The system instance must be initialized
+        and in the start state of the replay. The event array must
+        remain alive until the replay is no longer used.
+
+        ~~~C
+        typedef struct {
+            void* sys;                          // pointer to system instance
+            uint32_t frame_micro_seconds;       // emulated time per frame (default: 20000)
+            replay_exec_t exec;                 // wrapper around xxx_exec()
+            replay_key_t key_down;              // optional wrapper around xxx_key_down()
+            replay_key_t key_up;                // optional wrapper around xxx_key_up()
+            replay_display_info_t display_info; // optional wrapper around xxx_display_info()
+            replay_state_t state;               // optional function which returns the memory range to hash as state
+            const replay_event_t* events;       // optional input events, sorted by frame index
+            int num_events;                     // number of input events
+        } replay_desc_t;
+        ~~~
+
+    ~~~C
+    replay_hash_t replay_frame(replay_t* replay)
+    ~~~
+        Send the input events of the current frame to the system, execute
+        the system for one frame and return the hashes of the frame.
+
+    ~~~C
+    void replay_run(replay_t* replay, int num_frames, replay_hash_t* out_hashes)
+    ~~~
+        Call replay_frame() num_frames times and write the hashes to
+        out_hashes (which must have room for num_frames items).
+
+    ~~~C
+    int replay_compare(const replay_hash_t* a, const replay_hash_t* b, int num_frames, int mask)
+    ~~~
+        Compare two hash arrays and return the index of the first frame
+        where one of the hashes selected by mask differs, or -1 if all
+        frames are identical.
+
+    ~~~C
+    void replay_audio_callback(const float* samples, int num_samples, void* user_data)
+    ~~~
+        An audio callback function for the system emulators which hashes
+        the samples into the audio hash of the current frame, user_data
+        must point to the replay_t instance.
+
+    ## zlib/libpng license
+
+    Copyright (c) 2018 Andre Weissflog
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// masks for replay_compare()
+#define REPLAY_HASH_FRAME   (1<<0)
+#define REPLAY_HASH_AUDIO   (1<<1)
+#define REPLAY_HASH_STATE   (1<<2)
+#define REPLAY_HASH_ALL     (REPLAY_HASH_FRAME|REPLAY_HASH_AUDIO|REPLAY_HASH_STATE)
+
+typedef enum {
+    REPLAY_EVENT_KEY_DOWN,
+    REPLAY_EVENT_KEY_UP,
+} replay_event_type_t;
+
+// a recorded input event, sent to the system before the frame is executed
+typedef struct {
+    uint32_t frame;
+    replay_event_type_t type;
+    int key;
+} replay_event_t;
+
+// per-frame output hashes
+typedef struct {
+    uint64_t frame;     // visible screen area of the framebuffer
+    uint64_t audio;     // audio samples produced during the frame
+    uint64_t state;     // caller-provided state memory
+} replay_hash_t;
+
+// wrapper around a system's xxx_exec() function
+typedef uint32_t (*replay_exec_t)(void* sys, uint32_t micro_seconds);
+// wrapper around a system's xxx_key_down() or xxx_key_up() function
+typedef void (*replay_key_t)(void* sys, int key);
+// wrapper around a system's xxx_display_info() function
+typedef chips_display_info_t (*replay_display_info_t)(void* sys);
+// returns the memory range which is hashed as system state
+typedef chips_range_t (*replay_state_t)(void* sys);
+
+typedef struct {
+    void* sys;                          // pointer to system instance
+    uint32_t frame_micro_seconds;       // emulated time per frame (default: 20000)
+    replay_exec_t exec;                 // wrapper around xxx_exec()
+    replay_key_t key_down;              // optional wrapper around xxx_key_down()
+    replay_key_t key_up;                // optional wrapper around xxx_key_up()
+    replay_display_info_t display_info; // optional wrapper around xxx_display_info()
+    replay_state_t state;               // optional function which returns the memory range to hash as state
+    const replay_event_t* events;       // optional input events, sorted by frame index
+    int num_events;                     // number of input events
+} replay_desc_t;
+
+typedef struct {
+    bool valid;
+    void* sys;
+    uint32_t frame_micro_seconds;
+    replay_exec_t exec;
+    replay_key_t key_down;
+    replay_key_t key_up;
+    replay_display_info_t display_info;
+    replay_state_t state;
+    const replay_event_t* events;
+    int num_events;
+    int event_index;                    // next event to send
+    uint32_t frame_count;               // index of the next frame
+    uint64_t audio_hash;                // audio hash of the current frame
+} replay_t;
+
+void replay_init(replay_t* replay, const replay_desc_t* desc);
+replay_hash_t replay_frame(replay_t* replay);
+void replay_run(replay_t* replay, int num_frames, replay_hash_t* out_hashes);
+int replay_compare(const replay_hash_t* a, const replay_hash_t* b, int num_frames, int mask);
+void replay_audio_callback(const float* samples, int num_samples, void* user_data);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_UTIL_IMPL
+#include <string.h> // memset
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+#define _REPLAY_FNV_BASIS (0xCBF29CE484222325ULL)
+#define _REPLAY_FNV_PRIME (0x100000001B3ULL)
+
+static uint64_t _replay_hash(uint64_t hash, const void* ptr, size_t num_bytes) {
+    const uint8_t* p = (const uint8_t*) ptr;
+    for (size_t i = 0; i < num_bytes; i++) {
+        hash = (hash ^ p[i]) * _REPLAY_FNV_PRIME;
+    }
+    return hash;
+}
+
+// hash the visible screen area, line by line
+static uint64_t _replay_hash_frame(const chips_display_info_t* info) {
+    if (0 == info->frame.buffer.ptr) {
+        return 0;
+    }
+    const uint8_t* pixels = (const uint8_t*) info->frame.buffer.ptr;
+    const size_t pitch = (size_t)info->frame.dim.width * info->frame.bytes_per_pixel;
+    const size_t num_bytes = (size_t)info->screen.width * info->frame.bytes_per_pixel;
+    uint64_t hash = _REPLAY_FNV_BASIS;
+    for (int y = info->screen.y; y < (info->screen.y + info->screen.height); y++) {
+        const size_t offset = (size_t)y * pitch + (size_t)info->screen.x * info->frame.bytes_per_pixel;
+        CHIPS_ASSERT((offset + num_bytes) <= info->frame.buffer.size);
+        hash = _replay_hash(hash, pixels + offset, num_bytes);
+    }
+    return hash;
+}
+
+void replay_init(replay_t* replay, const replay_desc_t* desc) {
+    CHIPS_ASSERT(replay && desc);
+    CHIPS_ASSERT(desc->sys && desc->exec);
+    CHIPS_ASSERT((desc->num_events == 0) || desc->events);
+    memset(replay, 0, sizeof(replay_t));
+    replay->valid = true;
+    replay->sys = desc->sys;
+    replay->frame_micro_seconds = (desc->frame_micro_seconds == 0) ? 20000 : desc->frame_micro_seconds;
+    replay->exec = desc->exec;
+    replay->key_down = desc->key_down;
+    replay->key_up = desc->key_up;
+    replay->display_info = desc->display_info;
+    replay->state = desc->state;
+    replay->events = desc->events;
+    replay->num_events = desc->num_events;
+    replay->audio_hash = _REPLAY_FNV_BASIS;
+}
+
+replay_hash_t replay_frame(replay_t* replay) {
+    CHIPS_ASSERT(replay && replay->valid);
+
+    // send the input events of this frame
+    while ((replay->event_index < replay->num_events) && (replay->events[replay->event_index].frame <= replay->frame_count)) {
+        const replay_event_t* ev = &replay->events[replay->event_index++];
+        CHIPS_ASSERT(ev->frame == replay->frame_count);
+        switch (ev->type) {
+            case REPLAY_EVENT_KEY_DOWN:
+                if (replay->key_down) {
+                    replay->key_down(replay->sys, ev->key);
+                }
+                break;
+            case REPLAY_EVENT_KEY_UP:
+                if (replay->key_up) {
+                    replay->key_up(replay->sys, ev->key);
+                }
+                break;
+        }
+    }
+
+    // execute the frame, the audio callback updates the audio hash
+    replay->audio_hash = _REPLAY_FNV_BASIS;
+    replay->exec(replay->sys, replay->frame_micro_seconds);
+    replay->frame_count++;
+
+    replay_hash_t res = { .audio = replay->audio_hash };
+    if (replay->display_info) {
+        const chips_display_info_t info = replay->display_info(replay->sys);
+        res.frame = _replay_hash_frame(&info);
+    }
+    if (replay->state) {
+        const chips_range_t state = replay->state(replay->sys);
+        res.state = _replay_hash(_REPLAY_FNV_BASIS, state.ptr, state.size);
+    }
+    return res;
+}
+
+void replay_run(replay_t* replay, int num_frames, replay_hash_t* out_hashes) {
+    CHIPS_ASSERT(replay && replay->valid);
+    CHIPS_ASSERT((num_frames >= 0) && out_hashes);
+    for (int i = 0; i < num_frames; i++) {
+        out_hashes[i] = replay_frame(replay);
+    }
+}
+
+int replay_compare(const replay_hash_t* a, const replay_hash_t* b, int num_frames, int mask) {
+    CHIPS_ASSERT(a && b && (num_frames >= 0));
+    for (int i = 0; i < num_frames; i++) {
+        if (((mask & REPLAY_HASH_FRAME) && (a[i].frame != b[i].frame)) ||
+            ((mask & REPLAY_HASH_AUDIO) && (a[i].audio != b[i].audio)) ||
+            ((mask & REPLAY_HASH_STATE) && (a[i].state != b[i].state)))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void replay_audio_callback(const float* samples, int num_samples, void* user_data) {
+    replay_t* replay = (replay_t*) user_data;
+    CHIPS_ASSERT(replay && replay->valid && samples && (num_samples >= 0));
+    replay->audio_hash = _replay_hash(replay->audio_hash, samples, (size_t)num_samples * sizeof(float));
+}
+#endif /* CHIPS_UTIL_IMPL */
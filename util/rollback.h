@@ -0,0 +1,450 @@
+#pragma once
+/*#
+    # rollback.h
+
+    Rollback netplay helper: a per-frame input log for several players,
+    prediction of remote input which hasn't arrived yet, and rollback with
+    fast resimulation when a prediction turns out to be wrong.
+
+    Do this:
+    ~~~C
+    #define CHIPS_UTIL_IMPL
+    ~~~
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Optionally provide the following macros with your own implementation
+
+    ~~~C
+    CHIPS_ASSERT(c)
+    ~~~
+        your own assert macro (default: assert(c))
+
+    You need to include the following headers before including rollback.h:
+
+    - chips/chips_common.h
+
+    ## Overview
+
+    In a netplay session, each host runs its own instance of the emulator,
+    and only the input of the players is sent over the network. Since the
+    system emulators are deterministic (the same start state and the same
+    input produce the same output), all instances stay in sync as long as
+    they see the same input in the same emulated frames.
+
+    Instead of waiting for the remote input of a frame to arrive, the local
+    instance keeps running with a predicted input (the last input that
+    was received from the remote player). When the actual remote input
+    arrives and differs from the prediction, the emulator state is rolled
+    back to the start of the first mispredicted frame, and the frames up
+    to the current frame are simulated again with the corrected input, all
+    within the same host frame. Resimulated frames run without video
+    decoding, and their audio output should be discarded since it has
+    already been played.
+
+    The emulation must advance in whole frames driven by tick counts
+    (xxx_exec_frame()), so that the same input is always applied at the
+    same emulated clock tick.
+
+    Input is a 32-bit value per player and frame, the meaning of the bits
+    is up to the application (for instance a C64 joystick mask, a
+    combination of NAMCO_INPUT_* bits, or a set of keys). The input of
+    all players is applied before each frame in a single callback, which
+    also gets the input of the previous frame so that it can be translated
+    into key-down/key-up events.
+
+    A snapshot is saved at the start of every frame which has unconfirmed
+    input. When all players' inputs of a frame are already known, the
+    frame can never be rolled back, and no snapshot is saved.
+
+    The emulation stalls (rollback_frame() returns false) when it would
+    otherwise run more than ROLLBACK_MAX_FRAMES frames ahead of the last
+    frame with confirmed input of all players, this limits the number of
+    frames which need to be resimulated in a single host frame.
+
+    ## Usage
+
+    Wrap the system functions, for instance for the C64 with a joystick
+    on each port:
+
+    ~~~C
+    static uint32_t save(void* sys, void* dst) {
+        return c64_save_snapshot((c64_t*)sys, (c64_t*)dst);
+    }
+    static bool load(void* sys, uint32_t version, void* src) {
+        return c64_load_snapshot((c64_t*)sys, version, (c64_t*)src);
+    }
+    static uint32_t exec_frame(void* sys) {
+        return c64_exec_frame((c64_t*)sys);
+    }
+    static void input(void* sys, const uint32_t* input, const uint32_t* prev_input, int num_players) {
+        (void)prev_input; (void)num_players;
+        c64_joystick((c64_t*)sys, (uint8_t)input[0], (uint8_t)input[1]);
+    }
+    static void enable_video(void* sys, bool enabled) {
+        c64_enable_video((c64_t*)sys, enabled);
+    }
+    ~~~
+
+    Initialize the rollback session with memory for ROLLBACK_NUM_SNAPSHOTS
+    snapshots (both hosts must start from the same state, for instance by
+    loading the same snapshot first):
+
+    ~~~C
+    static c64_t sys;
+    static c64_t snapshots[ROLLBACK_NUM_SNAPSHOTS];
+    static rollback_t rollback;
+
+    rollback_init(&rollback, &(rollback_desc_t){
+        .sys = &sys,
+        .num_players = 2,
+        .snapshots = { .ptr = snapshots, .size = sizeof(snapshots) },
+        .snapshot_size = sizeof(c64_t),
+        .save = save,
+        .load = load,
+        .exec_frame = exec_frame,
+        .input = input,
+        .enable_video = enable_video,
+    });
+    ~~~
+
+    In each host frame, add the local input (usually a few frames in the
+    future to hide the network latency), send it to the remote host, add
+    all remote input that has arrived in the meantime, and advance the
+    emulation by one frame:
+
+    ~~~C
+    while (local_frame <= (rollback.frame + input_delay)) {
+        rollback_add_input(&rollback, local_player, local_frame, local_input);
+        send_input(local_frame++, local_input);
+    }
+    uint32_t frame, remote_input;
+    while (receive_input(&frame, &remote_input)) {
+        rollback_add_input(&rollback, remote_player, frame, remote_input);
+    }
+    rollback_frame(&rollback);
+    ~~~
+
+    In the audio callback, drop the samples while the emulator is
+    resimulating:
+
+    ~~~C
+    static void push_audio(const float* samples, int num_samples, void* user_data) {
+        if (!rollback_resimulating(&rollback)) {
+            saudio_push(samples, num_samples);
+        }
+    }
+    ~~~
+
+    ## Functions
+
+    ~~~C
+    void rollback_init(rollback_t* rb, const rollback_desc_t* desc)
+    ~~~
+        Initialize a rollback session. The system instance must be
+        initialized and in the start state of the session. The snapshot
+        memory must remain alive until the session is no longer used.
+
+        ~~~C
+        typedef struct {
+            void* sys;                              // pointer to system instance
+            int num_players;                        // number of players (1..ROLLBACK_MAX_PLAYERS)
+            chips_range_t snapshots;                // memory for ROLLBACK_NUM_SNAPSHOTS snapshots
+            size_t snapshot_size;                   // size of one snapshot (e.g. sizeof(c64_t))
+            rollback_save_t save;                   // wrapper around xxx_save_snapshot()
+            rollback_load_t load;                   // wrapper around xxx_load_snapshot()
+            rollback_exec_frame_t exec_frame;       // wrapper around xxx_exec_frame()
+            rollback_input_t input;                 // applies the input of all players before a frame
+            rollback_enable_video_t enable_video;   // optional wrapper around xxx_enable_video()
+        } rollback_desc_t;
+        ~~~
+
+    ~~~C
+    bool rollback_add_input(rollback_t* rb, int player, uint32_t frame, uint32_t input)
+    ~~~
+        Add the confirmed input of a player for a frame. The input of each
+        player must be added in frame order without gaps (starting at frame
+        0), and not more than ROLLBACK_MAX_INPUT_AHEAD frames ahead of the
+        current frame. Returns false if the input doesn't fit these rules
+        and was ignored. If the frame has already been executed with a
+        different predicted input, a rollback to this frame happens in the
+        next call to rollback_frame().
+
+    ~~~C
+    bool rollback_frame(rollback_t* rb)
+    ~~~
+        Resimulate any mispredicted frames, then run the emulation for one
+        frame. Returns false if the emulation stalls because the last
+        frame with confirmed input of all players is too far behind (the
+        current frame isn't executed then, but a pending rollback still
+        happens).
+
+    ~~~C
+    uint32_t rollback_confirmed_frame(const rollback_t* rb)
+    ~~~
+        Returns the number of frames for which the input of all players is
+        confirmed. Frames before this won't be rolled back anymore.
+
+    ~~~C
+    bool rollback_resimulating(const rollback_t* rb)
+    ~~~
+        Returns true while rollback_frame() is resimulating frames, use
+        this to discard the audio output of resimulated frames.
+
+    ~~~C
+    rollback_stats_t rollback_stats(const rollback_t* rb)
+    ~~~
+        Returns the statistics of the rollback session.
+
+        ~~~C
+        typedef struct {
+            uint32_t num_rollbacks;         // number of rollbacks
+            uint32_t num_resimulated;       // total number of resimulated frames
+            uint32_t max_resimulated;       // max number of frames resimulated in a single rollback
+            uint32_t num_snapshots;         // number of saved snapshots
+            uint32_t num_stalls;            // number of calls to rollback_frame() which stalled
+        } rollback_stats_t;
+        ~~~
+
+    ## zlib/libpng license
+
+    Copyright (c) 2018 Andre Weissflog
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// max number of players
+#define ROLLBACK_MAX_PLAYERS (4)
+// max number of frames the emulation runs ahead of the confirmed input
+#define ROLLBACK_MAX_FRAMES (8)
+// number of snapshots which must fit into rollback_desc_t.snapshots
+#define ROLLBACK_NUM_SNAPSHOTS (ROLLBACK_MAX_FRAMES)
+// max number of frames input can be added ahead of the current frame
+#define ROLLBACK_MAX_INPUT_AHEAD (16)
+// size of the input log in frames (must be a power of 2)
+#define ROLLBACK_INPUT_LOG_SIZE (32)
+
+// wrapper around a system's xxx_save_snapshot() function
+typedef uint32_t (*rollback_save_t)(void* sys, void* dst);
+// wrapper around a system's xxx_load_snapshot() function
+typedef bool (*rollback_load_t)(void* sys, uint32_t version, void* src);
+// wrapper around a system's xxx_exec_frame() function
+typedef uint32_t (*rollback_exec_frame_t)(void* sys);
+// applies the input of all players before a frame is executed
+typedef void (*rollback_input_t)(void* sys, const uint32_t* input, const uint32_t* prev_input, int num_players);
+// wrapper around a system's xxx_enable_video() function
+typedef void (*rollback_enable_video_t)(void* sys, bool enabled);
+
+typedef struct {
+    void* sys;                              // pointer to system instance
+    int num_players;                        // number of players (1..ROLLBACK_MAX_PLAYERS)
+    chips_range_t snapshots;                // memory for ROLLBACK_NUM_SNAPSHOTS snapshots
+    size_t snapshot_size;                   // size of one snapshot (e.g. sizeof(c64_t))
+    rollback_save_t save;                   // wrapper around xxx_save_snapshot()
+    rollback_load_t load;                   // wrapper around xxx_load_snapshot()
+    rollback_exec_frame_t exec_frame;       // wrapper around xxx_exec_frame()
+    rollback_input_t input;                 // applies the input of all players before a frame
+    rollback_enable_video_t enable_video;   // optional wrapper around xxx_enable_video()
+} rollback_desc_t;
+
+typedef struct {
+    uint32_t num_rollbacks;         // number of rollbacks
+    uint32_t num_resimulated;       // total number of resimulated frames
+    uint32_t max_resimulated;       // max number of frames resimulated in a single rollback
+    uint32_t num_snapshots;         // number of saved snapshots
+    uint32_t num_stalls;            // number of calls to rollback_frame() which stalled
+} rollback_stats_t;
+
+typedef struct {
+    bool valid;
+    void* sys;
+    int num_players;
+    uint8_t* snapshot_buffer;
+    size_t snapshot_size;
+    rollback_save_t save;
+    rollback_load_t load;
+    rollback_exec_frame_t exec_frame;
+    rollback_input_t input;
+    rollback_enable_video_t enable_video;
+    uint32_t frame;                     // index of the next frame to execute
+    uint32_t rollback_frame;            // first mispredicted frame, same as 'frame' if no rollback is pending
+    bool resimulating;
+    uint32_t confirmed[ROLLBACK_MAX_PLAYERS];   // per player: number of frames with confirmed input
+    // per frame and player: confirmed input, or the predicted input a frame was executed with
+    uint32_t input_log[ROLLBACK_INPUT_LOG_SIZE][ROLLBACK_MAX_PLAYERS];
+    struct {
+        bool valid;
+        uint32_t frame;                 // the snapshot holds the state at the start of this frame
+        uint32_t version;               // snapshot version from xxx_save_snapshot()
+    } snapshots[ROLLBACK_NUM_SNAPSHOTS];
+    rollback_stats_t stats;
+} rollback_t;
+
+void rollback_init(rollback_t* rb, const rollback_desc_t* desc);
+bool rollback_add_input(rollback_t* rb, int player, uint32_t frame, uint32_t input);
+bool rollback_frame(rollback_t* rb);
+uint32_t rollback_confirmed_frame(const rollback_t* rb);
+bool rollback_resimulating(const rollback_t* rb);
+rollback_stats_t rollback_stats(const rollback_t* rb);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_UTIL_IMPL
+#include <string.h> // memset
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+#define _ROLLBACK_INPUT_LOG_MASK (ROLLBACK_INPUT_LOG_SIZE - 1)
+
+void rollback_init(rollback_t* rb, const rollback_desc_t* desc) {
+    CHIPS_ASSERT(rb && desc);
+    CHIPS_ASSERT(desc->sys && desc->save && desc->load && desc->exec_frame && desc->input);
+    CHIPS_ASSERT((desc->num_players >= 1) && (desc->num_players <= ROLLBACK_MAX_PLAYERS));
+    CHIPS_ASSERT(desc->snapshots.ptr && (desc->snapshot_size > 0));
+    CHIPS_ASSERT(desc->snapshots.size >= (ROLLBACK_NUM_SNAPSHOTS * desc->snapshot_size));
+    // the input log must reach from the oldest frame which can be rolled back to the newest added input
+    CHIPS_ASSERT((ROLLBACK_MAX_FRAMES + 1 + ROLLBACK_MAX_INPUT_AHEAD) <= ROLLBACK_INPUT_LOG_SIZE);
+    memset(rb, 0, sizeof(rollback_t));
+    rb->valid = true;
+    rb->sys = desc->sys;
+    rb->num_players = desc->num_players;
+    rb->snapshot_buffer = (uint8_t*) desc->snapshots.ptr;
+    rb->snapshot_size = desc->snapshot_size;
+    rb->save = desc->save;
+    rb->load = desc->load;
+    rb->exec_frame = desc->exec_frame;
+    rb->input = desc->input;
+    rb->enable_video = desc->enable_video;
+}
+
+uint32_t rollback_confirmed_frame(const rollback_t* rb) {
+    CHIPS_ASSERT(rb && rb->valid);
+    uint32_t res = rb->confirmed[0];
+    for (int i = 1; i < rb->num_players; i++) {
+        if (rb->confirmed[i] < res) {
+            res = rb->confirmed[i];
+        }
+    }
+    return res;
+}
+
+bool rollback_add_input(rollback_t* rb, int player, uint32_t frame, uint32_t input) {
+    CHIPS_ASSERT(rb && rb->valid);
+    CHIPS_ASSERT((player >= 0) && (player < rb->num_players));
+    if ((frame != rb->confirmed[player]) || (frame >= (rb->frame + ROLLBACK_MAX_INPUT_AHEAD))) {
+        return false;
+    }
+    uint32_t* log_input = &rb->input_log[frame & _ROLLBACK_INPUT_LOG_MASK][player];
+    if ((frame < rb->rollback_frame) && (*log_input != input)) {
+        // the frame was executed with a wrong prediction, the stall
+        // condition in rollback_frame() guarantees that a snapshot exists
+        CHIPS_ASSERT((rb->frame - frame) <= ROLLBACK_MAX_FRAMES);
+        rb->rollback_frame = frame;
+    }
+    *log_input = input;
+    rb->confirmed[player]++;
+    return true;
+}
+
+// execute the next frame with confirmed or predicted input
+static void _rollback_exec(rollback_t* rb, bool save_snapshot) {
+    const uint32_t frame = rb->frame;
+    if (save_snapshot && (frame >= rollback_confirmed_frame(rb))) {
+        // the frame may need to be rolled back later
+        const int slot = (int)(frame % ROLLBACK_NUM_SNAPSHOTS);
+        rb->snapshots[slot].valid = true;
+        rb->snapshots[slot].frame = frame;
+        rb->snapshots[slot].version = rb->save(rb->sys, rb->snapshot_buffer + (size_t)slot * rb->snapshot_size);
+        rb->stats.num_snapshots++;
+    }
+    uint32_t* input = rb->input_log[frame & _ROLLBACK_INPUT_LOG_MASK];
+    uint32_t prev_input[ROLLBACK_MAX_PLAYERS] = { 0 };
+    for (int i = 0; i < rb->num_players; i++) {
+        if (frame > 0) {
+            prev_input[i] = rb->input_log[(frame - 1) & _ROLLBACK_INPUT_LOG_MASK][i];
+        }
+        if (frame >= rb->confirmed[i]) {
+            // predict that the input hasn't changed since the last confirmed frame
+            input[i] = (rb->confirmed[i] > 0) ? rb->input_log[(rb->confirmed[i] - 1) & _ROLLBACK_INPUT_LOG_MASK][i] : 0;
+        }
+    }
+    rb->input(rb->sys, input, prev_input, rb->num_players);
+    rb->exec_frame(rb->sys);
+    rb->frame++;
+}
+
+bool rollback_frame(rollback_t* rb) {
+    CHIPS_ASSERT(rb && rb->valid);
+    if (rb->rollback_frame < rb->frame) {
+        const uint32_t end_frame = rb->frame;
+        const uint32_t start_frame = rb->rollback_frame;
+        const int slot = (int)(start_frame % ROLLBACK_NUM_SNAPSHOTS);
+        CHIPS_ASSERT(rb->snapshots[slot].valid && (rb->snapshots[slot].frame == start_frame));
+        const bool loaded = rb->load(rb->sys, rb->snapshots[slot].version, rb->snapshot_buffer + (size_t)slot * rb->snapshot_size);
+        CHIPS_ASSERT(loaded); (void)loaded;
+        rb->frame = start_frame;
+        rb->resimulating = true;
+        if (rb->enable_video) {
+            rb->enable_video(rb->sys, false);
+        }
+        while (rb->frame < end_frame) {
+            // the snapshot of the first frame was just loaded and is still valid
+            _rollback_exec(rb, rb->frame != start_frame);
+        }
+        if (rb->enable_video) {
+            rb->enable_video(rb->sys, true);
+        }
+        rb->resimulating = false;
+        const uint32_t num_frames = end_frame - start_frame;
+        rb->stats.num_rollbacks++;
+        rb->stats.num_resimulated += num_frames;
+        if (num_frames > rb->stats.max_resimulated) {
+            rb->stats.max_resimulated = num_frames;
+        }
+    }
+    bool res = true;
+    if (rb->frame >= (rollback_confirmed_frame(rb) + ROLLBACK_MAX_FRAMES)) {
+        rb->stats.num_stalls++;
+        res = false;
+    }
+    else {
+        _rollback_exec(rb, true);
+    }
+    rb->rollback_frame = rb->frame;
+    return res;
+}
+
+bool rollback_resimulating(const rollback_t* rb) {
+    CHIPS_ASSERT(rb && rb->valid);
+    return rb->resimulating;
+}
+
+rollback_stats_t rollback_stats(const rollback_t* rb) {
+    CHIPS_ASSERT(rb && rb->valid);
+    return rb->stats;
+}
+#endif /* CHIPS_UTIL_IMPL */
@@ -0,0 +1,508 @@
+#pragma once
+/*#
+    # runner.h
+
+    Run many headless system emulator instances in parallel on a pool of
+    worker threads.
+
+    Do this:
+    ~~~C
+    #define CHIPS_UTIL_IMPL
+    ~~~
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Optionally provide the following macros with your own implementation
+
+    ~~~C
+    CHIPS_ASSERT(c)
+    ~~~
+        your own assert macro (default: assert(c))
+
+    You need to include the following headers before including runner.h:
+
+    - chips/chips_common.h
+
+    On Windows the runner uses Win32 threads, everywhere else pthreads
+    (so you may need to link with -lpthread).
+
+    ## Overview
+
+    The system emulators are self-contained structs without global state,
+    so different instances can run on different threads without any
+    synchronization. The runner owns a fixed pool of worker threads and
+    a list of pointers to system instances, and runner_frame() executes all
+    instances for the same amount of emulated time. The calling thread also
+    takes part in the work and runner_frame() returns when all instances
+    have been executed.
+
+    The instances are split into one contiguous slice per worker. A worker
+    first executes the instances of its own slice, and when it runs out of
+    work it steals instances from the slices of the other workers. Picking
+    the next instance is a single atomic increment, there are no locks
+    taken while instances are executed (a mutex and condition variables are
+    only used to start and finish a frame).
+
+    Per-frame outputs are gathered without locking: each instance has its
+    own audio sample buffer which is filled by the system's audio callback,
+    and the framebuffer is obtained through the system's display_info
+    function after runner_frame() has returned.
+
+    ## Usage
+
+    Since the runner works with any system, it needs a couple of wrapper
+    functions, for instance for the ZX Spectrum:
+
+    ~~~C
+    static uint32_t exec(void* sys, uint32_t micro_seconds) {
+        return zx_exec((zx_t*)sys, micro_seconds);
+    }
+    static chips_display_info_t display_info(void* sys) {
+        return zx_display_info((zx_t*)sys);
+    }
+    ~~~
+
+    Initialize the runner with pointers to the system instances, the
+    wrapper functions and an optional memory buffer for audio samples:
+
+    ~~~C
+    static zx_t systems[64];
+    static void* instances[64];
+    static float audio_buffer[64 * 1024];
+    static runner_t runner;
+
+    for (int i = 0; i < 64; i++) {
+        instances[i] = &systems[i];
+    }
+    runner_init(&runner, &(runner_desc_t){
+        .num_threads = 7,
+        .num_instances = 64,
+        .instances = instances,
+        .exec = exec,
+        .display_info = display_info,
+        .audio_buffer = { .ptr = audio_buffer, .size = sizeof(audio_buffer) },
+    });
+    ~~~
+
+    To capture audio, use runner_audio_callback() as the system's audio
+    callback function with a user data pointer from runner_audio_user_data():
+
+    ~~~C
+    for (int i = 0; i < 64; i++) {
+        zx_init(&systems[i], &(zx_desc_t){
+            .audio = {
+                .callback = {
+                    .func = runner_audio_callback,
+                    .user_data = runner_audio_user_data(&runner, i),
+                },
+            },
+            ...
+        });
+    }
+    ~~~
+
+    Then call runner_frame() once per frame and inspect the outputs:
+
+    ~~~C
+    runner_frame(&runner, 16667);
+    for (int i = 0; i < 64; i++) {
+        chips_display_info_t disp = runner_display_info(&runner, i);
+        chips_range_t samples = runner_audio_samples(&runner, i);
+        ...
+    }
+    ~~~
+
+    Finally call runner_discard() to stop the worker threads.
+
+    NOTE: the runner_t struct and the system instances must not be moved
+    in memory while the runner is active.
+
+    ## Functions
+
+    ~~~C
+    void runner_init(runner_t* runner, const runner_desc_t* desc)
+    ~~~
+        Initialize a runner and start the worker threads.
+
+        ~~~C
+        typedef struct {
+            int num_threads;                // number of worker threads in addition to the calling thread
+            int num_instances;              // number of system instances
+            void** instances;               // pointers to system instances
+            runner_exec_t exec;             // wrapper around xxx_exec()
+            runner_display_info_t display_info; // optional wrapper around xxx_display_info()
+            chips_range_t audio_buffer;     // optional memory for audio samples, split evenly between instances
+        } runner_desc_t;
+        ~~~
+
+    ~~~C
+    void runner_discard(runner_t* runner)
+    ~~~
+        Stop the worker threads.
+
+    ~~~C
+    void runner_frame(runner_t* runner, uint32_t micro_seconds)
+    ~~~
+        Execute all instances for the given number of micro seconds, returns
+        when all instances are done.
+
+    ~~~C
+    uint32_t runner_ticks(runner_t* runner, int index)
+    ~~~
+        Returns the number of ticks an instance executed in the last frame.
+
+    ~~~C
+    chips_display_info_t runner_display_info(runner_t* runner, int index)
+    ~~~
+        Returns the display info of an instance (a zero-initialized struct
+        if no display_info function was provided).
+
+    ~~~C
+    chips_range_t runner_audio_samples(runner_t* runner, int index)
+    ~~~
+        Returns the audio samples an instance produced in the last frame.
+
+    ~~~C
+    void runner_audio_callback(const float* samples, int num_samples, void* user_data)
+    ~~~
+        An audio callback function for the system emulators which appends
+        samples to an instance's audio buffer (samples which don't fit into
+        the buffer are dropped).
+
+    ~~~C
+    void* runner_audio_user_data(runner_t* runner, int index)
+    ~~~
+        Returns the user data pointer to use with runner_audio_callback().
+
+    ## zlib/libpng license
+
+    Copyright (c) 2018 Andre Weissflog
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdalign.h>
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RUNNER_MAX_INSTANCES (1024)
+#define RUNNER_MAX_THREADS (64)
+
+// wrapper around a system's xxx_exec() function
+typedef uint32_t (*runner_exec_t)(void* sys, uint32_t micro_seconds);
+// wrapper around a system's xxx_display_info() function
+typedef chips_display_info_t (*runner_display_info_t)(void* sys);
+
+typedef struct {
+    int num_threads;                    // number of worker threads in addition to the calling thread
+    int num_instances;                  // number of system instances
+    void** instances;                   // pointers to system instances
+    runner_exec_t exec;                 // wrapper around xxx_exec()
+    runner_display_info_t display_info; // optional wrapper around xxx_display_info()
+    chips_range_t audio_buffer;         // optional memory for audio samples, split evenly between instances
+} runner_desc_t;
+
+// per-instance audio output
+typedef struct {
+    float* buffer;
+    int capacity;
+    int num_samples;
+} runner_audio_t;
+
+// a range of instances owned by one worker, the next index is taken with an atomic increment
+typedef struct {
+    alignas(64) volatile int32_t next;
+    int32_t end;
+} runner_slice_t;
+
+typedef struct runner_t runner_t;
+
+// worker thread state
+typedef struct {
+    runner_t* runner;
+    int index;
+    #if defined(_WIN32)
+    HANDLE thread;
+    #else
+    pthread_t thread;
+    #endif
+} runner_worker_t;
+
+struct runner_t {
+    bool valid;
+    int num_threads;
+    int num_instances;
+    void* instances[RUNNER_MAX_INSTANCES];
+    runner_exec_t exec;
+    runner_display_info_t display_info;
+    uint32_t micro_seconds;             // time slice of the current frame
+    uint32_t frame_count;               // incremented by runner_frame() to start a new frame
+    int num_busy;                       // number of worker threads still working on the current frame
+    bool quit;
+    #if defined(_WIN32)
+    SRWLOCK lock;
+    CONDITION_VARIABLE start_cond;
+    CONDITION_VARIABLE done_cond;
+    #else
+    pthread_mutex_t lock;
+    pthread_cond_t start_cond;
+    pthread_cond_t done_cond;
+    #endif
+    uint32_t ticks[RUNNER_MAX_INSTANCES];
+    runner_audio_t audio[RUNNER_MAX_INSTANCES];
+    runner_slice_t slice[RUNNER_MAX_THREADS + 1];   // slice 0 belongs to the calling thread
+    runner_worker_t worker[RUNNER_MAX_THREADS];
+};
+
+// initialize a runner and start the worker threads
+void runner_init(runner_t* runner, const runner_desc_t* desc);
+// stop the worker threads
+void runner_discard(runner_t* runner);
+// execute all instances for the given number of micro seconds
+void runner_frame(runner_t* runner, uint32_t micro_seconds);
+// get the number of ticks an instance executed in the last frame
+uint32_t runner_ticks(runner_t* runner, int index);
+// get the display info of an instance
+chips_display_info_t runner_display_info(runner_t* runner, int index);
+// get the audio samples an instance produced in the last frame
+chips_range_t runner_audio_samples(runner_t* runner, int index);
+// an audio callback which appends samples to an instance's audio buffer
+void runner_audio_callback(const float* samples, int num_samples, void* user_data);
+// get the user data pointer for runner_audio_callback()
+void* runner_audio_user_data(runner_t* runner, int index);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_UTIL_IMPL
+#include <string.h> // memset, memcpy
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+#if defined(_MSC_VER)
+    #define _RUNNER_FETCH_INC(p) ((int32_t)_InterlockedExchangeAdd((volatile long*)(p), 1))
+#else
+    #define _RUNNER_FETCH_INC(p) (__atomic_fetch_add((p), 1, __ATOMIC_RELAXED))
+#endif
+
+#if defined(_WIN32)
+    #define _RUNNER_LOCK(r) AcquireSRWLockExclusive(&(r)->lock)
+    #define _RUNNER_UNLOCK(r) ReleaseSRWLockExclusive(&(r)->lock)
+    #define _RUNNER_WAIT(r, cond) SleepConditionVariableSRW(&(r)->cond, &(r)->lock, INFINITE, 0)
+    #define _RUNNER_BROADCAST(r, cond) WakeAllConditionVariable(&(r)->cond)
+#else
+    #define _RUNNER_LOCK(r) pthread_mutex_lock(&(r)->lock)
+    #define _RUNNER_UNLOCK(r) pthread_mutex_unlock(&(r)->lock)
+    #define _RUNNER_WAIT(r, cond) pthread_cond_wait(&(r)->cond, &(r)->lock)
+    #define _RUNNER_BROADCAST(r, cond) pthread_cond_broadcast(&(r)->cond)
+#endif
+
+static void _runner_exec_instance(runner_t* r, int index) {
+    r->ticks[index] = r->exec(r->instances[index], r->micro_seconds);
+}
+
+// execute the worker's own slice, then steal from the other slices
+static void _runner_work(runner_t* r, int worker_index) {
+    const int num_slices = r->num_threads + 1;
+    for (int i = 0; i < num_slices; i++) {
+        runner_slice_t* slice = &r->slice[(worker_index + i) % num_slices];
+        int32_t index;
+        while ((index = _RUNNER_FETCH_INC(&slice->next)) < slice->end) {
+            _runner_exec_instance(r, index);
+        }
+    }
+}
+
+static void _runner_worker_loop(runner_worker_t* worker) {
+    runner_t* r = worker->runner;
+    uint32_t frame_count = 0;
+    while (true) {
+        _RUNNER_LOCK(r);
+        while ((frame_count == r->frame_count) && !r->quit) {
+            _RUNNER_WAIT(r, start_cond);
+        }
+        const bool quit = r->quit;
+        frame_count = r->frame_count;
+        _RUNNER_UNLOCK(r);
+        if (quit) {
+            break;
+        }
+        _runner_work(r, worker->index);
+        _RUNNER_LOCK(r);
+        if (--r->num_busy == 0) {
+            _RUNNER_BROADCAST(r, done_cond);
+        }
+        _RUNNER_UNLOCK(r);
+    }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI _runner_thread_func(LPVOID arg) {
+    _runner_worker_loop((runner_worker_t*)arg);
+    return 0;
+}
+#else
+static void* _runner_thread_func(void* arg) {
+    _runner_worker_loop((runner_worker_t*)arg);
+    return 0;
+}
+#endif
+
+void runner_init(runner_t* r, const runner_desc_t* desc) {
+    CHIPS_ASSERT(r && desc);
+    CHIPS_ASSERT((desc->num_threads >= 0) && (desc->num_threads <= RUNNER_MAX_THREADS));
+    CHIPS_ASSERT((desc->num_instances > 0) && (desc->num_instances <= RUNNER_MAX_INSTANCES));
+    CHIPS_ASSERT(desc->instances && desc->exec);
+    memset(r, 0, sizeof(runner_t));
+    r->valid = true;
+    r->num_threads = desc->num_threads;
+    r->num_instances = desc->num_instances;
+    memcpy(r->instances, desc->instances, (size_t)desc->num_instances * sizeof(void*));
+    r->exec = desc->exec;
+    r->display_info = desc->display_info;
+    if (desc->audio_buffer.ptr) {
+        const int capacity = (int)(desc->audio_buffer.size / sizeof(float) / (size_t)desc->num_instances);
+        for (int i = 0; i < r->num_instances; i++) {
+            r->audio[i].buffer = ((float*)desc->audio_buffer.ptr) + i * capacity;
+            r->audio[i].capacity = capacity;
+        }
+    }
+    #if defined(_WIN32)
+    InitializeSRWLock(&r->lock);
+    InitializeConditionVariable(&r->start_cond);
+    InitializeConditionVariable(&r->done_cond);
+    #else
+    pthread_mutex_init(&r->lock, 0);
+    pthread_cond_init(&r->start_cond, 0);
+    pthread_cond_init(&r->done_cond, 0);
+    #endif
+    for (int i = 0; i < r->num_threads; i++) {
+        runner_worker_t* worker = &r->worker[i];
+        worker->runner = r;
+        worker->index = i + 1;
+        #if defined(_WIN32)
+        worker->thread = CreateThread(0, 0, _runner_thread_func, worker, 0, 0);
+        CHIPS_ASSERT(worker->thread);
+        #else
+        int res = pthread_create(&worker->thread, 0, _runner_thread_func, worker);
+        CHIPS_ASSERT(0 == res); (void)res;
+        #endif
+    }
+}
+
+void runner_discard(runner_t* r) {
+    CHIPS_ASSERT(r && r->valid);
+    _RUNNER_LOCK(r);
+    r->quit = true;
+    _RUNNER_BROADCAST(r, start_cond);
+    _RUNNER_UNLOCK(r);
+    for (int i = 0; i < r->num_threads; i++) {
+        #if defined(_WIN32)
+        WaitForSingleObject(r->worker[i].thread, INFINITE);
+        CloseHandle(r->worker[i].thread);
+        #else
+        pthread_join(r->worker[i].thread, 0);
+        #endif
+    }
+    #if !defined(_WIN32)
+    pthread_cond_destroy(&r->done_cond);
+    pthread_cond_destroy(&r->start_cond);
+    pthread_mutex_destroy(&r->lock);
+    #endif
+    r->valid = false;
+}
+
+void runner_frame(runner_t* r, uint32_t micro_seconds) {
+    CHIPS_ASSERT(r && r->valid);
+    for (int i = 0; i < r->num_instances; i++) {
+        r->audio[i].num_samples = 0;
+    }
+    // split the instances into one slice per worker
+    const int num_slices = r->num_threads + 1;
+    for (int i = 0; i < num_slices; i++) {
+        r->slice[i].next = (int32_t)((r->num_instances * i) / num_slices);
+        r->slice[i].end = (int32_t)((r->num_instances * (i + 1)) / num_slices);
+    }
+    _RUNNER_LOCK(r);
+    r->micro_seconds = micro_seconds;
+    r->num_busy = r->num_threads;
+    r->frame_count++;
+    _RUNNER_BROADCAST(r, start_cond);
+    _RUNNER_UNLOCK(r);
+    _runner_work(r, 0);
+    _RUNNER_LOCK(r);
+    while (r->num_busy > 0) {
+        _RUNNER_WAIT(r, done_cond);
+    }
+    _RUNNER_UNLOCK(r);
+}
+
+uint32_t runner_ticks(runner_t* r, int index) {
+    CHIPS_ASSERT(r && r->valid && (index >= 0) && (index < r->num_instances));
+    return r->ticks[index];
+}
+
+chips_display_info_t runner_display_info(runner_t* r, int index) {
+    CHIPS_ASSERT(r && r->valid && (index >= 0) && (index < r->num_instances));
+    if (r->display_info) {
+        return r->display_info(r->instances[index]);
+    }
+    else {
+        chips_display_info_t res;
+        memset(&res, 0, sizeof(res));
+        return res;
+    }
+}
+
+chips_range_t runner_audio_samples(runner_t* r, int index) {
+    CHIPS_ASSERT(r && r->valid && (index >= 0) && (index < r->num_instances));
+    return (chips_range_t){ .ptr = r->audio[index].buffer, .size = (size_t)r->audio[index].num_samples * sizeof(float) };
+}
+
+void runner_audio_callback(const float* samples, int num_samples, void* user_data) {
+    runner_audio_t* audio = (runner_audio_t*) user_data;
+    CHIPS_ASSERT(samples && audio);
+    int num = audio->capacity - audio->num_samples;
+    if (num > num_samples) {
+        num = num_samples;
+    }
+    if (num > 0) {
+        memcpy(audio->buffer + audio->num_samples, samples, (size_t)num * sizeof(float));
+        audio->num_samples += num;
+    }
+}
+
+void* runner_audio_user_data(runner_t* r, int index) {
+    CHIPS_ASSERT(r && r->valid && (index >= 0) && (index < r->num_instances));
+    return &r->audio[index];
+}
+
+#endif /* CHIPS_UTIL_IMPL */
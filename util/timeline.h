@@ -0,0 +1,295 @@
+#pragma once
+/*#
+    # timeline.h
+
+    Export the hardware event timeline of a system emulator (see
+    'Hardware Event Timeline' in chips_common.h) together with host-side
+    timing spans to the Chrome trace event JSON format, which can be viewed
+    in chrome://tracing or https://ui.perfetto.dev.
+
+    Do this:
+    ~~~C
+    #define CHIPS_UTIL_IMPL
+    ~~~
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Optionally provide the following macros with your own implementation
+
+    ~~~C
+    CHIPS_ASSERT(c)
+    ~~~
+        your own assert macro (default: assert(c))
+
+    You need to include the following headers before including timeline.h:
+
+    - chips/chips_common.h
+
+    ## Usage
+
+    Compile the system emulator with CHIPS_EVENTS defined and provide a
+    chips_event_ring_t to the system. Initialize the exporter with the
+    system tick frequency and a write callback which appends the generated
+    JSON text to a file:
+
+    ~~~C
+    static void write_json(const char* str, size_t len, void* user_data) {
+        fwrite(str, 1, len, (FILE*)user_data);
+    }
+
+    timeline_init(&tl, &(timeline_desc_t){
+        .freq_hz = C64_FREQUENCY,
+        .name = "C64",
+        .write_cb = write_json,
+        .user_data = fp,
+    });
+    ~~~
+
+    Then in each frame, associate the current event ring tick with the host
+    time (in micro-seconds, from any monotonic host clock), run the
+    emulation, and drain the event ring into the JSON stream. Host-side
+    spans can be added with timeline_host_begin() and timeline_host_end():
+
+    ~~~C
+    const double now_us = host_time_us();
+    timeline_sync(&tl, ring.tick, now_us);
+    timeline_host_begin(&tl, "c64_exec", now_us);
+    c64_exec(&sys, frame_time_us);
+    timeline_host_end(&tl, "c64_exec", host_time_us());
+    timeline_drain(&tl, &ring);
+    ~~~
+
+    Call timeline_finish() before closing the file, this terminates the
+    JSON array (chrome://tracing and Perfetto also accept an unterminated
+    stream, so a trace file is still usable if the host doesn't shut down
+    cleanly).
+
+    ## Trace Layout
+
+    All events of the emulated system are in the process 'desc.name' (pid 1)
+    with one track per event category, the host-side spans are in the
+    process 'host' (pid 2):
+
+    - 'IRQ' and 'NMI': complete spans while the interrupt line is active
+    - 'Video': VSYNC and raster interrupt instant events
+    - 'Timers': counter/timer underflow instant events
+    - 'Sound': sound chip register writes, with register and value
+    - 'Memory': memory map updates, with the memory configuration value
+    - 'User': events with type CHIPS_EVENT_USER and above
+
+    The timestamps of the emulated system's events are computed from the
+    event tick and the last timeline_sync() call, so that the emulated
+    events are placed next to the host spans of the same frame.
+
+    ## zlib/libpng license
+
+    Copyright (c) 2024 Andre Weissflog
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// callback to append JSON text to the trace stream
+typedef void (*timeline_write_t)(const char* str, size_t len, void* user_data);
+
+typedef struct {
+    uint64_t freq_hz;           // tick frequency of the emulated system
+    const char* name;           // process name of the emulated system (default: "guest")
+    timeline_write_t write_cb;  // called with the generated JSON text
+    void* user_data;            // user data for the write callback
+} timeline_desc_t;
+
+typedef struct {
+    bool valid;
+    uint64_t freq_hz;
+    timeline_write_t write_cb;
+    void* user_data;
+    uint32_t num_events;        // number of events written so far
+    uint64_t sync_tick;         // event ring tick of the last timeline_sync() call
+    double sync_us;             // host time of the last timeline_sync() call
+    char buf[256];
+} timeline_t;
+
+// initialize the exporter, writes the start of the JSON stream
+void timeline_init(timeline_t* tl, const timeline_desc_t* desc);
+// associate an event ring tick with a host timestamp in micro-seconds
+void timeline_sync(timeline_t* tl, uint64_t tick, double host_us);
+// convert all pending events in an event ring to JSON, returns number of events
+int timeline_drain(timeline_t* tl, chips_event_ring_t* ring);
+// begin a host-side span
+void timeline_host_begin(timeline_t* tl, const char* name, double host_us);
+// end a host-side span
+void timeline_host_end(timeline_t* tl, const char* name, double host_us);
+// write the end of the JSON stream and discard the exporter
+void timeline_finish(timeline_t* tl);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_UTIL_IMPL
+#include <string.h> // strlen
+#include <stdio.h>  // snprintf
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+#define _TIMELINE_PID_GUEST (1)
+#define _TIMELINE_PID_HOST (2)
+
+// tracks of the emulated system
+enum {
+    _TIMELINE_TID_IRQ = 1,
+    _TIMELINE_TID_NMI,
+    _TIMELINE_TID_VIDEO,
+    _TIMELINE_TID_TIMERS,
+    _TIMELINE_TID_SOUND,
+    _TIMELINE_TID_MEMORY,
+    _TIMELINE_TID_USER,
+};
+
+static void _timeline_write(timeline_t* tl, int len) {
+    if (len <= 0) {
+        return;
+    }
+    if ((size_t)len >= sizeof(tl->buf)) {
+        len = (int)sizeof(tl->buf) - 1;
+    }
+    tl->write_cb(tl->buf, (size_t)len, tl->user_data);
+}
+
+// JSON array items are separated by commas
+static inline const char* _timeline_sep(timeline_t* tl) {
+    return (tl->num_events++ == 0) ? "" : ",\n";
+}
+
+static void _timeline_meta(timeline_t* tl, const char* kind, int pid, int tid, const char* name) {
+    _timeline_write(tl, snprintf(tl->buf, sizeof(tl->buf),
+        "%s{\"name\":\"%s\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+        _timeline_sep(tl), kind, pid, tid, name));
+}
+
+void timeline_init(timeline_t* tl, const timeline_desc_t* desc) {
+    CHIPS_ASSERT(tl && desc && desc->write_cb && (desc->freq_hz > 0));
+    memset(tl, 0, sizeof(timeline_t));
+    tl->valid = true;
+    tl->freq_hz = desc->freq_hz;
+    tl->write_cb = desc->write_cb;
+    tl->user_data = desc->user_data;
+    tl->write_cb("[\n", 2, tl->user_data);
+    _timeline_meta(tl, "process_name", _TIMELINE_PID_GUEST, 0, desc->name ? desc->name : "guest");
+    _timeline_meta(tl, "process_name", _TIMELINE_PID_HOST, 0, "host");
+    _timeline_meta(tl, "thread_name", _TIMELINE_PID_GUEST, _TIMELINE_TID_IRQ, "IRQ");
+    _timeline_meta(tl, "thread_name", _TIMELINE_PID_GUEST, _TIMELINE_TID_NMI, "NMI");
+    _timeline_meta(tl, "thread_name", _TIMELINE_PID_GUEST, _TIMELINE_TID_VIDEO, "Video");
+    _timeline_meta(tl, "thread_name", _TIMELINE_PID_GUEST, _TIMELINE_TID_TIMERS, "Timers");
+    _timeline_meta(tl, "thread_name", _TIMELINE_PID_GUEST, _TIMELINE_TID_SOUND, "Sound");
+    _timeline_meta(tl, "thread_name", _TIMELINE_PID_GUEST, _TIMELINE_TID_MEMORY, "Memory");
+    _timeline_meta(tl, "thread_name", _TIMELINE_PID_GUEST, _TIMELINE_TID_USER, "User");
+    _timeline_meta(tl, "thread_name", _TIMELINE_PID_HOST, 1, "host");
+}
+
+void timeline_sync(timeline_t* tl, uint64_t tick, double host_us) {
+    CHIPS_ASSERT(tl && tl->valid);
+    tl->sync_tick = tick;
+    tl->sync_us = host_us;
+}
+
+// convert an event tick to a host timestamp in micro-seconds (events before the sync tick are allowed)
+static double _timeline_tick_to_us(timeline_t* tl, uint64_t tick) {
+    const double dt = (double)(int64_t)(tick - tl->sync_tick);
+    return tl->sync_us + (dt * 1000000.0) / (double)tl->freq_hz;
+}
+
+static void _timeline_instant(timeline_t* tl, const char* name, int tid, double ts, const chips_event_t* ev) {
+    _timeline_write(tl, snprintf(tl->buf, sizeof(tl->buf),
+        "%s{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"args\":{\"addr\":%u,\"data\":%u}}",
+        _timeline_sep(tl), name, _TIMELINE_PID_GUEST, tid, ts, ev->addr, (unsigned)ev->data));
+}
+
+static void _timeline_span(timeline_t* tl, const char* name, int pid, int tid, bool begin, double ts) {
+    _timeline_write(tl, snprintf(tl->buf, sizeof(tl->buf),
+        "%s{\"name\":\"%s\",\"ph\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f}",
+        _timeline_sep(tl), name, begin ? "B" : "E", pid, tid, ts));
+}
+
+int timeline_drain(timeline_t* tl, chips_event_ring_t* ring) {
+    CHIPS_ASSERT(tl && tl->valid && ring);
+    int num = 0;
+    const chips_event_t* ev;
+    char name[32];
+    while ((ev = chips_event_ring_next(ring))) {
+        const double ts = _timeline_tick_to_us(tl, ev->tick);
+        switch (ev->type) {
+            case CHIPS_EVENT_IRQ:
+                _timeline_span(tl, "IRQ", _TIMELINE_PID_GUEST, _TIMELINE_TID_IRQ, 0 != ev->data, ts);
+                break;
+            case CHIPS_EVENT_NMI:
+                _timeline_span(tl, "NMI", _TIMELINE_PID_GUEST, _TIMELINE_TID_NMI, 0 != ev->data, ts);
+                break;
+            case CHIPS_EVENT_VSYNC:
+                _timeline_instant(tl, "VSYNC", _TIMELINE_TID_VIDEO, ts, ev);
+                break;
+            case CHIPS_EVENT_RASTER_IRQ:
+                snprintf(name, sizeof(name), "Raster IRQ %u", ev->addr);
+                _timeline_instant(tl, name, _TIMELINE_TID_VIDEO, ts, ev);
+                break;
+            case CHIPS_EVENT_TIMER:
+                snprintf(name, sizeof(name), "Timer %u", ev->addr);
+                _timeline_instant(tl, name, _TIMELINE_TID_TIMERS, ts, ev);
+                break;
+            case CHIPS_EVENT_SOUND_REG:
+                snprintf(name, sizeof(name), "Reg %02X=%02X", ev->addr, (unsigned)(ev->data & 0xFF));
+                _timeline_instant(tl, name, _TIMELINE_TID_SOUND, ts, ev);
+                break;
+            case CHIPS_EVENT_MEMORY_MAP:
+                snprintf(name, sizeof(name), "Map %02X", (unsigned)ev->data);
+                _timeline_instant(tl, name, _TIMELINE_TID_MEMORY, ts, ev);
+                break;
+            default:
+                snprintf(name, sizeof(name), "Event %02X", ev->type);
+                _timeline_instant(tl, name, _TIMELINE_TID_USER, ts, ev);
+                break;
+        }
+        num++;
+    }
+    return num;
+}
+
+void timeline_host_begin(timeline_t* tl, const char* name, double host_us) {
+    CHIPS_ASSERT(tl && tl->valid && name);
+    _timeline_span(tl, name, _TIMELINE_PID_HOST, 1, true, host_us);
+}
+
+void timeline_host_end(timeline_t* tl, const char* name, double host_us) {
+    CHIPS_ASSERT(tl && tl->valid && name);
+    _timeline_span(tl, name, _TIMELINE_PID_HOST, 1, false, host_us);
+}
+
+void timeline_finish(timeline_t* tl) {
+    CHIPS_ASSERT(tl && tl->valid);
+    tl->write_cb("\n]\n", 3, tl->user_data);
+    tl->valid = false;
+}
+
+#endif /* CHIPS_UTIL_IMPL */
@@ -0,0 +1,583 @@
+#pragma once
+/*#
+    # trace.h
+
+    Record long instruction traces (PC, register changes and memory writes)
+    of a Z80 or 6502 system emulator into a compact, chunked byte stream,
+    and read them back.
+
+    Do this:
+    ~~~C
+    #define CHIPS_UTIL_IMPL
+    ~~~
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Select the traced CPU with the following macros (define one
+    or the other, but not both):
+
+    TRACE_USE_Z80
+    TRACE_USE_M6502
+
+    Optionally provide the following macros with your own implementation
+
+    ~~~C
+    CHIPS_ASSERT(c)
+    ~~~
+        your own assert macro (default: assert(c))
+
+    You need to include the following headers before including trace.h:
+
+    - chips/chips_common.h
+    - chips/z80.h       (only if TRACE_USE_Z80 is defined)
+    - chips/m6502.h     (only if TRACE_USE_M6502 is defined)
+
+    ## Overview
+
+    The recorder is attached to a system emulator through the debug
+    callback, with a debug callback filter (see 'Debug Callback Filter'
+    in chips_common.h) which only invokes the recorder at instruction
+    boundaries and on memory write ticks, so the system doesn't need to
+    call out on every tick:
+
+    ~~~C
+    static uint8_t chunk_buffer[64 * 1024];
+    static trace_t trace;
+
+    trace_init(&trace, &(trace_desc_t){
+        .z80 = &sys.cpu,
+        .buffer = { .ptr = chunk_buffer, .size = sizeof(chunk_buffer) },
+        .write_cb = my_write_func,
+        .user_data = my_file,
+    });
+    zx_init(&sys, &(zx_desc_t){
+        .debug = trace_get_debug(&trace),
+        ...
+    });
+    ~~~
+
+    NOTE: since the recorder takes the place of the debug callback, it
+    can't be used together with the ui_dbg.h debugger window in the same
+    system instance.
+
+    The recorder encodes each event as a small record into the chunk buffer
+    provided in trace_desc_t.buffer. When the chunk buffer is full (or when
+    trace_flush() is called), the chunk is handed to the write callback and
+    the recorder starts a new chunk in the same buffer, so the recorder
+    never allocates memory and never grows, no matter how long the trace
+    runs. The write callback usually appends the chunk to a file, all
+    chunks together are the trace stream.
+
+    Call trace_flush() before closing the file to write the last partial
+    chunk.
+
+    To read a trace, map or load the trace stream into memory, and iterate
+    over the items with trace_reader_next(). To look at a specific point in
+    time, first call trace_reader_seek() with a tick count, this skips whole
+    chunks with a single header read each:
+
+    ~~~C
+    trace_reader_t reader;
+    trace_reader_init(&reader, (chips_range_t){ .ptr = data, .size = size });
+    trace_reader_seek(&reader, tick);
+    trace_item_t item;
+    while (trace_reader_next(&reader, &item)) {
+        if (item.type == TRACE_ITEM_OP) {
+            // item.tick, item.pc, item.regs[]
+        }
+        else {
+            // TRACE_ITEM_WRITE: item.tick, item.addr, item.data
+        }
+    }
+    ~~~
+
+    Tick counts start at zero when the recorder is initialized.
+
+    ## Trace Stream Format
+
+    The trace stream is a sequence of chunks, each chunk is self-contained,
+    so that a reader can start decoding at any chunk. All values are
+    stored in little-endian byte order.
+
+    Each chunk starts with a header:
+
+    - 4 bytes: magic 'CTRC'
+    - 4 bytes: chunk size in bytes (including the header)
+    - 8 bytes: tick count at the start of the chunk
+    - 2 bytes: PC of the last instruction before the chunk
+    - 2 bytes: address of the last memory write before the chunk
+    - 2 bytes each: the TRACE_NUM_REGS register values before the chunk
+
+    ...followed by the records. Each record starts with a tag byte, bit 7
+    is the record type (0: instruction, 1: memory write) and bits 0..6 are
+    the number of ticks since the previous record (if the number of ticks
+    is 127 or more, the bits are all set and the tick count follows as
+    a variable-length integer).
+
+    Instruction records continue with the PC difference to the previous
+    instruction (a zigzag-encoded variable-length integer), a variable-length
+    bit mask of changed registers, and for each changed register the
+    zigzag-encoded difference to the previous value.
+
+    Memory write records continue with the zigzag-encoded address
+    difference to the previous write, and the written byte.
+
+    The registers values are captured at the start of each instruction:
+
+    - Z80: AF, BC, DE, HL, IX, IY, SP, AF', BC', DE', HL' and a combined
+      value with I in the upper byte and IM, IFF1 and IFF2 in the lower byte
+      (IM in bits 0..1, IFF1 in bit 4 and IFF2 in bit 5)
+    - 6502: A, X, Y, S and P
+
+    ## zlib/libpng license
+
+    Copyright (c) 2024 Andre Weissflog
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#if !defined(TRACE_USE_Z80) && !defined(TRACE_USE_M6502)
+#error "please define TRACE_USE_Z80 or TRACE_USE_M6502"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(TRACE_USE_Z80)
+#define TRACE_NUM_REGS (12)
+#else
+#define TRACE_NUM_REGS (5)
+#endif
+#define TRACE_CHUNK_HEADER_SIZE (22 + TRACE_NUM_REGS * 2)
+#define TRACE_MAX_RECORD_SIZE (16 + TRACE_NUM_REGS * 3)
+#define TRACE_MIN_CHUNK_SIZE (TRACE_CHUNK_HEADER_SIZE + 16 * TRACE_MAX_RECORD_SIZE)
+
+// trace item types
+#define TRACE_ITEM_OP (0)       // start of an instruction
+#define TRACE_ITEM_WRITE (1)    // memory write
+
+// callback to store a completed chunk
+typedef void (*trace_write_t)(const void* data, size_t num_bytes, void* user_data);
+
+typedef struct {
+    #if defined(TRACE_USE_Z80)
+    z80_t* z80;                 // the traced CPU
+    #else
+    m6502_t* m6502;             // the traced CPU
+    #endif
+    chips_range_t buffer;       // chunk buffer, at least TRACE_MIN_CHUNK_SIZE bytes
+    trace_write_t write_cb;     // called with each completed chunk
+    void* user_data;            // user data for the write callback
+} trace_desc_t;
+
+// the current delta-encoding state
+typedef struct {
+    uint64_t tick;              // tick count of the last record
+    uint16_t pc;                // PC of the last instruction record
+    uint16_t addr;              // address of the last memory write record
+    uint16_t regs[TRACE_NUM_REGS];
+} trace_state_t;
+
+typedef struct {
+    #if defined(TRACE_USE_Z80)
+    z80_t* z80;
+    #else
+    m6502_t* m6502;
+    #endif
+    uint8_t* buf;
+    size_t buf_size;
+    size_t pos;                 // write position in chunk buffer
+    trace_write_t write_cb;
+    void* user_data;
+    bool stopped;               // always false (required by chips_debug_t)
+    uint32_t num_chunks;        // number of chunks passed to the write callback
+    trace_state_t state;
+    chips_debug_filter_t filter;
+} trace_t;
+
+// a decoded trace item
+typedef struct {
+    int type;                   // TRACE_ITEM_*
+    uint64_t tick;
+    uint16_t pc;                // TRACE_ITEM_OP: instruction address
+    uint16_t regs[TRACE_NUM_REGS];  // TRACE_ITEM_OP: register values at start of instruction
+    uint16_t addr;              // TRACE_ITEM_WRITE: written address
+    uint8_t data;               // TRACE_ITEM_WRITE: written byte
+} trace_item_t;
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t chunk_pos;           // start of current chunk
+    size_t chunk_end;           // end of current chunk
+    size_t pos;                 // read position in current chunk
+    trace_state_t state;
+    bool has_pending;           // true if 'pending' has been decoded by trace_reader_seek()
+    trace_item_t pending;
+} trace_reader_t;
+
+// initialize a trace recorder
+void trace_init(trace_t* trace, const trace_desc_t* desc);
+// get a chips_debug_t to provide to the system emulator's desc struct
+chips_debug_t trace_get_debug(trace_t* trace);
+// the debug callback, records instructions and memory writes
+void trace_tick(trace_t* trace, uint64_t pins);
+// pass the current partial chunk to the write callback
+void trace_flush(trace_t* trace);
+
+// initialize a trace reader on a trace stream in memory
+void trace_reader_init(trace_reader_t* reader, chips_range_t data);
+// decode the next trace item, return false at end of stream
+bool trace_reader_next(trace_reader_t* reader, trace_item_t* out_item);
+// position the reader so that the next item is the first at or after tick, return false if there is none
+bool trace_reader_seek(trace_reader_t* reader, uint64_t tick);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_UTIL_IMPL
+#include <string.h> // memset
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+static inline void _trace_put_u16(uint8_t* ptr, uint16_t val) {
+    ptr[0] = (uint8_t)val;
+    ptr[1] = (uint8_t)(val >> 8);
+}
+
+static inline uint16_t _trace_get_u16(const uint8_t* ptr) {
+    return (uint16_t)(ptr[0] | (ptr[1] << 8));
+}
+
+static inline void _trace_put_u32(uint8_t* ptr, uint32_t val) {
+    _trace_put_u16(ptr, (uint16_t)val);
+    _trace_put_u16(ptr + 2, (uint16_t)(val >> 16));
+}
+
+static inline uint32_t _trace_get_u32(const uint8_t* ptr) {
+    return (uint32_t)_trace_get_u16(ptr) | ((uint32_t)_trace_get_u16(ptr + 2) << 16);
+}
+
+static inline void _trace_put_u64(uint8_t* ptr, uint64_t val) {
+    _trace_put_u32(ptr, (uint32_t)val);
+    _trace_put_u32(ptr + 4, (uint32_t)(val >> 32));
+}
+
+static inline uint64_t _trace_get_u64(const uint8_t* ptr) {
+    return (uint64_t)_trace_get_u32(ptr) | ((uint64_t)_trace_get_u32(ptr + 4) << 32);
+}
+
+static inline uint8_t* _trace_put_varint(uint8_t* ptr, uint64_t val) {
+    while (val >= 0x80) {
+        *ptr++ = (uint8_t)(val | 0x80);
+        val >>= 7;
+    }
+    *ptr++ = (uint8_t)val;
+    return ptr;
+}
+
+// 16-bit differences are zigzag-encoded so that small negative differences are small numbers
+static inline uint8_t* _trace_put_delta16(uint8_t* ptr, uint16_t cur, uint16_t prev) {
+    const int16_t d = (int16_t)(uint16_t)(cur - prev);
+    const uint16_t zz = (uint16_t)(((uint16_t)d << 1) ^ (uint16_t)(d >> 15));
+    return _trace_put_varint(ptr, zz);
+}
+
+static const uint8_t _trace_magic[4] = { 'C', 'T', 'R', 'C' };
+
+static void _trace_begin_chunk(trace_t* trace) {
+    uint8_t* hdr = trace->buf;
+    memcpy(hdr, _trace_magic, 4);
+    _trace_put_u32(hdr + 4, 0);
+    _trace_put_u64(hdr + 8, trace->state.tick);
+    _trace_put_u16(hdr + 16, trace->state.pc);
+    _trace_put_u16(hdr + 18, trace->state.addr);
+    for (int i = 0; i < TRACE_NUM_REGS; i++) {
+        _trace_put_u16(hdr + 20 + i * 2, trace->state.regs[i]);
+    }
+    trace->pos = TRACE_CHUNK_HEADER_SIZE;
+}
+
+static void _trace_end_chunk(trace_t* trace) {
+    _trace_put_u32(trace->buf + 4, (uint32_t)trace->pos);
+    trace->write_cb(trace->buf, trace->pos, trace->user_data);
+    trace->num_chunks++;
+    _trace_begin_chunk(trace);
+}
+
+void trace_init(trace_t* trace, const trace_desc_t* desc) {
+    CHIPS_ASSERT(trace && desc);
+    CHIPS_ASSERT(desc->buffer.ptr && (desc->buffer.size >= TRACE_MIN_CHUNK_SIZE));
+    CHIPS_ASSERT(desc->write_cb);
+    memset(trace, 0, sizeof(trace_t));
+    #if defined(TRACE_USE_Z80)
+        CHIPS_ASSERT(desc->z80);
+        trace->z80 = desc->z80;
+    #else
+        CHIPS_ASSERT(desc->m6502);
+        trace->m6502 = desc->m6502;
+    #endif
+    trace->buf = (uint8_t*) desc->buffer.ptr;
+    trace->buf_size = desc->buffer.size;
+    trace->write_cb = desc->write_cb;
+    trace->user_data = desc->user_data;
+    // only call the recorder at instruction boundaries and on memory writes
+    trace->filter.flags = CHIPS_DEBUG_FILTER_OP;
+    memset(trace->filter.write, 0xFF, sizeof(trace->filter.write));
+    _trace_begin_chunk(trace);
+}
+
+chips_debug_t trace_get_debug(trace_t* trace) {
+    CHIPS_ASSERT(trace);
+    chips_debug_t res;
+    memset(&res, 0, sizeof(res));
+    res.callback.func = (chips_debug_func_t) trace_tick;
+    res.callback.user_data = trace;
+    res.stopped = &trace->stopped;
+    res.filter = &trace->filter;
+    return res;
+}
+
+static inline uint8_t* _trace_put_tag(uint8_t* ptr, uint8_t type_bit, uint64_t num_ticks) {
+    if (num_ticks < 0x7F) {
+        *ptr++ = type_bit | (uint8_t)num_ticks;
+    }
+    else {
+        *ptr++ = type_bit | 0x7F;
+        ptr = _trace_put_varint(ptr, num_ticks);
+    }
+    return ptr;
+}
+
+static inline void _trace_get_regs(trace_t* trace, uint16_t* regs) {
+    #if defined(TRACE_USE_Z80)
+        z80_t* cpu = trace->z80;
+        z80_sync_flags(cpu);
+        regs[0] = cpu->af;
+        regs[1] = cpu->bc;
+        regs[2] = cpu->de;
+        regs[3] = cpu->hl;
+        regs[4] = cpu->ix;
+        regs[5] = cpu->iy;
+        regs[6] = cpu->sp;
+        regs[7] = cpu->af2;
+        regs[8] = cpu->bc2;
+        regs[9] = cpu->de2;
+        regs[10] = cpu->hl2;
+        regs[11] = (uint16_t)((cpu->i << 8) | (cpu->im & 3) | (cpu->iff1 ? 0x10 : 0) | (cpu->iff2 ? 0x20 : 0));
+    #else
+        const m6502_t* cpu = trace->m6502;
+        regs[0] = cpu->A;
+        regs[1] = cpu->X;
+        regs[2] = cpu->Y;
+        regs[3] = cpu->S;
+        regs[4] = cpu->P;
+    #endif
+}
+
+void trace_tick(trace_t* trace, uint64_t pins) {
+    #if defined(TRACE_USE_Z80)
+        const bool op_done = z80_opdone(trace->z80);
+        const bool mem_wr = (pins & (Z80_MREQ|Z80_WR)) == (Z80_MREQ|Z80_WR);
+        const uint16_t addr = Z80_GET_ADDR(pins);
+        const uint8_t data = Z80_GET_DATA(pins);
+    #else
+        const bool op_done = 0 != (pins & M6502_SYNC);
+        const bool mem_wr = 0 == (pins & M6502_RW);
+        const uint16_t addr = M6502_GET_ADDR(pins);
+        const uint8_t data = M6502_GET_DATA(pins);
+    #endif
+    if (!(op_done || mem_wr)) {
+        return;
+    }
+    if ((trace->pos + TRACE_MAX_RECORD_SIZE) > trace->buf_size) {
+        _trace_end_chunk(trace);
+    }
+    // the filter's tick counter includes the current tick
+    const uint64_t tick = trace->filter.ticks - 1;
+    trace_state_t* state = &trace->state;
+    uint8_t* ptr = trace->buf + trace->pos;
+    if (op_done) {
+        uint16_t regs[TRACE_NUM_REGS];
+        _trace_get_regs(trace, regs);
+        uint32_t mask = 0;
+        for (int i = 0; i < TRACE_NUM_REGS; i++) {
+            if (regs[i] != state->regs[i]) {
+                mask |= 1u << i;
+            }
+        }
+        ptr = _trace_put_tag(ptr, 0x00, tick - state->tick);
+        ptr = _trace_put_delta16(ptr, addr, state->pc);
+        ptr = _trace_put_varint(ptr, mask);
+        for (int i = 0; mask != 0; i++, mask >>= 1) {
+            if (mask & 1) {
+                ptr = _trace_put_delta16(ptr, regs[i], state->regs[i]);
+                state->regs[i] = regs[i];
+            }
+        }
+        state->pc = addr;
+    }
+    else {
+        ptr = _trace_put_tag(ptr, 0x80, tick - state->tick);
+        ptr = _trace_put_delta16(ptr, addr, state->addr);
+        *ptr++ = data;
+        state->addr = addr;
+    }
+    state->tick = tick;
+    trace->pos = (size_t)(ptr - trace->buf);
+}
+
+void trace_flush(trace_t* trace) {
+    CHIPS_ASSERT(trace);
+    if (trace->pos > TRACE_CHUNK_HEADER_SIZE) {
+        _trace_end_chunk(trace);
+    }
+}
+
+/*-- reader ------------------------------------------------------------------*/
+
+// returns false if the current position doesn't contain a valid chunk header
+static bool _trace_reader_chunk_at(trace_reader_t* reader, size_t pos) {
+    if ((pos + TRACE_CHUNK_HEADER_SIZE) > reader->size) {
+        return false;
+    }
+    const uint8_t* hdr = reader->data + pos;
+    const uint32_t chunk_size = _trace_get_u32(hdr + 4);
+    if ((0 != memcmp(hdr, _trace_magic, 4)) || (chunk_size < TRACE_CHUNK_HEADER_SIZE) || ((pos + chunk_size) > reader->size)) {
+        return false;
+    }
+    reader->chunk_pos = pos;
+    reader->chunk_end = pos + chunk_size;
+    reader->pos = pos + TRACE_CHUNK_HEADER_SIZE;
+    reader->state.tick = _trace_get_u64(hdr + 8);
+    reader->state.pc = _trace_get_u16(hdr + 16);
+    reader->state.addr = _trace_get_u16(hdr + 18);
+    for (int i = 0; i < TRACE_NUM_REGS; i++) {
+        reader->state.regs[i] = _trace_get_u16(hdr + 20 + i * 2);
+    }
+    return true;
+}
+
+void trace_reader_init(trace_reader_t* reader, chips_range_t data) {
+    CHIPS_ASSERT(reader);
+    memset(reader, 0, sizeof(trace_reader_t));
+    reader->data = (const uint8_t*) data.ptr;
+    reader->size = data.ptr ? data.size : 0;
+    if (!_trace_reader_chunk_at(reader, 0)) {
+        reader->chunk_pos = reader->chunk_end = reader->pos = reader->size;
+    }
+}
+
+static inline uint64_t _trace_get_varint(trace_reader_t* reader) {
+    uint64_t val = 0;
+    int shift = 0;
+    while (reader->pos < reader->chunk_end) {
+        const uint8_t b = reader->data[reader->pos++];
+        val |= (uint64_t)(b & 0x7F) << shift;
+        if (0 == (b & 0x80)) {
+            break;
+        }
+        shift += 7;
+    }
+    return val;
+}
+
+static inline uint16_t _trace_get_delta16(trace_reader_t* reader, uint16_t prev) {
+    const uint16_t zz = (uint16_t)_trace_get_varint(reader);
+    const uint16_t d = (uint16_t)((zz >> 1) ^ (uint16_t)(0 - (zz & 1)));
+    return (uint16_t)(prev + d);
+}
+
+static bool _trace_reader_decode(trace_reader_t* reader, trace_item_t* item) {
+    // move on to the next chunk when the current chunk has been decoded
+    while (reader->pos >= reader->chunk_end) {
+        if (!_trace_reader_chunk_at(reader, reader->chunk_end)) {
+            reader->pos = reader->chunk_end;
+            return false;
+        }
+    }
+    trace_state_t* state = &reader->state;
+    const uint8_t tag = reader->data[reader->pos++];
+    uint64_t num_ticks = tag & 0x7F;
+    if (num_ticks == 0x7F) {
+        num_ticks = _trace_get_varint(reader);
+    }
+    state->tick += num_ticks;
+    if (0 == (tag & 0x80)) {
+        state->pc = _trace_get_delta16(reader, state->pc);
+        uint32_t mask = (uint32_t)_trace_get_varint(reader);
+        for (int i = 0; (i < TRACE_NUM_REGS) && (mask != 0); i++, mask >>= 1) {
+            if (mask & 1) {
+                state->regs[i] = _trace_get_delta16(reader, state->regs[i]);
+            }
+        }
+        item->type = TRACE_ITEM_OP;
+        item->tick = state->tick;
+        item->pc = state->pc;
+        memcpy(item->regs, state->regs, sizeof(item->regs));
+        item->addr = 0;
+        item->data = 0;
+    }
+    else {
+        state->addr = _trace_get_delta16(reader, state->addr);
+        item->type = TRACE_ITEM_WRITE;
+        item->tick = state->tick;
+        item->pc = state->pc;
+        memcpy(item->regs, state->regs, sizeof(item->regs));
+        item->addr = state->addr;
+        item->data = (reader->pos < reader->chunk_end) ? reader->data[reader->pos++] : 0;
+    }
+    return true;
+}
+
+bool trace_reader_next(trace_reader_t* reader, trace_item_t* out_item) {
+    CHIPS_ASSERT(reader && out_item);
+    if (reader->has_pending) {
+        *out_item = reader->pending;
+        reader->has_pending = false;
+        return true;
+    }
+    return _trace_reader_decode(reader, out_item);
+}
+
+bool trace_reader_seek(trace_reader_t* reader, uint64_t tick) {
+    CHIPS_ASSERT(reader);
+    reader->has_pending = false;
+    // find the last chunk which starts before the requested tick by only looking at the chunk headers
+    if (!_trace_reader_chunk_at(reader, 0)) {
+        return false;
+    }
+    trace_reader_t next = *reader;
+    while (_trace_reader_chunk_at(&next, reader->chunk_end) && (next.state.tick < tick)) {
+        *reader = next;
+    }
+    // ...then decode items until the requested tick is reached
+    while (_trace_reader_decode(reader, &reader->pending)) {
+        if (reader->pending.tick >= tick) {
+            reader->has_pending = true;
+            return true;
+        }
+    }
+    return false;
+}
+#endif // CHIPS_UTIL_IMPL
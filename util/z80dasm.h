@@ -44,6 +44,57 @@
     All undocumented instructions are supported, but are currently
     not marked as such.
 
+    ## Bulk Decoding
+
+    For offline tools which need to process entire memory images, there's
+    a buffer-based API which doesn't call any function pointers and decodes
+    instructions into structured records instead of text:
+
+    ~~~C
+    size_t z80dasm_decode_range(uint16_t addr, const uint8_t* bytes, size_t num_bytes, z80dasm_inst_t* insts, size_t max_insts)
+    ~~~
+
+    addr    - the address of the first byte in the buffer
+    bytes   - pointer to the instruction bytes
+    num_bytes - number of bytes in the buffer
+    insts   - pointer to an array of z80dasm_inst_t items
+    max_insts - number of items in the insts array
+
+    The function decodes consecutive instructions until either the insts
+    array is full or the end of the byte buffer is reached (an instruction
+    which would read past the end of the buffer isn't decoded), and returns
+    the number of decoded instructions. The next address to continue
+    decoding at is `insts[n-1].addr + insts[n-1].len`.
+
+    A single instruction can be decoded with:
+
+    ~~~C
+    int z80dasm_decode(uint16_t addr, const uint8_t* bytes, size_t num_bytes, z80dasm_inst_t* out_inst)
+    ~~~
+
+    This returns the length of the instruction in bytes, or 0 if the
+    instruction doesn't fit into the buffer.
+
+    Each z80dasm_inst_t record contains:
+
+    - the instruction address, length and raw instruction bytes
+    - a mnemonic id (Z80DASM_MN_xxx)
+    - the control flow type (Z80DASM_FLOW_xxx) and whether the
+      flow change is conditional
+    - the operand values (8- or 16-bit immediate value, index register
+      displacement and jump/call target address), the `opnds` bit mask
+      tells which of those are valid (Z80DASM_OPND_xxx)
+
+    To get the text representation of a decoded instruction (the same
+    string z80dasm_op() would produce), call:
+
+    ~~~C
+    int z80dasm_render(const z80dasm_inst_t* inst, char* buf, int buf_size)
+    ~~~
+
+    This writes a zero-terminated string to buf and returns the string
+    length without the terminating zero.
+
     ## Links
 
     The disassembler uses this decoding strategy:
@@ -69,6 +120,8 @@
         distribution. 
 #*/
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -79,8 +132,123 @@ typedef uint8_t (*z80dasm_input_t)(void* user_data);
 /* the output callback type */
 typedef void (*z80dasm_output_t)(char c, void* user_data);
 
+/* max length of the rendered text of an instruction including terminating zero */
+#define Z80DASM_MAX_STRLEN (32)
+/* max number of bytes in one instruction */
+#define Z80DASM_MAX_BYTES (4)
+
+/* mnemonic ids */
+typedef enum {
+    Z80DASM_MN_INVALID = 0,     /* double prefix */
+    Z80DASM_MN_NOP,
+    Z80DASM_MN_LD,
+    Z80DASM_MN_EX,
+    Z80DASM_MN_EXX,
+    Z80DASM_MN_PUSH,
+    Z80DASM_MN_POP,
+    Z80DASM_MN_ADD,
+    Z80DASM_MN_ADC,
+    Z80DASM_MN_SUB,
+    Z80DASM_MN_SBC,
+    Z80DASM_MN_AND,
+    Z80DASM_MN_XOR,
+    Z80DASM_MN_OR,
+    Z80DASM_MN_CP,
+    Z80DASM_MN_INC,
+    Z80DASM_MN_DEC,
+    Z80DASM_MN_DAA,
+    Z80DASM_MN_CPL,
+    Z80DASM_MN_NEG,
+    Z80DASM_MN_CCF,
+    Z80DASM_MN_SCF,
+    Z80DASM_MN_HALT,
+    Z80DASM_MN_DI,
+    Z80DASM_MN_EI,
+    Z80DASM_MN_IM,
+    Z80DASM_MN_RLCA,
+    Z80DASM_MN_RRCA,
+    Z80DASM_MN_RLA,
+    Z80DASM_MN_RRA,
+    Z80DASM_MN_RLC,
+    Z80DASM_MN_RRC,
+    Z80DASM_MN_RL,
+    Z80DASM_MN_RR,
+    Z80DASM_MN_SLA,
+    Z80DASM_MN_SRA,
+    Z80DASM_MN_SLL,
+    Z80DASM_MN_SRL,
+    Z80DASM_MN_RLD,
+    Z80DASM_MN_RRD,
+    Z80DASM_MN_BIT,
+    Z80DASM_MN_RES,
+    Z80DASM_MN_SET,
+    Z80DASM_MN_JP,
+    Z80DASM_MN_JR,
+    Z80DASM_MN_DJNZ,
+    Z80DASM_MN_CALL,
+    Z80DASM_MN_RET,
+    Z80DASM_MN_RETI,
+    Z80DASM_MN_RETN,
+    Z80DASM_MN_RST,
+    Z80DASM_MN_IN,
+    Z80DASM_MN_OUT,
+    Z80DASM_MN_LDI,
+    Z80DASM_MN_LDIR,
+    Z80DASM_MN_LDD,
+    Z80DASM_MN_LDDR,
+    Z80DASM_MN_CPI,
+    Z80DASM_MN_CPIR,
+    Z80DASM_MN_CPD,
+    Z80DASM_MN_CPDR,
+    Z80DASM_MN_INI,
+    Z80DASM_MN_INIR,
+    Z80DASM_MN_IND,
+    Z80DASM_MN_INDR,
+    Z80DASM_MN_OUTI,
+    Z80DASM_MN_OTIR,
+    Z80DASM_MN_OUTD,
+    Z80DASM_MN_OTDR,
+    Z80DASM_MN_NUM,
+} z80dasm_mnemonic_t;
+
+/* control flow types */
+typedef enum {
+    Z80DASM_FLOW_NONE = 0,          /* continues with the next instruction */
+    Z80DASM_FLOW_JUMP,              /* JP nnnn, JR d, DJNZ d */
+    Z80DASM_FLOW_JUMP_INDIRECT,     /* JP (HL), JP (IX), JP (IY) */
+    Z80DASM_FLOW_CALL,              /* CALL nnnn, RST n */
+    Z80DASM_FLOW_RET,               /* RET, RETI, RETN */
+    Z80DASM_FLOW_HALT,              /* HALT */
+} z80dasm_flow_t;
+
+/* z80dasm_inst_t.opnds bits */
+#define Z80DASM_OPND_IMM8   (1<<0)  /* imm is an 8-bit immediate value */
+#define Z80DASM_OPND_IMM16  (1<<1)  /* imm is a 16-bit immediate value or address */
+#define Z80DASM_OPND_DISP   (1<<2)  /* disp is an (IX+d)/(IY+d) displacement */
+#define Z80DASM_OPND_TARGET (1<<3)  /* target is a jump or call target address */
+
+/* a decoded instruction */
+typedef struct {
+    uint16_t addr;              /* address of the first instruction byte */
+    uint8_t len;                /* instruction length in bytes */
+    uint8_t bytes[Z80DASM_MAX_BYTES];
+    uint8_t mnemonic;           /* Z80DASM_MN_xxx */
+    uint8_t flow;               /* Z80DASM_FLOW_xxx */
+    bool cond;                  /* true if the flow change is conditional */
+    uint8_t opnds;              /* Z80DASM_OPND_xxx bits */
+    int8_t disp;                /* index register displacement */
+    uint16_t imm;               /* immediate value or absolute address */
+    uint16_t target;            /* jump or call target address */
+} z80dasm_inst_t;
+
 /* disassemble a single Z80 instruction into a stream of ASCII characters */
 uint16_t z80dasm_op(uint16_t pc, z80dasm_input_t in_cb, z80dasm_output_t out_cb, void* user_data);
+/* decode a single instruction from a byte buffer, returns instruction length or 0 */
+int z80dasm_decode(uint16_t addr, const uint8_t* bytes, size_t num_bytes, z80dasm_inst_t* out_inst);
+/* decode consecutive instructions from a byte buffer, returns number of decoded instructions */
+size_t z80dasm_decode_range(uint16_t addr, const uint8_t* bytes, size_t num_bytes, z80dasm_inst_t* insts, size_t max_insts);
+/* render a decoded instruction as text, returns string length */
+int z80dasm_render(const z80dasm_inst_t* inst, char* buf, int buf_size);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -97,47 +265,47 @@ uint16_t z80dasm_op(uint16_t pc, z80dasm_input_t in_cb, z80dasm_output_t out_cb,
 #ifdef _FETCH_U8
 #undef _FETCH_U8
 #endif
-#define _FETCH_U8(v) v=in_cb(user_data);pc++;
+#define _FETCH_U8(v) v=_z80dasm_fetch(ctx);pc++;
 /* fetch signed 8-bit value and track pc */
 #ifdef _FETCH_I8
 #undef _FETCH_I8
 #endif
-#define _FETCH_I8(v) v=(int8_t)in_cb(user_data);pc++;
+#define _FETCH_I8(v) v=(int8_t)_z80dasm_fetch(ctx);pc++;
 /* fetch unsigned 16-bit value and track pc */
 #ifdef _FETCH_U16
 #undef _FETCH_U16
 #endif
-#define _FETCH_U16(v) v=in_cb(user_data);v|=in_cb(user_data)<<8;pc+=2;
+#define _FETCH_U16(v) v=_z80dasm_fetch(ctx);v|=_z80dasm_fetch(ctx)<<8;pc+=2;
 /* output character */
 #ifdef _CHR
 #undef _CHR
 #endif
-#define _CHR(c) if (out_cb) { out_cb(c,user_data); }
+#define _CHR(c) _z80dasm_chr(c,ctx);
 /* output string */
 #ifdef _STR
 #undef _STR
 #endif
-#define _STR(s) _z80dasm_str(s,out_cb,user_data);
+#define _STR(s) _z80dasm_str(s,ctx);
 /* output offset as signed 8-bit string (decimal) */
 #ifdef _STR_D8
 #undef _STR_D8
 #endif
-#define _STR_D8(d8) _z80dasm_d8((int8_t)(d8),out_cb,user_data);
+#define _STR_D8(d8) _z80dasm_d8((int8_t)(d8),ctx);
 /* output number as unsigned 8-bit string (hex) */
 #ifdef _STR_U8
 #undef _STR_U8
 #endif
-#define _STR_U8(u8) _z80dasm_u8((uint8_t)(u8),out_cb,user_data);
+#define _STR_U8(u8) _z80dasm_u8((uint8_t)(u8),ctx);
 /* output number number as unsigned 16-bit string (hex) */
 #ifdef _STR_U16
 #undef _STR_U16
 #endif
-#define _STR_U16(u16) _z80dasm_u16((uint16_t)(u16),out_cb,user_data);
+#define _STR_U16(u16) _z80dasm_u16((uint16_t)(u16),ctx);
 /* (HL)/(IX+d)/(IX+d) */
 #ifdef _M
 #undef _M
 #endif
-#define _M() _STR(r[6]);if(pre){_FETCH_I8(d);_STR_D8(d);_CHR(')');}
+#define _M() _STR(r[6]);if(pre){_FETCH_I8(d);_DISP(d);_STR_D8(d);_CHR(')');}
 /* same as _M, but with given offset byte */
 #ifdef _Md
 #undef _Md
@@ -157,12 +325,32 @@ uint16_t z80dasm_op(uint16_t pc, z80dasm_input_t in_cb, z80dasm_output_t out_cb,
 #ifdef _IMM16
 #undef _IMM16
 #endif
-#define _IMM16() _FETCH_U16(u16); _STR_U16(u16);
+#define _IMM16() _FETCH_U16(u16); _STR_U16(u16); ctx->inst->imm=u16; ctx->inst->opnds|=Z80DASM_OPND_IMM16;
 /* output 8-bit immediate operand */
 #ifdef _IMM8
 #undef _IMM8
 #endif
-#define _IMM8() _FETCH_U8(u8); _STR_U8(u8);
+#define _IMM8() _FETCH_U8(u8); _STR_U8(u8); ctx->inst->imm=u8; ctx->inst->opnds|=Z80DASM_OPND_IMM8;
+/* set the mnemonic id */
+#ifdef _MN
+#undef _MN
+#endif
+#define _MN(m) ctx->inst->mnemonic=(m);
+/* set the control flow type */
+#ifdef _FLOW
+#undef _FLOW
+#endif
+#define _FLOW(f,c) ctx->inst->flow=(f);ctx->inst->cond=(c);
+/* set the jump or call target address */
+#ifdef _TARGET
+#undef _TARGET
+#endif
+#define _TARGET(t) ctx->inst->target=(uint16_t)(t);ctx->inst->opnds|=Z80DASM_OPND_TARGET;
+/* set the index register displacement */
+#ifdef _DISP
+#undef _DISP
+#endif
+#define _DISP(d) ctx->inst->disp=(d);ctx->inst->opnds|=Z80DASM_OPND_DISP;
 
 static const char* _z80dasm_r[8] = { "B", "C", "D", "E", "H", "L", "(HL)", "A" };
 static const char* _z80dasm_rix[8] = { "B", "C", "D", "E", "IXH", "IXL", "(IX", "A" };
@@ -178,6 +366,22 @@ static const char* _z80dasm_alu[8] = { "ADD A,", "ADC A,", "SUB ", "SBC A,", "AN
 static const char* _z80dasm_rot[8] = { "RLC ", "RRC ", "RL ", "RR ", "SLA ", "SRA ", "SLL ", "SRL " };
 static const char* _z80dasm_x0z7[8] = { "RLCA", "RRCA", "RLA", "RRA", "DAA", "CPL", "SCF", "CCF" };
 static const char* _z80dasm_edx1z7[8] = { "LD I,A", "LD R,A", "LD A,I", "LD A,R", "RRD", "RLD", "NOP (ED)", "NOP (ED)" };
+static const uint8_t _z80dasm_alu_mn[8] = {
+    Z80DASM_MN_ADD, Z80DASM_MN_ADC, Z80DASM_MN_SUB, Z80DASM_MN_SBC,
+    Z80DASM_MN_AND, Z80DASM_MN_XOR, Z80DASM_MN_OR, Z80DASM_MN_CP
+};
+static const uint8_t _z80dasm_rot_mn[8] = {
+    Z80DASM_MN_RLC, Z80DASM_MN_RRC, Z80DASM_MN_RL, Z80DASM_MN_RR,
+    Z80DASM_MN_SLA, Z80DASM_MN_SRA, Z80DASM_MN_SLL, Z80DASM_MN_SRL
+};
+static const uint8_t _z80dasm_x0z7_mn[8] = {
+    Z80DASM_MN_RLCA, Z80DASM_MN_RRCA, Z80DASM_MN_RLA, Z80DASM_MN_RRA,
+    Z80DASM_MN_DAA, Z80DASM_MN_CPL, Z80DASM_MN_SCF, Z80DASM_MN_CCF
+};
+static const uint8_t _z80dasm_edx1z7_mn[8] = {
+    Z80DASM_MN_LD, Z80DASM_MN_LD, Z80DASM_MN_LD, Z80DASM_MN_LD,
+    Z80DASM_MN_RRD, Z80DASM_MN_RLD, Z80DASM_MN_NOP, Z80DASM_MN_NOP
+};
 static const char* _z80dasm_im[8] = { "0", "0", "1", "2", "0", "0", "1", "2" };
 static const char* _z80dasm_bli[4][4] = {
     { "LDI", "CPI", "INI", "OUTI" },
@@ -185,64 +389,113 @@ static const char* _z80dasm_bli[4][4] = {
     { "LDIR", "CPIR", "INIR", "OTIR" },
     { "LDDR", "CPDR", "INDR", "OTDR" }
 };
+static const uint8_t _z80dasm_bli_mn[4][4] = {
+    { Z80DASM_MN_LDI, Z80DASM_MN_CPI, Z80DASM_MN_INI, Z80DASM_MN_OUTI },
+    { Z80DASM_MN_LDD, Z80DASM_MN_CPD, Z80DASM_MN_IND, Z80DASM_MN_OUTD },
+    { Z80DASM_MN_LDIR, Z80DASM_MN_CPIR, Z80DASM_MN_INIR, Z80DASM_MN_OTIR },
+    { Z80DASM_MN_LDDR, Z80DASM_MN_CPDR, Z80DASM_MN_INDR, Z80DASM_MN_OTDR }
+};
 static const char* _z80dasm_oct = "01234567";
 static const char* _z80dasm_dec = "0123456789";
 static const char* _z80dasm_hex = "0123456789ABCDEF";
 
+/* a zero-initialized instruction record */
+static const z80dasm_inst_t _z80dasm_inst_zero = {0};
+
+/* decoder state, instruction bytes either come from a callback or a buffer */
+typedef struct {
+    z80dasm_input_t in_cb;
+    void* user_data;
+    const uint8_t* bytes;
+    size_t num_bytes;
+    size_t base;    /* buffer offset of current instruction */
+    size_t pos;     /* byte offset in current instruction */
+    bool text;
+    int str_pos;
+    char str[Z80DASM_MAX_STRLEN];
+    z80dasm_inst_t* inst;
+} _z80dasm_ctx_t;
+
+/* fetch the next instruction byte */
+static inline uint8_t _z80dasm_fetch(_z80dasm_ctx_t* ctx) {
+    uint8_t val = 0;
+    if (ctx->in_cb) {
+        val = ctx->in_cb(ctx->user_data);
+    }
+    else if ((ctx->base + ctx->pos) < ctx->num_bytes) {
+        val = ctx->bytes[ctx->base + ctx->pos];
+    }
+    if (ctx->pos < Z80DASM_MAX_BYTES) {
+        ctx->inst->bytes[ctx->pos] = val;
+    }
+    ctx->pos++;
+    return val;
+}
+
+/* output a character */
+static inline void _z80dasm_chr(char c, _z80dasm_ctx_t* ctx) {
+    if (ctx->text && ((ctx->str_pos + 1) < Z80DASM_MAX_STRLEN)) {
+        ctx->str[ctx->str_pos++] = c;
+    }
+}
+
 /* output a string */
-static void _z80dasm_str(const char* str, z80dasm_output_t out_cb, void* user_data) {
-    if (out_cb) {
+static void _z80dasm_str(const char* str, _z80dasm_ctx_t* ctx) {
+    if (ctx->text) {
         char c;
         while (0 != (c = *str++)) {
-            out_cb(c, user_data);
+            _z80dasm_chr(c, ctx);
         }
     }
 }
 
 /* output a signed 8-bit offset value as decimal string */
-static void _z80dasm_d8(int8_t val, z80dasm_output_t out_cb, void* user_data) {
-    if (out_cb) {
+static void _z80dasm_d8(int8_t val, _z80dasm_ctx_t* ctx) {
+    if (ctx->text) {
         if (val < 0) {
-            out_cb('-', user_data);
+            _z80dasm_chr('-', ctx);
             val = -val;
         }
         else {
-            out_cb('+', user_data);
+            _z80dasm_chr('+', ctx);
         }
         if (val >= 100) {
-            out_cb('1', user_data);
+            _z80dasm_chr('1', ctx);
             val -= 100;
         }
         if ((val/10) != 0) {
-            out_cb(_z80dasm_dec[val/10], user_data);
+            _z80dasm_chr(_z80dasm_dec[val/10], ctx);
         }
-        out_cb(_z80dasm_dec[val%10], user_data);
+        _z80dasm_chr(_z80dasm_dec[val%10], ctx);
     }
 }
 
 /* output an unsigned 8-bit value as hex string */
-static void _z80dasm_u8(uint8_t val, z80dasm_output_t out_cb, void* user_data) {
-    if (out_cb) {
+static void _z80dasm_u8(uint8_t val, _z80dasm_ctx_t* ctx) {
+    if (ctx->text) {
         for (int i = 1; i >= 0; i--) {
-            out_cb(_z80dasm_hex[(val>>(i*4)) & 0xF], user_data);
+            _z80dasm_chr(_z80dasm_hex[(val>>(i*4)) & 0xF], ctx);
         }
-        out_cb('h',user_data);
+        _z80dasm_chr('h', ctx);
     }
 }
 
 /* output an unsigned 16-bit value as hex string */
-static void _z80dasm_u16(uint16_t val, z80dasm_output_t out_cb, void* user_data) {
-    if (out_cb) {
+static void _z80dasm_u16(uint16_t val, _z80dasm_ctx_t* ctx) {
+    if (ctx->text) {
         for (int i = 3; i >= 0; i--) {
-            out_cb(_z80dasm_hex[(val>>(i*4)) & 0xF], user_data);
+            _z80dasm_chr(_z80dasm_hex[(val>>(i*4)) & 0xF], ctx);
         }
-        out_cb('h',user_data);
+        _z80dasm_chr('h', ctx);
     }
 }
 
-/* main disassembler function */
-uint16_t z80dasm_op(uint16_t pc, z80dasm_input_t in_cb, z80dasm_output_t out_cb, void* user_data) {
-    CHIPS_ASSERT(in_cb);
+/* main decoder function */
+static uint16_t _z80dasm_decode(uint16_t pc, _z80dasm_ctx_t* ctx) {
+    z80dasm_inst_t* inst = ctx->inst;
+    *inst = _z80dasm_inst_zero;
+    inst->addr = pc;
+    ctx->pos = 0;
     uint8_t op = 0, pre = 0, u8 = 0;
     int8_t d = 0;
     uint16_t u16 = 0;
@@ -285,11 +538,11 @@ uint16_t z80dasm_op(uint16_t pc, z80dasm_input_t in_cb, z80dasm_output_t out_cb,
         if (y == 6) {
             if (z == 6) {
                 /* special case LD (HL),(HL) */
-                _STR("HALT");
+                _MN(Z80DASM_MN_HALT); _FLOW(Z80DASM_FLOW_HALT,false); _STR("HALT");
             }
             else {
                 /* LD (HL),r; LD (IX+d),r; LD (IY+d),r */
-                _STR("LD "); _M(); _CHR(',');
+                _MN(Z80DASM_MN_LD); _STR("LD "); _M(); _CHR(',');
                 if (pre && ((z == 4) || (z == 5))) {
                     /* special case LD (IX+d),L/H (don't use IXL/IXH) */
                     _STR(_z80dasm_r[z]);
@@ -301,7 +554,7 @@ uint16_t z80dasm_op(uint16_t pc, z80dasm_input_t in_cb, z80dasm_output_t out_cb,
         }
         else if (z == 6) {
             /* LD r,(HL); LD r,(IX+d); LD r,(IY+d) */
-            _STR("LD ");
+            _MN(Z80DASM_MN_LD); _STR("LD ");
             if (pre && ((y == 4) || (y == 5))) {
                 /* special case LD H/L,(IX+d) (don't use IXL/IXH) */
                 _STR(_z80dasm_r[y]);
@@ -313,35 +566,35 @@ uint16_t z80dasm_op(uint16_t pc, z80dasm_input_t in_cb, z80dasm_output_t out_cb,
         }
         else {
             /* regular LD r,s */
-            _STR("LD "); _STR(r[y]); _CHR(','); _STR(r[z]);
+            _MN(Z80DASM_MN_LD); _STR("LD "); _STR(r[y]); _CHR(','); _STR(r[z]);
         }
     }
     else if (x == 2) {
         /* 8-bit ALU block */
-        _STR(alu[y]); _MR(z);
+        _MN(_z80dasm_alu_mn[y]); _STR(alu[y]); _MR(z);
     }
     else if (x == 0) {
         switch (z) {
             case 0:
                 switch (y) {
-                    case 0: _STR("NOP"); break;
-                    case 1: _STR("EX AF,AF'"); break;
-                    case 2: _STR("DJNZ "); _FETCH_I8(d); _STR_U16(pc+d); break;
-                    case 3: _STR("JR "); _FETCH_I8(d); _STR_U16(pc+d); break;
-                    default: _STR("JR "); _STR(cc[y-4]); _CHR(','); _FETCH_I8(d); _STR_U16(pc+d); break;
+                    case 0: _MN(Z80DASM_MN_NOP); _STR("NOP"); break;
+                    case 1: _MN(Z80DASM_MN_EX); _STR("EX AF,AF'"); break;
+                    case 2: _MN(Z80DASM_MN_DJNZ); _FLOW(Z80DASM_FLOW_JUMP,true); _STR("DJNZ "); _FETCH_I8(d); _TARGET(pc+d); _STR_U16(pc+d); break;
+                    case 3: _MN(Z80DASM_MN_JR); _FLOW(Z80DASM_FLOW_JUMP,false); _STR("JR "); _FETCH_I8(d); _TARGET(pc+d); _STR_U16(pc+d); break;
+                    default: _MN(Z80DASM_MN_JR); _FLOW(Z80DASM_FLOW_JUMP,true); _STR("JR "); _STR(cc[y-4]); _CHR(','); _FETCH_I8(d); _TARGET(pc+d); _STR_U16(pc+d); break;
                 }
                 break;
             case 1:
                 if (q == 0) {
-                    _STR("LD "); _STR(rp[p]); _CHR(','); _IMM16();
+                    _MN(Z80DASM_MN_LD); _STR("LD "); _STR(rp[p]); _CHR(','); _IMM16();
                 }
                 else {
-                    _STR("ADD "); _STR(rp[2]); _CHR(','); _STR(rp[p]);
+                    _MN(Z80DASM_MN_ADD); _STR("ADD "); _STR(rp[2]); _CHR(','); _STR(rp[p]);
                 }
                 break;
             case 2: 
                 {
-                    _STR("LD ");
+                    _MN(Z80DASM_MN_LD); _STR("LD ");
                     switch (y) {
                         case 0: _STR("(BC),A"); break;
                         case 1: _STR("A,(BC)"); break;
@@ -354,42 +607,42 @@ uint16_t z80dasm_op(uint16_t pc, z80dasm_input_t in_cb, z80dasm_output_t out_cb,
                     }
                 }
                 break;
-            case 3: _STR(q==0?"INC ":"DEC "); _STR(rp[p]); break;
-            case 4: _STR("INC "); _MR(y); break;
-            case 5: _STR("DEC "); _MR(y); break;
-            case 6: _STR("LD "); _MR(y); _CHR(','); _IMM8(); break;
-            case 7: _STR(_z80dasm_x0z7[y]); break;
+            case 3: _MN(q==0?Z80DASM_MN_INC:Z80DASM_MN_DEC); _STR(q==0?"INC ":"DEC "); _STR(rp[p]); break;
+            case 4: _MN(Z80DASM_MN_INC); _STR("INC "); _MR(y); break;
+            case 5: _MN(Z80DASM_MN_DEC); _STR("DEC "); _MR(y); break;
+            case 6: _MN(Z80DASM_MN_LD); _STR("LD "); _MR(y); _CHR(','); _IMM8(); break;
+            case 7: _MN(_z80dasm_x0z7_mn[y]); _STR(_z80dasm_x0z7[y]); break;
         }
     }
     else {
         switch (z) {
-            case 0: _STR("RET "); _STR(cc[y]); break;
+            case 0: _MN(Z80DASM_MN_RET); _FLOW(Z80DASM_FLOW_RET,true); _STR("RET "); _STR(cc[y]); break;
             case 1:
                 if (q == 0) {
-                    _STR("POP "); _STR(rp2[p]);
+                    _MN(Z80DASM_MN_POP); _STR("POP "); _STR(rp2[p]);
                 }
                 else {
                     switch (p) {
-                        case 0: _STR("RET"); break;
-                        case 1: _STR("EXX"); break;
-                        case 2: _STR("JP "); _CHR('('); _STR(rp[2]); _CHR(')'); break;
-                        case 3: _STR("LD SP,"); _STR(rp[2]); break;
+                        case 0: _MN(Z80DASM_MN_RET); _FLOW(Z80DASM_FLOW_RET,false); _STR("RET"); break;
+                        case 1: _MN(Z80DASM_MN_EXX); _STR("EXX"); break;
+                        case 2: _MN(Z80DASM_MN_JP); _FLOW(Z80DASM_FLOW_JUMP_INDIRECT,false); _STR("JP "); _CHR('('); _STR(rp[2]); _CHR(')'); break;
+                        case 3: _MN(Z80DASM_MN_LD); _STR("LD SP,"); _STR(rp[2]); break;
                     }
                 }
                 break;
-            case 2: _STR("JP "); _STR(cc[y]); _CHR(','); _IMM16(); break;
+            case 2: _MN(Z80DASM_MN_JP); _FLOW(Z80DASM_FLOW_JUMP,true); _STR("JP "); _STR(cc[y]); _CHR(','); _IMM16(); _TARGET(u16); break;
             case 3:
                 switch (y) {
-                    case 0: _STR("JP "); _IMM16(); break;
-                    case 2: _STR("OUT ("); _IMM8(); _CHR(')'); _STR(",A"); break;
-                    case 3: _STR("IN A,("); _IMM8(); _CHR(')'); break;
-                    case 4: _STR("EX (SP),"); _STR(rp[2]); break;
-                    case 5: _STR("EX DE,HL"); break;
-                    case 6: _STR("DI"); break;
-                    case 7: _STR("EI"); break;
+                    case 0: _MN(Z80DASM_MN_JP); _FLOW(Z80DASM_FLOW_JUMP,false); _STR("JP "); _IMM16(); _TARGET(u16); break;
+                    case 2: _MN(Z80DASM_MN_OUT); _STR("OUT ("); _IMM8(); _CHR(')'); _STR(",A"); break;
+                    case 3: _MN(Z80DASM_MN_IN); _STR("IN A,("); _IMM8(); _CHR(')'); break;
+                    case 4: _MN(Z80DASM_MN_EX); _STR("EX (SP),"); _STR(rp[2]); break;
+                    case 5: _MN(Z80DASM_MN_EX); _STR("EX DE,HL"); break;
+                    case 6: _MN(Z80DASM_MN_DI); _STR("DI"); break;
+                    case 7: _MN(Z80DASM_MN_EI); _STR("EI"); break;
                     case 1: /* CB prefix */
                         if (pre) {
-                            _FETCH_I8(d);
+                            _FETCH_I8(d); _DISP(d);
                         }
                         _FETCH_U8(op);
                         x = (op >> 6) & 3;
@@ -397,13 +650,13 @@ uint16_t z80dasm_op(uint16_t pc, z80dasm_input_t in_cb, z80dasm_output_t out_cb,
                         z = op & 7;
                         if (x == 0) {
                             /* rot and shift instructions */
-                            _STR(_z80dasm_rot[y]); _MRd(z,d);
+                            _MN(_z80dasm_rot_mn[y]); _STR(_z80dasm_rot[y]); _MRd(z,d);
                         }
                         else {
                             /* bit instructions */
-                            if (x == 1) { _STR("BIT "); }
-                            else if (x == 2) { _STR("RES "); }
-                            else { _STR("SET "); }
+                            if (x == 1) { _MN(Z80DASM_MN_BIT); _STR("BIT "); }
+                            else if (x == 2) { _MN(Z80DASM_MN_RES); _STR("RES "); }
+                            else { _MN(Z80DASM_MN_SET); _STR("SET "); }
                             _CHR(_z80dasm_oct[y]);
                             if (pre) {
                                 _CHR(','); _Md(d);
@@ -415,14 +668,14 @@ uint16_t z80dasm_op(uint16_t pc, z80dasm_input_t in_cb, z80dasm_output_t out_cb,
                         break;
                 }
                 break;
-            case 4: _STR("CALL "); _STR(cc[y]); _CHR(','); _IMM16(); break;
+            case 4: _MN(Z80DASM_MN_CALL); _FLOW(Z80DASM_FLOW_CALL,true); _STR("CALL "); _STR(cc[y]); _CHR(','); _IMM16(); _TARGET(u16); break;
             case 5: 
                 if (q == 0) {
-                    _STR("PUSH "); _STR(rp2[p]);
+                    _MN(Z80DASM_MN_PUSH); _STR("PUSH "); _STR(rp2[p]);
                 }
                 else {
                     switch (p) {
-                        case 0: _STR("CALL "); _IMM16(); break;
+                        case 0: _MN(Z80DASM_MN_CALL); _FLOW(Z80DASM_FLOW_CALL,false); _STR("CALL "); _IMM16(); _TARGET(u16); break;
                         case 1: _STR("DBL PREFIX"); break;
                         case 3: _STR("DBL PREFIX"); break;
                         case 2: /* ED prefix */
@@ -433,24 +686,24 @@ uint16_t z80dasm_op(uint16_t pc, z80dasm_input_t in_cb, z80dasm_output_t out_cb,
                             p = y >> 1;
                             q = y & 1;
                             if ((x == 0) || (x == 3)) {
-                                _STR("NOP (ED)");
+                                _MN(Z80DASM_MN_NOP); _STR("NOP (ED)");
                             }
                             else if (x == 2) {
                                 if ((y >= 4) && (z <= 3)) {
                                     /* block instructions */
-                                    _STR(_z80dasm_bli[y-4][z]);
+                                    _MN(_z80dasm_bli_mn[y-4][z]); _STR(_z80dasm_bli[y-4][z]);
                                 }
                                 else {
-                                    _STR("NOP (ED)");
+                                    _MN(Z80DASM_MN_NOP); _STR("NOP (ED)");
                                 }
                             }
                             else {
                                 switch (z) {
-                                    case 0: _STR("IN "); if(y!=6){_STR(r[y]);_CHR(',');} _STR("(C)"); break;
-                                    case 1: _STR("OUT (C),"); _STR(y==6?"0":r[y]); break;
-                                    case 2: _STR(q==0?"SBC":"ADC"); _STR(" HL,"); _STR(rp[p]); break;
+                                    case 0: _MN(Z80DASM_MN_IN); _STR("IN "); if(y!=6){_STR(r[y]);_CHR(',');} _STR("(C)"); break;
+                                    case 1: _MN(Z80DASM_MN_OUT); _STR("OUT (C),"); _STR(y==6?"0":r[y]); break;
+                                    case 2: _MN(q==0?Z80DASM_MN_SBC:Z80DASM_MN_ADC); _STR(q==0?"SBC":"ADC"); _STR(" HL,"); _STR(rp[p]); break;
                                     case 3:
-                                        _STR("LD ");
+                                        _MN(Z80DASM_MN_LD); _STR("LD ");
                                         if (q == 0) {
                                             _CHR('('); _IMM16(); _STR("),"); _STR(rp[p]);
                                         }
@@ -458,23 +711,80 @@ uint16_t z80dasm_op(uint16_t pc, z80dasm_input_t in_cb, z80dasm_output_t out_cb,
                                             _STR(rp[p]); _STR(",("); _IMM16(); _CHR(')');
                                         }
                                         break;
-                                    case 4: _STR("NEG"); break;
-                                    case 5: _STR(y==1?"RETI":"RETN"); break;
-                                    case 6: _STR("IM "); _STR(_z80dasm_im[y]); break;
-                                    case 7: _STR(_z80dasm_edx1z7[y]); break;
+                                    case 4: _MN(Z80DASM_MN_NEG); _STR("NEG"); break;
+                                    case 5: _MN(y==1?Z80DASM_MN_RETI:Z80DASM_MN_RETN); _FLOW(Z80DASM_FLOW_RET,false); _STR(y==1?"RETI":"RETN"); break;
+                                    case 6: _MN(Z80DASM_MN_IM); _STR("IM "); _STR(_z80dasm_im[y]); break;
+                                    case 7: _MN(_z80dasm_edx1z7_mn[y]); _STR(_z80dasm_edx1z7[y]); break;
                                 }
                             }
                             break;
                     }
                 }
                 break;
-            case 6: _STR(alu[y]); _IMM8(); break; /* ALU n */
-            case 7: _STR("RST "); _STR_U8(y*8); break;
+            case 6: _MN(_z80dasm_alu_mn[y]); _STR(alu[y]); _IMM8(); break; /* ALU n */
+            case 7: _MN(Z80DASM_MN_RST); _FLOW(Z80DASM_FLOW_CALL,false); _TARGET(y*8); _STR("RST "); _STR_U8(y*8); break;
         }
     }
+    ctx->inst->len = (uint8_t) ctx->pos;
     return pc;
 }
 
+uint16_t z80dasm_op(uint16_t pc, z80dasm_input_t in_cb, z80dasm_output_t out_cb, void* user_data) {
+    CHIPS_ASSERT(in_cb);
+    z80dasm_inst_t inst;
+    _z80dasm_ctx_t ctx = {0};
+    ctx.in_cb = in_cb;
+    ctx.user_data = user_data;
+    ctx.text = (0 != out_cb);
+    ctx.inst = &inst;
+    pc = _z80dasm_decode(pc, &ctx);
+    for (int i = 0; i < ctx.str_pos; i++) {
+        out_cb(ctx.str[i], user_data);
+    }
+    return pc;
+}
+
+int z80dasm_decode(uint16_t addr, const uint8_t* bytes, size_t num_bytes, z80dasm_inst_t* out_inst) {
+    CHIPS_ASSERT(bytes && out_inst);
+    return (1 == z80dasm_decode_range(addr, bytes, num_bytes, out_inst, 1)) ? out_inst->len : 0;
+}
+
+size_t z80dasm_decode_range(uint16_t addr, const uint8_t* bytes, size_t num_bytes, z80dasm_inst_t* insts, size_t max_insts) {
+    CHIPS_ASSERT(bytes && insts);
+    _z80dasm_ctx_t ctx = {0};
+    ctx.bytes = bytes;
+    ctx.num_bytes = num_bytes;
+    size_t num_insts = 0;
+    while ((num_insts < max_insts) && (ctx.base < num_bytes)) {
+        ctx.inst = &insts[num_insts];
+        addr = _z80dasm_decode(addr, &ctx);
+        if ((ctx.base + ctx.pos) > num_bytes) {
+            /* instruction doesn't fit into the buffer */
+            break;
+        }
+        ctx.base += ctx.pos;
+        num_insts++;
+    }
+    return num_insts;
+}
+
+int z80dasm_render(const z80dasm_inst_t* inst, char* buf, int buf_size) {
+    CHIPS_ASSERT(inst && buf && (buf_size > 0));
+    z80dasm_inst_t tmp;
+    _z80dasm_ctx_t ctx = {0};
+    ctx.bytes = inst->bytes;
+    ctx.num_bytes = inst->len;
+    ctx.text = true;
+    ctx.inst = &tmp;
+    _z80dasm_decode(inst->addr, &ctx);
+    int len = (ctx.str_pos < buf_size) ? ctx.str_pos : (buf_size - 1);
+    for (int i = 0; i < len; i++) {
+        buf[i] = ctx.str[i];
+    }
+    buf[len] = 0;
+    return len;
+}
+
 #undef _FETCH_U8
 #undef _FETCH_I8
 #undef _FETCH_U16
@@ -489,4 +799,8 @@ uint16_t z80dasm_op(uint16_t pc, z80dasm_input_t in_cb, z80dasm_output_t out_cb,
 #undef _MRd
 #undef _IMM16
 #undef _IMM8
+#undef _MN
+#undef _FLOW
+#undef _TARGET
+#undef _DISP
 #endif /* CHIPS_UTIL_IMPL */